@@ -27,6 +27,10 @@ static enum
     ACTION_POLL,
     ACTION_READ,
     ACTION_WATCH,
+    ACTION_STATS,
+    ACTION_POOLS,
+    ACTION_TRACE,
+    ACTION_BATCH,
 }
 Action = ACTION_UNSPECIFIED;
 
@@ -48,16 +52,28 @@ static enum
     OBJECT_TRANSFORM,
     OBJECT_BUFFER_SIZE,
     OBJECT_BACKUP_PERIOD,
+    OBJECT_SPILL_SIZE,
+    OBJECT_BUFFER_PRECISION,
     OBJECT_JSON_EXTRACTION,
     OBJECT_OBSERVATION,
     OBJECT_MIN,
     OBJECT_MAX,
     OBJECT_MEAN,
     OBJECT_STD_DEVIATION,
+    OBJECT_STATS,
 }
 Object;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Names of the buffer precisions, as given to and printed by the tool (indexed by
+ * admin_BufferPrecision_t).
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* const PrecisionNames[] = { "full", "compact" };
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Flag indicating whether or not the output should be in JSON format.
@@ -71,6 +87,74 @@ static bool UseJsonFormat = false;
 //--------------------------------------------------------------------------------------------------
 static bool ReadFromFile = false;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flag indicating whether or not the runtime statistics counters should be reset.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ResetStatsFlag = false;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of resources to list in the hottest resources view of the 'stats' command (0 = only if
+ * PATH is a Namespace, in which case DEFAULT_TOP_COUNT resources are listed).
+ */
+//--------------------------------------------------------------------------------------------------
+static int TopCount = 0;
+
+/// Number of resources listed in the hottest resources view, if not specified with --top.
+#define DEFAULT_TOP_COUNT   10
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flag indicating whether or not the 'pools' command should output a pools include file.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GenerateCdefFlag = false;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Headroom (in percent of the peak usage) added to the pool sizes by 'pools --cdef'.
+ */
+//--------------------------------------------------------------------------------------------------
+static int HeadroomPercent = 25;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * What the 'trace' command is asked to do.
+ */
+//--------------------------------------------------------------------------------------------------
+static enum
+{
+    TRACE_PRINT,    ///< Print the histograms.
+    TRACE_ON,       ///< Start tracing (or change the sample period).
+    TRACE_OFF,      ///< Stop tracing.
+    TRACE_RESET,    ///< Clear the histograms.
+}
+TraceCommand = TRACE_PRINT;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trace one push out of every TraceSamplePeriod, for 'trace on'.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t TraceSamplePeriod = 1;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ptr to the FILE argument of the 'batch' command ("-" = read the commands from stdin).
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* BatchFileArg = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of a line in a 'batch' command file (a 'set' command with the longest paths and
+ * string value), including the newline.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BATCH_MAX_LINE_LEN (IO_MAX_STRING_VALUE_LEN + (2 * IO_MAX_RESOURCE_PATH_LEN) + 64)
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Print help text to stdout and exit with EXIT_SUCCESS.
@@ -98,6 +182,8 @@ static void HandleHelpRequest
         "    dhub set changeBy PATH\n"
         "    dhub set bufferSize PATH\n"
         "    dhub set backupPeriod PATH\n"
+        "    dhub set spillSize PATH\n"
+        "    dhub set bufferPrecision PATH\n"
         "    dhub set jsonExtraction PATH\n"
         "    dhub remove OBJECT PATH\n"
         "    dhub push PATH [[--json] VALUE]\n"
@@ -105,6 +191,11 @@ static void HandleHelpRequest
         "    dhub watch [--json] PATH\n"
         "    dhub get OBJECT PATH [START]\n"
         "    dhub read PATH [START]\n"
+        "    dhub stats [--top=N] [PATH]\n"
+        "    dhub stats --reset PATH\n"
+        "    dhub pools [--cdef [--headroom=PERCENT]]\n"
+        "    dhub trace [on [PERIOD] | off | reset]\n"
+        "    dhub batch FILE\n"
         "    dhub help\n"
         "    dhub -h\n"
         "    dhub --help\n"
@@ -149,7 +240,7 @@ static void HandleHelpRequest
         "            an Observation resource at PATH if one does not already exist\n"
         "            there.\n"
         "\n"
-        "    dhub set transform PATH TYPE\n"
+        "    dhub set transform PATH TYPE[,PERIOD]\n"
         "            Sets the numeric transform for an Observation buffer.\n"
         "            PATH is expected to be under /obs/.  Setting this will create\n"
         "            an Observation resource at PATH if one does not already exist\n"
@@ -160,6 +251,12 @@ static void HandleHelpRequest
         "            2 : standard deviation\n"
         "            3 : maximum\n"
         "            4 : minimum\n"
+        "            5 : bucket mean\n"
+        "            6 : bucket minimum\n"
+        "            7 : bucket maximum\n"
+        "            8 : bucket last\n"
+        "            The bucket types downsample the Observation's input, passing on\n"
+        "            one sample per bucket of PERIOD seconds (60 if not specified).\n"
         "\n"
         "    dhub set bufferSize PATH VALUE\n"
         "            Sets the maximum number of samples that an Observation will buffer.\n"
@@ -178,6 +275,28 @@ static void HandleHelpRequest
         "            an Observation resource at PATH if one does not already exist\n"
         "            there.\n"
         "\n"
+        "    dhub set spillSize PATH VALUE\n"
+        "            Sets the number of samples evicted from an Observation's buffer\n"
+        "            that are kept in its spilled history on non-volatile storage.\n"
+        "            Only trigger, Boolean and numeric samples are spilled.  Reads and\n"
+        "            queries with a START older than the buffer include the history.\n"
+        "            0 = delete the spilled history.\n"
+        "\n"
+        "            ** WARNING ** - Beware of flash memory wear!\n"
+        "\n"
+        "            PATH is expected to be under /obs/.  Setting this will create\n"
+        "            an Observation resource at PATH if one does not already exist\n"
+        "            there.\n"
+        "\n"
+        "    dhub set bufferPrecision PATH VALUE\n"
+        "            Sets the precision with which an Observation buffers numbers.\n"
+        "            VALUE is 'full' (the default) or 'compact'.  Compact precision\n"
+        "            keeps values as single-precision floating point numbers and\n"
+        "            timestamps to the millisecond, which takes half the memory.\n"
+        "            PATH is expected to be under /obs/.  Setting this will create\n"
+        "            an Observation resource at PATH if one does not already exist\n"
+        "            there.\n"
+        "\n"
         "    dhub set jsonExtraction PATH VALUE\n"
         "            Specifies what an Observation should should extract from JSON\n"
         "            values it receives.  PATH is expected to be under /obs/.\n"
@@ -232,20 +351,23 @@ static void HandleHelpRequest
         "              max\n"
         "              mean\n"
         "              stddev\n"
+        "              stats\n"
         "\n"
         "            For the source, default, and override objects, the PATH must be\n"
         "            absolute (beginning with '/'). The other objects are only found\n"
         "            on Observations, so their PATH can be relative to /obs/.\n"
         "\n"
         "            When getting statistical measurements on an Observations' buffer\n"
-        "            of data samples (min, max, mean, and stddev), a start time (START)\n"
-        "            can optionally be specified.  If START is specified, then START is\n"
-        "            the time in seconds since the Unix Epoch (Jan 1, 1970, 00:00:00)\n"
-        "            at which reading will start.  If START is less than 30 years\n"
-        "            after the Epoch (946684800), then START will be subtracted from\n"
-        "            the current time to compute the start time.  E.g., 120 = compute\n"
-        "            the statistic using only data received within the last 2 minutes.\n"
-        "            If START is not specified, the entire buffer will be used.\n"
+        "            of data samples (min, max, mean, stddev, and stats), a start time\n"
+        "            (START) can optionally be specified.  If START is specified, then\n"
+        "            START is the time in seconds since the Unix Epoch (Jan 1, 1970,\n"
+        "            00:00:00) at which reading will start.  If START is less than 30\n"
+        "            years after the Epoch (946684800), then START will be subtracted\n"
+        "            from the current time to compute the start time.  E.g., 120 =\n"
+        "            compute the statistic using only data received within the last\n"
+        "            2 minutes.  If START is not specified, the entire buffer will be\n"
+        "            used.  The stats object reports the count, min, max, mean, and\n"
+        "            stddev together, all computed in a single query.\n"
         "\n"
         "    dhub read PATH [START]\n"
         "            Reads the contents of the data sample buffer of the Observation\n"
@@ -263,6 +385,63 @@ static void HandleHelpRequest
         "            than 2 minutes old.  If START is not specified, the entire buffer\n"
         "            will be read.\n"
         "\n"
+        "    dhub stats [--top=N] [PATH]\n"
+        "            Prints the runtime statistics counters of the resource at PATH:\n"
+        "            the number of samples received, accepted, dropped by each of\n"
+        "            the possible reasons, converted to the resource's data type or\n"
+        "            failing JSON extraction, and the number of push handler\n"
+        "            call-backs and buffer evictions.  PATH must be absolute.\n"
+        "\n"
+        "            If PATH is a namespace (default '/'), or if --top (or -t) is\n"
+        "            specified, then the N (default 10) resources under PATH that\n"
+        "            received the most samples are listed instead, hottest first.\n"
+        "\n"
+        "    dhub stats --reset PATH\n"
+        "            Sets the runtime statistics counters of the resource at PATH\n"
+        "            back to zero.  --reset can be abbreviated -r.\n"
+        "\n"
+        "    dhub pools\n"
+        "            Prints the usage of each of the Data Hub's memory pools: the\n"
+        "            size of its blocks, how many blocks it has, how many are in\n"
+        "            use, the most that were ever in use at the same time, and how\n"
+        "            many times it had to be expanded at runtime.\n"
+        "\n"
+        "    dhub pools --cdef [--headroom=PERCENT]\n"
+        "            Prints a pools section sizing every Data Hub pool to its peak\n"
+        "            usage plus PERCENT (default 25) percent, ready to be used as\n"
+        "            the file included by the Data Hub's Component.cdef through\n"
+        "            DHUB_POOLS_INC.  --cdef can be abbreviated -c, and --headroom\n"
+        "            can be abbreviated -m.\n"
+        "\n"
+        "    dhub trace\n"
+        "            Prints a latency histogram for each stage of the pushes that\n"
+        "            were traced: JSON extraction, filtering, buffering, type\n"
+        "            conversion, fan-out to route destinations, push handler\n"
+        "            call-backs and Observation destination call-backs, as well as\n"
+        "            the total time from the arrival of each push.\n"
+        "\n"
+        "    dhub trace on [PERIOD]\n"
+        "            Starts tracing one push out of every PERIOD (default 1) pushes\n"
+        "            received through the I/O API.\n"
+        "\n"
+        "    dhub trace off\n"
+        "            Stops tracing pushes.  The histograms are kept.\n"
+        "\n"
+        "    dhub trace reset\n"
+        "            Clears the histograms.\n"
+        "\n"
+        "    dhub batch FILE\n"
+        "            Runs the get, set, remove and push commands listed in FILE\n"
+        "            (or read from stdin if FILE is '-'), one per line, over a\n"
+        "            single connection and inside a single administrative update.\n"
+        "            Each line is written as it would be on the command line,\n"
+        "            optionally starting with 'dhub', except that the VALUE is the\n"
+        "            whole rest of the line, taken literally (no quoting).  Blank\n"
+        "            lines and lines starting with '#' are ignored.  A line that\n"
+        "            fails is reported on stderr, with its line number, and the\n"
+        "            following lines are still run.  Exits with EXIT_FAILURE if\n"
+        "            any line failed.\n"
+        "\n"
         "    dhub help\n"
         "    dhub -h\n"
         "    dhub --help\n"
@@ -302,7 +481,7 @@ static const char* ValueArg = NULL;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Start timestamp argument for 'read' and 'get min/max/mean/stddev' commands.
+ * Start timestamp argument for 'read' and 'get min/max/mean/stddev/stats' commands.
  */
 //--------------------------------------------------------------------------------------------------
 static double StartArg = NAN;  // Not-a-number by default
@@ -720,12 +899,32 @@ static void PrintTransformSetting
         "standard deviation (2)",
         "maximum (3)",
         "minimum (4)",
+        "bucket mean (5)",
+        "bucket minimum (6)",
+        "bucket maximum (7)",
+        "bucket last (8)",
     };
 
     printf("%s: %s\n", label, transformNameStr[value]);
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print out a buffer precision setting.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintPrecisionSetting
+(
+    const char* label,
+    admin_BufferPrecision_t precision
+)
+//--------------------------------------------------------------------------------------------------
+{
+    printf("%s: %s\n", label, PrecisionNames[precision]);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Print the data type of a resource at a given path.
@@ -930,6 +1129,10 @@ static void PrintEntry
                backupPeriod,
                ((double)backupPeriod) / 60,
                ((double)backupPeriod) / 3600);
+        Indent(depth);
+        printf("spillSize: %u entries\n", admin_GetBufferSpillMaxCount(path));
+        Indent(depth);
+        PrintPrecisionSetting("bufferPrecision", admin_GetBufferPrecision(path));
     }
 }
 
@@ -967,9 +1170,11 @@ static void PrintBranch
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the data flow route into destPath to be from srcPath.
+ *
+ * @return LE_OK if successful (errors are reported on stderr).
  */
 //--------------------------------------------------------------------------------------------------
-static void SetSource
+static le_result_t SetSource
 (
     const char* destPath,
     const char* srcPath
@@ -988,7 +1193,7 @@ static void SetSource
         case LE_BAD_PARAMETER:
 
             fprintf(stderr, "One or both of the resource paths are malformed.\n");
-            exit(EXIT_FAILURE);
+            break;
 
         case LE_DUPLICATE:
 
@@ -996,7 +1201,7 @@ static void SetSource
                     "Addition of a route from '%s' to '%s' would create a loop.\n",
                     srcPath,
                     destPath);
-            exit(EXIT_FAILURE);
+            break;
 
         default:
 
@@ -1004,8 +1209,10 @@ static void SetSource
                     "Unexpected result code %d (%s) from Data Hub.\n",
                     result,
                     LE_RESULT_TXT(result));
-            exit(EXIT_FAILURE);
+            break;
     }
+
+    return result;
 }
 
 
@@ -1152,10 +1359,12 @@ static void SetSetting
 /**
  * Set a floating-point numeric setting on an Observation.
  *
+ * @return LE_OK if successful (errors are reported on stderr).
+ *
  * @note Has the side-effect of creating the Observation if it does not yet exist.
  */
 //--------------------------------------------------------------------------------------------------
-static void SetDoubleSetting
+static le_result_t SetDoubleSetting
 (
     const char* path,
     const char* valueStr,
@@ -1169,7 +1378,7 @@ static void SetDoubleSetting
         if (admin_CreateObs(path) != LE_OK)
         {
             fprintf(stderr, "Invalid resource path for Observation.\n");
-            exit(EXIT_FAILURE);
+            return LE_BAD_PARAMETER;
         }
 
         func(path, number);
@@ -1177,8 +1386,10 @@ static void SetDoubleSetting
     else
     {
         fprintf(stderr, "Value must be numeric ('%s' is not).\n", valueStr);
-        exit(EXIT_FAILURE);
+        return LE_BAD_PARAMETER;
     }
+
+    return LE_OK;
 }
 
 
@@ -1206,10 +1417,12 @@ static void GetDoubleSetting
 /**
  * Set an integer setting.
  *
+ * @return LE_OK if successful (errors are reported on stderr).
+ *
  * @note Has the side-effect of creating the Observation if it does not yet exist.
  */
 //--------------------------------------------------------------------------------------------------
-static void SetIntegerSetting
+static le_result_t SetIntegerSetting
 (
     const char* path,
     const char* valueStr,
@@ -1221,16 +1434,18 @@ static void SetIntegerSetting
     if ((le_utf8_ParseInt(&value, valueStr) != LE_OK) || (value < 0))
     {
         fprintf(stderr, "Non-negative integer value required.\n");
-        exit(EXIT_FAILURE);
+        return LE_BAD_PARAMETER;
     }
 
     if (admin_CreateObs(path) != LE_OK)
     {
         fprintf(stderr, "Invalid resource path for Observation.\n");
-        exit(EXIT_FAILURE);
+        return LE_BAD_PARAMETER;
     }
 
     setterFunc(path, (uint32_t)value);
+
+    return LE_OK;
 }
 
 
@@ -1238,30 +1453,98 @@ static void SetIntegerSetting
 /**
  * Set a transform setting.
  *
+ * @return LE_OK if successful (errors are reported on stderr).
+ *
  * @note Has the side-effect of creating the Observation if it does not yet exist.
  */
 //--------------------------------------------------------------------------------------------------
-static void SetTransformSetting
+static le_result_t SetTransformSetting
 (
     const char* path,
     const char* valueStr
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // The type may be followed by a comma and the bucket period.
+    char typeStr[16];
+    double period = NAN;
+    size_t paramsSize = 0;
+    const char* periodStr = strchr(valueStr, ',');
+    if (periodStr != NULL)
+    {
+        size_t typeLen = periodStr - valueStr;
+        period = ParseDouble(periodStr + 1);
+        if ((typeLen >= sizeof(typeStr)) || !(period > 0))
+        {
+            fprintf(stderr, "Positive bucket period required after ','.\n");
+            return LE_BAD_PARAMETER;
+        }
+        memcpy(typeStr, valueStr, typeLen);
+        typeStr[typeLen] = '\0';
+        valueStr = typeStr;
+        paramsSize = 1;
+    }
+
     int value;
     if ((le_utf8_ParseInt(&value, valueStr) != LE_OK) || (value < 0))
     {
         fprintf(stderr, "Non-negative integer value required.\n");
-        exit(EXIT_FAILURE);
+        return LE_BAD_PARAMETER;
     }
 
     if (admin_CreateObs(path) != LE_OK)
     {
         fprintf(stderr, "Invalid resource path for Observation.\n");
-        exit(EXIT_FAILURE);
+        return LE_BAD_PARAMETER;
+    }
+
+    admin_SetTransform(path, (admin_TransformType_t)value, &period, paramsSize);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set a buffer precision setting.
+ *
+ * @return LE_OK if successful (errors are reported on stderr).
+ *
+ * @note Has the side-effect of creating the Observation if it does not yet exist.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SetPrecisionSetting
+(
+    const char* path,
+    const char* valueStr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    admin_BufferPrecision_t precision;
+
+    if (strcmp(valueStr, PrecisionNames[ADMIN_BUFFER_PRECISION_FULL]) == 0)
+    {
+        precision = ADMIN_BUFFER_PRECISION_FULL;
+    }
+    else if (strcmp(valueStr, PrecisionNames[ADMIN_BUFFER_PRECISION_COMPACT]) == 0)
+    {
+        precision = ADMIN_BUFFER_PRECISION_COMPACT;
+    }
+    else
+    {
+        fprintf(stderr, "Buffer precision must be 'full' or 'compact'.\n");
+        return LE_BAD_PARAMETER;
+    }
+
+    if (admin_CreateObs(path) != LE_OK)
+    {
+        fprintf(stderr, "Invalid resource path for Observation.\n");
+        return LE_BAD_PARAMETER;
     }
 
-    admin_SetTransform(path, (admin_TransformType_t)value, NULL, 0);
+    admin_SetBufferPrecision(path, precision);
+
+    return LE_OK;
 }
 
 
@@ -1285,9 +1568,11 @@ static void GetIntegerSetting
 //--------------------------------------------------------------------------------------------------
 /**
  * Get a buffer statistic.
+ *
+ * @return LE_OK if successful (errors are reported on stderr).
  */
 //--------------------------------------------------------------------------------------------------
-static void GetBufferStat
+static le_result_t GetBufferStat
 (
     double (*getterFunc)(const char*, double)
 )
@@ -1296,7 +1581,7 @@ static void GetBufferStat
     if (PathArg == NULL)
     {
         fprintf(stderr, "Missing PATH argument.\n");
-        exit(EXIT_FAILURE);
+        return LE_BAD_PARAMETER;
     }
 
     double value = getterFunc(PathArg, StartArg);
@@ -1304,670 +1589,2023 @@ static void GetBufferStat
     if (isnan(value))
     {
         fprintf(stderr, "No numerical data buffered at resource path '%s'.\n", PathArg);
-        exit(EXIT_FAILURE);
+        return LE_NOT_FOUND;
     }
     else
     {
         printf("%lf\n", value);
     }
+
+    return LE_OK;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Set the default value of a resource.
+ * Get all of the buffer statistics at once.
+ *
+ * @return LE_OK if successful (errors are reported on stderr).
  */
 //--------------------------------------------------------------------------------------------------
-static void SetDefault
+static le_result_t GetBufferStats
 (
-    const char* path,
-    const char* value
+    void
 )
 //--------------------------------------------------------------------------------------------------
 {
-    SetSetting(path,
-               value,
-               admin_SetBooleanDefault,
-               admin_SetNumericDefault,
-               admin_SetStringDefault,
-               admin_SetJsonDefault);
+    if (PathArg == NULL)
+    {
+        fprintf(stderr, "Missing PATH argument.\n");
+        return LE_BAD_PARAMETER;
+    }
+
+    double min;
+    double max;
+    double mean;
+    double stdDev;
+    uint32_t count;
+
+    if (query_GetStats(PathArg, StartArg, &min, &max, &mean, &stdDev, &count) != LE_OK)
+    {
+        fprintf(stderr, "No Observation found at resource path '%s'.\n", PathArg);
+        return LE_NOT_FOUND;
+    }
+
+    if (count == 0)
+    {
+        fprintf(stderr, "No numerical data buffered at resource path '%s'.\n", PathArg);
+        return LE_NOT_FOUND;
+    }
+
+    printf("count: %u\n", count);
+    printf("min: %lf\n", min);
+    printf("max: %lf\n", max);
+    printf("mean: %lf\n", mean);
+    printf("stddev: %lf\n", stdDev);
+
+    return LE_OK;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Push value of the resource using a local file
+ * Names of the runtime statistics counters, as printed by the 'stats' command.
  */
 //--------------------------------------------------------------------------------------------------
-static void PushFile
+static const char* const StatCounterNames[] =
+{
+    [ADMIN_STAT_RECEIVED]               = "received",
+    [ADMIN_STAT_ACCEPTED]               = "accepted",
+    [ADMIN_STAT_DROPPED_LIMIT]          = "dropped (limits)",
+    [ADMIN_STAT_DROPPED_CHANGE_BY]      = "dropped (changeBy)",
+    [ADMIN_STAT_DROPPED_MIN_PERIOD]     = "dropped (minPeriod)",
+    [ADMIN_STAT_DROPPED_OVERRIDE]       = "dropped (override)",
+    [ADMIN_STAT_DROPPED_UPDATING]       = "dropped (updating)",
+    [ADMIN_STAT_DROPPED_MISMATCH]       = "dropped (type/units mismatch)",
+    [ADMIN_STAT_DROPPED_NO_MEMORY]      = "dropped (out of memory)",
+    [ADMIN_STAT_COERCIONS]              = "type conversions",
+    [ADMIN_STAT_EXTRACTION_FAILURES]    = "JSON extraction failures",
+    [ADMIN_STAT_HANDLER_CALLS]          = "push handler calls",
+    [ADMIN_STAT_BUFFER_EVICTIONS]       = "buffer evictions",
+    [ADMIN_STAT_DROPPED_OVERFLOW]       = "dropped (stream overflow)",
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get one of the runtime statistics counters of a resource.
+ *
+ * @return The value of the counter, or 0 if the entry is not a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t GetStatCounter
 (
-    void
+    const char* path,
+    admin_StatCounter_t counter
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_result_t result = LE_FAULT;
-    char dataFileBuffer[IO_MAX_STRING_VALUE_LEN] = {0};
-    size_t fileSize;
+    uint32_t value = 0;
 
-    if (ValueArg == NULL)
+    if (admin_GetStatCounter(path, counter, &value) != LE_OK)
     {
-        fprintf(stderr, "Missing FILE_PATH argument.\n");
-        exit(EXIT_FAILURE);
+        return 0;
     }
 
-    result = le_fs_GetSize(ValueArg, &fileSize);
-    if (result == LE_OK)
-    {
-        if (fileSize > IO_MAX_STRING_VALUE_LEN)
-        {
-            result = LE_OVERFLOW;
-            fprintf(stderr, "Error '%s' too big to be loaded\n", ValueArg);
-            exit(EXIT_FAILURE);
-        }
-        else
-        {
-            le_fs_FileRef_t fileRef;
-            result = le_fs_Open(ValueArg, LE_FS_RDONLY, &fileRef);
-            if (result == LE_OK)
-            {
-                result = le_fs_Read(fileRef, (uint8_t *)dataFileBuffer, &fileSize);
-                if (result != LE_OK)
-                {
-                    fprintf(stderr, "Error reading file %s (%s)\n", ValueArg, LE_RESULT_TXT(result));
-                    exit(EXIT_FAILURE);
-                }
+    return value;
+}
 
-                result = le_fs_Close(fileRef);
-                if (result != LE_OK)
-                {
-                    fprintf(stderr, "Error closing file %s (%s)\n", ValueArg, LE_RESULT_TXT(result));
-                    exit(EXIT_FAILURE);
-                }
-            }
-        }
-    }
-    else
-    {
-        fprintf(stderr, "Error failed to get file size %s (%s)\n", ValueArg, LE_RESULT_TXT(result));
-        exit(EXIT_FAILURE);
-    }
 
-    if (UseJsonFormat)
-    {
-        admin_PushJson(PathArg, IO_NOW, dataFileBuffer);
-    }
-    else
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the total number of samples dropped by a resource, for any reason.
+ *
+ * @return The number of samples.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t GetDroppedCount
+(
+    const char* path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t total = 0;
+
+    for (admin_StatCounter_t counter = ADMIN_STAT_DROPPED_LIMIT;
+         counter <= ADMIN_STAT_DROPPED_NO_MEMORY;
+         counter++)
     {
-        admin_PushString(PathArg, IO_NOW, dataFileBuffer);
+        total += GetStatCounter(path, counter);
     }
+
+    return total;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Set the default value of a resource.
+ * Print all the runtime statistics counters of a resource.
  */
 //--------------------------------------------------------------------------------------------------
-static void Push
+static void PrintResourceStats
 (
-    void
+    const char* path
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (PathArg == NULL)
+    for (size_t i = 0; i < NUM_ARRAY_MEMBERS(StatCounterNames); i++)
     {
-        fprintf(stderr, "Missing PATH argument.\n");
-        exit(EXIT_FAILURE);
+        uint32_t value;
+
+        if (admin_GetStatCounter(path, (admin_StatCounter_t)i, &value) != LE_OK)
+        {
+            fprintf(stderr, "No resource at path '%s'.\n", path);
+            exit(EXIT_FAILURE);
+        }
+
+        printf("%s: %u\n", StatCounterNames[i], value);
     }
-
-    if (ReadFromFile)
-    {
-        PushFile();
-    }
-    // If no value was specified, push a trigger.
-    else if (ValueArg == NULL)
-    {
-        admin_PushTrigger(PathArg, IO_NOW);
-    }
-    else if (UseJsonFormat)
-    {
-        admin_PushJson(PathArg, IO_NOW, ValueArg);
-    }
-    else if (strcmp("true", ValueArg) == 0)
-    {
-        admin_PushBoolean(PathArg, IO_NOW, true);
-    }
-    else if (strcmp("false", ValueArg) == 0)
-    {
-        admin_PushBoolean(PathArg, IO_NOW, false);
-    }
-    else
-    {
-        // Try parsing as a number.
-        double number = ParseDouble(ValueArg);
-        if (errno == 0)
-        {
-            admin_PushNumeric(PathArg, IO_NOW, number);
-        }
-        // If that didn't work, if it's valid JSON, push it as JSON.
-        else if (json_IsValid(ValueArg))
-        {
-            admin_PushJson(PathArg, IO_NOW, ValueArg);
-        }
-        // Otherwise, treat as a string.
-        else
-        {
-            admin_PushString(PathArg, IO_NOW, ValueArg);
-        }
-    }
-}
+}
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Print the override value of a given resource.
+ * One of the hottest resources found so far by the 'stats' command.
  */
 //--------------------------------------------------------------------------------------------------
-static void GetOverride
-(
-    const char* path
-)
-//--------------------------------------------------------------------------------------------------
+typedef struct
 {
-    if (admin_HasOverride(PathArg))
-    {
-        PrintOverride(PathArg);
-        putchar('\n');
-    }
+    uint32_t received;                          ///< Number of samples received.
+    char path[IO_MAX_RESOURCE_PATH_LEN + 1];    ///< Absolute path of the resource.
 }
+HotResource_t;
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Set the override for a resource.
+ * Walk a branch of the resource tree, keeping track of the resources that received the most
+ * samples.
  */
 //--------------------------------------------------------------------------------------------------
-static void SetOverride
+static void FindHottest
 (
     const char* path,
-    const char* value
+    HotResource_t* hottestPtr,  ///< [INOUT] Hottest resources so far, hottest first.
+    size_t maxCount,            ///< Maximum number of entries in the hottest list.
+    size_t* countPtr            ///< [INOUT] Number of entries in the hottest list.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    SetSetting(path,
-               value,
-               admin_SetBooleanOverride,
-               admin_SetNumericOverride,
-               admin_SetStringOverride,
-               admin_SetJsonOverride);
+    uint32_t received;
+
+    if (admin_GetStatCounter(path, ADMIN_STAT_RECEIVED, &received) == LE_OK)
+    {
+        // Insertion sort, with the coldest entry falling off the end of a full list.
+        size_t i = *countPtr;
+
+        if ((i < maxCount) || (received > hottestPtr[maxCount - 1].received))
+        {
+            if (i == maxCount)
+            {
+                i--;
+            }
+            else
+            {
+                (*countPtr)++;
+            }
+
+            while ((i > 0) && (hottestPtr[i - 1].received < received))
+            {
+                hottestPtr[i] = hottestPtr[i - 1];
+                i--;
+            }
+
+            hottestPtr[i].received = received;
+            LE_ASSERT(le_utf8_Copy(hottestPtr[i].path,
+                                   path,
+                                   sizeof(hottestPtr[i].path),
+                                   NULL) == LE_OK);
+        }
+    }
+
+    char childPath[IO_MAX_RESOURCE_PATH_LEN + 1];
+
+    le_result_t result = admin_GetFirstChild(path, childPath, sizeof(childPath));
+    LE_ASSERT(result != LE_OVERFLOW);
+
+    while (result == LE_OK)
+    {
+        FindHottest(childPath, hottestPtr, maxCount, countPtr);
+
+        result = admin_GetNextSibling(childPath, childPath, sizeof(childPath));
+
+        LE_ASSERT(result != LE_OVERFLOW);
+    }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Call-back function that gets called whenever a watched resource receives an update to its current
- * value.
+ * Print the resources under a given path that received the most samples, hottest first.
  */
 //--------------------------------------------------------------------------------------------------
-static void PushHandler
+static void PrintHottest
 (
-    double timestamp,
-    const char* value,
-    void* contextPtr
+    const char* path,
+    size_t maxCount
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (UseJsonFormat)
-    {
-        printf("{ \"ts\": %lf, \"val\": %s }\n", timestamp, value);
-    }
-    else
-    {
-        time_t seconds = (size_t)timestamp;
-        size_t milliseconds = (timestamp - seconds) * 1000;
+    HotResource_t* hottestPtr = calloc(maxCount, sizeof(HotResource_t));
+    size_t count = 0;
 
-        char timeStr[64];
-        ctime_r(&seconds, timeStr);  // Will write up to 26 bytes into timeStr.
-
-        // Get rid of the newline at the end of the time string.
-        char* newlinePtr = strchr(timeStr, '\n');
-        *newlinePtr = '\0';
-
-        // Get a pointer to the year.
-        char* yearPtr = newlinePtr - 4;
+    LE_ASSERT(hottestPtr != NULL);
 
-        // Terminate the time string after the seconds.
-        *(yearPtr - 1) = '\0';
+    FindHottest(path, hottestPtr, maxCount, &count);
 
-        printf("%s.%-3zu %s: %s\n", timeStr, milliseconds, yearPtr, value);
+    printf("%10s %10s %10s  %s\n", "received", "accepted", "dropped", "path");
+    for (size_t i = 0; i < count; i++)
+    {
+        printf("%10u %10u %10u  %s\n",
+               hottestPtr[i].received,
+               GetStatCounter(hottestPtr[i].path, ADMIN_STAT_ACCEPTED),
+               GetDroppedCount(hottestPtr[i].path),
+               hottestPtr[i].path);
     }
+
+    free(hottestPtr);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Watch a resource for updates to its current value.
+ * Perform the 'stats' command.
  */
 //--------------------------------------------------------------------------------------------------
-static void Watch
+static void Stats
 (
     void
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (UseJsonFormat)
+    admin_EntryType_t entryType = admin_GetEntryType(PathArg);
+
+    if (entryType == ADMIN_ENTRY_TYPE_NONE)
     {
-        admin_AddJsonPushHandler(PathArg, PushHandler, NULL);
+        fprintf(stderr, "No resource at path '%s'.\n", PathArg);
+        exit(EXIT_FAILURE);
+    }
+
+    if (ResetStatsFlag)
+    {
+        if (admin_ResetStats(PathArg) != LE_OK)
+        {
+            fprintf(stderr, "'%s' is not a resource.\n", PathArg);
+            exit(EXIT_FAILURE);
+        }
+    }
+    else if (TopCount < 0)
+    {
+        fprintf(stderr, "The number of resources to list must be positive.\n");
+        exit(EXIT_FAILURE);
+    }
+    else if ((TopCount > 0) || (entryType == ADMIN_ENTRY_TYPE_NAMESPACE))
+    {
+        PrintHottest(PathArg, (TopCount > 0) ? TopCount : DEFAULT_TOP_COUNT);
     }
     else
     {
-        admin_AddStringPushHandler(PathArg, PushHandler, NULL);
+        PrintResourceStats(PathArg);
     }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Perform validity check on an absolute resource path.
+ * Get the name of a pool as it is known in the .cdef, i.e., without its component name prefix.
  *
- * @return Pointer to the validated path.
+ * @return Pointer to the name.
  */
 //--------------------------------------------------------------------------------------------------
-static const char* ValidateAbsolutePath
+static const char* GetPoolCdefName
 (
-    const char* path
+    const char* name
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (path[0] != '/')
-    {
-        fprintf(stderr, "Resource paths must be absolute (i.e., must begin with '/').\n");
-        exit(EXIT_FAILURE);
-    }
+    const char* namePtr = strrchr(name, '.');
 
-    return path;
+    return (namePtr == NULL) ? name : namePtr + 1;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Perform validity check on an Observation path.
- *
- * @return Pointer to the validated path.
+ * Perform the 'pools' command.
  */
 //--------------------------------------------------------------------------------------------------
-static const char* ValidateObservationPath
+static void Pools
 (
-    const char* path
+    void
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (path[0] == '/')
+    char name[ADMIN_MAX_POOL_NAME_LEN + 1];
+    uint32_t objectSize;
+    uint32_t totalBlocks;
+    uint32_t blocksInUse;
+    uint32_t peakBlocks;
+    uint32_t expansions;
+
+    if (HeadroomPercent < 0)
+    {
+        fprintf(stderr, "The headroom must be a positive percentage.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (GenerateCdefFlag)
+    {
+        printf("// Data Hub pool sizes generated by 'dhub pools --cdef' from the peak usage\n"
+               "// observed, plus %d%% headroom.\n"
+               "pools:\n"
+               "{\n",
+               HeadroomPercent);
+    }
+    else
+    {
+        printf("%-32s %8s %8s %8s %8s %10s\n",
+               "pool", "size", "blocks", "in use", "peak", "expansions");
+    }
+
+    for (uint32_t i = 0;
+         admin_GetPoolStats(i,
+                            name,
+                            sizeof(name),
+                            &objectSize,
+                            &totalBlocks,
+                            &blocksInUse,
+                            &peakBlocks,
+                            &expansions) != LE_OUT_OF_RANGE;
+         i++)
     {
-        if (strncmp(path, "/obs/", 5) == 0)
+        if (GenerateCdefFlag)
         {
-            return path;
-        }
+            // Round up, and never size a pool to nothing.
+            uint64_t size = (((uint64_t)peakBlocks * (100 + HeadroomPercent)) + 99) / 100;
 
-        fprintf(stderr, "Observation paths must be relative (not beginning with '/');\n"
-                        "unless they begin with '/obs/'.\n");
-        exit(EXIT_FAILURE);
+            printf("    %s = %" PRIu64 "\n", GetPoolCdefName(name), (size > 0) ? size : 1);
+        }
+        else
+        {
+            printf("%-32s %8u %8u %8u %8u %10u\n",
+                   name, objectSize, totalBlocks, blocksInUse, peakBlocks, expansions);
+        }
     }
 
-    return path;
+    if (GenerateCdefFlag)
+    {
+        printf("}\n");
+    }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Command-line argument handler call-back for a SRC_PATH argument to 'source' command.
+ * Names of the push stages, for the 'trace' command.
  */
 //--------------------------------------------------------------------------------------------------
-static void SrcPathArgHandler
-(
-    const char* arg
-)
-//--------------------------------------------------------------------------------------------------
+static const char* const TraceStageNames[] =
 {
-    SrcPathArg = ValidateAbsolutePath(arg);
-}
+    [ADMIN_TRACE_STAGE_TOTAL]           = "total",
+    [ADMIN_TRACE_STAGE_EXTRACTION]      = "JSON extraction",
+    [ADMIN_TRACE_STAGE_FILTERING]       = "filtering",
+    [ADMIN_TRACE_STAGE_BUFFERING]       = "buffering",
+    [ADMIN_TRACE_STAGE_COERCION]        = "type conversion",
+    [ADMIN_TRACE_STAGE_FAN_OUT]         = "route fan-out",
+    [ADMIN_TRACE_STAGE_HANDLERS]        = "push handlers",
+    [ADMIN_TRACE_STAGE_DESTINATION]     = "destination handlers",
+};
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Command-line argument handler call-back for a value argument.
+ * Print the latency histogram of each push stage.
  */
 //--------------------------------------------------------------------------------------------------
-static void ValueArgHandler
+static void PrintTraceHistograms
 (
-    const char* arg
+    void
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // It may be hard to tell what type to parse the value argument as until we have finished
-    // parsing the command line, so we don't do anything here, other than record the pointer
-    // to the value string for later.
-    ValueArg = arg;
+    for (size_t stage = 0; stage < NUM_ARRAY_MEMBERS(TraceStageNames); stage++)
+    {
+        uint32_t buckets[ADMIN_TRACE_HISTOGRAM_BUCKETS];
+        size_t bucketCount = NUM_ARRAY_MEMBERS(buckets);
+        uint32_t count;
+        uint64_t totalTime;
+        uint32_t maxTime;
+
+        if (admin_GetPushTraceHistogram((admin_TraceStage_t)stage,
+                                        buckets,
+                                        &bucketCount,
+                                        &count,
+                                        &totalTime,
+                                        &maxTime) != LE_OK)
+        {
+            fprintf(stderr, "Failed to get the histogram of stage '%s'.\n",
+                    TraceStageNames[stage]);
+            exit(EXIT_FAILURE);
+        }
+
+        if (count == 0)
+        {
+            printf("%s: no traced pushes\n", TraceStageNames[stage]);
+            continue;
+        }
+
+        printf("%s: %" PRIu32 " traced pushes, mean %" PRIu64 " us, max %" PRIu32 " us\n",
+               TraceStageNames[stage],
+               count,
+               totalTime / count,
+               maxTime);
+
+        // Bucket 0 is for less than 1 us, bucket i for [2^(i-1), 2^i) us, and the last bucket
+        // also counts anything longer.
+        for (size_t i = 0; i < bucketCount; i++)
+        {
+            if (buckets[i] == 0)
+            {
+                continue;
+            }
+
+            char range[32];
+            if (i == 0)
+            {
+                snprintf(range, sizeof(range), "< 1 us");
+            }
+            else if (i == (bucketCount - 1))
+            {
+                snprintf(range, sizeof(range), ">= %lu us", 1UL << (i - 1));
+            }
+            else
+            {
+                snprintf(range, sizeof(range), "%lu-%lu us", 1UL << (i - 1), 1UL << i);
+            }
+
+            printf("    %16s %10" PRIu32 "\n", range, buckets[i]);
+        }
+    }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Command-line argument handler call-back for a PATH argument.
+ * Perform the 'trace' command.
  */
 //--------------------------------------------------------------------------------------------------
-static void PathArgHandler
+static void Trace
 (
-    const char* arg
+    void
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (Action == ACTION_WATCH)
-    {
-        PathArg = ValidateAbsolutePath(arg);
-        return;
-    }
-    else if (Action == ACTION_PUSH)
+    switch (TraceCommand)
     {
-        PathArg = ValidateAbsolutePath(arg);
-
-        // PATH arg is followed by an optional VALUE arg.
-        le_arg_AddPositionalCallback(ValueArgHandler);
-        le_arg_AllowLessPositionalArgsThanCallbacks();
+        case TRACE_PRINT:
 
-        return;
-    }
+            PrintTraceHistograms();
+            break;
 
-    switch (Object)
-    {
-        case OBJECT_SOURCE:
-        case OBJECT_DEFAULT:
-        case OBJECT_OVERRIDE:
+        case TRACE_ON:
 
-            PathArg = ValidateAbsolutePath(arg);
+            admin_SetPushTracing(TraceSamplePeriod);
             break;
 
-        case OBJECT_MIN_PERIOD:
-        case OBJECT_LOW_LIMIT:
-        case OBJECT_HIGH_LIMIT:
-        case OBJECT_CHANGE_BY:
-        case OBJECT_TRANSFORM:
-        case OBJECT_BUFFER_SIZE:
-        case OBJECT_BACKUP_PERIOD:
-        case OBJECT_JSON_EXTRACTION:
-        case OBJECT_OBSERVATION:
-        case OBJECT_MIN:
-        case OBJECT_MAX:
-        case OBJECT_MEAN:
-        case OBJECT_STD_DEVIATION:
+        case TRACE_OFF:
 
-            PathArg = ValidateObservationPath(arg);
+            admin_SetPushTracing(0);
             break;
 
-        default:
-            LE_FATAL("Object unknown.");
+        case TRACE_RESET:
+
+            admin_ResetPushTraces();
+            break;
     }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Command-line argument handler call-back for the START argument.
+ * Set the default value of a resource.
  */
 //--------------------------------------------------------------------------------------------------
-static void StartArgHandler
+static void SetDefault
 (
-    const char* arg
+    const char* path,
+    const char* value
 )
 //--------------------------------------------------------------------------------------------------
 {
-    StartArg = ParseDouble(arg);
-
-    if (StartArg < 0)
-    {
-        fprintf(stderr, "Start time must be a positive number.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    if (errno != 0)
-    {
-        fprintf(stderr, "Error parsing START argument '%s'.\n"
-                        "Must be a positive number of seconds.\n", arg);
-        exit(EXIT_FAILURE);
-    }
+    SetSetting(path,
+               value,
+               admin_SetBooleanDefault,
+               admin_SetNumericDefault,
+               admin_SetStringDefault,
+               admin_SetJsonDefault);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Command-line argument handler callback for the object type argument (e.g., "source", "default").
+ * Push value of the resource using a local file
  */
 //--------------------------------------------------------------------------------------------------
-static void ObjectTypeArgHandler
+static void PushFile
 (
-    const char* arg
+    void
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (strcmp(arg, "source") == 0)
+    le_result_t result = LE_FAULT;
+    char dataFileBuffer[IO_MAX_STRING_VALUE_LEN] = {0};
+    size_t fileSize;
+
+    if (ValueArg == NULL)
     {
-        Object = OBJECT_SOURCE;
+        fprintf(stderr, "Missing FILE_PATH argument.\n");
+        exit(EXIT_FAILURE);
     }
-    else if (strcmp(arg, "default") == 0)
+
+    result = le_fs_GetSize(ValueArg, &fileSize);
+    if (result == LE_OK)
     {
-        Object = OBJECT_DEFAULT;
+        if (fileSize > IO_MAX_STRING_VALUE_LEN)
+        {
+            result = LE_OVERFLOW;
+            fprintf(stderr, "Error '%s' too big to be loaded\n", ValueArg);
+            exit(EXIT_FAILURE);
+        }
+        else
+        {
+            le_fs_FileRef_t fileRef;
+            result = le_fs_Open(ValueArg, LE_FS_RDONLY, &fileRef);
+            if (result == LE_OK)
+            {
+                result = le_fs_Read(fileRef, (uint8_t *)dataFileBuffer, &fileSize);
+                if (result != LE_OK)
+                {
+                    fprintf(stderr, "Error reading file %s (%s)\n", ValueArg, LE_RESULT_TXT(result));
+                    exit(EXIT_FAILURE);
+                }
+
+                result = le_fs_Close(fileRef);
+                if (result != LE_OK)
+                {
+                    fprintf(stderr, "Error closing file %s (%s)\n", ValueArg, LE_RESULT_TXT(result));
+                    exit(EXIT_FAILURE);
+                }
+            }
+        }
     }
-    else if (strcmp(arg, "override") == 0)
+    else
     {
-        Object = OBJECT_OVERRIDE;
+        fprintf(stderr, "Error failed to get file size %s (%s)\n", ValueArg, LE_RESULT_TXT(result));
+        exit(EXIT_FAILURE);
     }
-    else if (strcmp(arg, "minPeriod") == 0)
+
+    if (UseJsonFormat)
     {
-        Object = OBJECT_MIN_PERIOD;
+        admin_PushJson(PathArg, IO_NOW, dataFileBuffer);
     }
-    else if (strcmp(arg, "lowLimit") == 0)
+    else
     {
-        Object = OBJECT_LOW_LIMIT;
+        admin_PushString(PathArg, IO_NOW, dataFileBuffer);
     }
-    else if (strcmp(arg, "highLimit") == 0)
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the default value of a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Push
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (PathArg == NULL)
     {
-        Object = OBJECT_HIGH_LIMIT;
+        fprintf(stderr, "Missing PATH argument.\n");
+        exit(EXIT_FAILURE);
     }
-    else if (strcmp(arg, "changeBy") == 0)
+
+    if (ReadFromFile)
     {
-        Object = OBJECT_CHANGE_BY;
+        PushFile();
     }
-    else if (strcmp(arg, "transform") == 0)
+    // If no value was specified, push a trigger.
+    else if (ValueArg == NULL)
     {
-        Object = OBJECT_TRANSFORM;
+        admin_PushTrigger(PathArg, IO_NOW);
     }
-    else if (strcmp(arg, "bufferSize") == 0)
+    else if (UseJsonFormat)
     {
-        Object = OBJECT_BUFFER_SIZE;
+        admin_PushJson(PathArg, IO_NOW, ValueArg);
     }
-    else if (strcmp(arg, "backupPeriod") == 0)
+    else if (strcmp("true", ValueArg) == 0)
     {
-        Object = OBJECT_BACKUP_PERIOD;
+        admin_PushBoolean(PathArg, IO_NOW, true);
     }
-    else if (strcmp(arg, "jsonExtraction") == 0)
+    else if (strcmp("false", ValueArg) == 0)
     {
-        Object = OBJECT_JSON_EXTRACTION;
+        admin_PushBoolean(PathArg, IO_NOW, false);
     }
-    else if ((strcmp(arg, "obs") == 0) || (strcmp(arg, "observation") == 0))
+    else
     {
-        Object = OBJECT_OBSERVATION;
+        // Try parsing as a number.
+        double number = ParseDouble(ValueArg);
+        if (errno == 0)
+        {
+            admin_PushNumeric(PathArg, IO_NOW, number);
+        }
+        // If that didn't work, if it's valid JSON, push it as JSON.
+        else if (json_IsValid(ValueArg))
+        {
+            admin_PushJson(PathArg, IO_NOW, ValueArg);
+        }
+        // Otherwise, treat as a string.
+        else
+        {
+            admin_PushString(PathArg, IO_NOW, ValueArg);
+        }
     }
-    else if (strcmp(arg, "min") == 0)
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the override value of a given resource.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetOverride
+(
+    const char* path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (admin_HasOverride(PathArg))
     {
-        Object = OBJECT_MIN;
+        PrintOverride(PathArg);
+        putchar('\n');
     }
-    else if (strcmp(arg, "max") == 0)
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the override for a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetOverride
+(
+    const char* path,
+    const char* value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    SetSetting(path,
+               value,
+               admin_SetBooleanOverride,
+               admin_SetNumericOverride,
+               admin_SetStringOverride,
+               admin_SetJsonOverride);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call-back function that gets called whenever a watched resource receives an update to its current
+ * value.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushHandler
+(
+    double timestamp,
+    const char* value,
+    void* contextPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (UseJsonFormat)
     {
-        Object = OBJECT_MAX;
+        printf("{ \"ts\": %lf, \"val\": %s }\n", timestamp, value);
     }
-    else if (strcmp(arg, "mean") == 0)
+    else
     {
-        Object = OBJECT_MEAN;
+        time_t seconds = (size_t)timestamp;
+        size_t milliseconds = (timestamp - seconds) * 1000;
+
+        char timeStr[64];
+        ctime_r(&seconds, timeStr);  // Will write up to 26 bytes into timeStr.
+
+        // Get rid of the newline at the end of the time string.
+        char* newlinePtr = strchr(timeStr, '\n');
+        *newlinePtr = '\0';
+
+        // Get a pointer to the year.
+        char* yearPtr = newlinePtr - 4;
+
+        // Terminate the time string after the seconds.
+        *(yearPtr - 1) = '\0';
+
+        printf("%s.%-3zu %s: %s\n", timeStr, milliseconds, yearPtr, value);
     }
-    else if (strcmp(arg, "stddev") == 0)
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Watch a resource for updates to its current value.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Watch
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (UseJsonFormat)
     {
-        Object = OBJECT_STD_DEVIATION;
+        admin_AddJsonPushHandler(PathArg, PushHandler, NULL);
     }
     else
     {
-        fprintf(stderr, "Unknown object type '%s'.\n", arg);
-        exit(EXIT_FAILURE);
+        admin_AddStringPushHandler(PathArg, PushHandler, NULL);
     }
+}
 
-    // Expect a mandatory PATH argument.
-    le_arg_AddPositionalCallback(PathArgHandler);
 
-    // If the action is "set", then also expect another argument after that.
-    if (Action == ACTION_SET)
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a resource path is absolute, reporting an error on stderr if it isn't.
+ *
+ * @return true if the path is absolute.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsAbsolutePath
+(
+    const char* path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (path[0] != '/')
     {
-        if (Object == OBJECT_SOURCE)
-        {
-            // The "set source" command needs the SRC_PATH.
-            le_arg_AddPositionalCallback(SrcPathArgHandler);
-        }
-        else if (Object == OBJECT_OBSERVATION)
-        {
-            fprintf(stderr, "Can't 'set' an Observation.\n");
+        fprintf(stderr, "Resource paths must be absolute (i.e., must begin with '/').\n");
+        return false;
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Perform validity check on an absolute resource path.
+ *
+ * @return Pointer to the validated path.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* ValidateAbsolutePath
+(
+    const char* path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!IsAbsolutePath(path))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    return path;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a path is a valid Observation path, reporting an error on stderr if it isn't.
+ *
+ * @return true if the path is valid.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsObservationPath
+(
+    const char* path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((path[0] == '/') && (strncmp(path, "/obs/", 5) != 0))
+    {
+        fprintf(stderr, "Observation paths must be relative (not beginning with '/');\n"
+                        "unless they begin with '/obs/'.\n");
+        return false;
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Perform validity check on an Observation path.
+ *
+ * @return Pointer to the validated path.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* ValidateObservationPath
+(
+    const char* path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!IsObservationPath(path))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    return path;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a PATH argument is valid for the type of object acted on, reporting an error on
+ * stderr if it isn't.
+ *
+ * @return true if the path is valid.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsValidObjectPath
+(
+    const char* path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    switch (Object)
+    {
+        case OBJECT_SOURCE:
+        case OBJECT_DEFAULT:
+        case OBJECT_OVERRIDE:
+
+            return IsAbsolutePath(path);
+
+        default:
+
+            return IsObservationPath(path);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command-line argument handler call-back for a SRC_PATH argument to 'source' command.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SrcPathArgHandler
+(
+    const char* arg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    SrcPathArg = ValidateAbsolutePath(arg);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command-line argument handler call-back for a value argument.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ValueArgHandler
+(
+    const char* arg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // It may be hard to tell what type to parse the value argument as until we have finished
+    // parsing the command line, so we don't do anything here, other than record the pointer
+    // to the value string for later.
+    ValueArg = arg;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command-line argument handler call-back for a PATH argument.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PathArgHandler
+(
+    const char* arg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((Action == ACTION_WATCH) || (Action == ACTION_STATS))
+    {
+        PathArg = ValidateAbsolutePath(arg);
+        return;
+    }
+    else if (Action == ACTION_PUSH)
+    {
+        PathArg = ValidateAbsolutePath(arg);
+
+        // PATH arg is followed by an optional VALUE arg.
+        le_arg_AddPositionalCallback(ValueArgHandler);
+        le_arg_AllowLessPositionalArgsThanCallbacks();
+
+        return;
+    }
+
+    switch (Object)
+    {
+        case OBJECT_SOURCE:
+        case OBJECT_DEFAULT:
+        case OBJECT_OVERRIDE:
+
+            PathArg = ValidateAbsolutePath(arg);
+            break;
+
+        case OBJECT_MIN_PERIOD:
+        case OBJECT_LOW_LIMIT:
+        case OBJECT_HIGH_LIMIT:
+        case OBJECT_CHANGE_BY:
+        case OBJECT_TRANSFORM:
+        case OBJECT_BUFFER_SIZE:
+        case OBJECT_BACKUP_PERIOD:
+        case OBJECT_SPILL_SIZE:
+        case OBJECT_BUFFER_PRECISION:
+        case OBJECT_JSON_EXTRACTION:
+        case OBJECT_OBSERVATION:
+        case OBJECT_MIN:
+        case OBJECT_MAX:
+        case OBJECT_MEAN:
+        case OBJECT_STD_DEVIATION:
+        case OBJECT_STATS:
+
+            PathArg = ValidateObservationPath(arg);
+            break;
+
+        default:
+            LE_FATAL("Object unknown.");
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command-line argument handler call-back for the START argument.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartArgHandler
+(
+    const char* arg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    StartArg = ParseDouble(arg);
+
+    if (StartArg < 0)
+    {
+        fprintf(stderr, "Start time must be a positive number.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (errno != 0)
+    {
+        fprintf(stderr, "Error parsing START argument '%s'.\n"
+                        "Must be a positive number of seconds.\n", arg);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command-line argument handler callback for the PERIOD argument of 'trace on'.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TracePeriodArgHandler
+(
+    const char* arg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char* endPtr;
+
+    errno = 0;
+    unsigned long period = strtoul(arg, &endPtr, 10);
+
+    if ((errno != 0) || (*endPtr != '\0') || (arg[0] == '-') || (period == 0)
+        || (period > UINT32_MAX))
+    {
+        fprintf(stderr, "Error parsing PERIOD argument '%s'.\n"
+                        "Must be a positive number of pushes.\n", arg);
+        exit(EXIT_FAILURE);
+    }
+
+    TraceSamplePeriod = (uint32_t)period;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command-line argument handler callback for the argument of the 'trace' command.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TraceCommandArgHandler
+(
+    const char* arg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (strcmp(arg, "on") == 0)
+    {
+        TraceCommand = TRACE_ON;
+
+        // Accept an optional PERIOD argument.
+        le_arg_AddPositionalCallback(TracePeriodArgHandler);
+    }
+    else if (strcmp(arg, "off") == 0)
+    {
+        TraceCommand = TRACE_OFF;
+    }
+    else if (strcmp(arg, "reset") == 0)
+    {
+        TraceCommand = TRACE_RESET;
+    }
+    else
+    {
+        fprintf(stderr, "Unknown trace command '%s'.\n", arg);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the Object from its name (e.g., "source", "default").
+ *
+ * @return true if successful, false if the name is not a known object type.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ParseObjectType
+(
+    const char* name
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (strcmp(name, "source") == 0)
+    {
+        Object = OBJECT_SOURCE;
+    }
+    else if (strcmp(name, "default") == 0)
+    {
+        Object = OBJECT_DEFAULT;
+    }
+    else if (strcmp(name, "override") == 0)
+    {
+        Object = OBJECT_OVERRIDE;
+    }
+    else if (strcmp(name, "minPeriod") == 0)
+    {
+        Object = OBJECT_MIN_PERIOD;
+    }
+    else if (strcmp(name, "lowLimit") == 0)
+    {
+        Object = OBJECT_LOW_LIMIT;
+    }
+    else if (strcmp(name, "highLimit") == 0)
+    {
+        Object = OBJECT_HIGH_LIMIT;
+    }
+    else if (strcmp(name, "changeBy") == 0)
+    {
+        Object = OBJECT_CHANGE_BY;
+    }
+    else if (strcmp(name, "transform") == 0)
+    {
+        Object = OBJECT_TRANSFORM;
+    }
+    else if (strcmp(name, "bufferSize") == 0)
+    {
+        Object = OBJECT_BUFFER_SIZE;
+    }
+    else if (strcmp(name, "backupPeriod") == 0)
+    {
+        Object = OBJECT_BACKUP_PERIOD;
+    }
+    else if (strcmp(name, "spillSize") == 0)
+    {
+        Object = OBJECT_SPILL_SIZE;
+    }
+    else if (strcmp(name, "bufferPrecision") == 0)
+    {
+        Object = OBJECT_BUFFER_PRECISION;
+    }
+    else if (strcmp(name, "jsonExtraction") == 0)
+    {
+        Object = OBJECT_JSON_EXTRACTION;
+    }
+    else if ((strcmp(name, "obs") == 0) || (strcmp(name, "observation") == 0))
+    {
+        Object = OBJECT_OBSERVATION;
+    }
+    else if (strcmp(name, "min") == 0)
+    {
+        Object = OBJECT_MIN;
+    }
+    else if (strcmp(name, "max") == 0)
+    {
+        Object = OBJECT_MAX;
+    }
+    else if (strcmp(name, "mean") == 0)
+    {
+        Object = OBJECT_MEAN;
+    }
+    else if (strcmp(name, "stddev") == 0)
+    {
+        Object = OBJECT_STD_DEVIATION;
+    }
+    else if (strcmp(name, "stats") == 0)
+    {
+        Object = OBJECT_STATS;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command-line argument handler callback for the object type argument (e.g., "source", "default").
+ */
+//--------------------------------------------------------------------------------------------------
+static void ObjectTypeArgHandler
+(
+    const char* arg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!ParseObjectType(arg))
+    {
+        fprintf(stderr, "Unknown object type '%s'.\n", arg);
+        exit(EXIT_FAILURE);
+    }
+
+    // Expect a mandatory PATH argument.
+    le_arg_AddPositionalCallback(PathArgHandler);
+
+    // If the action is "set", then also expect another argument after that.
+    if (Action == ACTION_SET)
+    {
+        if (Object == OBJECT_SOURCE)
+        {
+            // The "set source" command needs the SRC_PATH.
+            le_arg_AddPositionalCallback(SrcPathArgHandler);
+        }
+        else if (Object == OBJECT_OBSERVATION)
+        {
+            fprintf(stderr, "Can't 'set' an Observation.\n");
             exit(EXIT_FAILURE);
         }
         else if (   (Object == OBJECT_MIN)
                  || (Object == OBJECT_MAX)
                  || (Object == OBJECT_MEAN)
-                 || (Object == OBJECT_STD_DEVIATION)  )
+                 || (Object == OBJECT_STD_DEVIATION)
+                 || (Object == OBJECT_STATS)  )
         {
             fprintf(stderr, "Can't 'set' a buffer statistic.\n");
             exit(EXIT_FAILURE);
         }
         else
         {
-            // Everything else needs a VALUE.
-            le_arg_AddPositionalCallback(ValueArgHandler);
+            // Everything else needs a VALUE.
+            le_arg_AddPositionalCallback(ValueArgHandler);
+        }
+    }
+    else if (Action == ACTION_GET)
+    {
+        // If we are getting a buffer statistic,
+        if (   (Object == OBJECT_MIN)
+            || (Object == OBJECT_MAX)
+            || (Object == OBJECT_MEAN)
+            || (Object == OBJECT_STD_DEVIATION)
+            || (Object == OBJECT_STATS)  )
+        {
+            // Accept an optional START argument.
+            le_arg_AddPositionalCallback(StartArgHandler);
+            le_arg_AllowLessPositionalArgsThanCallbacks();
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command-line argument handler call-back for the FILE argument of the 'batch' command.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BatchFileArgHandler
+(
+    const char* arg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    BatchFileArg = arg;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command-line argument handler call-back for the first positional argument, which is the command.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CommandArgHandler
+(
+    const char* arg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (strcmp(arg, "help") == 0)
+    {
+        Action = ACTION_HELP;
+    }
+    else if (strcmp(arg, "list") == 0)
+    {
+        Action = ACTION_LIST;
+
+        // Accept an optional PATH argument (default to "/").
+        le_arg_AddPositionalCallback(PathArgHandler);
+        le_arg_AllowLessPositionalArgsThanCallbacks();
+        PathArg = "/";
+    }
+    else if (strcmp(arg, "get") == 0)
+    {
+        Action = ACTION_GET;
+
+        // Expect an object type argument ("source", "default" or "override").
+        le_arg_AddPositionalCallback(ObjectTypeArgHandler);
+    }
+    else if (strcmp(arg, "set") == 0)
+    {
+        Action = ACTION_SET;
+
+        // Expect an object type argument ("source", "default" or "override").
+        le_arg_AddPositionalCallback(ObjectTypeArgHandler);
+    }
+    else if (strcmp(arg, "push") == 0)
+    {
+        Action = ACTION_PUSH;
+
+        // Expect a path argument and  optional :
+        // --json (-j) or --file (-f) flag
+        le_arg_AddPositionalCallback(PathArgHandler);
+        le_arg_SetFlagVar(&UseJsonFormat, "j", "json");
+        le_arg_SetFlagVar(&ReadFromFile, "f", "file");
+    }
+    else if (strcmp(arg, "remove") == 0)
+    {
+        Action = ACTION_REMOVE;
+
+        // Expect an object type argument ("source", "default" or "override").
+        le_arg_AddPositionalCallback(ObjectTypeArgHandler);
+    }
+    else if (strcmp(arg, "watch") == 0)
+    {
+        Action = ACTION_WATCH;
+
+        // Expect a PATH argument and an optional --json argument.
+        le_arg_AddPositionalCallback(PathArgHandler);
+        le_arg_SetFlagVar(&UseJsonFormat, "j", "json");
+    }
+    else if (strcmp(arg, "read") == 0)
+    {
+        Action = ACTION_READ;
+        Object = OBJECT_OBSERVATION;
+
+        // Expect a path argument.
+        le_arg_AddPositionalCallback(PathArgHandler);
+
+        // Accept an optional START argument.
+        le_arg_AddPositionalCallback(StartArgHandler);
+        le_arg_AllowLessPositionalArgsThanCallbacks();
+    }
+    else if (strcmp(arg, "stats") == 0)
+    {
+        Action = ACTION_STATS;
+
+        // Accept an optional PATH argument (default to "/"), and --top (-t) or --reset (-r).
+        le_arg_AddPositionalCallback(PathArgHandler);
+        le_arg_AllowLessPositionalArgsThanCallbacks();
+        PathArg = "/";
+        le_arg_SetIntVar(&TopCount, "t", "top");
+        le_arg_SetFlagVar(&ResetStatsFlag, "r", "reset");
+    }
+    else if (strcmp(arg, "pools") == 0)
+    {
+        Action = ACTION_POOLS;
+
+        // Accept an optional --cdef (-c) flag, and the --headroom (-m) that goes with it.
+        le_arg_SetFlagVar(&GenerateCdefFlag, "c", "cdef");
+        le_arg_SetIntVar(&HeadroomPercent, "m", "headroom");
+    }
+    else if (strcmp(arg, "trace") == 0)
+    {
+        Action = ACTION_TRACE;
+
+        // Accept an optional "on", "off" or "reset" argument.
+        le_arg_AddPositionalCallback(TraceCommandArgHandler);
+        le_arg_AllowLessPositionalArgsThanCallbacks();
+    }
+    else if (strcmp(arg, "batch") == 0)
+    {
+        Action = ACTION_BATCH;
+
+        // Expect a mandatory FILE argument.
+        le_arg_AddPositionalCallback(BatchFileArgHandler);
+    }
+    else
+    {
+        fprintf(stderr, "Unrecognized command '%s'.  Try 'dhub help' for assistance.\n", arg);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read completion callback function.  This gets called when a read operation has completed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadComplete
+(
+    le_result_t result,
+    void* contextPtr ///< Not used.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (result != LE_OK)
+    {
+        fprintf(stderr, "Read operation failed (%s).\n", LE_RESULT_TXT(result));
+        exit(EXIT_FAILURE);
+    }
+
+    putchar('\n');
+    exit(EXIT_SUCCESS);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the Object of the resource at PATH.
+ *
+ * @return LE_OK if successful (errors are reported on stderr).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t Get
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    switch (Object)
+    {
+        case OBJECT_SOURCE:
+
+            PrintSource(PathArg);
+            break;
+
+        case OBJECT_DEFAULT:
+
+            GetDefault(PathArg);
+            break;
+
+        case OBJECT_OVERRIDE:
+
+            GetOverride(PathArg);
+            break;
+
+        case OBJECT_MIN_PERIOD:
+
+            GetDoubleSetting(admin_GetMinPeriod);
+            break;
+
+        case OBJECT_LOW_LIMIT:
+
+            GetDoubleSetting(admin_GetLowLimit);
+            break;
+
+        case OBJECT_HIGH_LIMIT:
+
+            GetDoubleSetting(admin_GetHighLimit);
+            break;
+
+        case OBJECT_CHANGE_BY:
+
+            GetDoubleSetting(admin_GetChangeBy);
+            break;
+
+        case OBJECT_TRANSFORM:
+
+            GetIntegerSetting(admin_GetTransform);
+            break;
+
+        case OBJECT_BUFFER_SIZE:
+
+            GetIntegerSetting(admin_GetBufferMaxCount);
+            break;
+
+        case OBJECT_BACKUP_PERIOD:
+
+            GetIntegerSetting(admin_GetBufferBackupPeriod);
+            break;
+
+        case OBJECT_SPILL_SIZE:
+
+            GetIntegerSetting(admin_GetBufferSpillMaxCount);
+            break;
+
+        case OBJECT_BUFFER_PRECISION:
+
+            printf("%s\n", PrecisionNames[admin_GetBufferPrecision(PathArg)]);
+            break;
+
+        case OBJECT_JSON_EXTRACTION:
+        {
+            char spec[ADMIN_MAX_JSON_EXTRACTOR_LEN];
+            le_result_t result = admin_GetJsonExtraction(PathArg, spec, sizeof(spec));
+            if (result == LE_OK)
+            {
+                printf("%s\n", spec);
+            }
+            else
+            {
+                fprintf(stderr, "%s\n", LE_RESULT_TXT(result));
+            }
+            return result;
         }
+
+        case OBJECT_OBSERVATION:
+
+            fprintf(stderr, "Can't 'get' an Observation.\n");
+            return LE_BAD_PARAMETER;
+
+        case OBJECT_MIN:
+
+            return GetBufferStat(query_GetMin);
+
+        case OBJECT_MAX:
+
+            return GetBufferStat(query_GetMax);
+
+        case OBJECT_MEAN:
+
+            return GetBufferStat(query_GetMean);
+
+        case OBJECT_STD_DEVIATION:
+
+            return GetBufferStat(query_GetStdDev);
+
+        case OBJECT_STATS:
+
+            return GetBufferStats();
     }
-    else if (Action == ACTION_GET)
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the Object of the resource at PATH.  Must be called inside an administrative update.
+ *
+ * @return LE_OK if successful (errors are reported on stderr).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t Set
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    switch (Object)
     {
-        // If we are getting a buffer statistic,
-        if (   (Object == OBJECT_MIN)
-            || (Object == OBJECT_MAX)
-            || (Object == OBJECT_MEAN)
-            || (Object == OBJECT_STD_DEVIATION)  )
-        {
-            // Accept an optional START argument.
-            le_arg_AddPositionalCallback(StartArgHandler);
-            le_arg_AllowLessPositionalArgsThanCallbacks();
-        }
+        case OBJECT_SOURCE:
+
+            return SetSource(PathArg, SrcPathArg);
+
+        case OBJECT_DEFAULT:
+
+            SetDefault(PathArg, ValueArg);
+            break;
+
+        case OBJECT_OVERRIDE:
+
+            SetOverride(PathArg, ValueArg);
+            break;
+
+        case OBJECT_MIN_PERIOD:
+
+            return SetDoubleSetting(PathArg, ValueArg, admin_SetMinPeriod);
+
+        case OBJECT_LOW_LIMIT:
+
+            return SetDoubleSetting(PathArg, ValueArg, admin_SetLowLimit);
+
+        case OBJECT_HIGH_LIMIT:
+
+            return SetDoubleSetting(PathArg, ValueArg, admin_SetHighLimit);
+
+        case OBJECT_CHANGE_BY:
+
+            return SetDoubleSetting(PathArg, ValueArg, admin_SetChangeBy);
+
+        case OBJECT_TRANSFORM:
+
+            return SetTransformSetting(PathArg, ValueArg);
+
+        case OBJECT_BUFFER_SIZE:
+
+            return SetIntegerSetting(PathArg, ValueArg, admin_SetBufferMaxCount);
+
+        case OBJECT_BACKUP_PERIOD:
+
+            return SetIntegerSetting(PathArg, ValueArg, admin_SetBufferBackupPeriod);
+
+        case OBJECT_SPILL_SIZE:
+
+            return SetIntegerSetting(PathArg, ValueArg, admin_SetBufferSpillMaxCount);
+
+        case OBJECT_BUFFER_PRECISION:
+
+            return SetPrecisionSetting(PathArg, ValueArg);
+
+        case OBJECT_JSON_EXTRACTION:
+
+            admin_SetJsonExtraction(PathArg, ValueArg);
+            break;
+
+        case OBJECT_OBSERVATION:
+
+            fprintf(stderr, "Can't 'set' an Observation.\n");
+            return LE_BAD_PARAMETER;
+
+        case OBJECT_MIN:
+        case OBJECT_MAX:
+        case OBJECT_MEAN:
+        case OBJECT_STD_DEVIATION:
+        case OBJECT_STATS:
+
+            fprintf(stderr, "Can't 'set' a buffered data statistic.\n");
+            return LE_BAD_PARAMETER;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the Object of the resource at PATH.  Must be called inside an administrative update.
+ *
+ * @return LE_OK if successful (errors are reported on stderr).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t Remove
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    switch (Object)
+    {
+        case OBJECT_SOURCE:
+
+            admin_RemoveSource(PathArg);
+            break;
+
+        case OBJECT_DEFAULT:
+
+            admin_RemoveDefault(PathArg);
+            break;
+
+        case OBJECT_OVERRIDE:
+
+            admin_RemoveOverride(PathArg);
+            break;
+
+        case OBJECT_MIN_PERIOD:
+
+            admin_SetMinPeriod(PathArg, NAN);
+            break;
+
+        case OBJECT_LOW_LIMIT:
+
+            admin_SetLowLimit(PathArg, NAN);
+            break;
+
+        case OBJECT_HIGH_LIMIT:
+
+            admin_SetHighLimit(PathArg, NAN);
+            break;
+
+        case OBJECT_CHANGE_BY:
+
+            admin_SetChangeBy(PathArg, NAN);
+            break;
+
+        case OBJECT_TRANSFORM:
+
+            admin_SetTransform(PathArg, ADMIN_OBS_TRANSFORM_TYPE_NONE, NULL, 0);
+            break;
+
+        case OBJECT_BUFFER_SIZE:
+        case OBJECT_BACKUP_PERIOD:
+        case OBJECT_SPILL_SIZE:
+
+            fprintf(stderr, "This cannot be removed. Do you mean to set it to zero?\n");
+            return LE_BAD_PARAMETER;
+
+        case OBJECT_BUFFER_PRECISION:
+
+            admin_SetBufferPrecision(PathArg, ADMIN_BUFFER_PRECISION_FULL);
+            break;
+
+        case OBJECT_JSON_EXTRACTION:
+
+            admin_SetJsonExtraction(PathArg, "");
+            break;
+
+        case OBJECT_OBSERVATION:
+
+            admin_DeleteObs(PathArg);
+            break;
+
+        case OBJECT_MIN:
+        case OBJECT_MAX:
+        case OBJECT_MEAN:
+        case OBJECT_STD_DEVIATION:
+        case OBJECT_STATS:
+
+            fprintf(stderr, "Buffered data statistics cannot be removed.\n");
+            return LE_BAD_PARAMETER;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a character is white space in a 'batch' command line.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsBatchSpace
+(
+    char c
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n'));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the next word of a 'batch' command line, and move past it.
+ *
+ * @return Ptr to the (null-terminated) word, or NULL if there are no more words on the line.
+ */
+//--------------------------------------------------------------------------------------------------
+static char* NextBatchWord
+(
+    char** linePtrPtr   ///< [INOUT] Ptr to the rest of the line.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char* wordPtr = *linePtrPtr;
+
+    while (IsBatchSpace(*wordPtr))
+    {
+        wordPtr++;
+    }
+
+    if (*wordPtr == '\0')
+    {
+        *linePtrPtr = wordPtr;
+        return NULL;
+    }
+
+    char* endPtr = wordPtr;
+    while ((*endPtr != '\0') && !IsBatchSpace(*endPtr))
+    {
+        endPtr++;
+    }
+
+    if (*endPtr != '\0')
+    {
+        *endPtr = '\0';
+        endPtr++;
+    }
+    *linePtrPtr = endPtr;
+
+    return wordPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the rest of a 'batch' command line (the VALUE argument), without its leading white space.
+ *
+ * @return Ptr to the rest of the line, or NULL if there isn't anything left on the line.
+ */
+//--------------------------------------------------------------------------------------------------
+static char* RestOfBatchLine
+(
+    char** linePtrPtr   ///< [INOUT] Ptr to the rest of the line.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char* restPtr = *linePtrPtr;
+
+    while (IsBatchSpace(*restPtr))
+    {
+        restPtr++;
     }
+
+    *linePtrPtr = restPtr + strlen(restPtr);
+
+    return (*restPtr == '\0' ? NULL : restPtr);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Command-line argument handler call-back for the first positional argument, which is the command.
+ * Run one line of a 'batch' command file.
+ *
+ * @return LE_OK if successful (errors are reported on stderr).
  */
 //--------------------------------------------------------------------------------------------------
-static void CommandArgHandler
+static le_result_t RunBatchLine
 (
-    const char* arg
+    char* line  ///< The line, without its trailing white space.  Gets modified.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (strcmp(arg, "help") == 0)
+    char* cmd = NextBatchWord(&line);
+
+    // Skip blank lines and comments.
+    if ((cmd == NULL) || (cmd[0] == '#'))
     {
-        Action = ACTION_HELP;
+        return LE_OK;
     }
-    else if (strcmp(arg, "list") == 0)
+
+    // Accept lines copied from a script, that still start with the name of the tool.
+    if (strcmp(cmd, "dhub") == 0)
     {
-        Action = ACTION_LIST;
+        cmd = NextBatchWord(&line);
+        if (cmd == NULL)
+        {
+            fprintf(stderr, "Missing command.\n");
+            return LE_BAD_PARAMETER;
+        }
+    }
 
-        // Accept an optional PATH argument (default to "/").
-        le_arg_AddPositionalCallback(PathArgHandler);
-        le_arg_AllowLessPositionalArgsThanCallbacks();
-        PathArg = "/";
+    PathArg = NULL;
+    SrcPathArg = NULL;
+    ValueArg = NULL;
+    StartArg = NAN;
+
+    if (strcmp(cmd, "push") == 0)
+    {
+        Action = ACTION_PUSH;
     }
-    else if (strcmp(arg, "get") == 0)
+    else if (strcmp(cmd, "get") == 0)
     {
         Action = ACTION_GET;
-
-        // Expect an object type argument ("source", "default" or "override").
-        le_arg_AddPositionalCallback(ObjectTypeArgHandler);
     }
-    else if (strcmp(arg, "set") == 0)
+    else if (strcmp(cmd, "set") == 0)
     {
         Action = ACTION_SET;
-
-        // Expect an object type argument ("source", "default" or "override").
-        le_arg_AddPositionalCallback(ObjectTypeArgHandler);
     }
-    else if (strcmp(arg, "push") == 0)
+    else if (strcmp(cmd, "remove") == 0)
     {
-        Action = ACTION_PUSH;
-
-        // Expect a path argument and  optional :
-        // --json (-j) or --file (-f) flag
-        le_arg_AddPositionalCallback(PathArgHandler);
-        le_arg_SetFlagVar(&UseJsonFormat, "j", "json");
-        le_arg_SetFlagVar(&ReadFromFile, "f", "file");
+        Action = ACTION_REMOVE;
     }
-    else if (strcmp(arg, "remove") == 0)
+    else
     {
-        Action = ACTION_REMOVE;
-
-        // Expect an object type argument ("source", "default" or "override").
-        le_arg_AddPositionalCallback(ObjectTypeArgHandler);
+        fprintf(stderr, "Command '%s' can't be used in a batch.\n", cmd);
+        return LE_BAD_PARAMETER;
     }
-    else if (strcmp(arg, "watch") == 0)
+
+    if (Action != ACTION_PUSH)
     {
-        Action = ACTION_WATCH;
+        const char* objectName = NextBatchWord(&line);
+        if (objectName == NULL)
+        {
+            fprintf(stderr, "Missing OBJECT argument.\n");
+            return LE_BAD_PARAMETER;
+        }
+        if (!ParseObjectType(objectName))
+        {
+            fprintf(stderr, "Unknown object type '%s'.\n", objectName);
+            return LE_BAD_PARAMETER;
+        }
+    }
 
-        // Expect a PATH argument and an optional --json argument.
-        le_arg_AddPositionalCallback(PathArgHandler);
-        le_arg_SetFlagVar(&UseJsonFormat, "j", "json");
+    PathArg = NextBatchWord(&line);
+    if (PathArg == NULL)
+    {
+        fprintf(stderr, "Missing PATH argument.\n");
+        return LE_BAD_PARAMETER;
     }
-    else if (strcmp(arg, "read") == 0)
+    if ((Action == ACTION_PUSH) ? !IsAbsolutePath(PathArg) : !IsValidObjectPath(PathArg))
     {
-        Action = ACTION_READ;
-        Object = OBJECT_OBSERVATION;
+        return LE_BAD_PARAMETER;
+    }
 
-        // Expect a path argument.
-        le_arg_AddPositionalCallback(PathArgHandler);
+    if ((Action == ACTION_SET) && (Object == OBJECT_SOURCE))
+    {
+        SrcPathArg = NextBatchWord(&line);
+        if (SrcPathArg == NULL)
+        {
+            fprintf(stderr, "Missing SRC_PATH argument.\n");
+            return LE_BAD_PARAMETER;
+        }
+        if (!IsAbsolutePath(SrcPathArg))
+        {
+            return LE_BAD_PARAMETER;
+        }
+    }
+    else if ((Action == ACTION_SET) || (Action == ACTION_PUSH))
+    {
+        ValueArg = RestOfBatchLine(&line);
+        if ((ValueArg == NULL) && (Action == ACTION_SET))
+        {
+            fprintf(stderr, "Missing VALUE argument.\n");
+            return LE_BAD_PARAMETER;
+        }
+    }
+    else if (Action == ACTION_GET)
+    {
+        const char* startStr = NextBatchWord(&line);
+        if (startStr != NULL)
+        {
+            StartArg = ParseDouble(startStr);
+            if (errno != 0)
+            {
+                fprintf(stderr, "START must be a number ('%s' is not).\n", startStr);
+                return LE_BAD_PARAMETER;
+            }
+        }
+    }
 
-        // Accept an optional START argument.
-        le_arg_AddPositionalCallback(StartArgHandler);
-        le_arg_AllowLessPositionalArgsThanCallbacks();
+    if (NextBatchWord(&line) != NULL)
+    {
+        fprintf(stderr, "Too many arguments.\n");
+        return LE_BAD_PARAMETER;
     }
-    else
+
+    switch (Action)
     {
-        fprintf(stderr, "Unrecognized command '%s'.  Try 'dhub help' for assistance.\n", arg);
-        exit(EXIT_FAILURE);
+        case ACTION_PUSH:
+
+            Push();
+            return LE_OK;
+
+        case ACTION_GET:
+
+            return Get();
+
+        case ACTION_SET:
+
+            return Set();
+
+        default:
+
+            return Remove();
     }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Read completion callback function.  This gets called when a read operation has completed.
+ * Run the commands listed in the FILE argument of the 'batch' command, inside a single
+ * administrative update.  Exits with EXIT_FAILURE if any of them failed.
  */
 //--------------------------------------------------------------------------------------------------
-static void ReadComplete
+static void Batch
 (
-    le_result_t result,
-    void* contextPtr ///< Not used.
+    void
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (result != LE_OK)
+    // Too big for the stack.
+    static char line[BATCH_MAX_LINE_LEN + 1];
+
+    if (BatchFileArg == NULL)
     {
-        fprintf(stderr, "Read operation failed (%s).\n", LE_RESULT_TXT(result));
+        fprintf(stderr, "Missing FILE argument.\n");
         exit(EXIT_FAILURE);
     }
 
-    putchar('\n');
-    exit(EXIT_SUCCESS);
+    bool isStdin = (strcmp(BatchFileArg, "-") == 0);
+    const char* fileName = (isStdin ? "stdin" : BatchFileArg);
+
+    FILE* filePtr = (isStdin ? stdin : fopen(BatchFileArg, "r"));
+    if (filePtr == NULL)
+    {
+        fprintf(stderr, "Can't open '%s' (%m).\n", BatchFileArg);
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned int lineCount = 0;
+    unsigned int failureCount = 0;
+
+    admin_StartUpdate();
+
+    while (fgets(line, sizeof(line), filePtr) != NULL)
+    {
+        lineCount++;
+
+        size_t len = strlen(line);
+
+        if ((len == (sizeof(line) - 1)) && (line[len - 1] != '\n'))
+        {
+            // Skip the rest of the line.
+            int c;
+            do
+            {
+                c = fgetc(filePtr);
+            }
+            while ((c != '\n') && (c != EOF));
+
+            fprintf(stderr, "%s:%u: Line too long.\n", fileName, lineCount);
+            failureCount++;
+            continue;
+        }
+
+        while ((len > 0) && IsBatchSpace(line[len - 1]))
+        {
+            len--;
+        }
+        line[len] = '\0';
+
+        if (RunBatchLine(line) != LE_OK)
+        {
+            fprintf(stderr, "%s:%u: Failed.\n", fileName, lineCount);
+            failureCount++;
+        }
+    }
+
+    admin_EndUpdate();
+
+    if (!isStdin)
+    {
+        fclose(filePtr);
+    }
+
+    if (failureCount > 0)
+    {
+        fprintf(stderr, "%u of %u lines failed.\n", failureCount, lineCount);
+        exit(EXIT_FAILURE);
+    }
 }
 
 
@@ -1986,6 +3624,8 @@ COMPONENT_INIT
 
     ConnectToDataHub();
 
+    le_result_t result;
+
     switch (Action)
     {
         case ACTION_HELP:
@@ -2000,98 +3640,9 @@ COMPONENT_INIT
 
         case ACTION_GET:
 
-            switch (Object)
+            if (Get() != LE_OK)
             {
-                case OBJECT_SOURCE:
-
-                    PrintSource(PathArg);
-                    break;
-
-                case OBJECT_DEFAULT:
-
-                    GetDefault(PathArg);
-                    break;
-
-                case OBJECT_OVERRIDE:
-
-                    GetOverride(PathArg);
-                    break;
-
-                case OBJECT_MIN_PERIOD:
-
-                    GetDoubleSetting(admin_GetMinPeriod);
-                    break;
-
-                case OBJECT_LOW_LIMIT:
-
-                    GetDoubleSetting(admin_GetLowLimit);
-                    break;
-
-                case OBJECT_HIGH_LIMIT:
-
-                    GetDoubleSetting(admin_GetHighLimit);
-                    break;
-
-                case OBJECT_CHANGE_BY:
-
-                    GetDoubleSetting(admin_GetChangeBy);
-                    break;
-
-                case OBJECT_TRANSFORM:
-
-                    GetIntegerSetting(admin_GetTransform);
-                    break;
-
-                case OBJECT_BUFFER_SIZE:
-
-                    GetIntegerSetting(admin_GetBufferMaxCount);
-                    break;
-
-                case OBJECT_BACKUP_PERIOD:
-
-                    GetIntegerSetting(admin_GetBufferBackupPeriod);
-                    break;
-
-                case OBJECT_JSON_EXTRACTION:
-                {
-                    char spec[ADMIN_MAX_JSON_EXTRACTOR_LEN];
-                    le_result_t result = admin_GetJsonExtraction(PathArg, spec, sizeof(spec));
-                    if (result == LE_OK)
-                    {
-                        printf("%s\n", spec);
-                    }
-                    else
-                    {
-                        fprintf(stderr, "%s\n", LE_RESULT_TXT(result));
-                        exit(EXIT_FAILURE);
-                    }
-                    break;
-                }
-
-                case OBJECT_OBSERVATION:
-
-                    fprintf(stderr, "Can't 'get' an Observation.\n");
-                    exit(EXIT_FAILURE);
-
-                case OBJECT_MIN:
-
-                    GetBufferStat(query_GetMin);
-                    break;
-
-                case OBJECT_MAX:
-
-                    GetBufferStat(query_GetMax);
-                    break;
-
-                case OBJECT_MEAN:
-
-                    GetBufferStat(query_GetMean);
-                    break;
-
-                case OBJECT_STD_DEVIATION:
-
-                    GetBufferStat(query_GetStdDev);
-                    break;
+                exit(EXIT_FAILURE);
             }
             break;
 
@@ -2099,78 +3650,14 @@ COMPONENT_INIT
 
             admin_StartUpdate();
 
-            switch (Object)
-            {
-                case OBJECT_SOURCE:
-
-                    SetSource(PathArg, SrcPathArg);
-                    break;
-
-                case OBJECT_DEFAULT:
-
-                    SetDefault(PathArg, ValueArg);
-                    break;
-
-                case OBJECT_OVERRIDE:
-
-                    SetOverride(PathArg, ValueArg);
-                    break;
-
-                case OBJECT_MIN_PERIOD:
-
-                    SetDoubleSetting(PathArg, ValueArg, admin_SetMinPeriod);
-                    break;
+            result = Set();
 
-                case OBJECT_LOW_LIMIT:
-
-                    SetDoubleSetting(PathArg, ValueArg, admin_SetLowLimit);
-                    break;
-
-                case OBJECT_HIGH_LIMIT:
-
-                    SetDoubleSetting(PathArg, ValueArg, admin_SetHighLimit);
-                    break;
-
-                case OBJECT_CHANGE_BY:
-
-                    SetDoubleSetting(PathArg, ValueArg, admin_SetChangeBy);
-                    break;
-
-                case OBJECT_TRANSFORM:
-
-                    SetTransformSetting(PathArg, ValueArg);
-                    break;
-
-                case OBJECT_BUFFER_SIZE:
-
-                    SetIntegerSetting(PathArg, ValueArg, admin_SetBufferMaxCount);
-                    break;
-
-                case OBJECT_BACKUP_PERIOD:
-
-                    SetIntegerSetting(PathArg, ValueArg, admin_SetBufferBackupPeriod);
-                    break;
-
-                case OBJECT_JSON_EXTRACTION:
-
-                    admin_SetJsonExtraction(PathArg, ValueArg);
-                    break;
-
-                case OBJECT_OBSERVATION:
-
-                    fprintf(stderr, "Can't 'set' an Observation.\n");
-                    exit(EXIT_FAILURE);
-
-                case OBJECT_MIN:
-                case OBJECT_MAX:
-                case OBJECT_MEAN:
-                case OBJECT_STD_DEVIATION:
+            admin_EndUpdate();
 
-                    fprintf(stderr, "Can't 'set' a buffered data statistic.\n");
-                    exit(EXIT_FAILURE);
+            if (result != LE_OK)
+            {
+                exit(EXIT_FAILURE);
             }
-
-            admin_EndUpdate();
             break;
 
         case ACTION_PUSH:
@@ -2182,74 +3669,14 @@ COMPONENT_INIT
 
             admin_StartUpdate();
 
-            switch (Object)
-            {
-                case OBJECT_SOURCE:
-
-                    admin_RemoveSource(PathArg);
-                    break;
-
-                case OBJECT_DEFAULT:
-
-                    admin_RemoveDefault(PathArg);
-                    break;
-
-                case OBJECT_OVERRIDE:
-
-                    admin_RemoveOverride(PathArg);
-                    break;
-
-                case OBJECT_MIN_PERIOD:
-
-                    admin_SetMinPeriod(PathArg, NAN);
-                    break;
-
-                case OBJECT_LOW_LIMIT:
+            result = Remove();
 
-                    admin_SetLowLimit(PathArg, NAN);
-                    break;
-
-                case OBJECT_HIGH_LIMIT:
-
-                    admin_SetHighLimit(PathArg, NAN);
-                    break;
-
-                case OBJECT_CHANGE_BY:
-
-                    admin_SetChangeBy(PathArg, NAN);
-                    break;
-
-                case OBJECT_TRANSFORM:
-
-                    admin_SetTransform(PathArg, ADMIN_OBS_TRANSFORM_TYPE_NONE, NULL, 0);
-                    break;
-
-                case OBJECT_BUFFER_SIZE:
-                case OBJECT_BACKUP_PERIOD:
-
-                    fprintf(stderr, "This cannot be removed. Do you mean to set it to zero?\n");
-                    exit(EXIT_FAILURE);
-
-                case OBJECT_JSON_EXTRACTION:
-
-                    admin_SetJsonExtraction(PathArg, "");
-                    break;
-
-                case OBJECT_OBSERVATION:
-
-                    admin_DeleteObs(PathArg);
-                    break;
-
-                case OBJECT_MIN:
-                case OBJECT_MAX:
-                case OBJECT_MEAN:
-                case OBJECT_STD_DEVIATION:
+            admin_EndUpdate();
 
-                    fprintf(stderr, "Buffered data statistics cannot be removed.\n");
-                    exit(EXIT_FAILURE);
+            if (result != LE_OK)
+            {
+                exit(EXIT_FAILURE);
             }
-
-            admin_EndUpdate();
             break;
 
         case ACTION_WATCH:
@@ -2274,6 +3701,26 @@ COMPONENT_INIT
 
             return;  // Return instead of falling-through to exit. Wait for completion callback.
 
+        case ACTION_STATS:
+
+            Stats();
+            break;
+
+        case ACTION_POOLS:
+
+            Pools();
+            break;
+
+        case ACTION_TRACE:
+
+            Trace();
+            break;
+
+        case ACTION_BATCH:
+
+            Batch();
+            break;
+
         default:
 
             LE_FATAL("Unimplemented action.");
@@ -10,12 +10,14 @@
 #include "ioService.h"
 #include "resource.h"
 #include "handler.h"
+#include "pushTrace.h"
 #include "json.h"
 
 typedef struct
 {
     le_dls_Link_t link; ///< Used to link into the ResourceTreeChangeHandlerList
     admin_ResourceTreeChangeHandlerFunc_t callback;
+    admin_ResourceTreeChangeBatchHandlerFunc_t batchCallback; ///< Used instead, if in batch list.
     void* contextPtr;
 }
 ResourceTreeChangeHandler_t;
@@ -40,6 +42,34 @@ LE_MEM_DEFINE_STATIC_POOL(ResourceTreeChangeHandlerPool,
                           DEFAULT_RESOURCE_TREE_CHANGE_HANDLER_POOL_SIZE,
                           sizeof(ResourceTreeChangeHandler_t));
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * List of Resource Tree Change Batch Handlers.  They are allocated from the same pool as the
+ * Resource Tree Change Handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t ResourceTreeChangeBatchHandlerList = LE_DLS_LIST_INIT;
+
+/// Time (in milliseconds) for which resource tree changes made outside of an administrative
+/// update are accumulated before they are delivered to the batch handlers.  This can be
+/// overridden in the .cdef.
+#ifndef DHUB_TREE_CHANGE_COALESCE_MS
+#define DHUB_TREE_CHANGE_COALESCE_MS 100
+#endif
+
+/// Changes not yet delivered to the batch handlers, packed oldest first as described in
+/// @ref c_dataHubAdmin_ChangeNotifications.
+static uint8_t ChangeBatch[ADMIN_MAX_TREE_CHANGE_BATCH_BYTES];
+
+/// Number of bytes in the ChangeBatch (0 if no changes are pending).
+static size_t ChangeBatchLen = 0;
+
+/// Timer used to deliver the pending changes once no more have come for a while.
+static le_timer_Ref_t ChangeCoalesceTimer = NULL;
+
+/// true between admin_StartUpdate() and admin_EndUpdate().
+static bool IsUpdating = false;
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Current number of registered push handlers:
@@ -1369,6 +1399,140 @@ uint32_t admin_GetBufferBackupPeriod
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the number of samples evicted from an Observation's buffer to keep in its spilled history
+ * on non-volatile storage.  Only trigger, Boolean and numeric samples are spilled.
+ *
+ * @return
+ *      - LE_OK If the spill count was set successfully.
+ *      - LE_FAULT If an error happened during set.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_SetBufferSpillMaxCount
+(
+    const char* path,
+        ///< [IN] Path within the /obs/ namespace.
+    uint32_t count
+        ///< [IN] The number of evicted samples to keep (0 = delete the spilled history)
+)
+//--------------------------------------------------------------------------------------------------
+{
+    resTree_EntryRef_t obsEntry = GetObservation(path);
+
+    if (obsEntry == NULL)
+    {
+        LE_ERROR("Failed to get observation on path '%s'.", path);
+        return LE_FAULT;
+    }
+    else
+    {
+        resTree_SetBufferSpillMaxCount(obsEntry, count);
+        return LE_OK;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of samples evicted from an Observation's buffer to keep in its spilled history.
+ * See admin_SetBufferSpillMaxCount() for more information.
+ *
+ * @return The spill count (in number of samples) or 0 if the spilled history is disabled or the
+ *         Observation does not exist.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t admin_GetBufferSpillMaxCount
+(
+    const char* path
+        ///< [IN] Path within the /obs/ namespace.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    resTree_EntryRef_t resEntry = FindObservation(path);
+
+    if (resEntry == NULL)
+    {
+        return 0;
+    }
+    else
+    {
+        return resTree_GetBufferSpillMaxCount(resEntry);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the precision with which an Observation's buffered numbers are stored.  Compact precision
+ * stores values as single-precision floating point numbers and timestamps to the millisecond,
+ * which takes half the memory.  Samples already in the buffer keep the precision they have.
+ *
+ * @return
+ *      - LE_OK If the buffer precision was set successfully.
+ *      - LE_BAD_PARAMETER If the precision is not valid.
+ *      - LE_FAULT If an error happened during set.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_SetBufferPrecision
+(
+    const char* path,
+        ///< [IN] Path within the /obs/ namespace.
+    admin_BufferPrecision_t precision
+        ///< [IN] The precision of the buffered numbers.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (   (precision != ADMIN_BUFFER_PRECISION_FULL)
+        && (precision != ADMIN_BUFFER_PRECISION_COMPACT))
+    {
+        LE_ERROR("Invalid buffer precision %d.", precision);
+        return LE_BAD_PARAMETER;
+    }
+
+    resTree_EntryRef_t obsEntry = GetObservation(path);
+
+    if (obsEntry == NULL)
+    {
+        LE_ERROR("Failed to get observation on path '%s'.", path);
+        return LE_FAULT;
+    }
+    else
+    {
+        resTree_SetBufferPrecision(obsEntry, precision);
+        return LE_OK;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the precision with which an Observation's buffered numbers are stored.
+ * See admin_SetBufferPrecision() for more information.
+ *
+ * @return The buffer precision (ADMIN_BUFFER_PRECISION_FULL if the Observation does not exist).
+ */
+//--------------------------------------------------------------------------------------------------
+admin_BufferPrecision_t admin_GetBufferPrecision
+(
+    const char* path
+        ///< [IN] Path within the /obs/ namespace.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    resTree_EntryRef_t resEntry = FindObservation(path);
+
+    if (resEntry == NULL)
+    {
+        return ADMIN_BUFFER_PRECISION_FULL;
+    }
+    else
+    {
+        return resTree_GetBufferPrecision(resEntry);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Check if a given resource is a mandatory output.  If so, it means that this is an output resource
@@ -1396,6 +1560,218 @@ bool admin_IsMandatory
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the value of one of the runtime statistics counters of a resource.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if there is no resource at the given path (e.g., it's a Namespace).
+ *  - LE_BAD_PARAMETER if the counter is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_GetStatCounter
+(
+    const char* path,   ///< [IN] Absolute path of the resource.
+    admin_StatCounter_t counter,    ///< [IN] The counter to get.
+    uint32_t* valuePtr  ///< [OUT] The value of the counter.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((unsigned int) counter >= RES_NUM_STAT_COUNTERS)
+    {
+        LE_ERROR("Invalid statistics counter %d.", counter);
+        return LE_BAD_PARAMETER;
+    }
+
+    resTree_EntryRef_t resEntry = resTree_FindEntryAtAbsolutePath(path);
+
+    if (resEntry == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    return resTree_GetStat(resEntry, counter, valuePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set all the runtime statistics counters of a resource back to zero.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if there is no resource at the given path (e.g., it's a Namespace).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_ResetStats
+(
+    const char* path    ///< [IN] Absolute path of the resource.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    resTree_EntryRef_t resEntry = resTree_FindEntryAtAbsolutePath(path);
+
+    if (resEntry == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    return resTree_ResetStats(resEntry);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the usage of one of the Data Hub's memory pools whose size can be configured in the .cdef.
+ *
+ * The pools are numbered from 0, so they can all be listed by incrementing the index until
+ * LE_OUT_OF_RANGE is returned.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_OUT_OF_RANGE if the index is past the last pool.
+ *  - LE_OVERFLOW if the pool's name did not fit in the buffer provided (it has been truncated).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_GetPoolStats
+(
+    uint32_t index,     ///< [IN] Index of the pool.
+    char* name,         ///< [OUT] Name of the pool.
+    size_t nameSize,    ///< [IN] Size of the name buffer (in bytes).
+    uint32_t* objectSizePtr,    ///< [OUT] Size of the pool's blocks (in bytes).
+    uint32_t* totalBlocksPtr,   ///< [OUT] Number of blocks in the pool, including any expansions.
+    uint32_t* blocksInUsePtr,   ///< [OUT] Number of blocks currently in use.
+    uint32_t* peakBlocksPtr,    ///< [OUT] Largest number of blocks ever in use at the same time.
+    uint32_t* expansionsPtr     ///< [OUT] Number of times the pool had to be expanded.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_mem_PoolRef_t pool = hub_GetPool(index);
+    le_mem_PoolStats_t stats;
+
+    if (pool == NULL)
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    le_mem_GetStats(pool, &stats);
+
+    *objectSizePtr = le_mem_GetObjectSize(pool);
+    *totalBlocksPtr = le_mem_GetObjectCount(pool);
+    *blocksInUsePtr = stats.numBlocksInUse;
+    *peakBlocksPtr = stats.maxNumBlocksUsed;
+    *expansionsPtr = stats.numOverflows;
+
+    return le_mem_GetName(pool, name, nameSize);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start, change the rate of, or stop push latency tracing.
+ */
+//--------------------------------------------------------------------------------------------------
+void admin_SetPushTracing
+(
+    uint32_t samplePeriod   ///< [IN] Trace one push out of every samplePeriod (0 = stop tracing).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    pushTrace_SetSamplePeriod(samplePeriod);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the latency histogram of one of the stages of the traced pushes.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_BAD_PARAMETER if the stage is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_GetPushTraceHistogram
+(
+    admin_TraceStage_t stage,   ///< [IN] The stage.
+    uint32_t* bucketsPtr,       ///< [OUT] Number of traced pushes in each bucket.
+    size_t* bucketsSizePtr,     ///< [INOUT] Number of buckets.
+    uint32_t* countPtr,         ///< [OUT] Number of traced pushes that went through the stage.
+    uint64_t* totalTimePtr,     ///< [OUT] Total time spent in the stage (microseconds).
+    uint32_t* maxTimePtr        ///< [OUT] Longest time spent in the stage (microseconds).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t result = pushTrace_GetHistogram(stage,
+                                                bucketsPtr,
+                                                bucketsSizePtr,
+                                                countPtr,
+                                                totalTimePtr,
+                                                maxTimePtr);
+    if (result != LE_OK)
+    {
+        LE_ERROR("Invalid push trace stage %d.", stage);
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clear the latency histograms of all the stages of the traced pushes.
+ */
+//--------------------------------------------------------------------------------------------------
+void admin_ResetPushTraces
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    pushTrace_Reset();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mark or unmark a namespace or resource as high-priority.  Samples routed to the resources at or
+ * under a high-priority path are pushed ahead of all the others.  The path doesn't have to exist.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_BAD_PARAMETER if the path is not a valid absolute path.
+ *  - LE_OUT_OF_RANGE if the maximum number of high-priority paths are already marked.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_SetHighPriority
+(
+    const char* path,   ///< [IN] Absolute path of a namespace or resource.
+    bool isHighPriority ///< [IN] true to mark the path as high-priority, false to unmark it.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return resTree_SetHighPriority(path, isHighPriority);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a namespace or resource is at or under a path marked high-priority.
+ * See admin_SetHighPriority() for more information.
+ *
+ * @return true if it is.
+ */
+//--------------------------------------------------------------------------------------------------
+bool admin_IsHighPriority
+(
+    const char* path    ///< [IN] Absolute path of a namespace or resource.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return resTree_IsHighPriority(path);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set a default value for a given resource.
@@ -2520,6 +2896,167 @@ void admin_RemoveResourceTreeChangeHandler
 
     le_mem_Release(handlerPtr);
 }
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'admin_ResourceTreeChangeBatch'
+ */
+//--------------------------------------------------------------------------------------------------
+admin_ResourceTreeChangeBatchHandlerRef_t admin_AddResourceTreeChangeBatchHandler
+(
+    admin_ResourceTreeChangeBatchHandlerFunc_t callbackPtr,
+        ///< [IN]
+    void* contextPtr
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // See admin_AddResourceTreeChangeHandler() for why the allocation may fail.
+#ifdef DHUB_ADMIN_RESOURCE_TREE_CHANGE_HANDLER_COUNT
+    ResourceTreeChangeHandler_t* handlerPtr = le_mem_TryAlloc(ResourceTreeChangeHandlerPool);
+#else
+    ResourceTreeChangeHandler_t* handlerPtr = le_mem_Alloc(ResourceTreeChangeHandlerPool);
+#endif
+    if (handlerPtr != NULL)
+    {
+        handlerPtr->link = LE_DLS_LINK_INIT;
+
+        handlerPtr->callback = NULL;
+        handlerPtr->batchCallback = callbackPtr;
+        handlerPtr->contextPtr = contextPtr;
+
+        le_dls_Queue(&ResourceTreeChangeBatchHandlerList, &handlerPtr->link);
+    }
+    else
+    {
+        LE_WARN("Cannot add any more resource tree change handlers. Rejecting request.");
+    }
+    return (admin_ResourceTreeChangeBatchHandlerRef_t)handlerPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'admin_ResourceTreeChangeBatch'
+ */
+//--------------------------------------------------------------------------------------------------
+void admin_RemoveResourceTreeChangeBatchHandler
+(
+    admin_ResourceTreeChangeBatchHandlerRef_t handlerRef
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ResourceTreeChangeHandler_t* handlerPtr = (ResourceTreeChangeHandler_t*)handlerRef;
+
+    le_dls_Remove(&ResourceTreeChangeBatchHandlerList, &handlerPtr->link);
+
+    le_mem_Release(handlerPtr);
+
+    // Drop the changes nobody is left to receive, so that a handler added later isn't sent
+    // changes made before it was added.
+    if (le_dls_IsEmpty(&ResourceTreeChangeBatchHandlerList))
+    {
+        le_timer_Stop(ChangeCoalesceTimer);
+        ChangeBatchLen = 0;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deliver the pending resource tree changes, as one batch, to all the batch handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeliverChanges
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_timer_Stop(ChangeCoalesceTimer);
+
+    if (ChangeBatchLen == 0)
+    {
+        return;
+    }
+
+    // The handlers get a copy of the batch in their event message, so it can be reused right away.
+    size_t len = ChangeBatchLen;
+    ChangeBatchLen = 0;
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&ResourceTreeChangeBatchHandlerList);
+
+    while (linkPtr != NULL)
+    {
+        ResourceTreeChangeHandler_t* handlerPtr = CONTAINER_OF(linkPtr,
+                                                               ResourceTreeChangeHandler_t,
+                                                               link);
+
+        handlerPtr->batchCallback(ChangeBatch, len, handlerPtr->contextPtr);
+
+        linkPtr = le_dls_PeekNext(&ResourceTreeChangeBatchHandlerList, linkPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer expiry handler function for the resource tree change coalescing timer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ChangeCoalesceTimerExpired
+(
+    le_timer_Ref_t timer
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(timer);
+
+    // Changes made during an administrative update are delivered when it ends.
+    if (!IsUpdating)
+    {
+        DeliverChanges();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a resource tree change to the batch that will next be delivered to the batch handlers.
+ * If the batch has no room left for the change, it is delivered first, even during an
+ * administrative update, so that the changes kept never take more than the batch buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddPendingChange
+(
+    const char* path,
+    admin_EntryType_t entryType,
+    admin_ResourceOperationType_t resourceOperationType
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t pathSize = strlen(path) + 1;
+    size_t changeSize = 2 + pathSize;
+
+    // Paths are at most HUB_MAX_RESOURCE_PATH_BYTES long, so a change always fits in a batch.
+    if ((sizeof(ChangeBatch) - ChangeBatchLen) < changeSize)
+    {
+        DeliverChanges();
+    }
+
+    ChangeBatch[ChangeBatchLen] = (uint8_t)entryType;
+    ChangeBatch[ChangeBatchLen + 1] = (uint8_t)resourceOperationType;
+    memcpy(ChangeBatch + ChangeBatchLen + 2, path, pathSize);
+    ChangeBatchLen += changeSize;
+
+    // Restart the timer, so the batch is only delivered once no more changes have come.
+    if (!IsUpdating)
+    {
+        le_timer_Restart(ChangeCoalesceTimer);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Call all the registered Resource Tree Change Handlers.
@@ -2543,6 +3080,12 @@ void admin_CallResourceTreeChangeHandlers
 
         linkPtr = le_dls_PeekNext(&ResourceTreeChangeHandlerList, linkPtr);
     }
+
+    // Only keep the change for the batch handlers if there are any.
+    if (!le_dls_IsEmpty(&ResourceTreeChangeBatchHandlerList))
+    {
+        AddPendingChange(path, entryType, resourceOperationType);
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -2567,6 +3110,15 @@ void adminService_Init
 #endif
     ResourceTreeChangeHandlerPool = le_mem_InitStaticPool(ResourceTreeChangeHandlerPool,
         DEFAULT_RESOURCE_TREE_CHANGE_HANDLER_POOL_SIZE, sizeof(ResourceTreeChangeHandler_t));
+    hub_RegisterPool(ResourceTreeChangeHandlerPool);
+
+    // A change must always fit in an empty batch.
+    static_assert(ADMIN_MAX_TREE_CHANGE_BATCH_BYTES >= (2 + HUB_MAX_RESOURCE_PATH_BYTES),
+                  "ADMIN_MAX_TREE_CHANGE_BATCH_BYTES is too small for a resource path");
+
+    ChangeCoalesceTimer = le_timer_Create("treeChangeBatch");
+    LE_ASSERT(le_timer_SetMsInterval(ChangeCoalesceTimer, DHUB_TREE_CHANGE_COALESCE_MS) == LE_OK);
+    LE_ASSERT(le_timer_SetHandler(ChangeCoalesceTimer, ChangeCoalesceTimerExpired) == LE_OK);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -2584,6 +3136,8 @@ void admin_StartUpdate
 {
     LE_INFO("Data Hub administrative updates starting.");
 
+    IsUpdating = true;
+
     ioService_StartUpdate();
 
     res_StartUpdate();
@@ -2610,9 +3164,14 @@ void admin_EndUpdate
 {
     LE_INFO("Data Hub administrative updates complete.");
 
+    IsUpdating = false;
+
     ioService_EndUpdate();
 
     res_EndUpdate();
+
+    // Deliver the resource tree changes made during the update as one batch.
+    DeliverChanges();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -25,6 +25,13 @@
 //--------------------------------------------------------------------------------------------------
 static void* ContextPtr;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * true if the file given to the Load function is CBOR-encoded, false if it is JSON.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsCborEncoded;
+
 
 // Config Service Destination Callback structure
 typedef struct config_DestinationStructure
@@ -40,6 +47,40 @@ typedef struct config_DestinationStructure
 static config_DestinationStructure_t destinationRecord[CONFIG_DESTINATION_MAX_NUM];
 
 
+/// Maximum number of destination batch push handlers.  This can be overridden in the .cdef.
+#ifndef CONFIG_DESTINATION_BATCH_MAX_NUM
+#define CONFIG_DESTINATION_BATCH_MAX_NUM  2
+#endif
+
+/// CBOR (RFC 7049) major types and simple values used by destination batches.
+#define CBOR_MAJOR_UNSIGNED     0x00
+#define CBOR_MAJOR_TEXT_STRING  0x60
+#define CBOR_MAJOR_ARRAY        0x80
+#define CBOR_INDEF_ARRAY_START  0x9f
+#define CBOR_FALSE              0xf4
+#define CBOR_TRUE               0xf5
+#define CBOR_NULL               0xf6
+#define CBOR_FLOAT64            0xfb
+#define CBOR_BREAK              0xff
+
+// Config Service Destination Batch structure
+typedef struct config_DestinationBatch
+{
+    char destination[CONFIG_MAX_DESTINATION_NAME_BYTES];   ///< Destination string.
+    config_DestinationBatchPushHandlerFunc_t callbackPtr;  ///< handler provided by client.
+    void* contextPtr;                                      ///< client context.
+    size_t maxBytes;            ///< Batch size that triggers a delivery.
+    le_timer_Ref_t timer;       ///< Flush timer (NULL if there is no interval).
+    size_t len;                 ///< Number of bytes in the batch (0 if no samples are pending).
+    uint8_t batch[CONFIG_MAX_DESTINATION_BATCH_BYTES];     ///< Pending samples, CBOR-encoded.
+
+} config_DestinationBatch_t;
+
+
+// Static Destination Batch Record
+static config_DestinationBatch_t destinationBatch[CONFIG_DESTINATION_BATCH_MAX_NUM];
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Callback given to configService_TraverseDatahubResourceTree to be called whenever an observation
@@ -65,7 +106,7 @@ static void FoundObservation
         // 1. considerRelevance is false, meaning we're not considering the relevance of resources
         // during clean up, essentially deleting all config observations.
         // 2. This observations is not relevant.
-        if (!considerRelevance || !resTree_IsRelevant(entryRef))
+        if (!considerRelevance || !resTree_IsRelevant(entryRef, RESTREE_CONFIG_RELEVANCE_SLOT))
         {
             resTree_DeleteObservation(entryRef);
         }
@@ -89,7 +130,7 @@ static void ClearRelevanceFlag
 )
 {
     LE_UNUSED(context);
-    resTree_SetRelevance(entryRef, false);
+    resTree_SetRelevance(entryRef, RESTREE_CONFIG_RELEVANCE_SLOT, false);
 }
 
 
@@ -156,7 +197,7 @@ static le_result_t ValidateConfig
 )
 {
     // Validate the configuration
-    return configService_ParseConfig(fd, true, parseErrorPtr);
+    return configService_ParseConfig(fd, IsCborEncoded, true, parseErrorPtr);
 }
 
 
@@ -179,6 +220,7 @@ static le_result_t ApplyConfig
     le_result_t overallResult =
         configService_ParseConfig(
             fd,
+            IsCborEncoded,
             false,
             parseErrorPtr);
 
@@ -257,6 +299,8 @@ static void DoLoad
 /**
  * Function that causes the Datahub to load a configuration from a file.
  * Any existing configuration will be removed and replaced with the incoming one.
+ * Observations that are in both configurations are kept, and only their changed settings are
+ * applied.
  *
  * @return
  *  - LE_OK           : Configuration successfully loaded
@@ -274,7 +318,8 @@ le_result_t config_Load
 {
     LE_INFO("Loading Config, file path is %s" , filePath);
     int fd = -1;
-    if (strcmp(encodedType, "json") == 0)
+    bool isCbor = (strcmp(encodedType, "cbor") == 0);
+    if (isCbor || (strcmp(encodedType, "json") == 0))
     {
         // open the file now so you don't have to copy the file path.
         fd = open(filePath, O_RDONLY);
@@ -289,6 +334,7 @@ le_result_t config_Load
     }
 
     ContextPtr = contextPtr;
+    IsCborEncoded = isCbor;
 
     le_event_QueueFunction(DoLoad, (void*)(intptr_t)fd, (void*)callbackPtr);
 
@@ -346,6 +392,454 @@ void config_RemoveDestinationPushHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode the CBOR head of a data item with a given major type and argument (e.g., a length).
+ *
+ * @return The number of bytes encoded, or 0 if the buffer provided is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t EncodeCborHead
+(
+    uint8_t* buffPtr,
+    size_t buffSize,
+    uint8_t majorType,      ///< Major type (already shifted into the top 3 bits).
+    uint32_t argument
+)
+{
+    size_t argLen;
+    uint8_t info;
+
+    if (argument < 24)
+    {
+        argLen = 0;
+        info = (uint8_t)argument;
+    }
+    else if (argument <= UINT8_MAX)
+    {
+        argLen = 1;
+        info = 24;
+    }
+    else if (argument <= UINT16_MAX)
+    {
+        argLen = 2;
+        info = 25;
+    }
+    else
+    {
+        argLen = 4;
+        info = 26;
+    }
+
+    if (buffSize < (argLen + 1))
+    {
+        return 0;
+    }
+
+    buffPtr[0] = majorType | info;
+
+    // Multi-byte arguments are big-endian.
+    for (size_t i = argLen; i > 0; i--)
+    {
+        buffPtr[i] = (uint8_t)argument;
+        argument >>= 8;
+    }
+
+    return argLen + 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode a text string in CBOR.
+ *
+ * @return The number of bytes encoded, or 0 if the buffer provided is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t EncodeCborText
+(
+    uint8_t* buffPtr,
+    size_t buffSize,
+    const char* text
+)
+{
+    size_t textLen = strlen(text);
+    size_t headLen = EncodeCborHead(buffPtr, buffSize, CBOR_MAJOR_TEXT_STRING, textLen);
+
+    if ((headLen == 0) || ((buffSize - headLen) < textLen))
+    {
+        return 0;
+    }
+
+    memcpy(buffPtr + headLen, text, textLen);
+
+    return headLen + textLen;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode a double-precision floating point number in CBOR.
+ *
+ * @return The number of bytes encoded, or 0 if the buffer provided is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t EncodeCborDouble
+(
+    uint8_t* buffPtr,
+    size_t buffSize,
+    double value
+)
+{
+    if (buffSize < 9)
+    {
+        return 0;
+    }
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    buffPtr[0] = CBOR_FLOAT64;
+
+    // The value is big-endian.
+    for (size_t i = 8; i > 0; i--)
+    {
+        buffPtr[i] = (uint8_t)bits;
+        bits >>= 8;
+    }
+
+    return 9;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode a sample for a destination batch, as a CBOR array holding the observation name, the
+ * source path, the data type, the timestamp and the value.
+ *
+ * @return The number of bytes encoded, or 0 if the buffer provided is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t EncodeBatchSample
+(
+    uint8_t* buffPtr,
+    size_t buffSize,
+    const char* obsName,         ///< [IN] Observation Name
+    const char* srcPath,         ///< [IN] Source path + JSON extraction, if applicable
+    io_DataType_t dataType,      ///< [IN] Data type of the data sample
+    dataSample_Ref_t dataSample  ///< [IN] Data sample
+)
+{
+    size_t len = EncodeCborHead(buffPtr, buffSize, CBOR_MAJOR_ARRAY, 5);
+    if (len == 0)
+    {
+        return 0;
+    }
+
+    size_t itemLen = EncodeCborText(buffPtr + len, buffSize - len, obsName);
+    if (itemLen == 0)
+    {
+        return 0;
+    }
+    len += itemLen;
+
+    itemLen = EncodeCborText(buffPtr + len, buffSize - len, srcPath);
+    if (itemLen == 0)
+    {
+        return 0;
+    }
+    len += itemLen;
+
+    itemLen = EncodeCborHead(buffPtr + len, buffSize - len, CBOR_MAJOR_UNSIGNED, dataType);
+    if (itemLen == 0)
+    {
+        return 0;
+    }
+    len += itemLen;
+
+    itemLen = EncodeCborDouble(buffPtr + len, buffSize - len, dataSample_GetTimestamp(dataSample));
+    if (itemLen == 0)
+    {
+        return 0;
+    }
+    len += itemLen;
+
+    if (len >= buffSize)
+    {
+        return 0;
+    }
+
+    switch (dataType)
+    {
+        case IO_DATA_TYPE_TRIGGER:
+            buffPtr[len] = CBOR_NULL;
+            itemLen = 1;
+            break;
+
+        case IO_DATA_TYPE_BOOLEAN:
+            buffPtr[len] = dataSample_GetBoolean(dataSample) ? CBOR_TRUE : CBOR_FALSE;
+            itemLen = 1;
+            break;
+
+        case IO_DATA_TYPE_NUMERIC:
+            itemLen = EncodeCborDouble(buffPtr + len,
+                                       buffSize - len,
+                                       dataSample_GetNumeric(dataSample));
+            break;
+
+        case IO_DATA_TYPE_STRING:
+            itemLen = EncodeCborText(buffPtr + len,
+                                     buffSize - len,
+                                     dataSample_GetString(dataSample));
+            break;
+
+        case IO_DATA_TYPE_JSON:
+            itemLen = EncodeCborText(buffPtr + len,
+                                     buffSize - len,
+                                     dataSample_GetJson(dataSample));
+            break;
+
+        default:
+            itemLen = 0;
+            break;
+    }
+
+    if (itemLen == 0)
+    {
+        return 0;
+    }
+
+    return len + itemLen;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deliver the samples pending in a destination batch to its handler, if there are any.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeliverDestinationBatch
+(
+    config_DestinationBatch_t* batchPtr
+)
+{
+    if (batchPtr->timer != NULL)
+    {
+        le_timer_Stop(batchPtr->timer);
+    }
+
+    if (batchPtr->len == 0)
+    {
+        return;
+    }
+
+    // Room for the break was kept free when adding samples.
+    batchPtr->batch[batchPtr->len++] = CBOR_BREAK;
+
+    size_t len = batchPtr->len;
+    batchPtr->len = 0;
+
+    LE_DEBUG("[%s] Delivering %" PRIuS " bytes to destination [%s]",
+             __FUNCTION__,
+             len,
+             batchPtr->destination);
+
+    batchPtr->callbackPtr(batchPtr->batch, len, batchPtr->contextPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer expiry handler that delivers a destination batch whose flush interval has passed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DestinationBatchTimerExpired
+(
+    le_timer_Ref_t timerRef
+)
+{
+    DeliverDestinationBatch(le_timer_GetContextPtr(timerRef));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a sample to a destination batch, delivering the batch first if the sample doesn't fit in
+ * it, and afterwards if the batch has reached its delivery size.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddToDestinationBatch
+(
+    config_DestinationBatch_t* batchPtr,
+    const char* obsName,         ///< [IN] Observation Name
+    const char* srcPath,         ///< [IN] Source path + JSON extraction, if applicable
+    io_DataType_t dataType,      ///< [IN] Data type of the data sample
+    dataSample_Ref_t dataSample  ///< [IN] Data sample
+)
+{
+    // Leave room for the break at the end of the batch.
+    size_t buffSize = sizeof(batchPtr->batch) - 1;
+
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        bool wasEmpty = (batchPtr->len == 0);
+        size_t len = batchPtr->len;
+
+        if (wasEmpty)
+        {
+            batchPtr->batch[len++] = CBOR_INDEF_ARRAY_START;
+        }
+
+        size_t sampleLen = EncodeBatchSample(batchPtr->batch + len,
+                                             buffSize - len,
+                                             obsName,
+                                             srcPath,
+                                             dataType,
+                                             dataSample);
+        if (sampleLen != 0)
+        {
+            batchPtr->len = len + sampleLen;
+
+            if (batchPtr->len + 1 >= batchPtr->maxBytes)
+            {
+                DeliverDestinationBatch(batchPtr);
+            }
+            else if (wasEmpty && (batchPtr->timer != NULL))
+            {
+                le_timer_Start(batchPtr->timer);
+            }
+
+            return;
+        }
+
+        if (wasEmpty)
+        {
+            break;
+        }
+
+        // The sample may fit in the next batch, so deliver this one first.
+        DeliverDestinationBatch(batchPtr);
+    }
+
+    LE_ERROR("Sample of observation [%s] doesn't fit in a batch for destination [%s]. Dropping.",
+             obsName,
+             batchPtr->destination);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a sample to the batches of all destination batch push handlers for a given destination
+ * name.
+ *
+ * @return true if there were any such handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool AddToDestinationBatches
+(
+    const char* destination,     ///< [IN] Destination path of resource
+    const char* obsName,         ///< [IN] Observation Name
+    const char* srcPath,         ///< [IN] Source path + JSON extraction, if applicable
+    io_DataType_t dataType,      ///< [IN] Data type of the data sample
+    dataSample_Ref_t dataSample  ///< [IN] Data sample
+)
+{
+    bool isFound = false;
+
+    for (int i = 0; i < CONFIG_DESTINATION_BATCH_MAX_NUM; i++)
+    {
+        if (   (destinationBatch[i].callbackPtr != NULL)
+            && (strncmp(destinationBatch[i].destination, destination,
+                        sizeof(destinationBatch[i].destination)) == 0))
+        {
+            AddToDestinationBatch(&destinationBatch[i], obsName, srcPath, dataType, dataSample);
+            isFound = true;
+        }
+    }
+
+    return isFound;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'config_DestinationBatchPush'
+ */
+//--------------------------------------------------------------------------------------------------
+config_DestinationBatchPushHandlerRef_t config_AddDestinationBatchPushHandler
+(
+    const char* destination,                               ///< [IN] Destination name.
+    uint32_t maxBytes,                                     ///< [IN] Batch size that triggers a
+                                                           ///< delivery (0 = maximum).
+    uint32_t flushIntervalMs,                              ///< [IN] Longest time (ms) a sample
+                                                           ///< may be held back (0 = no limit).
+    config_DestinationBatchPushHandlerFunc_t callbackPtr,  ///< [IN]
+    void* contextPtr                                       ///< [IN]
+)
+{
+    // Traverse destination batch array looking for free entry
+    for (int i = 0; i < CONFIG_DESTINATION_BATCH_MAX_NUM; i++)
+    {
+        config_DestinationBatch_t* batchPtr = &destinationBatch[i];
+
+        if (batchPtr->callbackPtr == NULL)
+        {
+            strncpy(batchPtr->destination, destination, CONFIG_MAX_DESTINATION_NAME_LEN);
+            batchPtr->callbackPtr = callbackPtr;
+            batchPtr->contextPtr = contextPtr;
+            batchPtr->len = 0;
+
+            if ((maxBytes == 0) || (maxBytes > sizeof(batchPtr->batch)))
+            {
+                maxBytes = sizeof(batchPtr->batch);
+            }
+            batchPtr->maxBytes = maxBytes;
+
+            batchPtr->timer = NULL;
+            if (flushIntervalMs != 0)
+            {
+                batchPtr->timer = le_timer_Create("destBatch");
+                LE_ASSERT(le_timer_SetMsInterval(batchPtr->timer, flushIntervalMs) == LE_OK);
+                LE_ASSERT(le_timer_SetHandler(batchPtr->timer,
+                                              DestinationBatchTimerExpired) == LE_OK);
+                LE_ASSERT(le_timer_SetContextPtr(batchPtr->timer, batchPtr) == LE_OK);
+            }
+
+            return (config_DestinationBatchPushHandlerRef_t)batchPtr;
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'config_DestinationBatchPush', discarding any samples not
+ * yet delivered.
+ */
+//--------------------------------------------------------------------------------------------------
+void config_RemoveDestinationBatchPushHandler
+(
+    config_DestinationBatchPushHandlerRef_t handlerRef
+        ///< [IN]
+)
+{
+    config_DestinationBatch_t* batchPtr = (config_DestinationBatch_t*)handlerRef;
+
+    if (batchPtr->timer != NULL)
+    {
+        le_timer_Delete(batchPtr->timer);
+        batchPtr->timer = NULL;
+    }
+
+    memset(batchPtr->destination, 0, CONFIG_MAX_DESTINATION_NAME_BYTES);
+    batchPtr->callbackPtr = NULL;
+    batchPtr->contextPtr = NULL;
+    batchPtr->len = 0;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Trigger destination push handler for the specified destination name, if registered
@@ -354,6 +848,9 @@ void config_RemoveDestinationPushHandler
  *      - LE_OK                Function succeeded.
  *      - LE_BAD_PARAMETER     Invalid destination record variable.
  *      - LE_NOT_FOUND         Unable to find matching destination name
+ *
+ * @note The sample is also added to the batches of any destination batch push handlers for the
+ *       same destination name.
  */
 //--------------------------------------------------------------------------------------------------
 le_result_t configService_TriggerDestinationPushHandler
@@ -375,6 +872,8 @@ le_result_t configService_TriggerDestinationPushHandler
              srcPath,
              dataType);
 
+    bool isFound = AddToDestinationBatches(destination, obsName, srcPath, dataType, dataSample);
+
     // Traverse destination array searching for matching destination name
     for (int i = 0; i < CONFIG_DESTINATION_MAX_NUM; i++)
     {
@@ -449,6 +948,11 @@ le_result_t configService_TriggerDestinationPushHandler
         }
     }
 
+    if (isFound)
+    {
+        return LE_OK;
+    }
+
     LE_ERROR("[%s] Unable to find matching push handler, destination [%s]",
              __FUNCTION__,
              destination);
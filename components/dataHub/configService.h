@@ -98,6 +98,7 @@ void configService_TraverseDatahubResourceTree
 le_result_t configService_ParseConfig
 (
     int fd,                                ///< [IN] File descriptor of the configuration file.
+    bool isCbor,                           ///< [IN] true if the file is CBOR rather than JSON.
     bool validateOnly,                     ///< [IN] Boolean to indicate if this is a validate or
                                            /// apply operation.
     parseError_t* parseErrorPtr            ///< [OUT] Pointer to the Parse Error structure.
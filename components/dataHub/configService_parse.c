@@ -29,6 +29,9 @@ typedef struct ParseContext
     bool validateOnly;                      ///< Only validate the config, do not apply
     le_result_t result;                     ///< Overall parse result.
     parseError_t* parserErrorPtr;           ///< Pointer to parser error structure passed to us.
+    bool obsParsed;                         ///< The end of the observations has been reached.
+    bool statesSkipped;                     ///< States came before observations, so need another
+                                            /// parse once the observations have been processed.
 } ParseContext_t;
 
 
@@ -95,6 +98,24 @@ static void ErrorEventCb
 //--------------------------------------------------------------------------------------------------
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a setting already has the value that a config wants to give it.  Settings are
+ * only applied if they change, so that reloading a config only touches what changed in it.
+ *
+ * @return true if the values are the same (including both being NAN).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsSameValue
+(
+    double currentValue,    ///< [IN] Current value of the setting.
+    double newValue         ///< [IN] Value from the config.
+)
+{
+    return ((currentValue == newValue) || (isnan(currentValue) && isnan(newValue)));
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Helper function for creating an Observation.
@@ -137,7 +158,7 @@ static bool ObsNameHelper
         // Set the relevance flag so we know this obs was visited during application of this config
         resTree_EntryRef_t entryRef = resTree_FindEntry(resTree_GetObsNamespace(), obsName);
         LE_ASSERT(entryRef); // we just created it, so it must exist.
-        resTree_SetRelevance(entryRef, true);
+        resTree_SetRelevance(entryRef, RESTREE_CONFIG_RELEVANCE_SLOT, true);
 
         // Mark as config if it's a new observation:
         if (IsANewObs)
@@ -271,7 +292,8 @@ static bool ObsMinPeriodHelper
     ParseContext_t* parseContextPtr = (ParseContext_t*) context;
     if (!parseContextPtr->validateOnly)
     {
-        if ((obsDataPtr->bitmask & PARSER_OBS_PERIOD_MASK) || !IsANewObs)
+        if (   ((obsDataPtr->bitmask & PARSER_OBS_PERIOD_MASK) || !IsANewObs)
+            && !IsSameValue(admin_GetMinPeriod(obsDataPtr->obsName), obsDataPtr->minPeriod))
         {
             // Set the Observation Minimum period
             le_result_t result = admin_SetMinPeriod(obsDataPtr->obsName, obsDataPtr->minPeriod);
@@ -312,7 +334,8 @@ static bool ObsChangeByHelper
     ParseContext_t* parseContextPtr = (ParseContext_t*) context;
     if (!parseContextPtr->validateOnly)
     {
-        if ((obsDataPtr->bitmask & PARSER_OBS_CHANGEBY_MASK) || !IsANewObs)
+        if (   ((obsDataPtr->bitmask & PARSER_OBS_CHANGEBY_MASK) || !IsANewObs)
+            && !IsSameValue(admin_GetChangeBy(obsDataPtr->obsName), obsDataPtr->changeBy))
         {
             // Set the Observation Change By field
             le_result_t result = admin_SetChangeBy(obsDataPtr->obsName, obsDataPtr->changeBy);
@@ -354,7 +377,8 @@ static bool ObsLowerThanHelper
 
     if (!parseContextPtr->validateOnly)
     {
-        if ((obsDataPtr->bitmask & PARSER_OBS_LOWERTHAN_MASK) || !IsANewObs)
+        if (   ((obsDataPtr->bitmask & PARSER_OBS_LOWERTHAN_MASK) || !IsANewObs)
+            && !IsSameValue(admin_GetHighLimit(obsDataPtr->obsName), obsDataPtr->lowerThan))
         {
             // Set the Observation High Limit
             le_result_t result = admin_SetHighLimit(obsDataPtr->obsName, obsDataPtr->lowerThan);
@@ -396,7 +420,8 @@ static bool ObsGreaterThanHelper
 
     if (!parseContextPtr->validateOnly)
     {
-        if ((obsDataPtr->bitmask & PARSER_OBS_GREATERTHAN_MASK) || !IsANewObs)
+        if (   ((obsDataPtr->bitmask & PARSER_OBS_GREATERTHAN_MASK) || !IsANewObs)
+            && !IsSameValue(admin_GetLowLimit(obsDataPtr->obsName), obsDataPtr->greaterThan))
         {
             // Set the Observation Low Limit
             le_result_t result = admin_SetLowLimit(obsDataPtr->obsName, obsDataPtr->greaterThan);
@@ -438,7 +463,8 @@ static bool ObsMaxBufferHelper
 
     if (!parseContextPtr->validateOnly)
     {
-        if ((obsDataPtr->bitmask & PARSER_OBS_BUFFER_MASK) || !IsANewObs)
+        if (   ((obsDataPtr->bitmask & PARSER_OBS_BUFFER_MASK) || !IsANewObs)
+            && (admin_GetBufferMaxCount(obsDataPtr->obsName) != obsDataPtr->bufferMaxCount))
         {
             // Set the Observation Max Buffer Count
             le_result_t result = admin_SetBufferMaxCount(obsDataPtr->obsName,
@@ -461,6 +487,50 @@ static bool ObsMaxBufferHelper
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Helper function to set the Observation Buffer precision.
+ *
+ * @return
+ *      - true            The function succeeded.
+ *      - false           The function failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ObsBufferPrecisionHelper
+(
+    parser_ObsData_t* obsDataPtr,     ///< [IN] Pointer to Observation Data structure
+    bool IsANewObs,                   ///< [IN] Is this a new observation?
+    void* context                     ///< [IN] Context pointer
+)
+{
+    ParseContext_t* parseContextPtr = (ParseContext_t*) context;
+
+    if (!parseContextPtr->validateOnly)
+    {
+        if (   ((obsDataPtr->bitmask & PARSER_OBS_PRECISION_MASK) || !IsANewObs)
+            && (admin_GetBufferPrecision(obsDataPtr->obsName) != obsDataPtr->bufferPrecision))
+        {
+            // Set the Observation Buffer Precision
+            le_result_t result = admin_SetBufferPrecision(obsDataPtr->obsName,
+                obsDataPtr->bufferPrecision);
+            if (result != LE_OK)
+            {
+                char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
+                snprintf(msg,
+                         CONFIG_MAX_ERROR_MSG_LEN,
+                         "Failed to set buffer precision for obs %s, error: %s",
+                         obsDataPtr->obsName,
+                         LE_RESULT_TXT(result));
+
+                HandleError(parseContextPtr, LE_FAULT, msg);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Helper function to set the Observation Transform.
@@ -481,11 +551,24 @@ static bool ObsTransformFunctionHelper
 
     if (!parseContextPtr->validateOnly)
     {
-        if ((obsDataPtr->bitmask & PARSER_OBS_TRANSFORM_MASK) || !IsANewObs)
+        // Setting a transform clears the Observation's buffer, so only do it if it changed.
+        size_t paramsSize = 0;
+        if (obsDataPtr->bitmask & PARSER_OBS_TRANSFORM_PERIOD_MASK)
         {
-            // Set the Observation transform
+            paramsSize = 1;
+        }
+        resTree_EntryRef_t entryRef = resTree_FindEntry(resTree_GetObsNamespace(),
+                                                        obsDataPtr->obsName);
+
+        if (   ((obsDataPtr->bitmask & PARSER_OBS_TRANSFORM_MASK) || !IsANewObs)
+            && !resTree_IsTransformSet(entryRef,
+                                       obsDataPtr->transform,
+                                       &obsDataPtr->transformPeriod,
+                                       paramsSize))
+        {
+            // Set the Observation transform, with its bucket period (if any).
             le_result_t result = admin_SetTransform(obsDataPtr->obsName,
-                (obsDataPtr->transform), NULL, 0);
+                (obsDataPtr->transform), &obsDataPtr->transformPeriod, paramsSize);
             if (result != LE_OK)
             {
                 char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
@@ -524,7 +607,11 @@ static bool ObsJsonExtractionHelper
 
     if (!parseContextPtr->validateOnly)
     {
-        if ((obsDataPtr->bitmask & PARSER_OBS_JSON_EXT_MASK) || !IsANewObs)
+        char currentExtraction[ADMIN_MAX_JSON_EXTRACTOR_LEN + 1] = "";
+        admin_GetJsonExtraction(obsDataPtr->obsName, currentExtraction, sizeof(currentExtraction));
+
+        if (   ((obsDataPtr->bitmask & PARSER_OBS_JSON_EXT_MASK) || !IsANewObs)
+            && (strcmp(currentExtraction, obsDataPtr->jsonExtraction) != 0))
         {
             // Set the JSON Extraction
             le_result_t result = admin_SetJsonExtraction(obsDataPtr->obsName,
@@ -606,6 +693,11 @@ static void OneObservationCb
         return;
     }
 
+    if (!ObsBufferPrecisionHelper(obsDataPtr, newObs, context))
+    {
+        return;
+    }
+
     if (!ObsTransformFunctionHelper(obsDataPtr, newObs, context))
     {
         return;
@@ -741,7 +833,16 @@ static void StatesStartCb
     void* context    ///< [IN] Context pointer
 )
 {
-    LE_UNUSED(context);
+    ParseContext_t* parseContextPtr = (ParseContext_t*) context;
+
+    // States are applied after observations.  If the observations haven't been processed yet,
+    // leave the states for a second parse.
+    if (!parseContextPtr->obsParsed)
+    {
+        parseContextPtr->statesSkipped = true;
+        return;
+    }
+
     // we've found observations, so we can move on with states.
     parser_Callbacks_t* callbacksPtr = parser_GetCallbacks(
             parser_GetParseSessionRef());
@@ -764,10 +865,16 @@ static void ObservationsEndCb
     void* context    ///< [IN] Context pointer
 )
 {
-    LE_UNUSED(context);
+    ParseContext_t* parseContextPtr = (ParseContext_t*) context;
 
-    // Observations ended, stop the parser now. We will start it again for states.
-    parser_StopParse(parser_GetParseSessionRef());
+    parseContextPtr->obsParsed = true;
+
+    // If the states were already passed over, stop the parser now. We will start it again for
+    // states.  Otherwise, carry on to pick the states up in this same parse.
+    if (parseContextPtr->statesSkipped)
+    {
+        parser_StopParse(parser_GetParseSessionRef());
+    }
 }
 
 
@@ -808,6 +915,7 @@ static void ObservationsStartCb
 le_result_t configService_ParseConfig
 (
     int fd,                                ///< [IN] File descriptor of the configuration file.
+    bool isCbor,                           ///< [IN] true if the file is CBOR rather than JSON.
     bool validateOnly,                     ///< [IN] Boolean to indicate if this is a validate or
                                             /// apply operation.
     parseError_t* parseErrorPtr            ///< [OUT] Pointer to the Parse Error structure.
@@ -820,27 +928,34 @@ le_result_t configService_ParseConfig
 
     parser_Callbacks_t callbacks = {};
 
-    // At the beginning the only thing we care about is the start of the "o" section.
-    // so we'll register a callback for that event and then take it from there.
+    // Both encodings share the same schema and callbacks.
+    void (*parseFunc)(int, parser_Callbacks_t*, void*) = (isCbor ? parser_ParseCbor : parser_Parse);
+
+    // At the beginning the only thing we care about is the start of the "o" and "s" sections.
+    // so we'll register callbacks for those events and then take it from there.  If the "s"
+    // section comes after the "o" section (as it normally does), both are processed in this one
+    // pass over the file.
     callbacks.oObject = ObservationsStartCb;
+    callbacks.sObject = StatesStartCb;
     callbacks.error = ErrorEventCb;
 
     // Start parsing the config file to process observations ("o")
-    parser_Parse(fd, &callbacks, &parseContext);
+    parseFunc(fd, &callbacks, &parseContext);
 
-    if (parseContext.result == LE_OK)
+    if ((parseContext.result == LE_OK) && parseContext.statesSkipped)
     {
-        // At this point observations are parsed but states are not.
+        // At this point observations are parsed but states are not, because they came first.
         // so we'll parse again but with state callbacks enabled.
         // need to empty the callbacks because we don't want to get callbacks for observations for
         // a second time.
         memset(&callbacks, 0, sizeof(parser_Callbacks_t));
 
+        parseContext.obsParsed = true;
         callbacks.sObject = StatesStartCb;
         callbacks.error = ErrorEventCb;
         lseek(fd, 0, SEEK_SET);
         // Start parsing the config file to process states ("s")
-        parser_Parse(fd, &callbacks, &parseContext);
+        parseFunc(fd, &callbacks, &parseContext);
     }
 
     return parseContext.result;
@@ -30,10 +30,21 @@
 #include "ioPoint.h"
 #include "obs.h"
 #include "ioService.h"
+#include "queryService.h"
 #include "adminService.h"
 #include "snapshot.h"
+#include "jsonWorker.h"
 #include "configService.h"
 
+/// Maximum number of pools that can be registered with hub_RegisterPool().
+#define MAX_REGISTERED_POOLS 32
+
+/// Pools registered with hub_RegisterPool(), in order of registration.
+static le_mem_PoolRef_t RegisteredPools[MAX_REGISTERED_POOLS];
+
+/// Number of pools in RegisteredPools.
+static size_t RegisteredPoolCount = 0;
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -53,8 +64,12 @@ void initDataHub(void)
     obs_Init();
     resTree_Init();
     ioService_Init();
+    queryService_Init();
     adminService_Init();
     snapshot_Init();
+#ifdef DHUB_JSON_WORKERS
+    jsonWorker_Init();
+#endif
 
     LE_INFO("Data Hub started.");
 }
@@ -238,6 +253,45 @@ void* hub_MemAlloc
 #endif
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Register a datahub pool whose size can be configured in the .cdef, so its usage can be
+ *  reported by admin_GetPoolStats().
+ */
+//--------------------------------------------------------------------------------------------------
+void hub_RegisterPool
+(
+    le_mem_PoolRef_t    pool    ///< [IN] Pool created by le_mem_InitStaticPool().
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(RegisteredPoolCount < MAX_REGISTERED_POOLS);
+
+    RegisteredPools[RegisteredPoolCount++] = pool;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Get one of the datahub pools registered with hub_RegisterPool().
+ *
+ *  @return
+ *      The pool, or NULL if the index is past the last pool registered.
+ */
+//--------------------------------------------------------------------------------------------------
+le_mem_PoolRef_t hub_GetPool
+(
+    size_t              index   ///< [IN] Index of the pool, in order of registration.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (index >= RegisteredPoolCount)
+    {
+        return NULL;
+    }
+
+    return RegisteredPools[index];
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Is resource Path malformed?
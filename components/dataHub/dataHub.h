@@ -102,6 +102,30 @@ void* hub_MemAlloc
     le_mem_PoolRef_t    pool    ///< [IN] Pool from which the object is to be allocated.
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Register a datahub pool whose size can be configured in the .cdef, so its usage can be
+ *  reported by admin_GetPoolStats().
+ */
+//--------------------------------------------------------------------------------------------------
+void hub_RegisterPool
+(
+    le_mem_PoolRef_t    pool    ///< [IN] Pool created by le_mem_InitStaticPool().
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Get one of the datahub pools registered with hub_RegisterPool().
+ *
+ *  @return
+ *      The pool, or NULL if the index is past the last pool registered.
+ */
+//--------------------------------------------------------------------------------------------------
+le_mem_PoolRef_t hub_GetPool
+(
+    size_t              index   ///< [IN] Index of the pool, in order of registration.
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Is resource Path malformed?
@@ -37,6 +37,25 @@ typedef struct DataSample
 }
 DataSample_t;
 
+/// Largest string (including the null terminator) that is stored inside its Data Sample object.
+#ifndef DHUB_INLINE_STRING_BYTES
+#define DHUB_INLINE_STRING_BYTES    48
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * String or JSON Data Sample with its value stored inline, right after the sample, instead of in
+ * a separate block from the StringPool.  The sample's stringPtr points to the inline copy, so
+ * these are read the same way as other string samples.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    DataSample_t sample;                    ///< The Data Sample.  Must be first.
+    char str[DHUB_INLINE_STRING_BYTES];     ///< The string value.
+}
+InlineStringSample_t;
+
 /// Size of largest allowed strings in samples.
 #define STRING_LARGE_BYTES  HUB_MAX_STRING_BYTES
 /// Size of medium sized strings in samples.
@@ -50,6 +69,9 @@ DataSample_t;
 /// Default string based sample pool size. This may be overridden in the .cdef.
 #define DEFAULT_STRING_BASED_SAMPLE_POOL_SIZE 1000
 
+/// Default inline string sample pool size. This may be overridden in the .cdef.
+#define DEFAULT_INLINE_STRING_SAMPLE_POOL_SIZE 200
+
 /// Default number of large string pool entries.  This may be overridden in the .cdef.
 #define DEFAULT_LARGE_STRING_POOL_SIZE 5
 
@@ -72,6 +94,11 @@ static le_mem_PoolRef_t StringBasedDataSamplePool = NULL;
 LE_MEM_DEFINE_STATIC_POOL(StringBasedDataSamplePool, DEFAULT_STRING_BASED_SAMPLE_POOL_SIZE,
                           sizeof(DataSample_t));
 
+/// Pool of String based Data Sample objects with short values stored inline (string and json).
+static le_mem_PoolRef_t InlineStringSamplePool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(InlineStringSamplePool, DEFAULT_INLINE_STRING_SAMPLE_POOL_SIZE,
+                          sizeof(InlineStringSample_t));
+
 /// Pool for holding strings.
 static le_mem_PoolRef_t StringPool = NULL;
 LE_MEM_DEFINE_STATIC_POOL(StringPool, DEFAULT_LARGE_STRING_POOL_SIZE, STRING_LARGE_BYTES);
@@ -111,14 +138,22 @@ void dataSample_Init
 
     NonStringDataSamplePool = le_mem_InitStaticPool(NonStringDataSamplePool,
                                 DEFAULT_NON_STRING_SAMPLE_POOL_SIZE, sizeof(DataSample_t));
+    hub_RegisterPool(NonStringDataSamplePool);
 
     StringBasedDataSamplePool = le_mem_InitStaticPool(StringBasedDataSamplePool,
                                   DEFAULT_STRING_BASED_SAMPLE_POOL_SIZE, sizeof(DataSample_t));
+    hub_RegisterPool(StringBasedDataSamplePool);
 
     le_mem_SetDestructor(StringBasedDataSamplePool, StringSampleDestructor);
 
+    InlineStringSamplePool = le_mem_InitStaticPool(InlineStringSamplePool,
+                               DEFAULT_INLINE_STRING_SAMPLE_POOL_SIZE,
+                               sizeof(InlineStringSample_t));
+    hub_RegisterPool(InlineStringSamplePool);
+
     layeredStringPool = le_mem_InitStaticPool(StringPool, DEFAULT_LARGE_STRING_POOL_SIZE,
                             STRING_LARGE_BYTES);
+    hub_RegisterPool(layeredStringPool);
     layeredStringPool = le_mem_CreateReducedPool(layeredStringPool, "MedStringPool",
                             MED_STRING_POOL_SIZE, STRING_MED_BYTES);
     StringPool = le_mem_CreateReducedPool(layeredStringPool, "SmallStringPool",
@@ -126,6 +161,28 @@ void dataSample_Init
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the timestamp of a newly created Data Sample.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void SetSampleTimestamp
+(
+    DataSample_t* samplePtr,
+    Timestamp_t timestamp       ///< The timestamp (IO_NOW = now).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (timestamp == IO_NOW)
+    {
+        le_clk_Time_t currentTime = le_clk_GetAbsoluteTime();
+        timestamp = (((double)(currentTime.usec)) / 1000000) + currentTime.sec;
+    }
+
+    samplePtr->timestamp = timestamp;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates a new Data Sample object and returns a pointer to it.
@@ -150,13 +207,7 @@ static inline DataSample_t* CreateSample
         return NULL;
     }
 
-    if (timestamp == IO_NOW)
-    {
-        le_clk_Time_t currentTime = le_clk_GetAbsoluteTime();
-        timestamp = (((double)(currentTime.usec)) / 1000000) + currentTime.sec;
-    }
-
-    samplePtr->timestamp = timestamp;
+    SetSampleTimestamp(samplePtr, timestamp);
 
     return samplePtr;
 }
@@ -253,6 +304,23 @@ dataSample_Ref_t dataSample_CreateString
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // Short strings are stored inside the sample, saving the allocation of a separate block.
+    size_t valueBytes = strlen(value) + 1;
+    if (valueBytes <= DHUB_INLINE_STRING_BYTES)
+    {
+        InlineStringSample_t* inlinePtr = hub_MemAlloc(InlineStringSamplePool);
+        if (inlinePtr != NULL)
+        {
+            SetSampleTimestamp(&inlinePtr->sample, timestamp);
+            memcpy(inlinePtr->str, value, valueBytes);
+            inlinePtr->sample.value.stringPtr = inlinePtr->str;
+
+            return &inlinePtr->sample;
+        }
+
+        // If the inline pool is exhausted, fall back to a separately allocated string.
+    }
+
     DataSample_t *samplePtr = CreateSample(StringBasedDataSamplePool, timestamp);
     if (samplePtr)
     {
@@ -503,30 +571,22 @@ le_result_t dataSample_ConvertToJson
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Extract an object member or array element from a JSON data value, based on a given
- * extraction specifier.
- *
- * The extraction specifiers look like "x" or "x.y" or "[3]" or "x[3].y", etc.
+ * Create a data sample from the result of a JSON extraction.
  *
  * @return Reference to the extracted data sample, or NULL if failed.
  */
 //--------------------------------------------------------------------------------------------------
-dataSample_Ref_t dataSample_ExtractJson
+static dataSample_Ref_t CreateExtractedSample
 (
-    dataSample_Ref_t sampleRef, ///< [IN] Original JSON data sample to extract from.
+    dataSample_Ref_t sampleRef, ///< [IN] Original JSON data sample that was extracted from.
     const char* extractionSpec, ///< [IN] the extraction specification.
+    le_result_t result,         ///< [IN] Result of the extraction.
+    const char* resultBuff,     ///< [IN] The extracted JSON value.
+    json_DataType_t jsonType,   ///< [IN] The JSON type of the extracted value.
     io_DataType_t* dataTypePtr  ///< [OUT] Ptr to where to put the data type of the extracted object
 )
 //--------------------------------------------------------------------------------------------------
 {
-    char resultBuff[HUB_MAX_STRING_BYTES];
-    json_DataType_t jsonType;
-
-    le_result_t result = json_Extract(resultBuff,
-                                      sizeof(resultBuff),
-                                      dataSample_GetJson(sampleRef),
-                                      extractionSpec,
-                                      &jsonType);
     if (result != LE_OK)
     {
         LE_WARN("Failed to extract '%s' from JSON '%s'.",
@@ -574,6 +634,98 @@ dataSample_Ref_t dataSample_ExtractJson
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Extract an object member or array element from a JSON data value, based on a given
+ * extraction specifier.
+ *
+ * The extraction specifiers look like "x" or "x.y" or "[3]" or "x[3].y", etc.
+ *
+ * @return Reference to the extracted data sample, or NULL if failed.
+ */
+//--------------------------------------------------------------------------------------------------
+dataSample_Ref_t dataSample_ExtractJson
+(
+    dataSample_Ref_t sampleRef, ///< [IN] Original JSON data sample to extract from.
+    const char* extractionSpec, ///< [IN] the extraction specification.
+    io_DataType_t* dataTypePtr  ///< [OUT] Ptr to where to put the data type of the extracted object
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char resultBuff[HUB_MAX_STRING_BYTES];
+    json_DataType_t jsonType = JSON_TYPE_NULL;
+
+    le_result_t result = json_Extract(resultBuff,
+                                      sizeof(resultBuff),
+                                      dataSample_GetJson(sampleRef),
+                                      extractionSpec,
+                                      &jsonType);
+
+    return CreateExtractedSample(sampleRef, extractionSpec, result, resultBuff, jsonType,
+                                 dataTypePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Extract an object member or array element from a JSON data value, based on an extraction
+ * specifier compiled by json_CompileExtraction().
+ *
+ * @return Reference to the extracted data sample, or NULL if failed.
+ */
+//--------------------------------------------------------------------------------------------------
+dataSample_Ref_t dataSample_ExtractJsonCompiled
+(
+    dataSample_Ref_t sampleRef, ///< [IN] Original JSON data sample to extract from.
+    const json_Extraction_t* extractionPtr, ///< [IN] the compiled extraction specification.
+    io_DataType_t* dataTypePtr  ///< [OUT] Ptr to where to put the data type of the extracted object
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char resultBuff[HUB_MAX_STRING_BYTES];
+    json_DataType_t jsonType = JSON_TYPE_NULL;
+
+    le_result_t result = json_ExtractCompiled(resultBuff,
+                                              sizeof(resultBuff),
+                                              dataSample_GetJson(sampleRef),
+                                              extractionPtr,
+                                              &jsonType);
+
+    return CreateExtractedSample(sampleRef, extractionPtr->specPtr, result, resultBuff, jsonType,
+                                 dataTypePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a data sample from the value found in a JSON data value by json_ExtractMultiple().
+ *
+ * @return Reference to the extracted data sample, or NULL if failed.
+ */
+//--------------------------------------------------------------------------------------------------
+dataSample_Ref_t dataSample_ExtractJsonSpan
+(
+    dataSample_Ref_t sampleRef, ///< [IN] Original JSON data sample the span was found in.
+    const json_Span_t* spanPtr, ///< [IN] The span of the value to extract.
+    const char* extractionSpec, ///< [IN] the extraction specification (for logging).
+    io_DataType_t* dataTypePtr  ///< [OUT] Ptr to where to put the data type of the extracted object
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char resultBuff[HUB_MAX_STRING_BYTES];
+    json_DataType_t jsonType = JSON_TYPE_NULL;
+
+    le_result_t result = json_CopySpan(resultBuff,
+                                       sizeof(resultBuff),
+                                       dataSample_GetJson(sampleRef),
+                                       spanPtr,
+                                       &jsonType);
+
+    return CreateExtractedSample(sampleRef, extractionSpec, result, resultBuff, jsonType,
+                                 dataTypePtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the timestamp of a Data Sample.
@@ -588,3 +740,22 @@ void dataSample_SetTimestamp
 {
     sample->timestamp = timestamp;
 }
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the value of a numeric Data Sample.
+ *
+ * @warning Only for use on samples that are not shared, because the value of a sample is
+ *          otherwise expected never to change.
+ */
+//--------------------------------------------------------------------------------------------------
+void dataSample_SetNumeric
+(
+    dataSample_Ref_t sample,
+    double value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    sample->value.numeric = value;
+}
@@ -15,6 +15,8 @@
 #ifndef DATA_SAMPLE_H_INCLUDE_GUARD
 #define DATA_SAMPLE_H_INCLUDE_GUARD
 
+#include "json.h"
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -252,6 +254,38 @@ dataSample_Ref_t dataSample_ExtractJson
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Extract an object member or array element from a JSON data value, based on an extraction
+ * specifier compiled by json_CompileExtraction().
+ *
+ * @return Reference to the extracted data sample, or NULL if failed.
+ */
+//--------------------------------------------------------------------------------------------------
+dataSample_Ref_t dataSample_ExtractJsonCompiled
+(
+    dataSample_Ref_t sampleRef, ///< [IN] Original JSON data sample to extract from.
+    const json_Extraction_t* extractionPtr, ///< [IN] the compiled extraction specification.
+    io_DataType_t* dataTypePtr  ///< [OUT] Ptr to where to put the data type of the extracted object
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a data sample from the value found in a JSON data value by json_ExtractMultiple().
+ *
+ * @return Reference to the extracted data sample, or NULL if failed.
+ */
+//--------------------------------------------------------------------------------------------------
+dataSample_Ref_t dataSample_ExtractJsonSpan
+(
+    dataSample_Ref_t sampleRef, ///< [IN] Original JSON data sample the span was found in.
+    const json_Span_t* spanPtr, ///< [IN] The span of the value to extract.
+    const char* extractionSpec, ///< [IN] the extraction specification (for logging).
+    io_DataType_t* dataTypePtr  ///< [OUT] Ptr to where to put the data type of the extracted object
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the timestamp of a Data Sample.
@@ -264,4 +298,19 @@ void dataSample_SetTimestamp
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the value of a numeric Data Sample.
+ *
+ * @warning Only for use on samples that are not shared, because the value of a sample is
+ *          otherwise expected never to change.
+ */
+//--------------------------------------------------------------------------------------------------
+void dataSample_SetNumeric
+(
+    dataSample_Ref_t sample,
+    double value
+);
+
+
 #endif // DATA_SAMPLE_H_INCLUDE_GUARD
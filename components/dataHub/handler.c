@@ -24,6 +24,14 @@ typedef struct handler
     io_DataType_t dataType;    ///< Data type of the handler callback (only for Push handlers).
     void* callbackPtr;  ///< The callback function pointer.
     void* contextPtr;   ///< The context pointer provided by the client.
+    bool isFiltered;    ///< true if the filter settings below are in effect.
+    double minPeriod;   ///< Minimum time between deliveries (s).  0 or NAN = no minimum.
+    double changeBy;    ///< Minimum change since the last delivered value.  0 or NAN = any.
+    double lowLimit;    ///< Lowest numeric value delivered.  NAN = no limit.
+    double highLimit;   ///< Highest numeric value delivered.  NAN = no limit.
+    uint32_t lastPushTime;  ///< Relative time (ms) of the last delivery (if minPeriod is set).
+    io_DataType_t lastDataType; ///< Data type of the last delivered sample.
+    dataSample_Ref_t lastSampleRef; ///< Last delivered sample (NULL if none yet, or unfiltered).
 }
 Handler_t;
 
@@ -63,6 +71,54 @@ void handler_Init
 #endif
     HandlerPool = le_mem_InitStaticPool(HandlerPool, DEFAULT_PUSH_HANDLER_POOL_SIZE,
                     sizeof(Handler_t));
+    hub_RegisterPool(HandlerPool);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize an empty list of handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+void handler_InitList
+(
+    handler_List_t* listPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t i;
+
+    for (i = 0; i < HANDLER_DATA_TYPE_COUNT; i++)
+    {
+        listPtr->lists[i] = LE_DLS_LIST_INIT;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a given list of handlers is empty.
+ *
+ * @return true if there are no handlers in the list.
+ */
+//--------------------------------------------------------------------------------------------------
+bool handler_IsListEmpty
+(
+    const handler_List_t* listPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t i;
+
+    for (i = 0; i < HANDLER_DATA_TYPE_COUNT; i++)
+    {
+        if (!le_dls_IsEmpty(&listPtr->lists[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 
@@ -75,7 +131,7 @@ void handler_Init
 //--------------------------------------------------------------------------------------------------
 hub_HandlerRef_t handler_Add
 (
-    le_dls_List_t* listPtr,
+    handler_List_t* listPtr,
     io_DataType_t dataType,
     void* callbackPtr,
     void* contextPtr
@@ -90,13 +146,17 @@ hub_HandlerRef_t handler_Add
         return NULL;
     }
 
+    LE_ASSERT((size_t)dataType < HANDLER_DATA_TYPE_COUNT);
+
     handlerPtr->link = LE_DLS_LINK_INIT;
-    handlerPtr->listPtr = listPtr;
+    handlerPtr->listPtr = &listPtr->lists[dataType];
     handlerPtr->dataType = dataType;
     handlerPtr->callbackPtr = callbackPtr;
     handlerPtr->contextPtr = contextPtr;
+    handlerPtr->isFiltered = false;
+    handlerPtr->lastSampleRef = NULL;
 
-    le_dls_Queue(listPtr, &handlerPtr->link);
+    le_dls_Queue(handlerPtr->listPtr, &handlerPtr->link);
 
     LE_DEBUG("Added Handler %p for %d", (hub_HandlerRef_t)handlerPtr, dataType);
 
@@ -119,10 +179,42 @@ static void DeleteHandler
 {
     LE_DEBUG("Deleting handler %p", handlerPtr);
 
+    if (handlerPtr->lastSampleRef != NULL)
+    {
+        le_mem_Release(handlerPtr->lastSampleRef);
+    }
+
     le_mem_Release(handlerPtr);
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make a push handler filter the samples it is called with, in the same way an Observation with
+ * the same settings would (see obs_ShouldAccept()), so that only the samples that pass get
+ * delivered to the client.
+ */
+//--------------------------------------------------------------------------------------------------
+void handler_SetFilter
+(
+    hub_HandlerRef_t handlerRef,
+    double minPeriod,   ///< Minimum time between deliveries (s).  0 or NAN = no minimum.
+    double changeBy,    ///< Minimum change since the last delivered value.  0 or NAN = any.
+    double lowLimit,    ///< Lowest numeric value delivered.  NAN = no limit.
+    double highLimit    ///< Highest numeric value delivered.  NAN = no limit.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Handler_t* handlerPtr = (Handler_t*) handlerRef;
+
+    handlerPtr->isFiltered = true;
+    handlerPtr->minPeriod = minPeriod;
+    handlerPtr->changeBy = changeBy;
+    handlerPtr->lowLimit = lowLimit;
+    handlerPtr->highLimit = highLimit;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Remove a Handler from a given list.
@@ -162,25 +254,100 @@ le_result_t handler_Remove
 //--------------------------------------------------------------------------------------------------
 void handler_RemoveAll
 (
-    le_dls_List_t* listPtr
+    handler_List_t* listPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
     le_dls_Link_t* linkPtr;
+    size_t i;
 
-    while (NULL != (linkPtr = le_dls_Pop(listPtr)))
+    for (i = 0; i < HANDLER_DATA_TYPE_COUNT; i++)
     {
-        DeleteHandler(CONTAINER_OF(linkPtr, Handler_t, link));
+        while (NULL != (linkPtr = le_dls_Pop(&listPtr->lists[i])))
+        {
+            DeleteHandler(CONTAINER_OF(linkPtr, Handler_t, link));
+        }
     }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Call a given push handler, passing it a given data sample.
+ * Check whether a numeric value is outside a filtered push handler's limits.  Like an
+ * Observation's, a low limit higher than the high limit makes a deadband between them.
+ *
+ * @return true if the value should not be delivered.
  */
 //--------------------------------------------------------------------------------------------------
-static void CallPushHandler
+static bool IsOutsideLimits
+(
+    const Handler_t* handlerPtr,
+    double numericValue
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (   (!isnan(handlerPtr->highLimit))
+        && (!isnan(handlerPtr->lowLimit))
+        && (handlerPtr->lowLimit > handlerPtr->highLimit)  )
+    {
+        return ((numericValue < handlerPtr->lowLimit) && (numericValue > handlerPtr->highLimit));
+    }
+
+    return (   ((!isnan(handlerPtr->lowLimit)) && (numericValue < handlerPtr->lowLimit))
+            || ((!isnan(handlerPtr->highLimit)) && (numericValue > handlerPtr->highLimit)) );
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a data sample differs by less than a filtered push handler's changeBy setting
+ * from the last sample delivered to it, which must be of the same data type.
+ *
+ * @return true if the sample should not be delivered.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsUnchanged
+(
+    const Handler_t* handlerPtr,
+    io_DataType_t dataType,     ///< Data type of the data sample.
+    dataSample_Ref_t sampleRef  ///< Data sample.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    dataSample_Ref_t lastSampleRef = handlerPtr->lastSampleRef;
+
+    switch (dataType)
+    {
+        case IO_DATA_TYPE_TRIGGER:
+            return false;
+
+        case IO_DATA_TYPE_BOOLEAN:
+            return (dataSample_GetBoolean(sampleRef) == dataSample_GetBoolean(lastSampleRef));
+
+        case IO_DATA_TYPE_NUMERIC:
+            return (  fabs(dataSample_GetNumeric(sampleRef) - dataSample_GetNumeric(lastSampleRef))
+                    < handlerPtr->changeBy);
+
+        case IO_DATA_TYPE_STRING:
+        case IO_DATA_TYPE_JSON:
+            return (0 == strcmp(dataSample_GetString(sampleRef),
+                                dataSample_GetString(lastSampleRef)));
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Determine whether a data sample should be delivered to a given push handler, applying the
+ * handler's filter (if any) with the same semantics as obs_ShouldAccept().  If it should, the
+ * sample is remembered for comparison with the next one.
+ *
+ * @return true if the sample should be delivered.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ShouldDeliver
 (
     Handler_t* handlerPtr,
     io_DataType_t dataType,     ///< Data type of the data sample.
@@ -188,6 +355,76 @@ static void CallPushHandler
 )
 //--------------------------------------------------------------------------------------------------
 {
+    if (!handlerPtr->isFiltered)
+    {
+        return true;
+    }
+
+    // Check the high limit and low limit before other limits.
+    if (   (dataType == IO_DATA_TYPE_NUMERIC)
+        && IsOutsideLimits(handlerPtr, dataSample_GetNumeric(sampleRef)))
+    {
+        return false;
+    }
+
+    bool hasMinPeriod = ((handlerPtr->minPeriod != 0) && (!isnan(handlerPtr->minPeriod)));
+    uint32_t now = 0;
+
+    if (hasMinPeriod)
+    {
+        le_clk_Time_t relativeTime = le_clk_GetRelativeTime();
+        now = relativeTime.sec * 1000 + relativeTime.usec / 1000;
+    }
+
+    // The changeBy and minPeriod filters need a previously delivered sample to compare against.
+    if (handlerPtr->lastSampleRef != NULL)
+    {
+        // If the data type has changed, the samples can't be compared.
+        if (   (handlerPtr->changeBy != 0)
+            && (!isnan(handlerPtr->changeBy))
+            && (dataType == handlerPtr->lastDataType)
+            && IsUnchanged(handlerPtr, dataType, sampleRef))
+        {
+            return false;
+        }
+
+        if (hasMinPeriod && ((now - handlerPtr->lastPushTime) < (handlerPtr->minPeriod * 1000)))
+        {
+            return false;
+        }
+
+        le_mem_Release(handlerPtr->lastSampleRef);
+    }
+
+    le_mem_AddRef(sampleRef);
+    handlerPtr->lastSampleRef = sampleRef;
+    handlerPtr->lastDataType = dataType;
+    handlerPtr->lastPushTime = now;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call a given push handler, passing it a given data sample, unless the handler filters it out.
+ *
+ * @return true if the handler was called.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CallPushHandler
+(
+    Handler_t* handlerPtr,
+    io_DataType_t dataType,     ///< Data type of the data sample.
+    dataSample_Ref_t sampleRef  ///< Data sample.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!ShouldDeliver(handlerPtr, dataType, sampleRef))
+    {
+        return false;
+    }
+
     if (handlerPtr->dataType == dataType)
     {
         double timestamp = dataSample_GetTimestamp(sampleRef);
@@ -278,6 +515,8 @@ static void CallPushHandler
                         handlerPtr->contextPtr);
         }
     }
+
+    return true;
 }
 
 
@@ -301,33 +540,73 @@ void handler_Call
     }
     else
     {
-        CallPushHandler(handlerPtr, dataType, sampleRef);
+        (void)CallPushHandler(handlerPtr, dataType, sampleRef);
     }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Call all the push handler functions in a given list that match a given data type.
+ * Call all the push handler functions on one of the per-data-type lists of handlers.
+ *
+ * @return The number of handlers called (excluding those that filtered the sample out).
  */
 //--------------------------------------------------------------------------------------------------
-void handler_CallAll
+static size_t CallTypeList
 (
-    le_dls_List_t* listPtr,         ///< List of push handlers
+    le_dls_List_t* listPtr,         ///< List of push handlers of a single data type
     io_DataType_t dataType,         ///< Data Type of the data sample
     dataSample_Ref_t sampleRef      ///< Data Sample to pass to the push handlers that are called.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // Iterate over the Push Handler List and call each one that is a data type match.
     le_dls_Link_t* linkPtr = le_dls_Peek(listPtr);
+    size_t count = 0;
 
     while (linkPtr != NULL)
     {
         Handler_t* handlerPtr = CONTAINER_OF(linkPtr, Handler_t, link);
 
-        CallPushHandler(handlerPtr, dataType, sampleRef);
+        if (CallPushHandler(handlerPtr, dataType, sampleRef))
+        {
+            count++;
+        }
 
         linkPtr = le_dls_PeekNext(listPtr, linkPtr);
     }
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call all the push handler functions in a given list that match a given data type.
+ *
+ * @return The number of handlers called.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t handler_CallAll
+(
+    handler_List_t* listPtr,        ///< List of push handlers
+    io_DataType_t dataType,         ///< Data Type of the data sample
+    dataSample_Ref_t sampleRef      ///< Data Sample to pass to the push handlers that are called.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Handlers of the sample's own type get it as is.
+    size_t count = CallTypeList(&listPtr->lists[dataType], dataType, sampleRef);
+
+    // String and JSON handlers accept every type of sample, converted to a string or JSON value.
+    // No other handlers can receive this sample, so their lists don't need to be visited.
+    if (dataType != IO_DATA_TYPE_STRING)
+    {
+        count += CallTypeList(&listPtr->lists[IO_DATA_TYPE_STRING], dataType, sampleRef);
+    }
+    if (dataType != IO_DATA_TYPE_JSON)
+    {
+        count += CallTypeList(&listPtr->lists[IO_DATA_TYPE_JSON], dataType, sampleRef);
+    }
+
+    return count;
 }
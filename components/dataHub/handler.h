@@ -11,6 +11,23 @@
 #ifndef HANDLER_H_INCLUDE_GUARD
 #define HANDLER_H_INCLUDE_GUARD
 
+/// Number of different push handler data types.
+#define HANDLER_DATA_TYPE_COUNT (IO_DATA_TYPE_JSON + 1)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A set of push handlers, kept in a separate list for each data type so that pushing a sample
+ * only visits the handlers that can receive it.
+ *
+ * @warning DO NOT reference the members of this structure anywhere but handler.c.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_List_t lists[HANDLER_DATA_TYPE_COUNT]; ///< Handlers, indexed by handler data type.
+}
+handler_List_t;
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -25,6 +42,30 @@ void handler_Init
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize an empty list of handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+void handler_InitList
+(
+    handler_List_t* listPtr
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a given list of handlers is empty.
+ *
+ * @return true if there are no handlers in the list.
+ */
+//--------------------------------------------------------------------------------------------------
+bool handler_IsListEmpty
+(
+    const handler_List_t* listPtr
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add a Handler to a given list.
@@ -34,13 +75,30 @@ void handler_Init
 //--------------------------------------------------------------------------------------------------
 hub_HandlerRef_t handler_Add
 (
-    le_dls_List_t* listPtr,
+    handler_List_t* listPtr,
     io_DataType_t dataType,
     void* callbackPtr,
     void* contextPtr
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make a push handler filter the samples it is called with, in the same way an Observation with
+ * the same settings would (see obs_ShouldAccept()), so that only the samples that pass get
+ * delivered to the client.
+ */
+//--------------------------------------------------------------------------------------------------
+void handler_SetFilter
+(
+    hub_HandlerRef_t handlerRef,
+    double minPeriod,   ///< Minimum time between deliveries (s).  0 or NAN = no minimum.
+    double changeBy,    ///< Minimum change since the last delivered value.  0 or NAN = any.
+    double lowLimit,    ///< Lowest numeric value delivered.  NAN = no limit.
+    double highLimit    ///< Highest numeric value delivered.  NAN = no limit.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Remove a Handler from whatever list it is on.
@@ -63,7 +121,7 @@ le_result_t handler_Remove
 //--------------------------------------------------------------------------------------------------
 void handler_RemoveAll
 (
-    le_dls_List_t* listPtr
+    handler_List_t* listPtr
 );
 
 
@@ -83,11 +141,13 @@ void handler_Call
 //--------------------------------------------------------------------------------------------------
 /**
  * Call all the push handler functions in a given list that match a given data type.
+ *
+ * @return The number of handlers called.
  */
 //--------------------------------------------------------------------------------------------------
-void handler_CallAll
+size_t handler_CallAll
 (
-    le_dls_List_t* listPtr,         ///< List of push handlers
+    handler_List_t* listPtr,        ///< List of push handlers
     io_DataType_t dataType,         ///< Data Type of the data sample
     dataSample_Ref_t sampleRef      ///< Data Sample to pass to the push handlers that are called.
 );
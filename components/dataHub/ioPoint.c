@@ -71,6 +71,7 @@ void ioPoint_Init
     IoResourcePool = le_mem_InitStaticPool(IoResourcePool, DEFAULT_IO_RESOURCE_POOL_SIZE,
                         sizeof(IoResource_t));
     le_mem_SetDestructor(IoResourcePool, IoResourceDestructor);
+    hub_RegisterPool(IoResourcePool);
 }
 
 
@@ -397,6 +398,7 @@ le_result_t ioPoint_DoTypeCoercion
                 case IO_DATA_TYPE_JSON:
 
                     toSample = dataSample_CreateString(timestamp, dataSample_GetJson(fromSample));
+                    le_mem_Release(fromSample);
                     break;
 
             }
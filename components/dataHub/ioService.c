@@ -8,7 +8,16 @@
 
 #include "dataHub.h"
 #include "handler.h"
+#include "resource.h"
+#include "pushTrace.h"
 #include "json.h"
+#include "jsonWorker.h"
+#include "ioStreamRing.h"
+
+#if LE_CONFIG_LINUX
+#   include <sys/eventfd.h>
+#   include <sys/mman.h>
+#endif
 
 
 //--------------------------------------------------------------------------------------------------
@@ -54,6 +63,94 @@ LE_MEM_DEFINE_STATIC_POOL(UpdateStartEndHandlerPool,
 //--------------------------------------------------------------------------------------------------
 static unsigned int PushHandlerCount;
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handle for an Input or Output resource, returned by io_GetResourceHandle().
+ *
+ * These are allocated from the ResourceHandlePool and kept on the ResourceHandleList.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t link;                 ///< Used to link into the ResourceHandleList.
+    io_ResourceRef_t ref;               ///< Safe reference to this handle.
+    resTree_EntryRef_t entryRef;        ///< Resource the handle refers to (reference counted).
+    le_msg_SessionRef_t sessionRef;     ///< Client session that owns the handle.
+}
+ResourceHandle_t;
+
+/// Default number of resource handles.  This can be overridden in the .cdef.
+#define DEFAULT_RESOURCE_HANDLE_POOL_SIZE 10
+
+/// Pool of ResourceHandle objects.
+static le_mem_PoolRef_t ResourceHandlePool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(ResourceHandlePool,
+                          DEFAULT_RESOURCE_HANDLE_POOL_SIZE,
+                          sizeof(ResourceHandle_t));
+
+/// Safe references to ResourceHandle objects.
+static le_ref_MapRef_t ResourceHandleMap = NULL;
+LE_REF_DEFINE_STATIC_MAP(ResourceHandleMap, DEFAULT_RESOURCE_HANDLE_POOL_SIZE);
+
+/// List of all ResourceHandle objects.
+static le_dls_List_t ResourceHandleList = LE_DLS_LIST_INIT;
+
+#if LE_CONFIG_LINUX
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stream of samples pushed to an Input or Output through a ring in shared memory, returned by
+ * io_OpenStream().
+ *
+ * These are allocated from the StreamPool and kept on the StreamList.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t link;                 ///< Used to link into the StreamList.
+    io_StreamRef_t ref;                 ///< Safe reference to this stream.
+    resTree_EntryRef_t entryRef;        ///< Resource the stream pushes to (reference counted).
+    le_msg_SessionRef_t sessionRef;     ///< Client session that owns the stream.
+    io_DataType_t dataType;             ///< Type of the samples.
+    uint32_t capacity;                  ///< Number of records in the ring.
+    ioStreamRing_t* ringPtr;            ///< The ring, as mapped by the Data Hub.
+    uint64_t tail;                      ///< Number of records drained (not trusting the ring's).
+    uint64_t overflows;                 ///< Ring overflows counted in the resource's statistics.
+    int doorbellFd;                     ///< Event file the client writes to have the ring drained.
+    le_fdMonitor_Ref_t doorbellMonitor; ///< Monitors the doorbell.
+}
+Stream_t;
+
+/// Default number of streams.  This can be overridden in the .cdef.
+#define DEFAULT_STREAM_POOL_SIZE 4
+
+/// Interval (in ms) at which the rings of open streams are drained.  This can be overridden in
+/// the .cdef.
+#ifndef DHUB_STREAM_DRAIN_MS
+#define DHUB_STREAM_DRAIN_MS 10
+#endif
+
+/// Maximum number of records drained from a ring at a time, so that a busy stream can't hold up
+/// the event loop.  This can be overridden in the .cdef.
+#ifndef DHUB_STREAM_DRAIN_BATCH
+#define DHUB_STREAM_DRAIN_BATCH 1024
+#endif
+
+/// Pool of Stream objects.
+static le_mem_PoolRef_t StreamPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(StreamPool, DEFAULT_STREAM_POOL_SIZE, sizeof(Stream_t));
+
+/// Safe references to Stream objects.
+static le_ref_MapRef_t StreamMap = NULL;
+LE_REF_DEFINE_STATIC_MAP(StreamMap, DEFAULT_STREAM_POOL_SIZE);
+
+/// List of all Stream objects.
+static le_dls_List_t StreamList = LE_DLS_LIST_INIT;
+
+/// Timer that drains the rings of the open streams.  Only runs while there are some.
+static le_timer_Ref_t StreamDrainTimer = NULL;
+#endif /* end LE_CONFIG_LINUX */
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the resource at a given path within the app's namespace.
@@ -86,6 +183,167 @@ static resTree_EntryRef_t FindResource
     return entryRef;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a resource handle (its safe reference becomes invalid).
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReleaseResourceHandle
+(
+    ResourceHandle_t* handlePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_ref_DeleteRef(ResourceHandleMap, handlePtr->ref);
+    le_dls_Remove(&ResourceHandleList, &handlePtr->link);
+    le_mem_Release(handlePtr->entryRef);
+    le_mem_Release(handlePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release all the resource handles that refer to a given resource or that are owned by a given
+ * client session.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReleaseResourceHandles
+(
+    resTree_EntryRef_t entryRef,    ///< Resource (NULL = any).
+    le_msg_SessionRef_t sessionRef  ///< Client session (NULL = any).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&ResourceHandleList);
+
+    while (linkPtr != NULL)
+    {
+        ResourceHandle_t* handlePtr = CONTAINER_OF(linkPtr, ResourceHandle_t, link);
+
+        linkPtr = le_dls_PeekNext(&ResourceHandleList, linkPtr);
+
+        if (   ((entryRef == NULL) || (handlePtr->entryRef == entryRef))
+            && ((sessionRef == NULL) || (handlePtr->sessionRef == sessionRef)))
+        {
+            ReleaseResourceHandle(handlePtr);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the resource referred to by a resource handle owned by the client.
+ *
+ * @return Reference to the entry, or NULL if the handle is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+static resTree_EntryRef_t GetHandleResource
+(
+    io_ResourceRef_t handle ///< Handle returned by io_GetResourceHandle().
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ResourceHandle_t* handlePtr = le_ref_Lookup(ResourceHandleMap, handle);
+
+    if ((handlePtr == NULL) || (handlePtr->sessionRef != io_GetClientSessionRef()))
+    {
+        LE_ERROR("Invalid resource handle %p.", handle);
+        return NULL;
+    }
+
+    // The resource may have been deleted by other means than io_DeleteResource().
+    admin_EntryType_t entryType = resTree_GetEntryType(handlePtr->entryRef);
+
+    if ((entryType != ADMIN_ENTRY_TYPE_INPUT) && (entryType != ADMIN_ENTRY_TYPE_OUTPUT))
+    {
+        LE_ERROR("Resource handle %p refers to a resource that no longer exists.", handle);
+        return NULL;
+    }
+
+    return handlePtr->entryRef;
+}
+
+
+#if LE_CONFIG_LINUX
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close a stream (its safe reference becomes invalid).  Records still in its ring are dropped.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseStream
+(
+    Stream_t* streamPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_ref_DeleteRef(StreamMap, streamPtr->ref);
+    le_dls_Remove(&StreamList, &streamPtr->link);
+    le_fdMonitor_Delete(streamPtr->doorbellMonitor);
+    close(streamPtr->doorbellFd);
+    munmap(streamPtr->ringPtr, ioStreamRing_Size(streamPtr->capacity));
+    le_mem_Release(streamPtr->entryRef);
+    le_mem_Release(streamPtr);
+
+    if (le_dls_IsEmpty(&StreamList))
+    {
+        le_timer_Stop(StreamDrainTimer);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close all the streams that push to a given resource or that are owned by a given client
+ * session.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseStreams
+(
+    resTree_EntryRef_t entryRef,    ///< Resource (NULL = any).
+    le_msg_SessionRef_t sessionRef  ///< Client session (NULL = any).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&StreamList);
+
+    while (linkPtr != NULL)
+    {
+        Stream_t* streamPtr = CONTAINER_OF(linkPtr, Stream_t, link);
+
+        linkPtr = le_dls_PeekNext(&StreamList, linkPtr);
+
+        if (   ((entryRef == NULL) || (streamPtr->entryRef == entryRef))
+            && ((sessionRef == NULL) || (streamPtr->sessionRef == sessionRef)))
+        {
+            CloseStream(streamPtr);
+        }
+    }
+}
+#endif /* end LE_CONFIG_LINUX */
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler called when a client session closes.  Releases the resource handles and closes the
+ * streams it owns.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SessionCloseHandler
+(
+    le_msg_SessionRef_t sessionRef,
+    void* contextPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(contextPtr);
+
+    ReleaseResourceHandles(NULL, sessionRef);
+#if LE_CONFIG_LINUX
+    CloseStreams(NULL, sessionRef);
+#endif
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the client application's namespace to be used for the following calls
@@ -338,299 +596,1275 @@ le_result_t io_DeleteResource
     resTree_EntryRef_t resRef = FindResource(path);
     if (resRef != NULL)
     {
+        ReleaseResourceHandles(resRef, NULL);
+#if LE_CONFIG_LINUX
+        CloseStreams(resRef, NULL);
+#endif
         resTree_DeleteIO(resRef);
         return LE_OK;
     }
     else
     {
-        return LE_NOT_FOUND;
+        return LE_NOT_FOUND;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a trigger type data sample.
+ *
+ * @note The LE_OK return from this function means the sample has been successfully received by
+ * datahub. It does not guarantee that the sample will be successfully processed by observers
+ * of the path or that the sample will not be lost after power cycle.
+ *
+ * @return
+ *      - LE_OK If datasample was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
+ *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
+ *      - LE_NOT_FOUND If the path does not exist.
+ *      - LE_FAULT If any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushTrigger
+(
+    const char* path,
+        ///< [IN] Resource path within the client app's namespace.
+    double timestamp
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< Zero = now.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    bool isTraced = pushTrace_Begin();
+
+    resTree_EntryRef_t resRef = FindResource(path);
+    le_result_t ret;
+    if (resRef == NULL)
+    {
+        LE_ERROR("Client tried to push data to a non-existent resource '%s'.", path);
+        ret = LE_NOT_FOUND;
+    }
+    else
+    {
+        // Create a Data Sample object for this new sample.
+        dataSample_Ref_t sampleRef = dataSample_CreateTrigger(timestamp);
+
+        if (sampleRef)
+        {
+            // Push the sample to the Resource.
+            ret = resTree_Push(resRef, IO_DATA_TYPE_TRIGGER, sampleRef);
+        }
+        else
+        {
+            LE_ERROR("Failed to push trigger to path '%s'", path);
+            ret = LE_NO_MEMORY;
+        }
+    }
+
+    pushTrace_End(isTraced);
+    return ret;
+}
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a Boolean type data sample.
+ *
+ * @note The LE_OK return from this function means the sample has been successfully received by
+ * datahub. It does not guarantee that the sample will be successfully processed by observers
+ * of the path or that the sample will not be lost after power cycle.
+ *
+ * @return
+ *      - LE_OK If datasample was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
+ *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
+ *      - LE_NOT_FOUND If the path does not exist.
+ *      - LE_FAULT If any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushBoolean
+(
+    const char* path,
+        ///< [IN] Resource path within the client app's namespace.
+    double timestamp,
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< Zero = now.
+    bool value
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    bool isTraced = pushTrace_Begin();
+
+    resTree_EntryRef_t resRef = FindResource(path);
+    le_result_t ret;
+    if (resRef == NULL)
+    {
+        LE_ERROR("Client tried to push data to a non-existent resource '%s'.", path);
+        ret = LE_NOT_FOUND;
+    }
+    else
+    {
+        // Create a Data Sample object for this new sample.
+        dataSample_Ref_t sampleRef = dataSample_CreateBoolean(timestamp, value);
+
+        if (sampleRef)
+        {
+            // Push the sample to the Resource.
+            ret = resTree_Push(resRef, IO_DATA_TYPE_BOOLEAN, sampleRef);
+        }
+        else
+        {
+            LE_ERROR("Failed to push boolean to path '%s'", path);
+            ret = LE_NO_MEMORY;
+        }
+    }
+
+    pushTrace_End(isTraced);
+    return ret;
+}
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a numeric type data sample.
+ *
+ * @note The LE_OK return from this function means the sample has been successfully received by
+ * datahub. It does not guarantee that the sample will be successfully processed by observers
+ * of the path or that the sample will not be lost after power cycle.
+ *
+ * @return
+ *      - LE_OK If datasample was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
+ *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
+ *      - LE_NOT_FOUND If the path does not exist.
+ *      - LE_FAULT If any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushNumeric
+(
+    const char* path,
+        ///< [IN] Resource path within the client app's namespace.
+    double timestamp,
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< Zero = now.
+    double value
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    bool isTraced = pushTrace_Begin();
+
+    resTree_EntryRef_t resRef = FindResource(path);
+    le_result_t ret;
+    if (resRef == NULL)
+    {
+        LE_ERROR("Client tried to push data to a non-existent resource '%s'.", path);
+        ret = LE_NOT_FOUND;
+    }
+    else
+    {
+        // Push the value to the Resource.  A Data Sample object is only created for it if needed.
+        ret = resTree_PushNumeric(resRef, timestamp, value);
+        if (ret == LE_NO_MEMORY)
+        {
+            LE_ERROR("Failed to push numeric to path '%s'", path);
+        }
+    }
+
+    pushTrace_End(isTraced);
+    return ret;
+}
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a string type data sample.
+ *
+ * @note The LE_OK return from this function means the sample has been successfully received by
+ * datahub. It does not guarantee that the sample will be successfully processed by observers
+ * of the path or that the sample will not be lost after power cycle.
+ *
+ * @return
+ *      - LE_OK If datasample was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
+ *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
+ *      - LE_NOT_FOUND If the path does not exist.
+ *      - LE_FAULT If any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushString
+(
+    const char* path,
+        ///< [IN] Resource path within the client app's namespace.
+    double timestamp,
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< Zero = now.
+    const char* value
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    bool isTraced = pushTrace_Begin();
+
+    resTree_EntryRef_t resRef = FindResource(path);
+    le_result_t ret;
+    if (resRef == NULL)
+    {
+        LE_ERROR("Client tried to push data to a non-existent resource '%s'.", path);
+        ret = LE_NOT_FOUND;
+    }
+    else
+    {
+        // Create a Data Sample object for this new sample.
+        dataSample_Ref_t sampleRef = dataSample_CreateString(timestamp, value);
+
+        if (sampleRef)
+        {
+            // Push the sample to the Resource.
+            ret = resTree_Push(resRef, IO_DATA_TYPE_STRING, sampleRef);
+        }
+        else
+        {
+            LE_ERROR("Failed to push string to path '%s'", path);
+            ret = LE_NO_MEMORY;
+        }
+    }
+
+    pushTrace_End(isTraced);
+    return ret;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a JSON data sample.
+ *
+ * @note The LE_OK return from this function means the sample has been successfully received by
+ * datahub. It does not guarantee that the sample will be successfully processed by observers
+ * of the path or that the sample will not be lost after power cycle.
+ *
+ * @return
+ *      - LE_OK If datasample was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
+ *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit or JSON is not valid.
+ *      - LE_NOT_FOUND If the path does not exist.
+ *      - LE_FAULT If any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushJson
+(
+    const char* path,
+        ///< [IN] Resource path within the client app's namespace.
+    double timestamp,
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< Zero = now.
+    const char* value
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    bool isTraced = pushTrace_Begin();
+
+    resTree_EntryRef_t resRef = FindResource(path);
+    le_result_t ret;
+    if (resRef == NULL)
+    {
+        LE_ERROR("Client tried to push data to a non-existent resource '%s'.", path);
+        ret = LE_NOT_FOUND;
+    }
+#ifdef DHUB_JSON_WORKERS
+    else if (   jsonWorker_IsOffloaded(value)
+             && ((ret = jsonWorker_PushJson(resRef, timestamp, value)) != LE_UNAVAILABLE))
+    {
+        // Large values are validated by a worker thread (unless no worker job is available).
+    }
+#endif
+    else if (json_IsValid(value))
+    {
+        // Create a Data Sample object for this new sample.
+        dataSample_Ref_t sampleRef = dataSample_CreateJson(timestamp, value);
+
+        if (sampleRef)
+        {
+            // Push the sample to the Resource.
+            ret = resTree_Push(resRef, IO_DATA_TYPE_JSON, sampleRef);
+        }
+        else
+        {
+            LE_ERROR("Failed to push JSON to path '%s'", path);
+            ret = LE_NO_MEMORY;
+        }
+    }
+    else
+    {
+        LE_WARN("Rejecting invalid JSON string '%s'.", value);
+        ret = LE_BAD_PARAMETER;
+    }
+
+    pushTrace_End(isTraced);
+    return ret;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a handle for an Input or Output resource, to push data samples to it without having its
+ * path looked up on every push.
+ *
+ * The handle is only valid for the client session that got it.  It is released when the
+ * resource is deleted using io_DeleteResource(), when io_ReleaseResourceHandle() is called, or
+ * when the client disconnects.
+ *
+ * @return A handle for the resource, or NULL if the path does not exist or failed to allocate
+ *         memory.
+ */
+//--------------------------------------------------------------------------------------------------
+io_ResourceRef_t io_GetResourceHandle
+(
+    const char* path
+        ///< [IN] Resource path within the client app's namespace.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    resTree_EntryRef_t resRef = FindResource(path);
+    if (resRef == NULL)
+    {
+        LE_ERROR("Client tried to get a handle for a non-existent resource '%s'.", path);
+        return NULL;
+    }
+
+    ResourceHandle_t* handlePtr = hub_MemAlloc(ResourceHandlePool);
+    if (handlePtr == NULL)
+    {
+        LE_ERROR("Failed to allocate a handle for resource '%s'", path);
+        return NULL;
+    }
+
+    le_mem_AddRef(resRef);
+
+    handlePtr->link = LE_DLS_LINK_INIT;
+    handlePtr->entryRef = resRef;
+    handlePtr->sessionRef = io_GetClientSessionRef();
+    handlePtr->ref = le_ref_CreateRef(ResourceHandleMap, handlePtr);
+
+    le_dls_Queue(&ResourceHandleList, &handlePtr->link);
+
+    return handlePtr->ref;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a handle returned by io_GetResourceHandle().
+ *
+ * Does nothing if the handle is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+void io_ReleaseResourceHandle
+(
+    io_ResourceRef_t handle
+        ///< [IN] Handle returned by io_GetResourceHandle().
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ResourceHandle_t* handlePtr = le_ref_Lookup(ResourceHandleMap, handle);
+
+    if ((handlePtr != NULL) && (handlePtr->sessionRef == io_GetClientSessionRef()))
+    {
+        ReleaseResourceHandle(handlePtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a trigger type data sample to a resource referred to by a handle.
+ *
+ * @note The LE_OK return from this function means the sample has been successfully received by
+ * datahub. It does not guarantee that the sample will be successfully processed by observers
+ * of the path or that the sample will not be lost after power cycle.
+ *
+ * @return
+ *      - LE_OK If datasample was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
+ *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
+ *      - LE_NOT_FOUND If the handle is not valid (e.g., the resource has been deleted).
+ *      - LE_FAULT If any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushTriggerByHandle
+(
+    io_ResourceRef_t handle,
+        ///< [IN] Handle returned by io_GetResourceHandle().
+    double timestamp
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< Zero = now.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    bool isTraced = pushTrace_Begin();
+
+    resTree_EntryRef_t resRef = GetHandleResource(handle);
+    le_result_t ret;
+    if (resRef == NULL)
+    {
+        ret = LE_NOT_FOUND;
+    }
+    else
+    {
+        // Create a Data Sample object for this new sample.
+        dataSample_Ref_t sampleRef = dataSample_CreateTrigger(timestamp);
+
+        if (sampleRef)
+        {
+            // Push the sample to the Resource.
+            ret = resTree_Push(resRef, IO_DATA_TYPE_TRIGGER, sampleRef);
+        }
+        else
+        {
+            LE_ERROR("Failed to push trigger to handle %p", handle);
+            ret = LE_NO_MEMORY;
+        }
+    }
+
+    pushTrace_End(isTraced);
+    return ret;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a Boolean type data sample to a resource referred to by a handle.
+ *
+ * @note The LE_OK return from this function means the sample has been successfully received by
+ * datahub. It does not guarantee that the sample will be successfully processed by observers
+ * of the path or that the sample will not be lost after power cycle.
+ *
+ * @return
+ *      - LE_OK If datasample was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
+ *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
+ *      - LE_NOT_FOUND If the handle is not valid (e.g., the resource has been deleted).
+ *      - LE_FAULT If any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushBooleanByHandle
+(
+    io_ResourceRef_t handle,
+        ///< [IN] Handle returned by io_GetResourceHandle().
+    double timestamp,
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< Zero = now.
+    bool value
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    bool isTraced = pushTrace_Begin();
+
+    resTree_EntryRef_t resRef = GetHandleResource(handle);
+    le_result_t ret;
+    if (resRef == NULL)
+    {
+        ret = LE_NOT_FOUND;
+    }
+    else
+    {
+        // Create a Data Sample object for this new sample.
+        dataSample_Ref_t sampleRef = dataSample_CreateBoolean(timestamp, value);
+
+        if (sampleRef)
+        {
+            // Push the sample to the Resource.
+            ret = resTree_Push(resRef, IO_DATA_TYPE_BOOLEAN, sampleRef);
+        }
+        else
+        {
+            LE_ERROR("Failed to push boolean to handle %p", handle);
+            ret = LE_NO_MEMORY;
+        }
+    }
+
+    pushTrace_End(isTraced);
+    return ret;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a numeric type data sample to a resource referred to by a handle.
+ *
+ * @note The LE_OK return from this function means the sample has been successfully received by
+ * datahub. It does not guarantee that the sample will be successfully processed by observers
+ * of the path or that the sample will not be lost after power cycle.
+ *
+ * @return
+ *      - LE_OK If datasample was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
+ *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
+ *      - LE_NOT_FOUND If the handle is not valid (e.g., the resource has been deleted).
+ *      - LE_FAULT If any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushNumericByHandle
+(
+    io_ResourceRef_t handle,
+        ///< [IN] Handle returned by io_GetResourceHandle().
+    double timestamp,
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< Zero = now.
+    double value
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    bool isTraced = pushTrace_Begin();
+
+    resTree_EntryRef_t resRef = GetHandleResource(handle);
+    le_result_t ret;
+    if (resRef == NULL)
+    {
+        ret = LE_NOT_FOUND;
+    }
+    else
+    {
+        // Push the value to the Resource.  A Data Sample object is only created for it if needed.
+        ret = resTree_PushNumeric(resRef, timestamp, value);
+        if (ret == LE_NO_MEMORY)
+        {
+            LE_ERROR("Failed to push numeric to handle %p", handle);
+        }
+    }
+
+    pushTrace_End(isTraced);
+    return ret;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a string type data sample to a resource referred to by a handle.
+ *
+ * @note The LE_OK return from this function means the sample has been successfully received by
+ * datahub. It does not guarantee that the sample will be successfully processed by observers
+ * of the path or that the sample will not be lost after power cycle.
+ *
+ * @return
+ *      - LE_OK If datasample was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
+ *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
+ *      - LE_NOT_FOUND If the handle is not valid (e.g., the resource has been deleted).
+ *      - LE_FAULT If any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushStringByHandle
+(
+    io_ResourceRef_t handle,
+        ///< [IN] Handle returned by io_GetResourceHandle().
+    double timestamp,
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< Zero = now.
+    const char* value
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    bool isTraced = pushTrace_Begin();
+
+    resTree_EntryRef_t resRef = GetHandleResource(handle);
+    le_result_t ret;
+    if (resRef == NULL)
+    {
+        ret = LE_NOT_FOUND;
+    }
+    else
+    {
+        // Create a Data Sample object for this new sample.
+        dataSample_Ref_t sampleRef = dataSample_CreateString(timestamp, value);
+
+        if (sampleRef)
+        {
+            // Push the sample to the Resource.
+            ret = resTree_Push(resRef, IO_DATA_TYPE_STRING, sampleRef);
+        }
+        else
+        {
+            LE_ERROR("Failed to push string to handle %p", handle);
+            ret = LE_NO_MEMORY;
+        }
+    }
+
+    pushTrace_End(isTraced);
+    return ret;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a JSON data sample to a resource referred to by a handle.
+ *
+ * @note The LE_OK return from this function means the sample has been successfully received by
+ * datahub. It does not guarantee that the sample will be successfully processed by observers
+ * of the path or that the sample will not be lost after power cycle.
+ *
+ * @return
+ *      - LE_OK If datasample was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
+ *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit or JSON is not valid.
+ *      - LE_NOT_FOUND If the handle is not valid (e.g., the resource has been deleted).
+ *      - LE_FAULT If any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushJsonByHandle
+(
+    io_ResourceRef_t handle,
+        ///< [IN] Handle returned by io_GetResourceHandle().
+    double timestamp,
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< Zero = now.
+    const char* value
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    bool isTraced = pushTrace_Begin();
+
+    resTree_EntryRef_t resRef = GetHandleResource(handle);
+    le_result_t ret;
+    if (resRef == NULL)
+    {
+        ret = LE_NOT_FOUND;
+    }
+#ifdef DHUB_JSON_WORKERS
+    else if (   jsonWorker_IsOffloaded(value)
+             && ((ret = jsonWorker_PushJson(resRef, timestamp, value)) != LE_UNAVAILABLE))
+    {
+        // Large values are validated by a worker thread (unless no worker job is available).
+    }
+#endif
+    else if (json_IsValid(value))
+    {
+        // Create a Data Sample object for this new sample.
+        dataSample_Ref_t sampleRef = dataSample_CreateJson(timestamp, value);
+
+        if (sampleRef)
+        {
+            // Push the sample to the Resource.
+            ret = resTree_Push(resRef, IO_DATA_TYPE_JSON, sampleRef);
+        }
+        else
+        {
+            LE_ERROR("Failed to push JSON to handle %p", handle);
+            ret = LE_NO_MEMORY;
+        }
+    }
+    else
+    {
+        LE_WARN("Rejecting invalid JSON string '%s'.", value);
+        ret = LE_BAD_PARAMETER;
+    }
+
+    pushTrace_End(isTraced);
+    return ret;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time as a data sample timestamp.
+ *
+ * @return The timestamp.
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetTimestampNow
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_clk_Time_t currentTime = le_clk_GetAbsoluteTime();
+
+    return (((double)(currentTime.usec)) / 1000000) + currentTime.sec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a batch of Boolean type data samples, each to a resource referred to by a handle.
+ *
+ * The arrays must all have the same number of elements.  Sample i has timestamp timestamps[i]
+ * and value values[i], and is pushed to handles[i].  All the samples are pushed, even if pushing
+ * some of them fails.
+ *
+ * @return
+ *      - LE_OK If all the datasamples were pushed successfully.
+ *      - LE_BAD_PARAMETER If the arrays don't have the same number of elements, or have more
+ *                         than IO_MAX_BATCH_LEN (nothing is pushed).
+ *      - Otherwise, the result of the first push that failed (see io_PushBooleanByHandle()).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushBooleanBatch
+(
+    const io_ResourceRef_t* handlesPtr,
+        ///< [IN] Handles returned by io_GetResourceHandle().
+    size_t handlesSize,
+        ///< [IN]
+    const double* timestampsPtr,
+        ///< [IN] Timestamps in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< Zero = now.
+    size_t timestampsSize,
+        ///< [IN]
+    const bool* valuesPtr,
+        ///< [IN]
+    size_t valuesSize
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((handlesSize != timestampsSize) || (handlesSize != valuesSize))
+    {
+        LE_ERROR("Batch arrays have different sizes (%" PRIuS ", %" PRIuS ", %" PRIuS ").",
+                 handlesSize,
+                 timestampsSize,
+                 valuesSize);
+        return LE_BAD_PARAMETER;
+    }
+
+    if (handlesSize > IO_MAX_BATCH_LEN)
+    {
+        LE_ERROR("Batch of %" PRIuS " samples is longer than %d.", handlesSize, IO_MAX_BATCH_LEN);
+        return LE_BAD_PARAMETER;
+    }
+
+    // All the samples of the batch that are to be timestamped "now" get the same timestamp.
+    double now = IO_NOW;
+    le_result_t ret = LE_OK;
+
+    for (size_t i = 0; i < handlesSize; i++)
+    {
+        double timestamp = timestampsPtr[i];
+
+        if (timestamp == IO_NOW)
+        {
+            if (now == IO_NOW)
+            {
+                now = GetTimestampNow();
+            }
+            timestamp = now;
+        }
+
+        le_result_t result = io_PushBooleanByHandle(handlesPtr[i], timestamp, valuesPtr[i]);
+
+        if ((result != LE_OK) && (ret == LE_OK))
+        {
+            ret = result;
+        }
+    }
+
+    return ret;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a batch of numeric type data samples, each to a resource referred to by a handle.
+ *
+ * The arrays must all have the same number of elements.  Sample i has timestamp timestamps[i]
+ * and value values[i], and is pushed to handles[i].  All the samples are pushed, even if pushing
+ * some of them fails.
+ *
+ * @return
+ *      - LE_OK If all the datasamples were pushed successfully.
+ *      - LE_BAD_PARAMETER If the arrays don't have the same number of elements, or have more
+ *                         than IO_MAX_BATCH_LEN (nothing is pushed).
+ *      - Otherwise, the result of the first push that failed (see io_PushNumericByHandle()).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushNumericBatch
+(
+    const io_ResourceRef_t* handlesPtr,
+        ///< [IN] Handles returned by io_GetResourceHandle().
+    size_t handlesSize,
+        ///< [IN]
+    const double* timestampsPtr,
+        ///< [IN] Timestamps in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< Zero = now.
+    size_t timestampsSize,
+        ///< [IN]
+    const double* valuesPtr,
+        ///< [IN]
+    size_t valuesSize
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((handlesSize != timestampsSize) || (handlesSize != valuesSize))
+    {
+        LE_ERROR("Batch arrays have different sizes (%" PRIuS ", %" PRIuS ", %" PRIuS ").",
+                 handlesSize,
+                 timestampsSize,
+                 valuesSize);
+        return LE_BAD_PARAMETER;
+    }
+
+    if (handlesSize > IO_MAX_BATCH_LEN)
+    {
+        LE_ERROR("Batch of %" PRIuS " samples is longer than %d.", handlesSize, IO_MAX_BATCH_LEN);
+        return LE_BAD_PARAMETER;
+    }
+
+    // All the samples of the batch that are to be timestamped "now" get the same timestamp.
+    double now = IO_NOW;
+    le_result_t ret = LE_OK;
+
+    for (size_t i = 0; i < handlesSize; i++)
+    {
+        double timestamp = timestampsPtr[i];
+
+        if (timestamp == IO_NOW)
+        {
+            if (now == IO_NOW)
+            {
+                now = GetTimestampNow();
+            }
+            timestamp = now;
+        }
+
+        le_result_t result = io_PushNumericByHandle(handlesPtr[i], timestamp, valuesPtr[i]);
+
+        if ((result != LE_OK) && (ret == LE_OK))
+        {
+            ret = result;
+        }
+    }
+
+    return ret;
+}
+
+
+#if LE_CONFIG_LINUX
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a record drained from a stream's ring to the stream's resource.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushStreamRecord
+(
+    Stream_t* streamPtr,    ///< The stream.
+    double timestamp,       ///< Timestamp of the record (not IO_NOW).
+    double value            ///< Value of the record.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    dataSample_Ref_t sampleRef;
+
+    switch (streamPtr->dataType)
+    {
+        case IO_DATA_TYPE_NUMERIC:
+
+            // A Data Sample object is only created for the value if needed.
+            resTree_PushNumeric(streamPtr->entryRef, timestamp, value);
+            return;
+
+        case IO_DATA_TYPE_BOOLEAN:
+
+            sampleRef = dataSample_CreateBoolean(timestamp, (value != 0));
+            break;
+
+        default:
+
+            sampleRef = dataSample_CreateTrigger(timestamp);
+            break;
+    }
+
+    if (sampleRef == NULL)
+    {
+        res_AddToStat(resTree_GetResourcePtr(streamPtr->entryRef),
+                      ADMIN_STAT_DROPPED_NO_MEMORY,
+                      1);
+        return;
+    }
+
+    resTree_Push(streamPtr->entryRef, streamPtr->dataType, sampleRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push the records waiting in a stream's ring (up to DHUB_STREAM_DRAIN_BATCH of them) to the
+ * stream's resource, and count the overflows of the ring in the resource's statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DrainStream
+(
+    Stream_t* streamPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ioStreamRing_t* ringPtr = streamPtr->ringPtr;
+
+    // Pairs with the release by the client once it has written the records.
+    uint64_t head = __atomic_load_n(&ringPtr->head, __ATOMIC_ACQUIRE);
+    uint64_t count = head - streamPtr->tail;
+
+    if (count > streamPtr->capacity)
+    {
+        // Only a client that doesn't follow the ring's protocol can get here.
+        LE_WARN("Dropping the records of the corrupted stream to '%s'.",
+                resTree_GetEntryName(streamPtr->entryRef));
+        streamPtr->tail = head;
+        count = 0;
+    }
+    else if (count > DHUB_STREAM_DRAIN_BATCH)
+    {
+        count = DHUB_STREAM_DRAIN_BATCH;
+    }
+
+    // The resource may have been deleted by other means than io_DeleteResource().  Its records
+    // are drained anyway, so the client doesn't see a full ring.
+    admin_EntryType_t entryType = resTree_GetEntryType(streamPtr->entryRef);
+    bool isPushable = (entryType == ADMIN_ENTRY_TYPE_INPUT)
+                   || (entryType == ADMIN_ENTRY_TYPE_OUTPUT);
+
+    // All the records of the drain that are to be timestamped "now" get the same timestamp.
+    double now = IO_NOW;
+
+    for (uint64_t i = 0; isPushable && (i < count); i++)
+    {
+        // Each field is read once, as the client may be changing it.
+        const ioStreamRing_Record_t* recordPtr =
+            &ringPtr->records[(streamPtr->tail + i) & (streamPtr->capacity - 1)];
+        double timestamp = recordPtr->timestamp;
+        double value = recordPtr->value;
+
+        if (timestamp == IO_NOW)
+        {
+            if (now == IO_NOW)
+            {
+                now = GetTimestampNow();
+            }
+            timestamp = now;
+        }
+
+        PushStreamRecord(streamPtr, timestamp, value);
+    }
+
+    // Pairs with the acquire by the client before it reuses the records.
+    streamPtr->tail += count;
+    __atomic_store_n(&ringPtr->tail, streamPtr->tail, __ATOMIC_RELEASE);
+
+    uint64_t overflows = __atomic_load_n(&ringPtr->overflows, __ATOMIC_RELAXED);
+    if (isPushable && (overflows != streamPtr->overflows))
+    {
+        res_AddToStat(resTree_GetResourcePtr(streamPtr->entryRef),
+                      ADMIN_STAT_DROPPED_OVERFLOW,
+                      (uint32_t)(overflows - streamPtr->overflows));
+    }
+    streamPtr->overflows = overflows;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler called when the client rings the doorbell of a stream.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StreamDoorbellHandler
+(
+    int fd,         ///< The doorbell.
+    short events    ///< Bitmap of events that occurred.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Stream_t* streamPtr = le_fdMonitor_GetContextPtr();
+
+    // Reading the doorbell resets it.
+    uint64_t count;
+    if ((events & POLLIN) && (read(fd, &count, sizeof(count)) == sizeof(count)))
+    {
+        DrainStream(streamPtr);
     }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Push a trigger type data sample.
- *
- * @note The LE_OK return from this function means the sample has been successfully received by
- * datahub. It does not guarantee that the sample will be successfully processed by observers
- * of the path or that the sample will not be lost after power cycle.
+ * Check whether a stream pushes to a high-priority resource (see admin_SetHighPriority()).
  *
- * @return
- *      - LE_OK If datasample was pushed successfully.
- *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
- *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
- *      - LE_NOT_FOUND If the path does not exist.
- *      - LE_FAULT If any other error happened during push.
+ * @return true if it does.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t io_PushTrigger
+static bool IsHighPriorityStream
 (
-    const char* path,
-        ///< [IN] Resource path within the client app's namespace.
-    double timestamp
-        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
-        ///< Zero = now.
+    Stream_t* streamPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    resTree_EntryRef_t resRef = FindResource(path);
-    le_result_t ret;
-    if (resRef == NULL)
-    {
-        LE_ERROR("Client tried to push data to a non-existent resource '%s'.", path);
-        ret = LE_NOT_FOUND;
-    }
-    else
-    {
-        // Create a Data Sample object for this new sample.
-        dataSample_Ref_t sampleRef = dataSample_CreateTrigger(timestamp);
+    res_Resource_t* resPtr = resTree_GetResourcePtr(streamPtr->entryRef);
 
-        if (sampleRef)
-        {
-            // Push the sample to the Resource.
-            ret = resTree_Push(resRef, IO_DATA_TYPE_TRIGGER, sampleRef);
-        }
-        else
-        {
-            LE_ERROR("Failed to push trigger to path '%s'", path);
-            ret = LE_NO_MEMORY;
-        }
-    }
-    return ret;
+    return ((resPtr != NULL) && res_IsHighPriority(resPtr));
 }
 
 
-
 //--------------------------------------------------------------------------------------------------
 /**
- * Push a Boolean type data sample.
- *
- * @note The LE_OK return from this function means the sample has been successfully received by
- * datahub. It does not guarantee that the sample will be successfully processed by observers
- * of the path or that the sample will not be lost after power cycle.
- *
- * @return
- *      - LE_OK If datasample was pushed successfully.
- *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
- *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
- *      - LE_NOT_FOUND If the path does not exist.
- *      - LE_FAULT If any other error happened during push.
+ * Handler called when the stream drain timer expires.  Drains the rings of all the open streams,
+ * starting with the ones that push to high-priority resources.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t io_PushBoolean
+static void StreamDrainTimerExpired
 (
-    const char* path,
-        ///< [IN] Resource path within the client app's namespace.
-    double timestamp,
-        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
-        ///< Zero = now.
-    bool value
-        ///< [IN]
+    le_timer_Ref_t timer
 )
 //--------------------------------------------------------------------------------------------------
 {
-    resTree_EntryRef_t resRef = FindResource(path);
-    le_result_t ret;
-    if (resRef == NULL)
-    {
-        LE_ERROR("Client tried to push data to a non-existent resource '%s'.", path);
-        ret = LE_NOT_FOUND;
-    }
-    else
+    LE_UNUSED(timer);
+
+    for (int pass = 0; pass < 2; pass++)
     {
-        // Create a Data Sample object for this new sample.
-        dataSample_Ref_t sampleRef = dataSample_CreateBoolean(timestamp, value);
+        bool isHighPriorityPass = (pass == 0);
+        le_dls_Link_t* linkPtr = le_dls_Peek(&StreamList);
 
-        if (sampleRef)
-        {
-            // Push the sample to the Resource.
-            ret = resTree_Push(resRef, IO_DATA_TYPE_BOOLEAN, sampleRef);
-        }
-        else
+        while (linkPtr != NULL)
         {
-            LE_ERROR("Failed to push boolean to path '%s'", path);
-            ret = LE_NO_MEMORY;
+            Stream_t* streamPtr = CONTAINER_OF(linkPtr, Stream_t, link);
+
+            if (IsHighPriorityStream(streamPtr) == isHighPriorityPass)
+            {
+                DrainStream(streamPtr);
+            }
+
+            linkPtr = le_dls_PeekNext(&StreamList, linkPtr);
         }
     }
-    return ret;
 }
-
+#endif /* end LE_CONFIG_LINUX */
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Push a numeric type data sample.
+ * Open a stream of trigger, Boolean or numeric samples to an Input or Output.
  *
- * @note The LE_OK return from this function means the sample has been successfully received by
- * datahub. It does not guarantee that the sample will be successfully processed by observers
- * of the path or that the sample will not be lost after power cycle.
+ * The stream's ring of records is created in a shared memory file, which is passed back to the
+ * client to map and write samples into using the functions in ioStreamRing.h.
  *
- * @return
- *      - LE_OK If datasample was pushed successfully.
- *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
- *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
- *      - LE_NOT_FOUND If the path does not exist.
- *      - LE_FAULT If any other error happened during push.
+ * The stream belongs to the client session that opened it.  It is closed when the resource is
+ * deleted using io_DeleteResource(), when io_CloseStream() is called, or when the client
+ * disconnects.
+ *
+ * @return A reference to the stream, or NULL if the path does not exist, the data type or the
+ *         capacity is not valid, failed to allocate resources, or streams are not supported on
+ *         this target.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t io_PushNumeric
+io_StreamRef_t io_OpenStream
 (
     const char* path,
         ///< [IN] Resource path within the client app's namespace.
-    double timestamp,
-        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
-        ///< Zero = now.
-    double value
-        ///< [IN]
+    io_DataType_t dataType,
+        ///< [IN] Type of the samples (trigger, Boolean or numeric).
+    uint32_t capacity,
+        ///< [IN] Number of records in the ring (a power of two, up to IO_MAX_STREAM_CAPACITY).
+    int* streamMemoryPtr
+        ///< [OUT] Shared memory file holding the ring.
 )
 //--------------------------------------------------------------------------------------------------
 {
+    *streamMemoryPtr = -1;
+
+#if LE_CONFIG_LINUX
     resTree_EntryRef_t resRef = FindResource(path);
-    le_result_t ret;
     if (resRef == NULL)
     {
-        LE_ERROR("Client tried to push data to a non-existent resource '%s'.", path);
-        ret = LE_NOT_FOUND;
+        LE_ERROR("Client tried to open a stream to a non-existent resource '%s'.", path);
+        return NULL;
     }
-    else
+
+    if (   (dataType != IO_DATA_TYPE_TRIGGER)
+        && (dataType != IO_DATA_TYPE_BOOLEAN)
+        && (dataType != IO_DATA_TYPE_NUMERIC))
     {
-        // Create a Data Sample object for this new sample.
-        dataSample_Ref_t sampleRef = dataSample_CreateNumeric(timestamp, value);
+        LE_ERROR("Streams can't carry samples of type '%s'.", hub_GetDataTypeName(dataType));
+        return NULL;
+    }
 
-        if (sampleRef)
+    if (   (capacity < 2)
+        || (capacity > IO_MAX_STREAM_CAPACITY)
+        || ((capacity & (capacity - 1)) != 0))
+    {
+        LE_ERROR("Invalid stream capacity %" PRIu32 ".", capacity);
+        return NULL;
+    }
+
+    Stream_t* streamPtr = hub_MemAlloc(StreamPool);
+    if (streamPtr == NULL)
+    {
+        LE_ERROR("Failed to allocate a stream for resource '%s'", path);
+        return NULL;
+    }
+
+    // The file is sealed at its size, so the client can't shrink it from under the mapping.
+    size_t size = ioStreamRing_Size(capacity);
+    ioStreamRing_t* ringPtr = MAP_FAILED;
+    int doorbellFd = -1;
+    int memFd = memfd_create("datahub_stream", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+    if (   (memFd >= 0)
+        && (ftruncate(memFd, size) == 0)
+        && (fcntl(memFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == 0))
+    {
+        ringPtr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+    }
+    if (ringPtr != MAP_FAILED)
+    {
+        doorbellFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    }
+    if (doorbellFd < 0)
+    {
+        LE_ERROR("Failed to set up the ring of a stream to '%s' (%m).", path);
+        if (ringPtr != MAP_FAILED)
         {
-            // Push the sample to the Resource.
-            ret = resTree_Push(resRef, IO_DATA_TYPE_NUMERIC, sampleRef);
+            munmap(ringPtr, size);
         }
-        else
+        if (memFd >= 0)
         {
-            LE_ERROR("Failed to push numeric to path '%s'", path);
-            ret = LE_NO_MEMORY;
+            close(memFd);
         }
+        le_mem_Release(streamPtr);
+        return NULL;
     }
-    return ret;
-}
 
+    // The file is zero-filled, so the counters start at zero.
+    ringPtr->magic = IO_STREAM_RING_MAGIC;
+    ringPtr->version = IO_STREAM_RING_VERSION;
+    ringPtr->capacity = capacity;
+    ringPtr->dataType = dataType;
+
+    le_mem_AddRef(resRef);
+
+    streamPtr->link = LE_DLS_LINK_INIT;
+    streamPtr->entryRef = resRef;
+    streamPtr->sessionRef = io_GetClientSessionRef();
+    streamPtr->dataType = dataType;
+    streamPtr->capacity = capacity;
+    streamPtr->ringPtr = ringPtr;
+    streamPtr->tail = 0;
+    streamPtr->overflows = 0;
+    streamPtr->doorbellFd = doorbellFd;
+    streamPtr->doorbellMonitor = le_fdMonitor_Create("streamDoorbell",
+                                                     doorbellFd,
+                                                     StreamDoorbellHandler,
+                                                     POLLIN);
+    le_fdMonitor_SetContextPtr(streamPtr->doorbellMonitor, streamPtr);
+    streamPtr->ref = le_ref_CreateRef(StreamMap, streamPtr);
+
+    le_dls_Queue(&StreamList, &streamPtr->link);
+
+    if (!le_timer_IsRunning(StreamDrainTimer))
+    {
+        le_timer_Start(StreamDrainTimer);
+    }
+
+    // The file is closed once it has been passed to the client.  The mapping stays.
+    *streamMemoryPtr = memFd;
+
+    return streamPtr->ref;
+#else
+    LE_UNUSED(dataType);
+    LE_UNUSED(capacity);
+    LE_ERROR("Streams are not supported on this target ('%s').", path);
+    return NULL;
+#endif
+}
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Push a string type data sample.
- *
- * @note The LE_OK return from this function means the sample has been successfully received by
- * datahub. It does not guarantee that the sample will be successfully processed by observers
- * of the path or that the sample will not be lost after power cycle.
+ * Get the doorbell of a stream: an event file that the client writes to (using
+ * ioStreamRing_RingDoorbell()) to have the stream's ring drained right away.  The client is
+ * responsible for closing the file.
  *
  * @return
- *      - LE_OK If datasample was pushed successfully.
- *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
- *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
- *      - LE_NOT_FOUND If the path does not exist.
- *      - LE_FAULT If any other error happened during push.
+ *      - LE_OK If the doorbell was passed back.
+ *      - LE_BAD_PARAMETER If the stream reference is not valid.
+ *      - LE_FAULT If failed to duplicate the doorbell file.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t io_PushString
+le_result_t io_GetStreamDoorbell
 (
-    const char* path,
-        ///< [IN] Resource path within the client app's namespace.
-    double timestamp,
-        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
-        ///< Zero = now.
-    const char* value
-        ///< [IN]
+    io_StreamRef_t stream,
+        ///< [IN] Stream returned by io_OpenStream().
+    int* doorbellPtr
+        ///< [OUT] The stream's doorbell.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    resTree_EntryRef_t resRef = FindResource(path);
-    le_result_t ret;
-    if (resRef == NULL)
+    *doorbellPtr = -1;
+
+#if LE_CONFIG_LINUX
+    Stream_t* streamPtr = le_ref_Lookup(StreamMap, stream);
+
+    if ((streamPtr == NULL) || (streamPtr->sessionRef != io_GetClientSessionRef()))
     {
-        LE_ERROR("Client tried to push data to a non-existent resource '%s'.", path);
-        ret = LE_NOT_FOUND;
+        LE_ERROR("Invalid stream %p.", stream);
+        return LE_BAD_PARAMETER;
     }
-    else
-    {
-        // Create a Data Sample object for this new sample.
-        dataSample_Ref_t sampleRef = dataSample_CreateString(timestamp, value);
 
-        if (sampleRef)
-        {
-            // Push the sample to the Resource.
-            ret = resTree_Push(resRef, IO_DATA_TYPE_STRING, sampleRef);
-        }
-        else
-        {
-            LE_ERROR("Failed to push string to path '%s'", path);
-            ret = LE_NO_MEMORY;
-        }
+    // The Data Hub keeps its own file, as the one passed back is closed once it has been sent.
+    *doorbellPtr = fcntl(streamPtr->doorbellFd, F_DUPFD_CLOEXEC, 0);
+    if (*doorbellPtr < 0)
+    {
+        LE_ERROR("Failed to duplicate the doorbell of stream %p (%m).", stream);
+        return LE_FAULT;
     }
-    return ret;
+
+    return LE_OK;
+#else
+    LE_ERROR("Invalid stream %p.", stream);
+    return LE_BAD_PARAMETER;
+#endif
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Push a JSON data sample.
- *
- * @note The LE_OK return from this function means the sample has been successfully received by
- * datahub. It does not guarantee that the sample will be successfully processed by observers
- * of the path or that the sample will not be lost after power cycle.
+ * Close a stream returned by io_OpenStream().  Records still in its ring are dropped.
  *
- * @return
- *      - LE_OK If datasample was pushed successfully.
- *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
- *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit or JSON is not valid.
- *      - LE_NOT_FOUND If the path does not exist.
- *      - LE_FAULT If any other error happened during push.
+ * Does nothing if the stream reference is not valid.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t io_PushJson
+void io_CloseStream
 (
-    const char* path,
-        ///< [IN] Resource path within the client app's namespace.
-    double timestamp,
-        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
-        ///< Zero = now.
-    const char* value
-        ///< [IN]
+    io_StreamRef_t stream
+        ///< [IN] Stream returned by io_OpenStream().
 )
 //--------------------------------------------------------------------------------------------------
 {
-    resTree_EntryRef_t resRef = FindResource(path);
-    le_result_t ret;
-    if (resRef == NULL)
-    {
-        LE_ERROR("Client tried to push data to a non-existent resource '%s'.", path);
-        ret = LE_NOT_FOUND;
-    }
-    else if (json_IsValid(value))
-    {
-        // Create a Data Sample object for this new sample.
-        dataSample_Ref_t sampleRef = dataSample_CreateJson(timestamp, value);
+#if LE_CONFIG_LINUX
+    Stream_t* streamPtr = le_ref_Lookup(StreamMap, stream);
 
-        if (sampleRef)
-        {
-            // Push the sample to the Resource.
-            ret = resTree_Push(resRef, IO_DATA_TYPE_JSON, sampleRef);
-        }
-        else
-        {
-            LE_ERROR("Failed to push JSON to path '%s'", path);
-            ret = LE_NO_MEMORY;
-        }
-    }
-    else
+    if ((streamPtr != NULL) && (streamPtr->sessionRef == io_GetClientSessionRef()))
     {
-        LE_WARN("Rejecting invalid JSON string '%s'.", value);
-        ret = LE_BAD_PARAMETER;
+        CloseStream(streamPtr);
     }
-    return ret;
+#else
+    LE_UNUSED(stream);
+#endif
 }
 
 
@@ -1532,6 +2766,27 @@ void ioService_Init
     UpdateStartEndHandlerPool = le_mem_InitStaticPool(UpdateStartEndHandlerPool,
                                                       DEFAULT_UPDATE_HANDLER_POOL_SIZE,
                                                       sizeof(UpdateStartEndHandler_t));
+    hub_RegisterPool(UpdateStartEndHandlerPool);
+
+    ResourceHandlePool = le_mem_InitStaticPool(ResourceHandlePool,
+                                               DEFAULT_RESOURCE_HANDLE_POOL_SIZE,
+                                               sizeof(ResourceHandle_t));
+    hub_RegisterPool(ResourceHandlePool);
+    ResourceHandleMap = le_ref_InitStaticMap(ResourceHandleMap, DEFAULT_RESOURCE_HANDLE_POOL_SIZE);
+
+#if LE_CONFIG_LINUX
+    StreamPool = le_mem_InitStaticPool(StreamPool, DEFAULT_STREAM_POOL_SIZE, sizeof(Stream_t));
+    hub_RegisterPool(StreamPool);
+    StreamMap = le_ref_InitStaticMap(StreamMap, DEFAULT_STREAM_POOL_SIZE);
+
+    StreamDrainTimer = le_timer_Create("streamDrain");
+    LE_ASSERT(le_timer_SetMsInterval(StreamDrainTimer, DHUB_STREAM_DRAIN_MS) == LE_OK);
+    LE_ASSERT(le_timer_SetRepeat(StreamDrainTimer, 0) == LE_OK);
+    LE_ASSERT(le_timer_SetHandler(StreamDrainTimer, StreamDrainTimerExpired) == LE_OK);
+#endif
+
+    // Release resource handles and close streams owned by clients when they disconnect.
+    le_msg_AddServiceCloseHandler(io_GetServiceRef(), SessionCloseHandler, NULL);
 }
 
 
@@ -0,0 +1,154 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file ioStreamRing.h
+ *
+ * Layout of the shared memory ring of an I/O stream (see io_OpenStream()), and the inline
+ * functions a client uses to write samples into it.
+ *
+ * The ring is a lock-free single-producer, single-consumer queue of (timestamp, value) records.
+ * The client is the producer: it only ever writes the records, the head counter and the overflow
+ * counter.  The Data Hub is the consumer: it only ever writes the tail counter.  The counters
+ * only ever increase; the record that a counter value refers to is at that value modulo the
+ * capacity, which is a power of two.  The counters written by each side are kept on cache lines
+ * of their own.
+ *
+ * The Data Hub doesn't trust anything the client writes into the ring, apart from the records it
+ * gets between the tail and the head.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef IO_STREAM_RING_H_INCLUDE_GUARD
+#define IO_STREAM_RING_H_INCLUDE_GUARD
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <unistd.h>
+
+/// Value of the magic field of a stream ring.
+#define IO_STREAM_RING_MAGIC        0x52534844  // "DHSR"
+
+/// Version of the stream ring layout.
+#define IO_STREAM_RING_VERSION      1
+
+/// Size of the cache lines that the ring's counters are kept apart by.
+#define IO_STREAM_RING_CACHE_LINE   64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A record in a stream ring.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    double timestamp;   ///< Seconds since the Epoch (UTC), or IO_NOW (0) for when it is drained.
+    double value;       ///< Numeric value, non-zero for a true Boolean, ignored for a trigger.
+}
+ioStreamRing_Record_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header of a stream ring, followed in the shared memory file by its records.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    // Set up by the Data Hub when the stream is opened:
+    uint32_t magic;         ///< IO_STREAM_RING_MAGIC.
+    uint32_t version;       ///< IO_STREAM_RING_VERSION.
+    uint32_t capacity;      ///< Number of records in the ring (a power of two).
+    uint32_t dataType;      ///< Type of the samples (io_DataType_t).
+    uint8_t reserved0[IO_STREAM_RING_CACHE_LINE - 4 * sizeof(uint32_t)];
+
+    // Written by the client:
+    uint64_t head;          ///< Number of records written into the ring.
+    uint64_t overflows;     ///< Number of records dropped because the ring was full.
+    uint8_t reserved1[IO_STREAM_RING_CACHE_LINE - 2 * sizeof(uint64_t)];
+
+    // Written by the Data Hub:
+    uint64_t tail;          ///< Number of records drained from the ring.
+    uint8_t reserved2[IO_STREAM_RING_CACHE_LINE - sizeof(uint64_t)];
+
+    ioStreamRing_Record_t records[]; ///< The records.
+}
+ioStreamRing_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the size of the shared memory file holding a stream ring (the size to map).
+ *
+ * @return The size in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t ioStreamRing_Size
+(
+    uint32_t capacity   ///< Number of records in the ring.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return sizeof(ioStreamRing_t) + ((size_t)capacity * sizeof(ioStreamRing_Record_t));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a sample into a stream ring.  Must only be called by the client that opened the stream,
+ * from one thread at a time.
+ *
+ * @return true if the sample was written, or false if the ring was full (the sample is dropped
+ *         and counted as an overflow).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool ioStreamRing_Write
+(
+    ioStreamRing_t* ringPtr,    ///< The ring, as mapped by the client.
+    double timestamp,           ///< Seconds since the Epoch (UTC), or IO_NOW.
+    double value                ///< Value of the sample.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t head = ringPtr->head;
+    uint64_t tail = __atomic_load_n(&ringPtr->tail, __ATOMIC_ACQUIRE);
+
+    if ((head - tail) >= ringPtr->capacity)
+    {
+        __atomic_store_n(&ringPtr->overflows, ringPtr->overflows + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    ioStreamRing_Record_t* recordPtr = &ringPtr->records[head & (ringPtr->capacity - 1)];
+    recordPtr->timestamp = timestamp;
+    recordPtr->value = value;
+
+    // Publish the record.
+    __atomic_store_n(&ringPtr->head, head + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ring the doorbell of a stream (see io_GetStreamDoorbell()), to have the Data Hub drain the
+ * stream's ring right away.  This is worth doing after writing a burst of samples that must not
+ * wait for the next periodic drain.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void ioStreamRing_RingDoorbell
+(
+    int doorbellFd  ///< The stream's doorbell.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t count = 1;
+
+    if (write(doorbellFd, &count, sizeof(count)) < 0)
+    {
+        // The doorbell's counter is saturated, so the Data Hub already has a drain pending.
+    }
+}
+
+#endif // IO_STREAM_RING_H_INCLUDE_GUARD
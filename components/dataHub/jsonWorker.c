@@ -0,0 +1,506 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file jsonWorker.c
+ *
+ * JSON worker threads.  See jsonWorker.h.
+ *
+ * Every offloaded push is a Job.  Jobs are queued in the JobQueue, oldest first, and handed out
+ * to the worker threads in turn.  A worker only reads the Job's JSON value and extraction
+ * specifiers (copies, that the main thread doesn't touch while the worker has the Job) and
+ * writes its results into the Job, then hands it back to the main thread.  Everything else,
+ * including the Job's data sample and resource references, is only touched by the main thread.
+ *
+ * Pushes made to a resource while it has Jobs in the queue are queued as Jobs too, but with no
+ * work for the workers.  A Job is only done (pushed to its resource) once there are no Jobs ahead
+ * of it for the same resource in the queue.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "dataHub.h"
+#include "resource.h"
+#include "obs.h"
+#include "jsonWorker.h"
+
+#ifdef DHUB_JSON_WORKERS
+
+/// Number of JSON worker threads.  This can be overridden in the .cdef.
+#ifndef DHUB_JSON_WORKER_THREADS
+#define DHUB_JSON_WORKER_THREADS 2
+#endif
+
+/// Size (in bytes) from which pushed JSON values are validated by a worker thread.  This can be
+/// overridden in the .cdef.
+#ifndef DHUB_JSON_OFFLOAD_BYTES
+#define DHUB_JSON_OFFLOAD_BYTES 4096
+#endif
+
+/// Default number of JSON worker jobs.  This can be overridden in the .cdef.
+#define DEFAULT_JSON_JOB_POOL_SIZE  8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A push waiting in the JobQueue.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t link;             ///< Used to link into the JobQueue.
+    resTree_EntryRef_t entryRef;    ///< The resource to push to (holds a reference).
+    io_DataType_t dataType;         ///< The data type.
+    dataSample_Ref_t dataSample;    ///< The data sample (holds a reference).
+    char units[HUB_MAX_UNITS_BYTES];///< Units of the push, or "" if unspecified.
+    bool isWorkDone;                ///< true once the job is back from its worker (or has no work).
+
+    // Set by the worker:
+    bool isValid;                   ///< true if the JSON value is valid.
+
+    // Destinations the worker finds extracted values for, in route order:
+    size_t extractCount;            ///< Number of destinations.
+    resTree_EntryRef_t extractEntryRefs[JSON_MAX_MULTI_EXTRACTIONS]; ///< (hold references).
+    char specs[JSON_MAX_MULTI_EXTRACTIONS][ADMIN_MAX_JSON_EXTRACTOR_LEN + 1]; ///< Specifiers.
+    json_Span_t spans[JSON_MAX_MULTI_EXTRACTIONS]; ///< Set by the worker.
+}
+Job_t;
+
+/// Pool of Jobs.
+static le_mem_PoolRef_t JobPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(JobPool, DEFAULT_JSON_JOB_POOL_SIZE, sizeof(Job_t));
+
+/// Jobs waiting to be pushed, oldest first.
+static le_dls_List_t JobQueue = LE_DLS_LIST_INIT;
+
+/// The main thread, to which the workers hand the Jobs back.
+static le_thread_Ref_t MainThread = NULL;
+
+/// The worker threads.
+static le_thread_Ref_t Workers[DHUB_JSON_WORKER_THREADS];
+
+/// Index of the worker thread that gets the next Job.
+static size_t NextWorker = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Worker thread main function.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* WorkerMain
+(
+    void* contextPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(contextPtr);
+
+    le_event_RunLoop();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a Job for a given resource is waiting ahead of a given Job in the JobQueue.
+ *
+ * @return true if there is one.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsBlocked
+(
+    const Job_t* jobPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&JobQueue);
+
+    while (linkPtr != &jobPtr->link)
+    {
+        const Job_t* aheadPtr = CONTAINER_OF(linkPtr, Job_t, link);
+
+        if (aheadPtr->entryRef == jobPtr->entryRef)
+        {
+            return true;
+        }
+
+        linkPtr = le_dls_PeekNext(&JobQueue, linkPtr);
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Do the push of a Job whose work is done, and release the Job.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DoPush
+(
+    Job_t* jobPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // The resource may have been deleted since the push was queued.
+    res_Resource_t* resPtr = resTree_GetResourcePtr(jobPtr->entryRef);
+
+    if (resPtr == NULL)
+    {
+        le_mem_Release(jobPtr->dataSample);
+    }
+    else if (!jobPtr->isValid)
+    {
+        LE_WARN("Rejecting invalid JSON value pushed to '%s'.",
+                resTree_GetEntryName(jobPtr->entryRef));
+        le_mem_Release(jobPtr->dataSample);
+    }
+    else
+    {
+        // Only use the values found for destinations that still extract the same thing.
+        res_Resource_t* destPtrs[JSON_MAX_MULTI_EXTRACTIONS];
+        json_Span_t spans[JSON_MAX_MULTI_EXTRACTIONS];
+        size_t count = 0;
+
+        for (size_t i = 0; i < jobPtr->extractCount; i++)
+        {
+            res_Resource_t* destPtr = resTree_GetResourcePtr(jobPtr->extractEntryRefs[i]);
+
+            if (   (destPtr != NULL)
+                && (obs_GetJsonProgram(destPtr) != NULL)
+                && (strcmp(obs_GetJsonExtraction(destPtr), jobPtr->specs[i]) == 0))
+            {
+                destPtrs[count] = destPtr;
+                spans[count] = jobPtr->spans[i];
+                count++;
+            }
+        }
+
+        le_result_t result = res_PushExtracted(resPtr,
+                                               jobPtr->dataType,
+                                               jobPtr->units,
+                                               jobPtr->dataSample,
+                                               destPtrs,
+                                               spans,
+                                               count);
+        if (result != LE_OK)
+        {
+            LE_ERROR("Failed to push to '%s' (%s).",
+                     resTree_GetEntryName(jobPtr->entryRef),
+                     LE_RESULT_TXT(result));
+        }
+    }
+
+    for (size_t i = 0; i < jobPtr->extractCount; i++)
+    {
+        le_mem_Release(jobPtr->extractEntryRefs[i]);
+    }
+    le_mem_Release(jobPtr->entryRef);
+    le_mem_Release(jobPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Do the pushes of all the Jobs whose work is done and who aren't waiting behind another Job for
+ * the same resource.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DoReadyPushes
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&JobQueue);
+
+    while (linkPtr != NULL)
+    {
+        Job_t* jobPtr = CONTAINER_OF(linkPtr, Job_t, link);
+        linkPtr = le_dls_PeekNext(&JobQueue, linkPtr);
+
+        if (jobPtr->isWorkDone && !IsBlocked(jobPtr))
+        {
+            le_dls_Remove(&JobQueue, &jobPtr->link);
+            DoPush(jobPtr);
+
+            // The push may have queued or done other Jobs, so start over.
+            linkPtr = le_dls_Peek(&JobQueue);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called on the main thread when a worker is done with a Job.
+ */
+//--------------------------------------------------------------------------------------------------
+static void JobDone
+(
+    void* param1Ptr,    ///< The Job.
+    void* param2Ptr     ///< Not used.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(param2Ptr);
+
+    Job_t* jobPtr = param1Ptr;
+
+    jobPtr->isWorkDone = true;
+
+    DoReadyPushes();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called on a worker thread to do the work of a Job: validate its JSON value and find the values
+ * extracted from it by its destinations.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DoWork
+(
+    void* param1Ptr,    ///< The Job.
+    void* param2Ptr     ///< Not used.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(param2Ptr);
+
+    Job_t* jobPtr = param1Ptr;
+    const char* value = dataSample_GetJson(jobPtr->dataSample);
+
+    jobPtr->isValid = json_IsValid(value);
+
+    if (jobPtr->isValid && (jobPtr->extractCount > 0))
+    {
+        json_Extraction_t programs[JSON_MAX_MULTI_EXTRACTIONS];
+        const json_Extraction_t* programPtrs[JSON_MAX_MULTI_EXTRACTIONS];
+
+        for (size_t i = 0; i < jobPtr->extractCount; i++)
+        {
+            // The specifiers were compiled by the Observations, so they compile here too.
+            LE_ASSERT(json_CompileExtraction(jobPtr->specs[i], &programs[i]) == LE_OK);
+            programPtrs[i] = &programs[i];
+        }
+
+        LE_ASSERT(json_ExtractMultiple(value,
+                                       programPtrs,
+                                       jobPtr->extractCount,
+                                       jobPtr->spans) == LE_OK);
+    }
+
+    le_event_QueueFunctionToThread(MainThread, JobDone, jobPtr, NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocate a Job for a push to a given resource and add it to the end of the JobQueue.
+ *
+ * @return Ptr to the Job, or NULL if none could be allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static Job_t* QueueJob
+(
+    resTree_EntryRef_t entryRef,    ///< The resource to push to.
+    io_DataType_t dataType,         ///< The data type.
+    const char* units               ///< The units (NULL or "" = take on resource's units)
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Job_t* jobPtr = hub_MemAlloc(JobPool);
+    if (jobPtr == NULL)
+    {
+        return NULL;
+    }
+
+    jobPtr->link = LE_DLS_LINK_INIT;
+    jobPtr->entryRef = entryRef;
+    le_mem_AddRef(entryRef);
+    jobPtr->dataType = dataType;
+    jobPtr->dataSample = NULL;
+    le_utf8_Copy(jobPtr->units, (units == NULL) ? "" : units, sizeof(jobPtr->units), NULL);
+    jobPtr->isWorkDone = true;
+    jobPtr->isValid = true;
+    jobPtr->extractCount = 0;
+
+    le_dls_Queue(&JobQueue, &jobPtr->link);
+
+    return jobPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the JSON worker module and start the worker threads.
+ *
+ * @warning Must be called before any other functions in this module.
+ */
+//--------------------------------------------------------------------------------------------------
+void jsonWorker_Init
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    JobPool = le_mem_InitStaticPool(JobPool, DEFAULT_JSON_JOB_POOL_SIZE, sizeof(Job_t));
+    hub_RegisterPool(JobPool);
+
+    MainThread = le_thread_GetCurrent();
+
+    for (size_t i = 0; i < DHUB_JSON_WORKER_THREADS; i++)
+    {
+        char name[16];
+        snprintf(name, sizeof(name), "jsonWorker%zu", i);
+
+        Workers[i] = le_thread_Create(name, WorkerMain, NULL);
+        le_thread_Start(Workers[i]);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a JSON value is big enough to be validated by a worker thread.
+ *
+ * @return true if it should be pushed using jsonWorker_PushJson().
+ */
+//--------------------------------------------------------------------------------------------------
+bool jsonWorker_IsOffloaded
+(
+    const char* value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (strnlen(value, DHUB_JSON_OFFLOAD_BYTES) >= DHUB_JSON_OFFLOAD_BYTES);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a JSON value that has not been validated yet to a resource, having a worker thread
+ * validate it and find the values extracted from it by the resource's destinations first.
+ * Invalid JSON values are dropped once the worker is done with them.
+ *
+ * @return
+ *      - LE_OK If the push was queued.
+ *      - LE_NO_MEMORY If failed to create the data sample.
+ *      - LE_UNAVAILABLE If no worker job is available (the caller must do the push itself).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t jsonWorker_PushJson
+(
+    resTree_EntryRef_t entryRef,    ///< The resource to push to.
+    double timestamp,               ///< The timestamp (0 = now).
+    const char* value               ///< The JSON value.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    res_Resource_t* resPtr = resTree_GetResourcePtr(entryRef);
+    if (resPtr == NULL)
+    {
+        return LE_UNAVAILABLE;
+    }
+
+    Job_t* jobPtr = QueueJob(entryRef, IO_DATA_TYPE_JSON, NULL);
+    if (jobPtr == NULL)
+    {
+        return LE_UNAVAILABLE;
+    }
+
+    jobPtr->dataSample = dataSample_CreateJson(timestamp, value);
+    if (jobPtr->dataSample == NULL)
+    {
+        le_dls_Remove(&JobQueue, &jobPtr->link);
+        le_mem_Release(jobPtr->entryRef);
+        le_mem_Release(jobPtr);
+        return LE_NO_MEMORY;
+    }
+
+    // Copy the extraction specifiers, as the Observations may change them while the worker has
+    // the Job.
+    res_Resource_t* destPtrs[JSON_MAX_MULTI_EXTRACTIONS];
+    size_t count = res_GetExtractingDestinations(resPtr, destPtrs);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        jobPtr->extractEntryRefs[i] = destPtrs[i]->entryRef;
+        le_mem_AddRef(destPtrs[i]->entryRef);
+        le_utf8_Copy(jobPtr->specs[i],
+                     obs_GetJsonExtraction(destPtrs[i]),
+                     sizeof(jobPtr->specs[i]),
+                     NULL);
+    }
+    jobPtr->extractCount = count;
+
+    jobPtr->isWorkDone = false;
+    le_event_QueueFunctionToThread(Workers[NextWorker], DoWork, jobPtr, NULL);
+    NextWorker = (NextWorker + 1) % DHUB_JSON_WORKER_THREADS;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether there are offloaded pushes to a resource that haven't been done yet.
+ *
+ * @return true if pushes to the resource must be queued using jsonWorker_QueuePush().
+ */
+//--------------------------------------------------------------------------------------------------
+bool jsonWorker_IsPending
+(
+    resTree_EntryRef_t entryRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&JobQueue);
+
+    while (linkPtr != NULL)
+    {
+        if (CONTAINER_OF(linkPtr, Job_t, link)->entryRef == entryRef)
+        {
+            return true;
+        }
+
+        linkPtr = le_dls_PeekNext(&JobQueue, linkPtr);
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue a push to a resource behind the offloaded pushes to it that haven't been done yet.
+ *
+ * @note Takes ownership of the data sample reference.
+ *
+ * @return
+ *      - LE_OK If the push was queued.
+ *      - LE_NO_MEMORY If there was no room in the queue (the sample is dropped).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t jsonWorker_QueuePush
+(
+    resTree_EntryRef_t entryRef,    ///< The resource to push to.
+    io_DataType_t dataType,         ///< The data type.
+    const char* units,              ///< The units (NULL or "" = take on resource's units)
+    dataSample_Ref_t dataSample     ///< The data sample (timestamp + value).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Job_t* jobPtr = QueueJob(entryRef, dataType, units);
+    if (jobPtr == NULL)
+    {
+        LE_ERROR("Failed to queue a push to '%s'.", resTree_GetEntryName(entryRef));
+        le_mem_Release(dataSample);
+        return LE_NO_MEMORY;
+    }
+
+    jobPtr->dataSample = dataSample;
+
+    return LE_OK;
+}
+
+#endif // DHUB_JSON_WORKERS
@@ -0,0 +1,101 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file jsonWorker.h
+ *
+ * JSON worker threads.  Validate large JSON samples pushed through the I/O API, and find the
+ * values extracted from them by Observations, off the main thread (only if DHUB_JSON_WORKERS is
+ * defined).
+ *
+ * Offloaded pushes, and any pushes that come after them to the same resources, wait in a queue
+ * until the workers are done with them, so each resource still receives its samples in order.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef JSON_WORKER_H_INCLUDE_GUARD
+#define JSON_WORKER_H_INCLUDE_GUARD
+
+#ifdef DHUB_JSON_WORKERS
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the JSON worker module and start the worker threads.
+ *
+ * @warning Must be called before any other functions in this module.
+ */
+//--------------------------------------------------------------------------------------------------
+void jsonWorker_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a JSON value is big enough to be validated by a worker thread.
+ *
+ * @return true if it should be pushed using jsonWorker_PushJson().
+ */
+//--------------------------------------------------------------------------------------------------
+bool jsonWorker_IsOffloaded
+(
+    const char* value
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a JSON value that has not been validated yet to a resource, having a worker thread
+ * validate it and find the values extracted from it by the resource's destinations first.
+ * Invalid JSON values are dropped once the worker is done with them.
+ *
+ * @return
+ *      - LE_OK If the push was queued.
+ *      - LE_NO_MEMORY If failed to create the data sample.
+ *      - LE_UNAVAILABLE If no worker job is available (the caller must do the push itself).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t jsonWorker_PushJson
+(
+    resTree_EntryRef_t entryRef,    ///< The resource to push to.
+    double timestamp,               ///< The timestamp (0 = now).
+    const char* value               ///< The JSON value.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether there are offloaded pushes to a resource that haven't been done yet.
+ *
+ * @return true if pushes to the resource must be queued using jsonWorker_QueuePush().
+ */
+//--------------------------------------------------------------------------------------------------
+bool jsonWorker_IsPending
+(
+    resTree_EntryRef_t entryRef
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue a push to a resource behind the offloaded pushes to it that haven't been done yet.
+ *
+ * @note Takes ownership of the data sample reference.
+ *
+ * @return
+ *      - LE_OK If the push was queued.
+ *      - LE_NO_MEMORY If there was no room in the queue (the sample is dropped).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t jsonWorker_QueuePush
+(
+    resTree_EntryRef_t entryRef,    ///< The resource to push to.
+    io_DataType_t dataType,         ///< The data type.
+    const char* units,              ///< The units (NULL or "" = take on resource's units)
+    dataSample_Ref_t dataSample     ///< The data sample (timestamp + value).
+);
+
+#endif // DHUB_JSON_WORKERS
+
+#endif // JSON_WORKER_H_INCLUDE_GUARD
@@ -27,6 +27,55 @@
  *             s -> 4-byte unsigned integer length, followed by string content (no null-terminator)
  *             j -> 4-byte unsigned integer length, followed by JSON string content (no term char)
  *
+ * Version 1 backup files are journals, which let a backup append only the samples added since
+ * the previous backup instead of rewriting the whole buffer:
+ *
+ * - file format version byte = 1
+ * - data type byte (same as version 0)
+ * - sequence of segments, each written by one backup, containing:
+ *       - number of samples in the buffer (including this segment's) = 4-byte unsigned integer
+ *       - number of records in the segment = 4-byte unsigned integer
+ *       - array of records, sorted oldest-first, in the same format as version 0
+ *
+ * On restore, the segments are replayed in order, keeping only as many of the newest samples as
+ * each segment says were in the buffer.  Once the records that have fallen out of the buffer
+ * outnumber those still in it, or the buffer is emptied or changes type, the next backup compacts
+ * the journal by rewriting it as a single segment.  Version 0 files are still restored, and are
+ * replaced by a version 1 file on the next backup.
+ *
+ * Buffered samples are stored in one of two ways, depending on the buffered data type:
+ *
+ * - Trigger, Boolean and numeric samples are kept in "ring storage": their timestamps and values
+ *   are stored inline in fixed-size Sample Blocks, which are queued oldest-first.  When the oldest
+ *   block has been entirely consumed, it is recycled to the end of the queue, so a full buffer
+ *   doesn't allocate anything when new samples are added.  Each record is given a sequence number
+ *   so that read operations can detect when the record they are sitting on has been dropped.
+ * - String and JSON samples are kept in a list of Buffer Entries, each of which holds a reference
+ *   to a Data Sample object.
+ *
+ * If an Observation's buffer precision is compact, its ring storage values are rounded to single
+ * precision as they are added, and its timestamps to the millisecond after the timestamp of the
+ * first record in their Sample Block.  Once a Sample Block is full, it is replaced by a Compact
+ * Block, which stores each record in 8 bytes instead of 16 and gives back the same doubles.
+ *
+ * If an Observation's spill count is set, the ring storage samples that are evicted from its
+ * buffer are appended to its "spilled history" instead of being discarded.  The history is kept
+ * in segment files next to the backup file, named after it with SPILL_SUFFIX and the number of
+ * the segment's file slot.  Each segment file looks like this:
+ *
+ * - file format version byte = 2
+ * - data type byte (same as version 0, but only t, b or n)
+ * - array of up to DHUB_SPILL_SEGMENT_RECORDS records, sorted oldest-first, in the same format as
+ *   version 0
+ *
+ * Records are fixed-size, so a record can be read straight from its index.  Each segment's first
+ * timestamp, and the timestamps of every SPILL_INDEX_STRIDE-th record, are kept in memory as a
+ * sparse index.  When a new segment is needed and the history already has as many segments as
+ * the spill count needs, the oldest segment is deleted.
+ *
+ * Reads and queries given a start time older than the oldest buffered sample read the spilled
+ * history first, then carry on with the buffer.  Without a start time, they only cover the buffer.
+ *
  * Copyright (C) Sierra Wireless Inc.
  */
 //--------------------------------------------------------------------------------------------------
@@ -44,6 +93,7 @@
 
 #if LE_CONFIG_LINUX
 #   include <ftw.h>
+#   include <sys/mman.h>
 #endif
 
 #ifdef LEGATO_EMBEDDED
@@ -54,21 +104,279 @@
 #define BACKUP_DIR_PATH_LEN (sizeof(BACKUP_DIR) - 1)
 #define BACKUP_SUFFIX ".bak"
 #define BACKUP_SUFFIX_LEN (sizeof(BACKUP_SUFFIX) - 1)
+#define SPILL_SUFFIX ".seg."
+#define SPILL_SUFFIX_LEN (sizeof(SPILL_SUFFIX) - 1)
 
 #define MAX_BACKUP_FILE_PATH_BYTES (  BACKUP_DIR_PATH_LEN \
                                     + IO_MAX_RESOURCE_PATH_LEN \
                                     + BACKUP_SUFFIX_LEN \
                                     + 1 /* for null terminator */ )
 
+#define MAX_SPILL_FILE_PATH_BYTES (  BACKUP_DIR_PATH_LEN \
+                                   + IO_MAX_RESOURCE_PATH_LEN \
+                                   + SPILL_SUFFIX_LEN \
+                                   + 10 /* for the slot number */ \
+                                   + 1 /* for null terminator */ )
+
 /// Number of seconds in 30 years.
 #define THIRTY_YEARS 946684800.0
 
+/// Bucket length (in seconds) used by downsampling transforms if none is given.
+#define DEFAULT_BUCKET_PERIOD 60.0
+
 /// Default number of observations.  This can be overridden in the .cdef.
 #define DEFAULT_OBSERVATION_POOL_SIZE       5
 /// Default number of buffer entries.  This can be overridden in the .cdef.
 #define DEFAULT_BUFFER_ENTRY_POOL_SIZE      5
 /// Default number of read operations.  This can be overridden in the .cdef.
-#define DEFAULT_READ_OPERATION_POOL_SIZE    2
+#define DEFAULT_READ_OPERATION_POOL_SIZE    24
+/// Default number of write buffers for reads of string or JSON samples.  This can be overridden
+/// in the .cdef.
+#define DEFAULT_READ_BUFFER_POOL_SIZE       2
+/// Default number of sample blocks.  This can be overridden in the .cdef.
+#define DEFAULT_SAMPLE_BLOCK_POOL_SIZE      5
+/// Default number of compressed blocks.  This can be overridden in the .cdef.
+#define DEFAULT_COMPRESSED_BLOCK_POOL_SIZE  10
+/// Default number of compact blocks.  This can be overridden in the .cdef.
+#define DEFAULT_COMPACT_BLOCK_POOL_SIZE     10
+/// Default number of min/max deque blocks.  This can be overridden in the .cdef.
+#define DEFAULT_DEQUE_BLOCK_POOL_SIZE       2
+/// Default number of spilled history segments.  This can be overridden in the .cdef.
+#define DEFAULT_SPILL_SEGMENT_POOL_SIZE     4
+/// Default number of spill stages.  This can be overridden in the .cdef.
+#define DEFAULT_SPILL_STAGE_POOL_SIZE       2
+
+/// Number of sample records held in each Sample Block.
+#define SAMPLE_BLOCK_RECORDS 32
+
+/// Number of bytes of encoded records that a Compressed Block can hold.  A full Sample Block
+/// whose records don't fit is left uncompressed.  This can be overridden in the .cdef.
+#ifndef DHUB_COMPRESSED_BLOCK_BYTES
+#define DHUB_COMPRESSED_BLOCK_BYTES 128
+#endif
+
+/// Maximum number of backup files written each time the backup scheduler runs (0 = no limit).
+/// Writing an Observation's staged spilled history records counts as one file.  This can be
+/// overridden in the .cdef.
+#ifndef DHUB_BACKUP_MAX_FILES_PER_TICK
+#define DHUB_BACKUP_MAX_FILES_PER_TICK 8
+#endif
+
+/// Maximum number of bytes written to backup and spilled history files each second (0 = no limit).
+/// At least one backup is written each second, however large.  This can be overridden in the .cdef.
+#ifndef DHUB_BACKUP_BYTES_PER_SEC
+#define DHUB_BACKUP_BYTES_PER_SEC 0
+#endif
+
+/// Maximum time (in milliseconds) spent restoring backups in the background before letting the
+/// event loop serve clients again.  This can be overridden in the .cdef.
+#ifndef DHUB_RESTORE_SLICE_MS
+#define DHUB_RESTORE_SLICE_MS 5
+#endif
+
+/// Maximum number of records in each spilled history segment file.  This can be overridden in
+/// the .cdef.
+#ifndef DHUB_SPILL_SEGMENT_RECORDS
+#define DHUB_SPILL_SEGMENT_RECORDS 4096
+#endif
+
+/// Maximum number of evicted records that each Observation holds in memory until the backup
+/// scheduler writes them to its spilled history.  Records evicted while this many are waiting are
+/// dropped.  This can be overridden in the .cdef.
+#ifndef DHUB_SPILL_STAGE_RECORDS
+#define DHUB_SPILL_STAGE_RECORDS 256
+#endif
+
+/// File format version byte of spilled history segment files.
+#define SPILL_FILE_VERSION 2
+
+/// Size of the header of a spilled history segment file (version and data type bytes).
+#define SPILL_HEADER_BYTES 2
+
+/// Number of timestamps in the sparse index of a spilled history segment.
+#define SPILL_INDEX_ENTRIES 16
+
+/// Number of records between two timestamps of the sparse index of a spilled history segment.
+#define SPILL_INDEX_STRIDE \
+    ((DHUB_SPILL_SEGMENT_RECORDS + SPILL_INDEX_ENTRIES - 1) / SPILL_INDEX_ENTRIES)
+
+
+/// Formats of the blocks of records in an Observation's ring storage.
+typedef enum
+{
+    BLOCK_FORMAT_SAMPLE,        ///< Sample Block (SampleBlock_t).
+    BLOCK_FORMAT_COMPRESSED,    ///< Compressed Block (CompressedBlock_t).
+    BLOCK_FORMAT_COMPACT,       ///< Compact Block (CompactBlock_t).
+}
+BlockFormat_t;
+
+
+/// Header of a block of records in an Observation's ring storage.
+typedef struct
+{
+    le_dls_Link_t link;         ///< Used to link into an Observation's blockList.
+    uint64_t firstSeq;          ///< Sequence number of the record at index 0.
+    BlockFormat_t format;       ///< Format of the block.
+}
+RingBlock_t;
+
+
+/// Block of inline sample records used by an Observation's ring storage.
+/// Timestamps and values are kept in parallel arrays so scans only touch the data they need.
+typedef struct
+{
+    RingBlock_t header;                         ///< Block header (MUST BE FIRST).
+    double timestamps[SAMPLE_BLOCK_RECORDS];    ///< Sample timestamps.
+    double values[SAMPLE_BLOCK_RECORDS];        ///< Sample values (Boolean as 0 or 1).
+}
+SampleBlock_t;
+
+
+/// Full block of sample records, compressed Gorilla-style (see CompressBlock()).
+typedef struct
+{
+    RingBlock_t header;                         ///< Block header (MUST BE FIRST).
+    uint8_t bytes[DHUB_COMPRESSED_BLOCK_BYTES]; ///< Encoded records.
+}
+CompressedBlock_t;
+
+
+/// Full block of sample records, stored with reduced precision (see CompactBlock()).
+typedef struct
+{
+    RingBlock_t header;                         ///< Block header (MUST BE FIRST).
+    double baseTime;                            ///< Timestamp of the record at index 0.
+    uint32_t timeOffsets[SAMPLE_BLOCK_RECORDS]; ///< Sample timestamps (ms after baseTime).
+    float values[SAMPLE_BLOCK_RECORDS];         ///< Sample values (Boolean as 0 or 1).
+}
+CompactBlock_t;
+
+
+/// Block of entries in a monotonic deque.  Each entry holds a ring storage record's sequence
+/// number and value.
+typedef struct
+{
+    le_dls_Link_t link;                         ///< Used to link into a deque's blockList.
+    uint64_t seq[SAMPLE_BLOCK_RECORDS];         ///< Sequence numbers of the records.
+    double values[SAMPLE_BLOCK_RECORDS];        ///< Values of the records.
+}
+DequeBlock_t;
+
+
+/// Monotonic deque of ring storage records, used to track the minimum or maximum of the buffer
+/// without scanning it.  The front entry holds the current extreme value.
+typedef struct
+{
+    le_dls_List_t blockList;    ///< Deque Blocks (front first).
+    size_t headIndex;           ///< Index of the front entry in the first block.
+    size_t tailIndex;           ///< Index after the back entry in the last block.
+    size_t count;               ///< Number of entries in the deque.
+    bool isEnabled;             ///< true if the deque is being maintained.
+}
+MonoDeque_t;
+
+
+/// Running aggregates over the numerical values in an Observation's ring storage.
+/// The mean and variance are kept using Welford's algorithm, extended to support removal.
+typedef struct
+{
+    size_t count;               ///< Number of (non-NAN) values aggregated.
+    double mean;                ///< Mean of the values.
+    double m2;                  ///< Sum of squared differences from the mean.
+    MonoDeque_t minDeque;       ///< Candidates for the minimum (increasing values).
+    MonoDeque_t maxDeque;       ///< Candidates for the maximum (decreasing values).
+}
+Aggregates_t;
+
+
+/// Bucket of samples being aggregated by a downsampling transform.
+typedef struct
+{
+    double period;              ///< Length of each bucket (seconds).
+    double startTime;           ///< Start time of the bucket (a multiple of the period).
+    size_t count;               ///< Number of samples in the bucket (0 = bucket empty).
+    io_DataType_t dataType;     ///< Data type of the samples in the bucket.
+    double sum;                 ///< Sum of the values.
+    double min;                 ///< Minimum value.
+    double max;                 ///< Maximum value.
+    double last;                ///< Newest value.
+}
+Bucket_t;
+
+
+/// Segment file of an Observation's spilled history.  Read operations hold a reference on the
+/// segment they are reading, so it stays valid (and its file stays open) after it is dropped.
+typedef struct
+{
+    le_dls_Link_t link;         ///< Used to link into an Observation's spillList.
+    unsigned int slot;          ///< Number of the segment's file slot.
+    io_DataType_t dataType;     ///< Data type of the records (trigger, Boolean or numeric).
+    size_t count;               ///< Number of records in the segment.
+    size_t savedCount;          ///< Number of records written to the file (the rest are staged).
+    bool isClosed;              ///< true if no more records can be appended to the segment.
+    bool isDropped;             ///< true once removed from the history (its slot may be reused).
+    double lastTimestamp;       ///< Timestamp of the newest record.
+    uint64_t seq;               ///< Order in which the segments were started (oldest lowest).
+    double index[SPILL_INDEX_ENTRIES]; ///< Timestamps of every SPILL_INDEX_STRIDE-th record.
+}
+SpillSegment_t;
+
+
+/// Evicted records of an Observation waiting to be written to its spilled history, oldest first.
+/// They are the unsaved records of the newest segments, which count them but have no file space
+/// for them yet.
+typedef struct
+{
+    size_t count;                                   ///< Number of records staged.
+    size_t droppedCount;                            ///< Records dropped because the stage was full.
+    double timestamps[DHUB_SPILL_STAGE_RECORDS];    ///< Record timestamps.
+    double values[DHUB_SPILL_STAGE_RECORDS];        ///< Record values (Boolean as 0 or 1).
+}
+SpillStage_t;
+
+
+/// Position in an Observation's spilled history, used to read it oldest first.  Records are
+/// loaded from the segment files a Sample Block at a time, so that they can be read through a
+/// buffer position, like buffered records.
+typedef struct
+{
+    SpillSegment_t* segPtr;     ///< Segment being read (reference held), or NULL if done.
+    int fd;                     ///< File descriptor of the segment's file (-1 if none).
+    size_t nextIndex;           ///< Index in the segment of the next record to load.
+    double startTime;           ///< Records older than this (or as old, if excluded) are skipped.
+    bool isStartIncluded;       ///< true if records timestamped startTime are read.
+    double lastTimestamp;       ///< Timestamp of the last record read (NAN if none yet).
+    size_t loadedCount;         ///< Number of records loaded into the Sample Block.
+    size_t loadedIndex;         ///< Index in the Sample Block of the next record to read.
+    SampleBlock_t records;      ///< Records loaded from the segment file.
+}
+SpillCursor_t;
+
+
+/// Object used to link a Data Sample into an Observation's buffer.
+/// Holds a reference on the Data Sample object.
+typedef struct
+{
+    le_sls_Link_t link;  ///< Used to link into a Observation's sampleList.
+    dataSample_Ref_t sampleRef; ///< Reference to the Data Sample object.
+}
+BufferEntry_t;
+
+
+/// Position of a sample in an Observation's buffer.  Only one of entryPtr and blockPtr is set
+/// (depending on the storage used) and both are NULL if the position doesn't refer to a sample.
+typedef struct
+{
+    BufferEntry_t* entryPtr;    ///< Buffer Entry (list storage).
+    RingBlock_t* blockPtr;      ///< Block holding the record (ring storage).
+    size_t index;               ///< Index of the record in the Sample Block (ring storage).
+    uint64_t seq;               ///< Sequence number of the record (ring storage).
+}
+BufferPos_t;
+
+/// Initializer for a buffer position that doesn't refer to any sample.
+#define BUFFER_POS_INIT { NULL, NULL, 0, 0 }
+
 
 /// Observation Resource.  Allocated from the Observation Pool.
 typedef struct
@@ -83,37 +391,52 @@ typedef struct
     uint32_t lastPushTime; ///< Time at which last push was accepted (ms, relative clock).
 
     obs_TransformType_t transformType; ///< Buffer transform type
+    Bucket_t bucket;  ///< Current bucket of a downsampling transform.
 
     size_t maxCount;  ///< Maximum number of entries to buffer.
     size_t count;     ///< Current number of entries in the buffer.
 
     io_DataType_t bufferedType; ///< Data type of samples currently in the buffer.
+    bool isBufferCompact;   ///< true if ring storage records are kept with reduced precision.
 
     uint32_t backupPeriod; ///< Min time (in seconds) between non-volatile backups of the buffer.
     uint32_t lastBackupTime; ///< Time at which last push was accepted (seconds, relative clock).
-    le_timer_Ref_t backupTimer; ///< Reference to the timer used to trigger the next backup.
+    uint32_t backupDueTime; ///< When the next backup is due (seconds, relative clock).
+    bool isBackupScheduled; ///< true if in the BackupQueue, waiting for backupDueTime.
+    le_dls_Link_t backupLink; ///< Link in the BackupQueue.
+    size_t unsavedCount;   ///< Number of the newest buffered samples not yet in the backup file.
+    size_t journalCount;   ///< Number of records in the backup file (including dropped ones).
+    bool isJournalValid;   ///< true if new samples can be appended to the backup file.
+    bool isRestorePending; ///< true if the buffer hasn't been restored from backup yet.
+    le_dls_Link_t restoreLink; ///< Link in the RestoreQueue (while isRestorePending).
+
+    uint32_t spillMaxCount; ///< Number of evicted samples to keep on flash (0 = don't spill).
+    le_dls_List_t spillList; ///< Spilled history segments (oldest first).
+    int spillFd;            ///< File descriptor of the newest segment's file (-1 if not open).
+    SpillStage_t* spillStagePtr; ///< Records waiting to be written to the history, or NULL.
+    le_dls_Link_t spillLink; ///< Link in the SpillQueue (while spillStagePtr isn't NULL).
 
     le_sls_List_t sampleList; ///< Queue of buffered data samples (oldest first, newest last).
 
+    le_dls_List_t blockList;  ///< Ring storage Sample Blocks (oldest first, spare block last).
+    size_t headIndex;         ///< Index of the oldest record in the first Sample Block.
+    SampleBlock_t* tailBlockPtr; ///< Sample Block holding the newest record (NULL if empty).
+    size_t tailIndex;         ///< Index of the next free record in the tail Sample Block.
+    uint64_t oldestSeq;       ///< Sequence number of the oldest record in ring storage.
+    dataSample_Ref_t scratchSampleRef; ///< Data Sample built from a ring storage record, or NULL.
+    Aggregates_t aggregates;  ///< Running aggregates over the ring storage values.
+    BufferPos_t searchCursor; ///< Position found by the last ring storage time search.
+
     le_dls_List_t readOpList; ///< List of ongoing Read Operations on the buffered samples.
 
     char jsonExtraction[ADMIN_MAX_JSON_EXTRACTOR_LEN + 1]; ///< JSON extraction specifier (or "").
+    json_Extraction_t jsonProgram; ///< jsonExtraction compiled into steps (if isJsonProgramValid).
+    bool isJsonProgramValid;       ///< true if jsonProgram can be used instead of jsonExtraction.
     char destination[CONFIG_MAX_DESTINATION_NAME_BYTES];   ///< Destination name string
 }
 Observation_t;
 
 
-
-/// Object used to link a Data Sample into an Observation's buffer.
-/// Holds a reference on the Data Sample object.
-typedef struct
-{
-    le_sls_Link_t link;  ///< Used to link into a Observation's sampleList.
-    dataSample_Ref_t sampleRef; ///< Reference to the Data Sample object.
-}
-BufferEntry_t;
-
-
 /// Each data sample in a read operation looks like the following:
 /// {"t":1537483647.125371,"v":true}
 /// The largest value is IO_MAX_STRING_VALUE_LEN bytes long.
@@ -122,6 +445,52 @@ BufferEntry_t;
 /// but in this case they typically won't be more than 6 decimal places.
 #define READ_OP_BUFF_BYTES (HUB_MAX_STRING_BYTES + 48)
 
+/// Number of bytes of formatted samples that a read operation tries to batch into each write, on
+/// top of the room reserved for one of the largest samples.  Set this to 0 in the .cdef to write
+/// out one sample at a time.
+#ifndef DHUB_READ_OP_BATCH_BYTES
+#define DHUB_READ_OP_BATCH_BYTES 4096
+#endif
+
+/// Size of a read operation's write buffer.  Includes room for the brackets around the samples.
+#define READ_OP_CHUNK_BYTES (DHUB_READ_OP_BATCH_BYTES + READ_OP_BUFF_BYTES + 2)
+
+/// Number of write buffers a read operation loads before it yields to the event loop, so a fast
+/// reader of a long buffer doesn't hold up pushes.  This can be overridden in the .cdef.
+#ifndef DHUB_READ_OP_SLICE_CHUNKS
+#define DHUB_READ_OP_SLICE_CHUNKS 16
+#endif
+
+/// Trigger, Boolean and numeric samples in a read operation are much shorter.  The longest is a
+/// numeric value as large as a double can be, which takes up to 317 characters with "%lf".
+#define READ_OP_SMALL_BUFF_BYTES 400
+
+/// Size of the write buffer of a read operation on trigger, Boolean or numeric samples.
+#define READ_OP_SMALL_CHUNK_BYTES (DHUB_READ_OP_BATCH_BYTES + READ_OP_SMALL_BUFF_BYTES + 2)
+
+/// CBOR (RFC 7049) major types and simple values used by buffer read operations.
+#define CBOR_MAJOR_TEXT_STRING  0x60
+#define CBOR_MAJOR_ARRAY        0x80
+#define CBOR_INDEF_ARRAY_START  0x9f
+#define CBOR_FALSE              0xf4
+#define CBOR_TRUE               0xf5
+#define CBOR_NULL               0xf6
+#define CBOR_FLOAT64            0xfb
+#define CBOR_BREAK              0xff
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A sample selected by a decimating read operation, or a running total of samples.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    double timestamp;
+    double value;
+}
+ReadOpPoint_t;
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -134,13 +503,39 @@ typedef struct
     Observation_t* obsPtr;  ///< Ptr to Observation whose buffer is being read.
     le_fdMonitor_Ref_t fdMonitor; ///< Used to get notification when the FD is clear to write.
     int fd; ///< fd to write to.
-    BufferEntry_t* nextEntryPtr; ///< Buff entry to load into write buff next (ref counted).
-    enum { START, SAMPLE, COMMA, END } state; ///< What are we supposed to write next?
-    char writeBuffer[READ_OP_BUFF_BYTES];  ///< Buffer currently being written.
-    size_t writeLen; ///< Number of characters (excl. null terminator) in the writeBuffer.
+    BufferPos_t nextPos; ///< Position of sample to load into write buff next (entries ref counted).
+    enum { START, HISTORY, SAMPLE, END, DONE } state; ///< What are we supposed to load next?
+    SpillCursor_t history; ///< Position in the spilled history (segPtr is NULL if not read).
+    bool isCbor;     ///< true if writing CBOR, false if writing JSON.
+    bool needsComma; ///< true if a comma must be written before the next JSON sample.
+    size_t maxCount; ///< Number of samples to decimate the buffered read data to; 0 = all samples.
+    size_t spanCount;     ///< Number of samples in the read data (when decimating).
+    size_t bucketIndex;   ///< Index of the next bucket to select a sample from (when decimating).
+    BufferPos_t bucketPos; ///< Position of the first sample in that bucket (entries ref counted).
+    double prevTimestamp; ///< Timestamp of the last sample selected (when decimating), or the
+                          ///< mean timestamp of the current bucket (QUERY_DECIMATION_MEAN).
+    double prevValue;     ///< Value of the last sample selected (when decimating), or the mean
+                          ///< value of the current bucket (QUERY_DECIMATION_MEAN).
+    query_DecimationMode_t decimation; ///< How samples are selected (when decimating).
+    size_t historyMaxCount; ///< Number of samples to decimate the spilled history to; 0 = all.
+    size_t historySpan;   ///< Number of samples in the spilled history (when decimating it).
+    size_t historyIndex;  ///< Number of those read so far.
+    size_t historyBucket; ///< Index of the history bucket being read.
+    size_t bucketCount;   ///< Number of samples read into that bucket so far.
+    ReadOpPoint_t bucketFirst; ///< First sample of that bucket.
+    ReadOpPoint_t bucketMin;   ///< Sample of that bucket with the smallest value.
+    ReadOpPoint_t bucketMax;   ///< Sample of that bucket with the largest value.
+    ReadOpPoint_t bucketSum;   ///< Sums of the timestamps and values of that bucket's samples.
+    ReadOpPoint_t historyPoint; ///< Last sample selected from the history.
+    bool hasHistoryPoint; ///< true if the historyPoint is still to be written.
+    double endTime; ///< Samples newer than this aren't read (seconds since the Epoch, or HUGE_VAL).
+    char* writeBuffer;      ///< Chunk being written (smallBuffer, or from ReadBufferPool).
+    size_t writeBufferSize; ///< Size of the writeBuffer, in bytes.
+    size_t writeLen; ///< Number of characters in the writeBuffer.
     size_t writeOffset;   ///< Offset into the writeBuffer to write from next.
     query_ReadCompletionFunc_t handlerPtr; ///< Completion callback.
     void* contextPtr;   ///< Value to be passed to completion callback.
+    char smallBuffer[READ_OP_SMALL_CHUNK_BYTES]; ///< Write buffer for short samples.
 }
 ReadOperation_t;
 
@@ -159,6 +554,106 @@ LE_MEM_DEFINE_STATIC_POOL(ReadOperationPool,
                           DEFAULT_READ_OPERATION_POOL_SIZE,
                           sizeof(ReadOperation_t));
 
+/// Pool of write buffers for read operations on string or JSON samples.
+static le_mem_PoolRef_t ReadBufferPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(ReadBufferPool, DEFAULT_READ_BUFFER_POOL_SIZE, READ_OP_CHUNK_BYTES);
+
+/// Pool of Sample Block objects.
+static le_mem_PoolRef_t SampleBlockPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(SampleBlockPool, DEFAULT_SAMPLE_BLOCK_POOL_SIZE, sizeof(SampleBlock_t));
+
+/// Pool of Compact Block objects.
+static le_mem_PoolRef_t CompactBlockPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(CompactBlockPool,
+                          DEFAULT_COMPACT_BLOCK_POOL_SIZE,
+                          sizeof(CompactBlock_t));
+
+#ifdef DHUB_COMPRESSED_BUFFERS
+/// Pool of Compressed Block objects.
+static le_mem_PoolRef_t CompressedBlockPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(CompressedBlockPool,
+                          DEFAULT_COMPRESSED_BLOCK_POOL_SIZE,
+                          sizeof(CompressedBlock_t));
+#endif
+
+/// Records of the Compressed or Compact Block decoded last.  Reads usually walk through a block's
+/// records in order, so this means each block is decoded once per pass.
+static struct
+{
+    const RingBlock_t* blockPtr;        ///< Block whose records are cached, or NULL.
+    SampleBlock_t records;              ///< Decoded records (the header isn't used).
+}
+DecodedBlock;
+
+/// Pool of Deque Block objects.
+static le_mem_PoolRef_t DequeBlockPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(DequeBlockPool, DEFAULT_DEQUE_BLOCK_POOL_SIZE, sizeof(DequeBlock_t));
+
+/// Pool of Spill Segment objects.
+static le_mem_PoolRef_t SpillSegmentPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(SpillSegmentPool,
+                          DEFAULT_SPILL_SEGMENT_POOL_SIZE,
+                          sizeof(SpillSegment_t));
+
+#if LE_CONFIG_LINUX
+/// Pool of Spill Stage objects (only needed where histories can be spilled).
+static le_mem_PoolRef_t SpillStagePool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(SpillStagePool, DEFAULT_SPILL_STAGE_POOL_SIZE, sizeof(SpillStage_t));
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Observations that have samples waiting to be backed up, in order of backupDueTime.  A single
+ * timer writes their backups when they are due, a limited number at a time, so that the writes
+ * to non-volatile storage are bounded and happen together rather than at random times.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t BackupQueue = LE_DLS_LIST_INIT;
+
+/// Timer used to run the backup scheduler when the first Observation in the BackupQueue is due.
+static le_timer_Ref_t BackupTimer = NULL;
+
+/// true while the backup scheduler is writing backups.
+static bool IsBackupPassRunning = false;
+
+/// Number of bytes written to backup files so far (wraps around).
+static size_t BackupBytesWritten = 0;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Observations that have evicted records staged in memory (see SpillRecord()).  The backup
+ * scheduler writes them to the spilled history files, within the same budget as the backups, so
+ * that evicting a sample never waits for non-volatile storage.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t SpillQueue = LE_DLS_LIST_INIT;
+
+/// When the records in the SpillQueue are due to be written (seconds, relative clock).
+static uint32_t SpillDueTime = 0;
+
+#ifdef DHUB_LAZY_RESTORE
+//--------------------------------------------------------------------------------------------------
+/**
+ * Observations whose buffer is waiting to be restored from backup, oldest first.  They are
+ * restored a few at a time from the event loop, or as soon as they are pushed to or queried.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t RestoreQueue = LE_DLS_LIST_INIT;
+
+/// true if RestoreInBackground() has been queued to the event loop.
+static bool IsRestoreScheduled = false;
+
+/// true if the clean-up of unused backup files is waiting for the RestoreQueue to be empty.
+static bool IsCleanupPending = false;
+
+/// Maximum time spent in each call to RestoreInBackground().
+static const le_clk_Time_t RestoreSlice =
+{
+    .sec = DHUB_RESTORE_SLICE_MS / 1000,
+    .usec = (DHUB_RESTORE_SLICE_MS % 1000) * 1000
+};
+#endif
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -240,829 +735,960 @@ static void DeleteBackup
     {
         unlink(path);
     }
+
+    obsPtr->journalCount = 0;
+    obsPtr->isJournalValid = false;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Buffer Entry destructor.
+ * Get the file system path to use for a given file slot of an Observation's spilled history.
+ *
+ * @return LE_OK if successful.
  */
 //--------------------------------------------------------------------------------------------------
-static void BufferEntryDestructor
+static le_result_t GetSpillFilePath
 (
-    void* objectPtr
+    char* pathBuffPtr,  ///< [OUT] Ptr to where the path will be written.
+    size_t pathBuffSize,    ///< Size of the buffer in bytes.
+    Observation_t* obsPtr,
+    unsigned int slot
 )
 //--------------------------------------------------------------------------------------------------
 {
-    BufferEntry_t* buffEntryPtr = objectPtr;
+    le_result_t result = GetBackupFilePath(pathBuffPtr, pathBuffSize, obsPtr);
+    if (result != LE_OK)
+    {
+        return result;
+    }
 
-    le_mem_Release(buffEntryPtr->sampleRef);
+    // Replace the backup file suffix with the segment file suffix.
+    size_t len = strlen(pathBuffPtr) - BACKUP_SUFFIX_LEN;
+    if ((int)(pathBuffSize - len) <= snprintf(pathBuffPtr + len,
+                                              pathBuffSize - len,
+                                              SPILL_SUFFIX "%u",
+                                              slot))
+    {
+        return LE_OVERFLOW;
+    }
+
+    return LE_OK;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Terminate a read operation.
+ * Get the size of the records in the spilled history segment files of a given data type.
+ *
+ * @return The size, in bytes.
  */
 //--------------------------------------------------------------------------------------------------
-static void EndRead
+static inline size_t GetSpillRecordBytes
 (
-    ReadOperation_t* opPtr,
-    le_result_t result
+    io_DataType_t dataType
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (opPtr->nextEntryPtr != NULL)
+    switch (dataType)
     {
-        le_mem_Release(opPtr->nextEntryPtr);
-        opPtr->nextEntryPtr = NULL;
+        case IO_DATA_TYPE_BOOLEAN:  return sizeof(double) + 1;
+        case IO_DATA_TYPE_NUMERIC:  return sizeof(double) + sizeof(double);
+        default:                    return sizeof(double);
     }
-
-    le_fdMonitor_Delete(opPtr->fdMonitor);
-
-    close(opPtr->fd);
-
-    opPtr->handlerPtr(result, opPtr->contextPtr);
-
-    le_dls_Remove(&opPtr->obsPtr->readOpList, &opPtr->link);
-
-    le_mem_Release(opPtr);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Observation destructor.
+ * Get the index in an Observation's spill stage of the first unsaved record of a given segment
+ * of its spilled history.  The stage holds the unsaved records of the newest segments, in order.
+ *
+ * @return The index.
  */
 //--------------------------------------------------------------------------------------------------
-static void ObservationDestructor
+static size_t GetStagedIndex
 (
-    void* objectPtr
+    Observation_t* obsPtr,
+    SpillSegment_t* segPtr  ///< Segment with unsaved records (must be in the spillList).
 )
 //--------------------------------------------------------------------------------------------------
 {
-    Observation_t* obsPtr = objectPtr;
+    size_t index = obsPtr->spillStagePtr->count;
+    le_dls_Link_t* linkPtr = le_dls_PeekTail(&obsPtr->spillList);
 
-    // Delete all the buffered data samples.
-    le_sls_Link_t* linkPtr;
-    while (NULL != (linkPtr = le_sls_Pop(&obsPtr->sampleList)))
+    for (;;)
     {
-        BufferEntry_t* buffEntryPtr = CONTAINER_OF(linkPtr, BufferEntry_t, link);
-
-        le_mem_Release(buffEntryPtr);
-    }
+        SpillSegment_t* newerPtr = CONTAINER_OF(linkPtr, SpillSegment_t, link);
 
-    obsPtr->count = 0;
-    obsPtr->maxCount = 0;
+        index -= (newerPtr->count - newerPtr->savedCount);
 
-    // If the observation had backups enabled, delete the backup file.
-    if (obsPtr->backupPeriod > 0)
-    {
-        DeleteBackup(obsPtr);
-    }
+        if (newerPtr == segPtr)
+        {
+            return index;
+        }
 
-    // If there are read operations in progress, end them.
-    while (le_dls_IsEmpty(&obsPtr->readOpList) == false)
-    {
-        EndRead(CONTAINER_OF(le_dls_Peek(&obsPtr->readOpList), ReadOperation_t, link),
-                LE_COMM_ERROR);
+        linkPtr = le_dls_PeekPrev(&obsPtr->spillList, linkPtr);
     }
-
-    res_Destruct(&obsPtr->resource);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the first (oldest) buffer entry in an Observation's data sample buffer.
- *
- * @return Pointer to the buffer entry or NULL if the buffer is empty.
+ * Release an Observation's spill stage and remove the Observation from the SpillQueue, if it has
+ * a stage.
  */
 //--------------------------------------------------------------------------------------------------
-static BufferEntry_t* GetOldestBufferEntry
+static void ReleaseSpillStage
 (
     Observation_t* obsPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_sls_Link_t* linkPtr = le_sls_Peek(&obsPtr->sampleList);
-
-    if (linkPtr != NULL)
-    {
-        return CONTAINER_OF(linkPtr, BufferEntry_t, link);
-    }
-    else
+    if (obsPtr->spillStagePtr != NULL)
     {
-        return NULL;
+        le_dls_Remove(&SpillQueue, &obsPtr->spillLink);
+        le_mem_Release(obsPtr->spillStagePtr);
+        obsPtr->spillStagePtr = NULL;
     }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the next (newer) buffer entry in an Observation's data sample buffer.
- *
- * @return A pointer to the buffer entry, or NULL if there are no newer samples in the buffer.
+ * Remove a segment from an Observation's spilled history and delete its file, discarding any of
+ * its records that are still staged.  Read operations that hold the segment can finish reading
+ * its saved records through their own file descriptors.
  */
 //--------------------------------------------------------------------------------------------------
-static BufferEntry_t* GetNextBufferEntry
+static void DropSpillSegment
 (
     Observation_t* obsPtr,
-    BufferEntry_t* buffEntryPtr
+    SpillSegment_t* segPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_sls_Link_t* linkPtr = le_sls_PeekNext(&obsPtr->sampleList, &buffEntryPtr->link);
+    size_t unsavedCount = segPtr->count - segPtr->savedCount;
+    if (unsavedCount > 0)
+    {
+        SpillStage_t* stagePtr = obsPtr->spillStagePtr;
+        size_t index = GetStagedIndex(obsPtr, segPtr);
+        size_t newerCount = stagePtr->count - index - unsavedCount;
+
+        memmove(&stagePtr->timestamps[index],
+                &stagePtr->timestamps[index + unsavedCount],
+                newerCount * sizeof(double));
+        memmove(&stagePtr->values[index],
+                &stagePtr->values[index + unsavedCount],
+                newerCount * sizeof(double));
+        stagePtr->count -= unsavedCount;
+        segPtr->count = segPtr->savedCount;
+
+        if (stagePtr->count == 0)
+        {
+            ReleaseSpillStage(obsPtr);
+        }
+    }
 
-    if (linkPtr != NULL)
+    // The newest segment's file may be open for writing.
+    if (   (&segPtr->link == le_dls_PeekTail(&obsPtr->spillList))
+        && (obsPtr->spillFd != -1)  )
     {
-        return CONTAINER_OF(linkPtr, BufferEntry_t, link);
+        close(obsPtr->spillFd);
+        obsPtr->spillFd = -1;
     }
-    else
+
+    le_dls_Remove(&obsPtr->spillList, &segPtr->link);
+    segPtr->isDropped = true;
+    segPtr->isClosed = true;
+
+    char path[MAX_SPILL_FILE_PATH_BYTES];
+    if (GetSpillFilePath(path, sizeof(path), obsPtr, segPtr->slot) == LE_OK)
     {
-        return NULL;
+        if ((unlink(path) != 0) && (errno != ENOENT))
+        {
+            LE_ERROR("Failed to delete '%s' (%m).", path);
+        }
     }
+
+    le_mem_Release(segPtr);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Load the write buffer with a JSON representation of the next sample to be read.
- *
- * @return true if successful, false if there are no more samples.
+ * Delete all of a given Observation's spilled history.
  */
 //--------------------------------------------------------------------------------------------------
-static bool LoadReadOpBuffer
+static void DeleteSpillSegments
 (
-    ReadOperation_t* opPtr
+    Observation_t* obsPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    opPtr->writeLen = 0;
-    opPtr->writeOffset = 0;
-    opPtr->writeBuffer[0] = '\0';
-
-    do
+    le_dls_Link_t* linkPtr;
+    while (NULL != (linkPtr = le_dls_Peek(&obsPtr->spillList)))
     {
-        if (opPtr->nextEntryPtr == NULL)
-        {
-            return false;
-        }
-
-        // If the buffer entry's ref count should be 2.  If it is only 1, then we know it has
-        // fallen off the end of the observation's buffer, which means that all entries in the
-        // observation's buffer are now newer than this one.
-        if (le_mem_GetRefCount(opPtr->nextEntryPtr) == 1)
-        {
-            le_mem_Release(opPtr->nextEntryPtr);
-            opPtr->nextEntryPtr = GetOldestBufferEntry(opPtr->obsPtr);
-            if (opPtr->nextEntryPtr != NULL)
-            {
-                le_mem_AddRef(opPtr->nextEntryPtr);
-            }
-            else
-            {
-                return false;
-            }
-        }
-
-        int len = snprintf(opPtr->writeBuffer,
-                           sizeof(opPtr->writeBuffer),
-                           "{\"t\":%lf,\"v\":",
-                           dataSample_GetTimestamp(opPtr->nextEntryPtr->sampleRef));
-        if (len >= (int) sizeof(opPtr->writeBuffer))
-        {
-            LE_CRIT("Buffer overflow. Skipping entry.");
-            // Leave the writeLen 0 so we'll loop around and try the next sample.
-        }
-        else
-        {
-            // Copy the JSON version of the contents of the current buffer entry's data into
-            // the write buffer, if there's space (leaving room for an additional '}' at the end).
-            le_result_t result = dataSample_ConvertToJson(opPtr->nextEntryPtr->sampleRef,
-                                                          res_GetDataType(&(opPtr->obsPtr->resource)),
-                                                          opPtr->writeBuffer + len,
-                                                          sizeof(opPtr->writeBuffer) - len - 1);
-            if (result != LE_OK)
-            {
-                LE_ERROR("JSON value doesn't fit in write buffer. Skipping.");
-                // Leave the writeLen 0 so we'll loop around and try the next sample.
-            }
-            else
-            {
-                len += strlen(opPtr->writeBuffer + len);
-
-                opPtr->writeBuffer[len] = '}';
-                opPtr->writeBuffer[len + 1] = '\0';
-
-                opPtr->writeLen = len + 1;
-            }
-        }
-
-        // Advance the nextEntryPtr to the next entry in the Observation's data sample list.
-        BufferEntry_t* nextEntryPtr = GetNextBufferEntry(opPtr->obsPtr, opPtr->nextEntryPtr);
-        le_mem_Release(opPtr->nextEntryPtr);
-
-        if (nextEntryPtr != NULL)
-        {
-            opPtr->nextEntryPtr = nextEntryPtr;
-            le_mem_AddRef(nextEntryPtr);
-        }
-        else
-        {
-            opPtr->nextEntryPtr = NULL;
-        }
-
-    } while (opPtr->writeLen == 0); // Loop if the write buffer is still empty.
-
-    return true;
+        DropSpillSegment(obsPtr, CONTAINER_OF(linkPtr, SpillSegment_t, link));
+    }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Write to an unbuffered file descriptor.
- *
- * @return The number of bytes written.  -1 on error (errno is set).
+ * Make sure a given Observation's spilled history holds the same data type as its buffer.
+ * If the buffer is empty, it takes on the history's data type, so the history can be read.
+ * Otherwise, a history of another type is deleted, like the buffer is when its type changes.
  */
 //--------------------------------------------------------------------------------------------------
-static ssize_t WriteToFd
+static void CheckSpilledType
 (
-    int fd,
-    const void* buffPtr,
-    size_t byteCount
+    Observation_t* obsPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    ssize_t result;
-
-    LE_ASSERT(buffPtr != NULL);
-
-    do
+    le_dls_Link_t* linkPtr = le_dls_PeekTail(&obsPtr->spillList);
+    if (linkPtr == NULL)
     {
-        result = write(fd, buffPtr, byteCount);
+        return;
+    }
 
-    } while ((result == -1) && (errno == EINTR));
+    io_DataType_t dataType = CONTAINER_OF(linkPtr, SpillSegment_t, link)->dataType;
 
-    return result;
+    if (obsPtr->count == 0)
+    {
+        obsPtr->bufferedType = dataType;
+    }
+    else if (obsPtr->bufferedType != dataType)
+    {
+        DeleteSpillSegments(obsPtr);
+    }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Continue a read operation.
+ * Stop reading an Observation's spilled history, releasing the segment being read.
  */
 //--------------------------------------------------------------------------------------------------
-static void ContinueReadOp
+static void CloseSpillCursor
 (
-    ReadOperation_t* opPtr
+    SpillCursor_t* cursorPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    ssize_t result;
-    for (;;)
+    if (cursorPtr->fd != -1)
     {
-        const char* writeBuffPtr = NULL;
-        size_t writeLen = 0;
-
-        // Figure out what to write based on the state.
-        switch (opPtr->state)
-        {
-            case START:
-
-                writeBuffPtr = "[";
-                writeLen = 1;
-
-                break;
-
-            case SAMPLE:
+        close(cursorPtr->fd);
+        cursorPtr->fd = -1;
+    }
 
-                writeBuffPtr = opPtr->writeBuffer + opPtr->writeOffset;
-                writeLen = opPtr->writeLen - opPtr->writeOffset;
+    if (cursorPtr->segPtr != NULL)
+    {
+        le_mem_Release(cursorPtr->segPtr);
+        cursorPtr->segPtr = NULL;
+    }
 
-                break;
+    cursorPtr->loadedCount = 0;
+    cursorPtr->loadedIndex = 0;
+}
 
-            case COMMA:
 
-                writeBuffPtr = ",";
-                writeLen = 1;
+//--------------------------------------------------------------------------------------------------
+/**
+ * Buffer Entry destructor.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BufferEntryDestructor
+(
+    void* objectPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    BufferEntry_t* buffEntryPtr = objectPtr;
 
-                break;
+    le_mem_Release(buffEntryPtr->sampleRef);
+}
 
-            case END:
 
-                writeBuffPtr = "]";
-                writeLen = 1;
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a given Observation's buffer uses ring storage (inline records in Sample Blocks)
+ * rather than a list of Buffer Entries.  This depends on the type of the buffered data.
+ *
+ * @return true if ring storage is used.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsRingStorage
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (   (obsPtr->bufferedType == IO_DATA_TYPE_TRIGGER)
+            || (obsPtr->bufferedType == IO_DATA_TYPE_BOOLEAN)
+            || (obsPtr->bufferedType == IO_DATA_TYPE_NUMERIC)  );
+}
 
-                break;
-        }
 
-        // Write and check for errors.
-        result = WriteToFd(opPtr->fd, writeBuffPtr, writeLen);
-        if (result == -1)
-        {
-            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
-            {
-                // Return and wait for this function to be called again by the FD Monitor.
-                return;
-            }
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a buffer position refers to a sample.
+ *
+ * @return true if it does.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsValidBufferPos
+(
+    const BufferPos_t* posPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return ((posPtr->entryPtr != NULL) || (posPtr->blockPtr != NULL));
+}
 
-            LE_ERROR("Error writing (%m).");
-            EndRead(opPtr, LE_COMM_ERROR);
 
-            return;
-        }
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take a hold on the sample at a given buffer position, so that the position stays usable after
+ * control returns to the event loop.  Only Buffer Entries need to be held; ring storage records
+ * are checked using their sequence numbers instead (see IsStillBuffered()).
+ */
+//--------------------------------------------------------------------------------------------------
+static void HoldBufferPos
+(
+    BufferPos_t* posPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (posPtr->entryPtr != NULL)
+    {
+        le_mem_AddRef(posPtr->entryPtr);
+    }
+}
 
-        // Advance to the next state.
-        switch (opPtr->state)
-        {
-            case START:
 
-                // If there's a sample in the write buffer,
-                if (opPtr->writeLen > 0)
-                {
-                    opPtr->state = SAMPLE;
-                }
-                else
-                {
-                    opPtr->state = END;
-                }
-                break;
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a hold on a buffer position taken using HoldBufferPos(), and clear the position.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReleaseBufferPos
+(
+    BufferPos_t* posPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (posPtr->entryPtr != NULL)
+    {
+        le_mem_Release(posPtr->entryPtr);
+    }
 
-            case SAMPLE:
+    posPtr->entryPtr = NULL;
+    posPtr->blockPtr = NULL;
+}
 
-                // Update the write offset.
-                opPtr->writeOffset += result;
 
-                // If the write buffer has been written entirely,
-                if (opPtr->writeOffset == opPtr->writeLen)
-                {
-                    // Try to load the next sample into the write buffer.
-                    if (LoadReadOpBuffer(opPtr))
-                    {
-                        opPtr->state = COMMA;
-                    }
-                    else
-                    {
-                        opPtr->state = END;
-                    }
-                }
-                // Note: If the write buffer has not been written entirely, stay in the SAMPLE
-                // state and loop back around to write more.
-                break;
+//--------------------------------------------------------------------------------------------------
+/**
+ * Empty a monotonic deque, releasing all its blocks.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ClearDeque
+(
+    MonoDeque_t* dequePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr;
+    while (NULL != (linkPtr = le_dls_Pop(&dequePtr->blockList)))
+    {
+        le_mem_Release(CONTAINER_OF(linkPtr, DequeBlock_t, link));
+    }
 
-            case COMMA:
+    dequePtr->headIndex = 0;
+    dequePtr->tailIndex = 0;
+    dequePtr->count = 0;
+}
 
-                opPtr->state = SAMPLE;
-                break;
 
-            case END:
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the first block of a non-empty monotonic deque.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline DequeBlock_t* GetDequeFrontBlock
+(
+    MonoDeque_t* dequePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return CONTAINER_OF(le_dls_Peek(&dequePtr->blockList), DequeBlock_t, link);
+}
 
-                EndRead(opPtr, LE_OK);
 
-                return;
-        }
-    }
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the last block of a non-empty monotonic deque.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline DequeBlock_t* GetDequeBackBlock
+(
+    MonoDeque_t* dequePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return CONTAINER_OF(le_dls_PeekTail(&dequePtr->blockList), DequeBlock_t, link);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Event handler call-back for events on a read operation's write file descriptor.
+ * Pop the back (newest) entry off a non-empty monotonic deque.
  */
 //--------------------------------------------------------------------------------------------------
-static void ReadOpFdEventHandler
+static void PopDequeBack
 (
-    int fd,
-    short events
+    MonoDeque_t* dequePtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    LE_UNUSED(fd);
-
-    ReadOperation_t* opPtr = le_fdMonitor_GetContextPtr();
+    (dequePtr->count)--;
+    (dequePtr->tailIndex)--;
 
-    // Check for error or hang-up.
-    if ((events & POLLERR) || (events & POLLHUP) || (events & POLLRDHUP))
+    if (dequePtr->count == 0)
     {
-        LE_ERROR("Error or hang-up on output stream.");
-        EndRead(opPtr, LE_COMM_ERROR);
+        ClearDeque(dequePtr);
     }
-    // Note: The only other reason for this function to be called is POLLOUT (writeable).
-    else
+    else if (dequePtr->tailIndex == 0)
     {
-        ContinueReadOp(opPtr);
+        // The last block is empty.  The block before it is full (up to the end of the block).
+        le_mem_Release(CONTAINER_OF(le_dls_PopTail(&dequePtr->blockList), DequeBlock_t, link));
+        dequePtr->tailIndex = SAMPLE_BLOCK_RECORDS;
     }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Start a read operation on a given Observation's buffer.
+ * Pop the front (oldest) entry off a non-empty monotonic deque.
  */
 //--------------------------------------------------------------------------------------------------
-static void StartRead
+static void PopDequeFront
 (
-    Observation_t* obsPtr,
-    BufferEntry_t* startPtr, ///< Ptr to buffer entry to start at, or NULL if read data set empty.
-    int outputFile, ///< File descriptor to write the data to.
-    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
-    void* contextPtr    ///< Value to be passed to completion callback.
+    MonoDeque_t* dequePtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // Set the fd non-blocking
-    if (0 != fcntl(outputFile, F_SETFL, O_NONBLOCK))
-    {
-        LE_ERROR("Failed to activate non-blocking mode (%m).");
-        handlerPtr(LE_COMM_ERROR, contextPtr);
-        return;
-    }
+    (dequePtr->count)--;
+    (dequePtr->headIndex)++;
 
-    ReadOperation_t* opPtr = hub_MemAlloc(ReadOperationPool);
-    if (opPtr == NULL)
+    if (dequePtr->count == 0)
     {
-        LE_ERROR("Failed to allocate a read operation");
-        handlerPtr(LE_NO_MEMORY, contextPtr);
-        return;
+        ClearDeque(dequePtr);
     }
-    opPtr->link = LE_DLS_LINK_INIT;
-    le_dls_Queue(&obsPtr->readOpList, &opPtr->link);
-
-    opPtr->obsPtr = obsPtr;
-
-    opPtr->fdMonitor = le_fdMonitor_Create("Read", outputFile, ReadOpFdEventHandler, POLLOUT);
-    le_fdMonitor_SetContextPtr(opPtr->fdMonitor, opPtr);
-    opPtr->fd = outputFile;
-    opPtr->nextEntryPtr = startPtr;
-    // We hold a ref count on the buffer entry to prevent it from being released.
-    if (startPtr != NULL)
+    else if (dequePtr->headIndex == SAMPLE_BLOCK_RECORDS)
     {
-        le_mem_AddRef(startPtr);
+        le_mem_Release(CONTAINER_OF(le_dls_Pop(&dequePtr->blockList), DequeBlock_t, link));
+        dequePtr->headIndex = 0;
     }
-    opPtr->handlerPtr = handlerPtr;
-    opPtr->contextPtr = contextPtr;
-
-    opPtr->state = START;
-    (void)LoadReadOpBuffer(opPtr);
-
-    ContinueReadOp(opPtr);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Adds a given data sample to the buffer of a given Observation.
+ * Push a new record onto the back of a monotonic deque, first popping all entries that can no
+ * longer become the extreme value.  For a minimum deque, that is every entry with a value greater
+ * than or equal to the new one.  For a maximum deque, it is every entry less than or equal to it.
  *
- * @return
- *      - LE_OK If datasample was added to observation buffer successfully.
- *      - LE_NO_MEMORY If failed to allocate memory for the new datasample in Buffer Pool.
- *      - LE_BAD_PARAMETER If dropped sample because its timestamp was older than the sample already
- *           in buffer.
+ * If a deque block can't be allocated, the deque is disabled, and queries fall back to scanning
+ * the buffer.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AddToBuffer
+static void PushDequeBack
 (
-    Observation_t* obsPtr,
-    dataSample_Ref_t sampleRef
+    MonoDeque_t* dequePtr,
+    bool isMin,     ///< true for a minimum deque, false for a maximum deque.
+    uint64_t seq,
+    double value
 )
 //--------------------------------------------------------------------------------------------------
 {
-    BufferEntry_t* buffEntryPtr;
+    while (dequePtr->count > 0)
+    {
+        double backValue = GetDequeBackBlock(dequePtr)->values[dequePtr->tailIndex - 1];
 
-    // If the new sample is timestamped older than the newest sample already in the buffer,
-    // then we have a serious problem, because buffer traversal operations could get stuck in loops.
-    le_sls_Link_t* linkPtr = le_sls_PeekTail(&obsPtr->sampleList);
-    if (linkPtr != NULL)
-    {
-        buffEntryPtr = CONTAINER_OF(linkPtr, BufferEntry_t, link);
+        if (isMin ? (backValue < value) : (backValue > value))
+        {
+            break;
+        }
 
-        double oldEntryTimestamp = dataSample_GetTimestamp(buffEntryPtr->sampleRef);
-        double newEntryTimestamp = dataSample_GetTimestamp(sampleRef);
+        PopDequeBack(dequePtr);
+    }
 
-        if (oldEntryTimestamp > newEntryTimestamp)
+    if ((dequePtr->count == 0) || (dequePtr->tailIndex == SAMPLE_BLOCK_RECORDS))
+    {
+        DequeBlock_t* blockPtr = hub_MemAlloc(DequeBlockPool);
+        if (blockPtr == NULL)
         {
-            LE_ERROR("New sample has older timestamp than (older) sample already in the buffer!");
-            LE_ERROR("Dropping new sample timestamped %lf (< %lf in buffer)!",
-                     newEntryTimestamp,
-                     oldEntryTimestamp);
-            return LE_BAD_PARAMETER;
+            LE_ERROR("Failed to allocate a deque block. Disabling incremental %s.",
+                     isMin ? "minimum" : "maximum");
+            ClearDeque(dequePtr);
+            dequePtr->isEnabled = false;
+            return;
+        }
+        blockPtr->link = LE_DLS_LINK_INIT;
+        le_dls_Queue(&dequePtr->blockList, &blockPtr->link);
+
+        if (dequePtr->count == 0)
+        {
+            dequePtr->headIndex = 0;
         }
+        dequePtr->tailIndex = 0;
     }
 
-    buffEntryPtr = hub_MemAlloc(BufferEntryPool);
-    if (buffEntryPtr)
-    {
-        le_mem_AddRef(sampleRef);
-        buffEntryPtr->sampleRef = sampleRef;
-        buffEntryPtr->link = LE_SLS_LINK_INIT;
-        le_sls_Queue(&obsPtr->sampleList, &buffEntryPtr->link);
+    DequeBlock_t* blockPtr = GetDequeBackBlock(dequePtr);
+    blockPtr->seq[dequePtr->tailIndex] = seq;
+    blockPtr->values[dequePtr->tailIndex] = value;
+    (dequePtr->tailIndex)++;
+    (dequePtr->count)++;
+}
 
-        (obsPtr->count)++;
-        return LE_OK;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a record that is being dropped from the front of the buffer from a monotonic deque.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveFromDeque
+(
+    MonoDeque_t* dequePtr,
+    uint64_t seq
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (   (dequePtr->count > 0)
+        && (GetDequeFrontBlock(dequePtr)->seq[dequePtr->headIndex] == seq))
+    {
+        PopDequeFront(dequePtr);
     }
-    else
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the extreme value tracked by a monotonic deque.
+ *
+ * @return The value, or NAN if the deque is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetDequeFront
+(
+    MonoDeque_t* dequePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (dequePtr->count == 0)
     {
-        LE_ERROR("Failed to allocate a buffer entry");
-        return LE_NO_MEMORY;
+        return NAN;
     }
+
+    return GetDequeFrontBlock(dequePtr)->values[dequePtr->headIndex];
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * If the number of entries in a given Observation's buffer is larger than the number given,
- * discard enough of the oldest entries to correct that condition.
+ * Reset the running aggregates of a given Observation.  Enabled deques stay enabled.
  */
 //--------------------------------------------------------------------------------------------------
-static void TruncateBuffer
+static void ResetAggregates
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Aggregates_t* aggPtr = &obsPtr->aggregates;
+
+    aggPtr->count = 0;
+    aggPtr->mean = 0;
+    aggPtr->m2 = 0;
+
+    ClearDeque(&aggPtr->minDeque);
+    ClearDeque(&aggPtr->maxDeque);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Update the running aggregates of a given Observation for a record added to its ring storage.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddToAggregates
 (
     Observation_t* obsPtr,
-    size_t count
+    uint64_t seq,
+    double value
 )
 //--------------------------------------------------------------------------------------------------
 {
-    while (obsPtr->count > count)
+    Aggregates_t* aggPtr = &obsPtr->aggregates;
+
+    if (isnan(value))
     {
-        le_sls_Link_t* linkPtr = le_sls_Pop(&obsPtr->sampleList);
-        LE_ASSERT(linkPtr != NULL);
+        return;
+    }
 
-        le_mem_Release(CONTAINER_OF(linkPtr, BufferEntry_t, link));
+    (aggPtr->count)++;
+    double delta = value - aggPtr->mean;
+    aggPtr->mean += delta / aggPtr->count;
+    aggPtr->m2 += delta * (value - aggPtr->mean);
 
-        (obsPtr->count)--;
+    if (aggPtr->minDeque.isEnabled)
+    {
+        PushDequeBack(&aggPtr->minDeque, true, seq, value);
+    }
+    if (aggPtr->maxDeque.isEnabled)
+    {
+        PushDequeBack(&aggPtr->maxDeque, false, seq, value);
     }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Update the value of a data sample by replacing it, if necessary
- *
- * Note: Even though this function uses dataSample_CreateBoolean and dataSample-CreateNumberic which
- * may return NULL if dataSample pool is exhusted, because the previous sample is always released
- * first before calling the createSample function, it is expected that creating sample is always
- * successful.
- *
- * @return
- *      Pointer to the updated sample.
+ * Update the running aggregates of a given Observation for the oldest record being dropped from
+ * its ring storage.
  */
 //--------------------------------------------------------------------------------------------------
-static dataSample_Ref_t UpdateSample
+static void RemoveFromAggregates
 (
-    dataSample_Ref_t sampleRef,
-    io_DataType_t dataType,
-    void *valuePtr
+    Observation_t* obsPtr,
+    uint64_t seq,
+    double value
 )
 //--------------------------------------------------------------------------------------------------
 {
-    dataSample_Ref_t sample = sampleRef;
-    double timestamp = dataSample_GetTimestamp(sampleRef);
+    Aggregates_t* aggPtr = &obsPtr->aggregates;
 
+    if (isnan(value) || (aggPtr->count == 0))
+    {
+        return;
+    }
 
-    switch (dataType)
+    (aggPtr->count)--;
+    if (aggPtr->count == 0)
     {
-        case IO_DATA_TYPE_BOOLEAN:
-        {
-            bool value = *((double *)valuePtr) > 0.0 ? true : false;
-            if (dataSample_GetBoolean(sampleRef) != value)
-            {
-                le_mem_Release(sampleRef);
-                sample = dataSample_CreateBoolean(timestamp, value);
-            }
-            break;
-        }
+        aggPtr->mean = 0;
+        aggPtr->m2 = 0;
+    }
+    else
+    {
+        double delta = value - aggPtr->mean;
+        aggPtr->mean -= delta / aggPtr->count;
+        aggPtr->m2 -= delta * (value - aggPtr->mean);
 
-        case IO_DATA_TYPE_NUMERIC:
+        // Guard against rounding errors accumulating below zero.
+        if (aggPtr->m2 < 0)
         {
-            double value = *((double *)valuePtr);
-            if (dataSample_GetNumeric(sampleRef) != value)
-            {
-                le_mem_Release(sampleRef);
-                sample = dataSample_CreateNumeric(timestamp, value);
-            }
+            aggPtr->m2 = 0;
         }
-
-        default:
-            break;
     }
 
-    if (!sample)
-    {
-        LE_FATAL("UpdateSample Failed to allocate a new sample");
-    }
-    return sample;
+    RemoveFromDeque(&aggPtr->minDeque, seq);
+    RemoveFromDeque(&aggPtr->maxDeque, seq);
 }
 
 
-#if LE_CONFIG_FILESYSTEM
 //--------------------------------------------------------------------------------------------------
 /**
- * Writes a buffer load of data to a buffered file stream.
- *
- * On error, logs an error message and closes the file.
+ * Check whether the running aggregates can be used to answer a query on a given Observation.
+ * They cover the whole buffer, so they can only be used if no start time was given.
  *
- * @return true if successful, false if failed.
+ * @return true if they can.
  */
 //--------------------------------------------------------------------------------------------------
-static bool WriteToStream
+static inline bool CanUseAggregates
 (
-    FILE* file,
-    const void* buffPtr,
-    size_t buffSize
+    Observation_t* obsPtr,
+    double startTime
 )
 //--------------------------------------------------------------------------------------------------
 {
-    size_t recordsWritten = fwrite(buffPtr, buffSize, 1, file);
-    if (recordsWritten != 1)
+    return (isnan(startTime) && IsRingStorage(obsPtr));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a block of ring storage.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReleaseRingBlock
+(
+    RingBlock_t* blockPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (DecodedBlock.blockPtr == blockPtr)
     {
-        LE_CRIT("Failed to write (%m).");
-        le_atomFile_CancelStream(file);
-        return false;
+        DecodedBlock.blockPtr = NULL;
     }
-    return true;
+
+    le_mem_Release(blockPtr);
 }
 
 
+#ifdef DHUB_COMPRESSED_BUFFERS
 //--------------------------------------------------------------------------------------------------
 /**
- * Reads a buffer load of data from a backup file.
- *
- * On error, logs an error message and closes the file.
+ * Stream of bits being written to (most significant bit first) or read from.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint8_t* bytesPtr;      ///< Bytes holding the bits.
+    size_t bitCount;        ///< Number of bits that fit into the bytes.
+    size_t bitPos;          ///< Position of the next bit to write or read.
+}
+BitStream_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the low bits of a value to a bit stream.
  *
- * @return LE_OK if successful, LE_UNDERFLOW if the end of file was reached, LE_FAULT if failed.
+ * @return true if successful, false if the bits don't fit.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t ReadFromFile
+static bool WriteBits
 (
-    void* buffPtr,
-    size_t buffSize,
-    FILE* file
+    BitStream_t* streamPtr,
+    uint64_t value,
+    unsigned int count      ///< Number of bits to write (up to 64).
 )
 //--------------------------------------------------------------------------------------------------
 {
-    size_t bytesRead = fread(buffPtr, 1, buffSize, file);
-
-    le_result_t result = LE_OK;
+    if ((streamPtr->bitCount - streamPtr->bitPos) < count)
+    {
+        return false;
+    }
 
-    if (bytesRead < buffSize)
+    while (count > 0)
     {
-        if (feof(file))
+        count--;
+
+        uint8_t mask = (uint8_t)(0x80 >> (streamPtr->bitPos % 8));
+        uint8_t* bytePtr = &streamPtr->bytesPtr[streamPtr->bitPos / 8];
+
+        if ((value >> count) & 1)
         {
-            result = LE_UNDERFLOW;
+            *bytePtr |= mask;
         }
         else
         {
-            LE_CRIT("Failed to read (%m).");
-            result = LE_FAULT;
+            *bytePtr &= ~mask;
         }
 
-        le_atomFile_CancelStream(file);
+        streamPtr->bitPos++;
     }
 
-    return result;
+    return true;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Gets the data type code byte to be written into a backup file.
+ * Read bits from a bit stream.
  *
- * @return the data type code byte.
+ * @return The bits read (in the low bits).
  */
 //--------------------------------------------------------------------------------------------------
-static uint8_t GetDataTypeCode
+static uint64_t ReadBits
 (
-    Observation_t* obsPtr
+    BitStream_t* streamPtr,
+    unsigned int count      ///< Number of bits to read (up to 64).
 )
 //--------------------------------------------------------------------------------------------------
 {
-    switch (res_GetDataType(&obsPtr->resource))
+    uint64_t value = 0;
+
+    for (; count > 0; count--)
     {
-        case IO_DATA_TYPE_TRIGGER:  return 't';
-        case IO_DATA_TYPE_BOOLEAN:  return 'b';
-        case IO_DATA_TYPE_NUMERIC:  return 'n';
-        case IO_DATA_TYPE_STRING:   return 's';
-        case IO_DATA_TYPE_JSON:     return 'j';
+        uint8_t byte = streamPtr->bytesPtr[streamPtr->bitPos / 8];
+
+        value = (value << 1) | ((byte >> (7 - (streamPtr->bitPos % 8))) & 1);
+        streamPtr->bitPos++;
     }
 
-    LE_FATAL("Invalid data type %d.", res_GetDataType(&obsPtr->resource));
+    return value;
 }
 
 
+/// Delta-of-delta encodings of timestamps: number of '1' bits in the prefix (followed by a '0',
+/// except for the last one) and the number of value bits that follow.  A zero delta-of-delta is
+/// encoded as a single '0' bit.
+static const unsigned int DodValueBits[] = { 7, 12, 20, 32, 64 };
+#define DOD_ENCODINGS (sizeof(DodValueBits) / sizeof(DodValueBits[0]))
+
+
 //--------------------------------------------------------------------------------------------------
 /**
- * Gets the data type represented by the code byte read from a backup file.
+ * Check whether a signed value fits in a given number of bits (two's complement).
  *
- * @return true if successful, false on error.
+ * @return true if it fits.
  */
 //--------------------------------------------------------------------------------------------------
-static bool GetDataTypeFromCode
+static inline bool FitsInBits
 (
-    io_DataType_t* dataTypePtr, ///< [OUT] Ptr to where the result will be put on success.
-    uint8_t code
+    int64_t value,
+    unsigned int bitCount   ///< Less than 64.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    switch (code)
-    {
-        case 't': *dataTypePtr = IO_DATA_TYPE_TRIGGER; return true;
-        case 'b': *dataTypePtr = IO_DATA_TYPE_BOOLEAN; return true;
-        case 'n': *dataTypePtr = IO_DATA_TYPE_NUMERIC; return true;
-        case 's': *dataTypePtr = IO_DATA_TYPE_STRING;  return true;
-        case 'j': *dataTypePtr = IO_DATA_TYPE_JSON;    return true;
-    }
-
-    LE_CRIT("Invalid data type code %d.", (int)code);
+    int64_t limit = (int64_t)1 << (bitCount - 1);
 
-    return false;
+    return ((value >= -limit) && (value < limit));
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Writes all the data samples for a given Observation to a given backup file.
+ * Compress the records of a full Sample Block, Gorilla-style:
  *
- * On error, logs an error message and closes the file.
+ *  - The first timestamp and value are stored as they are (64 bits each).
+ *  - The bit patterns of the timestamps are treated as integers, and the difference between
+ *    consecutive deltas (delta-of-delta) is stored with a variable-length prefix code.  The bit
+ *    patterns of doubles of the same magnitude are evenly spaced, so periodic samples mostly
+ *    cost a single bit.
+ *  - Each value is XORed with the previous one.  A zero XOR (same value) is stored as a '0' bit.
+ *    Otherwise the meaningful bits are stored after a '1' bit, followed by either a '0' bit if
+ *    they fit in the window of meaningful bits of the previous value, or a '1' bit and the
+ *    number of leading zeros (5 bits) and meaningful bits (6 bits) of a new window.
  *
- * @return true if successful, false if failed.
+ * This is lossless.
+ *
+ * @return true if the records fit in the given buffer.
  */
 //--------------------------------------------------------------------------------------------------
-static bool WriteSamplesToFile
+static bool EncodeBlock
 (
-    FILE* file,
-    Observation_t* obsPtr
+    const SampleBlock_t* blockPtr,
+    uint8_t* bytesPtr,
+    size_t byteCount
 )
 //--------------------------------------------------------------------------------------------------
 {
-    io_DataType_t dataType = obsPtr->bufferedType;
-
-    BufferEntry_t* buffEntryPtr = GetOldestBufferEntry(obsPtr);
+    BitStream_t stream = { bytesPtr, byteCount * 8, 0 };
+    uint64_t prevTimestamp;
+    uint64_t prevValue;
+    uint64_t prevDelta = 0;
+    unsigned int prevLeading = 0;
+    unsigned int prevTrailing = 0;
+    bool haveWindow = false;
+
+    memcpy(&prevTimestamp, &blockPtr->timestamps[0], sizeof(prevTimestamp));
+    memcpy(&prevValue, &blockPtr->values[0], sizeof(prevValue));
+
+    if (!WriteBits(&stream, prevTimestamp, 64) || !WriteBits(&stream, prevValue, 64))
+    {
+        return false;
+    }
 
-    while (buffEntryPtr != NULL)
+    for (size_t i = 1; i < SAMPLE_BLOCK_RECORDS; i++)
     {
-        // Write the timestamp.
-        double timestamp = dataSample_GetTimestamp(buffEntryPtr->sampleRef);
-        if (!WriteToStream(file, &timestamp, sizeof(timestamp)))
+        uint64_t timestamp;
+        uint64_t value;
+        memcpy(&timestamp, &blockPtr->timestamps[i], sizeof(timestamp));
+        memcpy(&value, &blockPtr->values[i], sizeof(value));
+
+        // Timestamp.
+        uint64_t delta = timestamp - prevTimestamp;
+        int64_t dod = (int64_t)(delta - prevDelta);
+        bool ok;
+
+        if (dod == 0)
         {
-            return false;
+            ok = WriteBits(&stream, 0, 1);
         }
-
-        switch (dataType)
+        else
         {
-            case IO_DATA_TYPE_TRIGGER:
-
-                // No Value.
-                break;
-
-            case IO_DATA_TYPE_BOOLEAN:
+            size_t encoding = 0;
+            while (   (encoding < (DOD_ENCODINGS - 1))
+                   && !FitsInBits(dod, DodValueBits[encoding]))
             {
-                bool value = dataSample_GetBoolean(buffEntryPtr->sampleRef);
-                if (!WriteToStream(file, &value, sizeof(value)))
-                {
-                    return false;
-                }
-                break;
+                encoding++;
             }
-            case IO_DATA_TYPE_NUMERIC:
+
+            // The prefix is encoding + 1 '1' bits, then a '0' unless it's the longest one.
+            unsigned int prefixLen = encoding + 1;
+            uint64_t prefix = ((uint64_t)1 << prefixLen) - 1;
+            if (encoding < (DOD_ENCODINGS - 1))
             {
-                double value = dataSample_GetNumeric(buffEntryPtr->sampleRef);
-                if (!WriteToStream(file, &value, sizeof(value)))
-                {
-                    return false;
-                }
-                break;
+                prefix <<= 1;
+                prefixLen++;
             }
-            case IO_DATA_TYPE_STRING:
-            {
-                const char* valuePtr = dataSample_GetString(buffEntryPtr->sampleRef);
-                uint32_t stringLen = strlen(valuePtr);
-                if (!WriteToStream(file, &stringLen, 4))
-                {
-                    return false;
-                }
-                if (!WriteToStream(file, valuePtr, stringLen))
-                {
-                    return false;
-                }
-                break;
+
+            unsigned int valueBits = DodValueBits[encoding];
+            uint64_t mask = (valueBits == 64) ? UINT64_MAX : (((uint64_t)1 << valueBits) - 1);
+
+            ok =    WriteBits(&stream, prefix, prefixLen)
+                 && WriteBits(&stream, (uint64_t)dod & mask, valueBits);
+        }
+
+        prevTimestamp = timestamp;
+        prevDelta = delta;
+
+        // Value.
+        uint64_t xor = value ^ prevValue;
+
+        if (!ok)
+        {
+            return false;
+        }
+        else if (xor == 0)
+        {
+            ok = WriteBits(&stream, 0, 1);
+        }
+        else
+        {
+            unsigned int leading = __builtin_clzll(xor);
+            unsigned int trailing = __builtin_ctzll(xor);
+
+            if (leading > 31)
+            {
+                leading = 31;
             }
-            case IO_DATA_TYPE_JSON:
+
+            if (haveWindow && (leading >= prevLeading) && (trailing >= prevTrailing))
             {
-                const char* valuePtr = dataSample_GetJson(buffEntryPtr->sampleRef);
-                uint32_t stringLen = strlen(valuePtr);
-                if (!WriteToStream(file, &stringLen, 4))
-                {
-                    return false;
-                }
-                if (!WriteToStream(file, valuePtr, stringLen))
-                {
-                    return false;
-                }
-                break;
+                unsigned int meaningful = 64 - prevLeading - prevTrailing;
+
+                ok =    WriteBits(&stream, 2, 2)
+                     && WriteBits(&stream, xor >> prevTrailing, meaningful);
+            }
+            else
+            {
+                unsigned int meaningful = 64 - leading - trailing;
+
+                // The number of meaningful bits (1 to 64) is stored minus one.
+                ok =    WriteBits(&stream, 3, 2)
+                     && WriteBits(&stream, leading, 5)
+                     && WriteBits(&stream, meaningful - 1, 6)
+                     && WriteBits(&stream, xor >> trailing, meaningful);
+
+                prevLeading = leading;
+                prevTrailing = trailing;
+                haveWindow = true;
             }
         }
 
-        buffEntryPtr = GetNextBufferEntry(obsPtr, buffEntryPtr);
+        if (!ok)
+        {
+            return false;
+        }
+
+        prevValue = value;
     }
 
     return true;
@@ -1071,324 +1697,4984 @@ static bool WriteSamplesToFile
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Reads all the data samples from a given backup file and adds them to a given Observation's
- * data sample buffer.  Closes the file when done.
+ * Decompress the records of a Compressed Block (see EncodeBlock()).
+ *
+ * @return Ptr to the records (valid until another block is decoded).
  */
 //--------------------------------------------------------------------------------------------------
-static void ReadSamplesFromFile
+static const SampleBlock_t* DecompressBlock
 (
-    Observation_t* obsPtr,
-    FILE* file,
-    size_t count    ///< The expected number of samples to read.
+    const CompressedBlock_t* blockPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (count == 0)
+    SampleBlock_t* recordsPtr = &DecodedBlock.records;
+
+    if (DecodedBlock.blockPtr == &blockPtr->header)
     {
-        return;
+        return recordsPtr;
     }
 
-    io_DataType_t dataType = obsPtr->bufferedType;
+    BitStream_t stream = { (uint8_t*)blockPtr->bytes, sizeof(blockPtr->bytes) * 8, 0 };
+    uint64_t timestamp = ReadBits(&stream, 64);
+    uint64_t value = ReadBits(&stream, 64);
+    uint64_t delta = 0;
+    unsigned int leading = 0;
+    unsigned int trailing = 0;
 
-    dataSample_Ref_t dataSample = NULL;
+    memcpy(&recordsPtr->timestamps[0], &timestamp, sizeof(timestamp));
+    memcpy(&recordsPtr->values[0], &value, sizeof(value));
 
-    for (;;)
+    for (size_t i = 1; i < SAMPLE_BLOCK_RECORDS; i++)
     {
-        // Read the timestamp.
-        double timestamp;
-        le_result_t result = ReadFromFile(&timestamp, sizeof(timestamp), file);
-        if (result != LE_OK)
-        {
-            if (result == LE_UNDERFLOW)
-            {
-                // End of file reached, check that we've received all we should.
-                if (count == 0)
-                {
-                    // The file contained exactly the number of samples we expected.
-                    // The last data sample read from the file (which is the newest)
-                    // should be pushed to the Observation so it becomes the current value.
-                    res_Push(&obsPtr->resource, dataType, "", dataSample);
-                    return;
-                }
-                else
-                {
-                    LE_CRIT("Backup file was truncated. Expected %zu more samples.", count);
-                }
-            }
-
-            goto error;
-        }
-
-        // We succeeded in reading another timestamp, so we had better be expecting more samples.
-        if (count == 0)
+        // Timestamp.
+        size_t encoding = 0;
+        while ((encoding < DOD_ENCODINGS) && (ReadBits(&stream, 1) == 1))
         {
-            LE_CRIT("Backup file contains extra samples.");
-            le_atomFile_CancelStream(file);
-            goto error;
+            encoding++;
         }
 
-        count--;
-
-        switch (dataType)
+        if (encoding > 0)
         {
-            case IO_DATA_TYPE_TRIGGER:
-
-                // No Value.
-                dataSample = dataSample_CreateTrigger(timestamp);
-                break;
+            unsigned int valueBits = DodValueBits[encoding - 1];
+            uint64_t dod = ReadBits(&stream, valueBits);
 
-            case IO_DATA_TYPE_BOOLEAN:
-            {
-                bool value;
-                if (ReadFromFile(&value, sizeof(value), file) != LE_OK)
-                {
-                    LE_CRIT("Failed to read boolean value.");
-                    goto error;
-                }
-                dataSample = dataSample_CreateBoolean(timestamp, value);
-                break;
-            }
-            case IO_DATA_TYPE_NUMERIC:
-            {
-                double value;
-                if (ReadFromFile(&value, sizeof(value), file) != LE_OK)
-                {
-                    LE_CRIT("Failed to read numeric value.");
-                    goto error;
-                }
-                dataSample = dataSample_CreateNumeric(timestamp, value);
-                break;
-            }
-            case IO_DATA_TYPE_STRING:
+            // Sign-extend.
+            if ((valueBits < 64) && ((dod >> (valueBits - 1)) & 1))
             {
-                char value[HUB_MAX_STRING_BYTES];
-
-                uint32_t stringLen;
-                if (ReadFromFile(&stringLen, 4, file) != LE_OK)
-                {
-                    LE_CRIT("Failed to read string length.");
-                    goto error;
-                }
-                if (stringLen > (sizeof(value) - 1))
-                {
-                    LE_CRIT("String length (%zu) is larger than permitted (%zu).",
-                            (size_t)stringLen,
-                            sizeof(value) - 1);
-                    le_atomFile_CancelStream(file);
-                    goto error;
-                }
-                if (ReadFromFile(value, stringLen, file) != LE_OK)
-                {
-                    LE_CRIT("Failed to read string value of length %zu.", (size_t)stringLen);
-                    goto error;
-                }
-                value[stringLen] = '\0';
-                dataSample = dataSample_CreateString(timestamp, value);
-                break;
+                dod |= UINT64_MAX << valueBits;
             }
-            case IO_DATA_TYPE_JSON:
-            {
-                char value[HUB_MAX_STRING_BYTES];
 
-                uint32_t stringLen;
-                if (ReadFromFile(&stringLen, 4, file) != LE_OK)
-                {
-                    LE_CRIT("Failed to read JSON object length.");
-                    goto error;
-                }
-                if (stringLen > (sizeof(value) - 1))
-                {
-                    LE_CRIT("JSON string length (%zu) is larger than permitted (%zu).",
-                            (size_t)stringLen,
-                            sizeof(value) - 1);
-                    le_atomFile_CancelStream(file);
-                    goto error;
-                }
-                if (ReadFromFile(value, stringLen, file) != LE_OK)
-                {
-                    LE_CRIT("Failed to read JSON value of length %zu.", (size_t)stringLen);
-                    goto error;
-                }
-                value[stringLen] = '\0';
-                dataSample = dataSample_CreateJson(timestamp, value);
-                break;
-            }
+            delta += dod;
         }
 
-        // Add the sample to the buffer, unless this is the last (newest) sample, in which case
-        // we will push it to the Observation later when we confirm that the file doesn't have
-        // more than expected in it (which would mean that all these samples are probably corrupt
-        // and need to be discarded).
-        if (count != 0 && dataSample)
+        timestamp += delta;
+
+        // Value.
+        if (ReadBits(&stream, 1) == 1)
         {
-            if (AddToBuffer(obsPtr, dataSample) != LE_OK)
+            if (ReadBits(&stream, 1) == 1)
             {
-                goto error;
+                leading = (unsigned int)ReadBits(&stream, 5);
+                trailing = 64 - leading - ((unsigned int)ReadBits(&stream, 6) + 1);
             }
+
+            value ^= ReadBits(&stream, 64 - leading - trailing) << trailing;
         }
-        else if (!dataSample)
-        {
-            // Failed to allocate a data sample and therefore cannot proceed with read.
-            LE_ERROR("Failed to allocate dataSample for value read from file");
-            goto error;
-        }
+
+        memcpy(&recordsPtr->timestamps[i], &timestamp, sizeof(timestamp));
+        memcpy(&recordsPtr->values[i], &value, sizeof(value));
     }
 
-error:
+    DecodedBlock.blockPtr = &blockPtr->header;
 
-    // On error, dump the buffer contents in case we read some corrupted samples from the file.
-    TruncateBuffer(obsPtr, 0);
+    return recordsPtr;
 }
-#endif /* end LE_CONFIG_FILESYSTEM */
+#endif
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Perform a backup to non-volatile storage of an observation's data sample buffer.
+ * Point a buffer position that refers to a record in a given block at the same record in another
+ * block.
  */
 //--------------------------------------------------------------------------------------------------
-static void Backup
+static inline void MoveBufferPos
 (
-    Observation_t* obsPtr
+    BufferPos_t* posPtr,
+    const RingBlock_t* oldBlockPtr,
+    RingBlock_t* newBlockPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // If the backup timer exists, delete it.
-    if (obsPtr->backupTimer != NULL)
+    if (posPtr->blockPtr == oldBlockPtr)
     {
-        le_timer_Delete(obsPtr->backupTimer);
-        obsPtr->backupTimer = NULL;
+        posPtr->blockPtr = newBlockPtr;
     }
+}
 
-    // Update the time of last backup.
-    le_clk_Time_t now = le_clk_GetRelativeTime();
-    obsPtr->lastBackupTime = now.sec;
 
-#if LE_CONFIG_FILESYSTEM
-    // Get the backup file path.
-    char path[MAX_BACKUP_FILE_PATH_BYTES];
-    if (GetBackupFilePath(path, sizeof(path), obsPtr) != LE_OK)
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the offset of a timestamp from the base time of a Compact Block, to the nearest
+ * millisecond.
+ *
+ * @return true if successful, false if the timestamp is older than the base time or too far
+ *         after it.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetCompactOffset
+(
+    double baseTime,
+    double timestamp,
+    uint32_t* offsetPtr     ///< [OUT] Milliseconds after baseTime.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    double offset = round((timestamp - baseTime) * 1000);
+
+    if (!(offset >= 0) || (offset > UINT32_MAX))
     {
-        return;
+        return false;
     }
 
-    LE_DEBUG("Backing up to '%s'...", path);
+    *offsetPtr = (uint32_t)offset;
 
-    // Create the backup directory, if it doesn't exist already.
-    struct stat st = {0};
-    if (stat(BACKUP_DIR, &st) == -1)
-    {
-        LE_DEBUG("Creating directory '" BACKUP_DIR "'.");
+    return true;
+}
 
-        if (mkdir(BACKUP_DIR, 0700) == -1)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the timestamp of a Compact Block record from its offset.  Timestamps are rounded with this
+ * as they are added to a compact buffer, so decoding gives back exactly the same doubles.
+ *
+ * @return The timestamp.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline double GetCompactTimestamp
+(
+    double baseTime,
+    uint32_t offset         ///< Milliseconds after baseTime.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return baseTime + ((double)offset / 1000);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode the records of a Compact Block (see CompactBlock()).
+ *
+ * @return Ptr to the records (valid until another block is decoded).
+ */
+//--------------------------------------------------------------------------------------------------
+static const SampleBlock_t* DecodeCompactBlock
+(
+    const CompactBlock_t* blockPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    SampleBlock_t* recordsPtr = &DecodedBlock.records;
+
+    if (DecodedBlock.blockPtr != &blockPtr->header)
+    {
+        for (size_t i = 0; i < SAMPLE_BLOCK_RECORDS; i++)
         {
-            LE_CRIT("Unable to create directory '" BACKUP_DIR "' (%m).");
-            return;
+            recordsPtr->timestamps[i] = GetCompactTimestamp(blockPtr->baseTime,
+                                                            blockPtr->timeOffsets[i]);
+            recordsPtr->values[i] = blockPtr->values[i];
         }
+
+        DecodedBlock.blockPtr = &blockPtr->header;
     }
 
-    // Open the file for writing, truncating it to zero length to start.
-    le_result_t result;
-    FILE* file = le_atomFile_CreateStream(path,
-                                          LE_FLOCK_WRITE,
-                                          LE_FLOCK_REPLACE_IF_EXIST,
-                                          0600,
-                                          &result);
-    if (result != LE_OK)
+    return recordsPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the records of a block of ring storage, decoding them if necessary.
+ *
+ * @warning The records of a Compressed or Compact Block are only valid until another block is
+ *          decoded.
+ *
+ * @return Ptr to the records.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline const SampleBlock_t* GetBlockRecords
+(
+    const RingBlock_t* blockPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+#ifdef DHUB_COMPRESSED_BUFFERS
+    if (blockPtr->format == BLOCK_FORMAT_COMPRESSED)
     {
-        LE_CRIT("Unable to open file '%s' for writing (%s).", path, LE_RESULT_TXT(result));
-        return;
+        return DecompressBlock(CONTAINER_OF(blockPtr, CompressedBlock_t, header));
     }
+#endif
 
-    // Write in the version byte.
-    uint8_t byte = 0;
-    if (!WriteToStream(file, &byte, 1))
+    if (blockPtr->format == BLOCK_FORMAT_COMPACT)
     {
-        return;
+        return DecodeCompactBlock(CONTAINER_OF(blockPtr, CompactBlock_t, header));
+    }
+
+    return CONTAINER_OF(blockPtr, SampleBlock_t, header);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release all the Sample Blocks of a given Observation's ring storage.
+ *
+ * @warning The ring storage must be empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReleaseSampleBlocks
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr;
+    while (NULL != (linkPtr = le_dls_Pop(&obsPtr->blockList)))
+    {
+        ReleaseRingBlock(CONTAINER_OF(linkPtr, RingBlock_t, link));
     }
 
-    // Write the data type code.
-    byte = GetDataTypeCode(obsPtr);
-    if (byte == 0)
-    {
-        le_atomFile_CancelStream(file);
-        return;
-    }
-    if (!WriteToStream(file, &byte, 1))
+    obsPtr->headIndex = 0;
+    obsPtr->tailBlockPtr = NULL;
+    obsPtr->tailIndex = 0;
+
+    const BufferPos_t emptyPos = BUFFER_POS_INIT;
+    obsPtr->searchCursor = emptyPos;
+
+    ResetAggregates(obsPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Terminate a read operation.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EndRead
+(
+    ReadOperation_t* opPtr,
+    le_result_t result
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ReleaseBufferPos(&opPtr->nextPos);
+    ReleaseBufferPos(&opPtr->bucketPos);
+    CloseSpillCursor(&opPtr->history);
+
+    le_fdMonitor_Delete(opPtr->fdMonitor);
+
+    close(opPtr->fd);
+    opPtr->fd = -1;
+
+    if (opPtr->writeBuffer != opPtr->smallBuffer)
+    {
+        le_mem_Release(opPtr->writeBuffer);
+    }
+
+    opPtr->handlerPtr(result, opPtr->contextPtr);
+
+    le_dls_Remove(&opPtr->obsPtr->readOpList, &opPtr->link);
+
+    le_mem_Release(opPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drop a deferred restore of a given Observation's data buffer, if one is pending.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CancelRestore
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (obsPtr->isRestorePending)
+    {
+        obsPtr->isRestorePending = false;
+#ifdef DHUB_LAZY_RESTORE
+        le_dls_Remove(&RestoreQueue, &obsPtr->restoreLink);
+#endif
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Observation destructor.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ObservationDestructor
+(
+    void* objectPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = objectPtr;
+
+    CancelRestore(obsPtr);
+
+    // The backup timer may still expire for this Observation, but won't find it in the queue.
+    if (obsPtr->isBackupScheduled)
+    {
+        le_dls_Remove(&BackupQueue, &obsPtr->backupLink);
+        obsPtr->isBackupScheduled = false;
+    }
+
+    // Delete all the buffered data samples.
+    le_sls_Link_t* linkPtr;
+    while (NULL != (linkPtr = le_sls_Pop(&obsPtr->sampleList)))
+    {
+        BufferEntry_t* buffEntryPtr = CONTAINER_OF(linkPtr, BufferEntry_t, link);
+
+        le_mem_Release(buffEntryPtr);
+    }
+
+    ReleaseSampleBlocks(obsPtr);
+
+    if (obsPtr->scratchSampleRef != NULL)
+    {
+        le_mem_Release(obsPtr->scratchSampleRef);
+        obsPtr->scratchSampleRef = NULL;
+    }
+
+    obsPtr->count = 0;
+    obsPtr->maxCount = 0;
+
+    // If the observation had backups enabled, delete the backup file.
+    if (obsPtr->backupPeriod > 0)
+    {
+        DeleteBackup(obsPtr);
+    }
+
+    DeleteSpillSegments(obsPtr);
+
+    // If there are read operations in progress, end them.
+    while (le_dls_IsEmpty(&obsPtr->readOpList) == false)
+    {
+        EndRead(CONTAINER_OF(le_dls_Peek(&obsPtr->readOpList), ReadOperation_t, link),
+                LE_COMM_ERROR);
+    }
+
+    res_Destruct(&obsPtr->resource);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the position of the first (oldest) sample in an Observation's data sample buffer.
+ *
+ * @return true if successful, false if the buffer is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetOldestBufferEntry
+(
+    Observation_t* obsPtr,
+    BufferPos_t* posPtr         ///< [OUT] Position of the oldest sample.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const BufferPos_t emptyPos = BUFFER_POS_INIT;
+    *posPtr = emptyPos;
+
+    if (IsRingStorage(obsPtr))
+    {
+        if (obsPtr->count == 0)
+        {
+            return false;
+        }
+
+        posPtr->blockPtr = CONTAINER_OF(le_dls_Peek(&obsPtr->blockList), RingBlock_t, link);
+        posPtr->index = obsPtr->headIndex;
+        posPtr->seq = obsPtr->oldestSeq;
+
+        return true;
+    }
+
+    le_sls_Link_t* linkPtr = le_sls_Peek(&obsPtr->sampleList);
+
+    if (linkPtr != NULL)
+    {
+        posPtr->entryPtr = CONTAINER_OF(linkPtr, BufferEntry_t, link);
+        return true;
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Advance a buffer position to the next (newer) sample in an Observation's data sample buffer.
+ *
+ * @warning The position must refer to a sample that is still in the buffer.
+ *
+ * @return true if successful, false if there are no newer samples in the buffer (in which case
+ *         the position is cleared).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetNextBufferEntry
+(
+    Observation_t* obsPtr,
+    BufferPos_t* posPtr         ///< [INOUT] Position to advance.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (posPtr->entryPtr != NULL)
+    {
+        le_sls_Link_t* linkPtr = le_sls_PeekNext(&obsPtr->sampleList, &posPtr->entryPtr->link);
+
+        if (linkPtr != NULL)
+        {
+            posPtr->entryPtr = CONTAINER_OF(linkPtr, BufferEntry_t, link);
+            return true;
+        }
+
+        posPtr->entryPtr = NULL;
+    }
+    else if (posPtr->blockPtr != NULL)
+    {
+        posPtr->seq++;
+
+        if (posPtr->seq < (obsPtr->oldestSeq + obsPtr->count))
+        {
+            posPtr->index++;
+
+            if (posPtr->index == SAMPLE_BLOCK_RECORDS)
+            {
+                le_dls_Link_t* linkPtr = le_dls_PeekNext(&obsPtr->blockList,
+                                                         &posPtr->blockPtr->link);
+                LE_ASSERT(linkPtr != NULL);
+
+                posPtr->blockPtr = CONTAINER_OF(linkPtr, RingBlock_t, link);
+                posPtr->index = 0;
+            }
+
+            return true;
+        }
+
+        posPtr->blockPtr = NULL;
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether the sample at a held buffer position is still in an Observation's buffer.
+ *
+ * A held Buffer Entry's ref count should be 2.  If it is only 1, then we know it has fallen off
+ * the end of the observation's buffer.  A ring storage record has been dropped if its sequence
+ * number is older than the oldest record in the buffer.  Either way, all samples in the
+ * observation's buffer are then newer than this one.
+ *
+ * @return true if the sample is still buffered.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsStillBuffered
+(
+    Observation_t* obsPtr,
+    const BufferPos_t* posPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (posPtr->entryPtr != NULL)
+    {
+        return (le_mem_GetRefCount(posPtr->entryPtr) > 1);
+    }
+
+    return ((posPtr->blockPtr != NULL) && (posPtr->seq >= obsPtr->oldestSeq));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the timestamp of the sample at a given buffer position.
+ *
+ * @return The timestamp.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline double GetBufferedTimestamp
+(
+    const BufferPos_t* posPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (posPtr->entryPtr != NULL)
+    {
+        return dataSample_GetTimestamp(posPtr->entryPtr->sampleRef);
+    }
+
+    return GetBlockRecords(posPtr->blockPtr)->timestamps[posPtr->index];
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get buffered numerical value.  This works for numeric or Boolean types only.
+ *
+ * @return The value.
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetBufferedNumber
+(
+    const BufferPos_t* posPtr,
+    io_DataType_t dataType
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((dataType != IO_DATA_TYPE_NUMERIC) && (dataType != IO_DATA_TYPE_BOOLEAN))
+    {
+        LE_CRIT("Non-numerical data type %d.", dataType);
+        return NAN;
+    }
+
+    if (posPtr->blockPtr != NULL)
+    {
+        return GetBlockRecords(posPtr->blockPtr)->values[posPtr->index];
+    }
+
+    if (dataType == IO_DATA_TYPE_NUMERIC)
+    {
+        return dataSample_GetNumeric(posPtr->entryPtr->sampleRef);
+    }
+    else if (dataSample_GetBoolean(posPtr->entryPtr->sampleRef))
+    {
+        return 1.0;
+    }
+    else
+    {
+        return 0.0;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a Data Sample for the sample at a given buffer position.
+ *
+ * Ring storage doesn't keep Data Sample objects, so one is created from the record.  It is owned
+ * by the Observation and stays valid until the next call to this function for the Observation.
+ *
+ * @return Reference to the sample, or NULL if failed to allocate one.
+ */
+//--------------------------------------------------------------------------------------------------
+static dataSample_Ref_t GetBufferedSample
+(
+    Observation_t* obsPtr,
+    const BufferPos_t* posPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (posPtr->entryPtr != NULL)
+    {
+        return posPtr->entryPtr->sampleRef;
+    }
+
+    if (obsPtr->scratchSampleRef != NULL)
+    {
+        le_mem_Release(obsPtr->scratchSampleRef);
+        obsPtr->scratchSampleRef = NULL;
+    }
+
+    const SampleBlock_t* recordsPtr = GetBlockRecords(posPtr->blockPtr);
+    double timestamp = recordsPtr->timestamps[posPtr->index];
+    double value = recordsPtr->values[posPtr->index];
+
+    switch (obsPtr->bufferedType)
+    {
+        case IO_DATA_TYPE_BOOLEAN:
+            obsPtr->scratchSampleRef = dataSample_CreateBoolean(timestamp, (value != 0));
+            break;
+
+        case IO_DATA_TYPE_NUMERIC:
+            obsPtr->scratchSampleRef = dataSample_CreateNumeric(timestamp, value);
+            break;
+
+        default:
+            obsPtr->scratchSampleRef = dataSample_CreateTrigger(timestamp);
+            break;
+    }
+
+    return obsPtr->scratchSampleRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert a start time given to a read or query into an absolute time.
+ *
+ * @return The number of seconds since the Epoch, or NAN if the start time is NAN.
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetAbsoluteStartTime
+(
+    double startTime    ///< If < 30 years then seconds before now; else seconds since the Epoch.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // If the start time is less than or equal to 30 years, then convert to an
+    // absolute timestamp by subtracting it from the current time.
+    if (startTime <= THIRTY_YEARS)
+    {
+        le_clk_Time_t now = le_clk_GetAbsoluteTime();
+        startTime = ((((double)(now.usec)) / 1000000) + now.sec) - startTime;
+    }
+
+    return startTime;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a read or query with a given start time has to start in an Observation's spilled
+ * history, because the history holds samples that are at least as new as the start time.
+ *
+ * @return true if it does.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsHistoryQuery
+(
+    Observation_t* obsPtr,
+    double startTime,   ///< If < 30 years then seconds before now; else seconds since the Epoch.
+    double* absStartPtr ///< [OUT] Start time converted to seconds since the Epoch.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr = le_dls_PeekTail(&obsPtr->spillList);
+
+    if (isnan(startTime) || (linkPtr == NULL))
+    {
+        return false;
+    }
+
+    const SpillSegment_t* newestPtr = CONTAINER_OF(linkPtr, SpillSegment_t, link);
+
+    *absStartPtr = GetAbsoluteStartTime(startTime);
+
+    return (   (newestPtr->dataType == obsPtr->bufferedType)
+            && (*absStartPtr <= newestPtr->lastTimestamp)  );
+}
+
+
+#if LE_CONFIG_LINUX
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open the file of the segment that a cursor is reading.  A segment that has been dropped since
+ * the cursor started reading it can't be opened, because its file slot may have been reused.
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool OpenSpillFile
+(
+    Observation_t* obsPtr,
+    SpillCursor_t* cursorPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (cursorPtr->segPtr->isDropped)
+    {
+        return false;
+    }
+
+    char path[MAX_SPILL_FILE_PATH_BYTES];
+    if (GetSpillFilePath(path, sizeof(path), obsPtr, cursorPtr->segPtr->slot) != LE_OK)
+    {
+        return false;
+    }
+
+    cursorPtr->fd = open(path, O_RDONLY);
+    if (cursorPtr->fd == -1)
+    {
+        LE_ERROR("Failed to open '%s' (%m).", path);
+        return false;
+    }
+
+    return true;
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start reading a given segment of an Observation's spilled history, from the record that the
+ * sparse index says is the last one older than the cursor's start time.  The segment's file is
+ * opened if it has saved records; records that are still staged are read from memory.
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool OpenSpillSegment
+(
+    Observation_t* obsPtr,
+    SpillCursor_t* cursorPtr,
+    SpillSegment_t* segPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+#if LE_CONFIG_LINUX
+    cursorPtr->segPtr = segPtr;
+
+    if ((segPtr->savedCount > 0) && !OpenSpillFile(obsPtr, cursorPtr))
+    {
+        cursorPtr->segPtr = NULL;
+        return false;
+    }
+
+    le_mem_AddRef(segPtr);
+
+    size_t i = 0;
+    while (   ((i + 1) < SPILL_INDEX_ENTRIES)
+           && (((i + 1) * SPILL_INDEX_STRIDE) < segPtr->count)
+           && (segPtr->index[i + 1] < cursorPtr->startTime)  )
+    {
+        i++;
+    }
+    cursorPtr->nextIndex = i * SPILL_INDEX_STRIDE;
+
+    return true;
+#else
+    LE_UNUSED(obsPtr);
+    LE_UNUSED(cursorPtr);
+    LE_UNUSED(segPtr);
+
+    return false;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start reading a given Observation's spilled history at a given time.
+ *
+ * @return true if there may be records to read, false if not.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool OpenSpillCursor
+(
+    Observation_t* obsPtr,
+    SpillCursor_t* cursorPtr,   ///< [OUT] Cursor to initialize.
+    double startTime,           ///< Seconds since the Epoch.
+    bool isStartIncluded        ///< true to read records timestamped startTime.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    cursorPtr->segPtr = NULL;
+    cursorPtr->fd = -1;
+    cursorPtr->nextIndex = 0;
+    cursorPtr->startTime = startTime;
+    cursorPtr->isStartIncluded = isStartIncluded;
+    cursorPtr->lastTimestamp = NAN;
+    cursorPtr->loadedCount = 0;
+    cursorPtr->loadedIndex = 0;
+    cursorPtr->records.header.link = LE_DLS_LINK_INIT;
+    cursorPtr->records.header.firstSeq = 0;
+    cursorPtr->records.header.format = BLOCK_FORMAT_SAMPLE;
+
+    // Skip the segments that only hold older records.
+    le_dls_Link_t* linkPtr = le_dls_Peek(&obsPtr->spillList);
+
+    while (linkPtr != NULL)
+    {
+        SpillSegment_t* segPtr = CONTAINER_OF(linkPtr, SpillSegment_t, link);
+
+        if (segPtr->lastTimestamp >= startTime)
+        {
+            return OpenSpillSegment(obsPtr, cursorPtr, segPtr);
+        }
+
+        linkPtr = le_dls_PeekNext(&obsPtr->spillList, linkPtr);
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the next records of an Observation's spilled history into a cursor's Sample Block, moving
+ * on to the next segment when the one being read is finished.  A segment that has been dropped
+ * is read to its end, then the cursor moves on to the oldest segment started after it.
+ *
+ * @return true if records were loaded, false if there are no more (or they couldn't be read).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool LoadSpilledRecords
+(
+    Observation_t* obsPtr,
+    SpillCursor_t* cursorPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    while (cursorPtr->segPtr != NULL)
+    {
+        SpillSegment_t* segPtr = cursorPtr->segPtr;
+
+        if (cursorPtr->nextIndex < segPtr->count)
+        {
+#if LE_CONFIG_LINUX
+            size_t count = segPtr->count - cursorPtr->nextIndex;
+            if (count > SAMPLE_BLOCK_RECORDS)
+            {
+                count = SAMPLE_BLOCK_RECORDS;
+            }
+
+            if (cursorPtr->nextIndex >= segPtr->savedCount)
+            {
+                // Staged records haven't been written to the file yet.
+                const SpillStage_t* stagePtr = obsPtr->spillStagePtr;
+                size_t index = GetStagedIndex(obsPtr, segPtr)
+                               + (cursorPtr->nextIndex - segPtr->savedCount);
+
+                memcpy(cursorPtr->records.timestamps,
+                       &stagePtr->timestamps[index],
+                       count * sizeof(double));
+                memcpy(cursorPtr->records.values, &stagePtr->values[index], count * sizeof(double));
+
+                cursorPtr->nextIndex += count;
+                cursorPtr->loadedCount = count;
+                cursorPtr->loadedIndex = 0;
+
+                return true;
+            }
+
+            if (count > (segPtr->savedCount - cursorPtr->nextIndex))
+            {
+                count = segPtr->savedCount - cursorPtr->nextIndex;
+            }
+
+            // The file is opened late if the segment had no saved records when reading started.
+            if ((cursorPtr->fd == -1) && !OpenSpillFile(obsPtr, cursorPtr))
+            {
+                return false;
+            }
+
+            size_t recordBytes = GetSpillRecordBytes(segPtr->dataType);
+            uint8_t bytes[SAMPLE_BLOCK_RECORDS * (sizeof(double) + sizeof(double))];
+            ssize_t result = pread(cursorPtr->fd,
+                                   bytes,
+                                   count * recordBytes,
+                                   SPILL_HEADER_BYTES + (cursorPtr->nextIndex * recordBytes));
+            if (result != (ssize_t)(count * recordBytes))
+            {
+                LE_ERROR("Failed to read spilled history (%m).");
+                return false;
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const uint8_t* recordPtr = bytes + (i * recordBytes);
+                double value = NAN;
+
+                memcpy(&cursorPtr->records.timestamps[i], recordPtr, sizeof(double));
+
+                if (segPtr->dataType == IO_DATA_TYPE_BOOLEAN)
+                {
+                    value = (recordPtr[sizeof(double)] != 0) ? 1.0 : 0.0;
+                }
+                else if (segPtr->dataType == IO_DATA_TYPE_NUMERIC)
+                {
+                    memcpy(&value, recordPtr + sizeof(double), sizeof(double));
+                }
+                cursorPtr->records.values[i] = value;
+            }
+
+            cursorPtr->nextIndex += count;
+            cursorPtr->loadedCount = count;
+            cursorPtr->loadedIndex = 0;
+
+            return true;
+#endif
+        }
+
+        // Move on to the oldest segment started after this one, if it holds the same data type.
+        le_dls_Link_t* linkPtr = le_dls_Peek(&obsPtr->spillList);
+        SpillSegment_t* nextPtr = NULL;
+
+        while (linkPtr != NULL)
+        {
+            nextPtr = CONTAINER_OF(linkPtr, SpillSegment_t, link);
+            if (nextPtr->seq > segPtr->seq)
+            {
+                break;
+            }
+            nextPtr = NULL;
+            linkPtr = le_dls_PeekNext(&obsPtr->spillList, linkPtr);
+        }
+
+        CloseSpillCursor(cursorPtr);
+
+        if (   (nextPtr == NULL)
+            || (nextPtr->dataType != obsPtr->bufferedType)
+            || (!OpenSpillSegment(obsPtr, cursorPtr, nextPtr))  )
+        {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the position of the next record to be read from an Observation's spilled history, skipping
+ * records older than the cursor's start time.  The position stays valid until the next call to
+ * this function with the same cursor.  The cursor is closed once there are no more records.
+ *
+ * @return true if successful, false if there are no more records to read.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool PeekSpilledRecord
+(
+    Observation_t* obsPtr,
+    SpillCursor_t* cursorPtr,
+    BufferPos_t* posPtr         ///< [OUT] Position of the record.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const BufferPos_t emptyPos = BUFFER_POS_INIT;
+    *posPtr = emptyPos;
+
+    // The history can't be read as the buffer's data type once that has changed.
+    while (   (cursorPtr->segPtr != NULL)
+           && (cursorPtr->segPtr->dataType == obsPtr->bufferedType)  )
+    {
+        if (cursorPtr->loadedIndex < cursorPtr->loadedCount)
+        {
+            double timestamp = cursorPtr->records.timestamps[cursorPtr->loadedIndex];
+
+            if (   (timestamp > cursorPtr->startTime)
+                || ((timestamp == cursorPtr->startTime) && cursorPtr->isStartIncluded)  )
+            {
+                posPtr->blockPtr = &cursorPtr->records.header;
+                posPtr->index = cursorPtr->loadedIndex;
+                return true;
+            }
+
+            cursorPtr->loadedIndex++;
+        }
+        else if (!LoadSpilledRecords(obsPtr, cursorPtr))
+        {
+            break;
+        }
+    }
+
+    CloseSpillCursor(cursorPtr);
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Move a cursor past the record returned by the last call to PeekSpilledRecord().
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void SkipSpilledRecord
+(
+    SpillCursor_t* cursorPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    cursorPtr->lastTimestamp = cursorPtr->records.timestamps[cursorPtr->loadedIndex];
+    cursorPtr->loadedIndex++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count the records in a given Observation's spilled history that are newer than a given time,
+ * and not newer than another.  The records have to be read to be counted, so this costs as much
+ * file I/O as reading them.
+ *
+ * @return The number of records.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t CountHistorySpan
+(
+    Observation_t* obsPtr,
+    double startTime,   ///< Seconds since the Epoch.
+    double endTime      ///< Seconds since the Epoch, or HUGE_VAL.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t count = 0;
+    SpillCursor_t cursor;
+    BufferPos_t pos;
+
+    if (OpenSpillCursor(obsPtr, &cursor, startTime, false))
+    {
+        while (   PeekSpilledRecord(obsPtr, &cursor, &pos)
+               && (GetBufferedTimestamp(&pos) <= endTime))
+        {
+            count++;
+            SkipSpilledRecord(&cursor);
+        }
+    }
+
+    CloseSpillCursor(&cursor);
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the JSON representation of the value of the sample at a given buffer position into
+ * a given buffer.
+ *
+ * @return
+ *  - LE_OK if successful,
+ *  - LE_OVERFLOW if the buffer provided is too small to hold the value.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ConvertBufferedToJson
+(
+    Observation_t* obsPtr,
+    const BufferPos_t* posPtr,
+    char* valueBuffPtr,     ///< [OUT] Ptr to buffer where value will be stored.
+    size_t valueBuffSize    ///< [IN] Size of value buffer, in bytes.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (posPtr->entryPtr != NULL)
+    {
+        return dataSample_ConvertToJson(posPtr->entryPtr->sampleRef,
+                                        res_GetDataType(&obsPtr->resource),
+                                        valueBuffPtr,
+                                        valueBuffSize);
+    }
+
+    double value = GetBlockRecords(posPtr->blockPtr)->values[posPtr->index];
+
+    switch (obsPtr->bufferedType)
+    {
+        case IO_DATA_TYPE_BOOLEAN:
+            return le_utf8_Copy(valueBuffPtr, (value != 0) ? "true" : "false", valueBuffSize, NULL);
+
+        case IO_DATA_TYPE_NUMERIC:
+            if ((int) valueBuffSize <= snprintf(valueBuffPtr, valueBuffSize, "%lf", value))
+            {
+                return LE_OVERFLOW;
+            }
+            return LE_OK;
+
+        default:
+            return le_utf8_Copy(valueBuffPtr, "null", valueBuffSize, NULL);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Format the JSON representation of a sample to be read (preceded by a comma if it isn't the
+ * first) into a given buffer.
+ *
+ * @return
+ *  - LE_OK if successful,
+ *  - LE_OVERFLOW if the buffer provided is too small to hold the sample.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FormatReadOpSample
+(
+    ReadOperation_t* opPtr,
+    const BufferPos_t* posPtr, ///< Position of the sample.
+    char* buffPtr,          ///< [OUT] Ptr to buffer where the sample will be stored.
+    size_t buffSize,        ///< [IN] Size of the buffer, in bytes.
+    size_t* lenPtr          ///< [OUT] Number of characters stored (excl. null terminator).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int len = snprintf(buffPtr,
+                       buffSize,
+                       "%s{\"t\":%lf,\"v\":",
+                       opPtr->needsComma ? "," : "",
+                       GetBufferedTimestamp(posPtr));
+
+    // Leave room for an additional '}' at the end.
+    if ((len < 0) || ((size_t)len + 1 >= buffSize))
+    {
+        return LE_OVERFLOW;
+    }
+
+    // Copy the JSON version of the contents of the current buffer entry's data into the buffer.
+    le_result_t result = ConvertBufferedToJson(opPtr->obsPtr,
+                                               posPtr,
+                                               buffPtr + len,
+                                               buffSize - len - 1);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    len += strlen(buffPtr + len);
+    buffPtr[len] = '}';
+
+    *lenPtr = len + 1;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode the CBOR head of a data item with a given major type and argument (e.g., a length).
+ *
+ * @return The number of bytes encoded, or 0 if the buffer provided is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t EncodeCborHead
+(
+    uint8_t* buffPtr,
+    size_t buffSize,
+    uint8_t majorType,      ///< Major type (already shifted into the top 3 bits).
+    uint64_t argument
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t argLen;
+    uint8_t info;
+
+    if (argument < 24)
+    {
+        argLen = 0;
+        info = (uint8_t)argument;
+    }
+    else if (argument <= UINT8_MAX)
+    {
+        argLen = 1;
+        info = 24;
+    }
+    else if (argument <= UINT16_MAX)
+    {
+        argLen = 2;
+        info = 25;
+    }
+    else if (argument <= UINT32_MAX)
+    {
+        argLen = 4;
+        info = 26;
+    }
+    else
+    {
+        argLen = 8;
+        info = 27;
+    }
+
+    if (buffSize < (argLen + 1))
+    {
+        return 0;
+    }
+
+    buffPtr[0] = majorType | info;
+
+    // Multi-byte arguments are big-endian.
+    for (size_t i = argLen; i > 0; i--)
+    {
+        buffPtr[i] = (uint8_t)argument;
+        argument >>= 8;
+    }
+
+    return argLen + 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode a double-precision floating point number in CBOR.
+ *
+ * @return The number of bytes encoded, or 0 if the buffer provided is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t EncodeCborDouble
+(
+    uint8_t* buffPtr,
+    size_t buffSize,
+    double value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (buffSize < 9)
+    {
+        return 0;
+    }
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    buffPtr[0] = CBOR_FLOAT64;
+
+    // The value is big-endian.
+    for (size_t i = 8; i > 0; i--)
+    {
+        buffPtr[i] = (uint8_t)bits;
+        bits >>= 8;
+    }
+
+    return 9;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode a sample to be read into a given buffer in CBOR, as a two-element array holding
+ * the timestamp and the value.
+ *
+ * @return
+ *  - LE_OK if successful,
+ *  - LE_OVERFLOW if the buffer provided is too small to hold the sample.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t EncodeReadOpSampleCbor
+(
+    ReadOperation_t* opPtr,
+    const BufferPos_t* posPtr, ///< Position of the sample.
+    uint8_t* buffPtr,       ///< [OUT] Ptr to buffer where the sample will be stored.
+    size_t buffSize,        ///< [IN] Size of the buffer, in bytes.
+    size_t* lenPtr          ///< [OUT] Number of bytes stored.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (buffSize < 11)
+    {
+        return LE_OVERFLOW;
+    }
+
+    buffPtr[0] = CBOR_MAJOR_ARRAY | 2;
+    size_t len = 1;
+    len += EncodeCborDouble(buffPtr + len, buffSize - len, GetBufferedTimestamp(posPtr));
+
+    size_t valueLen;
+
+    switch (opPtr->obsPtr->bufferedType)
+    {
+        case IO_DATA_TYPE_TRIGGER:
+
+            buffPtr[len] = CBOR_NULL;
+            valueLen = 1;
+            break;
+
+        case IO_DATA_TYPE_BOOLEAN:
+
+            buffPtr[len] = (GetBufferedNumber(posPtr, IO_DATA_TYPE_BOOLEAN) != 0) ?
+                           CBOR_TRUE : CBOR_FALSE;
+            valueLen = 1;
+            break;
+
+        case IO_DATA_TYPE_NUMERIC:
+
+            valueLen = EncodeCborDouble(buffPtr + len,
+                                        buffSize - len,
+                                        GetBufferedNumber(posPtr, IO_DATA_TYPE_NUMERIC));
+            break;
+
+        default:
+        {
+            // Strings and JSON values are both encoded as text strings.
+            const char* valuePtr;
+            if (opPtr->obsPtr->bufferedType == IO_DATA_TYPE_JSON)
+            {
+                valuePtr = dataSample_GetJson(posPtr->entryPtr->sampleRef);
+            }
+            else
+            {
+                valuePtr = dataSample_GetString(posPtr->entryPtr->sampleRef);
+            }
+            size_t stringLen = strlen(valuePtr);
+
+            valueLen = EncodeCborHead(buffPtr + len,
+                                      buffSize - len,
+                                      CBOR_MAJOR_TEXT_STRING,
+                                      stringLen);
+            if ((valueLen == 0) || ((buffSize - len - valueLen) < stringLen))
+            {
+                return LE_OVERFLOW;
+            }
+            memcpy(buffPtr + len + valueLen, valuePtr, stringLen);
+            valueLen += stringLen;
+            break;
+        }
+    }
+
+    if (valueLen == 0)
+    {
+        return LE_OVERFLOW;
+    }
+
+    *lenPtr = len + valueLen;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the offset (from the first sample of the read data) of the first sample of a given bucket
+ * of a decimating read operation.
+ *
+ * Largest-Triangle-Three-Buckets (LTTB) decimation puts the first and last samples in buckets of
+ * their own and splits the samples between them into maxCount - 2 buckets of (nearly) equal size.
+ *
+ * @return The offset.  For the bucket after the last one, this is the number of samples.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetLttbBucketStart
+(
+    const ReadOperation_t* opPtr,
+    size_t bucketIndex
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t middleBuckets = opPtr->maxCount - 2;
+
+    if (bucketIndex == 0)
+    {
+        return 0;
+    }
+    if (bucketIndex > middleBuckets + 1)
+    {
+        return opPtr->spanCount;
+    }
+
+    return (size_t)(((double)(bucketIndex - 1) * (opPtr->spanCount - 2)) / middleBuckets) + 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Advance a buffer position by a given number of samples.
+ *
+ * @return true if successful, false if it ran out of samples (in which case the position is
+ *         cleared).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool SkipBufferEntries
+(
+    Observation_t* obsPtr,
+    BufferPos_t* posPtr,        ///< [INOUT] Position to advance.
+    size_t count
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!GetNextBufferEntry(obsPtr, posPtr))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Select the sample of the next bucket of a decimating read operation and make it the next
+ * sample to be written (nextPos).  The sample selected is the one that forms the largest
+ * triangle with the sample selected from the previous bucket and the average of the samples in
+ * the following bucket.
+ *
+ * If the samples of the bucket have fallen off the end of the Observation's buffer, the bucket
+ * starts at the oldest sample instead.  If the buffer runs out early, the remaining buckets are
+ * skipped.
+ *
+ * The nextPos is cleared if there are no more samples to write.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SelectLttbSample
+(
+    ReadOperation_t* opPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = opPtr->obsPtr;
+    io_DataType_t dataType = obsPtr->bufferedType;
+
+    ReleaseBufferPos(&opPtr->nextPos);
+
+    if (   (!IsValidBufferPos(&opPtr->bucketPos))
+        || (opPtr->bucketIndex >= opPtr->maxCount))
+    {
+        return;
+    }
+
+    if (!IsStillBuffered(obsPtr, &opPtr->bucketPos))
+    {
+        ReleaseBufferPos(&opPtr->bucketPos);
+        if (!GetOldestBufferEntry(obsPtr, &opPtr->bucketPos))
+        {
+            return;
+        }
+        HoldBufferPos(&opPtr->bucketPos);
+    }
+
+    size_t bucketIndex = opPtr->bucketIndex;
+    size_t bucketStart = GetLttbBucketStart(opPtr, bucketIndex);
+    size_t nextStart = GetLttbBucketStart(opPtr, bucketIndex + 1);
+    BufferPos_t selectedPos = opPtr->bucketPos;
+    BufferPos_t nextBucketPos = opPtr->bucketPos;
+    bool haveNextBucket = SkipBufferEntries(obsPtr, &nextBucketPos, nextStart - bucketStart);
+
+    // The first and last buckets only hold one sample, so there's nothing to choose from.
+    if ((bucketIndex > 0) && (bucketIndex < opPtr->maxCount - 1) && haveNextBucket)
+    {
+        // Average the samples in the following bucket.
+        size_t nextCount = GetLttbBucketStart(opPtr, bucketIndex + 2) - nextStart;
+        double avgTimestamp = 0.0;
+        double avgValue = 0.0;
+        size_t avgCount = 0;
+        BufferPos_t pos = nextBucketPos;
+        bool havePos = true;
+
+        while (havePos && (avgCount < nextCount))
+        {
+            avgTimestamp += GetBufferedTimestamp(&pos);
+            avgValue += GetBufferedNumber(&pos, dataType);
+            avgCount++;
+            havePos = GetNextBufferEntry(obsPtr, &pos);
+        }
+        avgTimestamp /= avgCount;
+        avgValue /= avgCount;
+
+        // Find the sample in this bucket with the largest triangle area.
+        double maxArea = -1.0;
+        pos = opPtr->bucketPos;
+
+        for (size_t i = bucketStart; i < nextStart; i++)
+        {
+            double timestamp = GetBufferedTimestamp(&pos);
+            double area = fabs(  ((opPtr->prevTimestamp - avgTimestamp)
+                                     * (GetBufferedNumber(&pos, dataType) - opPtr->prevValue))
+                               - ((opPtr->prevTimestamp - timestamp)
+                                     * (avgValue - opPtr->prevValue))  );
+            if (area > maxArea)
+            {
+                maxArea = area;
+                selectedPos = pos;
+            }
+
+            (void)GetNextBufferEntry(obsPtr, &pos);
+        }
+    }
+
+    opPtr->nextPos = selectedPos;
+    HoldBufferPos(&opPtr->nextPos);
+    opPtr->prevTimestamp = GetBufferedTimestamp(&selectedPos);
+    opPtr->prevValue = GetBufferedNumber(&selectedPos, dataType);
+
+    // Move on to the next bucket.
+    ReleaseBufferPos(&opPtr->bucketPos);
+    if (haveNextBucket)
+    {
+        opPtr->bucketPos = nextBucketPos;
+        HoldBufferPos(&opPtr->bucketPos);
+        opPtr->bucketIndex++;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the offset (from the first sample of a span of read data) of the first sample of a given
+ * bucket of a read operation decimated by stride or by bucket mean.  The samples are split into
+ * maxCount buckets of (nearly) equal size.
+ *
+ * @return The offset.  For the bucket after the last one, this is the number of samples.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetEvenBucketStart
+(
+    size_t spanCount,   ///< Number of samples in the span.
+    size_t maxCount,    ///< Number of buckets.
+    size_t bucketIndex
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (bucketIndex >= maxCount)
+    {
+        return spanCount;
+    }
+
+    return (size_t)(((double)bucketIndex * spanCount) / maxCount);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Select the next bucket of a read operation decimated by stride or by bucket mean, and make its
+ * first sample the next sample to be written (nextPos).  For bucket mean decimation, the mean
+ * timestamp and value of the samples in the bucket are kept in prevTimestamp and prevValue, to be
+ * written instead of that sample.
+ *
+ * If the samples of the bucket have fallen off the end of the Observation's buffer, the bucket
+ * starts at the oldest sample instead.  If the buffer runs out early, the remaining buckets are
+ * skipped.
+ *
+ * The nextPos is cleared if there are no more samples to write.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SelectBucketSample
+(
+    ReadOperation_t* opPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = opPtr->obsPtr;
+
+    ReleaseBufferPos(&opPtr->nextPos);
+
+    if (   (!IsValidBufferPos(&opPtr->bucketPos))
+        || (opPtr->bucketIndex >= opPtr->maxCount))
+    {
+        return;
+    }
+
+    if (!IsStillBuffered(obsPtr, &opPtr->bucketPos))
+    {
+        ReleaseBufferPos(&opPtr->bucketPos);
+        if (!GetOldestBufferEntry(obsPtr, &opPtr->bucketPos))
+        {
+            return;
+        }
+        HoldBufferPos(&opPtr->bucketPos);
+    }
+
+    size_t bucketSize =   GetEvenBucketStart(opPtr->spanCount,
+                                             opPtr->maxCount,
+                                             opPtr->bucketIndex + 1)
+                        - GetEvenBucketStart(opPtr->spanCount, opPtr->maxCount, opPtr->bucketIndex);
+    BufferPos_t nextBucketPos = opPtr->bucketPos;
+    bool haveNextBucket;
+
+    if (opPtr->decimation == QUERY_DECIMATION_MEAN)
+    {
+        double sumTimestamp = 0.0;
+        double sumValue = 0.0;
+        size_t count = 0;
+
+        haveNextBucket = true;
+        while (   haveNextBucket
+               && (count < bucketSize)
+               && (GetBufferedTimestamp(&nextBucketPos) <= opPtr->endTime))
+        {
+            sumTimestamp += GetBufferedTimestamp(&nextBucketPos);
+            sumValue += GetBufferedNumber(&nextBucketPos, IO_DATA_TYPE_NUMERIC);
+            count++;
+            haveNextBucket = GetNextBufferEntry(obsPtr, &nextBucketPos);
+        }
+
+        // If the bucket is past the end of the range, it won't be written anyway.
+        if (count > 0)
+        {
+            opPtr->prevTimestamp = sumTimestamp / count;
+            opPtr->prevValue = sumValue / count;
+        }
+    }
+    else
+    {
+        haveNextBucket = SkipBufferEntries(obsPtr, &nextBucketPos, bucketSize);
+    }
+
+    opPtr->nextPos = opPtr->bucketPos;
+    HoldBufferPos(&opPtr->nextPos);
+
+    // Move on to the next bucket.
+    ReleaseBufferPos(&opPtr->bucketPos);
+    if (haveNextBucket)
+    {
+        opPtr->bucketPos = nextBucketPos;
+        HoldBufferPos(&opPtr->bucketPos);
+        opPtr->bucketIndex++;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Select the sample of the next bucket of a decimating read operation, according to its
+ * decimation mode, and make it the next sample to be written (nextPos).
+ *
+ * The nextPos is cleared if there are no more samples to write.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SelectDecimatedSample
+(
+    ReadOperation_t* opPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (opPtr->decimation == QUERY_DECIMATION_LTTB)
+    {
+        SelectLttbSample(opPtr);
+    }
+    else
+    {
+        SelectBucketSample(opPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a sample that isn't in the Observation's buffer (e.g., the mean of a bucket of a read
+ * operation decimated by bucket mean) to a read operation's write buffer.  The sample is written
+ * as one of the Observation's buffered data type, which must be trigger, Boolean or numeric.
+ *
+ * @return
+ *  - LE_OK if the sample was added.
+ *  - LE_OVERFLOW if the sample doesn't fit in the rest of the write buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AddReadOpPoint
+(
+    ReadOperation_t* opPtr,
+    double timestamp,
+    double value,               ///< Value (not used for triggers).
+    size_t* lenPtr              ///< [INOUT] Number of bytes in the write buffer.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Leave room for the end of the array.
+    size_t spaceLeft = opPtr->writeBufferSize - *lenPtr - 1;
+    char* buffPtr = opPtr->writeBuffer + *lenPtr;
+    io_DataType_t dataType = opPtr->obsPtr->bufferedType;
+    size_t len;
+
+    if (opPtr->isCbor)
+    {
+        uint8_t* cborPtr = (uint8_t*)buffPtr;
+
+        // An array head and up to two doubles.
+        if (spaceLeft < 19)
+        {
+            return LE_OVERFLOW;
+        }
+
+        cborPtr[0] = CBOR_MAJOR_ARRAY | 2;
+        len = 1;
+        len += EncodeCborDouble(cborPtr + len, spaceLeft - len, timestamp);
+
+        if (dataType == IO_DATA_TYPE_TRIGGER)
+        {
+            cborPtr[len++] = CBOR_NULL;
+        }
+        else if (dataType == IO_DATA_TYPE_BOOLEAN)
+        {
+            cborPtr[len++] = (value != 0) ? CBOR_TRUE : CBOR_FALSE;
+        }
+        else
+        {
+            len += EncodeCborDouble(cborPtr + len, spaceLeft - len, value);
+        }
+    }
+    else
+    {
+        int result;
+
+        if (dataType == IO_DATA_TYPE_NUMERIC)
+        {
+            result = snprintf(buffPtr,
+                              spaceLeft,
+                              "%s{\"t\":%lf,\"v\":%lf}",
+                              opPtr->needsComma ? "," : "",
+                              timestamp,
+                              value);
+        }
+        else
+        {
+            const char* valuePtr = "null";
+            if (dataType == IO_DATA_TYPE_BOOLEAN)
+            {
+                valuePtr = (value != 0) ? "true" : "false";
+            }
+
+            result = snprintf(buffPtr,
+                              spaceLeft,
+                              "%s{\"t\":%lf,\"v\":%s}",
+                              opPtr->needsComma ? "," : "",
+                              timestamp,
+                              valuePtr);
+        }
+        if ((result < 0) || ((size_t)result >= spaceLeft))
+        {
+            return LE_OVERFLOW;
+        }
+        len = result;
+    }
+
+    *lenPtr += len;
+    opPtr->needsComma = true;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a sample to the write buffer of a read operation.  A sample too big to ever fit is skipped.
+ *
+ * @return
+ *  - LE_OK if the sample was added (or skipped).
+ *  - LE_OVERFLOW if the sample doesn't fit in the rest of the write buffer, but may fit in the
+ *    next chunk.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AddReadOpSample
+(
+    ReadOperation_t* opPtr,
+    const BufferPos_t* posPtr,  ///< Position of the sample.
+    size_t* lenPtr              ///< [INOUT] Number of bytes in the write buffer.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Leave room for the end of the array.
+    size_t spaceLeft = opPtr->writeBufferSize - *lenPtr - 1;
+
+    size_t sampleLen;
+    le_result_t result;
+    if (opPtr->isCbor)
+    {
+        result = EncodeReadOpSampleCbor(opPtr,
+                                        posPtr,
+                                        (uint8_t*)opPtr->writeBuffer + *lenPtr,
+                                        spaceLeft,
+                                        &sampleLen);
+    }
+    else
+    {
+        result = FormatReadOpSample(opPtr,
+                                    posPtr,
+                                    opPtr->writeBuffer + *lenPtr,
+                                    spaceLeft,
+                                    &sampleLen);
+    }
+    if (result == LE_OK)
+    {
+        *lenPtr += sampleLen;
+        opPtr->needsComma = true;
+    }
+    else if (spaceLeft <= (opPtr->writeBufferSize - DHUB_READ_OP_BATCH_BYTES - 2))
+    {
+        // The sample may fit in the next chunk, so send this one first.
+        return LE_OVERFLOW;
+    }
+    else
+    {
+        LE_ERROR("JSON value doesn't fit in write buffer. Skipping.");
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get twice the area of the triangle formed by three samples.
+ *
+ * @return The area (times two).
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetTriangleArea
+(
+    const ReadOpPoint_t* aPtr,
+    const ReadOpPoint_t* bPtr,
+    const ReadOpPoint_t* cPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return fabs(  ((aPtr->timestamp - bPtr->timestamp) * (cPtr->value - aPtr->value))
+                - ((aPtr->timestamp - cPtr->timestamp) * (bPtr->value - aPtr->value))  );
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Select the sample to be written for the history bucket that a decimating read operation has
+ * read (historyPoint), and move on to the next bucket.  Decimating by stride selects the first
+ * sample of the bucket, and decimating by bucket mean selects the mean of its samples.
+ *
+ * The spilled history can only be read once, in order, so LTTB can't look ahead at the following
+ * bucket.  Instead, it selects the smallest or the largest value of the bucket, whichever forms
+ * the larger triangle with the previous sample selected and the mean of the bucket itself.  The
+ * first sample is always selected from the first bucket.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SelectHistoryPoint
+(
+    ReadOperation_t* opPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ReadOpPoint_t mean =
+    {
+        .timestamp = opPtr->bucketSum.timestamp / opPtr->bucketCount,
+        .value = opPtr->bucketSum.value / opPtr->bucketCount
+    };
+    const ReadOpPoint_t* selectedPtr = &opPtr->bucketFirst;
+
+    if (opPtr->decimation == QUERY_DECIMATION_MEAN)
+    {
+        selectedPtr = &mean;
+    }
+    else if ((opPtr->decimation == QUERY_DECIMATION_LTTB) && (opPtr->historyBucket > 0))
+    {
+        if (  GetTriangleArea(&opPtr->historyPoint, &mean, &opPtr->bucketMin)
+            > GetTriangleArea(&opPtr->historyPoint, &mean, &opPtr->bucketMax))
+        {
+            selectedPtr = &opPtr->bucketMin;
+        }
+        else
+        {
+            selectedPtr = &opPtr->bucketMax;
+        }
+    }
+
+    opPtr->historyPoint = *selectedPtr;
+    opPtr->hasHistoryPoint = true;
+    opPtr->bucketCount = 0;
+    opPtr->historyBucket++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a record of the spilled history to the current history bucket of a decimating read
+ * operation, selecting the sample to be written for the bucket once it is complete.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddHistoryRecord
+(
+    ReadOperation_t* opPtr,
+    const BufferPos_t* posPtr   ///< Position of the record.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ReadOpPoint_t point =
+    {
+        .timestamp = GetBufferedTimestamp(posPtr),
+        .value = GetBufferedNumber(posPtr, opPtr->obsPtr->bufferedType)
+    };
+
+    if (opPtr->bucketCount == 0)
+    {
+        opPtr->bucketFirst = point;
+        opPtr->bucketMin = point;
+        opPtr->bucketMax = point;
+        opPtr->bucketSum.timestamp = 0.0;
+        opPtr->bucketSum.value = 0.0;
+    }
+    else if (point.value < opPtr->bucketMin.value)
+    {
+        opPtr->bucketMin = point;
+    }
+    else if (point.value > opPtr->bucketMax.value)
+    {
+        opPtr->bucketMax = point;
+    }
+
+    opPtr->bucketSum.timestamp += point.timestamp;
+    opPtr->bucketSum.value += point.value;
+    opPtr->bucketCount++;
+    opPtr->historyIndex++;
+
+    if (opPtr->historyIndex >= GetEvenBucketStart(opPtr->historySpan,
+                                                  opPtr->historyMaxCount,
+                                                  opPtr->historyBucket + 1))
+    {
+        SelectHistoryPoint(opPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finish reading the spilled history of a read operation, and carry on with the oldest buffered
+ * sample that is newer than the last sample read from the history.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EndHistoryRead
+(
+    ReadOperation_t* opPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = opPtr->obsPtr;
+    double lastTimestamp = opPtr->history.lastTimestamp;
+
+    CloseSpillCursor(&opPtr->history);
+    opPtr->state = SAMPLE;
+
+    // Samples may have been added to the buffer, or evicted into the history, while it was read.
+    if (!IsStillBuffered(obsPtr, &opPtr->nextPos))
+    {
+        ReleaseBufferPos(&opPtr->nextPos);
+        if (!GetOldestBufferEntry(obsPtr, &opPtr->nextPos))
+        {
+            return;
+        }
+        HoldBufferPos(&opPtr->nextPos);
+    }
+
+    BufferPos_t pos = opPtr->nextPos;
+    bool havePos = true;
+
+    while (havePos && (GetBufferedTimestamp(&pos) <= lastTimestamp))
+    {
+        havePos = GetNextBufferEntry(obsPtr, &pos);
+    }
+
+    ReleaseBufferPos(&opPtr->nextPos);
+    if (havePos)
+    {
+        opPtr->nextPos = pos;
+        HoldBufferPos(&opPtr->nextPos);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the write buffer with a chunk of the output of a read operation: the start of the array,
+ * as many of the following samples as fit, and the end of the array once there are no more.
+ * Samples from the spilled history, if it is being read, come before those in the buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LoadReadOpBuffer
+(
+    ReadOperation_t* opPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t len = 0;
+
+    if (opPtr->state == START)
+    {
+        opPtr->writeBuffer[len++] = opPtr->isCbor ? (char)CBOR_INDEF_ARRAY_START : '[';
+        opPtr->state = (opPtr->history.segPtr != NULL) ? HISTORY : SAMPLE;
+    }
+
+    while (opPtr->state == HISTORY)
+    {
+        // A sample selected by decimation is written before reading any more of the history.
+        if (opPtr->hasHistoryPoint)
+        {
+            if (AddReadOpPoint(opPtr,
+                               opPtr->historyPoint.timestamp,
+                               opPtr->historyPoint.value,
+                               &len) != LE_OK)
+            {
+                break;
+            }
+            opPtr->hasHistoryPoint = false;
+        }
+
+        // When decimating, the history ends with the samples that were counted.  Those evicted
+        // since are read from the buffer.  A bucket left incomplete is written as it is.
+        BufferPos_t pos;
+        if (   ((opPtr->historyMaxCount > 0) && (opPtr->historyIndex >= opPtr->historySpan))
+            || !PeekSpilledRecord(opPtr->obsPtr, &opPtr->history, &pos))
+        {
+            if (opPtr->bucketCount > 0)
+            {
+                SelectHistoryPoint(opPtr);
+            }
+            else
+            {
+                EndHistoryRead(opPtr);
+            }
+        }
+        else if (GetBufferedTimestamp(&pos) > opPtr->endTime)
+        {
+            // The rest of the history, and the whole buffer, are past the end of the range.
+            if (opPtr->bucketCount > 0)
+            {
+                SelectHistoryPoint(opPtr);
+            }
+            else
+            {
+                CloseSpillCursor(&opPtr->history);
+                opPtr->state = END;
+            }
+        }
+        else if (opPtr->historyMaxCount > 0)
+        {
+            AddHistoryRecord(opPtr, &pos);
+            SkipSpilledRecord(&opPtr->history);
+        }
+        else if (AddReadOpSample(opPtr, &pos, &len) == LE_OK)
+        {
+            SkipSpilledRecord(&opPtr->history);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    while (opPtr->state == SAMPLE)
+    {
+        if (!IsValidBufferPos(&opPtr->nextPos))
+        {
+            opPtr->state = END;
+            break;
+        }
+
+        // If the next sample to be selected by decimation has fallen off the end of the
+        // observation's buffer, select another.
+        if ((opPtr->maxCount > 0) && !IsStillBuffered(opPtr->obsPtr, &opPtr->nextPos))
+        {
+            SelectDecimatedSample(opPtr);
+            continue;
+        }
+
+        // If the next sample has fallen off the end of the observation's buffer, all entries in
+        // the observation's buffer are now newer than it, so restart from the oldest.
+        if (!IsStillBuffered(opPtr->obsPtr, &opPtr->nextPos))
+        {
+            ReleaseBufferPos(&opPtr->nextPos);
+            if (GetOldestBufferEntry(opPtr->obsPtr, &opPtr->nextPos))
+            {
+                HoldBufferPos(&opPtr->nextPos);
+            }
+            else
+            {
+                opPtr->state = END;
+                break;
+            }
+        }
+
+        // Samples newer than the end of the range are not read.
+        if (GetBufferedTimestamp(&opPtr->nextPos) > opPtr->endTime)
+        {
+            opPtr->state = END;
+            break;
+        }
+
+        le_result_t result;
+        if ((opPtr->maxCount > 0) && (opPtr->decimation == QUERY_DECIMATION_MEAN))
+        {
+            result = AddReadOpPoint(opPtr, opPtr->prevTimestamp, opPtr->prevValue, &len);
+        }
+        else
+        {
+            result = AddReadOpSample(opPtr, &opPtr->nextPos, &len);
+        }
+        if (result != LE_OK)
+        {
+            break;
+        }
+
+        if (opPtr->maxCount > 0)
+        {
+            SelectDecimatedSample(opPtr);
+            continue;
+        }
+
+        // Advance the nextPos to the next sample in the Observation's buffer.
+        BufferPos_t nextPos = opPtr->nextPos;
+        bool haveNext = GetNextBufferEntry(opPtr->obsPtr, &nextPos);
+        ReleaseBufferPos(&opPtr->nextPos);
+
+        if (haveNext)
+        {
+            opPtr->nextPos = nextPos;
+            HoldBufferPos(&opPtr->nextPos);
+        }
+    }
+
+    if (opPtr->state == END)
+    {
+        opPtr->writeBuffer[len++] = opPtr->isCbor ? (char)CBOR_BREAK : ']';
+        opPtr->state = DONE;
+    }
+
+    opPtr->writeLen = len;
+    opPtr->writeOffset = 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write to an unbuffered file descriptor.
+ *
+ * @return The number of bytes written.  -1 on error (errno is set).
+ */
+//--------------------------------------------------------------------------------------------------
+static ssize_t WriteToFd
+(
+    int fd,
+    const void* buffPtr,
+    size_t byteCount
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ssize_t result;
+
+    LE_ASSERT(buffPtr != NULL);
+
+    do
+    {
+        result = write(fd, buffPtr, byteCount);
+
+    } while ((result == -1) && (errno == EINTR));
+
+    return result;
+}
+
+
+static void ResumeReadOp(void* param1Ptr, void* param2Ptr);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Continue a read operation.  After DHUB_READ_OP_SLICE_CHUNKS write buffers have been loaded,
+ * the rest is left to ResumeReadOp(), so other events get handled in between.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ContinueReadOp
+(
+    ReadOperation_t* opPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t chunkCount = 0;
+
+    for (;;)
+    {
+        // If the write buffer has been written entirely, load the next chunk, unless the
+        // end of the array has already been written.
+        if (opPtr->writeOffset == opPtr->writeLen)
+        {
+            if (opPtr->state == DONE)
+            {
+                EndRead(opPtr, LE_OK);
+
+                return;
+            }
+
+            if (chunkCount >= DHUB_READ_OP_SLICE_CHUNKS)
+            {
+                // Stop watching the fd until resumed, and hold the operation until then, in case
+                // it ends (e.g., on hang-up) in the meantime.
+                le_fdMonitor_Disable(opPtr->fdMonitor, POLLOUT);
+                le_mem_AddRef(opPtr);
+                le_event_QueueFunction(ResumeReadOp, opPtr, NULL);
+
+                return;
+            }
+
+            LoadReadOpBuffer(opPtr);
+            chunkCount++;
+        }
+
+        // Write and check for errors.
+        ssize_t result = WriteToFd(opPtr->fd,
+                                   opPtr->writeBuffer + opPtr->writeOffset,
+                                   opPtr->writeLen - opPtr->writeOffset);
+        if (result == -1)
+        {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                // Return and wait for this function to be called again by the FD Monitor.
+                return;
+            }
+
+            LE_ERROR("Error writing (%m).");
+            EndRead(opPtr, LE_COMM_ERROR);
+
+            return;
+        }
+
+        // Update the write offset.
+        // Note: If the write buffer has not been written entirely, loop back around to write more.
+        opPtr->writeOffset += result;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resume a read operation that has yielded to the event loop, unless it has ended since.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ResumeReadOp
+(
+    void* param1Ptr,    ///< The read operation.
+    void* param2Ptr     ///< Not used.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(param2Ptr);
+
+    ReadOperation_t* opPtr = param1Ptr;
+
+    if (opPtr->fd != -1)
+    {
+        le_fdMonitor_Enable(opPtr->fdMonitor, POLLOUT);
+        ContinueReadOp(opPtr);
+    }
+
+    le_mem_Release(opPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Event handler call-back for events on a read operation's write file descriptor.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadOpFdEventHandler
+(
+    int fd,
+    short events
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(fd);
+
+    ReadOperation_t* opPtr = le_fdMonitor_GetContextPtr();
+
+    // Check for error or hang-up.
+    if ((events & POLLERR) || (events & POLLHUP) || (events & POLLRDHUP))
+    {
+        LE_ERROR("Error or hang-up on output stream.");
+        EndRead(opPtr, LE_COMM_ERROR);
+    }
+    // Note: The only other reason for this function to be called is POLLOUT (writeable).
+    else
+    {
+        ContinueReadOp(opPtr);
+    }
+}
+
+
+static size_t CountReadSpan(Observation_t* obsPtr, const BufferPos_t* startPosPtr,
+                           double endTime);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a read operation on a given Observation's buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartRead
+(
+    Observation_t* obsPtr,
+    const BufferPos_t* startPosPtr, ///< Position of sample to start at (not valid if read data
+                                    ///< set empty).
+    double endTime, ///< Time of the newest sample to read (seconds since the Epoch, or HUGE_VAL).
+    bool isCbor,    ///< true to write CBOR, false to write JSON.
+    size_t maxCount, ///< Max number of samples to write (decimating if necessary); 0 = no limit.
+    query_DecimationMode_t decimation, ///< How to select the samples, if decimating.
+    double historyStart, ///< Read the spilled history from this time (seconds since the Epoch)
+                         ///< before the buffer, or NAN to only read the buffer.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Set the fd non-blocking
+    if (0 != fcntl(outputFile, F_SETFL, O_NONBLOCK))
+    {
+        LE_ERROR("Failed to activate non-blocking mode (%m).");
+        handlerPtr(LE_COMM_ERROR, contextPtr);
+        return;
+    }
+
+    ReadOperation_t* opPtr = hub_MemAlloc(ReadOperationPool);
+    if (opPtr == NULL)
+    {
+        LE_ERROR("Failed to allocate a read operation");
+        handlerPtr(LE_NO_MEMORY, contextPtr);
+        return;
+    }
+
+    // Only string and JSON samples can be too long for the read operation's own buffer.
+    if (IsRingStorage(obsPtr))
+    {
+        opPtr->writeBuffer = opPtr->smallBuffer;
+        opPtr->writeBufferSize = sizeof(opPtr->smallBuffer);
+    }
+    else
+    {
+        opPtr->writeBuffer = hub_MemAlloc(ReadBufferPool);
+        if (opPtr->writeBuffer == NULL)
+        {
+            LE_ERROR("Failed to allocate a read buffer");
+            le_mem_Release(opPtr);
+            handlerPtr(LE_NO_MEMORY, contextPtr);
+            return;
+        }
+        opPtr->writeBufferSize = READ_OP_CHUNK_BYTES;
+    }
+    opPtr->link = LE_DLS_LINK_INIT;
+    le_dls_Queue(&obsPtr->readOpList, &opPtr->link);
+
+    opPtr->obsPtr = obsPtr;
+
+    opPtr->fdMonitor = le_fdMonitor_Create("Read", outputFile, ReadOpFdEventHandler, POLLOUT);
+    le_fdMonitor_SetContextPtr(opPtr->fdMonitor, opPtr);
+    opPtr->fd = outputFile;
+    opPtr->nextPos = *startPosPtr;
+    // We hold a ref count on the buffer entry to prevent it from being released.
+    HoldBufferPos(&opPtr->nextPos);
+    opPtr->handlerPtr = handlerPtr;
+    opPtr->contextPtr = contextPtr;
+
+    opPtr->history.segPtr = NULL;
+    opPtr->history.fd = -1;
+    if (!isnan(historyStart))
+    {
+        (void)OpenSpillCursor(obsPtr, &opPtr->history, historyStart, false);
+    }
+
+    opPtr->state = START;
+    opPtr->isCbor = isCbor;
+    opPtr->needsComma = false;
+    opPtr->writeLen = 0;
+    opPtr->writeOffset = 0;
+    opPtr->endTime = endTime;
+    opPtr->decimation = decimation;
+
+    // The mean of values that aren't numbers isn't one of them, and LTTB needs values that can be
+    // compared, so data of other types is decimated by stride instead.
+    io_DataType_t dataType = obsPtr->bufferedType;
+    if (   (   (decimation == QUERY_DECIMATION_MEAN)
+            && (dataType != IO_DATA_TYPE_NUMERIC))
+        || (   (decimation == QUERY_DECIMATION_LTTB)
+            && (dataType != IO_DATA_TYPE_NUMERIC)
+            && (dataType != IO_DATA_TYPE_BOOLEAN))  )
+    {
+        opPtr->decimation = QUERY_DECIMATION_STRIDE;
+    }
+
+    // Data is only decimated if there's more of it than asked for.
+    const BufferPos_t emptyPos = BUFFER_POS_INIT;
+    opPtr->bucketPos = emptyPos;
+    opPtr->maxCount = 0;
+    opPtr->spanCount = 0;
+    opPtr->historyMaxCount = 0;
+    opPtr->historySpan = 0;
+    opPtr->historyIndex = 0;
+    opPtr->historyBucket = 0;
+    opPtr->bucketCount = 0;
+    opPtr->hasHistoryPoint = false;
+    if (maxCount > 0)
+    {
+        bool isLttb = (opPtr->decimation == QUERY_DECIMATION_LTTB);
+
+        // LTTB always keeps the first and last samples, plus at least one in between.
+        if (isLttb && (maxCount < 3))
+        {
+            maxCount = 3;
+        }
+
+        opPtr->spanCount = CountReadSpan(obsPtr, startPosPtr, endTime);
+        if (opPtr->history.segPtr != NULL)
+        {
+            opPtr->historySpan = CountHistorySpan(obsPtr, historyStart, endTime);
+        }
+
+        size_t totalCount = opPtr->spanCount + opPtr->historySpan;
+        if (totalCount > maxCount)
+        {
+            // Share the samples asked for between the history and the buffer, in proportion to
+            // the number of samples each holds.
+            size_t bufferMaxCount =
+                maxCount - (size_t)(((double)maxCount * opPtr->historySpan) / totalCount);
+            if (isLttb && (opPtr->spanCount > 0) && (bufferMaxCount < 3))
+            {
+                bufferMaxCount = 3;
+            }
+            opPtr->historyMaxCount = maxCount - bufferMaxCount;
+
+            // If no samples are left for the history, it isn't read at all.
+            if (opPtr->historyMaxCount == 0)
+            {
+                CloseSpillCursor(&opPtr->history);
+            }
+
+            if (opPtr->spanCount > bufferMaxCount)
+            {
+                opPtr->maxCount = bufferMaxCount;
+                opPtr->bucketIndex = 0;
+                opPtr->bucketPos = opPtr->nextPos;
+                HoldBufferPos(&opPtr->bucketPos);
+                SelectDecimatedSample(opPtr);
+            }
+        }
+    }
+
+    ContinueReadOp(opPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the timestamp of the newest sample in a given Observation's buffer.
+ *
+ * @return The timestamp, or NAN if the buffer is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetNewestTimestamp
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (obsPtr->count == 0)
+    {
+        return NAN;
+    }
+
+    if (IsRingStorage(obsPtr))
+    {
+        return obsPtr->tailBlockPtr->timestamps[obsPtr->tailIndex - 1];
+    }
+
+    le_sls_Link_t* linkPtr = le_sls_PeekTail(&obsPtr->sampleList);
+    LE_ASSERT(linkPtr != NULL);
+
+    return dataSample_GetTimestamp(CONTAINER_OF(linkPtr, BufferEntry_t, link)->sampleRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Put a block holding the same records as a full Sample Block of a given Observation's ring
+ * storage in place of it.  Buffer positions that refer to the Sample Block are moved to the new
+ * block, which is inserted just before the Sample Block in the ring so the caller can reuse the
+ * Sample Block as the next tail block.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReplaceSampleBlock
+(
+    Observation_t* obsPtr,
+    SampleBlock_t* blockPtr,
+    RingBlock_t* newBlockPtr    ///< The new block (its format must be set).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    newBlockPtr->link = LE_DLS_LINK_INIT;
+    newBlockPtr->firstSeq = blockPtr->header.firstSeq;
+
+    le_dls_AddBefore(&obsPtr->blockList, &blockPtr->header.link, &newBlockPtr->link);
+
+    MoveBufferPos(&obsPtr->searchCursor, &blockPtr->header, newBlockPtr);
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&obsPtr->readOpList);
+    while (linkPtr != NULL)
+    {
+        ReadOperation_t* opPtr = CONTAINER_OF(linkPtr, ReadOperation_t, link);
+
+        MoveBufferPos(&opPtr->nextPos, &blockPtr->header, newBlockPtr);
+        MoveBufferPos(&opPtr->bucketPos, &blockPtr->header, newBlockPtr);
+
+        linkPtr = le_dls_PeekNext(&obsPtr->readOpList, linkPtr);
+    }
+}
+
+
+#ifdef DHUB_COMPRESSED_BUFFERS
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replace a full Sample Block of a given Observation's ring storage with a Compressed Block
+ * holding the same records (see ReplaceSampleBlock()).
+ *
+ * @return true if the block was compressed, false if it is left as it is (the records don't fit
+ *         in a Compressed Block, or no Compressed Block could be allocated).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CompressBlock
+(
+    Observation_t* obsPtr,
+    SampleBlock_t* blockPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint8_t bytes[DHUB_COMPRESSED_BLOCK_BYTES] = { 0 };
+
+    if (!EncodeBlock(blockPtr, bytes, sizeof(bytes)))
+    {
+        return false;
+    }
+
+    CompressedBlock_t* compressedPtr = hub_MemAlloc(CompressedBlockPool);
+    if (compressedPtr == NULL)
+    {
+        return false;
+    }
+
+    compressedPtr->header.format = BLOCK_FORMAT_COMPRESSED;
+    memcpy(compressedPtr->bytes, bytes, sizeof(bytes));
+
+    ReplaceSampleBlock(obsPtr, blockPtr, &compressedPtr->header);
+
+    return true;
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replace a full Sample Block of a given Observation's ring storage with a Compact Block holding
+ * the same records (see ReplaceSampleBlock()).
+ *
+ * @return true if the block was compacted, false if it is left as it is (some records would lose
+ *         precision, e.g., because they were added before the buffer precision was set to
+ *         compact, or no Compact Block could be allocated).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CompactBlock
+(
+    Observation_t* obsPtr,
+    SampleBlock_t* blockPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    double baseTime = blockPtr->timestamps[0];
+    uint32_t timeOffsets[SAMPLE_BLOCK_RECORDS];
+    float values[SAMPLE_BLOCK_RECORDS];
+
+    for (size_t i = 0; i < SAMPLE_BLOCK_RECORDS; i++)
+    {
+        double value = blockPtr->values[i];
+
+        values[i] = (float)value;
+
+        if (   (!GetCompactOffset(baseTime, blockPtr->timestamps[i], &timeOffsets[i]))
+            || (GetCompactTimestamp(baseTime, timeOffsets[i]) != blockPtr->timestamps[i])
+            || (((double)values[i] != value) && !isnan(value))  )
+        {
+            return false;
+        }
+    }
+
+    CompactBlock_t* compactPtr = hub_MemAlloc(CompactBlockPool);
+    if (compactPtr == NULL)
+    {
+        return false;
+    }
+
+    compactPtr->header.format = BLOCK_FORMAT_COMPACT;
+    compactPtr->baseTime = baseTime;
+    memcpy(compactPtr->timeOffsets, timeOffsets, sizeof(timeOffsets));
+    memcpy(compactPtr->values, values, sizeof(values));
+
+    ReplaceSampleBlock(obsPtr, blockPtr, &compactPtr->header);
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a record to the ring storage of a given Observation.  A new Sample Block is only
+ * allocated if the tail block is full and there is no spare block to recycle.
+ *
+ * @return
+ *      - LE_OK If the record was added successfully.
+ *      - LE_NO_MEMORY If failed to allocate a Sample Block.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AddRecordToBuffer
+(
+    Observation_t* obsPtr,
+    double timestamp,
+    double value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((obsPtr->tailBlockPtr == NULL) || (obsPtr->tailIndex == SAMPLE_BLOCK_RECORDS))
+    {
+        le_dls_Link_t* linkPtr;
+
+        if (obsPtr->tailBlockPtr == NULL)
+        {
+            linkPtr = le_dls_Peek(&obsPtr->blockList);
+        }
+#ifdef DHUB_COMPRESSED_BUFFERS
+        // If the full tail block can be compressed, its Sample Block can be reused right away.
+        else if (CompressBlock(obsPtr, obsPtr->tailBlockPtr))
+        {
+            linkPtr = &obsPtr->tailBlockPtr->header.link;
+        }
+#endif
+        // Likewise if it can be compacted.
+        else if (obsPtr->isBufferCompact && CompactBlock(obsPtr, obsPtr->tailBlockPtr))
+        {
+            linkPtr = &obsPtr->tailBlockPtr->header.link;
+        }
+        else
+        {
+            linkPtr = le_dls_PeekNext(&obsPtr->blockList, &obsPtr->tailBlockPtr->header.link);
+        }
+
+        SampleBlock_t* blockPtr;
+
+        if (linkPtr != NULL)
+        {
+            blockPtr = CONTAINER_OF(linkPtr, SampleBlock_t, header.link);
+        }
+        else
+        {
+            blockPtr = hub_MemAlloc(SampleBlockPool);
+            if (blockPtr == NULL)
+            {
+                LE_ERROR("Failed to allocate a sample block");
+                return LE_NO_MEMORY;
+            }
+            blockPtr->header.link = LE_DLS_LINK_INIT;
+            blockPtr->header.format = BLOCK_FORMAT_SAMPLE;
+            le_dls_Queue(&obsPtr->blockList, &blockPtr->header.link);
+        }
+
+        blockPtr->header.firstSeq = obsPtr->oldestSeq + obsPtr->count;
+        obsPtr->tailBlockPtr = blockPtr;
+        obsPtr->tailIndex = 0;
+    }
+
+    if (obsPtr->isBufferCompact)
+    {
+        // Round the record the way a Compact Block stores it, so that the block can be
+        // compacted once it is full and reads give the same record before and after.
+        double baseTime = obsPtr->tailBlockPtr->timestamps[0];
+        uint32_t offset;
+
+        if ((obsPtr->tailIndex > 0) && GetCompactOffset(baseTime, timestamp, &offset))
+        {
+            timestamp = GetCompactTimestamp(baseTime, offset);
+        }
+        value = (float)value;
+    }
+
+    obsPtr->tailBlockPtr->timestamps[obsPtr->tailIndex] = timestamp;
+    obsPtr->tailBlockPtr->values[obsPtr->tailIndex] = value;
+    (obsPtr->tailIndex)++;
+
+    AddToAggregates(obsPtr, obsPtr->oldestSeq + obsPtr->count, value);
+
+    (obsPtr->count)++;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Discard the oldest record in the ring storage of a given Observation.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DropOldestRecord
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(obsPtr->count > 0);
+
+    RingBlock_t* headBlockPtr = CONTAINER_OF(le_dls_Peek(&obsPtr->blockList), RingBlock_t, link);
+    RemoveFromAggregates(obsPtr,
+                         obsPtr->oldestSeq,
+                         GetBlockRecords(headBlockPtr)->values[obsPtr->headIndex]);
+
+    (obsPtr->count)--;
+    (obsPtr->oldestSeq)++;
+    (obsPtr->headIndex)++;
+
+    if (obsPtr->count == 0)
+    {
+        ReleaseSampleBlocks(obsPtr);
+    }
+    else if (obsPtr->headIndex == SAMPLE_BLOCK_RECORDS)
+    {
+        // The oldest block has been entirely consumed.  Keep it as the spare block at the end of
+        // the ring, unless it isn't a Sample Block or there's already a spare block there.
+        le_dls_Link_t* linkPtr = le_dls_Pop(&obsPtr->blockList);
+
+        if (   (headBlockPtr->format == BLOCK_FORMAT_SAMPLE)
+            && (le_dls_PeekNext(&obsPtr->blockList, &obsPtr->tailBlockPtr->header.link) == NULL))
+        {
+            le_dls_Queue(&obsPtr->blockList, linkPtr);
+        }
+        else
+        {
+            ReleaseRingBlock(headBlockPtr);
+        }
+
+        obsPtr->headIndex = 0;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds a given data sample to the buffer of a given Observation.
+ *
+ * @return
+ *      - LE_OK If datasample was added to observation buffer successfully.
+ *      - LE_NO_MEMORY If failed to allocate memory for the new datasample in Buffer Pool.
+ *      - LE_BAD_PARAMETER If dropped sample because its timestamp was older than the sample already
+ *           in buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AddToBuffer
+(
+    Observation_t* obsPtr,
+    dataSample_Ref_t sampleRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    BufferEntry_t* buffEntryPtr;
+
+    double newEntryTimestamp = dataSample_GetTimestamp(sampleRef);
+
+    // If the new sample is timestamped older than the newest sample already in the buffer,
+    // then we have a serious problem, because buffer traversal operations could get stuck in loops.
+    if (obsPtr->count > 0)
+    {
+        double oldEntryTimestamp = GetNewestTimestamp(obsPtr);
+
+        if (oldEntryTimestamp > newEntryTimestamp)
+        {
+            LE_ERROR("New sample has older timestamp than (older) sample already in the buffer!");
+            LE_ERROR("Dropping new sample timestamped %lf (< %lf in buffer)!",
+                     newEntryTimestamp,
+                     oldEntryTimestamp);
+            return LE_BAD_PARAMETER;
+        }
+    }
+
+    le_result_t result;
+
+    switch (obsPtr->bufferedType)
+    {
+        case IO_DATA_TYPE_TRIGGER:
+            result = AddRecordToBuffer(obsPtr, newEntryTimestamp, NAN);
+            break;
+
+        case IO_DATA_TYPE_BOOLEAN:
+            result = AddRecordToBuffer(obsPtr,
+                                       newEntryTimestamp,
+                                       dataSample_GetBoolean(sampleRef) ? 1.0 : 0.0);
+            break;
+
+        case IO_DATA_TYPE_NUMERIC:
+            result = AddRecordToBuffer(obsPtr,
+                                       newEntryTimestamp,
+                                       dataSample_GetNumeric(sampleRef));
+            break;
+
+        default:
+
+            buffEntryPtr = hub_MemAlloc(BufferEntryPool);
+            if (buffEntryPtr)
+            {
+                le_mem_AddRef(sampleRef);
+                buffEntryPtr->sampleRef = sampleRef;
+                buffEntryPtr->link = LE_SLS_LINK_INIT;
+                le_sls_Queue(&obsPtr->sampleList, &buffEntryPtr->link);
+
+                (obsPtr->count)++;
+                result = LE_OK;
+            }
+            else
+            {
+                LE_ERROR("Failed to allocate a buffer entry");
+                result = LE_NO_MEMORY;
+            }
+            break;
+    }
+
+    if (result == LE_OK)
+    {
+        (obsPtr->unsavedCount)++;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * If the number of entries in a given Observation's buffer is larger than the number given,
+ * discard enough of the oldest entries to correct that condition.
+ *
+ * Entries dropped to make room for new ones stay in the backup journal until it is compacted,
+ * but if the buffer is cut below its maximum size, then the journal must be rewritten so the
+ * discarded entries don't come back when it is restored.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TruncateBuffer
+(
+    Observation_t* obsPtr,
+    size_t count
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (obsPtr->count > count)
+    {
+        if (count < obsPtr->maxCount)
+        {
+            obsPtr->isJournalValid = false;
+        }
+
+        if (obsPtr->unsavedCount > count)
+        {
+            obsPtr->unsavedCount = count;
+        }
+    }
+
+    if (IsRingStorage(obsPtr))
+    {
+        while (obsPtr->count > count)
+        {
+            DropOldestRecord(obsPtr);
+        }
+
+        return;
+    }
+
+    while (obsPtr->count > count)
+    {
+        le_sls_Link_t* linkPtr = le_sls_Pop(&obsPtr->sampleList);
+        LE_ASSERT(linkPtr != NULL);
+
+        le_mem_Release(CONTAINER_OF(linkPtr, BufferEntry_t, link));
+
+        (obsPtr->count)--;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Update the value of a data sample by replacing it, if necessary
+ *
+ * Note: Even though this function uses dataSample_CreateBoolean and dataSample-CreateNumberic which
+ * may return NULL if dataSample pool is exhusted, because the previous sample is always released
+ * first before calling the createSample function, it is expected that creating sample is always
+ * successful.
+ *
+ * @return
+ *      Pointer to the updated sample.
+ */
+//--------------------------------------------------------------------------------------------------
+static dataSample_Ref_t UpdateSample
+(
+    dataSample_Ref_t sampleRef,
+    io_DataType_t dataType,
+    void *valuePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    dataSample_Ref_t sample = sampleRef;
+    double timestamp = dataSample_GetTimestamp(sampleRef);
+
+
+    switch (dataType)
+    {
+        case IO_DATA_TYPE_BOOLEAN:
+        {
+            bool value = *((double *)valuePtr) > 0.0 ? true : false;
+            if (dataSample_GetBoolean(sampleRef) != value)
+            {
+                le_mem_Release(sampleRef);
+                sample = dataSample_CreateBoolean(timestamp, value);
+            }
+            break;
+        }
+
+        case IO_DATA_TYPE_NUMERIC:
+        {
+            double value = *((double *)valuePtr);
+            if (dataSample_GetNumeric(sampleRef) != value)
+            {
+                le_mem_Release(sampleRef);
+                sample = dataSample_CreateNumeric(timestamp, value);
+            }
+        }
+
+        default:
+            break;
+    }
+
+    if (!sample)
+    {
+        LE_FATAL("UpdateSample Failed to allocate a new sample");
+    }
+    return sample;
+}
+
+
+#if LE_CONFIG_FILESYSTEM
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes a buffer load of data to a buffered file stream.
+ *
+ * On error, logs an error message.  It is up to the caller to close the file.
+ *
+ * @return true if successful, false if failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool WriteToStream
+(
+    FILE* file,
+    const void* buffPtr,
+    size_t buffSize
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t recordsWritten = fwrite(buffPtr, buffSize, 1, file);
+    if (recordsWritten != 1)
+    {
+        LE_CRIT("Failed to write (%m).");
+        return false;
+    }
+    BackupBytesWritten += buffSize;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a buffer load of data from a backup file.
+ *
+ * On error, logs an error message and closes the file.
+ *
+ * @return LE_OK if successful, LE_UNDERFLOW if the end of file was reached, LE_FAULT if failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadFromFile
+(
+    void* buffPtr,
+    size_t buffSize,
+    FILE* file
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t bytesRead = fread(buffPtr, 1, buffSize, file);
+
+    le_result_t result = LE_OK;
+
+    if (bytesRead < buffSize)
+    {
+        if (feof(file))
+        {
+            result = LE_UNDERFLOW;
+        }
+        else
+        {
+            LE_CRIT("Failed to read (%m).");
+            result = LE_FAULT;
+        }
+
+        le_atomFile_CancelStream(file);
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the data type code byte to be written into a backup file.
+ *
+ * @return the data type code byte.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t GetDataTypeCode
+(
+    io_DataType_t dataType
+)
+//--------------------------------------------------------------------------------------------------
+{
+    switch (dataType)
+    {
+        case IO_DATA_TYPE_TRIGGER:  return 't';
+        case IO_DATA_TYPE_BOOLEAN:  return 'b';
+        case IO_DATA_TYPE_NUMERIC:  return 'n';
+        case IO_DATA_TYPE_STRING:   return 's';
+        case IO_DATA_TYPE_JSON:     return 'j';
+    }
+
+    LE_FATAL("Invalid data type %d.", dataType);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the data type represented by the code byte read from a backup file.
+ *
+ * @return true if successful, false on error.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetDataTypeFromCode
+(
+    io_DataType_t* dataTypePtr, ///< [OUT] Ptr to where the result will be put on success.
+    uint8_t code
+)
+//--------------------------------------------------------------------------------------------------
+{
+    switch (code)
+    {
+        case 't': *dataTypePtr = IO_DATA_TYPE_TRIGGER; return true;
+        case 'b': *dataTypePtr = IO_DATA_TYPE_BOOLEAN; return true;
+        case 'n': *dataTypePtr = IO_DATA_TYPE_NUMERIC; return true;
+        case 's': *dataTypePtr = IO_DATA_TYPE_STRING;  return true;
+        case 'j': *dataTypePtr = IO_DATA_TYPE_JSON;    return true;
+    }
+
+    LE_CRIT("Invalid data type code %d.", (int)code);
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes the data samples for a given Observation to a given backup file, from a given position
+ * up to the newest sample.
+ *
+ * On error, logs an error message.  It is up to the caller to close the file.
+ *
+ * @return true if successful, false if failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool WriteSamplesToFile
+(
+    FILE* file,
+    Observation_t* obsPtr,
+    BufferPos_t pos     ///< Position of the oldest sample to write.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    io_DataType_t dataType = obsPtr->bufferedType;
+
+    bool havePos = IsValidBufferPos(&pos);
+
+    while (havePos)
+    {
+        // Write the timestamp.
+        double timestamp = GetBufferedTimestamp(&pos);
+        if (!WriteToStream(file, &timestamp, sizeof(timestamp)))
+        {
+            return false;
+        }
+
+        switch (dataType)
+        {
+            case IO_DATA_TYPE_TRIGGER:
+
+                // No Value.
+                break;
+
+            case IO_DATA_TYPE_BOOLEAN:
+            {
+                bool value = (GetBufferedNumber(&pos, dataType) != 0);
+                if (!WriteToStream(file, &value, sizeof(value)))
+                {
+                    return false;
+                }
+                break;
+            }
+            case IO_DATA_TYPE_NUMERIC:
+            {
+                double value = GetBufferedNumber(&pos, dataType);
+                if (!WriteToStream(file, &value, sizeof(value)))
+                {
+                    return false;
+                }
+                break;
+            }
+            case IO_DATA_TYPE_STRING:
+            {
+                const char* valuePtr = dataSample_GetString(pos.entryPtr->sampleRef);
+                uint32_t stringLen = strlen(valuePtr);
+                if (!WriteToStream(file, &stringLen, 4))
+                {
+                    return false;
+                }
+                if (!WriteToStream(file, valuePtr, stringLen))
+                {
+                    return false;
+                }
+                break;
+            }
+            case IO_DATA_TYPE_JSON:
+            {
+                const char* valuePtr = dataSample_GetJson(pos.entryPtr->sampleRef);
+                uint32_t stringLen = strlen(valuePtr);
+                if (!WriteToStream(file, &stringLen, 4))
+                {
+                    return false;
+                }
+                if (!WriteToStream(file, valuePtr, stringLen))
+                {
+                    return false;
+                }
+                break;
+            }
+        }
+
+        havePos = GetNextBufferEntry(obsPtr, &pos);
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the position of the n-th newest sample in an Observation's data sample buffer.
+ *
+ * @return true if successful, false if the buffer holds fewer than n samples or n is zero.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetNewerBufferEntry
+(
+    Observation_t* obsPtr,
+    size_t n,                   ///< 1 for the newest sample, 2 for the one before that, etc.
+    BufferPos_t* posPtr         ///< [OUT] Position of the sample.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((n == 0) || (n > obsPtr->count))
+    {
+        const BufferPos_t emptyPos = BUFFER_POS_INIT;
+        *posPtr = emptyPos;
+        return false;
+    }
+
+    if (IsRingStorage(obsPtr))
+    {
+        // Work back from the tail block so only the blocks being written out are visited.
+        RingBlock_t* blockPtr = &obsPtr->tailBlockPtr->header;
+        size_t index = obsPtr->tailIndex;
+
+        while (n > index)
+        {
+            n -= index;
+            blockPtr = CONTAINER_OF(le_dls_PeekPrev(&obsPtr->blockList, &blockPtr->link),
+                                    RingBlock_t,
+                                    link);
+            index = SAMPLE_BLOCK_RECORDS;
+        }
+
+        posPtr->entryPtr = NULL;
+        posPtr->blockPtr = blockPtr;
+        posPtr->index = index - n;
+        posPtr->seq = blockPtr->firstSeq + posPtr->index;
+
+        return true;
+    }
+
+    bool havePos = GetOldestBufferEntry(obsPtr, posPtr);
+
+    for (size_t i = obsPtr->count - n; havePos && (i > 0); i--)
+    {
+        havePos = GetNextBufferEntry(obsPtr, posPtr);
+    }
+
+    return havePos;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes a backup journal segment containing a given number of the newest data samples for a
+ * given Observation to a given backup file.
+ *
+ * On error, logs an error message.  It is up to the caller to close the file.
+ *
+ * @return true if successful, false if failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool WriteJournalSegment
+(
+    FILE* file,
+    Observation_t* obsPtr,
+    size_t recordCount  ///< Number of the newest samples to write.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t header[2] = { (uint32_t)obsPtr->count, (uint32_t)recordCount };
+    if (!WriteToStream(file, header, sizeof(header)))
+    {
+        return false;
+    }
+
+    BufferPos_t pos;
+    if (!GetNewerBufferEntry(obsPtr, recordCount, &pos))
+    {
+        return true;
+    }
+
+    return WriteSamplesToFile(file, obsPtr, pos);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a data sample record from a given backup file.
+ *
+ * On error, logs an error message and closes the file.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_UNDERFLOW if the end of file was reached before the record (the file is closed).
+ *      - LE_OUT_OF_RANGE if the end of file was reached part way through the record.
+ *      - LE_FAULT if failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadRecordFromFile
+(
+    Observation_t* obsPtr,
+    FILE* file,
+    dataSample_Ref_t* sampleRefPtr  ///< [OUT] New Data Sample holding the record.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    dataSample_Ref_t dataSample = NULL;
+
+    // Read the timestamp.
+    double timestamp;
+    le_result_t result = ReadFromFile(&timestamp, sizeof(timestamp), file);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    switch (obsPtr->bufferedType)
+    {
+        case IO_DATA_TYPE_TRIGGER:
+
+            // No Value.
+            dataSample = dataSample_CreateTrigger(timestamp);
+            break;
+
+        case IO_DATA_TYPE_BOOLEAN:
+        {
+            bool value;
+            result = ReadFromFile(&value, sizeof(value), file);
+            if (result != LE_OK)
+            {
+                LE_CRIT("Failed to read boolean value.");
+                goto error;
+            }
+            dataSample = dataSample_CreateBoolean(timestamp, value);
+            break;
+        }
+        case IO_DATA_TYPE_NUMERIC:
+        {
+            double value;
+            result = ReadFromFile(&value, sizeof(value), file);
+            if (result != LE_OK)
+            {
+                LE_CRIT("Failed to read numeric value.");
+                goto error;
+            }
+            dataSample = dataSample_CreateNumeric(timestamp, value);
+            break;
+        }
+        case IO_DATA_TYPE_STRING:
+        {
+            char value[HUB_MAX_STRING_BYTES];
+
+            uint32_t stringLen;
+            result = ReadFromFile(&stringLen, 4, file);
+            if (result != LE_OK)
+            {
+                LE_CRIT("Failed to read string length.");
+                goto error;
+            }
+            if (stringLen > (sizeof(value) - 1))
+            {
+                LE_CRIT("String length (%zu) is larger than permitted (%zu).",
+                        (size_t)stringLen,
+                        sizeof(value) - 1);
+                le_atomFile_CancelStream(file);
+                return LE_FAULT;
+            }
+            result = ReadFromFile(value, stringLen, file);
+            if (result != LE_OK)
+            {
+                LE_CRIT("Failed to read string value of length %zu.", (size_t)stringLen);
+                goto error;
+            }
+            value[stringLen] = '\0';
+            dataSample = dataSample_CreateString(timestamp, value);
+            break;
+        }
+        case IO_DATA_TYPE_JSON:
+        {
+            char value[HUB_MAX_STRING_BYTES];
+
+            uint32_t stringLen;
+            result = ReadFromFile(&stringLen, 4, file);
+            if (result != LE_OK)
+            {
+                LE_CRIT("Failed to read JSON object length.");
+                goto error;
+            }
+            if (stringLen > (sizeof(value) - 1))
+            {
+                LE_CRIT("JSON string length (%zu) is larger than permitted (%zu).",
+                        (size_t)stringLen,
+                        sizeof(value) - 1);
+                le_atomFile_CancelStream(file);
+                return LE_FAULT;
+            }
+            result = ReadFromFile(value, stringLen, file);
+            if (result != LE_OK)
+            {
+                LE_CRIT("Failed to read JSON value of length %zu.", (size_t)stringLen);
+                goto error;
+            }
+            value[stringLen] = '\0';
+            dataSample = dataSample_CreateJson(timestamp, value);
+            break;
+        }
+    }
+
+    if (!dataSample)
+    {
+        // Failed to allocate a data sample and therefore cannot proceed with read.
+        LE_ERROR("Failed to allocate dataSample for value read from file");
+        le_atomFile_CancelStream(file);
+        return LE_FAULT;
+    }
+
+    *sampleRefPtr = dataSample;
+    return LE_OK;
+
+error:
+
+    // The file has already been closed by ReadFromFile().
+    return ((result == LE_UNDERFLOW) ? LE_OUT_OF_RANGE : result);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads all the data samples from a given version 0 backup file and adds them to a given
+ * Observation's data sample buffer.  Closes the file when done.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadSamplesFromFile
+(
+    Observation_t* obsPtr,
+    FILE* file,
+    size_t count    ///< The expected number of samples to read.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (count == 0)
+    {
+        le_atomFile_CancelStream(file);
+        return;
+    }
+
+    io_DataType_t dataType = obsPtr->bufferedType;
+
+    // The newest sample read so far.  It isn't added to the buffer until we know it isn't the
+    // last (newest) sample, because that one gets pushed to the Observation instead, once we
+    // confirm that the file doesn't have more than expected in it (which would mean that all these
+    // samples are probably corrupt and need to be discarded).
+    dataSample_Ref_t dataSample = NULL;
+
+    for (;;)
+    {
+        dataSample_Ref_t newSample;
+        le_result_t result = ReadRecordFromFile(obsPtr, file, &newSample);
+        if (result != LE_OK)
+        {
+            if (result == LE_UNDERFLOW)
+            {
+                // End of file reached, check that we've received all we should.
+                if (count == 0)
+                {
+                    // The file contained exactly the number of samples we expected.
+                    // The last data sample read from the file (which is the newest)
+                    // should be pushed to the Observation so it becomes the current value.
+                    res_Push(&obsPtr->resource, dataType, "", dataSample);
+                    return;
+                }
+                else
+                {
+                    LE_CRIT("Backup file was truncated. Expected %zu more samples.", count);
+                }
+            }
+
+            goto error;
+        }
+
+        // We succeeded in reading another sample, so we had better be expecting more samples.
+        if (count == 0)
+        {
+            LE_CRIT("Backup file contains extra samples.");
+            le_mem_Release(newSample);
+            le_atomFile_CancelStream(file);
+            goto error;
+        }
+
+        count--;
+
+        if (dataSample != NULL)
+        {
+            // The buffer takes its own reference on (or copy of) the sample.
+            le_result_t addResult = AddToBuffer(obsPtr, dataSample);
+            le_mem_Release(dataSample);
+            dataSample = newSample;
+            if (addResult != LE_OK)
+            {
+                le_atomFile_CancelStream(file);
+                goto error;
+            }
+        }
+        else
+        {
+            dataSample = newSample;
+        }
+    }
+
+error:
+
+    if (dataSample != NULL)
+    {
+        le_mem_Release(dataSample);
+    }
+
+    // On error, dump the buffer contents in case we read some corrupted samples from the file.
+    TruncateBuffer(obsPtr, 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replays the segments of a given version 1 backup file (journal) into a given Observation's
+ * data sample buffer.  Closes the file when done.
+ *
+ * If the last segment was cut short (e.g., by a power failure part way through a backup), the
+ * samples that were completely written are kept, and the journal will be compacted on the next
+ * backup so that nothing is appended after the partial segment.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadJournalFromFile
+(
+    Observation_t* obsPtr,
+    FILE* file
+)
+//--------------------------------------------------------------------------------------------------
+{
+    io_DataType_t dataType = obsPtr->bufferedType;
+    bool isMaxCountSet = (obsPtr->maxCount > 0);
+    size_t recordCount = 0;
+    bool isComplete = true;
+
+    // The newest sample read so far.  As with version 0 files, it gets pushed to the Observation
+    // to become the current value, rather than being added to the buffer directly.
+    dataSample_Ref_t dataSample = NULL;
+
+    for (;;)
+    {
+        // Read the segment header, telling a clean end of file from a partial header.
+        uint32_t header[2];
+        size_t bytesRead = fread(header, 1, sizeof(header), file);
+        if (bytesRead < sizeof(header))
+        {
+            if (ferror(file))
+            {
+                LE_CRIT("Failed to read (%m).");
+                le_atomFile_CancelStream(file);
+                goto error;
+            }
+
+            if (bytesRead > 0)
+            {
+                LE_WARN("Backup journal segment header was truncated.");
+                isComplete = false;
+            }
+
+            le_atomFile_CancelStream(file);
+            break;
+        }
+
+        size_t bufferCount = header[0];
+
+        // The maximum count must be at least the number in the buffer.
+        if ((!isMaxCountSet) && (obsPtr->maxCount < bufferCount))
+        {
+            obsPtr->maxCount = bufferCount;
+        }
+
+        if ((bufferCount == 0) && (dataSample != NULL))
+        {
+            le_mem_Release(dataSample);
+            dataSample = NULL;
+        }
+        TruncateBuffer(obsPtr, (bufferCount > 0) ? (bufferCount - 1) : 0);
+
+        for (size_t i = header[1]; i > 0; i--)
+        {
+            dataSample_Ref_t newSample;
+            le_result_t result = ReadRecordFromFile(obsPtr, file, &newSample);
+            if ((result == LE_UNDERFLOW) || (result == LE_OUT_OF_RANGE))
+            {
+                LE_WARN("Backup journal segment was truncated. Expected %zu more samples.", i);
+                isComplete = false;
+                goto done;
+            }
+            else if (result != LE_OK)
+            {
+                goto error;
+            }
+
+            recordCount++;
+
+            if (dataSample != NULL)
+            {
+                // The buffer takes its own reference on (or copy of) the sample.
+                le_result_t addResult = AddToBuffer(obsPtr, dataSample);
+                le_mem_Release(dataSample);
+                dataSample = newSample;
+                if (addResult != LE_OK)
+                {
+                    le_atomFile_CancelStream(file);
+                    goto error;
+                }
+
+                // Only keep as many of the older samples as fit with the newest one.
+                TruncateBuffer(obsPtr, (bufferCount > 0) ? (bufferCount - 1) : 0);
+            }
+            else
+            {
+                dataSample = newSample;
+            }
+        }
+    }
+
+done:
+
+    if (dataSample != NULL)
+    {
+        res_Push(&obsPtr->resource, dataType, "", dataSample);
+    }
+
+    // Everything in the buffer is now in the journal.
+    obsPtr->unsavedCount = 0;
+    obsPtr->journalCount = recordCount;
+    obsPtr->isJournalValid = isComplete;
+    return;
+
+error:
+
+    if (dataSample != NULL)
+    {
+        le_mem_Release(dataSample);
+    }
+
+    // On error, dump the buffer contents in case we read some corrupted samples from the file.
+    TruncateBuffer(obsPtr, 0);
+}
+
+
+#if LE_CONFIG_LINUX
+//--------------------------------------------------------------------------------------------------
+/**
+ * Restore a given Observation's data sample buffer from a memory-mapped version 1 backup file
+ * holding trigger, Boolean or numeric samples.
+ *
+ * The records of these types have a fixed size, so the journal can be checked in one pass over
+ * the segment headers, and then the records are loaded straight into the ring storage without
+ * creating a Data Sample for each one.  As with the stream-based restore, the newest sample is
+ * pushed to the Observation to become its current value.
+ *
+ * @return
+ *      - LE_OK if the file was handled (even if its contents had to be discarded).
+ *      - LE_UNSUPPORTED if the file's version or data type needs the stream-based restore.
+ *      - LE_FAULT if the file couldn't be mapped.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t LoadMappedBackup
+(
+    Observation_t* obsPtr,
+    const char* path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        return LE_FAULT;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) == -1) || (st.st_size < 2))
+    {
+        close(fd);
+        return LE_FAULT;
+    }
+
+    size_t size = st.st_size;
+    const uint8_t* basePtr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (basePtr == MAP_FAILED)
+    {
+        LE_WARN("Unable to map '%s' (%m).", path);
+        return LE_FAULT;
+    }
+
+    io_DataType_t dataType;
+    size_t recordSize = sizeof(double);
+
+    if ((basePtr[0] != 1) || (!GetDataTypeFromCode(&dataType, basePtr[1])))
+    {
+        munmap((void*)basePtr, size);
+        return LE_UNSUPPORTED;
+    }
+
+    switch (dataType)
+    {
+        case IO_DATA_TYPE_TRIGGER:  break;
+        case IO_DATA_TYPE_BOOLEAN:  recordSize += sizeof(bool);   break;
+        case IO_DATA_TYPE_NUMERIC:  recordSize += sizeof(double); break;
+
+        default:
+            munmap((void*)basePtr, size);
+            return LE_UNSUPPORTED;
+    }
+
+    // Walk the segment headers to find how many complete records there are.
+    size_t totalCount = 0;
+    bool isComplete = true;
+    size_t offset = 2;
+
+    while (offset < size)
+    {
+        uint32_t header[2];
+        if ((size - offset) < sizeof(header))
+        {
+            LE_WARN("Backup journal segment header was truncated.");
+            isComplete = false;
+            break;
+        }
+        memcpy(header, basePtr + offset, sizeof(header));
+        offset += sizeof(header);
+
+        size_t availableCount = (size - offset) / recordSize;
+        if (header[1] > availableCount)
+        {
+            LE_WARN("Backup journal segment was truncated. Expected %zu more samples.",
+                    (size_t)header[1] - availableCount);
+            totalCount += availableCount;
+            isComplete = false;
+            break;
+        }
+
+        totalCount += header[1];
+        offset += header[1] * recordSize;
+    }
+
+    if (obsPtr->bufferedType != dataType)
+    {
+        TruncateBuffer(obsPtr, 0);
+
+        obsPtr->bufferedType = dataType;
+    }
+
+    bool isMaxCountSet = (obsPtr->maxCount > 0);
+    size_t bufferCount = 0;
+    size_t loadedCount = 0;
+    double timestamp = NAN;
+    double value = NAN;
+
+    // Load all but the newest record into the buffer, keeping only as many of the newest as each
+    // segment says were buffered.  Segments are only appended with at least one record, so the
+    // newest record is always in the last segment that has any.
+    offset = 2;
+
+    while (loadedCount < totalCount)
+    {
+        uint32_t header[2];
+        memcpy(header, basePtr + offset, sizeof(header));
+        offset += sizeof(header);
+
+        bufferCount = header[0];
+
+        // The maximum count must be at least the number in the buffer.
+        if ((!isMaxCountSet) && (obsPtr->maxCount < bufferCount))
+        {
+            obsPtr->maxCount = bufferCount;
+        }
+
+        for (size_t i = header[1]; (i > 0) && (loadedCount < totalCount); i--)
+        {
+            // The previous record isn't the newest, so it goes into the buffer.
+            if (loadedCount > 0)
+            {
+                if (AddRecordToBuffer(obsPtr, timestamp, value) != LE_OK)
+                {
+                    goto error;
+                }
+                TruncateBuffer(obsPtr, bufferCount);
+            }
+
+            const uint8_t* recordPtr = basePtr + offset;
+            offset += recordSize;
+
+            double newTimestamp;
+            memcpy(&newTimestamp, recordPtr, sizeof(newTimestamp));
+            if ((loadedCount > 0) && (newTimestamp < timestamp))
+            {
+                LE_CRIT("Backup file has samples out of order (%lf < %lf).",
+                        newTimestamp,
+                        timestamp);
+                goto error;
+            }
+            timestamp = newTimestamp;
+
+            if (dataType == IO_DATA_TYPE_BOOLEAN)
+            {
+                value = (recordPtr[sizeof(double)] != 0) ? 1.0 : 0.0;
+            }
+            else if (dataType == IO_DATA_TYPE_NUMERIC)
+            {
+                memcpy(&value, recordPtr + sizeof(double), sizeof(value));
+            }
+
+            loadedCount++;
+        }
+    }
+
+    munmap((void*)basePtr, size);
+
+    if (loadedCount > 0)
+    {
+        // Make room for the newest, then push it to the Observation so it becomes the current
+        // value.
+        TruncateBuffer(obsPtr, (bufferCount > 0) ? (bufferCount - 1) : 0);
+
+        dataSample_Ref_t dataSample;
+        switch (dataType)
+        {
+            case IO_DATA_TYPE_BOOLEAN:
+                dataSample = dataSample_CreateBoolean(timestamp, (value != 0));
+                break;
+
+            case IO_DATA_TYPE_NUMERIC:
+                dataSample = dataSample_CreateNumeric(timestamp, value);
+                break;
+
+            default:
+                dataSample = dataSample_CreateTrigger(timestamp);
+                break;
+        }
+
+        if (dataSample == NULL)
+        {
+            LE_ERROR("Failed to allocate dataSample for value read from file");
+            TruncateBuffer(obsPtr, 0);
+            return LE_OK;
+        }
+
+        res_Push(&obsPtr->resource, dataType, "", dataSample);
+    }
+
+    // Everything in the buffer is now in the journal.
+    obsPtr->unsavedCount = 0;
+    obsPtr->journalCount = totalCount;
+    obsPtr->isJournalValid = isComplete;
+
+    return LE_OK;
+
+error:
+
+    munmap((void*)basePtr, size);
+
+    // Dump the buffer contents in case we loaded some corrupted samples from the file.
+    TruncateBuffer(obsPtr, 0);
+
+    return LE_OK;
+}
+#endif /* end LE_CONFIG_LINUX */
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Restore an Observation's data buffer from non-volatile backup, if one exists.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RestoreBackup
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // If there's no backup directory yet, then we know there are no backups, so don't
+    // try opening one (which would result in an error message in the logs because the lock file
+    // can't be created).
+    struct stat st = {0};
+    if (stat(BACKUP_DIR, &st) == -1)
+    {
+        LE_DEBUG("Backup directory '" BACKUP_DIR "' not found. (%m)");
+        return;
+    }
+
+    char path[MAX_BACKUP_FILE_PATH_BYTES];
+    if (GetBackupFilePath(path, sizeof(path), obsPtr) != LE_OK)
+    {
+        return;
+    }
+
+    LE_INFO("Loading observation buffer from file '%s'.", path);
+
+#if LE_CONFIG_LINUX
+    // Try the fast path first.  If the file can't be handled that way, fall back to reading it
+    // as a stream.
+    if (LoadMappedBackup(obsPtr, path) == LE_OK)
+    {
+        return;
+    }
+#endif
+
+    // Open the file for reading.
+    le_result_t result;
+    FILE* file = le_atomFile_OpenStream(path, LE_FLOCK_READ, &result);
+    if (result != LE_OK)
+    {
+        LE_DEBUG("Unable to open '%s' for reading (%s).", path, LE_RESULT_TXT(result));
+        return;
+    }
+
+    // Read the version byte.
+    uint8_t byte;
+    if (ReadFromFile(&byte, 1, file) != LE_OK)
+    {
+        LE_ERROR("Failed to read version byte.");
+        return;
+    }
+    if (byte > 1)
+    {
+        LE_CRIT("Backup file format version %d unrecognized.", (int)byte);
+        le_atomFile_CancelStream(file);
+        return;
+    }
+    uint8_t version = byte;
+
+    // Read the data type code.
+    if (ReadFromFile(&byte, 1, file) != LE_OK)
+    {
+        LE_ERROR("Failed to read data type code.");
+        return;
+    }
+    io_DataType_t dataType;
+    if (!GetDataTypeFromCode(&dataType, byte))
+    {
+        le_atomFile_CancelStream(file);
+        return;
+    }
+    if (obsPtr->bufferedType != dataType)
+    {
+        TruncateBuffer(obsPtr, 0);
+
+        obsPtr->bufferedType = dataType;
+    }
+
+    if (version == 1)
+    {
+        ReadJournalFromFile(obsPtr, file);
+        return;
+    }
+
+    // Read the number of samples.
+    uint32_t count;
+    if (ReadFromFile(&count, 4, file) != LE_OK)
+    {
+        LE_ERROR("Failed to read number of samples.");
+        return;
+    }
+
+    // The maximum count must be at least the number we read.
+    if (obsPtr->maxCount == 0)
+    {
+        obsPtr->maxCount = count;
+    }
+    // NOTE: Don't enable backups, though, because we don't know the frequency to choose
+    //       and flash wear can permanently damage a device.
+
+    // Read all the data samples from the file.
+    ReadSamplesFromFile(obsPtr, file, count);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compact the backup journal of a given Observation by replacing it with a single segment holding
+ * the whole data sample buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CompactBackup
+(
+    Observation_t* obsPtr,
+    const char* path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Open the file for writing, truncating it to zero length to start.
+    le_result_t result;
+    FILE* file = le_atomFile_CreateStream(path,
+                                          LE_FLOCK_WRITE,
+                                          LE_FLOCK_REPLACE_IF_EXIST,
+                                          0600,
+                                          &result);
+    if (result != LE_OK)
+    {
+        LE_CRIT("Unable to open file '%s' for writing (%s).", path, LE_RESULT_TXT(result));
+        return;
+    }
+
+    // Write in the version byte and the data type code, then all the data samples.
+    uint8_t header[2] = { 1, GetDataTypeCode(obsPtr->bufferedType) };
+    if (   (!WriteToStream(file, header, sizeof(header)))
+        || (!WriteJournalSegment(file, obsPtr, obsPtr->count))  )
+    {
+        le_atomFile_CancelStream(file);
+        return;
+    }
+
+    // Commit the file.
+    result = le_atomFile_CloseStream(file);
+    if (result != LE_OK)
+    {
+        LE_CRIT("Failed to save '%s' (%s).", path, LE_RESULT_TXT(result));
+        return;
+    }
+
+    obsPtr->unsavedCount = 0;
+    obsPtr->journalCount = obsPtr->count;
+    obsPtr->isJournalValid = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append the samples added to a given Observation's data sample buffer since the last backup to
+ * the backup journal.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AppendBackup
+(
+    Observation_t* obsPtr,
+    const char* path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    FILE* file = fopen(path, "ab");
+    if (file == NULL)
+    {
+        LE_CRIT("Unable to open file '%s' for appending (%m).", path);
+        obsPtr->isJournalValid = false;
+        return;
+    }
+
+    bool isOk = WriteJournalSegment(file, obsPtr, obsPtr->unsavedCount);
+
+    if (isOk && (fflush(file) != 0))
+    {
+        LE_CRIT("Failed to write (%m).");
+        isOk = false;
+    }
+#if LE_CONFIG_LINUX
+    if (isOk && (fsync(fileno(file)) != 0))
+    {
+        LE_CRIT("Failed to sync (%m).");
+        isOk = false;
+    }
+#endif
+    if ((fclose(file) != 0) && isOk)
+    {
+        LE_CRIT("Failed to close (%m).");
+        isOk = false;
+    }
+
+    if (!isOk)
+    {
+        // The journal may now end with a partial segment, so it must be rewritten next time.
+        LE_CRIT("Failed to append to '%s'.", path);
+        obsPtr->isJournalValid = false;
+        return;
+    }
+
+    obsPtr->journalCount += obsPtr->unsavedCount;
+    obsPtr->unsavedCount = 0;
+}
+#endif /* end LE_CONFIG_FILESYSTEM */
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Complete a deferred restore of a given Observation's data buffer, if one is pending.  This must
+ * be done before the buffer is used.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CompleteRestore
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+#if LE_CONFIG_FILESYSTEM
+    if (obsPtr->isRestorePending)
+    {
+        obsPtr->isRestorePending = false;
+#ifdef DHUB_LAZY_RESTORE
+        le_dls_Remove(&RestoreQueue, &obsPtr->restoreLink);
+#endif
+
+        // Restoring pushes the newest buffered sample, which mustn't count against the minPeriod
+        // filter for the push that may have triggered the restore.
+        uint32_t lastPushTime = obsPtr->lastPushTime;
+
+        RestoreBackup(obsPtr);
+        CheckSpilledType(obsPtr);
+
+        obsPtr->lastPushTime = lastPushTime;
+
+        // The maximum count may have been configured by now.
+        if (obsPtr->maxCount > 0)
+        {
+            TruncateBuffer(obsPtr, obsPtr->maxCount);
+        }
+    }
+#else
+    LE_UNUSED(obsPtr);
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Perform a backup to non-volatile storage of an observation's data sample buffer.
+ *
+ * Normally, only the samples added since the last backup are appended to the backup journal.
+ * The journal is compacted instead if it can't be appended to, or if more of its records have
+ * been dropped from the buffer than are still in it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Backup
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    CompleteRestore(obsPtr);
+
+    // Update the time of last backup.
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+    obsPtr->lastBackupTime = now.sec;
+
+#if LE_CONFIG_FILESYSTEM
+    // Get the backup file path.
+    char path[MAX_BACKUP_FILE_PATH_BYTES];
+    if (GetBackupFilePath(path, sizeof(path), obsPtr) != LE_OK)
+    {
+        return;
+    }
+
+    LE_DEBUG("Backing up to '%s'...", path);
+
+    // Create the backup directory, if it doesn't exist already.
+    struct stat st = {0};
+    if (stat(BACKUP_DIR, &st) == -1)
+    {
+        LE_DEBUG("Creating directory '" BACKUP_DIR "'.");
+
+        if (mkdir(BACKUP_DIR, 0700) == -1)
+        {
+            LE_CRIT("Unable to create directory '" BACKUP_DIR "' (%m).");
+            return;
+        }
+
+        obsPtr->isJournalValid = false;
+    }
+
+    if (   (!obsPtr->isJournalValid)
+        || ((obsPtr->journalCount + obsPtr->unsavedCount) > (2 * obsPtr->count))  )
+    {
+        CompactBackup(obsPtr, path);
+    }
+    else if (obsPtr->unsavedCount > 0)
+    {
+        AppendBackup(obsPtr, path);
+    }
+#else /* !LE_CONFIG_FILESYSTEM */
+    // TODO: implement non-volatile storage without a filesystem.
+#endif /* end !LE_CONFIG_FILESYSTEM */
+
+    LE_DEBUG("Backup complete.");
+}
+
+
+#if LE_CONFIG_LINUX
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the unsaved records of a segment of an Observation's spilled history to the segment's
+ * file, creating the file if the segment has no saved records yet.  The segment's saved count
+ * tells how many were written.
+ *
+ * @return The number of bytes written.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t WriteSpillRecords
+(
+    Observation_t* obsPtr,
+    SpillSegment_t* segPtr,
+    size_t stagedIndex  ///< Index of the segment's first unsaved record in the spill stage.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const SpillStage_t* stagePtr = obsPtr->spillStagePtr;
+    bool isNewest = (&segPtr->link == le_dls_PeekTail(&obsPtr->spillList));
+    size_t byteCount = 0;
+    int fd = (isNewest ? obsPtr->spillFd : -1);
+
+    if (fd == -1)
+    {
+        // Create the backup directory, if it doesn't exist already.
+        struct stat st = {0};
+        if ((stat(BACKUP_DIR, &st) == -1) && (mkdir(BACKUP_DIR, 0700) == -1))
+        {
+            LE_CRIT("Unable to create directory '" BACKUP_DIR "' (%m).");
+            return 0;
+        }
+
+        char path[MAX_SPILL_FILE_PATH_BYTES];
+        if (GetSpillFilePath(path, sizeof(path), obsPtr, segPtr->slot) != LE_OK)
+        {
+            return 0;
+        }
+
+        int flags = ((segPtr->savedCount == 0) ? (O_WRONLY | O_CREAT | O_TRUNC) : O_WRONLY);
+        fd = open(path, flags, 0600);
+        if (fd == -1)
+        {
+            LE_ERROR("Failed to open '%s' (%m).", path);
+            return 0;
+        }
+
+        if (segPtr->savedCount == 0)
+        {
+            const uint8_t header[SPILL_HEADER_BYTES] =
+                { SPILL_FILE_VERSION, GetDataTypeCode(segPtr->dataType) };
+
+            if (pwrite(fd, header, sizeof(header), 0) != sizeof(header))
+            {
+                LE_ERROR("Failed to write to '%s' (%m).", path);
+                close(fd);
+                unlink(path);
+                return 0;
+            }
+            byteCount += sizeof(header);
+        }
+    }
+
+    size_t recordBytes = GetSpillRecordBytes(segPtr->dataType);
+    bool isOk = true;
+
+    // Encode and write the records a Sample Block's worth at a time.
+    while (isOk && (segPtr->savedCount < segPtr->count))
+    {
+        size_t count = segPtr->count - segPtr->savedCount;
+        if (count > SAMPLE_BLOCK_RECORDS)
+        {
+            count = SAMPLE_BLOCK_RECORDS;
+        }
+
+        uint8_t bytes[SAMPLE_BLOCK_RECORDS * (sizeof(double) + sizeof(double))];
+
+        for (size_t i = 0; i < count; i++)
+        {
+            uint8_t* recordPtr = bytes + (i * recordBytes);
+
+            memcpy(recordPtr, &stagePtr->timestamps[stagedIndex + i], sizeof(double));
+            if (segPtr->dataType == IO_DATA_TYPE_BOOLEAN)
+            {
+                recordPtr[sizeof(double)] = (stagePtr->values[stagedIndex + i] != 0);
+            }
+            else if (segPtr->dataType == IO_DATA_TYPE_NUMERIC)
+            {
+                memcpy(recordPtr + sizeof(double),
+                       &stagePtr->values[stagedIndex + i],
+                       sizeof(double));
+            }
+        }
+
+        ssize_t result = pwrite(fd,
+                                bytes,
+                                count * recordBytes,
+                                SPILL_HEADER_BYTES + (segPtr->savedCount * recordBytes));
+        if (result != (ssize_t)(count * recordBytes))
+        {
+            LE_ERROR("Failed to write spilled history (%m).");
+            isOk = false;
+        }
+        else
+        {
+            segPtr->savedCount += count;
+            stagedIndex += count;
+            byteCount += count * recordBytes;
+        }
+    }
+
+    // Keep the newest segment's file open for the next records.
+    if (isOk && isNewest)
+    {
+        obsPtr->spillFd = fd;
+    }
+    else
+    {
+        close(fd);
+        if (isNewest)
+        {
+            obsPtr->spillFd = -1;
+        }
+    }
+
+    return byteCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the records staged for a given Observation to its spilled history segment files, then
+ * release the stage.  Records that can't be written are discarded, and their segment is closed
+ * so that the next records go into a new one.
+ *
+ * @return The number of bytes written.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t FlushSpillStage
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t byteCount = 0;
+    size_t stagedIndex = 0;
+
+    if (obsPtr->spillStagePtr->droppedCount > 0)
+    {
+        LE_WARN("Dropped %" PRIuS " evicted samples; spilled history writes fell behind.",
+                obsPtr->spillStagePtr->droppedCount);
+    }
+
+    // The stage holds the unsaved records of the newest segments, oldest first.
+    le_dls_Link_t* linkPtr = le_dls_Peek(&obsPtr->spillList);
+    while (linkPtr != NULL)
+    {
+        SpillSegment_t* segPtr = CONTAINER_OF(linkPtr, SpillSegment_t, link);
+        size_t unsavedCount = segPtr->count - segPtr->savedCount;
+
+        if (unsavedCount > 0)
+        {
+            byteCount += WriteSpillRecords(obsPtr, segPtr, stagedIndex);
+
+            if (segPtr->savedCount < segPtr->count)
+            {
+                segPtr->count = segPtr->savedCount;
+                segPtr->isClosed = true;
+            }
+            stagedIndex += unsavedCount;
+        }
+
+        linkPtr = le_dls_PeekNext(&obsPtr->spillList, linkPtr);
+    }
+
+    ReleaseSpillStage(obsPtr);
+
+    return byteCount;
+}
+#endif /* end LE_CONFIG_LINUX */
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start the backup timer to expire when the first Observation in the BackupQueue is due, or the
+ * records in the SpillQueue are, or after a given delay if that is later.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartBackupTimer
+(
+    uint32_t minDelay   ///< Minimum delay (in milliseconds).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_timer_Stop(BackupTimer);
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&BackupQueue);
+    bool isSpillPending = !le_dls_IsEmpty(&SpillQueue);
+    if ((linkPtr == NULL) && !isSpillPending)
+    {
+        return;
+    }
+
+    uint32_t dueTime = SpillDueTime;
+    if (linkPtr != NULL)
+    {
+        uint32_t backupDueTime = CONTAINER_OF(linkPtr, Observation_t, backupLink)->backupDueTime;
+        if ((!isSpillPending) || (backupDueTime < dueTime))
+        {
+            dueTime = backupDueTime;
+        }
+    }
+
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+    uint32_t delay = 0;
+
+    if (dueTime > now.sec)
+    {
+        delay = (dueTime - now.sec) * 1000;
+    }
+    if (delay < minDelay)
+    {
+        delay = minDelay;
+    }
+
+    LE_ASSERT(le_timer_SetMsInterval(BackupTimer, delay) == LE_OK);
+    LE_ASSERT(le_timer_Start(BackupTimer) == LE_OK);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a given Observation from the BackupQueue, if it is in it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UnscheduleBackup
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (obsPtr->isBackupScheduled)
+    {
+        le_dls_Remove(&BackupQueue, &obsPtr->backupLink);
+        obsPtr->isBackupScheduled = false;
+
+        if (!IsBackupPassRunning)
+        {
+            StartBackupTimer(0);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Schedule a backup of a given Observation's data sample buffer, replacing any backup of it that
+ * was already scheduled.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ScheduleBackup
+(
+    Observation_t* obsPtr,
+    uint32_t dueTime    ///< When the backup is due (seconds, relative clock).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (obsPtr->isBackupScheduled)
+    {
+        le_dls_Remove(&BackupQueue, &obsPtr->backupLink);
+    }
+
+    obsPtr->backupDueTime = dueTime;
+    obsPtr->isBackupScheduled = true;
+
+    // Most backups are due after those already queued, so search from the back.
+    le_dls_Link_t* linkPtr = le_dls_PeekTail(&BackupQueue);
+    while (   (linkPtr != NULL)
+           && (CONTAINER_OF(linkPtr, Observation_t, backupLink)->backupDueTime > dueTime))
+    {
+        linkPtr = le_dls_PeekPrev(&BackupQueue, linkPtr);
+    }
+
+    if (linkPtr == NULL)
+    {
+        le_dls_Stack(&BackupQueue, &obsPtr->backupLink);
+    }
+    else
+    {
+        le_dls_AddAfter(&BackupQueue, linkPtr, &obsPtr->backupLink);
+    }
+
+    if ((!IsBackupPassRunning) && (le_dls_Peek(&BackupQueue) == &obsPtr->backupLink))
+    {
+        StartBackupTimer(0);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer expiry handler function for the backup timer.
+ *
+ * Writes the staged spilled history records and the backups that are due, in order of their due
+ * time, up to DHUB_BACKUP_MAX_FILES_PER_TICK files and DHUB_BACKUP_BYTES_PER_SEC bytes.  Each
+ * Observation's staged records count as one file.  Any that are left over are written a second
+ * later.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BackupTimerExpired
+(
+    le_timer_Ref_t timer
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(timer);
+
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+    size_t startBytes = BackupBytesWritten;
+    size_t fileCount = 0;
+    bool isBudgetSpent = false;
+
+    IsBackupPassRunning = true;
+
+    for (;;)
+    {
+        size_t byteCount = BackupBytesWritten - startBytes;
+        bool isFileBudgetSpent = (   (DHUB_BACKUP_MAX_FILES_PER_TICK > 0)
+                                  && (fileCount >= DHUB_BACKUP_MAX_FILES_PER_TICK));
+        bool isByteBudgetSpent = (   (DHUB_BACKUP_BYTES_PER_SEC > 0)
+                                  && (byteCount >= DHUB_BACKUP_BYTES_PER_SEC));
+
+        le_dls_Link_t* linkPtr = le_dls_Peek(&BackupQueue);
+        Observation_t* obsPtr = ((linkPtr == NULL) ?
+                                 NULL : CONTAINER_OF(linkPtr, Observation_t, backupLink));
+        bool isBackupDue = ((obsPtr != NULL) && (obsPtr->backupDueTime <= now.sec));
+        bool isSpillDue = ((!le_dls_IsEmpty(&SpillQueue)) && (SpillDueTime <= now.sec));
+
+        if ((!isBackupDue) && (!isSpillDue))
+        {
+            break;
+        }
+        if (isFileBudgetSpent || isByteBudgetSpent)
+        {
+            isBudgetSpent = true;
+            break;
+        }
+
+#if LE_CONFIG_LINUX
+        // Staged records go first, because new ones are dropped while the stage is full.
+        if (isSpillDue)
+        {
+            obsPtr = CONTAINER_OF(le_dls_Peek(&SpillQueue), Observation_t, spillLink);
+            BackupBytesWritten += FlushSpillStage(obsPtr);
+            fileCount++;
+            continue;
+        }
+#endif
+
+        le_dls_Remove(&BackupQueue, linkPtr);
+        obsPtr->isBackupScheduled = false;
+
+        Backup(obsPtr);
+        fileCount++;
+    }
+
+    IsBackupPassRunning = false;
+
+    StartBackupTimer(isBudgetSpent ? 1000 : 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Disable backups of a given Observation's data sample buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DisableBackups
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    UnscheduleBackup(obsPtr);
+
+    obsPtr->lastBackupTime = 0;
+
+    // Don't lose the buffer contents along with the backup file.
+    CompleteRestore(obsPtr);
+
+    DeleteBackup(obsPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of records that each segment of an Observation's spilled history can hold.
+ * Small histories use small segments, so that deleting the oldest segment doesn't drop more
+ * samples than the spill count.
+ *
+ * @return The number of records.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t GetSpillSegmentCapacity
+(
+    uint32_t spillMaxCount  ///< Number of evicted samples to keep (must not be 0).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return ((spillMaxCount < DHUB_SPILL_SEGMENT_RECORDS) ? spillMaxCount
+                                                         : DHUB_SPILL_SEGMENT_RECORDS);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of segments an Observation's spilled history may have: enough full segments
+ * to hold the spill count, plus the one being filled.  Segment files use the slots below this.
+ *
+ * @return The number of segments.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline unsigned int GetMaxSpillSegments
+(
+    uint32_t spillMaxCount  ///< Number of evicted samples to keep (must not be 0).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t capacity = GetSpillSegmentCapacity(spillMaxCount);
+
+    return ((spillMaxCount + capacity - 1) / capacity) + 1;
+}
+
+
+#if LE_CONFIG_LINUX
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the lowest file slot that isn't used by a segment of a given Observation's spilled history.
+ *
+ * @return The slot number.
+ */
+//--------------------------------------------------------------------------------------------------
+static unsigned int GetFreeSpillSlot
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    unsigned int slot = 0;
+    le_dls_Link_t* linkPtr = le_dls_Peek(&obsPtr->spillList);
+
+    while (linkPtr != NULL)
+    {
+        if (CONTAINER_OF(linkPtr, SpillSegment_t, link)->slot == slot)
+        {
+            // Taken.  Try the next slot from the start of the list.
+            slot++;
+            linkPtr = le_dls_Peek(&obsPtr->spillList);
+        }
+        else
+        {
+            linkPtr = le_dls_PeekNext(&obsPtr->spillList, linkPtr);
+        }
+    }
+
+    return slot;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a new segment of a given Observation's spilled history, for samples of the buffered data
+ * type, deleting the oldest segments if there are too many.  The new segment's file is created
+ * when its first records are written (see WriteSpillRecords()).
+ *
+ * @return Ptr to the segment, or NULL if failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static SpillSegment_t* StartSpillSegment
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (obsPtr->spillFd != -1)
+    {
+        close(obsPtr->spillFd);
+        obsPtr->spillFd = -1;
+    }
+
+    while (le_dls_NumLinks(&obsPtr->spillList) >= GetMaxSpillSegments(obsPtr->spillMaxCount))
+    {
+        DropSpillSegment(obsPtr,
+                         CONTAINER_OF(le_dls_Peek(&obsPtr->spillList), SpillSegment_t, link));
+    }
+
+    SpillSegment_t* segPtr = hub_MemAlloc(SpillSegmentPool);
+    if (segPtr == NULL)
+    {
+        return NULL;
+    }
+
+    le_dls_Link_t* newestLinkPtr = le_dls_PeekTail(&obsPtr->spillList);
+
+    segPtr->link = LE_DLS_LINK_INIT;
+    segPtr->slot = GetFreeSpillSlot(obsPtr);
+    segPtr->dataType = obsPtr->bufferedType;
+    segPtr->count = 0;
+    segPtr->savedCount = 0;
+    segPtr->isClosed = false;
+    segPtr->isDropped = false;
+    segPtr->lastTimestamp = NAN;
+    segPtr->seq = ((newestLinkPtr == NULL) ?
+                   0 : (CONTAINER_OF(newestLinkPtr, SpillSegment_t, link)->seq + 1));
+    le_dls_Queue(&obsPtr->spillList, &segPtr->link);
+
+    return segPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a record that has been evicted from a given Observation's ring storage to its spilled
+ * history, starting a new segment if the newest one is full (or can't be appended to).
+ *
+ * The record is only staged in memory; the backup scheduler writes it to the segment's file
+ * later (see FlushSpillStage()).  If DHUB_SPILL_STAGE_RECORDS records are already waiting, the
+ * record is dropped.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SpillRecord
+(
+    Observation_t* obsPtr,
+    double timestamp,
+    double value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (   (obsPtr->spillStagePtr != NULL)
+        && (obsPtr->spillStagePtr->count >= DHUB_SPILL_STAGE_RECORDS)  )
+    {
+        obsPtr->spillStagePtr->droppedCount++;
+        return;
+    }
+
+    le_dls_Link_t* linkPtr = le_dls_PeekTail(&obsPtr->spillList);
+    SpillSegment_t* segPtr = ((linkPtr == NULL) ?
+                              NULL : CONTAINER_OF(linkPtr, SpillSegment_t, link));
+
+    if (   (segPtr == NULL)
+        || segPtr->isClosed
+        || (segPtr->dataType != obsPtr->bufferedType)
+        || (segPtr->count >= GetSpillSegmentCapacity(obsPtr->spillMaxCount))  )
+    {
+        // This may drop old segments, along with their staged records.
+        segPtr = StartSpillSegment(obsPtr);
+        if (segPtr == NULL)
+        {
+            return;
+        }
+    }
+
+    if (obsPtr->spillStagePtr == NULL)
+    {
+        obsPtr->spillStagePtr = hub_MemAlloc(SpillStagePool);
+        if (obsPtr->spillStagePtr == NULL)
+        {
+            return;
+        }
+        obsPtr->spillStagePtr->count = 0;
+        obsPtr->spillStagePtr->droppedCount = 0;
+
+        // Records are written a second after the first one is staged, with any backups due.
+        bool isQueueEmpty = le_dls_IsEmpty(&SpillQueue);
+        le_dls_Queue(&SpillQueue, &obsPtr->spillLink);
+
+        if (isQueueEmpty)
+        {
+            SpillDueTime = le_clk_GetRelativeTime().sec + 1;
+
+            if (!IsBackupPassRunning)
+            {
+                StartBackupTimer(1000);
+            }
+        }
+    }
+
+    SpillStage_t* stagePtr = obsPtr->spillStagePtr;
+
+    stagePtr->timestamps[stagePtr->count] = timestamp;
+    switch (segPtr->dataType)
+    {
+        case IO_DATA_TYPE_BOOLEAN:  stagePtr->values[stagePtr->count] = (value != 0);  break;
+        case IO_DATA_TYPE_NUMERIC:  stagePtr->values[stagePtr->count] = value;         break;
+        default:                    stagePtr->values[stagePtr->count] = NAN;           break;
+    }
+    stagePtr->count++;
+
+    if ((segPtr->count % SPILL_INDEX_STRIDE) == 0)
+    {
+        segPtr->index[segPtr->count / SPILL_INDEX_STRIDE] = timestamp;
+    }
+    segPtr->count++;
+    segPtr->lastTimestamp = timestamp;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the timestamp of a given record of a spilled history segment file.
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadSpilledTimestamp
+(
+    int fd,
+    size_t recordBytes,
+    size_t index,
+    double* timestampPtr    ///< [OUT] The timestamp.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (pread(fd, timestampPtr, sizeof(double), SPILL_HEADER_BYTES + (index * recordBytes))
+            == sizeof(double));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the segment held in a given file slot of an Observation's spilled history, building its
+ * sparse index from the file.
+ *
+ * @return Ptr to the segment, or NULL if the file doesn't exist or isn't valid.
+ */
+//--------------------------------------------------------------------------------------------------
+static SpillSegment_t* LoadSpillSegment
+(
+    const char* path,
+    unsigned int slot
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        return NULL;
+    }
+
+    uint8_t header[SPILL_HEADER_BYTES];
+    io_DataType_t dataType;
+    struct stat st;
+    SpillSegment_t* segPtr = NULL;
+
+    if (   (pread(fd, header, sizeof(header), 0) == sizeof(header))
+        && (header[0] == SPILL_FILE_VERSION)
+        && GetDataTypeFromCode(&dataType, header[1])
+        && (   (dataType == IO_DATA_TYPE_TRIGGER)
+            || (dataType == IO_DATA_TYPE_BOOLEAN)
+            || (dataType == IO_DATA_TYPE_NUMERIC)  )
+        && (fstat(fd, &st) == 0)  )
+    {
+        size_t recordBytes = GetSpillRecordBytes(dataType);
+        size_t count = (st.st_size - SPILL_HEADER_BYTES) / recordBytes;
+        if (count > DHUB_SPILL_SEGMENT_RECORDS)
+        {
+            count = DHUB_SPILL_SEGMENT_RECORDS;
+        }
+
+        if (count > 0)
+        {
+            segPtr = hub_MemAlloc(SpillSegmentPool);
+        }
+
+        if (segPtr != NULL)
+        {
+            segPtr->link = LE_DLS_LINK_INIT;
+            segPtr->slot = slot;
+            segPtr->dataType = dataType;
+            segPtr->count = count;
+            segPtr->savedCount = count;
+            segPtr->isClosed = true;
+            segPtr->isDropped = false;
+            segPtr->seq = 0;
+
+            bool isValid = ReadSpilledTimestamp(fd, recordBytes, count - 1, &segPtr->lastTimestamp);
+
+            for (size_t i = 0; isValid && ((i * SPILL_INDEX_STRIDE) < count); i++)
+            {
+                isValid = ReadSpilledTimestamp(fd,
+                                               recordBytes,
+                                               i * SPILL_INDEX_STRIDE,
+                                               &segPtr->index[i]);
+            }
+
+            if (!isValid)
+            {
+                le_mem_Release(segPtr);
+                segPtr = NULL;
+            }
+        }
+    }
+
+    close(fd);
+
+    if (segPtr == NULL)
+    {
+        LE_WARN("Discarding spilled history file '%s'.", path);
+        unlink(path);
+    }
+
+    return segPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the segments of a given Observation's spilled history from the files left by a previous
+ * run.  New records always go into a new segment.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LoadSpillSegments
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    unsigned int maxSegments = GetMaxSpillSegments(obsPtr->spillMaxCount);
+
+    for (unsigned int slot = 0; slot < maxSegments; slot++)
     {
-        return;
-    }
+        char path[MAX_SPILL_FILE_PATH_BYTES];
+        if (GetSpillFilePath(path, sizeof(path), obsPtr, slot) != LE_OK)
+        {
+            return;
+        }
 
-    // Write in the number of samples.
-    uint32_t count = obsPtr->count;
-    if (!WriteToStream(file, &count, 4))
-    {
-        return;
-    }
+        SpillSegment_t* segPtr = LoadSpillSegment(path, slot);
+        if (segPtr == NULL)
+        {
+            continue;
+        }
 
-    // Write all the data samples to the file.
-    if (!WriteSamplesToFile(file, obsPtr))
-    {
-        return;
+        // Keep the list sorted oldest first.
+        le_dls_Link_t* linkPtr = le_dls_Peek(&obsPtr->spillList);
+        while (   (linkPtr != NULL)
+               && (CONTAINER_OF(linkPtr, SpillSegment_t, link)->index[0] <= segPtr->index[0]))
+        {
+            linkPtr = le_dls_PeekNext(&obsPtr->spillList, linkPtr);
+        }
+
+        if (linkPtr == NULL)
+        {
+            le_dls_Queue(&obsPtr->spillList, &segPtr->link);
+        }
+        else
+        {
+            le_dls_AddBefore(&obsPtr->spillList, linkPtr, &segPtr->link);
+        }
     }
 
-    // Commit the file.
-    result = le_atomFile_CloseStream(file);
-    if (result != LE_OK)
+    uint64_t seq = 0;
+    le_dls_Link_t* linkPtr = le_dls_Peek(&obsPtr->spillList);
+    while (linkPtr != NULL)
     {
-        LE_CRIT("Failed to save '%s' (%s).", path, LE_RESULT_TXT(result));
+        CONTAINER_OF(linkPtr, SpillSegment_t, link)->seq = seq++;
+        linkPtr = le_dls_PeekNext(&obsPtr->spillList, linkPtr);
     }
-#else /* !LE_CONFIG_FILESYSTEM */
-    // TODO: implement non-volatile storage without a filesystem.
-#endif /* end !LE_CONFIG_FILESYSTEM */
 
-    LE_DEBUG("Backup complete.");
+    CheckSpilledType(obsPtr);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Disable backups of a given Observation's data sample buffer.
+ * Delete the oldest segments of a given Observation's spilled history until there are no more
+ * than its spill count needs, and move the rest into the file slots that are still used.
  */
 //--------------------------------------------------------------------------------------------------
-static void DisableBackups
+static void TrimSpillSegments
 (
     Observation_t* obsPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (obsPtr->backupTimer != NULL)
+    unsigned int maxSegments = GetMaxSpillSegments(obsPtr->spillMaxCount);
+
+    while (le_dls_NumLinks(&obsPtr->spillList) > maxSegments)
     {
-        le_timer_Stop(obsPtr->backupTimer);
-        le_timer_Delete(obsPtr->backupTimer);
-        obsPtr->backupTimer = NULL;
+        DropSpillSegment(obsPtr,
+                         CONTAINER_OF(le_dls_Peek(&obsPtr->spillList), SpillSegment_t, link));
     }
 
-    obsPtr->lastBackupTime = 0;
+    le_dls_Link_t* linkPtr = le_dls_Peek(&obsPtr->spillList);
+    while (linkPtr != NULL)
+    {
+        SpillSegment_t* segPtr = CONTAINER_OF(linkPtr, SpillSegment_t, link);
 
-    DeleteBackup(obsPtr);
+        if ((segPtr->slot >= maxSegments) && (segPtr->savedCount == 0))
+        {
+            // The segment's file hasn't been created yet.
+            segPtr->slot = GetFreeSpillSlot(obsPtr);
+        }
+        else if (segPtr->slot >= maxSegments)
+        {
+            // Open files (including the one being written) follow the rename.
+            unsigned int slot = GetFreeSpillSlot(obsPtr);
+            char oldPath[MAX_SPILL_FILE_PATH_BYTES];
+            char newPath[MAX_SPILL_FILE_PATH_BYTES];
+
+            if (   (GetSpillFilePath(oldPath, sizeof(oldPath), obsPtr, segPtr->slot) == LE_OK)
+                && (GetSpillFilePath(newPath, sizeof(newPath), obsPtr, slot) == LE_OK))
+            {
+                if (rename(oldPath, newPath) == 0)
+                {
+                    segPtr->slot = slot;
+                }
+                else
+                {
+                    LE_ERROR("Failed to rename '%s' to '%s' (%m).", oldPath, newPath);
+                }
+            }
+        }
+
+        linkPtr = le_dls_PeekNext(&obsPtr->spillList, linkPtr);
+    }
 }
+#endif /* end LE_CONFIG_LINUX */
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Timer expiry handler function for Observation data sample buffer backup timers.
- *
- * Saves the contents of an Observation's data sample buffer to non-volatile storage.
- *
- * @note The timer should only be running if a data sample arrived in the buffer before the
- *       backup period had elapsed since the previous backup.
+ * Discard the oldest entries of a given Observation's buffer like TruncateBuffer(), but append
+ * the discarded ring storage records to the Observation's spilled history, if it has one.
  */
 //--------------------------------------------------------------------------------------------------
-static void BackupTimerExpired
+static void SpillAndTruncateBuffer
 (
-    le_timer_Ref_t timer
+    Observation_t* obsPtr,
+    size_t count
 )
 //--------------------------------------------------------------------------------------------------
 {
-    Observation_t* obsPtr = le_timer_GetContextPtr(timer);
+#if LE_CONFIG_LINUX
+    if ((obsPtr->spillMaxCount > 0) && IsRingStorage(obsPtr) && (obsPtr->count > count))
+    {
+        size_t spillCount = obsPtr->count - count;
+        BufferPos_t pos;
+        bool havePos = GetOldestBufferEntry(obsPtr, &pos);
+
+        while (havePos && (spillCount > 0))
+        {
+            SpillRecord(obsPtr,
+                        GetBufferedTimestamp(&pos),
+                        GetBlockRecords(pos.blockPtr)->values[pos.index]);
+            spillCount--;
+            havePos = GetNextBufferEntry(obsPtr, &pos);
+        }
+    }
+#endif
 
-    Backup(obsPtr);
+    TruncateBuffer(obsPtr, count);
 }
 
 
@@ -1408,14 +6694,57 @@ void obs_Init
     ObservationPool = le_mem_InitStaticPool(ObservationPool, DEFAULT_OBSERVATION_POOL_SIZE,
                         sizeof(Observation_t));
     le_mem_SetDestructor(ObservationPool, ObservationDestructor);
+    hub_RegisterPool(ObservationPool);
 
     BufferEntryPool = le_mem_InitStaticPool(BufferEntryPool, DEFAULT_BUFFER_ENTRY_POOL_SIZE,
                         sizeof(BufferEntry_t));
     le_mem_SetDestructor(BufferEntryPool, BufferEntryDestructor);
+    hub_RegisterPool(BufferEntryPool);
 
     ReadOperationPool = le_mem_InitStaticPool(ReadOperationPool,
                                               DEFAULT_READ_OPERATION_POOL_SIZE,
                                               sizeof(ReadOperation_t));
+    hub_RegisterPool(ReadOperationPool);
+
+    ReadBufferPool = le_mem_InitStaticPool(ReadBufferPool,
+                                           DEFAULT_READ_BUFFER_POOL_SIZE,
+                                           READ_OP_CHUNK_BYTES);
+    hub_RegisterPool(ReadBufferPool);
+
+    SampleBlockPool = le_mem_InitStaticPool(SampleBlockPool, DEFAULT_SAMPLE_BLOCK_POOL_SIZE,
+                        sizeof(SampleBlock_t));
+    hub_RegisterPool(SampleBlockPool);
+
+    CompactBlockPool = le_mem_InitStaticPool(CompactBlockPool,
+                                             DEFAULT_COMPACT_BLOCK_POOL_SIZE,
+                                             sizeof(CompactBlock_t));
+    hub_RegisterPool(CompactBlockPool);
+
+#ifdef DHUB_COMPRESSED_BUFFERS
+    CompressedBlockPool = le_mem_InitStaticPool(CompressedBlockPool,
+                                                DEFAULT_COMPRESSED_BLOCK_POOL_SIZE,
+                                                sizeof(CompressedBlock_t));
+    hub_RegisterPool(CompressedBlockPool);
+#endif
+
+    DequeBlockPool = le_mem_InitStaticPool(DequeBlockPool, DEFAULT_DEQUE_BLOCK_POOL_SIZE,
+                        sizeof(DequeBlock_t));
+    hub_RegisterPool(DequeBlockPool);
+
+    SpillSegmentPool = le_mem_InitStaticPool(SpillSegmentPool,
+                                             DEFAULT_SPILL_SEGMENT_POOL_SIZE,
+                                             sizeof(SpillSegment_t));
+    hub_RegisterPool(SpillSegmentPool);
+
+#if LE_CONFIG_LINUX
+    SpillStagePool = le_mem_InitStaticPool(SpillStagePool,
+                                           DEFAULT_SPILL_STAGE_POOL_SIZE,
+                                           sizeof(SpillStage_t));
+    hub_RegisterPool(SpillStagePool);
+#endif
+
+    BackupTimer = le_timer_Create("backup");
+    LE_ASSERT(le_timer_SetHandler(BackupTimer, BackupTimerExpired) == LE_OK);
 }
 
 
@@ -1451,18 +6780,49 @@ res_Resource_t* obs_Create
     obsPtr->count = 0;
 
     obsPtr->transformType = OBS_TRANSFORM_TYPE_NONE;
+    obsPtr->bucket.period = DEFAULT_BUCKET_PERIOD;
+    obsPtr->bucket.count = 0;
 
     obsPtr->bufferedType = IO_DATA_TYPE_TRIGGER;
+    obsPtr->isBufferCompact = false;
 
     obsPtr->backupPeriod = 0;
     obsPtr->lastBackupTime = 0;
-    obsPtr->backupTimer = NULL;
+    obsPtr->backupDueTime = 0;
+    obsPtr->isBackupScheduled = false;
+    obsPtr->backupLink = LE_DLS_LINK_INIT;
+    obsPtr->unsavedCount = 0;
+    obsPtr->journalCount = 0;
+    obsPtr->isJournalValid = false;
+    obsPtr->isRestorePending = false;
+    obsPtr->restoreLink = LE_DLS_LINK_INIT;
+
+    obsPtr->spillMaxCount = 0;
+    obsPtr->spillList = LE_DLS_LIST_INIT;
+    obsPtr->spillFd = -1;
+    obsPtr->spillStagePtr = NULL;
+    obsPtr->spillLink = LE_DLS_LINK_INIT;
 
     obsPtr->sampleList = LE_SLS_LIST_INIT;
 
+    obsPtr->blockList = LE_DLS_LIST_INIT;
+    obsPtr->headIndex = 0;
+    obsPtr->tailBlockPtr = NULL;
+    obsPtr->tailIndex = 0;
+    obsPtr->oldestSeq = 0;
+    obsPtr->scratchSampleRef = NULL;
+
+    const BufferPos_t emptyPos = BUFFER_POS_INIT;
+    obsPtr->searchCursor = emptyPos;
+
+    memset(&obsPtr->aggregates, 0, sizeof(obsPtr->aggregates));
+    obsPtr->aggregates.minDeque.blockList = LE_DLS_LIST_INIT;
+    obsPtr->aggregates.maxDeque.blockList = LE_DLS_LIST_INIT;
+
     obsPtr->readOpList = LE_DLS_LIST_INIT;
 
     obsPtr->jsonExtraction[0] = '\0';
+    obsPtr->isJsonProgramValid = false;
 
     obsPtr->destination[0] = '\0';
 
@@ -1470,100 +6830,6 @@ res_Resource_t* obs_Create
 }
 
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Restore an Observation's data buffer from non-volatile backup, if one exists.
- */
-//--------------------------------------------------------------------------------------------------
-void obs_RestoreBackup
-(
-    res_Resource_t* resPtr
-)
-//--------------------------------------------------------------------------------------------------
-{
-#if LE_CONFIG_FILESYSTEM
-    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
-
-    // If there's no backup directory yet, then we know there are no backups, so don't
-    // try opening one (which would result in an error message in the logs because the lock file
-    // can't be created).
-    struct stat st = {0};
-    if (stat(BACKUP_DIR, &st) == -1)
-    {
-        LE_DEBUG("Backup directory '" BACKUP_DIR "' not found. (%m)");
-        return;
-    }
-
-    char path[MAX_BACKUP_FILE_PATH_BYTES];
-    if (GetBackupFilePath(path, sizeof(path), obsPtr) != LE_OK)
-    {
-        return;
-    }
-
-    LE_INFO("Loading observation buffer from file '%s'.", path);
-
-    // Open the file for reading.
-    le_result_t result;
-    FILE* file = le_atomFile_OpenStream(path, LE_FLOCK_READ, &result);
-    if (result != LE_OK)
-    {
-        LE_DEBUG("Unable to open '%s' for reading (%s).", path, LE_RESULT_TXT(result));
-        return;
-    }
-
-    // Read the version byte.
-    uint8_t byte;
-    if (ReadFromFile(&byte, 1, file) != LE_OK)
-    {
-        LE_ERROR("Failed to read version byte.");
-        return;
-    }
-    if (byte != 0)
-    {
-        LE_CRIT("Backup file format version %d unrecognized.", (int)byte);
-        le_atomFile_CancelStream(file);
-        return;
-    }
-
-    // Read the data type code.
-    if (ReadFromFile(&byte, 1, file) != LE_OK)
-    {
-        LE_ERROR("Failed to read data type code.");
-        return;
-    }
-    io_DataType_t dataType;
-    if (!GetDataTypeFromCode(&dataType, byte))
-    {
-        le_atomFile_CancelStream(file);
-        return;
-    }
-    obsPtr->bufferedType = dataType;
-
-    // Read the number of samples.
-    uint32_t count;
-    if (ReadFromFile(&count, 4, file) != LE_OK)
-    {
-        LE_ERROR("Failed to read number of samples.");
-        return;
-    }
-
-    // The maximum count must be at least the number we read.
-    if (obsPtr->maxCount == 0)
-    {
-        obsPtr->maxCount = count;
-    }
-    // NOTE: Don't enable backups, though, because we don't know the frequency to choose
-    //       and flash wear can permanently damage a device.
-
-    // Read all the data samples from the file.
-    ReadSamplesFromFile(obsPtr, file, count);
-#else /* !LE_CONFIG_FILESYSTEM */
-    // TODO: read from non-volatile storage without a filesystem.
-    LE_UNUSED(resPtr);
-#endif /* end !LE_CONFIG_FILESYSTEM */
-}
-
-
 //--------------------------------------------------------------------------------------------------
 /**
  * Perform JSON extraction.  If the data type is not JSON, does nothing.
@@ -1591,10 +6857,22 @@ le_result_t obs_DoJsonExtraction
         }
 
         // Extract the appropriate JSON data element from the value.
+        // Use the pre-compiled specifier if there is one, to avoid re-parsing the specifier
+        // text for every sample.
         io_DataType_t extractedType;
-        dataSample_Ref_t extractedValue = dataSample_ExtractJson(*valueRefPtr,
-                                                                 obsPtr->jsonExtraction,
-                                                                 &extractedType);
+        dataSample_Ref_t extractedValue;
+        if (obsPtr->isJsonProgramValid)
+        {
+            extractedValue = dataSample_ExtractJsonCompiled(*valueRefPtr,
+                                                            &obsPtr->jsonProgram,
+                                                            &extractedType);
+        }
+        else
+        {
+            extractedValue = dataSample_ExtractJson(*valueRefPtr,
+                                                    obsPtr->jsonExtraction,
+                                                    &extractedType);
+        }
         if (extractedValue == NULL)
         {
             // Extraction failed.
@@ -1611,6 +6889,61 @@ le_result_t obs_DoJsonExtraction
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check a numeric value against an Observation's high and low limits.
+ *
+ * @return true if the value is outside the range allowed by the limits.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsOutsideLimits
+(
+    const Observation_t* obsPtr,
+    double numericValue
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // If both limits are enabled and the low limit is higher than the high limit, then
+    // this is the "deadband" case. ( - <------HxxxxxxxxxL------> + )
+    if (   (!isnan(obsPtr->highLimit))
+        && (!isnan(obsPtr->lowLimit))
+        && (obsPtr->lowLimit > obsPtr->highLimit)  )
+    {
+        return ((numericValue < obsPtr->lowLimit) && (numericValue > obsPtr->highLimit));
+    }
+
+    // In all other cases, reject if lower than non-NAN low limit or higher than non-NAN high.
+    return (   ((!isnan(obsPtr->lowLimit)) && (numericValue < obsPtr->lowLimit))
+            || ((!isnan(obsPtr->highLimit)) && (numericValue > obsPtr->highLimit)) );
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether an Observation's minimum period has not yet elapsed since it last accepted a
+ * value.
+ *
+ * @return true if a value received now is too soon to be accepted.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsTooSoon
+(
+    const Observation_t* obsPtr,
+    uint32_t* nowPtr            ///< [OUT] The current relative time (ms), if it was fetched.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((obsPtr->minPeriod != 0) && (!isnan(obsPtr->minPeriod)))
+    {
+        *nowPtr = GetRelativeTimeMs();  // system call
+
+        return ((*nowPtr - obsPtr->lastPushTime) < (obsPtr->minPeriod * 1000));
+    }
+
+    return false;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Determine whether the value should be accepted by a given Observation.
@@ -1631,34 +6964,11 @@ bool obs_ShouldAccept
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
     // Check the high limit and low limit before other limits.
-    if (dataType == IO_DATA_TYPE_NUMERIC)
+    if (   (dataType == IO_DATA_TYPE_NUMERIC)
+        && IsOutsideLimits(obsPtr, dataSample_GetNumeric(valueRef)))
     {
-        double numericValue = dataSample_GetNumeric(valueRef);
-
-        // If both limits are enabled and the low limit is higher than the high limit, then
-        // this is the "deadband" case. ( - <------HxxxxxxxxxL------> + )
-        if (   (!isnan(obsPtr->highLimit))
-            && (!isnan(obsPtr->lowLimit))
-            && (obsPtr->lowLimit > obsPtr->highLimit)  )
-        {
-            if ((numericValue < obsPtr->lowLimit) && (numericValue > obsPtr->highLimit))
-            {
-                return false;
-            }
-        }
-        // In all other cases, reject if lower than non-NAN low limit or higher than non-NAN high.
-        else
-        {
-            if ((!isnan(obsPtr->lowLimit)) && (numericValue < obsPtr->lowLimit))
-            {
-                return false;
-            }
-
-            if ((!isnan(obsPtr->highLimit)) && (numericValue > obsPtr->highLimit))
-            {
-                return false;
-            }
-        }
+        res_AddToStat(resPtr, ADMIN_STAT_DROPPED_LIMIT, 1);
+        return false;
     }
 
     // The current time in ms since some unspecified start time.
@@ -1675,6 +6985,7 @@ bool obs_ShouldAccept
             // If overridden, reject everything because the value won't change.
             if (res_IsOverridden(resPtr))
             {
+                res_AddToStat(resPtr, ADMIN_STAT_DROPPED_OVERRIDE, 1);
                 return false;
             }
 
@@ -1691,6 +7002,7 @@ bool obs_ShouldAccept
                     if (  fabs(dataSample_GetNumeric(valueRef) - previousNumber)
                         < obsPtr->changeBy)
                     {
+                        res_AddToStat(resPtr, ADMIN_STAT_DROPPED_CHANGE_BY, 1);
                         return false;
                     }
                 }
@@ -1699,6 +7011,7 @@ bool obs_ShouldAccept
                 {
                     if (dataSample_GetBoolean(valueRef) == dataSample_GetBoolean(previousValue))
                     {
+                        res_AddToStat(resPtr, ADMIN_STAT_DROPPED_CHANGE_BY, 1);
                         return false;
                     }
                 }
@@ -1709,33 +7022,128 @@ bool obs_ShouldAccept
                     if (0 == strcmp(dataSample_GetString(valueRef),
                                     dataSample_GetString(previousValue)))
                     {
+                        res_AddToStat(resPtr, ADMIN_STAT_DROPPED_CHANGE_BY, 1);
                         return false;
                     }
                 }
             }
         }
 
-        // All of the above can be done without a system call, so that's why we do the
-        // minPeriod check last.
-        if ((obsPtr->minPeriod != 0) && (!isnan(obsPtr->minPeriod)))
+        // All of the above can be done without a system call, so that's why we do the
+        // minPeriod check last.
+        if (IsTooSoon(obsPtr, &now))
+        {
+            res_AddToStat(resPtr, ADMIN_STAT_DROPPED_MIN_PERIOD, 1);
+            return false;
+        }
+    }
+
+    // Update the time of last update.
+    if (now == 0)
+    {
+        now = GetRelativeTimeMs(); // system call
+    }
+    obsPtr->lastPushTime = now;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Determine, without creating a data sample, whether a numeric value pushed to a given
+ * Observation would certainly be dropped by it without changing any of its state.
+ *
+ * This is only the case for Observations that neither buffer, transform nor extract from their
+ * samples, and whose filters reject the value.  It does not change the Observation.
+ *
+ * @return true if the value would be rejected.  false if it might be accepted.
+ */
+//--------------------------------------------------------------------------------------------------
+bool obs_WouldDropNumeric
+(
+    res_Resource_t* resPtr,
+    double value                ///< [IN] the numeric value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    // These see (or may modify) every sample before it gets filtered.
+    if (   (obsPtr->maxCount != 0)
+        || (obsPtr->transformType != OBS_TRANSFORM_TYPE_NONE)
+        || (obsPtr->jsonExtraction[0] != '\0'))
+    {
+        return false;
+    }
+
+    if (IsOutsideLimits(obsPtr, value))
+    {
+        return true;
+    }
+
+    dataSample_Ref_t previousValue = res_GetCurrentValue(resPtr);
+    if (previousValue == NULL)
+    {
+        return false;
+    }
+
+    if ((obsPtr->changeBy != 0) && (!isnan(obsPtr->changeBy)))
+    {
+        if (res_IsOverridden(resPtr))
         {
-            now = GetRelativeTimeMs();  // system call
+            return true;
+        }
 
-            if ((now - obsPtr->lastPushTime) < (obsPtr->minPeriod * 1000))
-            {
-                return false;
-            }
+        if (   (res_GetDataType(resPtr) == IO_DATA_TYPE_NUMERIC)
+            && (fabs(value - dataSample_GetNumeric(previousValue)) < obsPtr->changeBy))
+        {
+            return true;
         }
     }
 
-    // Update the time of last update.
-    if (now == 0)
+    uint32_t now;
+
+    return IsTooSoon(obsPtr, &now);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count a numeric value that obs_WouldDropNumeric() found would be dropped by a given Observation
+ * as received and dropped by it, for the same reason as it would have been by obs_ShouldAccept().
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_CountNumericDrop
+(
+    res_Resource_t* resPtr,
+    double value                ///< [IN] the numeric value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+    admin_StatCounter_t reason = ADMIN_STAT_DROPPED_MIN_PERIOD;
+
+    if (IsOutsideLimits(obsPtr, value))
     {
-        now = GetRelativeTimeMs(); // system call
+        reason = ADMIN_STAT_DROPPED_LIMIT;
+    }
+    else if ((obsPtr->changeBy != 0) && (!isnan(obsPtr->changeBy)))
+    {
+        if (res_IsOverridden(resPtr))
+        {
+            reason = ADMIN_STAT_DROPPED_OVERRIDE;
+        }
+        else if (   (res_GetDataType(resPtr) == IO_DATA_TYPE_NUMERIC)
+                 && (fabs(value - dataSample_GetNumeric(res_GetCurrentValue(resPtr)))
+                     < obsPtr->changeBy))
+        {
+            reason = ADMIN_STAT_DROPPED_CHANGE_BY;
+        }
     }
-    obsPtr->lastPushTime = now;
 
-    return true;
+    res_AddToStat(resPtr, ADMIN_STAT_RECEIVED, 1);
+    res_AddToStat(resPtr, reason, 1);
 }
 
 
@@ -1755,11 +7163,15 @@ void obs_ProcessAccepted
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
+    CompleteRestore(obsPtr);
+
     if (obsPtr->maxCount > 0)
     {
-        // If the data type has changed, we have to dump the current set of buffered samples.
+        // If the data type has changed, we have to dump the current set of buffered samples,
+        // along with the spilled history.
         if (obsPtr->bufferedType != dataType)
         {
+            DeleteSpillSegments(obsPtr);
             TruncateBuffer(obsPtr, 0);
 
             obsPtr->bufferedType = dataType;
@@ -1768,35 +7180,184 @@ void obs_ProcessAccepted
         if (AddToBuffer(obsPtr, sampleRef) != LE_OK)
         {
             LE_ERROR("Failed to an accepted sample to buffer");
+            res_AddToStat(resPtr, ADMIN_STAT_DROPPED_NO_MEMORY, 1);
             return;
         }
 
-        TruncateBuffer(obsPtr, obsPtr->maxCount);
+        if (obsPtr->count > obsPtr->maxCount)
+        {
+            res_AddToStat(resPtr, ADMIN_STAT_BUFFER_EVICTIONS, obsPtr->count - obsPtr->maxCount);
+        }
+        SpillAndTruncateBuffer(obsPtr, obsPtr->maxCount);
 
         // If the buffer backup period is non-zero, then back-ups are enabled.
         if (obsPtr->backupPeriod > 0)
         {
-            // If more than the backup period has passed since the time of last backup, do a backup.
-            uint32_t nextBackupTime = obsPtr->lastBackupTime + obsPtr->backupPeriod;
-            le_clk_Time_t now = le_clk_GetRelativeTime();
-            if (nextBackupTime <= now.sec)
+            // If a backup isn't already scheduled, schedule one for when the backup period has
+            // passed since the time of last backup (which may be now).
+            if (!obsPtr->isBackupScheduled)
             {
-                Backup(obsPtr);
+                ScheduleBackup(obsPtr, obsPtr->lastBackupTime + obsPtr->backupPeriod);
             }
-            // If the backup period hasn't passed yet, and there isn't already a timer running,
-            // then start a timer to expire when it's time to do a backup.
-            else if (obsPtr->backupTimer == NULL)
-            {
-                uint32_t timerInterval = (nextBackupTime - now.sec) * 1000;
+        }
+    }
+}
 
-                obsPtr->backupTimer = le_timer_Create("backup");
-                LE_ASSERT(le_timer_SetMsInterval(obsPtr->backupTimer, timerInterval) == LE_OK);
-                LE_ASSERT(le_timer_SetHandler(obsPtr->backupTimer, BackupTimerExpired) == LE_OK);
-                LE_ASSERT(le_timer_SetContextPtr(obsPtr->backupTimer, obsPtr) == LE_OK);
-                LE_ASSERT(le_timer_Start(obsPtr->backupTimer) == LE_OK);
-            }
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a transform type is a downsampling transform, which aggregates samples into
+ * time buckets before they are buffered, rather than operating on the buffer.
+ *
+ * @return true if it is a downsampling transform.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsDownsampling
+(
+    obs_TransformType_t transformType
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (   (transformType == OBS_TRANSFORM_TYPE_BUCKET_MEAN)
+            || (transformType == OBS_TRANSFORM_TYPE_BUCKET_MIN)
+            || (transformType == OBS_TRANSFORM_TYPE_BUCKET_MAX)
+            || (transformType == OBS_TRANSFORM_TYPE_BUCKET_LAST)  );
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a data sample holding the aggregate of an Observation's (non-empty) current bucket.
+ * The sample is timestamped with the start time of the bucket.  A Boolean aggregate is true if
+ * the aggregate value (with true = 1 and false = 0) is at least 0.5.
+ *
+ * @return The data sample, or NULL if it couldn't be allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static dataSample_Ref_t CreateBucketSample
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const Bucket_t* bucketPtr = &obsPtr->bucket;
+    double value;
+
+    switch (obsPtr->transformType)
+    {
+        case OBS_TRANSFORM_TYPE_BUCKET_MEAN:
+            value = bucketPtr->sum / bucketPtr->count;
+            break;
+
+        case OBS_TRANSFORM_TYPE_BUCKET_MIN:
+            value = bucketPtr->min;
+            break;
+
+        case OBS_TRANSFORM_TYPE_BUCKET_MAX:
+            value = bucketPtr->max;
+            break;
+
+        case OBS_TRANSFORM_TYPE_BUCKET_LAST:
+            value = bucketPtr->last;
+            break;
+
+        default:
+            LE_FATAL("Invalid downsampling transform type %d", obsPtr->transformType);
+            break;
+    }
+
+    if (bucketPtr->dataType == IO_DATA_TYPE_BOOLEAN)
+    {
+        return dataSample_CreateBoolean(bucketPtr->startTime, (value >= 0.5));
+    }
+
+    return dataSample_CreateNumeric(bucketPtr->startTime, value);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fold a data sample into the current bucket of an Observation's downsampling transform (if it
+ * has one).  This must be done before the sample is buffered.
+ *
+ * Buckets are aligned on multiples of the bucket period since the Epoch.  A bucket is completed
+ * (and its aggregate is passed on) when a sample arrives that belongs to a different bucket (or
+ * has a different data type).  Non-numeric samples (other than Boolean) are passed straight
+ * through.
+ *
+ * @note Takes ownership of the data sample reference.
+ *
+ * @return The data sample to carry on with (the aggregate of a completed bucket, or the sample
+ *         itself if the Observation isn't downsampling), or NULL if the sample was absorbed.
+ */
+//--------------------------------------------------------------------------------------------------
+dataSample_Ref_t obs_ApplyDownsampling
+(
+    res_Resource_t* resPtr,
+    io_DataType_t dataType,     ///< Data type of the data sample.
+    dataSample_Ref_t sampleRef  ///< Data sample.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+    Bucket_t* bucketPtr = &obsPtr->bucket;
+
+    if (   (!IsDownsampling(obsPtr->transformType))
+        || ((dataType != IO_DATA_TYPE_NUMERIC) && (dataType != IO_DATA_TYPE_BOOLEAN))  )
+    {
+        return sampleRef;
+    }
+
+    double timestamp = dataSample_GetTimestamp(sampleRef);
+    double startTime = floor(timestamp / bucketPtr->period) * bucketPtr->period;
+    double value;
+    if (dataType == IO_DATA_TYPE_NUMERIC)
+    {
+        value = dataSample_GetNumeric(sampleRef);
+    }
+    else
+    {
+        value = dataSample_GetBoolean(sampleRef) ? 1.0 : 0.0;
+    }
+
+    le_mem_Release(sampleRef);
+
+    dataSample_Ref_t resultRef = NULL;
+
+    if (   (bucketPtr->count > 0)
+        && ((bucketPtr->startTime != startTime) || (bucketPtr->dataType != dataType))  )
+    {
+        resultRef = CreateBucketSample(obsPtr);
+        if (resultRef == NULL)
+        {
+            LE_ERROR("Failed to allocate a sample for a completed bucket. Dropping it.");
         }
+
+        bucketPtr->count = 0;
+    }
+
+    if (bucketPtr->count == 0)
+    {
+        bucketPtr->startTime = startTime;
+        bucketPtr->dataType = dataType;
+        bucketPtr->sum = 0.0;
+        bucketPtr->min = value;
+        bucketPtr->max = value;
+    }
+
+    bucketPtr->count++;
+    bucketPtr->sum += value;
+    bucketPtr->last = value;
+    if (value < bucketPtr->min)
+    {
+        bucketPtr->min = value;
+    }
+    if (value > bucketPtr->max)
+    {
+        bucketPtr->max = value;
     }
+
+    return resultRef;
 }
 
 
@@ -1821,7 +7382,12 @@ dataSample_Ref_t obs_ApplyTransform
     switch (obsPtr->transformType)
     {
         case OBS_TRANSFORM_TYPE_NONE:
-            break;
+        case OBS_TRANSFORM_TYPE_BUCKET_MEAN:
+        case OBS_TRANSFORM_TYPE_BUCKET_MIN:
+        case OBS_TRANSFORM_TYPE_BUCKET_MAX:
+        case OBS_TRANSFORM_TYPE_BUCKET_LAST:
+            // Downsampling is done by obs_ApplyDownsampling() before the sample is buffered.
+            return sample;
 
         case OBS_TRANSFORM_TYPE_MEAN:
             transformVal = obs_QueryMean(resPtr, NAN);
@@ -1845,12 +7411,7 @@ dataSample_Ref_t obs_ApplyTransform
     }
 
     // If transformed value differs from the input sample, update the sample
-    if (OBS_TRANSFORM_TYPE_NONE != obsPtr->transformType)
-    {
-        sample = UpdateSample(sampleRef, dataType, (void *)&transformVal);
-    }
-
-    return sample;
+    return UpdateSample(sampleRef, dataType, (void *)&transformVal);
 }
 
 
@@ -2014,11 +7575,42 @@ double obs_GetChangeBy
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the bucket period that a given transform and parameters would set.
+ *
+ * @return The bucket period, in seconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetBucketPeriod
+(
+    obs_TransformType_t transformType,
+    const double* paramsPtr,
+    size_t paramsSize
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (   IsDownsampling(transformType)
+        && (paramsPtr != NULL)
+        && (paramsSize > 0)
+        && (paramsPtr[0] > 0)
+        && isfinite(paramsPtr[0]))
+    {
+        return paramsPtr[0];
+    }
+
+    return DEFAULT_BUCKET_PERIOD;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Perform a transform on buffered data. Value of the observation will be the output of the
  * transform
  *
+ * For the downsampling (bucket) transforms, the first parameter is the length of the buckets,
+ * in seconds (DEFAULT_BUCKET_PERIOD if absent).
+ *
  * Ignored for all non-numeric types except Boolean for which non-zero = true and zero = false.
  */
 //--------------------------------------------------------------------------------------------------
@@ -2035,9 +7627,22 @@ void obs_SetTransform
 
     obsPtr->transformType = transformType;
 
-    // If the transform is being set to anything other than NONE, ensure there is at least one
-    // data sample buffered in order to allow transforms to behave properly
+    obsPtr->bucket.count = 0;
+    obsPtr->bucket.period = GetBucketPeriod(transformType, paramsPtr, paramsSize);
+    if (   IsDownsampling(transformType)
+        && (paramsPtr != NULL)
+        && (paramsSize > 0)
+        && (obsPtr->bucket.period != paramsPtr[0]))
+    {
+        LE_WARN("Invalid bucket period %lf. Using %lf seconds.",
+                paramsPtr[0],
+                DEFAULT_BUCKET_PERIOD);
+    }
+
+    // If the transform operates on the buffer, ensure there is at least one data sample
+    // buffered in order to allow transforms to behave properly
     if (   (OBS_TRANSFORM_TYPE_NONE != obsPtr->transformType)
+        && (!IsDownsampling(obsPtr->transformType))
         && (0 == obsPtr->maxCount))
     {
         obsPtr->maxCount = 1;
@@ -2045,15 +7650,16 @@ void obs_SetTransform
 
     // Clear the buffer and current value of the observation.  Do this even if the same transform
     // is being re-applied.  This allows any cumulative behavior to be cleared
+    CancelRestore(obsPtr);
     TruncateBuffer(obsPtr, 0);
+    obsPtr->aggregates.minDeque.isEnabled = (OBS_TRANSFORM_TYPE_MIN == transformType);
+    obsPtr->aggregates.maxDeque.isEnabled = (OBS_TRANSFORM_TYPE_MAX == transformType);
     if (resPtr->pushedValue != NULL)
     {
         le_mem_Release(resPtr->pushedValue);
         resPtr->pushedValue = NULL;
     }
 
-    (void)paramsPtr;
-    (void)paramsSize;
 }
 
 
@@ -2076,6 +7682,36 @@ obs_TransformType_t obs_GetTransform
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a given transform, with given parameters, is the one currently applied to an
+ * Observation.  Setting a transform clears the Observation's buffer even if it is the same one,
+ * so this can be used to avoid re-applying it needlessly.
+ *
+ * @return true if setting this transform would not change the Observation's transform settings.
+ */
+//--------------------------------------------------------------------------------------------------
+bool obs_IsTransformSet
+(
+    res_Resource_t* resPtr,
+    obs_TransformType_t transformType,
+    const double* paramsPtr,
+    size_t paramsSize
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    if (obsPtr->transformType != transformType)
+    {
+        return false;
+    }
+
+    return (   !IsDownsampling(transformType)
+            || (obsPtr->bucket.period == GetBucketPeriod(transformType, paramsPtr, paramsSize)));
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the maximum number of data samples to buffer in a given Observation.  Buffers are FIFO
@@ -2104,7 +7740,7 @@ void obs_SetBufferMaxCount
         obsPtr->maxCount = count;
 
         // Discard extra samples if the size has shrunk.
-        TruncateBuffer(obsPtr, count);
+        SpillAndTruncateBuffer(obsPtr, count);
     }
 }
 
@@ -2162,37 +7798,17 @@ void obs_SetBufferBackupPeriod
             }
             // If there's nothing in the buffer, we can skip the rest and just wait for something
             // to be added to the buffer.
-            else if (!le_sls_IsEmpty(&obsPtr->sampleList))
+            else if (obsPtr->count > 0)
             {
                 // If backups were already enabled and the period has just changed,
                 if (oldPeriod != 0)
                 {
-                    // If the timer is running, then we know there's something waiting to be
-                    // backed up.  Otherwise, we wait for something to be added to the buffer.
-                    if (obsPtr->backupTimer != NULL)
+                    // If a backup is scheduled, then we know there's something waiting to be
+                    // backed up, so move it to its new due time (which may be now).  Otherwise,
+                    // we wait for something to be added to the buffer.
+                    if (obsPtr->isBackupScheduled)
                     {
-                        // Stop the old timer, because we know it has the wrong interval.
-                        le_timer_Stop(obsPtr->backupTimer);
-
-                        // If the backup period has passed since the last backup,
-                        // release the timer and do a backup now.
-                        uint32_t nextBackupTime = obsPtr->lastBackupTime + seconds;
-                        le_clk_Time_t now = le_clk_GetRelativeTime();
-                        if (nextBackupTime < now.sec)
-                        {
-                            le_timer_Delete(obsPtr->backupTimer);
-                            obsPtr->backupTimer = NULL;
-
-                            Backup(obsPtr);
-                        }
-                        else // If the backup period has not yet passed, correct the timer's
-                             // interval and restart it.
-                        {
-                            uint32_t timerInterval = (nextBackupTime - now.sec) * 1000;
-                            LE_ASSERT(le_timer_SetMsInterval(obsPtr->backupTimer, timerInterval)
-                                      == LE_OK);
-                            LE_ASSERT(le_timer_Start(obsPtr->backupTimer) == LE_OK);
-                        }
+                        ScheduleBackup(obsPtr, obsPtr->lastBackupTime + seconds);
                     }
                 }
             }
@@ -2203,14 +7819,113 @@ void obs_SetBufferBackupPeriod
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the minimum time between backups of an Observation's buffer to non-volatile storage.
- * See admin_SetBufferBackupPeriod() for more information.
+ * Get the minimum time between backups of an Observation's buffer to non-volatile storage.
+ * See admin_SetBufferBackupPeriod() for more information.
+ *
+ * @return The buffer backup period (in seconds) or 0 if backups are disabled or the Observation
+ *         does not exist.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t obs_GetBufferBackupPeriod
+(
+    res_Resource_t* resPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    return obsPtr->backupPeriod;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the number of samples evicted from an Observation's buffer to keep in its spilled history
+ * on non-volatile storage (see admin_SetBufferSpillMaxCount()).  Setting it to 0 deletes the
+ * history.  When it is first set, the history left by a previous run is loaded.
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_SetBufferSpillMaxCount
+(
+    res_Resource_t* resPtr,
+    uint32_t count
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    uint32_t oldCount = obsPtr->spillMaxCount;
+
+    if (oldCount == count)
+    {
+        return;
+    }
+
+    obsPtr->spillMaxCount = count;
+
+    if (count == 0)
+    {
+        DeleteSpillSegments(obsPtr);
+    }
+#if LE_CONFIG_LINUX
+    else if (oldCount == 0)
+    {
+        LoadSpillSegments(obsPtr);
+    }
+    else
+    {
+        TrimSpillSegments(obsPtr);
+    }
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of samples evicted from an Observation's buffer to keep in its spilled history.
+ *
+ * @return The number of samples, or 0 if the history is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t obs_GetBufferSpillMaxCount
+(
+    res_Resource_t* resPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    return obsPtr->spillMaxCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set whether an Observation's buffered numbers are kept with reduced precision (see
+ * admin_SetBufferPrecision()).  Samples already in the buffer keep the precision they have.
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_SetBufferCompact
+(
+    res_Resource_t* resPtr,
+    bool isCompact
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    obsPtr->isBufferCompact = isCompact;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether an Observation's buffered numbers are kept with reduced precision.
  *
- * @return The buffer backup period (in seconds) or 0 if backups are disabled or the Observation
- *         does not exist.
+ * @return true if they are.
  */
 //--------------------------------------------------------------------------------------------------
-uint32_t obs_GetBufferBackupPeriod
+bool obs_IsBufferCompact
 (
     res_Resource_t* resPtr
 )
@@ -2218,7 +7933,7 @@ uint32_t obs_GetBufferBackupPeriod
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
-    return obsPtr->backupPeriod;
+    return obsPtr->isBufferCompact;
 }
 
 
@@ -2244,9 +7959,20 @@ static int BackupDirTreeWalkCallback
     {
         case FTW_F:  // regular file
         {
-            // Compute the resource tree entry path of the associated Observation.
+            // Compute the resource tree entry path of the associated Observation.  The file is
+            // either its backup file or one of its spilled history segment files.
             const char* relPath = fpath + BACKUP_DIR_PATH_LEN;
-            const char* suffixPtr = strstr(relPath, BACKUP_SUFFIX);
+            const char* suffixPtr = strstr(relPath, SPILL_SUFFIX);
+            bool isSpillFile = (suffixPtr != NULL);
+            unsigned long slot = 0;
+            if (isSpillFile)
+            {
+                slot = strtoul(suffixPtr + SPILL_SUFFIX_LEN, NULL, 10);
+            }
+            else
+            {
+                suffixPtr = strstr(relPath, BACKUP_SUFFIX);
+            }
             if (suffixPtr == NULL)
             {
                 LE_WARN("Unexpected file in backup directory. Skipping '%s'.", fpath);
@@ -2263,10 +7989,20 @@ static int BackupDirTreeWalkCallback
             (void)snprintf(obsPath, obsPathBytes, "/obs/%s", relPath);
 
             // If that Observation doesn't exist, or its backup period is 0, delete the file.
+            // Segment files are deleted if its spill count is 0, or doesn't use their slot.
             resTree_EntryRef_t entryRef = resTree_FindEntry(resTree_GetRoot(), obsPath);
+            uint32_t spillMaxCount = 0;
+            if (   (entryRef != NULL)
+                && (resTree_GetEntryType(entryRef) == ADMIN_ENTRY_TYPE_OBSERVATION)  )
+            {
+                spillMaxCount = resTree_GetBufferSpillMaxCount(entryRef);
+            }
             if (   (entryRef == NULL)
                 || (resTree_GetEntryType(entryRef) != ADMIN_ENTRY_TYPE_OBSERVATION)
-                || (resTree_GetBufferBackupPeriod(entryRef) == 0)  )
+                || (   isSpillFile
+                    && (   (spillMaxCount == 0)
+                        || (slot >= GetMaxSpillSegments(spillMaxCount))  )  )
+                || ((!isSpillFile) && (resTree_GetBufferBackupPeriod(entryRef) == 0))  )
             {
                 if (unlink(fpath) != 0)
                 {
@@ -2326,7 +8062,7 @@ static int BackupDirTreeWalkCallback
  * Delete buffer backup files that aren't being used.
  */
 //--------------------------------------------------------------------------------------------------
-void obs_DeleteUnusedBackupFiles
+static void DeleteUnusedBackupFiles
 (
     void
 )
@@ -2349,62 +8085,470 @@ void obs_DeleteUnusedBackupFiles
                       FTW_DEPTH /* depth-first traversal */);
     if (result != 0)
     {
-        if (errno == ENOENT)
-        {
-            LE_DEBUG("No backup directory. Skipping backup file clean-up.");
-        }
-        else
+        if (errno == ENOENT)
+        {
+            LE_DEBUG("No backup directory. Skipping backup file clean-up.");
+        }
+        else
+        {
+            LE_CRIT("Failed to traverse backup directory '%s' (%m)", BACKUP_DIR);
+        }
+    }
+#endif /* end LE_CONFIG_LINUX */
+}
+
+
+#ifdef DHUB_LAZY_RESTORE
+//--------------------------------------------------------------------------------------------------
+/**
+ * Restore the buffers of the Observations in the RestoreQueue for up to DHUB_RESTORE_SLICE_MS,
+ * then give the event loop a chance to serve clients before going on.  Once they are all
+ * restored, do any clean-up of unused backup files that was deferred.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RestoreInBackground
+(
+    void* param1Ptr,    ///< Not used.
+    void* param2Ptr     ///< Not used.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(param1Ptr);
+    LE_UNUSED(param2Ptr);
+
+    IsRestoreScheduled = false;
+
+    le_clk_Time_t deadline = le_clk_Add(le_clk_GetRelativeTime(), RestoreSlice);
+    le_dls_Link_t* linkPtr;
+
+    // Always restore at least one, so that a slow restore can't stall the others.
+    while ((linkPtr = le_dls_Peek(&RestoreQueue)) != NULL)
+    {
+        CompleteRestore(CONTAINER_OF(linkPtr, Observation_t, restoreLink));
+
+        if (le_clk_GreaterThan(le_clk_GetRelativeTime(), deadline))
+        {
+            break;
+        }
+    }
+
+    if (!le_dls_IsEmpty(&RestoreQueue))
+    {
+        IsRestoreScheduled = true;
+        le_event_QueueFunction(&RestoreInBackground, NULL, NULL);
+    }
+    else if (IsCleanupPending)
+    {
+        IsCleanupPending = false;
+        DeleteUnusedBackupFiles();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue RestoreInBackground() to the event loop, if it isn't already.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ScheduleBackgroundRestore
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!IsRestoreScheduled)
+    {
+        IsRestoreScheduled = true;
+        le_event_QueueFunction(&RestoreInBackground, NULL, NULL);
+    }
+}
+#endif /* end DHUB_LAZY_RESTORE */
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Restore an Observation's data buffer from non-volatile backup, if one exists.
+ *
+ * If Data Hub was built with DHUB_LAZY_RESTORE, the restore is deferred so that clients can be
+ * served right away.  Deferred restores are done a few at a time from the event loop (see
+ * RestoreInBackground()), or as soon as the Observation's buffer is pushed to or queried (see
+ * CompleteRestore()), whichever comes first.  Until then, the Observation has no current value.
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_RestoreBackup
+(
+    res_Resource_t* resPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+#if LE_CONFIG_FILESYSTEM
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+#ifdef DHUB_LAZY_RESTORE
+    if (!obsPtr->isRestorePending)
+    {
+        obsPtr->isRestorePending = true;
+        le_dls_Queue(&RestoreQueue, &obsPtr->restoreLink);
+    }
+    ScheduleBackgroundRestore();
+#else
+    RestoreBackup(obsPtr);
+    CheckSpilledType(obsPtr);
+#endif
+#else /* !LE_CONFIG_FILESYSTEM */
+    // TODO: read from non-volatile storage without a filesystem.
+    LE_UNUSED(resPtr);
+#endif /* end !LE_CONFIG_FILESYSTEM */
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete buffer backup files that aren't being used.
+ *
+ * If Data Hub was built with DHUB_LAZY_RESTORE, the backup directory is only walked once all the
+ * deferred restores have been done, so that it doesn't hold up serving clients at start-up.
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_DeleteUnusedBackupFiles
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+#ifdef DHUB_LAZY_RESTORE
+    IsCleanupPending = true;
+    ScheduleBackgroundRestore();
+#else
+    DeleteUnusedBackupFiles();
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the index of the first record of a given Observation's ring storage in a Sample Block.
+ *
+ * @return The index.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t GetBlockStartIndex
+(
+    Observation_t* obsPtr,
+    RingBlock_t* blockPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (&blockPtr->link == le_dls_Peek(&obsPtr->blockList))
+    {
+        return obsPtr->headIndex;
+    }
+
+    return 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the index after the last record of a given Observation's ring storage in a Sample Block.
+ *
+ * @return The index.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t GetBlockEndIndex
+(
+    Observation_t* obsPtr,
+    RingBlock_t* blockPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (blockPtr == &obsPtr->tailBlockPtr->header)
+    {
+        return obsPtr->tailIndex;
+    }
+
+    return SAMPLE_BLOCK_RECORDS;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Binary search a range of records in a Sample Block for the first one with a timestamp at or
+ * after a given time.  Timestamps in ring storage are non-decreasing.
+ *
+ * @return The index of the record found, or endIndex if all records in the range are older.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t SearchBlock
+(
+    const RingBlock_t* blockPtr,
+    size_t startIndex,  ///< Index of the first record in the range.
+    size_t endIndex,    ///< Index after the last record in the range.
+    double startTime    ///< Absolute time to search for.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const SampleBlock_t* recordsPtr = GetBlockRecords(blockPtr);
+
+    while (startIndex < endIndex)
+    {
+        size_t midIndex = startIndex + ((endIndex - startIndex) / 2);
+
+        if (recordsPtr->timestamps[midIndex] < startTime)
+        {
+            startIndex = midIndex + 1;
+        }
+        else
+        {
+            endIndex = midIndex;
+        }
+    }
+
+    return startIndex;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the record at or after a given absolute time in a given Observation's ring storage.
+ *
+ * Repeated polling usually asks for samples after a time that moves forward, so the position
+ * found is cached on the Observation.  If the time searched for is after the cached position,
+ * the search resumes from there; otherwise it works back from the newest Sample Block, which is
+ * where reads of recent samples will end.  Either way, whole blocks are skipped by checking
+ * their first or last timestamp, and the block found is binary searched.
+ *
+ * @note Blocks are only linked, so skipping them is still linear in the number of blocks
+ *       (count / SAMPLE_BLOCK_RECORDS); only the search within a block is logarithmic.
+ *
+ * @return true if found, false if not.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool FindRingRecord
+(
+    Observation_t* obsPtr,
+    double startTime,   ///< Absolute time.
+    BufferPos_t* posPtr ///< [OUT] Position of the record found.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!GetOldestBufferEntry(obsPtr, posPtr) || (GetBufferedTimestamp(posPtr) >= startTime))
+    {
+        return (posPtr->blockPtr != NULL);
+    }
+
+    if (!(GetNewestTimestamp(obsPtr) >= startTime))
+    {
+        posPtr->blockPtr = NULL;
+        return false;
+    }
+
+    // From here on, the oldest record is older than startTime and the newest one isn't, so the
+    // record searched for is neither the oldest nor past the end.
+    const BufferPos_t* cursorPtr = &obsPtr->searchCursor;
+    RingBlock_t* blockPtr;
+    size_t startIndex;
+
+    if (   (cursorPtr->blockPtr != NULL)
+        && (cursorPtr->seq >= obsPtr->oldestSeq)
+        && (cursorPtr->seq < (obsPtr->oldestSeq + obsPtr->count))
+        && (GetBufferedTimestamp(cursorPtr) < startTime)  )
+    {
+        // Skip forward over blocks whose newest record is still too old.
+        blockPtr = cursorPtr->blockPtr;
+        startIndex = cursorPtr->index + 1;
+
+        while (  GetBlockRecords(blockPtr)->timestamps[GetBlockEndIndex(obsPtr, blockPtr) - 1]
+               < startTime)
+        {
+            blockPtr = CONTAINER_OF(le_dls_PeekNext(&obsPtr->blockList, &blockPtr->link),
+                                    RingBlock_t,
+                                    link);
+            startIndex = 0;
+        }
+    }
+    else
+    {
+        // Skip back over blocks whose oldest record is already new enough.
+        blockPtr = &obsPtr->tailBlockPtr->header;
+
+        while (  GetBlockRecords(blockPtr)->timestamps[GetBlockStartIndex(obsPtr, blockPtr)]
+               >= startTime)
+        {
+            blockPtr = CONTAINER_OF(le_dls_PeekPrev(&obsPtr->blockList, &blockPtr->link),
+                                    RingBlock_t,
+                                    link);
+        }
+
+        startIndex = GetBlockStartIndex(obsPtr, blockPtr);
+    }
+
+    size_t endIndex = GetBlockEndIndex(obsPtr, blockPtr);
+    size_t index = SearchBlock(blockPtr, startIndex, endIndex, startTime);
+
+    // If every record in the block is older, the one searched for starts the next block.
+    if (index == endIndex)
+    {
+        blockPtr = CONTAINER_OF(le_dls_PeekNext(&obsPtr->blockList, &blockPtr->link),
+                                RingBlock_t,
+                                link);
+        index = 0;
+    }
+
+    posPtr->blockPtr = blockPtr;
+    posPtr->index = index;
+    posPtr->seq = blockPtr->firstSeq + index;
+
+    obsPtr->searchCursor = *posPtr;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the data sample at or after a given timestamp in a given Observation's buffer.
+ *
+ * @return true if found, false if not.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool FindBufferEntry
+(
+    Observation_t* obsPtr,
+    double startTime,   ///< NAN for oldest; if < 30 years, count back from now; else absolute time.
+    BufferPos_t* posPtr ///< [OUT] Position of the sample found.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (isnan(startTime))
+    {
+        return GetOldestBufferEntry(obsPtr, posPtr);
+    }
+
+    startTime = GetAbsoluteStartTime(startTime);
+
+    if (IsRingStorage(obsPtr))
+    {
+        return FindRingRecord(obsPtr, startTime, posPtr);
+    }
+
+    // Start at the oldest end and walk up the buffer looking for an entry that is the same age
+    // or newer than the specified start time.
+    bool found = GetOldestBufferEntry(obsPtr, posPtr);
+
+    while (found && (GetBufferedTimestamp(posPtr) < startTime))
+    {
+        found = GetNextBufferEntry(obsPtr, posPtr);
+    }
+
+    return found;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count the samples in a given Observation's buffer from a given position up to a given time.
+ * Ring storage records are numbered, so only the end of the range has to be searched for.
+ *
+ * @return The number of samples.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t CountReadSpan
+(
+    Observation_t* obsPtr,
+    const BufferPos_t* startPosPtr, ///< Position of the first sample (not valid if none).
+    double endTime      ///< Time of the newest sample to count (seconds since the Epoch, or
+                        ///< HUGE_VAL to count up to the newest sample in the buffer).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!IsValidBufferPos(startPosPtr))
+    {
+        return 0;
+    }
+
+    if (IsRingStorage(obsPtr))
+    {
+        uint64_t endSeq = obsPtr->oldestSeq + obsPtr->count;
+        BufferPos_t endPos;
+
+        if (   (endTime < HUGE_VAL)
+            && FindRingRecord(obsPtr, nextafter(endTime, HUGE_VAL), &endPos))
         {
-            LE_CRIT("Failed to traverse backup directory '%s' (%m)", BACKUP_DIR);
+            endSeq = endPos.seq;
         }
+
+        return (endSeq > startPosPtr->seq) ? (size_t)(endSeq - startPosPtr->seq) : 0;
     }
-#endif /* end LE_CONFIG_LINUX */
+
+    size_t count = 0;
+    BufferPos_t pos = *startPosPtr;
+    bool havePos = true;
+
+    while (havePos && (GetBufferedTimestamp(&pos) <= endTime))
+    {
+        count++;
+        havePos = GetNextBufferEntry(obsPtr, &pos);
+    }
+
+    return count;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Find the data sample at or after a given timestamp in a given Observation's buffer.
- *
- * @return a pointer to the buffer entry, or NULL if not found.
+ * Start a read operation on the samples in a given Observation's buffer that are newer than a
+ * given time, and not newer than another.  If the spilled history holds samples newer than the
+ * start time, they are read (and decimated) first.
  */
 //--------------------------------------------------------------------------------------------------
-static BufferEntry_t* FindBufferEntry
+static void ReadBuffer
 (
     Observation_t* obsPtr,
-    double startTime   ///< NAN for oldest; if < 30 years, count back from now; else absolute time.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to read the whole buffer.
+    double endAt,   ///< End at this many seconds ago, or at an absolute number of seconds since
+                    ///< the Epoch (if endAt > 30 years).  Use NAN to read up to the newest sample.
+    bool isCbor,    ///< true to write CBOR, false to write JSON.
+    size_t maxCount, ///< Max number of samples to write (decimating if necessary); 0 = no limit.
+    query_DecimationMode_t decimation, ///< How to select the samples, if decimating.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // Start at the oldest end and search forward.
-    BufferEntry_t* buffEntryPtr = GetOldestBufferEntry(obsPtr);
+    CompleteRestore(obsPtr);
 
-    // If the buffer isn't empty and the startTime was specified,
-    if ((buffEntryPtr != NULL) && (!isnan(startTime)))
-    {
-        // If the start time is less than or equal to 30 years, then convert to an
-        // absolute timestamp by subtracting it from the current time.
-        if (startTime <= THIRTY_YEARS)
-        {
-            le_clk_Time_t now = le_clk_GetAbsoluteTime();
-            startTime = ((((double)(now.usec)) / 1000000) + now.sec) - startTime;
-        }
-
-        // Walk up the buffer looking for an entry that is the same age or newer than the
-        // specified start time.
-        do
-        {
-            if (dataSample_GetTimestamp(buffEntryPtr->sampleRef) >= startTime)
-            {
-                break;
-            }
+    double endTime = isnan(endAt) ? HUGE_VAL : GetAbsoluteStartTime(endAt);
 
-            buffEntryPtr = GetNextBufferEntry(obsPtr, buffEntryPtr);
+    BufferPos_t startPos;
+    double historyStart = NAN;
 
-        } while (buffEntryPtr != NULL);
+    if (IsHistoryQuery(obsPtr, startAfter, &historyStart))
+    {
+        // The whole buffer is newer than the start time.
+        (void)GetOldestBufferEntry(obsPtr, &startPos);
+    }
+    // If the data sample found is an exact match for the startAfter time, then skip to the
+    // sample after that.
+    else if (   FindBufferEntry(obsPtr, startAfter, &startPos)
+             && (GetBufferedTimestamp(&startPos) == startAfter))
+    {
+        (void)GetNextBufferEntry(obsPtr, &startPos);
     }
 
-    return buffEntryPtr;
+    StartRead(obsPtr,
+              &startPos,
+              endTime,
+              isCbor,
+              maxCount,
+              decimation,
+              historyStart,
+              outputFile,
+              handlerPtr,
+              contextPtr);
 }
 
 
@@ -2433,16 +8577,123 @@ void obs_ReadBufferJson
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
-    BufferEntry_t* startPtr = FindBufferEntry(obsPtr, startAfter);
+    ReadBuffer(obsPtr,
+               startAfter,
+               NAN,
+               false,
+               0,
+               QUERY_DECIMATION_LTTB,
+               outputFile,
+               handlerPtr,
+               contextPtr);
+}
 
-    // If the data sample found is an exact match for the startAfter time, then skip to the
-    // sample after that.
-    if ((startPtr != NULL) && (dataSample_GetTimestamp(startPtr->sampleRef) == startAfter))
-    {
-        startPtr = GetNextBufferEntry(obsPtr, startPtr);
-    }
 
-    StartRead(obsPtr, startPtr, outputFile, handlerPtr, contextPtr);
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer in JSON format (like obs_ReadBufferJson()), decimated to at most a
+ * given number of samples using the Largest-Triangle-Three-Buckets algorithm, which keeps the
+ * visual shape of the data.  The first and the last samples are always included.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride instead.
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_ReadBufferJsonDecimated
+(
+    res_Resource_t* resPtr, ///< Ptr to the resource object for the Observation.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to read the whole buffer.
+    uint32_t maxCount,  ///< Max number of samples to read (at least 3); 0 = no limit.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    ReadBuffer(obsPtr,
+               startAfter,
+               NAN,
+               false,
+               maxCount,
+               QUERY_DECIMATION_LTTB,
+               outputFile,
+               handlerPtr,
+               contextPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the samples in a buffer between two times, in JSON format (like obs_ReadBufferJson()),
+ * decimated to at most a given number of samples using a given decimation mode.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride.
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_ReadBufferJsonRange
+(
+    res_Resource_t* resPtr, ///< Ptr to the resource object for the Observation.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to start at the oldest sample.
+    double endAt,   ///< End at this many seconds ago, or at an absolute number of seconds since
+                    ///< the Epoch (if endAt > 30 years).  Use NAN to read up to the newest sample.
+    uint32_t maxCount,  ///< Max number of samples to read; 0 = no limit.
+    query_DecimationMode_t decimation, ///< How to select the samples, if decimating.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    ReadBuffer(obsPtr,
+               startAfter,
+               endAt,
+               false,
+               maxCount,
+               decimation,
+               outputFile,
+               handlerPtr,
+               contextPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer.  Data is written to a given file descriptor in CBOR format as an
+ * indefinite-length array of [timestamp, value] arrays.  Timestamps and numeric values are
+ * doubles, Boolean values are true or false, trigger values are null, and string and JSON values
+ * are text strings.
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_ReadBufferCbor
+(
+    res_Resource_t* resPtr, ///< Ptr to the resource object for the Observation.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to read the whole buffer.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    ReadBuffer(obsPtr,
+               startAfter,
+               NAN,
+               true,
+               0,
+               QUERY_DECIMATION_LTTB,
+               outputFile,
+               handlerPtr,
+               contextPtr);
 }
 
 
@@ -2464,18 +8715,41 @@ dataSample_Ref_t obs_FindBufferedSampleAfter
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
-    BufferEntry_t* startPtr = FindBufferEntry(obsPtr, startAfter);
+    CompleteRestore(obsPtr);
+
+    BufferPos_t startPos;
+    double absStart;
+
+    // Look in the spilled history first, if it holds samples newer than the start time.
+    if (IsHistoryQuery(obsPtr, startAfter, &absStart))
+    {
+        SpillCursor_t cursor;
+        dataSample_Ref_t sampleRef = NULL;
+
+        if (   OpenSpillCursor(obsPtr, &cursor, absStart, false)
+            && PeekSpilledRecord(obsPtr, &cursor, &startPos))
+        {
+            sampleRef = GetBufferedSample(obsPtr, &startPos);
+        }
+        CloseSpillCursor(&cursor);
+
+        if (sampleRef != NULL)
+        {
+            return sampleRef;
+        }
+    }
 
     // If the data sample found is an exact match for the startAfter time, then skip to the
     // sample after that.
-    if ((startPtr != NULL) && (dataSample_GetTimestamp(startPtr->sampleRef) == startAfter))
+    if (   FindBufferEntry(obsPtr, startAfter, &startPos)
+        && (GetBufferedTimestamp(&startPos) == startAfter))
     {
-        startPtr = GetNextBufferEntry(obsPtr, startPtr);
+        (void)GetNextBufferEntry(obsPtr, &startPos);
     }
 
-    if (startPtr != NULL)
+    if (IsValidBufferPos(&startPos))
     {
-        return startPtr->sampleRef;
+        return GetBufferedSample(obsPtr, &startPos);
     }
 
     return NULL;
@@ -2504,6 +8778,12 @@ void obs_SetJsonExtraction
                                     extractionSpec,
                                     sizeof(obsPtr->jsonExtraction),
                                     NULL));
+
+    // Compile the specifier once here rather than parsing it on every push.  If it can't be
+    // compiled (e.g., too many steps), fall back to the text specifier, which reports the error.
+    obsPtr->isJsonProgramValid = ((obsPtr->jsonExtraction[0] != '\0')
+                                  && (json_CompileExtraction(obsPtr->jsonExtraction,
+                                                             &obsPtr->jsonProgram) == LE_OK));
 }
 
 
@@ -2529,38 +8809,117 @@ const char* obs_GetJsonExtraction
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get buffer entry numerical value.  This works for numeric or Boolean types only.
+ * Get the compiled form of an Observation's JSON extraction specifier.
  *
- * @return The value.
+ * @return Ptr to the compiled specifier, or NULL if JSON extraction is not set or the specifier
+ *         could not be compiled.
  */
 //--------------------------------------------------------------------------------------------------
-static double GetBufferedNumber
+const json_Extraction_t* obs_GetJsonProgram
 (
-    BufferEntry_t* buffEntryPtr,
-    io_DataType_t dataType
+    res_Resource_t* resPtr  ///< Observation resource.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (dataType == IO_DATA_TYPE_NUMERIC)
-    {
-        return dataSample_GetNumeric(buffEntryPtr->sampleRef);
-    }
-    else if (dataType == IO_DATA_TYPE_BOOLEAN)
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    return (obsPtr->isJsonProgramValid ? &obsPtr->jsonProgram : NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the minimum, maximum, mean and standard deviation of the numerical values found in a given
+ * Observation's spilled history from a given time on, and in its whole buffer.
+ *
+ * If there are no such values, the count is zero and the statistics are NAN (not-a-number).
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetHistoryStats
+(
+    Observation_t* obsPtr,
+    double startTime,   ///< Seconds since the Epoch.
+    double* minPtr,     ///< [OUT] Minimum value.
+    double* maxPtr,     ///< [OUT] Maximum value.
+    double* meanPtr,    ///< [OUT] Mean value.
+    double* stdDevPtr,  ///< [OUT] Standard deviation.
+    uint32_t* countPtr  ///< [OUT] Number of values the statistics were computed from.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t count = 0;
+    double mean = 0;
+    double m2 = 0;
+    double min = NAN;
+    double max = NAN;
+
+    SpillCursor_t cursor;
+    BufferPos_t pos;
+    bool isHistory = OpenSpillCursor(obsPtr, &cursor, startTime, true);
+    bool havePos = (isHistory && PeekSpilledRecord(obsPtr, &cursor, &pos));
+
+    for (;;)
     {
-        if (dataSample_GetBoolean(buffEntryPtr->sampleRef))
+        // Carry on with the buffer once the history has been read.
+        if (isHistory && !havePos)
+        {
+            isHistory = false;
+            havePos = GetOldestBufferEntry(obsPtr, &pos);
+        }
+
+        if (!havePos)
+        {
+            break;
+        }
+
+        double value = GetBufferedNumber(&pos, obsPtr->bufferedType);
+
+        if (!isnan(value))
+        {
+            // Welford's algorithm.
+            count++;
+            double delta = value - mean;
+            mean += delta / count;
+            m2 += delta * (value - mean);
+
+            if (isnan(min) || (value < min))
+            {
+                min = value;
+            }
+            if (isnan(max) || (value > max))
+            {
+                max = value;
+            }
+        }
+
+        if (isHistory)
         {
-            return 1.0;
+            SkipSpilledRecord(&cursor);
+            havePos = PeekSpilledRecord(obsPtr, &cursor, &pos);
         }
         else
         {
-            return 0.0;
+            havePos = GetNextBufferEntry(obsPtr, &pos);
         }
     }
-    else
+
+    CloseSpillCursor(&cursor);
+
+    *countPtr = count;
+
+    if (count == 0)
     {
-        LE_CRIT("Non-numerical data type %d.", dataType);
-        return NAN;
+        *minPtr = NAN;
+        *maxPtr = NAN;
+        *meanPtr = NAN;
+        *stdDevPtr = NAN;
+        return;
     }
+
+    *minPtr = min;
+    *maxPtr = max;
+    *meanPtr = mean;
+    *stdDevPtr = sqrt(((m2 > 0) ? m2 : 0) / count);
 }
 
 
@@ -2582,6 +8941,8 @@ double obs_QueryMin
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
+    CompleteRestore(obsPtr);
+
     // This only works for numeric or Boolean type data.
     if (   (obsPtr->bufferedType != IO_DATA_TYPE_NUMERIC)
         && (obsPtr->bufferedType != IO_DATA_TYPE_BOOLEAN)  )
@@ -2589,13 +8950,29 @@ double obs_QueryMin
         return NAN;
     }
 
-    BufferEntry_t* buffEntryPtr = FindBufferEntry(obsPtr, startTime);
+    // Samples older than the buffer are in the spilled history.
+    double absStart;
+    if (IsHistoryQuery(obsPtr, startTime, &absStart))
+    {
+        double min, max, mean, stdDev;
+        uint32_t count;
+        GetHistoryStats(obsPtr, absStart, &min, &max, &mean, &stdDev, &count);
+        return min;
+    }
+
+    if (CanUseAggregates(obsPtr, startTime) && obsPtr->aggregates.minDeque.isEnabled)
+    {
+        return GetDequeFront(&obsPtr->aggregates.minDeque);
+    }
+
+    BufferPos_t pos;
+    bool havePos = FindBufferEntry(obsPtr, startTime, &pos);
 
     double result = NAN;
 
-    while (buffEntryPtr != NULL)
+    while (havePos)
     {
-        double value = GetBufferedNumber(buffEntryPtr, obsPtr->bufferedType);
+        double value = GetBufferedNumber(&pos, obsPtr->bufferedType);
 
         if (!isnan(value))
         {
@@ -2605,7 +8982,7 @@ double obs_QueryMin
             }
         }
 
-        buffEntryPtr = GetNextBufferEntry(obsPtr, buffEntryPtr);
+        havePos = GetNextBufferEntry(obsPtr, &pos);
     }
 
     return result;
@@ -2630,6 +9007,8 @@ double obs_QueryMax
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
+    CompleteRestore(obsPtr);
+
     // This only works for numeric or Boolean type data.
     if (   (obsPtr->bufferedType != IO_DATA_TYPE_NUMERIC)
         && (obsPtr->bufferedType != IO_DATA_TYPE_BOOLEAN)  )
@@ -2637,13 +9016,29 @@ double obs_QueryMax
         return NAN;
     }
 
-    BufferEntry_t* buffEntryPtr = FindBufferEntry(obsPtr, startTime);
+    // Samples older than the buffer are in the spilled history.
+    double absStart;
+    if (IsHistoryQuery(obsPtr, startTime, &absStart))
+    {
+        double min, max, mean, stdDev;
+        uint32_t count;
+        GetHistoryStats(obsPtr, absStart, &min, &max, &mean, &stdDev, &count);
+        return max;
+    }
+
+    if (CanUseAggregates(obsPtr, startTime) && obsPtr->aggregates.maxDeque.isEnabled)
+    {
+        return GetDequeFront(&obsPtr->aggregates.maxDeque);
+    }
+
+    BufferPos_t pos;
+    bool havePos = FindBufferEntry(obsPtr, startTime, &pos);
 
     double result = NAN;
 
-    while (buffEntryPtr != NULL)
+    while (havePos)
     {
-        double value = GetBufferedNumber(buffEntryPtr, obsPtr->bufferedType);
+        double value = GetBufferedNumber(&pos, obsPtr->bufferedType);
 
         if (!isnan(value))
         {
@@ -2653,7 +9048,7 @@ double obs_QueryMax
             }
         }
 
-        buffEntryPtr = GetNextBufferEntry(obsPtr, buffEntryPtr);
+        havePos = GetNextBufferEntry(obsPtr, &pos);
     }
 
     return result;
@@ -2678,6 +9073,8 @@ double obs_QueryMean
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
+    CompleteRestore(obsPtr);
+
     // This only works for numeric or Boolean type data.
     if (   (obsPtr->bufferedType != IO_DATA_TYPE_NUMERIC)
         && (obsPtr->bufferedType != IO_DATA_TYPE_BOOLEAN)  )
@@ -2685,14 +9082,35 @@ double obs_QueryMean
         return NAN;
     }
 
-    BufferEntry_t* buffEntryPtr = FindBufferEntry(obsPtr, startTime);
+    // Samples older than the buffer are in the spilled history.
+    double absStart;
+    if (IsHistoryQuery(obsPtr, startTime, &absStart))
+    {
+        double min, max, mean, stdDev;
+        uint32_t count;
+        GetHistoryStats(obsPtr, absStart, &min, &max, &mean, &stdDev, &count);
+        return mean;
+    }
+
+    // The running mean covers the whole buffer.
+    if (CanUseAggregates(obsPtr, startTime))
+    {
+        if (obsPtr->aggregates.count == 0)
+        {
+            return NAN;
+        }
+        return obsPtr->aggregates.mean;
+    }
+
+    BufferPos_t pos;
+    bool havePos = FindBufferEntry(obsPtr, startTime, &pos);
 
     double sum = 0;
     size_t count = 0;
 
-    while (buffEntryPtr != NULL)
+    while (havePos)
     {
-        double value = GetBufferedNumber(buffEntryPtr, obsPtr->bufferedType);
+        double value = GetBufferedNumber(&pos, obsPtr->bufferedType);
 
         if (!isnan(value))
         {
@@ -2700,7 +9118,7 @@ double obs_QueryMean
             count++;
         }
 
-        buffEntryPtr = GetNextBufferEntry(obsPtr, buffEntryPtr);
+        havePos = GetNextBufferEntry(obsPtr, &pos);
     }
 
     if (count == 0)
@@ -2731,6 +9149,8 @@ double obs_QueryStdDev
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
+    CompleteRestore(obsPtr);
+
     // This only works for numeric or Boolean type data.
     if (   (obsPtr->bufferedType != IO_DATA_TYPE_NUMERIC)
         && (obsPtr->bufferedType != IO_DATA_TYPE_BOOLEAN)  )
@@ -2738,9 +9158,29 @@ double obs_QueryStdDev
         return NAN;
     }
 
-    BufferEntry_t* startEntryPtr = FindBufferEntry(obsPtr, startTime);
+    // Samples older than the buffer are in the spilled history.
+    double absStart;
+    if (IsHistoryQuery(obsPtr, startTime, &absStart))
+    {
+        double min, max, mean, stdDev;
+        uint32_t count;
+        GetHistoryStats(obsPtr, absStart, &min, &max, &mean, &stdDev, &count);
+        return stdDev;
+    }
+
+    // The running variance covers the whole buffer.
+    if (CanUseAggregates(obsPtr, startTime))
+    {
+        if (obsPtr->aggregates.count == 0)
+        {
+            return NAN;
+        }
+        return sqrt(obsPtr->aggregates.m2 / obsPtr->aggregates.count);
+    }
+
+    BufferPos_t startPos;
 
-    if (startEntryPtr == NULL)
+    if (!FindBufferEntry(obsPtr, startTime, &startPos))
     {
         return NAN;
     }
@@ -2748,10 +9188,11 @@ double obs_QueryStdDev
     double sum = 0;
     size_t count = 0;
 
-    BufferEntry_t* buffEntryPtr = startEntryPtr;
-    while (buffEntryPtr != NULL)
+    BufferPos_t pos = startPos;
+    bool havePos = true;
+    while (havePos)
     {
-        double value = GetBufferedNumber(buffEntryPtr, obsPtr->bufferedType);
+        double value = GetBufferedNumber(&pos, obsPtr->bufferedType);
 
         if (!isnan(value))
         {
@@ -2759,7 +9200,7 @@ double obs_QueryStdDev
             count++;
         }
 
-        buffEntryPtr = GetNextBufferEntry(obsPtr, buffEntryPtr);
+        havePos = GetNextBufferEntry(obsPtr, &pos);
     }
 
     if (count == 0)
@@ -2771,10 +9212,11 @@ double obs_QueryStdDev
 
     double sumOfSquaredDifferences = 0;
 
-    buffEntryPtr = startEntryPtr;
-    while (buffEntryPtr != NULL)
+    pos = startPos;
+    havePos = true;
+    while (havePos)
     {
-        double value = GetBufferedNumber(buffEntryPtr, obsPtr->bufferedType);
+        double value = GetBufferedNumber(&pos, obsPtr->bufferedType);
 
         if (!isnan(value))
         {
@@ -2782,13 +9224,137 @@ double obs_QueryStdDev
             sumOfSquaredDifferences += (diff * diff);
         }
 
-        buffEntryPtr = GetNextBufferEntry(obsPtr, buffEntryPtr);
+        havePos = GetNextBufferEntry(obsPtr, &pos);
     }
 
     return sqrt(sumOfSquaredDifferences / count);
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the minimum, maximum, mean and standard deviation of all values found within a given time
+ * span in an Observation's buffer, in a single pass over the buffer (or none, if the running
+ * aggregates cover the time span).
+ *
+ * If there's no numerical data in the Observation's buffer (if the buffer size is zero, the
+ * buffer is empty, or the buffer contains data of a non-numerical type), the count is zero and
+ * the statistics are NAN (not-a-number).
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_QueryStats
+(
+    res_Resource_t* resPtr,    ///< Ptr to Observation resource.
+    double startTime,   ///< If < 30 years then seconds before now; else seconds since the Epoch.
+    double* minPtr,     ///< [OUT] Minimum value.
+    double* maxPtr,     ///< [OUT] Maximum value.
+    double* meanPtr,    ///< [OUT] Mean value.
+    double* stdDevPtr,  ///< [OUT] Standard deviation.
+    uint32_t* countPtr  ///< [OUT] Number of values the statistics were computed from.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    CompleteRestore(obsPtr);
+
+    *minPtr = NAN;
+    *maxPtr = NAN;
+    *meanPtr = NAN;
+    *stdDevPtr = NAN;
+    *countPtr = 0;
+
+    // This only works for numeric or Boolean type data.
+    if (   (obsPtr->bufferedType != IO_DATA_TYPE_NUMERIC)
+        && (obsPtr->bufferedType != IO_DATA_TYPE_BOOLEAN)  )
+    {
+        return;
+    }
+
+    // Samples older than the buffer are in the spilled history.
+    double absStart;
+    if (IsHistoryQuery(obsPtr, startTime, &absStart))
+    {
+        GetHistoryStats(obsPtr, absStart, minPtr, maxPtr, meanPtr, stdDevPtr, countPtr);
+        return;
+    }
+
+    size_t count = 0;
+    double mean = 0;
+    double m2 = 0;
+    double min = NAN;
+    double max = NAN;
+    bool needScan = true;
+
+    // The running aggregates cover the whole buffer.  The minimum and maximum are only tracked
+    // for the transform that needs them, so the buffer may still have to be scanned for those.
+    if (CanUseAggregates(obsPtr, startTime))
+    {
+        count = obsPtr->aggregates.count;
+        mean = obsPtr->aggregates.mean;
+        m2 = obsPtr->aggregates.m2;
+
+        if (obsPtr->aggregates.minDeque.isEnabled && obsPtr->aggregates.maxDeque.isEnabled)
+        {
+            min = GetDequeFront(&obsPtr->aggregates.minDeque);
+            max = GetDequeFront(&obsPtr->aggregates.maxDeque);
+            needScan = false;
+        }
+        else if (count == 0)
+        {
+            needScan = false;
+        }
+    }
+
+    if (needScan)
+    {
+        bool isMeanNeeded = (count == 0);
+
+        BufferPos_t pos;
+        bool havePos = FindBufferEntry(obsPtr, startTime, &pos);
+
+        while (havePos)
+        {
+            double value = GetBufferedNumber(&pos, obsPtr->bufferedType);
+
+            if (!isnan(value))
+            {
+                if (isMeanNeeded)
+                {
+                    // Welford's algorithm.
+                    count++;
+                    double delta = value - mean;
+                    mean += delta / count;
+                    m2 += delta * (value - mean);
+                }
+
+                if (isnan(min) || (value < min))
+                {
+                    min = value;
+                }
+                if (isnan(max) || (value > max))
+                {
+                    max = value;
+                }
+            }
+
+            havePos = GetNextBufferEntry(obsPtr, &pos);
+        }
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    *minPtr = min;
+    *maxPtr = max;
+    *meanPtr = mean;
+    *stdDevPtr = sqrt(((m2 > 0) ? m2 : 0) / count);
+    *countPtr = count;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Function to get an Observation's Source path.
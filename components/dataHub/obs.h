@@ -24,6 +24,10 @@ typedef enum
     OBS_TRANSFORM_TYPE_STDDEV,
     OBS_TRANSFORM_TYPE_MAX,
     OBS_TRANSFORM_TYPE_MIN,
+    OBS_TRANSFORM_TYPE_BUCKET_MEAN,
+    OBS_TRANSFORM_TYPE_BUCKET_MIN,
+    OBS_TRANSFORM_TYPE_BUCKET_MAX,
+    OBS_TRANSFORM_TYPE_BUCKET_LAST,
 }
 obs_TransformType_t;
 
@@ -98,6 +102,34 @@ bool obs_ShouldAccept
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Determine, without creating a data sample, whether a numeric value pushed to a given
+ * Observation would certainly be dropped by it without changing any of its state.
+ *
+ * @return true if the value would be rejected.  false if it might be accepted.
+ */
+//--------------------------------------------------------------------------------------------------
+bool obs_WouldDropNumeric
+(
+    res_Resource_t* resPtr,
+    double value                ///< [IN] the numeric value
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count a numeric value that obs_WouldDropNumeric() found would be dropped by a given Observation
+ * as received and dropped by it, for the same reason as it would have been by obs_ShouldAccept().
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_CountNumericDrop
+(
+    res_Resource_t* resPtr,
+    double value                ///< [IN] the numeric value
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Perform processing of an accepted pushed data sample that is specific to an Observation
@@ -112,6 +144,25 @@ void obs_ProcessAccepted
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fold a data sample into the current bucket of an Observation's downsampling transform (if it
+ * has one).  This must be done before the sample is buffered.
+ *
+ * @note Takes ownership of the data sample reference.
+ *
+ * @return The data sample to carry on with (the aggregate of a completed bucket, or the sample
+ *         itself if the Observation isn't downsampling), or NULL if the sample was absorbed.
+ */
+//--------------------------------------------------------------------------------------------------
+dataSample_Ref_t obs_ApplyDownsampling
+(
+    res_Resource_t* resPtr,
+    io_DataType_t dataType,     ///< Data type of the data sample.
+    dataSample_Ref_t sampleRef  ///< Data sample.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Perform any post-filtering on a given Observation.
@@ -269,6 +320,24 @@ obs_TransformType_t obs_GetTransform
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a given transform, with given parameters, is the one currently applied to an
+ * Observation.  Setting a transform clears the Observation's buffer even if it is the same one,
+ * so this can be used to avoid re-applying it needlessly.
+ *
+ * @return true if setting this transform would not change the Observation's transform settings.
+ */
+//--------------------------------------------------------------------------------------------------
+bool obs_IsTransformSet
+(
+    res_Resource_t* resPtr,
+    obs_TransformType_t transformType,
+    const double* paramsPtr,
+    size_t paramsSize
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the maximum number of data samples to buffer in a given Observation.  Buffers are FIFO
@@ -325,6 +394,60 @@ uint32_t obs_GetBufferBackupPeriod
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the number of samples evicted from an Observation's buffer to keep in its spilled history
+ * on non-volatile storage.  See admin_SetBufferSpillMaxCount() for more information.
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_SetBufferSpillMaxCount
+(
+    res_Resource_t* resPtr,
+    uint32_t count
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of samples evicted from an Observation's buffer to keep in its spilled history.
+ * See admin_SetBufferSpillMaxCount() for more information.
+ *
+ * @return The spill count (in number of samples) or 0 if the spilled history is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t obs_GetBufferSpillMaxCount
+(
+    res_Resource_t* resPtr
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set whether an Observation's buffered numbers are kept with reduced precision.
+ * See admin_SetBufferPrecision() for more information.
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_SetBufferCompact
+(
+    res_Resource_t* resPtr,
+    bool isCompact
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether an Observation's buffered numbers are kept with reduced precision.
+ * See admin_SetBufferPrecision() for more information.
+ *
+ * @return true if they are.
+ */
+//--------------------------------------------------------------------------------------------------
+bool obs_IsBufferCompact
+(
+    res_Resource_t* resPtr
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Delete buffer backup files that aren't being used.
@@ -359,6 +482,72 @@ void obs_ReadBufferJson
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer in JSON format (like obs_ReadBufferJson()), decimated to at most a
+ * given number of samples using the Largest-Triangle-Three-Buckets algorithm, which keeps the
+ * visual shape of the data.  The first and the last samples are always included.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride instead.
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_ReadBufferJsonDecimated
+(
+    res_Resource_t* resPtr, ///< Ptr to the resource object for the Observation.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to read the whole buffer.
+    uint32_t maxCount,  ///< Max number of samples to read (at least 3); 0 = no limit.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the samples in a buffer between two times, in JSON format (like obs_ReadBufferJson()),
+ * decimated to at most a given number of samples using a given decimation mode.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride.
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_ReadBufferJsonRange
+(
+    res_Resource_t* resPtr, ///< Ptr to the resource object for the Observation.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to start at the oldest sample.
+    double endAt,   ///< End at this many seconds ago, or at an absolute number of seconds since
+                    ///< the Epoch (if endAt > 30 years).  Use NAN to read up to the newest sample.
+    uint32_t maxCount,  ///< Max number of samples to read; 0 = no limit.
+    query_DecimationMode_t decimation, ///< How to select the samples, if decimating.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer.  Data is written to a given file descriptor in CBOR format as an
+ * indefinite-length array of [timestamp, value] arrays.  Timestamps and numeric values are
+ * doubles, Boolean values are true or false, trigger values are null, and string and JSON values
+ * are text strings.
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_ReadBufferCbor
+(
+    res_Resource_t* resPtr, ///< Ptr to the resource object for the Observation.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to read the whole buffer.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Find the oldest data sample in a given Observation's buffer that is newer than a given timestamp.
@@ -405,6 +594,20 @@ const char* obs_GetJsonExtraction
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the compiled form of an Observation's JSON extraction specifier.
+ *
+ * @return Ptr to the compiled specifier, or NULL if JSON extraction is not set or the specifier
+ *         could not be compiled.
+ */
+//--------------------------------------------------------------------------------------------------
+const json_Extraction_t* obs_GetJsonProgram
+(
+    res_Resource_t* resPtr  ///< Observation resource.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the minimum value found in an Observation's data set within a given time span.
@@ -470,6 +673,28 @@ double obs_QueryStdDev
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the minimum, maximum, mean and standard deviation of all values found within a given time
+ * span in an Observation's buffer, all at once.
+ *
+ * If there's no numerical data in the Observation's buffer (if the buffer size is zero, the
+ * buffer is empty, or the buffer contains data of a non-numerical type), the count is zero and
+ * the statistics are NAN (not-a-number).
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_QueryStats
+(
+    res_Resource_t* resPtr,    ///< Ptr to Observation resource.
+    double startTime,   ///< If < 30 years then seconds before now; else seconds since the Epoch.
+    double* minPtr,     ///< [OUT] Minimum value.
+    double* maxPtr,     ///< [OUT] Maximum value.
+    double* meanPtr,    ///< [OUT] Mean value.
+    double* stdDevPtr,  ///< [OUT] Standard deviation.
+    uint32_t* countPtr  ///< [OUT] Number of values the statistics were computed from.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Trigger configService to call the destination callback, if registered.
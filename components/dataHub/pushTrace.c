@@ -0,0 +1,254 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file pushTrace.c
+ *
+ * Push latency tracing.  See pushTrace.h.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "dataHub.h"
+#include "pushTrace.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Latency histogram of a push stage.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t buckets[ADMIN_TRACE_HISTOGRAM_BUCKETS];  ///< Traced pushes, by log2 of the time.
+    uint32_t count;         ///< Number of traced pushes that went through the stage.
+    uint64_t totalTime;     ///< Total time spent in the stage (microseconds).
+    uint32_t maxTime;       ///< Longest time spent in the stage (microseconds).
+}
+Histogram_t;
+
+
+bool pushTrace_IsTracing = false;
+
+/// Trace one push out of every SamplePeriod (0 = tracing is off).
+static uint32_t SamplePeriod = 0;
+
+/// Number of pushes to let go by untraced before tracing the next one.
+static uint32_t SkipCount = 0;
+
+/// Time at which the push being traced arrived.
+static uint64_t PushStartTime;
+
+/// Time spent so far in each stage by the push being traced (microseconds).
+static uint64_t StageTimes[PUSHTRACE_STAGE_COUNT];
+
+/// Bit i is set if the push being traced has gone through stage i.
+static uint32_t StagesSeen;
+
+/// Latency histogram of each stage.
+static Histogram_t Histograms[PUSHTRACE_STAGE_COUNT];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a stage time to a histogram.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddToHistogram
+(
+    Histogram_t* histogramPtr,
+    uint64_t time               ///< Time spent in the stage (microseconds).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Bucket 0 is for less than 1 us, bucket i for [2^(i-1), 2^i) us.
+    size_t bucket = 0;
+    while (((time >> bucket) != 0) && (bucket < (ADMIN_TRACE_HISTOGRAM_BUCKETS - 1)))
+    {
+        bucket++;
+    }
+
+    histogramPtr->buckets[bucket]++;
+    histogramPtr->count++;
+    histogramPtr->totalTime += time;
+    if (time > histogramPtr->maxTime)
+    {
+        histogramPtr->maxTime = (time > UINT32_MAX ? UINT32_MAX : (uint32_t)time);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time, for timing a push stage.
+ *
+ * @return The time, in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t pushTrace_GetTime
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return ((uint64_t)now.sec * 1000000) + now.usec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the time that has been spent in a stage of the push being traced.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushTrace_AddStageTime
+(
+    admin_TraceStage_t stage,   ///< The stage.
+    uint64_t startTime          ///< The time at which the stage started.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    StageTimes[stage] += pushTrace_GetTime() - startTime;
+    StagesSeen |= (1U << stage);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called when a push arrives, to decide whether to trace it.
+ *
+ * Pushes that arrive while a traced push is being propagated (e.g., from a push handler) are
+ * part of that push, and are not traced separately.
+ *
+ * @return true if this call started tracing the push (pass it to pushTrace_End()).
+ */
+//--------------------------------------------------------------------------------------------------
+bool pushTrace_Begin
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((SamplePeriod == 0) || pushTrace_IsTracing)
+    {
+        return false;
+    }
+
+    if (SkipCount > 0)
+    {
+        SkipCount--;
+        return false;
+    }
+    SkipCount = SamplePeriod - 1;
+
+    memset(StageTimes, 0, sizeof(StageTimes));
+    StagesSeen = 0;
+    pushTrace_IsTracing = true;
+    PushStartTime = pushTrace_GetTime();
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called when a push has been propagated, to add its stage times to the histograms if it was
+ * traced.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushTrace_End
+(
+    bool isTraced       ///< The value returned by pushTrace_Begin().
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!isTraced)
+    {
+        return;
+    }
+
+    pushTrace_AddStageTime(ADMIN_TRACE_STAGE_TOTAL, PushStartTime);
+    pushTrace_IsTracing = false;
+
+    for (size_t stage = 0; stage < PUSHTRACE_STAGE_COUNT; stage++)
+    {
+        if (StagesSeen & (1U << stage))
+        {
+            AddToHistogram(&Histograms[stage], StageTimes[stage]);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set how often pushes are traced.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushTrace_SetSamplePeriod
+(
+    uint32_t samplePeriod   ///< Trace one push out of every samplePeriod (0 = stop tracing).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    SamplePeriod = samplePeriod;
+    SkipCount = 0;
+
+    // A push that is being traced when tracing is stopped still gets added to the histograms.
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the latency histogram of a push stage.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_BAD_PARAMETER if the stage is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pushTrace_GetHistogram
+(
+    admin_TraceStage_t stage,   ///< The stage.
+    uint32_t* bucketsPtr,       ///< [OUT] Number of traced pushes in each bucket.
+    size_t* bucketsSizePtr,     ///< [INOUT] Number of buckets.
+    uint32_t* countPtr,         ///< [OUT] Number of traced pushes that went through the stage.
+    uint64_t* totalTimePtr,     ///< [OUT] Total time spent in the stage (microseconds).
+    uint32_t* maxTimePtr        ///< [OUT] Longest time spent in the stage (microseconds).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((unsigned int)stage >= PUSHTRACE_STAGE_COUNT)
+    {
+        return LE_BAD_PARAMETER;
+    }
+
+    const Histogram_t* histogramPtr = &Histograms[stage];
+
+    if (*bucketsSizePtr > ADMIN_TRACE_HISTOGRAM_BUCKETS)
+    {
+        *bucketsSizePtr = ADMIN_TRACE_HISTOGRAM_BUCKETS;
+    }
+    memcpy(bucketsPtr, histogramPtr->buckets, *bucketsSizePtr * sizeof(uint32_t));
+
+    *countPtr = histogramPtr->count;
+    *totalTimePtr = histogramPtr->totalTime;
+    *maxTimePtr = histogramPtr->maxTime;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clear the latency histograms of all the push stages.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushTrace_Reset
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    memset(Histograms, 0, sizeof(Histograms));
+}
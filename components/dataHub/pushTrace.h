@@ -0,0 +1,164 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file pushTrace.h
+ *
+ * Push latency tracing.  Times the stages of a sample of the pushes received through the I/O API
+ * and keeps a histogram of the time spent in each stage.
+ *
+ * A push is traced from pushTrace_Begin() to pushTrace_End().  In between, every stage that
+ * it goes through is timed from pushTrace_StageStart() to pushTrace_StageEnd().  Those are
+ * inline, so that they only cost a flag check when the push is not being traced.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef PUSH_TRACE_H_INCLUDE_GUARD
+#define PUSH_TRACE_H_INCLUDE_GUARD
+
+
+/// Number of push stages that are timed.
+#define PUSHTRACE_STAGE_COUNT (ADMIN_TRACE_STAGE_DESTINATION + 1)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true while a push that is being traced is being propagated.
+ *
+ * @warning DO NOT set this anywhere but pushTrace.c.
+ */
+//--------------------------------------------------------------------------------------------------
+extern bool pushTrace_IsTracing;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time, for timing a push stage.
+ *
+ * @return The time, in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t pushTrace_GetTime
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the time that has been spent in a stage of the push being traced.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushTrace_AddStageTime
+(
+    admin_TraceStage_t stage,   ///< The stage.
+    uint64_t startTime          ///< The time at which the stage started.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start timing a stage of a push.
+ *
+ * @return The start time to pass to pushTrace_StageEnd() (0 if the push is not being traced).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t pushTrace_StageStart
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (pushTrace_IsTracing ? pushTrace_GetTime() : 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop timing a stage of a push.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void pushTrace_StageEnd
+(
+    admin_TraceStage_t stage,   ///< The stage.
+    uint64_t startTime          ///< The time returned by pushTrace_StageStart().
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (pushTrace_IsTracing)
+    {
+        pushTrace_AddStageTime(stage, startTime);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called when a push arrives, to decide whether to trace it.
+ *
+ * Pushes that arrive while a traced push is being propagated (e.g., from a push handler) are
+ * part of that push, and are not traced separately.
+ *
+ * @return true if this call started tracing the push (pass it to pushTrace_End()).
+ */
+//--------------------------------------------------------------------------------------------------
+bool pushTrace_Begin
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called when a push has been propagated, to add its stage times to the histograms if it was
+ * traced.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushTrace_End
+(
+    bool isTraced       ///< The value returned by pushTrace_Begin().
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set how often pushes are traced.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushTrace_SetSamplePeriod
+(
+    uint32_t samplePeriod   ///< Trace one push out of every samplePeriod (0 = stop tracing).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the latency histogram of a push stage.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_BAD_PARAMETER if the stage is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pushTrace_GetHistogram
+(
+    admin_TraceStage_t stage,   ///< The stage.
+    uint32_t* bucketsPtr,       ///< [OUT] Number of traced pushes in each bucket.
+    size_t* bucketsSizePtr,     ///< [INOUT] Number of buckets.
+    uint32_t* countPtr,         ///< [OUT] Number of traced pushes that went through the stage.
+    uint64_t* totalTimePtr,     ///< [OUT] Total time spent in the stage (microseconds).
+    uint32_t* maxTimePtr        ///< [OUT] Longest time spent in the stage (microseconds).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clear the latency histograms of all the push stages.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushTrace_Reset
+(
+    void
+);
+
+
+#endif // PUSH_TRACE_H_INCLUDE_GUARD
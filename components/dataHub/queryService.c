@@ -8,6 +8,7 @@
 
 #include "dataHub.h"
 #include "handler.h"
+#include "queryService.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -17,6 +18,122 @@
 //--------------------------------------------------------------------------------------------------
 static unsigned int PushHandlerCount;
 
+/// Default number of batched push handlers.  This can be overridden in the .cdef.
+#define DEFAULT_BATCH_PUSH_HANDLER_POOL_SIZE  8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Samples accumulated for a client's batched push handler, waiting to be delivered to it in a
+ * single call-back.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    hub_HandlerRef_t handlerRef;    ///< Push handler registered on the resource.
+    io_DataType_t dataType;         ///< IO_DATA_TYPE_BOOLEAN or IO_DATA_TYPE_NUMERIC.
+    void* callbackPtr;              ///< Client's batch call-back function.
+    void* contextPtr;               ///< Client's context pointer.
+    size_t maxCount;                ///< Number of pending samples that triggers a delivery.
+    le_timer_Ref_t timer;           ///< Delivery timer (NULL if there is no delay limit).
+    size_t count;                   ///< Number of pending samples.
+    double timestamps[IO_MAX_BATCH_LEN]; ///< Timestamps of the pending samples.
+    union
+    {
+        bool booleans[IO_MAX_BATCH_LEN];
+        double numerics[IO_MAX_BATCH_LEN];
+    }
+    values;                         ///< Values of the pending samples.
+}
+Batch_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which Batch_t objects are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t BatchPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(BatchPool, DEFAULT_BATCH_PUSH_HANDLER_POOL_SIZE, sizeof(Batch_t));
+
+/// Default number of bulk reads (query_GetMultiple()) that can be in progress at the same time.
+/// This can be overridden in the .cdef.
+#define DEFAULT_BULK_READ_POOL_SIZE  2
+
+/// Default number of write buffers for chunks of bulk reads holding long string or JSON values.
+/// This can be overridden in the .cdef.
+#define DEFAULT_BULK_READ_BUFFER_POOL_SIZE  1
+
+/// Maximum number of resources that a single bulk read can return.  This can be overridden in the
+/// .cdef.
+#ifndef DHUB_BULK_READ_MAX_COUNT
+#define DHUB_BULK_READ_MAX_COUNT 512
+#endif
+
+/// Number of bytes of formatted values that a bulk read tries to batch into each write, on top of
+/// the room reserved for one of the largest values.
+#ifndef DHUB_BULK_READ_BATCH_BYTES
+#define DHUB_BULK_READ_BATCH_BYTES 4096
+#endif
+
+/// Each value in a bulk read looks like the following:
+/// "/app/x/y":{"type":2,"ts":1537483647.125371,"value":12.5}
+/// The path and the value can both be as long as the longest ones allowed.  The time stamp
+/// typically won't have more than 6 decimal places.
+#define BULK_READ_VALUE_BYTES (HUB_MAX_RESOURCE_PATH_BYTES + HUB_MAX_STRING_BYTES + 64)
+
+/// Size of a bulk read's write buffer.  Includes room for the braces around the values.
+#define BULK_READ_CHUNK_BYTES (DHUB_BULK_READ_BATCH_BYTES + BULK_READ_VALUE_BYTES + 2)
+
+/// Trigger, Boolean and numeric values are much shorter.  The longest is a numeric value as large
+/// as a double can be, which takes up to 317 characters with "%lf".
+#define BULK_READ_SMALL_VALUE_BYTES (HUB_MAX_RESOURCE_PATH_BYTES + 400)
+
+/// Size of a bulk read's own write buffer, which holds any value but long strings or JSON.
+#define BULK_READ_SMALL_CHUNK_BYTES (DHUB_BULK_READ_BATCH_BYTES + BULK_READ_SMALL_VALUE_BYTES + 2)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record used for keeping track of a bulk read of the current values of several resources.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_fdMonitor_Ref_t fdMonitor;   ///< Used to get notification when the FD is clear to write.
+    int fd;                         ///< fd to write to.
+    enum { BULK_START, BULK_VALUES, BULK_END, BULK_DONE } state; ///< What to load next.
+    double since;                   ///< Only values newer than this are written (in s).
+    size_t count;                   ///< Number of entries to read.
+    size_t index;                   ///< Index of the entry to read next.
+    resTree_EntryRef_t entries[DHUB_BULK_READ_MAX_COUNT]; ///< Entries to read (ref counted).
+    bool needsComma;                ///< true if a comma must be written before the next value.
+    char* writeBuffer;              ///< Chunk being written (smallBuffer or from the buffer pool).
+    size_t writeBufferSize;         ///< Size of the writeBuffer, in bytes.
+    size_t writeLen;                ///< Number of characters in the writeBuffer.
+    size_t writeOffset;             ///< Offset into the writeBuffer to write from next.
+    query_ReadCompletionFunc_t handlerPtr; ///< Completion callback.
+    void* contextPtr;               ///< Value to be passed to completion callback.
+    char smallBuffer[BULK_READ_SMALL_CHUNK_BYTES]; ///< Write buffer for chunks of short values.
+}
+BulkRead_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which BulkRead_t objects are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t BulkReadPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(BulkReadPool, DEFAULT_BULK_READ_POOL_SIZE, sizeof(BulkRead_t));
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of write buffers for the chunks of bulk reads that hold long string or JSON values.  A
+ * bulk read only holds one while such a chunk is being written, so all bulk reads share them.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t BulkReadBufferPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(BulkReadBufferPool,
+                          DEFAULT_BULK_READ_BUFFER_POOL_SIZE,
+                          BULK_READ_CHUNK_BYTES);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Find an Observation.
@@ -119,6 +236,195 @@ le_result_t query_ReadBufferJson
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer in JSON format (like query_ReadBufferJson()), decimated to at most a
+ * given number of samples using the Largest-Triangle-Three-Buckets algorithm, which keeps the
+ * visual shape of the data.  The first and the last samples are always included.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride instead.
+ *
+ * @return
+ *  - LE_OK if the read operation started successfully.
+ *  - LE_NOT_FOUND if the Observation doesn't exist.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t query_ReadBufferJsonDecimated
+(
+    const char* obsPath,
+        ///< [IN] Observation path. Can be absolute
+        ///< (beginning with a '/') or relative to /obs/.
+    double startAfter,
+        ///< [IN] Start after this many seconds ago,
+        ///< or after an absolute number of seconds since the Epoch
+        ///< (if startafter > 30 years).
+        ///< Use NAN (not a number) to read the whole buffer.
+    uint32_t maxCount,
+        ///< [IN] Maximum number of samples to read (at least 3). 0 = no limit.
+    int outputFile,
+        ///< [IN] File descriptor to write the data to.
+    query_ReadCompletionFunc_t completionFuncPtr,
+        ///< [IN] Completion callback to be called when operation finishes.
+    void* contextPtr
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    resTree_EntryRef_t entryRef = FindObservation(obsPath);
+
+    if (entryRef == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    if (startAfter < 0)
+    {
+        LE_KILL_CLIENT("Negative startAfter time provided (%lf).", startAfter);
+        return LE_OK;   // Doesn't matter what we return.
+    }
+
+    resTree_ReadBufferJsonDecimated(entryRef,
+                                    startAfter,
+                                    maxCount,
+                                    outputFile,
+                                    completionFuncPtr,
+                                    contextPtr);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the samples in a buffer that are newer than a start time and not newer than an end time,
+ * in JSON format (like query_ReadBufferJson()), decimated to at most a given number of samples.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride.
+ *
+ * @return
+ *  - LE_OK if the read operation started successfully.
+ *  - LE_NOT_FOUND if the Observation doesn't exist.
+ *  - LE_BAD_PARAMETER if the decimation mode is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t query_ReadBufferJsonRange
+(
+    const char* obsPath,
+        ///< [IN] Observation path. Can be absolute
+        ///< (beginning with a '/') or relative to /obs/.
+    double startAfter,
+        ///< [IN] Start after this many seconds ago,
+        ///< or after an absolute number of seconds since the Epoch
+        ///< (if startafter > 30 years).
+        ///< Use NAN (not a number) to start at the oldest sample.
+    double endAt,
+        ///< [IN] End at this many seconds ago,
+        ///< or at an absolute number of seconds since the Epoch
+        ///< (if endAt > 30 years).
+        ///< Use NAN (not a number) to read up to the newest sample.
+    uint32_t maxCount,
+        ///< [IN] Maximum number of samples to read (at least 3 for LTTB). 0 = no limit.
+    query_DecimationMode_t mode,
+        ///< [IN] How to select the samples, if there are more than maxCount.
+    int outputFile,
+        ///< [IN] File descriptor to write the data to.
+    query_ReadCompletionFunc_t completionFuncPtr,
+        ///< [IN] Completion callback to be called when operation finishes.
+    void* contextPtr
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    resTree_EntryRef_t entryRef = FindObservation(obsPath);
+
+    if (entryRef == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    if ((startAfter < 0) || (endAt < 0))
+    {
+        LE_KILL_CLIENT("Negative startAfter (%lf) or endAt (%lf) time provided.",
+                       startAfter,
+                       endAt);
+        return LE_OK;   // Doesn't matter what we return.
+    }
+
+    if (   (mode != QUERY_DECIMATION_LTTB)
+        && (mode != QUERY_DECIMATION_STRIDE)
+        && (mode != QUERY_DECIMATION_MEAN))
+    {
+        LE_ERROR("Invalid decimation mode %d.", mode);
+        return LE_BAD_PARAMETER;
+    }
+
+    resTree_ReadBufferJsonRange(entryRef,
+                                startAfter,
+                                endAt,
+                                maxCount,
+                                mode,
+                                outputFile,
+                                completionFuncPtr,
+                                contextPtr);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer.  Data is written to a given file descriptor in CBOR format as an
+ * indefinite-length array of [timestamp, value] arrays.  Timestamps and numeric values are
+ * doubles, Boolean values are true or false, trigger values are null, and string and JSON values
+ * are text strings.  E.g., in CBOR diagnostic notation,
+ *
+ * @code
+ * [_ [1537483647.125, true], [1537483657.128, true]]
+ * @endcode
+ *
+ * @return
+ *  - LE_OK if the read operation started successfully.
+ *  - LE_NOT_FOUND if the Observation doesn't exist.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t query_ReadBufferCbor
+(
+    const char* obsPath,
+        ///< [IN] Observation path. Can be absolute
+        ///< (beginning with a '/') or relative to /obs/.
+    double startAfter,
+        ///< [IN] Start after this many seconds ago,
+        ///< or after an absolute number of seconds since the Epoch
+        ///< (if startafter > 30 years).
+        ///< Use NAN (not a number) to read the whole buffer.
+    int outputFile,
+        ///< [IN] File descriptor to write the data to.
+    query_ReadCompletionFunc_t completionFuncPtr,
+        ///< [IN] Completion callback to be called when operation finishes.
+    void* contextPtr
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    resTree_EntryRef_t entryRef = FindObservation(obsPath);
+
+    if (entryRef == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    if (startAfter < 0)
+    {
+        LE_KILL_CLIENT("Negative startAfter time provided (%lf).", startAfter);
+        return LE_OK;   // Doesn't matter what we return.
+    }
+
+    resTree_ReadBufferCbor(entryRef, startAfter, outputFile, completionFuncPtr, contextPtr);
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Read the timestamp of a single sample from a buffer.
@@ -555,6 +861,53 @@ double query_GetStdDev
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the minimum, maximum, mean and standard deviation of all values found within a given time
+ * span in an Observation's buffer, all at once.
+ *
+ * If there's no numerical data in the Observation's buffer (if the buffer size is zero, the
+ * buffer is empty, or the buffer contains data of a non-numerical type), the count is zero and
+ * the statistics are NAN (not-a-number).
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if the Observation doesn't exist.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t query_GetStats
+(
+    const char* obsPath,
+        ///< [IN] Observation path. Can be absolute
+        ///< (beginning with a '/') or relative to /obs/.
+    double startTime,
+        ///< [IN] If < 30 years then seconds before now; else seconds since the Epoch.
+    double* minPtr,
+        ///< [OUT] Minimum value.
+    double* maxPtr,
+        ///< [OUT] Maximum value.
+    double* meanPtr,
+        ///< [OUT] Mean (average) value.
+    double* stdDevPtr,
+        ///< [OUT] Standard deviation.
+    uint32_t* countPtr
+        ///< [OUT] Number of numerical values the statistics were computed from.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    resTree_EntryRef_t entryRef = FindObservation(obsPath);
+
+    if (entryRef == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    resTree_QueryStats(entryRef, startTime, minPtr, maxPtr, meanPtr, stdDevPtr, countPtr);
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Find a resource at a given path.  The path can be absolute (beginning with a '/'), or relative
@@ -1032,74 +1385,857 @@ le_result_t query_GetJsonExample
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add a handler function to be called when a value is pushed to (and accepted by) a resource
- * anywhere in the resource tree.  If there's no resource at that location yet, a placeholder will
- * be created.
+ * Check whether a bulk read should write out the current value of a given entry.
  *
- * @return A reference to the handler, which can be removed using handler_Remove().
- *         If adding the handler fails, NULL is returned.
+ * @return true if the entry is a resource whose current value is newer than the given time.
  */
 //--------------------------------------------------------------------------------------------------
-static hub_HandlerRef_t AddPushHandler
+static bool IsBulkValueWanted
 (
-    const char* path,   ///< Absolute resource path.
-    io_DataType_t dataType,
-    void* callbackPtr,  ///< Callback function pointer
-    void* contextPtr
+    resTree_EntryRef_t entryRef,
+    double since    ///< Only values newer than this are wanted (in s).
 )
 //--------------------------------------------------------------------------------------------------
 {
-#ifdef DHUB_QUERY_PUSH_HANDLER_COUNT
-    if (PushHandlerCount >= DHUB_QUERY_PUSH_HANDLER_COUNT)
-    {
-        return NULL;
-    }
-#endif
-    resTree_EntryRef_t resRef;
-    if (resTree_GetResource(resTree_GetRoot(), path, &resRef) != LE_OK)
-    {
-        LE_ERROR("Failed to get resource at '%s'.", path);
-        return NULL;
-    }
-    hub_HandlerRef_t handlerRef = resTree_AddPushHandler(resRef, dataType, callbackPtr, contextPtr);
-    if (handlerRef)
+    if (resTree_IsDeleted(entryRef) || !resTree_IsResource(entryRef))
     {
-        PushHandlerCount++;
+        return false;
     }
-    return handlerRef;
+
+    dataSample_Ref_t sampleRef = resTree_GetCurrentValue(entryRef);
+
+    return ((sampleRef != NULL) && (dataSample_GetTimestamp(sampleRef) > since));
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add handler function for EVENT 'query_TriggerPush'
+ * Add an entry to the set of entries read by a bulk read.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_OVERFLOW if the bulk read already has as many entries as it can hold.
  */
 //--------------------------------------------------------------------------------------------------
-query_TriggerPushHandlerRef_t query_AddTriggerPushHandler
+static le_result_t AddBulkReadEntry
 (
-    const char* path,
-        ///< [IN] Absolute path of resource.
-    query_TriggerPushHandlerFunc_t callbackPtr,
-        ///< [IN]
-    void* contextPtr
-        ///< [IN]
+    BulkRead_t* opPtr,
+    resTree_EntryRef_t entryRef
 )
 //--------------------------------------------------------------------------------------------------
 {
-    hub_HandlerRef_t ref = AddPushHandler(path, IO_DATA_TYPE_TRIGGER, callbackPtr, contextPtr);
+    if (opPtr->count >= DHUB_BULK_READ_MAX_COUNT)
+    {
+        return LE_OVERFLOW;
+    }
 
-    return (query_TriggerPushHandlerRef_t)ref;
+    // Hold a reference so the entry outlives a deletion until it has been read.
+    le_mem_AddRef(entryRef);
+    opPtr->entries[opPtr->count++] = entryRef;
+
+    return LE_OK;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Remove handler function for EVENT 'query_TriggerPush'
- */
-//--------------------------------------------------------------------------------------------------
+ * Add to a bulk read every entry in a given subtree whose current value is newer than the
+ * bulk read's "since" time.  Subtrees that haven't had a newer value are skipped without being
+ * walked.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_OVERFLOW if the bulk read can't hold all the entries.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AddBulkReadSubtree
+(
+    BulkRead_t* opPtr,
+    resTree_EntryRef_t entryRef     ///< Root of the subtree.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (resTree_GetSubtreeLastModified(entryRef) <= opPtr->since)
+    {
+        return LE_OK;
+    }
+
+    if (IsBulkValueWanted(entryRef, opPtr->since))
+    {
+        le_result_t result = AddBulkReadEntry(opPtr, entryRef);
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    for (resTree_EntryRef_t childRef = resTree_GetFirstChild(entryRef);
+         childRef != NULL;
+         childRef = resTree_GetNextSibling(childRef))
+    {
+        le_result_t result = AddBulkReadSubtree(opPtr, childRef);
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add to a bulk read the entries selected by one of the paths it was given.  A path ending in a
+ * '/' selects every resource beneath that namespace; any other path selects a single resource.
+ * Paths that don't select anything are ignored.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_OVERFLOW if the bulk read can't hold all the entries.
+ *  - LE_BAD_PARAMETER if the path is too long.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AddBulkReadPath
+(
+    BulkRead_t* opPtr,
+    const char* pathPtr,    ///< Path (not necessarily null-terminated).
+    size_t pathLen          ///< Length of the path, in bytes (> 0).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char path[HUB_MAX_RESOURCE_PATH_BYTES];
+
+    if (pathLen >= sizeof(path))
+    {
+        LE_ERROR("Path '%.*s' is too long.", (int)pathLen, pathPtr);
+        return LE_BAD_PARAMETER;
+    }
+
+    memcpy(path, pathPtr, pathLen);
+    path[pathLen] = '\0';
+
+    if (path[pathLen - 1] != '/')
+    {
+        resTree_EntryRef_t entryRef = FindResource(path);
+
+        if ((entryRef == NULL) || !IsBulkValueWanted(entryRef, opPtr->since))
+        {
+            return LE_OK;
+        }
+
+        return AddBulkReadEntry(opPtr, entryRef);
+    }
+
+    path[pathLen - 1] = '\0';
+
+    resTree_EntryRef_t nsRef;
+
+    if (path[0] == '\0')
+    {
+        nsRef = resTree_GetRoot();
+    }
+    else if (path[0] == '/')
+    {
+        nsRef = resTree_FindEntryAtAbsolutePath(path);
+    }
+    else
+    {
+        nsRef = hub_GetClientNamespace(query_GetClientSessionRef());
+
+        if (nsRef != NULL)
+        {
+            nsRef = resTree_FindEntry(nsRef, path);
+        }
+    }
+
+    if (nsRef == NULL)
+    {
+        return LE_OK;
+    }
+
+    return AddBulkReadSubtree(opPtr, nsRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Terminate a bulk read.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EndBulkRead
+(
+    BulkRead_t* opPtr,
+    le_result_t result
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (size_t i = 0; i < opPtr->count; i++)
+    {
+        le_mem_Release(opPtr->entries[i]);
+    }
+
+    le_fdMonitor_Delete(opPtr->fdMonitor);
+
+    close(opPtr->fd);
+
+    if (opPtr->writeBuffer != opPtr->smallBuffer)
+    {
+        le_mem_Release(opPtr->writeBuffer);
+    }
+
+    opPtr->handlerPtr(result, opPtr->contextPtr);
+
+    le_mem_Release(opPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Format the current value of a resource for a bulk read, as a JSON object member named after
+ * the resource's absolute path.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_OVERFLOW if the buffer provided is too small to hold it.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FormatBulkValue
+(
+    BulkRead_t* opPtr,
+    resTree_EntryRef_t entryRef,
+    char* buffPtr,          ///< [OUT] Ptr to buffer where the value will be stored.
+    size_t buffSize,        ///< [IN] Size of the buffer, in bytes.
+    size_t* lenPtr          ///< [OUT] Number of characters stored (excl. null terminator).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char path[HUB_MAX_RESOURCE_PATH_BYTES];
+    dataSample_Ref_t sampleRef = resTree_GetCurrentValue(entryRef);
+    io_DataType_t dataType = resTree_GetDataType(entryRef);
+
+    LE_ASSERT(resTree_GetPath(path, sizeof(path), resTree_GetRoot(), entryRef) >= 0);
+
+    int len = snprintf(buffPtr,
+                       buffSize,
+                       "%s\"%s\":{\"type\":%u,\"ts\":%lf%s",
+                       opPtr->needsComma ? "," : "",
+                       path,
+                       dataType,
+                       dataSample_GetTimestamp(sampleRef),
+                       (dataType == IO_DATA_TYPE_TRIGGER) ? "" : ",\"value\":");
+
+    // Leave room for an additional '}' at the end.
+    if ((len < 0) || ((size_t)len + 1 >= buffSize))
+    {
+        return LE_OVERFLOW;
+    }
+
+    if (dataType != IO_DATA_TYPE_TRIGGER)
+    {
+        le_result_t result;
+
+        if (dataType == IO_DATA_TYPE_JSON)
+        {
+            result = le_utf8_Copy(buffPtr + len,
+                                  dataSample_GetJson(sampleRef),
+                                  buffSize - len - 1,
+                                  NULL);
+        }
+        else
+        {
+            result = dataSample_ConvertToJson(sampleRef,
+                                              dataType,
+                                              buffPtr + len,
+                                              buffSize - len - 1);
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+
+        len += strlen(buffPtr + len);
+    }
+
+    buffPtr[len] = '}';
+
+    *lenPtr = len + 1;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Move the chunk being loaded by a bulk read from its own write buffer to one from the
+ * BulkReadBufferPool, to make room for a long string or JSON value.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NO_MEMORY if the pool is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t UseLargeBulkReadBuffer
+(
+    BulkRead_t* opPtr,
+    size_t len          ///< Number of characters already loaded into the chunk.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char* buffPtr = hub_MemAlloc(BulkReadBufferPool);
+    if (buffPtr == NULL)
+    {
+        LE_ERROR("Failed to allocate a bulk read buffer");
+        return LE_NO_MEMORY;
+    }
+
+    memcpy(buffPtr, opPtr->writeBuffer, len);
+    opPtr->writeBuffer = buffPtr;
+    opPtr->writeBufferSize = BULK_READ_CHUNK_BYTES;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the next chunk of a bulk read into its write buffer.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NO_MEMORY if a value is too long for the bulk read's own buffer and no larger one is free.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t LoadBulkReadBuffer
+(
+    BulkRead_t* opPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t len = 0;
+
+    if (opPtr->state == BULK_START)
+    {
+        opPtr->writeBuffer[len++] = '{';
+        opPtr->state = BULK_VALUES;
+    }
+
+    while (opPtr->state == BULK_VALUES)
+    {
+        if (opPtr->index >= opPtr->count)
+        {
+            opPtr->state = BULK_END;
+            break;
+        }
+
+        resTree_EntryRef_t entryRef = opPtr->entries[opPtr->index];
+
+        // The entry may have been deleted, or lost its value, since the read started.
+        if (IsBulkValueWanted(entryRef, opPtr->since))
+        {
+            // Leave room for the end of the object.
+            size_t spaceLeft = opPtr->writeBufferSize - len - 1;
+            size_t valueLen;
+
+            if (FormatBulkValue(opPtr, entryRef, opPtr->writeBuffer + len, spaceLeft, &valueLen)
+                == LE_OK)
+            {
+                len += valueLen;
+                opPtr->needsComma = true;
+            }
+            else if (spaceLeft <= (opPtr->writeBufferSize - DHUB_BULK_READ_BATCH_BYTES - 2))
+            {
+                // The value may fit in the next chunk, so send this one first.
+                break;
+            }
+            else if (opPtr->writeBuffer == opPtr->smallBuffer)
+            {
+                // Only long string and JSON values get here.  Try again in a larger buffer.
+                le_result_t result = UseLargeBulkReadBuffer(opPtr, len);
+                if (result != LE_OK)
+                {
+                    return result;
+                }
+                continue;
+            }
+            else
+            {
+                LE_ERROR("Value doesn't fit in write buffer. Skipping.");
+            }
+        }
+
+        opPtr->index++;
+    }
+
+    if (opPtr->state == BULK_END)
+    {
+        opPtr->writeBuffer[len++] = '}';
+        opPtr->state = BULK_DONE;
+    }
+
+    opPtr->writeLen = len;
+    opPtr->writeOffset = 0;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Continue a bulk read, writing to its file descriptor until it would block or there's nothing
+ * left to write.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ContinueBulkRead
+(
+    BulkRead_t* opPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (;;)
+    {
+        // If the write buffer has been written entirely, load the next chunk, unless the
+        // end of the object has already been written.
+        if (opPtr->writeOffset == opPtr->writeLen)
+        {
+            if (opPtr->state == BULK_DONE)
+            {
+                EndBulkRead(opPtr, LE_OK);
+
+                return;
+            }
+
+            // Give a large buffer back as soon as its chunk has been written, for other bulk
+            // reads to use.
+            if (opPtr->writeBuffer != opPtr->smallBuffer)
+            {
+                le_mem_Release(opPtr->writeBuffer);
+                opPtr->writeBuffer = opPtr->smallBuffer;
+                opPtr->writeBufferSize = sizeof(opPtr->smallBuffer);
+            }
+
+            le_result_t result = LoadBulkReadBuffer(opPtr);
+            if (result != LE_OK)
+            {
+                EndBulkRead(opPtr, result);
+
+                return;
+            }
+        }
+
+        ssize_t result;
+
+        do
+        {
+            result = write(opPtr->fd,
+                           opPtr->writeBuffer + opPtr->writeOffset,
+                           opPtr->writeLen - opPtr->writeOffset);
+
+        } while ((result == -1) && (errno == EINTR));
+
+        if (result == -1)
+        {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                // Return and wait for this function to be called again by the FD Monitor.
+                return;
+            }
+
+            LE_ERROR("Error writing (%m).");
+            EndBulkRead(opPtr, LE_COMM_ERROR);
+
+            return;
+        }
+
+        opPtr->writeOffset += result;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Event handler call-back for events on a bulk read's write file descriptor.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BulkReadFdEventHandler
+(
+    int fd,
+    short events
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(fd);
+
+    BulkRead_t* opPtr = le_fdMonitor_GetContextPtr();
+
+    // Check for error or hang-up.
+    if ((events & POLLERR) || (events & POLLHUP) || (events & POLLRDHUP))
+    {
+        LE_ERROR("Error or hang-up on output stream.");
+        EndBulkRead(opPtr, LE_COMM_ERROR);
+    }
+    // Note: The only other reason for this function to be called is POLLOUT (writeable).
+    else
+    {
+        ContinueBulkRead(opPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the current values of several resources at once.  Data is written to a given file
+ * descriptor as a JSON object with a member for each resource, named after the resource's
+ * absolute path, holding the data type, the time stamp and the value (except for triggers) of the
+ * resource's current value.  E.g.,
+ *
+ * @code
+ * {"/app/hmi/speed":{"type":2,"ts":1537483647.125,"value":12.5},
+ *  "/app/hmi/door":{"type":1,"ts":1537483657.128,"value":true}}
+ * @endcode
+ *
+ * Resources that don't have a current value newer than the given time are left out.  Long string
+ * and JSON values are written through a buffer shared by all bulk reads, and the read completes
+ * with LE_NO_MEMORY if none is free when one is needed.
+ *
+ * @return
+ *  - LE_OK if the read operation started successfully.
+ *  - LE_OVERFLOW if the paths select more resources than can be read at once.
+ *  - LE_BAD_PARAMETER if one of the paths is too long.
+ *  - LE_NO_MEMORY if too many bulk reads are already in progress.
+ *  - LE_COMM_ERROR if the file descriptor can't be written to.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t query_GetMultiple
+(
+    const char* paths,
+        ///< [IN] Newline-separated list of resource paths.
+        ///< Each can be absolute (beginning with a '/') or relative
+        ///< to the namespace of the calling app (/app/<app-name>/).
+        ///< A path ending in a '/' selects all resources in a namespace.
+    double since,
+        ///< [IN] Only read values newer than this (in seconds since
+        ///< the Epoch). Use BEGINNING_OF_TIME to read all values.
+    int outputFile,
+        ///< [IN] File descriptor to write the data to.
+    query_ReadCompletionFunc_t completionFuncPtr,
+        ///< [IN] Completion callback to be called when operation finishes.
+    void* contextPtr
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (since < 0)
+    {
+        LE_KILL_CLIENT("Negative since time provided (%lf).", since);
+        close(outputFile);
+        return LE_OK;   // Doesn't matter what we return.
+    }
+
+    BulkRead_t* opPtr = hub_MemAlloc(BulkReadPool);
+    if (opPtr == NULL)
+    {
+        LE_ERROR("Failed to allocate a bulk read");
+        close(outputFile);
+        return LE_NO_MEMORY;
+    }
+
+    opPtr->since = since;
+    opPtr->count = 0;
+
+    le_result_t result = LE_OK;
+    const char* pathPtr = paths;
+
+    while ((result == LE_OK) && (*pathPtr != '\0'))
+    {
+        size_t pathLen = strcspn(pathPtr, "\n");
+
+        if (pathLen > 0)
+        {
+            result = AddBulkReadPath(opPtr, pathPtr, pathLen);
+        }
+
+        pathPtr += pathLen;
+        if (*pathPtr == '\n')
+        {
+            pathPtr++;
+        }
+    }
+
+    // Set the fd non-blocking
+    if ((result == LE_OK) && (0 != fcntl(outputFile, F_SETFL, O_NONBLOCK)))
+    {
+        LE_ERROR("Failed to activate non-blocking mode (%m).");
+        result = LE_COMM_ERROR;
+    }
+
+    if (result != LE_OK)
+    {
+        for (size_t i = 0; i < opPtr->count; i++)
+        {
+            le_mem_Release(opPtr->entries[i]);
+        }
+        le_mem_Release(opPtr);
+        close(outputFile);
+
+        return result;
+    }
+
+    opPtr->fdMonitor = le_fdMonitor_Create("BulkRead", outputFile, BulkReadFdEventHandler, POLLOUT);
+    le_fdMonitor_SetContextPtr(opPtr->fdMonitor, opPtr);
+    opPtr->fd = outputFile;
+    opPtr->state = BULK_START;
+    opPtr->index = 0;
+    opPtr->needsComma = false;
+    opPtr->writeBuffer = opPtr->smallBuffer;
+    opPtr->writeBufferSize = sizeof(opPtr->smallBuffer);
+    opPtr->writeLen = 0;
+    opPtr->writeOffset = 0;
+    opPtr->handlerPtr = completionFuncPtr;
+    opPtr->contextPtr = contextPtr;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a handler function to be called when a value is pushed to (and accepted by) a resource
+ * anywhere in the resource tree.  If there's no resource at that location yet, a placeholder will
+ * be created.
+ *
+ * @return A reference to the handler, which can be removed using handler_Remove().
+ *         If adding the handler fails, NULL is returned.
+ */
+//--------------------------------------------------------------------------------------------------
+static hub_HandlerRef_t AddPushHandler
+(
+    const char* path,   ///< Absolute resource path.
+    io_DataType_t dataType,
+    void* callbackPtr,  ///< Callback function pointer
+    void* contextPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+#ifdef DHUB_QUERY_PUSH_HANDLER_COUNT
+    if (PushHandlerCount >= DHUB_QUERY_PUSH_HANDLER_COUNT)
+    {
+        return NULL;
+    }
+#endif
+    resTree_EntryRef_t resRef;
+    if (resTree_GetResource(resTree_GetRoot(), path, &resRef) != LE_OK)
+    {
+        LE_ERROR("Failed to get resource at '%s'.", path);
+        return NULL;
+    }
+    hub_HandlerRef_t handlerRef = resTree_AddPushHandler(resRef, dataType, callbackPtr, contextPtr);
+    if (handlerRef)
+    {
+        PushHandlerCount++;
+    }
+    return handlerRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'query_TriggerPush'
+ */
+//--------------------------------------------------------------------------------------------------
+query_TriggerPushHandlerRef_t query_AddTriggerPushHandler
+(
+    const char* path,
+        ///< [IN] Absolute path of resource.
+    query_TriggerPushHandlerFunc_t callbackPtr,
+        ///< [IN]
+    void* contextPtr
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    hub_HandlerRef_t ref = AddPushHandler(path, IO_DATA_TYPE_TRIGGER, callbackPtr, contextPtr);
+
+    return (query_TriggerPushHandlerRef_t)ref;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'query_TriggerPush'
+ */
+//--------------------------------------------------------------------------------------------------
 void query_RemoveTriggerPushHandler
 (
-    query_TriggerPushHandlerRef_t handlerRef
+    query_TriggerPushHandlerRef_t handlerRef
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (handler_Remove((hub_HandlerRef_t)handlerRef) == LE_OK)
+    {
+        LE_ASSERT(PushHandlerCount != 0);
+        PushHandlerCount--;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'query_BooleanPush'
+ */
+//--------------------------------------------------------------------------------------------------
+query_BooleanPushHandlerRef_t query_AddBooleanPushHandler
+(
+    const char* path,
+        ///< [IN] Absolute path of resource.
+    query_BooleanPushHandlerFunc_t callbackPtr,
+        ///< [IN]
+    void* contextPtr
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    hub_HandlerRef_t ref = AddPushHandler(path, IO_DATA_TYPE_BOOLEAN, callbackPtr, contextPtr);
+
+    return (query_BooleanPushHandlerRef_t)ref;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'query_BooleanPush'
+ */
+//--------------------------------------------------------------------------------------------------
+void query_RemoveBooleanPushHandler
+(
+    query_BooleanPushHandlerRef_t handlerRef
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (handler_Remove((hub_HandlerRef_t)handlerRef) == LE_OK)
+    {
+        LE_ASSERT(PushHandlerCount != 0);
+        PushHandlerCount--;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'query_NumericPush'
+ */
+//--------------------------------------------------------------------------------------------------
+query_NumericPushHandlerRef_t query_AddNumericPushHandler
+(
+    const char* path,
+        ///< [IN] Absolute path of resource.
+    query_NumericPushHandlerFunc_t callbackPtr,
+        ///< [IN]
+    void* contextPtr
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    hub_HandlerRef_t ref = AddPushHandler(path, IO_DATA_TYPE_NUMERIC, callbackPtr, contextPtr);
+
+    return (query_NumericPushHandlerRef_t)ref;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'query_NumericPush'
+ */
+//--------------------------------------------------------------------------------------------------
+void query_RemoveNumericPushHandler
+(
+    query_NumericPushHandlerRef_t handlerRef
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (handler_Remove((hub_HandlerRef_t)handlerRef) == LE_OK)
+    {
+        LE_ASSERT(PushHandlerCount != 0);
+        PushHandlerCount--;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'query_StringPush'
+ */
+//--------------------------------------------------------------------------------------------------
+query_StringPushHandlerRef_t query_AddStringPushHandler
+(
+    const char* path,
+        ///< [IN] Absolute path of resource.
+    query_StringPushHandlerFunc_t callbackPtr,
+        ///< [IN]
+    void* contextPtr
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    hub_HandlerRef_t ref = AddPushHandler(path, IO_DATA_TYPE_STRING, callbackPtr, contextPtr);
+
+    return (query_StringPushHandlerRef_t)ref;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'query_StringPush'
+ */
+//--------------------------------------------------------------------------------------------------
+void query_RemoveStringPushHandler
+(
+    query_StringPushHandlerRef_t handlerRef
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (handler_Remove((hub_HandlerRef_t)handlerRef) == LE_OK)
+    {
+        LE_ASSERT(PushHandlerCount != 0);
+        PushHandlerCount--;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'query_JsonPush'
+ */
+//--------------------------------------------------------------------------------------------------
+query_JsonPushHandlerRef_t query_AddJsonPushHandler
+(
+    const char* path,
+        ///< [IN] Absolute path of resource.
+    query_JsonPushHandlerFunc_t callbackPtr,
+        ///< [IN]
+    void* contextPtr
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    hub_HandlerRef_t ref = AddPushHandler(path, IO_DATA_TYPE_JSON, callbackPtr, contextPtr);
+
+    return (query_JsonPushHandlerRef_t)ref;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'query_JsonPush'
+ */
+//--------------------------------------------------------------------------------------------------
+void query_RemoveJsonPushHandler
+(
+    query_JsonPushHandlerRef_t handlerRef
         ///< [IN]
 )
 //--------------------------------------------------------------------------------------------------
@@ -1114,76 +2250,378 @@ void query_RemoveTriggerPushHandler
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add handler function for EVENT 'query_BooleanPush'
+ * Deliver all the pending samples of a batch to the client.
  */
 //--------------------------------------------------------------------------------------------------
-query_BooleanPushHandlerRef_t query_AddBooleanPushHandler
+static void DeliverBatch
+(
+    Batch_t* batchPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (batchPtr->timer != NULL)
+    {
+        le_timer_Stop(batchPtr->timer);
+    }
+
+    size_t count = batchPtr->count;
+    batchPtr->count = 0;
+
+    if (batchPtr->dataType == IO_DATA_TYPE_BOOLEAN)
+    {
+        query_BooleanBatchPushHandlerFunc_t callbackPtr = batchPtr->callbackPtr;
+        callbackPtr(batchPtr->timestamps, count,
+                    batchPtr->values.booleans, count,
+                    batchPtr->contextPtr);
+    }
+    else
+    {
+        query_NumericBatchPushHandlerFunc_t callbackPtr = batchPtr->callbackPtr;
+        callbackPtr(batchPtr->timestamps, count,
+                    batchPtr->values.numerics, count,
+                    batchPtr->contextPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record that a sample has been added to a batch, delivering the batch if it is now full.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddedToBatch
+(
+    Batch_t* batchPtr,
+    double timestamp
+)
+//--------------------------------------------------------------------------------------------------
+{
+    batchPtr->timestamps[batchPtr->count] = timestamp;
+    batchPtr->count++;
+
+    if (batchPtr->count >= batchPtr->maxCount)
+    {
+        DeliverBatch(batchPtr);
+    }
+    else if ((batchPtr->count == 1) && (batchPtr->timer != NULL))
+    {
+        le_timer_Start(batchPtr->timer);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Boolean push handler registered on a resource on behalf of a batched push handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BatchBooleanPushHandler
+(
+    double timestamp,
+    bool value,
+    void* contextPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Batch_t* batchPtr = contextPtr;
+
+    batchPtr->values.booleans[batchPtr->count] = value;
+    AddedToBatch(batchPtr, timestamp);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Numeric push handler registered on a resource on behalf of a batched push handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BatchNumericPushHandler
+(
+    double timestamp,
+    double value,
+    void* contextPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Batch_t* batchPtr = contextPtr;
+
+    batchPtr->values.numerics[batchPtr->count] = value;
+    AddedToBatch(batchPtr, timestamp);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called when a batch's delivery timer expires.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BatchTimerExpired
+(
+    le_timer_Ref_t timer
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Batch_t* batchPtr = le_timer_GetContextPtr(timer);
+
+    if (batchPtr->count > 0)
+    {
+        DeliverBatch(batchPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a batched push handler.
+ *
+ * @return Ptr to the batch, or NULL if adding the handler failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static Batch_t* AddBatchPushHandler
+(
+    const char* path,       ///< Absolute resource path.
+    io_DataType_t dataType, ///< IO_DATA_TYPE_BOOLEAN or IO_DATA_TYPE_NUMERIC.
+    uint32_t maxCount,      ///< Number of pending samples to deliver at once (0 = maximum).
+    uint32_t maxDelayMs,    ///< Longest time a sample may be held back (0 = no limit).
+    void* callbackPtr,      ///< Client's batch call-back function.
+    void* contextPtr        ///< Client's context pointer.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Batch_t* batchPtr = hub_MemAlloc(BatchPool);
+    if (batchPtr == NULL)
+    {
+        LE_ERROR("Failed to allocate a batched push handler for '%s'.", path);
+        return NULL;
+    }
+
+    batchPtr->handlerRef = AddPushHandler(path,
+                                          dataType,
+                                          (dataType == IO_DATA_TYPE_BOOLEAN ?
+                                            (void*)BatchBooleanPushHandler :
+                                            (void*)BatchNumericPushHandler),
+                                          batchPtr);
+    if (batchPtr->handlerRef == NULL)
+    {
+        le_mem_Release(batchPtr);
+        return NULL;
+    }
+
+    batchPtr->dataType = dataType;
+    batchPtr->callbackPtr = callbackPtr;
+    batchPtr->contextPtr = contextPtr;
+    batchPtr->count = 0;
+
+    if ((maxCount == 0) || (maxCount > IO_MAX_BATCH_LEN))
+    {
+        maxCount = IO_MAX_BATCH_LEN;
+    }
+    batchPtr->maxCount = maxCount;
+
+    batchPtr->timer = NULL;
+    if (maxDelayMs != 0)
+    {
+        batchPtr->timer = le_timer_Create("queryBatch");
+        LE_ASSERT(le_timer_SetMsInterval(batchPtr->timer, maxDelayMs) == LE_OK);
+        LE_ASSERT(le_timer_SetHandler(batchPtr->timer, BatchTimerExpired) == LE_OK);
+        LE_ASSERT(le_timer_SetContextPtr(batchPtr->timer, batchPtr) == LE_OK);
+    }
+
+    return batchPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a batched push handler, discarding any samples not yet delivered.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveBatchPushHandler
+(
+    Batch_t* batchPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (batchPtr == NULL)
+    {
+        LE_ERROR("Invalid batched push handler reference.");
+        return;
+    }
+
+    if (handler_Remove(batchPtr->handlerRef) == LE_OK)
+    {
+        LE_ASSERT(PushHandlerCount != 0);
+        PushHandlerCount--;
+    }
+
+    if (batchPtr->timer != NULL)
+    {
+        le_timer_Delete(batchPtr->timer);
+    }
+
+    le_mem_Release(batchPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'query_BooleanBatchPush'
+ */
+//--------------------------------------------------------------------------------------------------
+query_BooleanBatchPushHandlerRef_t query_AddBooleanBatchPushHandler
 (
     const char* path,
         ///< [IN] Absolute path of resource.
-    query_BooleanPushHandlerFunc_t callbackPtr,
+    uint32_t maxCount,
+        ///< [IN] Pending samples to deliver at once (0 = io.MAX_BATCH_LEN).
+    uint32_t maxDelayMs,
+        ///< [IN] Longest time (ms) a sample may be held back (0 = no limit).
+    query_BooleanBatchPushHandlerFunc_t callbackPtr,
         ///< [IN]
     void* contextPtr
         ///< [IN]
 )
 //--------------------------------------------------------------------------------------------------
 {
-    hub_HandlerRef_t ref = AddPushHandler(path, IO_DATA_TYPE_BOOLEAN, callbackPtr, contextPtr);
+    Batch_t* batchPtr = AddBatchPushHandler(path, IO_DATA_TYPE_BOOLEAN, maxCount, maxDelayMs,
+                                            callbackPtr, contextPtr);
 
-    return (query_BooleanPushHandlerRef_t)ref;
+    return (query_BooleanBatchPushHandlerRef_t)batchPtr;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Remove handler function for EVENT 'query_BooleanPush'
+ * Remove handler function for EVENT 'query_BooleanBatchPush'
  */
 //--------------------------------------------------------------------------------------------------
-void query_RemoveBooleanPushHandler
+void query_RemoveBooleanBatchPushHandler
 (
-    query_BooleanPushHandlerRef_t handlerRef
+    query_BooleanBatchPushHandlerRef_t handlerRef
         ///< [IN]
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (handler_Remove((hub_HandlerRef_t)handlerRef) == LE_OK)
+    RemoveBatchPushHandler((Batch_t*)handlerRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'query_NumericBatchPush'
+ */
+//--------------------------------------------------------------------------------------------------
+query_NumericBatchPushHandlerRef_t query_AddNumericBatchPushHandler
+(
+    const char* path,
+        ///< [IN] Absolute path of resource.
+    uint32_t maxCount,
+        ///< [IN] Pending samples to deliver at once (0 = io.MAX_BATCH_LEN).
+    uint32_t maxDelayMs,
+        ///< [IN] Longest time (ms) a sample may be held back (0 = no limit).
+    query_NumericBatchPushHandlerFunc_t callbackPtr,
+        ///< [IN]
+    void* contextPtr
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Batch_t* batchPtr = AddBatchPushHandler(path, IO_DATA_TYPE_NUMERIC, maxCount, maxDelayMs,
+                                            callbackPtr, contextPtr);
+
+    return (query_NumericBatchPushHandlerRef_t)batchPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'query_NumericBatchPush'
+ */
+//--------------------------------------------------------------------------------------------------
+void query_RemoveNumericBatchPushHandler
+(
+    query_NumericBatchPushHandlerRef_t handlerRef
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    RemoveBatchPushHandler((Batch_t*)handlerRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a push handler that only gets called with the samples that pass a given filter.
+ *
+ * @return A reference to the handler, which can be removed using handler_Remove().
+ *         If adding the handler fails, NULL is returned.
+ */
+//--------------------------------------------------------------------------------------------------
+static hub_HandlerRef_t AddFilteredPushHandler
+(
+    const char* path,   ///< Absolute resource path.
+    io_DataType_t dataType,
+    double minPeriod,   ///< Minimum time between deliveries (s).  0 or NAN = no minimum.
+    double changeBy,    ///< Minimum change since the last delivered value.  0 or NAN = any.
+    double lowLimit,    ///< Lowest numeric value delivered.  NAN = no limit.
+    double highLimit,   ///< Highest numeric value delivered.  NAN = no limit.
+    void* callbackPtr,  ///< Callback function pointer
+    void* contextPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (minPeriod < 0)
     {
-        LE_ASSERT(PushHandlerCount != 0);
-        PushHandlerCount--;
+        LE_KILL_CLIENT("Negative minPeriod provided (%lf).", minPeriod);
+        return NULL;
+    }
+
+    hub_HandlerRef_t handlerRef = AddPushHandler(path, dataType, callbackPtr, contextPtr);
+    if (handlerRef != NULL)
+    {
+        handler_SetFilter(handlerRef, minPeriod, changeBy, lowLimit, highLimit);
     }
+
+    return handlerRef;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add handler function for EVENT 'query_NumericPush'
+ * Add handler function for EVENT 'query_FilteredBooleanPush'
  */
 //--------------------------------------------------------------------------------------------------
-query_NumericPushHandlerRef_t query_AddNumericPushHandler
+query_FilteredBooleanPushHandlerRef_t query_AddFilteredBooleanPushHandler
 (
     const char* path,
         ///< [IN] Absolute path of resource.
-    query_NumericPushHandlerFunc_t callbackPtr,
+    double minPeriod,
+        ///< [IN] Minimum time between notifications (s).  0 or NAN = no minimum.
+    double changeBy,
+        ///< [IN] Non-zero to only notify when the value changes.
+    query_BooleanPushHandlerFunc_t callbackPtr,
         ///< [IN]
     void* contextPtr
         ///< [IN]
 )
 //--------------------------------------------------------------------------------------------------
 {
-    hub_HandlerRef_t ref = AddPushHandler(path, IO_DATA_TYPE_NUMERIC, callbackPtr, contextPtr);
+    hub_HandlerRef_t ref = AddFilteredPushHandler(path, IO_DATA_TYPE_BOOLEAN,
+                                                  minPeriod, changeBy, NAN, NAN,
+                                                  callbackPtr, contextPtr);
 
-    return (query_NumericPushHandlerRef_t)ref;
+    return (query_FilteredBooleanPushHandlerRef_t)ref;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Remove handler function for EVENT 'query_NumericPush'
+ * Remove handler function for EVENT 'query_FilteredBooleanPush'
  */
 //--------------------------------------------------------------------------------------------------
-void query_RemoveNumericPushHandler
+void query_RemoveFilteredBooleanPushHandler
 (
-    query_NumericPushHandlerRef_t handlerRef
+    query_FilteredBooleanPushHandlerRef_t handlerRef
         ///< [IN]
 )
 //--------------------------------------------------------------------------------------------------
@@ -1198,34 +2636,45 @@ void query_RemoveNumericPushHandler
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add handler function for EVENT 'query_StringPush'
+ * Add handler function for EVENT 'query_FilteredNumericPush'
  */
 //--------------------------------------------------------------------------------------------------
-query_StringPushHandlerRef_t query_AddStringPushHandler
+query_FilteredNumericPushHandlerRef_t query_AddFilteredNumericPushHandler
 (
     const char* path,
         ///< [IN] Absolute path of resource.
-    query_StringPushHandlerFunc_t callbackPtr,
+    double minPeriod,
+        ///< [IN] Minimum time between notifications (s).  0 or NAN = no minimum.
+    double changeBy,
+        ///< [IN] Minimum change since the last value notified.  0 or NAN = any.
+    double lowLimit,
+        ///< [IN] Lowest value notified.  NAN = no limit.
+    double highLimit,
+        ///< [IN] Highest value notified.  NAN = no limit.  If lower than
+        ///< lowLimit, only values outside of the range between are notified.
+    query_NumericPushHandlerFunc_t callbackPtr,
         ///< [IN]
     void* contextPtr
         ///< [IN]
 )
 //--------------------------------------------------------------------------------------------------
 {
-    hub_HandlerRef_t ref = AddPushHandler(path, IO_DATA_TYPE_STRING, callbackPtr, contextPtr);
+    hub_HandlerRef_t ref = AddFilteredPushHandler(path, IO_DATA_TYPE_NUMERIC,
+                                                  minPeriod, changeBy, lowLimit, highLimit,
+                                                  callbackPtr, contextPtr);
 
-    return (query_StringPushHandlerRef_t)ref;
+    return (query_FilteredNumericPushHandlerRef_t)ref;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Remove handler function for EVENT 'query_StringPush'
+ * Remove handler function for EVENT 'query_FilteredNumericPush'
  */
 //--------------------------------------------------------------------------------------------------
-void query_RemoveStringPushHandler
+void query_RemoveFilteredNumericPushHandler
 (
-    query_StringPushHandlerRef_t handlerRef
+    query_FilteredNumericPushHandlerRef_t handlerRef
         ///< [IN]
 )
 //--------------------------------------------------------------------------------------------------
@@ -1240,34 +2689,40 @@ void query_RemoveStringPushHandler
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add handler function for EVENT 'query_JsonPush'
+ * Add handler function for EVENT 'query_FilteredStringPush'
  */
 //--------------------------------------------------------------------------------------------------
-query_JsonPushHandlerRef_t query_AddJsonPushHandler
+query_FilteredStringPushHandlerRef_t query_AddFilteredStringPushHandler
 (
     const char* path,
         ///< [IN] Absolute path of resource.
-    query_JsonPushHandlerFunc_t callbackPtr,
+    double minPeriod,
+        ///< [IN] Minimum time between notifications (s).  0 or NAN = no minimum.
+    double changeBy,
+        ///< [IN] Non-zero to only notify when the value changes.
+    query_StringPushHandlerFunc_t callbackPtr,
         ///< [IN]
     void* contextPtr
         ///< [IN]
 )
 //--------------------------------------------------------------------------------------------------
 {
-    hub_HandlerRef_t ref = AddPushHandler(path, IO_DATA_TYPE_JSON, callbackPtr, contextPtr);
+    hub_HandlerRef_t ref = AddFilteredPushHandler(path, IO_DATA_TYPE_STRING,
+                                                  minPeriod, changeBy, NAN, NAN,
+                                                  callbackPtr, contextPtr);
 
-    return (query_JsonPushHandlerRef_t)ref;
+    return (query_FilteredStringPushHandlerRef_t)ref;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Remove handler function for EVENT 'query_JsonPush'
+ * Remove handler function for EVENT 'query_FilteredStringPush'
  */
 //--------------------------------------------------------------------------------------------------
-void query_RemoveJsonPushHandler
+void query_RemoveFilteredStringPushHandler
 (
-    query_JsonPushHandlerRef_t handlerRef
+    query_FilteredStringPushHandlerRef_t handlerRef
         ///< [IN]
 )
 //--------------------------------------------------------------------------------------------------
@@ -1278,3 +2733,29 @@ void query_RemoveJsonPushHandler
         PushHandlerCount--;
     }
 }
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the module.  Must be called before any other functions in the module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void queryService_Init
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    BatchPool = le_mem_InitStaticPool(BatchPool, DEFAULT_BATCH_PUSH_HANDLER_POOL_SIZE,
+                    sizeof(Batch_t));
+    hub_RegisterPool(BatchPool);
+
+    BulkReadPool = le_mem_InitStaticPool(BulkReadPool, DEFAULT_BULK_READ_POOL_SIZE,
+                    sizeof(BulkRead_t));
+    hub_RegisterPool(BulkReadPool);
+
+    BulkReadBufferPool = le_mem_InitStaticPool(BulkReadBufferPool,
+                                               DEFAULT_BULK_READ_BUFFER_POOL_SIZE,
+                                               BULK_READ_CHUNK_BYTES);
+    hub_RegisterPool(BulkReadBufferPool);
+}
@@ -0,0 +1,27 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file queryService.h
+ *
+ * Declarations of functions that are provided by the queryService module to other modules inside
+ * the Data Hub.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef QUERY_SERVICE_H_INCLUDE_GUARD
+#define QUERY_SERVICE_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the module.  Must be called before any other functions in the module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void queryService_Init
+(
+    void
+);
+
+
+#endif // QUERY_SERVICE_H_INCLUDE_GUARD
@@ -13,6 +13,74 @@
 #include "resTree.h"
 #include "adminService.h"
 #include "snapshot.h"
+#include "jsonWorker.h"
+
+/// Number of children a namespace must have before its children are indexed by name hash.
+/// This can be overridden in the .cdef.
+#ifndef DHUB_CHILD_INDEX_THRESHOLD
+#define DHUB_CHILD_INDEX_THRESHOLD 32
+#endif
+
+/// Number of hash buckets in a Child Index (must be a power of 2).
+/// This can be overridden in the .cdef.
+#ifndef DHUB_CHILD_INDEX_BUCKETS
+#define DHUB_CHILD_INDEX_BUCKETS 256
+#endif
+
+#if (DHUB_CHILD_INDEX_BUCKETS & (DHUB_CHILD_INDEX_BUCKETS - 1)) != 0
+#error "DHUB_CHILD_INDEX_BUCKETS must be a power of 2"
+#endif
+
+/// Number of hash buckets in the Name Table (must be a power of 2).
+/// This can be overridden in the .cdef.
+#ifndef DHUB_NAME_TABLE_BUCKETS
+#define DHUB_NAME_TABLE_BUCKETS 256
+#endif
+
+#if (DHUB_NAME_TABLE_BUCKETS & (DHUB_NAME_TABLE_BUCKETS - 1)) != 0
+#error "DHUB_NAME_TABLE_BUCKETS must be a power of 2"
+#endif
+
+/// Maximum number of paths that can be marked high-priority at the same time.
+/// This can be overridden in the .cdef.
+#ifndef DHUB_MAX_PRIORITY_PATHS
+#define DHUB_MAX_PRIORITY_PATHS 8
+#endif
+
+/// Number of relevance slots: one for applying a configuration and one for each snapshot session.
+#define RELEVANCE_SLOTS (RESTREE_CONFIG_RELEVANCE_SLOT + 1 + DHUB_SNAPSHOT_MAX_SESSIONS)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Interned entry name.  Entries with the same name (e.g., all the "value" resources) share the
+ * same Name object, which is kept in the Name Table and only takes as much space as the name
+ * needs.
+ *
+ * These are allocated from the NamePool (or one of its reduced pools, depending on the length of
+ * the name).
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct Name
+{
+    struct Name* nextPtr;   ///< Next Name in the same Name Table bucket.
+    uint32_t hash;          ///< Hash of the name.
+    uint32_t refCount;      ///< Number of entries with this name.
+    uint8_t length;         ///< Number of bytes in the name (excluding the terminator).
+    char str[];             ///< The name (null-terminated).
+}
+Name_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Index of the children of a namespace with many children, to find them by name without walking
+ * the whole list of children.  Children are chained into buckets by the hash of their name.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    struct resTree_Entry* buckets[DHUB_CHILD_INDEX_BUCKETS]; ///< Chains of children.
+}
+ChildIndex_t;
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -23,30 +91,409 @@
 //--------------------------------------------------------------------------------------------------
 typedef struct resTree_Entry
 {
+    // Members used when looking up children and checking timeliness come first, so they share a
+    // cache line.
     le_dls_Link_t link;  ///< Used to link into parent's list of children.
-    struct resTree_Entry* parentPtr; ///< Ptr to the parent entry (NULL if the root entry).
-    char name[HUB_MAX_ENTRY_NAME_BYTES]; ///< Name of the entry.
-    le_dls_List_t childList;  ///< List of child entries.
+    const Name_t* namePtr; ///< Name of the entry (interned).
+    struct resTree_Entry* hashNextPtr; ///< Next entry in the parent's Child Index bucket.
     admin_EntryType_t type; ///< The type of entry.
+    uint32_t childCount; ///< Number of child entries (including deleted ones not yet flushed).
 
     union
     {
         res_Resource_t  *resourcePtr;   ///< Ptr to the Resource object.
         uint32_t         flags;         ///< Flags if this is just a namespace.
     } u;
+
+    struct resTree_Entry* parentPtr; ///< Ptr to the parent entry (NULL if the root entry).
+    le_dls_List_t childList;  ///< List of child entries.
+    ChildIndex_t* childIndexPtr; ///< Index of child entries by name (NULL if not indexed).
+    le_dls_Link_t changeLink; ///< Used to link into the Change Journal (once it has had a value).
+    double changeTime; ///< Time stamp of the entry's value when it was last journaled.
+    double subtreeChangeTime; ///< Newest changeTime of the entry and all its descendants.
+    le_dls_Link_t structureLink; ///< Used to link into the Structure Journal.
+    uint32_t relevantPass[RELEVANCE_SLOTS]; ///< Relevance pass the entry is relevant to in each
+                                            ///< relevance slot (0 = none).
+#ifdef DHUB_PATH_CACHE
+    char* pathPtr; ///< Absolute path of the entry (NULL until first needed).
+#endif
 }
 Entry_t;
 
 /// Default number of resource tree entries.  This can be overridden in the .cdef.
 #define DEFAULT_RESOURCE_TREE_ENTRY_POOL_SIZE 10
 
+/// Change Journal: every entry that has had a current value, ordered by the time stamp of that
+/// value (oldest first), so the entries changed since a given time are found from the tail without
+/// walking the tree.
+static le_dls_List_t ChangeJournal = LE_DLS_LIST_INIT;
+
+/// Structure Journal: entries that may have been created since the last snapshot or deleted since
+/// the last deletion flush.  Entries that turn out to be neither are dropped when their newness is
+/// cleared, or when they are destroyed.
+static le_dls_List_t StructureJournal = LE_DLS_LIST_INIT;
+
+/// Current relevance pass of each relevance slot.  An entry is relevant in a slot if its
+/// relevantPass matches this, so starting a new pass makes every entry irrelevant at once.
+static uint32_t RelevancePass[RELEVANCE_SLOTS];
+
 /// Pointer to the Root object (the root of the resource tree).
 static Entry_t* RootPtr;
 
+/// Absolute paths of the namespaces and resources marked high-priority.  Route pushes to the
+/// resources at or under these paths are processed ahead of all the others.
+static char PriorityPaths[DHUB_MAX_PRIORITY_PATHS][HUB_MAX_RESOURCE_PATH_BYTES];
+
+/// Number of paths in PriorityPaths[].
+static size_t PriorityPathCount = 0;
+
 /// Pool of Entry objects.
 static le_mem_PoolRef_t EntryPool = NULL;
 LE_MEM_DEFINE_STATIC_POOL(EntryPool, DEFAULT_RESOURCE_TREE_ENTRY_POOL_SIZE, sizeof(Entry_t));
 
+/// Default number of Child Indexes.  This can be overridden in the .cdef.
+#define DEFAULT_CHILD_INDEX_POOL_SIZE 2
+
+/// Pool of Child Index objects.
+static le_mem_PoolRef_t ChildIndexPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(ChildIndexPool, DEFAULT_CHILD_INDEX_POOL_SIZE, sizeof(ChildIndex_t));
+
+/// Size of Name objects holding the longest allowed names.
+#define NAME_LARGE_BYTES    (offsetof(Name_t, str) + HUB_MAX_ENTRY_NAME_BYTES)
+/// Size of Name objects holding medium length names.
+#define NAME_MED_BYTES      48
+/// Size of Name objects holding short names.
+#define NAME_SMALL_BYTES    32
+
+/// Default number of large Name objects.  This can be overridden in the .cdef.
+#define DEFAULT_LARGE_NAME_POOL_SIZE 4
+
+/// Number of medium Name objects.
+#define MED_NAME_POOL_SIZE                                                                  \
+    (((LE_MEM_BLOCKS(NamePool, DEFAULT_LARGE_NAME_POOL_SIZE) / 2) * NAME_LARGE_BYTES)      \
+        / NAME_MED_BYTES)
+
+/// Number of small Name objects.
+#define SMALL_NAME_POOL_SIZE \
+    (((MED_NAME_POOL_SIZE / 2) * NAME_MED_BYTES) / NAME_SMALL_BYTES)
+
+/// Pool of Name objects.
+static le_mem_PoolRef_t NamePool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(NamePool, DEFAULT_LARGE_NAME_POOL_SIZE, NAME_LARGE_BYTES);
+
+/// Table of interned names, chained into buckets by hash.
+static Name_t* NameTable[DHUB_NAME_TABLE_BUCKETS];
+
+#ifdef DHUB_PATH_CACHE
+/// Size of medium sized cached paths.
+#define PATH_MED_BYTES      64
+/// Size of small cached paths.
+#define PATH_SMALL_BYTES    32
+
+/// Default number of largest cached paths.  This can be overridden in the .cdef.
+#define DEFAULT_LARGE_PATH_POOL_SIZE 4
+
+/// Number of medium sized cached paths.
+#define MED_PATH_POOL_SIZE                                                                      \
+    (((LE_MEM_BLOCKS(PathPool, DEFAULT_LARGE_PATH_POOL_SIZE) / 2) * HUB_MAX_RESOURCE_PATH_BYTES) \
+        / PATH_MED_BYTES)
+
+/// Number of small cached paths.
+#define SMALL_PATH_POOL_SIZE \
+    (((MED_PATH_POOL_SIZE / 2) * PATH_MED_BYTES) / PATH_SMALL_BYTES)
+
+/// Pool of cached absolute paths.
+static le_mem_PoolRef_t PathPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(PathPool, DEFAULT_LARGE_PATH_POOL_SIZE, HUB_MAX_RESOURCE_PATH_BYTES);
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the hash of an entry name (32-bit FNV-1a).
+ *
+ * @return The hash.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t HashName
+(
+    const char* name
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t hash = 2166136261u;
+
+    for (; *name != '\0'; name++)
+    {
+        hash = (hash ^ (uint8_t)*name) * 16777619u;
+    }
+
+    return hash;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find an interned name.
+ *
+ * @return Ptr to the Name object or NULL if no entry has that name.
+ */
+//--------------------------------------------------------------------------------------------------
+static const Name_t* FindName
+(
+    const char* name,
+    uint32_t hash       ///< Hash of the name.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const Name_t* namePtr = NameTable[hash & (DHUB_NAME_TABLE_BUCKETS - 1)];
+
+    for (; namePtr != NULL; namePtr = namePtr->nextPtr)
+    {
+        if ((namePtr->hash == hash) && (strcmp(namePtr->str, name) == 0))
+        {
+            return namePtr;
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the interned copy of a name, interning the name if no entry has it yet.
+ *
+ * @return Ptr to the Name object (to be released using ReleaseName()) or NULL if failed to
+ *         allocate memory.
+ */
+//--------------------------------------------------------------------------------------------------
+static const Name_t* InternName
+(
+    const char* name
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t hash = HashName(name);
+    Name_t* namePtr = (Name_t*)FindName(name, hash);
+
+    if (namePtr == NULL)
+    {
+        size_t length = strlen(name);
+        LE_ASSERT(length < HUB_MAX_ENTRY_NAME_BYTES);
+
+#if LE_CONFIG_LINUX
+        namePtr = le_mem_VarAlloc(NamePool, offsetof(Name_t, str) + length + 1);
+#else
+        namePtr = le_mem_TryVarAlloc(NamePool, offsetof(Name_t, str) + length + 1);
+#endif
+        if (namePtr == NULL)
+        {
+            LE_ERROR("Failed to allocate space for name of size %" PRIuS, length);
+            return NULL;
+        }
+
+        namePtr->hash = hash;
+        namePtr->refCount = 0;
+        namePtr->length = (uint8_t)length;
+        memcpy(namePtr->str, name, length + 1);
+
+        Name_t** bucketPtr = &NameTable[hash & (DHUB_NAME_TABLE_BUCKETS - 1)];
+        namePtr->nextPtr = *bucketPtr;
+        *bucketPtr = namePtr;
+    }
+
+    namePtr->refCount++;
+
+    return namePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release an interned name.  It is removed from the Name Table when no entry has it anymore.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReleaseName
+(
+    const Name_t* namePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Name_t* mutableNamePtr = (Name_t*)namePtr;
+
+    LE_ASSERT(mutableNamePtr->refCount > 0);
+
+    if (--mutableNamePtr->refCount == 0)
+    {
+        Name_t** nextPtrPtr = &NameTable[namePtr->hash & (DHUB_NAME_TABLE_BUCKETS - 1)];
+
+        while (*nextPtrPtr != mutableNamePtr)
+        {
+            LE_ASSERT(*nextPtrPtr != NULL);
+            nextPtrPtr = &(*nextPtrPtr)->nextPtr;
+        }
+
+        *nextPtrPtr = mutableNamePtr->nextPtr;
+        le_mem_Release(mutableNamePtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the Child Index bucket that an entry name hash belongs to.
+ *
+ * @return Ptr to the head of the bucket's chain.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline Entry_t** GetChildIndexBucket
+(
+    ChildIndex_t* indexPtr,
+    uint32_t nameHash
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return &indexPtr->buckets[nameHash & (DHUB_CHILD_INDEX_BUCKETS - 1)];
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a child entry to its parent's Child Index.  If the parent has no Child Index yet and now
+ * has enough children to need one, build it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void IndexChild
+(
+    Entry_t* parentPtr,
+    Entry_t* childPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (parentPtr->childIndexPtr != NULL)
+    {
+        Entry_t** bucketPtr = GetChildIndexBucket(parentPtr->childIndexPtr,
+                                                  childPtr->namePtr->hash);
+
+        childPtr->hashNextPtr = *bucketPtr;
+        *bucketPtr = childPtr;
+    }
+    else if (parentPtr->childCount >= DHUB_CHILD_INDEX_THRESHOLD)
+    {
+        // If this fails, the children will be found by walking the list and building the index
+        // will be retried when the next child is added.
+        parentPtr->childIndexPtr = hub_MemAlloc(ChildIndexPool);
+
+        if (parentPtr->childIndexPtr != NULL)
+        {
+            memset(parentPtr->childIndexPtr, 0, sizeof(ChildIndex_t));
+
+            le_dls_Link_t* linkPtr = le_dls_Peek(&parentPtr->childList);
+
+            while (linkPtr != NULL)
+            {
+                IndexChild(parentPtr, CONTAINER_OF(linkPtr, Entry_t, link));
+
+                linkPtr = le_dls_PeekNext(&parentPtr->childList, linkPtr);
+            }
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a child entry from its parent's Child Index, if it has one.  The Child Index is
+ * released when the parent has no children left.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UnindexChild
+(
+    Entry_t* parentPtr,
+    Entry_t* childPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (parentPtr->childIndexPtr == NULL)
+    {
+        return;
+    }
+
+    if (parentPtr->childCount == 0)
+    {
+        le_mem_Release(parentPtr->childIndexPtr);
+        parentPtr->childIndexPtr = NULL;
+        return;
+    }
+
+    Entry_t** nextPtrPtr = GetChildIndexBucket(parentPtr->childIndexPtr, childPtr->namePtr->hash);
+
+    while (*nextPtrPtr != childPtr)
+    {
+        LE_ASSERT(*nextPtrPtr != NULL);
+        nextPtrPtr = &(*nextPtrPtr)->hashNextPtr;
+    }
+
+    *nextPtrPtr = childPtr->hashNextPtr;
+    childPtr->hashNextPtr = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether an entry is linked into one of the journals.
+ *
+ * @return true if the link is in a list.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsJournaled
+(
+    const le_dls_Link_t* linkPtr ///< The entry's link for the journal.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (linkPtr->nextPtr != NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove an entry from one of the journals, if it is in it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Unjournal
+(
+    le_dls_List_t* journalPtr,  ///< The journal.
+    le_dls_Link_t* linkPtr      ///< The entry's link for the journal.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (IsJournaled(linkPtr))
+    {
+        le_dls_Remove(journalPtr, linkPtr);
+        *linkPtr = LE_DLS_LINK_INIT;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record that an entry may have become new.
+ */
+//--------------------------------------------------------------------------------------------------
+static void JournalStructureChange
+(
+    Entry_t* entryPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!IsJournaled(&entryPtr->structureLink))
+    {
+        le_dls_Queue(&StructureJournal, &entryPtr->structureLink);
+    }
+}
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -66,14 +513,25 @@ static Entry_t* AddChild
 {
     if (entryPtr == NULL)
     {
-        entryPtr = hub_MemAlloc(EntryPool);
+        const Name_t* namePtr = InternName(name);
+        entryPtr = (namePtr != NULL) ? hub_MemAlloc(EntryPool) : NULL;
 
         if (entryPtr)
         {
-            LE_ASSERT_OK(le_utf8_Copy(entryPtr->name, name, sizeof(entryPtr->name), NULL));
-
+            entryPtr->namePtr = namePtr;
+            entryPtr->hashNextPtr = NULL;
             entryPtr->link = LE_DLS_LINK_INIT;
             entryPtr->childList = LE_DLS_LIST_INIT;
+            entryPtr->childCount = 0;
+            entryPtr->childIndexPtr = NULL;
+            entryPtr->changeLink = LE_DLS_LINK_INIT;
+            entryPtr->changeTime = -1;
+            entryPtr->subtreeChangeTime = -1;
+            entryPtr->structureLink = LE_DLS_LINK_INIT;
+            memset(entryPtr->relevantPass, 0, sizeof(entryPtr->relevantPass));
+#ifdef DHUB_PATH_CACHE
+            entryPtr->pathPtr = NULL;
+#endif
             entryPtr->type = ADMIN_ENTRY_TYPE_NAMESPACE;
 
             if (parentPtr != NULL)
@@ -86,10 +544,16 @@ static Entry_t* AddChild
                 // Link to the parent entry.
                 entryPtr->parentPtr = parentPtr;
                 le_dls_Queue(&parentPtr->childList, &entryPtr->link);
+                parentPtr->childCount++;
+                IndexChild(parentPtr, entryPtr);
             }
         }
         else
         {
+            if (namePtr != NULL)
+            {
+                ReleaseName(namePtr);
+            }
             LE_ERROR("Failed to allocate memory in AddChild");
         }
     }
@@ -98,11 +562,16 @@ static Entry_t* AddChild
         LE_ASSERT(entryPtr->type == ADMIN_ENTRY_TYPE_NAMESPACE);
         LE_ASSERT(entryPtr->parentPtr == parentPtr);
         LE_ASSERT(le_dls_IsEmpty(&entryPtr->childList));
+
+        // Only snapshots are still referring to a deleted entry, so the resurrected entry needs a
+        // reference of its own to live on.
+        le_mem_AddRef(entryPtr);
     }
 
     if (entryPtr)
     {
         entryPtr->u.flags = RES_FLAG_NEW;
+        JournalStructureChange(entryPtr);
     }
     return entryPtr;
 }
@@ -124,8 +593,21 @@ static void EntryDestructor
     LE_ASSERT(entryPtr->parentPtr != NULL);
     LE_ASSERT(le_dls_IsEmpty(&entryPtr->childList));
 
-    // Remove from parent's list of children.
+    // Remove from the journals and the parent's list of children.
+    Unjournal(&ChangeJournal, &entryPtr->changeLink);
+    Unjournal(&StructureJournal, &entryPtr->structureLink);
     le_dls_Remove(&entryPtr->parentPtr->childList, &entryPtr->link);
+    entryPtr->parentPtr->childCount--;
+    UnindexChild(entryPtr->parentPtr, entryPtr);
+
+    ReleaseName(entryPtr->namePtr);
+
+#ifdef DHUB_PATH_CACHE
+    if (entryPtr->pathPtr != NULL)
+    {
+        le_mem_Release(entryPtr->pathPtr);
+    }
+#endif
 
     // Release the reference to the parent.
     le_mem_Release(entryPtr->parentPtr);
@@ -145,10 +627,41 @@ void resTree_Init
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // 0 means "not relevant", so every slot starts at pass 1.
+    for (unsigned int slot = 0; slot < RELEVANCE_SLOTS; slot++)
+    {
+        RelevancePass[slot] = 1;
+    }
+
     // Create the Namespace Pool (note: Namespaces are just instances of Entry_t).
     EntryPool = le_mem_InitStaticPool(EntryPool, DEFAULT_RESOURCE_TREE_ENTRY_POOL_SIZE,
                     sizeof(Entry_t));
     le_mem_SetDestructor(EntryPool, EntryDestructor);
+    hub_RegisterPool(EntryPool);
+
+    ChildIndexPool = le_mem_InitStaticPool(ChildIndexPool, DEFAULT_CHILD_INDEX_POOL_SIZE,
+                        sizeof(ChildIndex_t));
+    hub_RegisterPool(ChildIndexPool);
+
+    le_mem_PoolRef_t layeredNamePool = le_mem_InitStaticPool(NamePool,
+                                                             DEFAULT_LARGE_NAME_POOL_SIZE,
+                                                             NAME_LARGE_BYTES);
+    hub_RegisterPool(layeredNamePool);
+    layeredNamePool = le_mem_CreateReducedPool(layeredNamePool, "MedNamePool",
+                        MED_NAME_POOL_SIZE, NAME_MED_BYTES);
+    NamePool = le_mem_CreateReducedPool(layeredNamePool, "SmallNamePool",
+                   SMALL_NAME_POOL_SIZE, NAME_SMALL_BYTES);
+
+#ifdef DHUB_PATH_CACHE
+    le_mem_PoolRef_t layeredPathPool = le_mem_InitStaticPool(PathPool,
+                                                             DEFAULT_LARGE_PATH_POOL_SIZE,
+                                                             HUB_MAX_RESOURCE_PATH_BYTES);
+    hub_RegisterPool(layeredPathPool);
+    layeredPathPool = le_mem_CreateReducedPool(layeredPathPool, "MedPathPool",
+                        MED_PATH_POOL_SIZE, PATH_MED_BYTES);
+    PathPool = le_mem_CreateReducedPool(layeredPathPool, "SmallPathPool",
+                   SMALL_PATH_POOL_SIZE, PATH_SMALL_BYTES);
+#endif
 
     // Create the Root Namespace.
     RootPtr = AddChild(NULL, "", NULL);
@@ -180,6 +693,28 @@ bool resTree_IsResource
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the Resource attached to a given resource tree Entry.
+ *
+ * @return Ptr to the Resource, or NULL if the Entry is not a Resource.
+ */
+//--------------------------------------------------------------------------------------------------
+res_Resource_t* resTree_GetResourcePtr
+(
+    resTree_EntryRef_t entryRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (entryRef->type == ADMIN_ENTRY_TYPE_NAMESPACE)
+    {
+        return NULL;
+    }
+
+    return entryRef->u.resourcePtr;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get a reference to the root namespace.
@@ -198,8 +733,8 @@ resTree_EntryRef_t resTree_GetRoot
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Find a child entry with a given name, optionally including already deleted nodes if they have not
- * been flushed.
+ * Find a child entry with a given name, optionally including already deleted nodes that snapshots
+ * still refer to.
  *
  * @return Reference to the object or NULL if not found.
  */
@@ -212,6 +747,32 @@ resTree_EntryRef_t resTree_FindChildEx
                                         ///< return it.
 )
 {
+    // Entry names are interned, so if no entry has this name there's no such child, and otherwise
+    // children only need to be compared with the interned name by address.
+    uint32_t nameHash = HashName(name);
+    const Name_t* namePtr = FindName(name, nameHash);
+
+    if (namePtr == NULL)
+    {
+        return NULL;
+    }
+
+    if (nsRef->childIndexPtr != NULL)
+    {
+        Entry_t* childPtr = *GetChildIndexBucket(nsRef->childIndexPtr, nameHash);
+
+        for (; childPtr != NULL; childPtr = childPtr->hashNextPtr)
+        {
+            if (childPtr->namePtr == namePtr)
+            {
+                // Names are unique among children, including deleted ones.
+                return (withZombies || !resTree_IsDeleted(childPtr)) ? childPtr : NULL;
+            }
+        }
+
+        return NULL;
+    }
+
     le_dls_Link_t* linkPtr = le_dls_Peek(&nsRef->childList);
 
     while (linkPtr != NULL)
@@ -220,7 +781,7 @@ resTree_EntryRef_t resTree_FindChildEx
 
         if (withZombies || !resTree_IsDeleted(childPtr))
         {
-            if (strncmp(name, childPtr->name, sizeof(childPtr->name)) == 0)
+            if (childPtr->namePtr == namePtr)
             {
                 return childPtr;
             }
@@ -357,8 +918,10 @@ static resTree_EntryRef_t CreateEntry
         // If found, this becomes the new current entry.
         Entry_t* childPtr = resTree_FindChildEx(currentEntry, entryName, true);
 
-        LE_FATAL_IF(((childPtr != NULL) && (*terminatorPtr == '\0')), "Attempting to create an"
-                    "entry that already exists");
+        // A deleted entry that is still around can be brought back, so only a live one is an error.
+        LE_FATAL_IF(((childPtr != NULL) && !resTree_IsDeleted(childPtr) &&
+                     (*terminatorPtr == '\0')),
+                    "Attempting to create an entry that already exists");
 
         if (childPtr == NULL || resTree_IsDeleted(childPtr))
         {
@@ -468,6 +1031,9 @@ static le_result_t CreatePlaceholderForNamespace
     {
         entryRef->u.resourcePtr = placeholderPtr;
         entryRef->type = ADMIN_ENTRY_TYPE_PLACEHOLDER;
+
+        // The new resource is "new" even if the namespace wasn't.
+        JournalStructureChange(entryRef);
     }
     else
     {
@@ -579,7 +1145,7 @@ const char* resTree_GetEntryName
 )
 //--------------------------------------------------------------------------------------------------
 {
-    return entryRef->name;
+    return entryRef->namePtr->str;
 }
 
 
@@ -916,6 +1482,119 @@ le_result_t resTree_GetObservation
 }
 
 
+#ifdef DHUB_PATH_CACHE
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the absolute path of a given resource tree entry from the path cache, computing and caching
+ * it (and the paths of its ancestors) if this is the first time it's needed.
+ *
+ * Entries are never renamed or moved, so a cached path stays valid until the entry is destroyed.
+ *
+ * @return Ptr to the path ("" for the Root), or NULL if it could not be cached (failed to
+ *         allocate memory or the path is too long).
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* GetCachedPath
+(
+    Entry_t* entryPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (entryPtr == RootPtr)
+    {
+        return "";
+    }
+
+    if (entryPtr->pathPtr == NULL)
+    {
+        const char* parentPathPtr = GetCachedPath(entryPtr->parentPtr);
+        if (parentPathPtr == NULL)
+        {
+            return NULL;
+        }
+
+        char path[HUB_MAX_RESOURCE_PATH_BYTES];
+        int len = snprintf(path, sizeof(path), "%s/%s", parentPathPtr, entryPtr->namePtr->str);
+        if ((len < 0) || ((size_t)len >= sizeof(path)))
+        {
+            return NULL;
+        }
+
+        entryPtr->pathPtr = le_mem_StrDup(PathPool, path);
+    }
+
+    return entryPtr->pathPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the path of a given resource tree entry relative to a given namespace, using the path
+ * cache.
+ *
+ * @return
+ *  - Number of bytes written to the string buffer (excluding null terminator) if successful.
+ *  - LE_OVERFLOW if the string doesn't have space for the path.
+ *  - LE_NOT_FOUND if the resource is not in the given namespace.
+ *  - LE_UNAVAILABLE if the path could not be cached.
+ */
+//--------------------------------------------------------------------------------------------------
+static ssize_t GetPathFromCache
+(
+    char* stringBuffPtr,  ///< Ptr to where the path should be written.
+    size_t stringBuffSize,  ///< Size of the string buffer, in bytes.
+    Entry_t* baseNamespace,
+    Entry_t* entryPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t offset = 0;
+
+    if (baseNamespace != RootPtr)
+    {
+        // Make sure the entry is in the base namespace.
+        if (entryPtr == RootPtr)
+        {
+            return LE_NOT_FOUND;
+        }
+
+        const Entry_t* ancestorPtr = entryPtr->parentPtr;
+
+        while (ancestorPtr != baseNamespace)
+        {
+            if (ancestorPtr == RootPtr)
+            {
+                return LE_NOT_FOUND;
+            }
+            ancestorPtr = ancestorPtr->parentPtr;
+        }
+
+        // The relative path is what follows the base namespace's path and a '/' separator.
+        const char* basePathPtr = GetCachedPath(baseNamespace);
+        if (basePathPtr == NULL)
+        {
+            return LE_UNAVAILABLE;
+        }
+        offset = strlen(basePathPtr) + 1;
+    }
+
+    const char* pathPtr = GetCachedPath(entryPtr);
+    if (pathPtr == NULL)
+    {
+        return LE_UNAVAILABLE;
+    }
+
+    size_t len;
+    if (LE_OK != le_utf8_Copy(stringBuffPtr, pathPtr + offset, stringBuffSize, &len))
+    {
+        return LE_OVERFLOW;
+    }
+
+    return len;
+}
+#endif
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the path of a given resource tree entry relative to a given namespace.
@@ -946,6 +1625,14 @@ ssize_t resTree_GetPath
         return LE_OK;
     }
 
+#ifdef DHUB_PATH_CACHE
+    ssize_t cachedResult = GetPathFromCache(stringBuffPtr, stringBuffSize, baseNamespace, entryRef);
+    if (cachedResult != LE_UNAVAILABLE)
+    {
+        return cachedResult;
+    }
+#endif
+
     // If the parent is the base namespace, just print the name of the current entry.
     if (entryRef->parentPtr == baseNamespace)
     {
@@ -962,7 +1649,7 @@ ssize_t resTree_GetPath
             stringBuffSize--;
             bytesWritten = 1;
         }
-        if (LE_OK != le_utf8_Copy(stringBuffPtr, entryRef->name, stringBuffSize, &len))
+        if (LE_OK != le_utf8_Copy(stringBuffPtr, entryRef->namePtr->str, stringBuffSize, &len))
         {
             return LE_OVERFLOW;
         }
@@ -1004,7 +1691,7 @@ ssize_t resTree_GetPath
     stringBuffPtr += len;
     stringBuffSize -= len;
 
-    if (LE_OK != le_utf8_Copy(stringBuffPtr, entryRef->name, stringBuffSize, &len))
+    if (LE_OK != le_utf8_Copy(stringBuffPtr, entryRef->namePtr->str, stringBuffSize, &len))
     {
         return LE_OVERFLOW;
     }
@@ -1031,8 +1718,8 @@ resTree_EntryRef_t resTree_GetParent
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the first child of a given entry, optionally including already deleted nodes if they have not
- * been flushed.
+ * Get the first child of a given entry, optionally including already deleted nodes that snapshots
+ * still refer to.
  *
  * @return Reference to the first child entry, or NULL if the entry has no children.
  */
@@ -1078,7 +1765,7 @@ resTree_EntryRef_t resTree_GetFirstChild
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the next sibling (child of the same parent) of a given entry, optionally including already
- * deleted nodes if they have not been flushed.
+ * deleted nodes that snapshots still refer to.
  *
  * @return Reference to the next entry in the parent's child list, or
  *         NULL if already at the last child.
@@ -1120,19 +1807,45 @@ resTree_EntryRef_t resTree_GetNextSiblingEx
  *         NULL if already at the last child.
  */
 //--------------------------------------------------------------------------------------------------
-resTree_EntryRef_t resTree_GetNextSibling
+resTree_EntryRef_t resTree_GetNextSibling
+(
+    resTree_EntryRef_t entryRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return resTree_GetNextSiblingEx(entryRef, false);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a data sample to a resource.
+ *
+ * @note Takes ownership of the data sample reference.
+ *
+ * @return
+ *      - LE_OK If datasample was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
+ *      - LE_IN_PROGRESS Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
+ *      - LE_FAULT is any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t resTree_Push
 (
-    resTree_EntryRef_t entryRef
+    resTree_EntryRef_t entryRef,    ///< The entry to push to.
+    io_DataType_t dataType,         ///< The data type.
+    dataSample_Ref_t dataSample     ///< The data sample (timestamp + value).
 )
 //--------------------------------------------------------------------------------------------------
 {
-    return resTree_GetNextSiblingEx(entryRef, false);
+    return resTree_PushWithUnits(entryRef, dataType, NULL, dataSample);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Push a data sample to a resource.
+ * Push a data sample with given units to a resource.
  *
  * @note Takes ownership of the data sample reference.
  *
@@ -1144,10 +1857,11 @@ resTree_EntryRef_t resTree_GetNextSibling
  *      - LE_FAULT is any other error happened during push.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t resTree_Push
+le_result_t resTree_PushWithUnits
 (
     resTree_EntryRef_t entryRef,    ///< The entry to push to.
     io_DataType_t dataType,         ///< The data type.
+    const char* units,              ///< The units (NULL or "" = take on resource's units)
     dataSample_Ref_t dataSample     ///< The data sample (timestamp + value).
 )
 //--------------------------------------------------------------------------------------------------
@@ -1159,7 +1873,14 @@ le_result_t resTree_Push
         case ADMIN_ENTRY_TYPE_OBSERVATION:
         case ADMIN_ENTRY_TYPE_PLACEHOLDER:
 
-            return res_Push(entryRef->u.resourcePtr, dataType, NULL, dataSample);
+#ifdef DHUB_JSON_WORKERS
+            // Keep the pushes to this resource in order behind those still being validated.
+            if (jsonWorker_IsPending(entryRef))
+            {
+                return jsonWorker_QueuePush(entryRef, dataType, units, dataSample);
+            }
+#endif
+            return res_Push(entryRef->u.resourcePtr, dataType, units, dataSample);
 
         case ADMIN_ENTRY_TYPE_NAMESPACE:
 
@@ -1174,6 +1895,52 @@ le_result_t resTree_Push
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a numeric value to a resource.
+ *
+ * If the value would be dropped by all of the resource's routes, no data sample is created for
+ * it, to save the allocation.
+ *
+ * @return
+ *      - LE_OK If the value was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the value because of failure in memory allocation.
+ *      - LE_IN_PROGRESS Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
+ *      - LE_FAULT is any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t resTree_PushNumeric
+(
+    resTree_EntryRef_t entryRef,    ///< The entry to push to.
+    double timestamp,               ///< The timestamp (IO_NOW = now).
+    double value                    ///< The numeric value.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (   resTree_IsResource(entryRef)
+#ifdef DHUB_JSON_WORKERS
+        && !jsonWorker_IsPending(entryRef)
+#endif
+       )
+    {
+        le_result_t res = res_PushNumericIfDropped(entryRef->u.resourcePtr, timestamp, value);
+        if (res != LE_UNAVAILABLE)
+        {
+            return res;
+        }
+    }
+
+    dataSample_Ref_t sampleRef = dataSample_CreateNumeric(timestamp, value);
+    if (sampleRef == NULL)
+    {
+        return LE_NO_MEMORY;
+    }
+
+    return resTree_Push(entryRef, IO_DATA_TYPE_NUMERIC, sampleRef);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add a Push Handler to an Output resource.
@@ -1532,6 +2299,28 @@ admin_TransformType_t resTree_GetTransform
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a given transform, with given parameters, is the one currently applied to an
+ * Observation.  Setting a transform clears the Observation's buffer even if it is the same one,
+ * so this can be used to avoid re-applying it needlessly.
+ *
+ * @return true if setting this transform would not change the Observation's transform settings.
+ */
+//--------------------------------------------------------------------------------------------------
+bool resTree_IsTransformSet
+(
+    resTree_EntryRef_t obsEntry,
+    admin_TransformType_t transformType,
+    const double* paramsPtr,
+    size_t paramsSize
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return res_IsTransformSet(obsEntry->u.resourcePtr, transformType, paramsPtr, paramsSize);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the maximum number of data samples to buffer in a given Observation.  Buffers are FIFO
@@ -1604,6 +2393,76 @@ uint32_t resTree_GetBufferBackupPeriod
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the number of samples evicted from an Observation's buffer to keep in its spilled history
+ * on non-volatile storage.  See admin_SetBufferSpillMaxCount() for more information.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_SetBufferSpillMaxCount
+(
+    resTree_EntryRef_t obsEntry,
+    uint32_t count
+)
+//--------------------------------------------------------------------------------------------------
+{
+    res_SetBufferSpillMaxCount(obsEntry->u.resourcePtr, count);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of samples evicted from an Observation's buffer to keep in its spilled history.
+ * See admin_SetBufferSpillMaxCount() for more information.
+ *
+ * @return The spill count (in number of samples) or 0 if the spilled history is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t resTree_GetBufferSpillMaxCount
+(
+    resTree_EntryRef_t obsEntry
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return res_GetBufferSpillMaxCount(obsEntry->u.resourcePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the precision with which an Observation's buffered numbers are stored.
+ * See admin_SetBufferPrecision() for more information.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_SetBufferPrecision
+(
+    resTree_EntryRef_t obsEntry,
+    admin_BufferPrecision_t precision
+)
+//--------------------------------------------------------------------------------------------------
+{
+    res_SetBufferPrecision(obsEntry->u.resourcePtr, precision);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the precision with which an Observation's buffered numbers are stored.
+ * See admin_SetBufferPrecision() for more information.
+ *
+ * @return The buffer precision.
+ */
+//--------------------------------------------------------------------------------------------------
+admin_BufferPrecision_t resTree_GetBufferPrecision
+(
+    resTree_EntryRef_t obsEntry
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return res_GetBufferPrecision(obsEntry->u.resourcePtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Mark an Output resource "optional".  (By default, they are marked "mandatory".)
@@ -1644,6 +2503,64 @@ bool resTree_IsMandatory
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the value of one of the runtime statistics counters of a resource.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_NOT_FOUND if the entry is not a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t resTree_GetStat
+(
+    resTree_EntryRef_t resEntry,
+    admin_StatCounter_t counter,
+    uint32_t* valuePtr          ///< [OUT] The value of the counter.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    res_Resource_t* resPtr = resTree_GetResourcePtr(resEntry);
+
+    if (resPtr == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    *valuePtr = res_GetStat(resPtr, counter);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set all the runtime statistics counters of a resource back to zero.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_NOT_FOUND if the entry is not a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t resTree_ResetStats
+(
+    resTree_EntryRef_t resEntry
+)
+//--------------------------------------------------------------------------------------------------
+{
+    res_Resource_t* resPtr = resTree_GetResourcePtr(resEntry);
+
+    if (resPtr == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    res_ResetStats(resPtr);
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the default value of a resource.
@@ -1849,166 +2766,282 @@ double resTree_GetLastModified
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Set the node's relevance flag.
+ * Set the node's relevance flag in one of the relevance slots.
  */
 //--------------------------------------------------------------------------------------------------
 void resTree_SetRelevance
 (
     resTree_EntryRef_t  resEntry,   ///< Resource to query.
-    bool                relevant    ///< Relevance of node to current operation.
+    unsigned int        slot,       ///< Relevance slot of the operation.
+    bool                relevant    ///< Relevance of node to the operation.
+)
+{
+    LE_ASSERT(slot < RELEVANCE_SLOTS);
+    resEntry->relevantPass[slot] = (relevant ? RelevancePass[slot] : 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a new relevance pass in one of the relevance slots, making all nodes irrelevant in it.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_ResetRelevance
+(
+    unsigned int slot   ///< Relevance slot of the operation.
+)
+{
+    LE_ASSERT(slot < RELEVANCE_SLOTS);
+    RelevancePass[slot]++;
+
+    // 0 means "not relevant", so skip it when the counter wraps.
+    if (RelevancePass[slot] == 0)
+    {
+        RelevancePass[slot] = 1;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the node's relevance flag in one of the relevance slots.
+ *
+ * @return Relevance of node to the operation.
+ */
+//--------------------------------------------------------------------------------------------------
+bool resTree_IsRelevant
+(
+    resTree_EntryRef_t resEntry,    ///< Resource to query.
+    unsigned int       slot         ///< Relevance slot of the operation.
+)
+{
+    LE_ASSERT(slot < RELEVANCE_SLOTS);
+    return (resEntry->relevantPass[slot] == RelevancePass[slot]);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the node's clear newness flag
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_SetClearNewnessFlag
+(
+    resTree_EntryRef_t resEntry ///< Resource to update.
 )
 {
     if (resEntry->type == ADMIN_ENTRY_TYPE_NAMESPACE)
     {
-        if (relevant)
-        {
-            resEntry->u.flags |= RES_FLAG_RELEVANT;
-        }
-        else
-        {
-            resEntry->u.flags &= ~RES_FLAG_RELEVANT;
-        }
+        resEntry->u.flags |= RES_FLAG_CLEAR_NEW;
     }
     else
     {
-        res_SetRelevance(resEntry->u.resourcePtr, relevant);
+        res_SetClearNewnessFlag(resEntry->u.resourcePtr);
     }
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the node's relevance flag.
+ * Get the node's "clear newness" flag.
  *
- * @return Relevance of node to the current operation.
+ * @return Whether the node "newness" flag must be cleared at the end of current snapshot
  */
 //--------------------------------------------------------------------------------------------------
-bool resTree_IsRelevant
+bool resTree_IsNewnessClearRequired
 (
     resTree_EntryRef_t resEntry ///< Resource to query.
 )
 {
     if (resEntry->type == ADMIN_ENTRY_TYPE_NAMESPACE)
     {
-        return (resEntry->u.flags & RES_FLAG_RELEVANT);
+        return (resEntry->u.flags & RES_FLAG_CLEAR_NEW);
     }
     else
     {
-        return res_IsRelevant(resEntry->u.resourcePtr);
+        return res_IsNewnessClearRequired(resEntry->u.resourcePtr);
     }
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Set the node's clear newness flag
+ * Mark a node as no longer "new."  New nodes are those that were created after the last snapshot
+ * scan of the tree.
+ * Also remove the "clear newness" flag.
  */
 //--------------------------------------------------------------------------------------------------
-void resTree_SetClearNewnessFlag
+void resTree_ClearNewness
 (
     resTree_EntryRef_t resEntry ///< Resource to update.
 )
 {
     if (resEntry->type == ADMIN_ENTRY_TYPE_NAMESPACE)
     {
-        resEntry->u.flags |= RES_FLAG_CLEAR_NEW;
+        resEntry->u.flags &= ~RES_FLAG_NEW;
+        resEntry->u.flags &= ~RES_FLAG_CLEAR_NEW;
     }
     else
     {
-        res_SetClearNewnessFlag(resEntry->u.resourcePtr);
+        res_ClearNewness(resEntry->u.resourcePtr);
+    }
+
+    if (!resTree_IsDeleted(resEntry))
+    {
+        Unjournal(&StructureJournal, &resEntry->structureLink);
     }
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the node's "clear newness" flag.
+ * Get the node's "newness" flag.
  *
- * @return Whether the node "newness" flag must be cleared at the end of current snapshot
+ * @return Whether the node was created after the last scan.
  */
 //--------------------------------------------------------------------------------------------------
-bool resTree_IsNewnessClearRequired
+bool resTree_IsNew
 (
     resTree_EntryRef_t resEntry ///< Resource to query.
 )
 {
     if (resEntry->type == ADMIN_ENTRY_TYPE_NAMESPACE)
     {
-        return (resEntry->u.flags & RES_FLAG_CLEAR_NEW);
+        return (resEntry->u.flags & RES_FLAG_NEW);
     }
     else
     {
-        return res_IsNewnessClearRequired(resEntry->u.resourcePtr);
+        return res_IsNew(resEntry->u.resourcePtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mark a node as deleted.  Deleted nodes are hidden from lookups, and only stay in the tree while a
+ * snapshot still refers to them.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_SetDeleted
+(
+    resTree_EntryRef_t resEntry ///< Resource to update.
+)
+{
+    // The deleted flag should only be set on nodes which have already been converted to namespaces
+    // as part of the deletion cleanup process.
+    LE_ASSERT(resEntry->type == ADMIN_ENTRY_TYPE_NAMESPACE);
+    // Deletions are reported from the snapshot deletion log, so a deleted node is never new.
+    LE_ASSERT((resEntry->u.flags & RES_FLAG_NEW) == 0);
+
+    resEntry->u.flags |= RES_FLAG_DELETED;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record that the current value of a resource has changed, so that it can be found by
+ * resTree_GetChangedSince().
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_RecordChange
+(
+    resTree_EntryRef_t resEntry ///< Resource whose current value changed.
+)
+{
+    double changeTime = resTree_GetLastModified(resEntry);
+
+    Unjournal(&ChangeJournal, &resEntry->changeLink);
+    resEntry->changeTime = changeTime;
+
+    // Propagate the time stamp up to the ancestors whose subtrees haven't seen one this new yet.
+    for (Entry_t* entryPtr = resEntry;
+         (entryPtr != NULL) && (entryPtr->subtreeChangeTime < changeTime);
+         entryPtr = entryPtr->parentPtr)
+    {
+        entryPtr->subtreeChangeTime = changeTime;
+    }
+
+    // Values are normally time stamped "now", so this usually stops at the tail straight away.
+    le_dls_Link_t* prevLinkPtr = le_dls_PeekTail(&ChangeJournal);
+    while (   (prevLinkPtr != NULL)
+           && (CONTAINER_OF(prevLinkPtr, Entry_t, changeLink)->changeTime > changeTime))
+    {
+        prevLinkPtr = le_dls_PeekPrev(&ChangeJournal, prevLinkPtr);
+    }
+
+    if (prevLinkPtr == NULL)
+    {
+        le_dls_Stack(&ChangeJournal, &resEntry->changeLink);
+    }
+    else
+    {
+        le_dls_AddAfter(&ChangeJournal, prevLinkPtr, &resEntry->changeLink);
     }
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Mark a node as no longer "new."  New nodes are those that were created after the last snapshot
- * scan of the tree.
- * Also remove the "clear newness" flag.
+ * Get the newest time stamp of any value that the entry or any of its descendants has had.  None of
+ * the entries in the subtree can have a last modified time stamp newer than this.
+ *
+ * @return Time stamp value, in seconds since the Epoch, or -1 if none of them has had a value.
  */
 //--------------------------------------------------------------------------------------------------
-void resTree_ClearNewness
+double resTree_GetSubtreeLastModified
 (
-    resTree_EntryRef_t resEntry ///< Resource to update.
+    resTree_EntryRef_t resEntry ///< Root of the subtree.
 )
 {
-    if (resEntry->type == ADMIN_ENTRY_TYPE_NAMESPACE)
-    {
-        resEntry->u.flags &= ~RES_FLAG_NEW;
-        resEntry->u.flags &= ~RES_FLAG_CLEAR_NEW;
-    }
-    else
-    {
-        res_ClearNewness(resEntry->u.resourcePtr);
-    }
+    return resEntry->subtreeChangeTime;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the node's "newness" flag.
+ * Iterate over the entries whose current value has a time stamp newer than a given time, newest
+ * first.  Entries whose value has since been removed may also be returned.
  *
- * @return Whether the node was created after the last scan.
+ * @return The next entry, or NULL if there are no more.
  */
 //--------------------------------------------------------------------------------------------------
-bool resTree_IsNew
+resTree_EntryRef_t resTree_GetChangedSince
 (
-    resTree_EntryRef_t resEntry ///< Resource to query.
+    double since,                   ///< Only entries with values newer than this (in s).
+    resTree_EntryRef_t prevEntry    ///< Entry returned by the previous call, or NULL to start.
 )
 {
-    if (resEntry->type == ADMIN_ENTRY_TYPE_NAMESPACE)
-    {
-        return (resEntry->u.flags & RES_FLAG_NEW);
-    }
-    else
+    le_dls_Link_t* linkPtr = ((prevEntry == NULL) ?
+                              le_dls_PeekTail(&ChangeJournal) :
+                              le_dls_PeekPrev(&ChangeJournal, &prevEntry->changeLink));
+
+    if (linkPtr != NULL)
     {
-        return res_IsNew(resEntry->u.resourcePtr);
+        Entry_t* entryPtr = CONTAINER_OF(linkPtr, Entry_t, changeLink);
+        if (entryPtr->changeTime > since)
+        {
+            return entryPtr;
+        }
     }
+
+    return NULL;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Mark a node as deleted.
+ * Iterate over the entries that may be new.  Every entry for which resTree_IsNew() is true is
+ * returned, but others may be returned too.
+ *
+ * @return The next entry, or NULL if there are no more.
  */
 //--------------------------------------------------------------------------------------------------
-void resTree_SetDeleted
+resTree_EntryRef_t resTree_GetNextStructureChange
 (
-    resTree_EntryRef_t resEntry ///< Resource to update.
+    resTree_EntryRef_t prevEntry    ///< Entry returned by the previous call, or NULL to start.
 )
 {
-    // The deleted flag should only be set on nodes which have already been converted to namespaces
-    // as part of the deletion cleanup process.
-    LE_ASSERT(resEntry->type == ADMIN_ENTRY_TYPE_NAMESPACE);
-    // The deletion flag should not be set on nodes which have not been scanned yet, as there is no
-    // point in keeping them around as a deletion record.
-    LE_ASSERT((resEntry->u.flags & RES_FLAG_NEW) == 0);
+    le_dls_Link_t* linkPtr = ((prevEntry == NULL) ?
+                              le_dls_Peek(&StructureJournal) :
+                              le_dls_PeekNext(&StructureJournal, &prevEntry->structureLink));
 
-    resEntry->u.flags |= RES_FLAG_DELETED;
+    return ((linkPtr == NULL) ? NULL : CONTAINER_OF(linkPtr, Entry_t, structureLink));
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the node's "deleted" flag.
  *
- * @return Whether the node was deleted after the last flush.
+ * @return Whether the node was deleted.
  */
 //--------------------------------------------------------------------------------------------------
 bool resTree_IsDeleted
@@ -2110,6 +3143,165 @@ void resTree_ForEachResource
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a given absolute path is at or under one of the paths marked high-priority.
+ *
+ * @return true if it is.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsUnderPriorityPath
+(
+    const char* path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (size_t i = 0; i < PriorityPathCount; i++)
+    {
+        size_t len = strlen(PriorityPaths[i]);
+
+        if (   (strncmp(path, PriorityPaths[i], len) == 0)
+            && ((path[len] == '\0') || (path[len] == '/')))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a given entry is at or under one of the paths marked high-priority.
+ *
+ * @return true if it is.
+ */
+//--------------------------------------------------------------------------------------------------
+bool resTree_IsHighPriorityEntry
+(
+    resTree_EntryRef_t entryRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Most systems don't mark anything, so don't bother building the path.
+    if (PriorityPathCount == 0)
+    {
+        return false;
+    }
+
+    char path[HUB_MAX_RESOURCE_PATH_BYTES];
+
+    if (resTree_GetPath(path, sizeof(path), RootPtr, entryRef) < 0)
+    {
+        return false;
+    }
+
+    return IsUnderPriorityPath(path);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Update a resource's priority after the paths marked high-priority have changed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdatePriority
+(
+    res_Resource_t* resPtr,
+    admin_EntryType_t entryType
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(entryType);
+
+    res_SetHighPriority(resPtr, resTree_IsHighPriorityEntry(resPtr->entryRef));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mark or unmark a path as high-priority.  Route pushes to the resources at or under a
+ * high-priority path, including ones created later, are processed ahead of all the others.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_BAD_PARAMETER if the path is not a valid absolute path.
+ *      - LE_OUT_OF_RANGE if DHUB_MAX_PRIORITY_PATHS paths are already marked.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t resTree_SetHighPriority
+(
+    const char* path,   ///< Absolute path of a namespace or resource.
+    bool isHighPriority
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((path[0] != '/') || hub_IsResourcePathMalformed(path))
+    {
+        LE_ERROR("Invalid path '%s'.", path);
+        return LE_BAD_PARAMETER;
+    }
+
+    size_t i = 0;
+    while ((i < PriorityPathCount) && (strcmp(PriorityPaths[i], path) != 0))
+    {
+        i++;
+    }
+
+    if (isHighPriority)
+    {
+        if (i < PriorityPathCount)
+        {
+            return LE_OK;
+        }
+        if (PriorityPathCount >= DHUB_MAX_PRIORITY_PATHS)
+        {
+            LE_ERROR("Too many high-priority paths (max %d).", DHUB_MAX_PRIORITY_PATHS);
+            return LE_OUT_OF_RANGE;
+        }
+
+        LE_ASSERT(le_utf8_Copy(PriorityPaths[PriorityPathCount], path,
+                               sizeof(PriorityPaths[PriorityPathCount]), NULL) == LE_OK);
+        PriorityPathCount++;
+    }
+    else
+    {
+        if (i >= PriorityPathCount)
+        {
+            return LE_OK;
+        }
+
+        PriorityPathCount--;
+        if (i < PriorityPathCount)
+        {
+            memcpy(PriorityPaths[i], PriorityPaths[PriorityPathCount], sizeof(PriorityPaths[i]));
+        }
+    }
+
+    ForEachResourceUnder(RootPtr, UpdatePriority);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a given absolute path is at or under a path marked high-priority.
+ *
+ * @return true if it is.
+ */
+//--------------------------------------------------------------------------------------------------
+bool resTree_IsHighPriority
+(
+    const char* path    ///< Absolute path of a namespace or resource.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return IsUnderPriorityPath(path);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Read data out of a buffer.  Data is written to a given file descriptor in JSON-encoded format
@@ -2140,6 +3332,105 @@ void resTree_ReadBufferJson
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer in JSON format (like resTree_ReadBufferJson()), decimated to at most a
+ * given number of samples using the Largest-Triangle-Three-Buckets algorithm, which keeps the
+ * visual shape of the data.  The first and the last samples are always included.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride instead.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_ReadBufferJsonDecimated
+(
+    resTree_EntryRef_t obsEntry, ///< Observation entry.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to read the whole buffer.
+    uint32_t maxCount,  ///< Max number of samples to read (at least 3); 0 = no limit.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(obsEntry->type == ADMIN_ENTRY_TYPE_OBSERVATION);
+    LE_ASSERT(obsEntry->u.resourcePtr != NULL);
+
+    res_ReadBufferJsonDecimated(obsEntry->u.resourcePtr,
+                                startAfter,
+                                maxCount,
+                                outputFile,
+                                handlerPtr,
+                                contextPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the samples in a buffer between two times, in JSON format (like resTree_ReadBufferJson()),
+ * decimated to at most a given number of samples using a given decimation mode.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_ReadBufferJsonRange
+(
+    resTree_EntryRef_t obsEntry, ///< Observation entry.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to start at the oldest sample.
+    double endAt,   ///< End at this many seconds ago, or at an absolute number of seconds since
+                    ///< the Epoch (if endAt > 30 years).  Use NAN to read up to the newest sample.
+    uint32_t maxCount,  ///< Max number of samples to read; 0 = no limit.
+    query_DecimationMode_t decimation, ///< How to select the samples, if decimating.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(obsEntry->type == ADMIN_ENTRY_TYPE_OBSERVATION);
+    LE_ASSERT(obsEntry->u.resourcePtr != NULL);
+
+    res_ReadBufferJsonRange(obsEntry->u.resourcePtr,
+                            startAfter,
+                            endAt,
+                            maxCount,
+                            decimation,
+                            outputFile,
+                            handlerPtr,
+                            contextPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer.  Data is written to a given file descriptor in CBOR format as an
+ * indefinite-length array of [timestamp, value] arrays.  Timestamps and numeric values are
+ * doubles, Boolean values are true or false, trigger values are null, and string and JSON values
+ * are text strings.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_ReadBufferCbor
+(
+    resTree_EntryRef_t obsEntry, ///< Observation entry.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to read the whole buffer.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(obsEntry->type == ADMIN_ENTRY_TYPE_OBSERVATION);
+    LE_ASSERT(obsEntry->u.resourcePtr != NULL);
+
+    res_ReadBufferCbor(obsEntry->u.resourcePtr, startAfter, outputFile, handlerPtr, contextPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Find the oldest data sample held in a given Observation's buffer that is newer than a
@@ -2239,6 +3530,47 @@ dataSample_Ref_t resTree_GetJsonExample
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the metadata encoding cached on a given resource by a snapshot formatter.
+ *
+ * @return The cached encoding, or NULL if none is cached.
+ */
+//--------------------------------------------------------------------------------------------------
+void* resTree_GetMetadataCache
+(
+    resTree_EntryRef_t resEntry
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(resEntry->type != ADMIN_ENTRY_TYPE_NAMESPACE);
+    LE_ASSERT(resEntry->u.resourcePtr != NULL);
+
+    return res_GetMetadataCache(resEntry->u.resourcePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cache a snapshot formatter's encoding of a given resource's metadata.  The cache is dropped when
+ * the units or the default value of the resource change, or when the resource is deleted.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_SetMetadataCache
+(
+    resTree_EntryRef_t resEntry,
+    void* cachePtr  ///< Memory pool object, or NULL.  Ownership of this reference is passed to the
+                    ///< resource.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(resEntry->type != ADMIN_ENTRY_TYPE_NAMESPACE);
+    LE_ASSERT(resEntry->u.resourcePtr != NULL);
+
+    res_SetMetadataCache(resEntry->u.resourcePtr, cachePtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the JSON member/element specifier for extraction of data from within a structured JSON
@@ -2398,6 +3730,49 @@ double resTree_QueryStdDev
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the minimum, maximum, mean and standard deviation of all values found within a given time
+ * span in an Observation's buffer, all at once.
+ *
+ * If there's no numerical data in the Observation's buffer (if the buffer size is zero, the
+ * buffer is empty, or the buffer contains data of a non-numerical type), the count is zero and
+ * the statistics are NAN (not-a-number).
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_QueryStats
+(
+    resTree_EntryRef_t obsEntry,    ///< Observation entry.
+    double startTime,   ///< If < 30 years then seconds before now; else seconds since the Epoch.
+    double* minPtr,     ///< [OUT] Minimum value.
+    double* maxPtr,     ///< [OUT] Maximum value.
+    double* meanPtr,    ///< [OUT] Mean value.
+    double* stdDevPtr,  ///< [OUT] Standard deviation.
+    uint32_t* countPtr  ///< [OUT] Number of values the statistics were computed from.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (obsEntry->type != ADMIN_ENTRY_TYPE_OBSERVATION)
+    {
+        *minPtr = NAN;
+        *maxPtr = NAN;
+        *meanPtr = NAN;
+        *stdDevPtr = NAN;
+        *countPtr = 0;
+        return;
+    }
+
+    LE_ASSERT(obsEntry->u.resourcePtr != NULL);
+    res_QueryStats(obsEntry->u.resourcePtr,
+                   startTime,
+                   minPtr,
+                   maxPtr,
+                   meanPtr,
+                   stdDevPtr,
+                   countPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Mark an observation as config.
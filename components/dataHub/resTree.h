@@ -35,6 +35,10 @@
 //--------------------------------------------------------------------------------------------------
 typedef struct resTree_Entry* resTree_EntryRef_t;
 
+/// Relevance slot used while applying a configuration.  Snapshot sessions use the slots after it,
+/// so that their relevance marks don't disturb each other.
+#define RESTREE_CONFIG_RELEVANCE_SLOT 0
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -74,10 +78,23 @@ bool resTree_IsResource
     resTree_EntryRef_t entryRef
 );
 
+
 //--------------------------------------------------------------------------------------------------
 /**
- * Find a child entry with a given name, optionally including already deleted nodes if they have not
- * been flushed.
+ * Get the Resource attached to a given resource tree Entry.
+ *
+ * @return Ptr to the Resource, or NULL if the Entry is not a Resource.
+ */
+//--------------------------------------------------------------------------------------------------
+res_Resource_t* resTree_GetResourcePtr
+(
+    resTree_EntryRef_t entryRef
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a child entry with a given name, optionally including already deleted nodes that snapshots
+ * still refer to.
  *
  * @return Reference to the object or NULL if not found.
  */
@@ -343,8 +360,8 @@ LE_SHARED resTree_EntryRef_t resTree_GetParent
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the first child of a given entry, optionally including already deleted nodes if they have not
- * been flushed.
+ * Get the first child of a given entry, optionally including already deleted nodes that snapshots
+ * still refer to.
  *
  * @return Reference to the first child entry, or NULL if the entry has no children.
  */
@@ -371,7 +388,7 @@ LE_SHARED resTree_EntryRef_t resTree_GetFirstChild
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the next sibling (child of the same parent) of a given entry, optionally including already
- * deleted nodes if they have not been flushed.
+ * deleted nodes that snapshots still refer to.
  *
  * @return Reference to the next entry in the parent's child list, or
  *         NULL if already at the last child.
@@ -422,6 +439,52 @@ le_result_t resTree_Push
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a data sample with given units to a resource.
+ *
+ * @note Takes ownership of the data sample reference.
+ *
+ * @return
+ *      - LE_OK If datasample was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
+ *      - LE_IN_PROGRESS Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
+ *      - LE_FAULT is any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t resTree_PushWithUnits
+(
+    resTree_EntryRef_t entryRef,    ///< The entry to push to.
+    io_DataType_t dataType,         ///< The data type.
+    const char* units,              ///< The units (NULL or "" = take on resource's units)
+    dataSample_Ref_t dataSample     ///< The data sample (timestamp + value).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a numeric value to a resource.
+ *
+ * If the value would be dropped by all of the resource's routes, no data sample is created for
+ * it, to save the allocation.
+ *
+ * @return
+ *      - LE_OK If the value was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the value because of failure in memory allocation.
+ *      - LE_IN_PROGRESS Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
+ *      - LE_FAULT is any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t resTree_PushNumeric
+(
+    resTree_EntryRef_t entryRef,    ///< The entry to push to.
+    double timestamp,               ///< The timestamp (IO_NOW = now).
+    double value                    ///< The numeric value.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add a Push Handler to an Output resource.
@@ -657,6 +720,24 @@ admin_TransformType_t resTree_GetTransform
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a given transform, with given parameters, is the one currently applied to an
+ * Observation.  Setting a transform clears the Observation's buffer even if it is the same one,
+ * so this can be used to avoid re-applying it needlessly.
+ *
+ * @return true if setting this transform would not change the Observation's transform settings.
+ */
+//--------------------------------------------------------------------------------------------------
+bool resTree_IsTransformSet
+(
+    resTree_EntryRef_t obsEntry,
+    admin_TransformType_t transformType,
+    const double* paramsPtr,
+    size_t paramsSize
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the maximum number of data samples to buffer in a given Observation.  Buffers are FIFO
@@ -713,6 +794,60 @@ uint32_t resTree_GetBufferBackupPeriod
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the number of samples evicted from an Observation's buffer to keep in its spilled history
+ * on non-volatile storage.  See admin_SetBufferSpillMaxCount() for more information.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_SetBufferSpillMaxCount
+(
+    resTree_EntryRef_t obsEntry,
+    uint32_t count
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of samples evicted from an Observation's buffer to keep in its spilled history.
+ * See admin_SetBufferSpillMaxCount() for more information.
+ *
+ * @return The spill count (in number of samples) or 0 if the spilled history is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t resTree_GetBufferSpillMaxCount
+(
+    resTree_EntryRef_t obsEntry
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the precision with which an Observation's buffered numbers are stored.
+ * See admin_SetBufferPrecision() for more information.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_SetBufferPrecision
+(
+    resTree_EntryRef_t obsEntry,
+    admin_BufferPrecision_t precision
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the precision with which an Observation's buffered numbers are stored.
+ * See admin_SetBufferPrecision() for more information.
+ *
+ * @return The buffer precision.
+ */
+//--------------------------------------------------------------------------------------------------
+admin_BufferPrecision_t resTree_GetBufferPrecision
+(
+    resTree_EntryRef_t obsEntry
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Mark an Output resource "optional".  (By default, they are marked "mandatory".)
@@ -738,6 +873,38 @@ LE_SHARED bool resTree_IsMandatory
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the value of one of the runtime statistics counters of a resource.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_NOT_FOUND if the entry is not a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t resTree_GetStat
+(
+    resTree_EntryRef_t resEntry,
+    admin_StatCounter_t counter,
+    uint32_t* valuePtr          ///< [OUT] The value of the counter.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set all the runtime statistics counters of a resource back to zero.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_NOT_FOUND if the entry is not a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t resTree_ResetStats
+(
+    resTree_EntryRef_t resEntry
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the default value of a resource.
@@ -889,25 +1056,37 @@ double resTree_GetLastModified
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Set the node's relevance flag.
+ * Set the node's relevance flag in one of the relevance slots.
  */
 //--------------------------------------------------------------------------------------------------
 void resTree_SetRelevance
 (
     resTree_EntryRef_t  resEntry,   ///< Resource to query.
-    bool                relevant    ///< Relevance of node to current operation.
+    unsigned int        slot,       ///< Relevance slot of the operation.
+    bool                relevant    ///< Relevance of node to the operation.
 );
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the node's relevance flag.
+ * Get the node's relevance flag in one of the relevance slots.
  *
- * @return Relevance of node to the current operation.
+ * @return Relevance of node to the operation.
  */
 //--------------------------------------------------------------------------------------------------
 bool resTree_IsRelevant
 (
-    resTree_EntryRef_t resEntry ///< Resource to query.
+    resTree_EntryRef_t resEntry,    ///< Resource to query.
+    unsigned int       slot         ///< Relevance slot of the operation.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a new relevance pass in one of the relevance slots, making all nodes irrelevant in it.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_ResetRelevance
+(
+    unsigned int slot   ///< Relevance slot of the operation.
 );
 
 //--------------------------------------------------------------------------------------------------
@@ -957,7 +1136,8 @@ LE_SHARED bool resTree_IsNew
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Mark a node as deleted.
+ * Mark a node as deleted.  Deleted nodes are hidden from lookups, and only stay in the tree while a
+ * snapshot still refers to them.
  */
 //--------------------------------------------------------------------------------------------------
 void resTree_SetDeleted
@@ -969,7 +1149,7 @@ void resTree_SetDeleted
 /**
  * Get the node's "deleted" flag.
  *
- * @return Whether the node was deleted after the last flush.
+ * @return Whether the node was deleted.
  */
 //--------------------------------------------------------------------------------------------------
 LE_SHARED bool resTree_IsDeleted
@@ -977,6 +1157,57 @@ LE_SHARED bool resTree_IsDeleted
     resTree_EntryRef_t resEntry ///< Resource to query.
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record that the current value of a resource has changed, so that it can be found by
+ * resTree_GetChangedSince().
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_RecordChange
+(
+    resTree_EntryRef_t resEntry ///< Resource whose current value changed.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the newest time stamp of any value that the entry or any of its descendants has had.  None of
+ * the entries in the subtree can have a last modified time stamp newer than this.
+ *
+ * @return Time stamp value, in seconds since the Epoch, or -1 if none of them has had a value.
+ */
+//--------------------------------------------------------------------------------------------------
+double resTree_GetSubtreeLastModified
+(
+    resTree_EntryRef_t resEntry ///< Root of the subtree.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Iterate over the entries whose current value has a time stamp newer than a given time, newest
+ * first.  Entries whose value has since been removed may also be returned.
+ *
+ * @return The next entry, or NULL if there are no more.
+ */
+//--------------------------------------------------------------------------------------------------
+resTree_EntryRef_t resTree_GetChangedSince
+(
+    double since,                   ///< Only entries with values newer than this (in s).
+    resTree_EntryRef_t prevEntry    ///< Entry returned by the previous call, or NULL to start.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Iterate over the entries that may be new.  Every entry for which resTree_IsNew() is true is
+ * returned, but others may be returned too.
+ *
+ * @return The next entry, or NULL if there are no more.
+ */
+//--------------------------------------------------------------------------------------------------
+resTree_EntryRef_t resTree_GetNextStructureChange
+(
+    resTree_EntryRef_t prevEntry    ///< Entry returned by the previous call, or NULL to start.
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Notify that administrative changes are about to be performed.
@@ -1016,6 +1247,50 @@ void resTree_ForEachResource
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a given entry is at or under one of the paths marked high-priority.
+ *
+ * @return true if it is.
+ */
+//--------------------------------------------------------------------------------------------------
+bool resTree_IsHighPriorityEntry
+(
+    resTree_EntryRef_t entryRef
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mark or unmark a path as high-priority.  Route pushes to the resources at or under a
+ * high-priority path, including ones created later, are processed ahead of all the others.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_BAD_PARAMETER if the path is not a valid absolute path.
+ *      - LE_OUT_OF_RANGE if DHUB_MAX_PRIORITY_PATHS paths are already marked.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t resTree_SetHighPriority
+(
+    const char* path,   ///< Absolute path of a namespace or resource.
+    bool isHighPriority
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a given absolute path is at or under a path marked high-priority.
+ *
+ * @return true if it is.
+ */
+//--------------------------------------------------------------------------------------------------
+bool resTree_IsHighPriority
+(
+    const char* path    ///< Absolute path of a namespace or resource.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Read data out of a buffer.  Data is written to a given file descriptor in JSON-encoded format
@@ -1039,6 +1314,72 @@ void resTree_ReadBufferJson
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer in JSON format (like resTree_ReadBufferJson()), decimated to at most a
+ * given number of samples using the Largest-Triangle-Three-Buckets algorithm, which keeps the
+ * visual shape of the data.  The first and the last samples are always included.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride instead.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_ReadBufferJsonDecimated
+(
+    resTree_EntryRef_t obsEntry, ///< Observation entry.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to read the whole buffer.
+    uint32_t maxCount,  ///< Max number of samples to read (at least 3); 0 = no limit.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the samples in a buffer between two times, in JSON format (like resTree_ReadBufferJson()),
+ * decimated to at most a given number of samples using a given decimation mode.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_ReadBufferJsonRange
+(
+    resTree_EntryRef_t obsEntry, ///< Observation entry.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to start at the oldest sample.
+    double endAt,   ///< End at this many seconds ago, or at an absolute number of seconds since
+                    ///< the Epoch (if endAt > 30 years).  Use NAN to read up to the newest sample.
+    uint32_t maxCount,  ///< Max number of samples to read; 0 = no limit.
+    query_DecimationMode_t decimation, ///< How to select the samples, if decimating.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer.  Data is written to a given file descriptor in CBOR format as an
+ * indefinite-length array of [timestamp, value] arrays.  Timestamps and numeric values are
+ * doubles, Boolean values are true or false, trigger values are null, and string and JSON values
+ * are text strings.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_ReadBufferCbor
+(
+    resTree_EntryRef_t obsEntry, ///< Observation entry.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to read the whole buffer.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Find the oldest data sample held in a given Observation's buffer that is newer than a
@@ -1105,6 +1446,33 @@ LE_SHARED dataSample_Ref_t resTree_GetJsonExample
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the metadata encoding cached on a given resource by a snapshot formatter.
+ *
+ * @return The cached encoding, or NULL if none is cached.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void* resTree_GetMetadataCache
+(
+    resTree_EntryRef_t resEntry
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cache a snapshot formatter's encoding of a given resource's metadata.  The cache is dropped when
+ * the units or the default value of the resource change, or when the resource is deleted.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void resTree_SetMetadataCache
+(
+    resTree_EntryRef_t resEntry,
+    void* cachePtr  ///< Memory pool object, or NULL.  Ownership of this reference is passed to the
+                    ///< resource.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the JSON member/element specifier for extraction of data from within a structured JSON
@@ -1200,6 +1568,28 @@ double resTree_QueryStdDev
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the minimum, maximum, mean and standard deviation of all values found within a given time
+ * span in an Observation's buffer, all at once.
+ *
+ * If there's no numerical data in the Observation's buffer (if the buffer size is zero, the
+ * buffer is empty, or the buffer contains data of a non-numerical type), the count is zero and
+ * the statistics are NAN (not-a-number).
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_QueryStats
+(
+    resTree_EntryRef_t obsEntry,    ///< Observation entry.
+    double startTime,   ///< If < 30 years then seconds before now; else seconds since the Epoch.
+    double* minPtr,     ///< [OUT] Minimum value.
+    double* maxPtr,     ///< [OUT] Maximum value.
+    double* meanPtr,    ///< [OUT] Mean value.
+    double* stdDevPtr,  ///< [OUT] Standard deviation.
+    uint32_t* countPtr  ///< [OUT] Number of values the statistics were computed from.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Mark an observation as config.
@@ -11,10 +11,55 @@
 #include "ioPoint.h"
 #include "obs.h"
 #include "handler.h"
+#include "pushTrace.h"
 
 /// true if an extended configuration update is in progress, false if in normal operating mode.
 static bool IsUpdateInProgress = false;
 
+/// Default number of pending route pushes.  This can be overridden in the .cdef.  The pool is
+/// expanded from the heap on Linux, but on RTOS it caps the number of route pushes that can be
+/// waiting at once (about the widest fan-out of the routes), and pushes beyond that are dropped.
+#define DEFAULT_PENDING_PUSH_POOL_SIZE  16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A data sample waiting to be pushed along a route to a destination resource.
+ *
+ * Route fan-out is not done by recursion.  Instead, each destination is queued as one of these
+ * and the queue is drained breadth-first by the outermost res_Push() call.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_sls_Link_t link;             ///< Used to link into a pending push queue.
+    resTree_EntryRef_t entryRef;    ///< Destination entry (holds a reference).
+    io_DataType_t dataType;         ///< The data type of the sample.
+    dataSample_Ref_t dataSample;    ///< The data sample (holds a reference).
+    char units[HUB_MAX_UNITS_BYTES];///< Units of the source resource, or "" if unspecified.
+    bool isExtracted;               ///< true if JSON extraction has already been done.
+#ifdef DHUB_COALESCE_ROUTES
+    uint32_t count;                 ///< Number of updates folded into this one.
+#endif
+}
+PendingPush_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which PendingPush_t objects are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t PendingPushPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(PendingPushPool, DEFAULT_PENDING_PUSH_POOL_SIZE, sizeof(PendingPush_t));
+
+/// FIFO of route pushes waiting to be processed.
+static le_sls_List_t PendingPushQueue = LE_SLS_LIST_INIT;
+
+/// FIFO of route pushes to high-priority resources, processed ahead of the PendingPushQueue.
+static le_sls_List_t PriorityPushQueue = LE_SLS_LIST_INIT;
+
+/// true while the outermost res_Push() is draining the pending push queues.
+static bool IsPropagating = false;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Initialize the Resource module.
@@ -27,6 +72,9 @@ void res_Init
     void
 )
 {
+    PendingPushPool = le_mem_InitStaticPool(PendingPushPool, DEFAULT_PENDING_PUSH_POOL_SIZE,
+                        sizeof(PendingPush_t));
+    hub_RegisterPool(PendingPushPool);
 }
 
 
@@ -124,8 +172,33 @@ void res_Construct
     resPtr->defaultValue = NULL;
     resPtr->defaultType = IO_DATA_TYPE_TRIGGER;
     resPtr->flags = RES_FLAG_NEW;
-    resPtr->pushHandlerList = LE_DLS_LIST_INIT;
+    if (resTree_IsHighPriorityEntry(entryRef))
+    {
+        resPtr->flags |= RES_FLAG_HIGH_PRIORITY;
+    }
+    handler_InitList(&resPtr->pushHandlerList);
     resPtr->jsonExample = NULL;
+    resPtr->metadataCache = NULL;
+    res_ResetStats(resPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drop the metadata encoding cached on a resource, if any, after its metadata has changed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InvalidateMetadataCache
+(
+    res_Resource_t* resPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (resPtr->metadataCache != NULL)
+    {
+        le_mem_Release(resPtr->metadataCache);
+        resPtr->metadataCache = NULL;
+    }
 }
 
 
@@ -141,6 +214,8 @@ static void SetUnits
 )
 //--------------------------------------------------------------------------------------------------
 {
+    InvalidateMetadataCache(resPtr);
+
     if (le_utf8_Copy(resPtr->units, units, sizeof(resPtr->units), NULL) != LE_OK)
     {
         LE_CRIT("Units string too long!");
@@ -355,6 +430,7 @@ void res_ConvertIoToPlaceholder
     }
 
     memset(resPtr->units, 0, HUB_MAX_UNITS_BYTES);
+    InvalidateMetadataCache(resPtr);
 }
 
 
@@ -421,6 +497,8 @@ void res_Destruct
 
     handler_RemoveAll(&resPtr->pushHandlerList);
 
+    InvalidateMetadataCache(resPtr);
+
     if (resPtr->jsonExample != NULL)
     {
         LE_WARN("Resource had a JSON example value.");
@@ -480,6 +558,9 @@ dataSample_Ref_t res_GetCurrentValue
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // The caller may hold onto the sample, so it can no longer be updated in place.
+    resPtr->flags &= ~RES_FLAG_PRIVATE_VALUE;
+
     return resPtr->currentValue;
 }
 
@@ -587,10 +668,421 @@ resTree_EntryRef_t res_GetSource
 }
 
 
+#ifdef DHUB_COALESCE_ROUTES
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether pending pushes to a given destination may be folded into one.
+ *
+ * Observations that buffer or transform their samples need to see every one of them, so they
+ * are never coalesced.
+ *
+ * @return true if only the latest pending sample needs to be delivered.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CanCoalesce
+(
+    res_Resource_t* destPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (resTree_GetEntryType(destPtr->entryRef) != ADMIN_ENTRY_TYPE_OBSERVATION)
+    {
+        return true;
+    }
+
+    return (   (obs_GetBufferMaxCount(destPtr) == 0)
+            && (obs_GetTransform(destPtr) == OBS_TRANSFORM_TYPE_NONE) );
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue a data sample to be pushed along a route to a destination resource.
+ *
+ * @note Takes ownership of the data sample reference.
+ *
+ * @return
+ *      - LE_OK If the push was queued.
+ *      - LE_NO_MEMORY If there was no room in the queue (the sample is dropped).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t QueuePush
+(
+    res_Resource_t* destPtr,        ///< The destination resource.
+    io_DataType_t dataType,         ///< The data type.
+    const char* units,              ///< The units of the source resource.
+    dataSample_Ref_t dataSample,    ///< The data sample (timestamp + value).
+    bool isExtracted                ///< true if the destination's JSON extraction has been done.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    PendingPush_t* pendingPtr;
+    le_sls_List_t* queuePtr = (  (destPtr->flags & RES_FLAG_HIGH_PRIORITY)
+                               ? &PriorityPushQueue : &PendingPushQueue);
+
+#ifdef DHUB_COALESCE_ROUTES
+    // If an update to this destination is already waiting, replace its sample with this newer one.
+    if (CanCoalesce(destPtr))
+    {
+        le_sls_Link_t* linkPtr = le_sls_Peek(queuePtr);
+        while (linkPtr != NULL)
+        {
+            pendingPtr = CONTAINER_OF(linkPtr, PendingPush_t, link);
+
+            if (   (pendingPtr->entryRef == destPtr->entryRef)
+                && (pendingPtr->dataType == dataType)
+                && (pendingPtr->isExtracted == isExtracted))
+            {
+                le_mem_Release(pendingPtr->dataSample);
+                pendingPtr->dataSample = dataSample;
+                le_utf8_Copy(pendingPtr->units, units, sizeof(pendingPtr->units), NULL);
+                pendingPtr->count++;
+
+                return LE_OK;
+            }
+
+            linkPtr = le_sls_PeekNext(queuePtr, linkPtr);
+        }
+    }
+#endif
+
+    pendingPtr = hub_MemAlloc(PendingPushPool);
+    if (pendingPtr == NULL)
+    {
+        le_mem_Release(dataSample);
+        return LE_NO_MEMORY;
+    }
+
+    pendingPtr->link = LE_SLS_LINK_INIT;
+    pendingPtr->entryRef = destPtr->entryRef;
+    le_mem_AddRef(pendingPtr->entryRef);
+    pendingPtr->dataType = dataType;
+    pendingPtr->dataSample = dataSample;
+    le_utf8_Copy(pendingPtr->units, units, sizeof(pendingPtr->units), NULL);
+    pendingPtr->isExtracted = isExtracted;
+#ifdef DHUB_COALESCE_ROUTES
+    pendingPtr->count = 1;
+#endif
+
+    le_sls_Queue(queuePtr, &pendingPtr->link);
+
+    return LE_OK;
+}
+
+
+static le_result_t PushToResource(res_Resource_t* resPtr, io_DataType_t dataType,
+                                  const char* units, dataSample_Ref_t dataSample, bool isExtracted);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take the next queued route push off the pending push queues.
+ *
+ * @return Ptr to the push's link, or NULL if none are queued.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sls_Link_t* PopPendingPush
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_sls_Link_t* linkPtr = le_sls_Pop(&PriorityPushQueue);
+
+    if (linkPtr == NULL)
+    {
+        linkPtr = le_sls_Pop(&PendingPushQueue);
+    }
+
+    return linkPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push all the queued route pushes, including any that get queued while doing so, in the order
+ * they were queued.  Pushes to high-priority resources are done before any others.
+ *
+ * @return
+ *      - LE_OK If all the pushes were successful.
+ *      - LE_NO_MEMORY If at least one push failed because of lack of memory.
+ *      - Otherwise, the result of the first failed push.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t DrainPendingPushes
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t res = LE_OK;
+    le_sls_Link_t* linkPtr;
+
+    while ((linkPtr = PopPendingPush()) != NULL)
+    {
+        PendingPush_t* pendingPtr = CONTAINER_OF(linkPtr, PendingPush_t, link);
+        resTree_EntryRef_t entryRef = pendingPtr->entryRef;
+
+#ifdef DHUB_COALESCE_ROUTES
+        if (pendingPtr->count > 1)
+        {
+            LE_DEBUG("Coalesced %" PRIu32 " updates to '%s'.",
+                     pendingPtr->count,
+                     resTree_GetEntryName(entryRef));
+        }
+#endif
+
+        // The destination may have been deleted by a handler since the push was queued.
+        res_Resource_t* destPtr = resTree_GetResourcePtr(entryRef);
+        if (destPtr != NULL)
+        {
+            le_result_t pushRes = PushToResource(destPtr,
+                                                 pendingPtr->dataType,
+                                                 pendingPtr->units,
+                                                 pendingPtr->dataSample,
+                                                 pendingPtr->isExtracted);
+            if (pushRes != LE_OK)
+            {
+                LE_ERROR("Failed to update a value for entry %s with error: %d",
+                         resTree_GetEntryName(entryRef), pushRes);
+                if (res == LE_OK || pushRes == LE_NO_MEMORY)
+                {
+                    // Latch in error result if a push fails in the middle of processing multiple
+                    // destinations.  Precedence: LE_OK < [other errors] < LE_NO_MEMORY
+                    res = pushRes;
+                }
+            }
+        }
+        else
+        {
+            le_mem_Release(pendingPtr->dataSample);
+        }
+
+        le_mem_Release(entryRef);
+        le_mem_Release(pendingPtr);
+    }
+
+    return res;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Values already extracted for a resource's destinations from the JSON value being pushed to it
+ * (by a JSON worker thread).  Only valid during res_PushExtracted().
+ */
+//--------------------------------------------------------------------------------------------------
+static struct
+{
+    res_Resource_t* resPtr;         ///< The resource being pushed to, or NULL.
+    dataSample_Ref_t dataSample;    ///< The JSON data sample being pushed to it.
+    res_Resource_t** destPtrs;      ///< The destinations served, in destination list order.
+    const json_Span_t* spans;       ///< The span found for each of the destinations.
+    size_t count;                   ///< The number of destinations served.
+}
+Extracted;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Samples converted by type coercion while a push is propagated along routes, so that the
+ * destinations of a wide fan-out that need the same conversion of the same sample share one
+ * converted sample.  Only conversions of one source sample are kept at a time, and they are
+ * dropped once the propagation is finished.
+ */
+//--------------------------------------------------------------------------------------------------
+static struct
+{
+    dataSample_Ref_t fromSample;    ///< The source sample (reference held), or NULL if none.
+    dataSample_Ref_t toSamples[HANDLER_DATA_TYPE_COUNT]; ///< Conversions of it, by data type.
+}
+Coerced;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drop the samples kept by type coercion for sharing.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReleaseCoercedSamples
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (Coerced.fromSample == NULL)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < HANDLER_DATA_TYPE_COUNT; i++)
+    {
+        if (Coerced.toSamples[i] != NULL)
+        {
+            le_mem_Release(Coerced.toSamples[i]);
+            Coerced.toSamples[i] = NULL;
+        }
+    }
+
+    le_mem_Release(Coerced.fromSample);
+    Coerced.fromSample = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Perform type coercion for an Input or Output resource (see ioPoint_DoTypeCoercion()), sharing
+ * the converted sample with the other destinations of the same push that need the same
+ * conversion.
+ *
+ * @note Takes ownership of the data sample reference, replacing it with one to the converted
+ *       sample if there is a conversion.
+ *
+ * @return
+ *      - LE_OK If coercion happened successfully.
+ *      - LE_NO_MEMORY If could not coerce to a new type because failed to allocate a new datasample
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CoerceSample
+(
+    res_Resource_t* resPtr,
+    io_DataType_t* dataTypePtr,     ///< [INOUT] the data type, may be changed by type coercion
+    dataSample_Ref_t* valueRefPtr   ///< [INOUT] the data sample, may be replaced by type coercion
+)
+//--------------------------------------------------------------------------------------------------
+{
+    io_DataType_t toType = ioPoint_GetDataType(resPtr);
+    dataSample_Ref_t fromSample = *valueRefPtr;
+
+    // Overrides have their timestamps updated in place, so their conversions can't be shared.
+    if ((toType == *dataTypePtr) || res_IsOverridden(resPtr))
+    {
+        return ioPoint_DoTypeCoercion(resPtr, dataTypePtr, valueRefPtr);
+    }
+
+    if ((Coerced.fromSample == fromSample) && (Coerced.toSamples[toType] != NULL))
+    {
+        le_mem_AddRef(Coerced.toSamples[toType]);
+        le_mem_Release(fromSample);
+        *valueRefPtr = Coerced.toSamples[toType];
+        *dataTypePtr = toType;
+
+        return LE_OK;
+    }
+
+    // Hold on to the source sample while its conversion is kept, so it can be recognized.
+    le_mem_AddRef(fromSample);
+
+    le_result_t result = ioPoint_DoTypeCoercion(resPtr, dataTypePtr, valueRefPtr);
+
+    if ((result != LE_OK) || (*valueRefPtr == fromSample))
+    {
+        le_mem_Release(fromSample);
+        return result;
+    }
+
+    if (Coerced.fromSample != fromSample)
+    {
+        ReleaseCoercedSamples();
+        Coerced.fromSample = fromSample;
+    }
+    else
+    {
+        le_mem_Release(fromSample);
+    }
+
+    le_mem_AddRef(*valueRefPtr);
+    Coerced.toSamples[toType] = *valueRefPtr;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get those of a resource's destinations that are Observations with JSON extraction specifiers.
+ *
+ * @return The number of destinations found (at most JSON_MAX_MULTI_EXTRACTIONS).  They are
+ *         listed in the same order as in the resource's destination list.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t res_GetExtractingDestinations
+(
+    res_Resource_t* resPtr,         ///< The source resource.
+    res_Resource_t* destPtrs[]      ///< [OUT] The destinations (JSON_MAX_MULTI_EXTRACTIONS).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t count = 0;
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&(resPtr->destList));
+    while ((linkPtr != NULL) && (count < JSON_MAX_MULTI_EXTRACTIONS))
+    {
+        res_Resource_t* destPtr = CONTAINER_OF(linkPtr, res_Resource_t, destListLink);
+
+        if (   (resTree_GetEntryType(destPtr->entryRef) == ADMIN_ENTRY_TYPE_OBSERVATION)
+            && (obs_GetJsonProgram(destPtr) != NULL))
+        {
+            destPtrs[count] = destPtr;
+            count++;
+        }
+
+        linkPtr = le_dls_PeekNext(&(resPtr->destList), linkPtr);
+    }
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find, in a single pass over a resource's JSON value, the values to be extracted by those of
+ * its destinations that are Observations with JSON extraction specifiers.
+ *
+ * This is only done if there are at least two such Observations.  Otherwise, each Observation
+ * does its own extraction when the push reaches it.
+ *
+ * @return The number of destinations that were served (0 if none).  They are listed in the
+ *         same order as in the resource's destination list.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t ExtractForDestinations
+(
+    res_Resource_t* resPtr,         ///< The source resource.
+    dataSample_Ref_t dataSample,    ///< The JSON data sample being pushed out of it.
+    res_Resource_t* destPtrs[],     ///< [OUT] The destinations served (JSON_MAX_MULTI_EXTRACTIONS).
+    json_Span_t spans[]             ///< [OUT] The span found for each of the destinations.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const json_Extraction_t* extractionPtrs[JSON_MAX_MULTI_EXTRACTIONS];
+    size_t count = res_GetExtractingDestinations(resPtr, destPtrs);
+
+    if (count < 2)
+    {
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        extractionPtrs[i] = obs_GetJsonProgram(destPtrs[i]);
+    }
+
+    LE_ASSERT(json_ExtractMultiple(dataSample_GetJson(dataSample),
+                                   extractionPtrs,
+                                   count,
+                                   spans) == LE_OK);
+
+    return count;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Update the current value of a resource.  This can have the side effect of pushing the value
  * out to other resources or apps that have registered to receive Pushes from this resource.
+ * Pushes to other resources are queued, to be done by the outermost res_Push().
  *
  * @note This function takes ownership of the dataSample reference it is passed.
  *
@@ -619,10 +1111,13 @@ static le_result_t UpdateCurrentValue
                 hub_GetDataTypeName(ioPoint_GetDataType(resPtr)));
 
         le_mem_Release(dataSample);
+        res_AddToStat(resPtr, ADMIN_STAT_DROPPED_MISMATCH, 1);
 
         return LE_BAD_PARAMETER;
     }
 
+    res_AddToStat(resPtr, ADMIN_STAT_ACCEPTED, 1);
+
     // Set the current value to the new data sample.
     if (resPtr->currentValue != NULL)
     {
@@ -630,6 +1125,8 @@ static le_result_t UpdateCurrentValue
     }
     resPtr->currentType = dataType;
     resPtr->currentValue = dataSample;
+    resPtr->flags &= ~RES_FLAG_PRIVATE_VALUE;
+    resTree_RecordChange(resPtr->entryRef);
 
     // If data type is JSON and there isn't a JSON example value for this resource yet,
     // then make this the JSON example value.
@@ -649,40 +1146,83 @@ static le_result_t UpdateCurrentValue
     }
 
     le_result_t res = LE_OK;
+    uint64_t stageStart = pushTrace_StageStart();
+
+    // If several destinations extract from this JSON value, find all their values in one pass,
+    // unless a JSON worker thread has already done so.
+    res_Resource_t* extractBuffer[JSON_MAX_MULTI_EXTRACTIONS];
+    json_Span_t spanBuffer[JSON_MAX_MULTI_EXTRACTIONS];
+    res_Resource_t** extractDestPtrs = extractBuffer;
+    const json_Span_t* extractSpans = spanBuffer;
+    size_t extractCount = 0;
+    size_t extractIndex = 0;
+    if ((Extracted.resPtr == resPtr) && (Extracted.dataSample == dataSample))
+    {
+        extractDestPtrs = Extracted.destPtrs;
+        extractSpans = Extracted.spans;
+        extractCount = Extracted.count;
+        Extracted.resPtr = NULL;
+    }
+    else if (dataType == IO_DATA_TYPE_JSON)
+    {
+        extractCount = ExtractForDestinations(resPtr, dataSample, extractBuffer, spanBuffer);
+    }
 
-    // Iterate over the list of destination routes, pushing to all of them.
+    // Iterate over the list of destination routes, queueing a push to each of them.
     le_dls_Link_t* linkPtr = le_dls_Peek(&(resPtr->destList));
     while (linkPtr != NULL)
     {
         res_Resource_t* destPtr = CONTAINER_OF(linkPtr, res_Resource_t, destListLink);
+        dataSample_Ref_t destSample = NULL;
+        io_DataType_t destType = dataType;
 
-        // Increment the reference count before pushing.
-        le_mem_AddRef(dataSample);
+        // The destinations served by the shared extraction were collected in list order.
+        // If the value wasn't found for one of them, it gets the whole JSON value and its own
+        // extraction reports the failure.
+        if ((extractIndex < extractCount) && (extractDestPtrs[extractIndex] == destPtr))
+        {
+            destSample = dataSample_ExtractJsonSpan(dataSample,
+                                                    &extractSpans[extractIndex],
+                                                    obs_GetJsonExtraction(destPtr),
+                                                    &destType);
+            extractIndex++;
+        }
 
-        le_result_t pushRes = res_Push(destPtr, dataType, resPtr->units, dataSample);
-        if (pushRes != LE_OK)
+        if (destSample == NULL)
         {
-            LE_ERROR("Failed to update a value for entry %s with error: %d",
-                     resTree_GetEntryName(destPtr->entryRef), res);
-            if (res == LE_OK || pushRes == LE_NO_MEMORY)
-            {
-                // Latch in error result if a push fails in the middle of processing multiple
-                // destinations.  Precedence: LE_OK < [other errors] < LE_NO_MEMORY
-                res = pushRes;
-            }
+            // Increment the reference count before queueing.
+            le_mem_AddRef(dataSample);
+            destSample = dataSample;
+            destType = dataType;
+        }
+
+        if (QueuePush(destPtr, destType, resPtr->units, destSample, destSample != dataSample)
+            != LE_OK)
+        {
+            LE_ERROR("Failed to queue a value for entry %s.",
+                     resTree_GetEntryName(destPtr->entryRef));
+            res_AddToStat(destPtr, ADMIN_STAT_DROPPED_NO_MEMORY, 1);
+            res = LE_NO_MEMORY;
         }
 
         linkPtr = le_dls_PeekNext(&(resPtr->destList), linkPtr);
     }
+    pushTrace_StageEnd(ADMIN_TRACE_STAGE_FAN_OUT, stageStart);
 
     // Call any the push handlers that match the data type of the sample.
-    handler_CallAll(&resPtr->pushHandlerList, dataType, dataSample);
+    stageStart = pushTrace_StageStart();
+    res_AddToStat(resPtr,
+                  ADMIN_STAT_HANDLER_CALLS,
+                  handler_CallAll(&resPtr->pushHandlerList, dataType, dataSample));
+    pushTrace_StageEnd(ADMIN_TRACE_STAGE_HANDLERS, stageStart);
 
     admin_EntryType_t type = resTree_GetEntryType(resPtr->entryRef);
     if (type == ADMIN_ENTRY_TYPE_OBSERVATION)
     {
         // Call the destination push handler for this observation
+        stageStart = pushTrace_StageStart();
         obs_TriggerDestinationCallback(resPtr, dataType, dataSample);
+        pushTrace_StageEnd(ADMIN_TRACE_STAGE_DESTINATION, stageStart);
     }
 
     return res;
@@ -691,7 +1231,7 @@ static le_result_t UpdateCurrentValue
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Push a data sample to a resource.
+ * Push a data sample to a resource, queueing (but not doing) the pushes to its destinations.
  *
  * @note Takes ownership of the data sample reference.
  *
@@ -703,17 +1243,20 @@ static le_result_t UpdateCurrentValue
  *      - LE_FAULT If any other error happened during push.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t res_Push
+static le_result_t PushToResource
 (
     res_Resource_t* resPtr,         ///< The resource to push to.
     io_DataType_t dataType,         ///< The data type.
     const char* units,              ///< The units (NULL or "" = take on resource's units)
-    dataSample_Ref_t dataSample     ///< The data sample (timestamp + value).
+    dataSample_Ref_t dataSample,    ///< The data sample (timestamp + value).
+    bool isExtracted                ///< true if JSON extraction has already been done.
 )
 //--------------------------------------------------------------------------------------------------
 {
     LE_ASSERT(resPtr->entryRef != NULL);
 
+    res_AddToStat(resPtr, ADMIN_STAT_RECEIVED, 1);
+
     if ((units != NULL) && (*units == '\0'))
     {
         units = NULL;
@@ -721,21 +1264,45 @@ le_result_t res_Push
 
     if (ADMIN_ENTRY_TYPE_OBSERVATION == resTree_GetEntryType(resPtr->entryRef))
     {
-        // Do JSON extraction (if applicable) before filtering.
-        if (obs_DoJsonExtraction(resPtr, &dataType, &dataSample) != LE_OK)
+        // Do JSON extraction (if applicable and not already done) before filtering.
+        if (!isExtracted)
         {
-            le_mem_Release(dataSample);
-            LE_ERROR("Rejecting push because failed to do JSON extraction on datasample");
-            return LE_FAULT;
+            uint64_t stageStart = pushTrace_StageStart();
+            le_result_t extractRes = obs_DoJsonExtraction(resPtr, &dataType, &dataSample);
+            pushTrace_StageEnd(ADMIN_TRACE_STAGE_EXTRACTION, stageStart);
+
+            if (extractRes != LE_OK)
+            {
+                le_mem_Release(dataSample);
+                res_AddToStat(resPtr, ADMIN_STAT_EXTRACTION_FAILURES, 1);
+                LE_ERROR("Rejecting push because failed to do JSON extraction on datasample");
+                return LE_FAULT;
+            }
+        }
+
+        // If the Observation is downsampling, fold the sample into the current bucket.  Only the
+        // aggregate of each completed bucket carries on through the Observation.
+        uint64_t stageStart = pushTrace_StageStart();
+        dataSample = obs_ApplyDownsampling(resPtr, dataType, dataSample);
+        pushTrace_StageEnd(ADMIN_TRACE_STAGE_FILTERING, stageStart);
+        if (dataSample == NULL)
+        {
+            return LE_OK;
         }
 
         // Buffer and possibly backup the sample
+        stageStart = pushTrace_StageStart();
         obs_ProcessAccepted(resPtr, dataType, dataSample);
 
         // Perform any transforms on the buffered data
         dataSample = obs_ApplyTransform(resPtr, dataType, dataSample);
+        pushTrace_StageEnd(ADMIN_TRACE_STAGE_BUFFERING, stageStart);
 
-        if (true != obs_ShouldAccept(resPtr, dataType, dataSample))
+        // Note: the Observation counts the reason for rejecting the sample.
+        stageStart = pushTrace_StageStart();
+        bool isAccepted = obs_ShouldAccept(resPtr, dataType, dataSample);
+        pushTrace_StageEnd(ADMIN_TRACE_STAGE_FILTERING, stageStart);
+        if (true != isAccepted)
         {
             le_mem_Release(dataSample);
             LE_ERROR("Rejecting push because datasample should not be accepted");
@@ -752,6 +1319,7 @@ le_result_t res_Push
     le_mem_AddRef(dataSample);
     resPtr->pushedValue = dataSample;
     resPtr->pushedType = dataType;
+    resPtr->flags &= ~RES_FLAG_PRIVATE_VALUE;
 
     // If the resource is undergoing a change to its routing or filtering configuration,
     // then acceptance of new samples is suspended until the configuration change is done.
@@ -759,6 +1327,7 @@ le_result_t res_Push
     {
         LE_WARN("Rejecting pushed value because configuration update is in progress.");
         le_mem_Release(dataSample);
+        res_AddToStat(resPtr, ADMIN_STAT_DROPPED_UPDATING, 1);
         return LE_IN_PROGRESS;
     }
 
@@ -767,6 +1336,11 @@ le_result_t res_Push
     // original sample).
     if (res_IsOverridden(resPtr))
     {
+        // Conversions of the override value with its old timestamp can no longer be shared.
+        if (Coerced.fromSample == resPtr->overrideValue)
+        {
+            ReleaseCoercedSamples();
+        }
         dataSample_SetTimestamp(resPtr->overrideValue, dataSample_GetTimestamp(dataSample));
         le_mem_AddRef(resPtr->overrideValue);
         le_mem_Release(dataSample);
@@ -790,42 +1364,258 @@ le_result_t res_Push
                         units,
                         resPtr->units);
                 le_mem_Release(dataSample);
+                res_AddToStat(resPtr, ADMIN_STAT_DROPPED_MISMATCH, 1);
                 return LE_BAD_PARAMETER;
             }
 
             // Inputs and outputs have a fixed type.  This means that if a different type
             // of value is received, we must do a type conversion before we can accept it.
-            le_result_t res = ioPoint_DoTypeCoercion(resPtr, &dataType, &dataSample);
+            io_DataType_t pushedType = dataType;
+            uint64_t stageStart = pushTrace_StageStart();
+            le_result_t res = CoerceSample(resPtr, &dataType, &dataSample);
+            pushTrace_StageEnd(ADMIN_TRACE_STAGE_COERCION, stageStart);
             if (res != LE_OK)
             {
                 LE_ERROR("Rejecting push because failed to do type coercion on datasample");
+                res_AddToStat(resPtr, ADMIN_STAT_DROPPED_NO_MEMORY, 1);
                 return res;
             }
+            if (dataType != pushedType)
+            {
+                res_AddToStat(resPtr, ADMIN_STAT_COERCIONS, 1);
+            }
             break;
 
-        case ADMIN_ENTRY_TYPE_OBSERVATION:
+        case ADMIN_ENTRY_TYPE_OBSERVATION:
+
+            // *** FALL THROUGH ***
+
+        case ADMIN_ENTRY_TYPE_PLACEHOLDER:
+
+            // Note: Placeholders accept everything.
+
+            // This is a units-flexible resource, so if the units were provided,
+            // apply the units to this resource.
+            if (units != NULL)
+            {
+                SetUnits(resPtr, units);
+            }
+
+            break;
+
+        default:
+            LE_FATAL("Unexpected entry type.");
+            break;
+    }
+
+    return UpdateCurrentValue(resPtr, dataType, dataSample);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a data sample to a resource.
+ *
+ * The push is propagated along routes breadth-first, from a queue, rather than by recursion, so
+ * stack usage does not grow with the length of a route chain.  If this is called while a push
+ * is already being propagated (e.g., from a push handler), the resulting route pushes are added
+ * to the same queue.
+ *
+ * @note Takes ownership of the data sample reference.
+ *
+ * @return
+ *      - LE_OK If datasample was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
+ *      - LE_IN_PROGRESS Push is rejected because a configuration update is in progress.
+ *      - LE_BAD_PARAMETER If there is a mismatch if datasample unit.
+ *      - LE_FAULT If any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t res_Push
+(
+    res_Resource_t* resPtr,         ///< The resource to push to.
+    io_DataType_t dataType,         ///< The data type.
+    const char* units,              ///< The units (NULL or "" = take on resource's units)
+    dataSample_Ref_t dataSample     ///< The data sample (timestamp + value).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (IsPropagating)
+    {
+        return PushToResource(resPtr, dataType, units, dataSample, false);
+    }
+
+    IsPropagating = true;
+
+    le_result_t res = PushToResource(resPtr, dataType, units, dataSample, false);
+    le_result_t drainRes = DrainPendingPushes();
+
+    ReleaseCoercedSamples();
+    IsPropagating = false;
+
+    if ((drainRes != LE_OK) && ((res == LE_OK) || (drainRes == LE_NO_MEMORY)))
+    {
+        res = drainRes;
+    }
+
+    return res;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a JSON data sample to a resource, using values already extracted from it for some of its
+ * destinations instead of extracting them again.
+ *
+ * @note Takes ownership of the data sample reference.
+ *
+ * @return Same as res_Push().
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t res_PushExtracted
+(
+    res_Resource_t* resPtr,         ///< The resource to push to.
+    io_DataType_t dataType,         ///< The data type.
+    const char* units,              ///< The units (NULL or "" = take on resource's units)
+    dataSample_Ref_t dataSample,    ///< The data sample (timestamp + value).
+    res_Resource_t* destPtrs[],     ///< The destinations served, in destination list order.
+    const json_Span_t spans[],      ///< The span found in the JSON value for each destination.
+    size_t count                    ///< The number of destinations served.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((dataType == IO_DATA_TYPE_JSON) && (count > 0))
+    {
+        Extracted.resPtr = resPtr;
+        Extracted.dataSample = dataSample;
+        Extracted.destPtrs = destPtrs;
+        Extracted.spans = spans;
+        Extracted.count = count;
+    }
+
+    le_result_t result = res_Push(resPtr, dataType, units, dataSample);
+
+    // In case the sample didn't make it to the resource's destinations.
+    Extracted.resPtr = NULL;
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a numeric value to a resource without creating a data sample, if none of the resource's
+ * destinations would accept it and nothing else would see it.
+ *
+ * This is the case for an Input or Output of numeric type that has no push handlers or override,
+ * and whose destinations are all Observations that would filter out the value (e.g., by their
+ * minimum period).  Only the current value of the resource is updated then.  The sample that
+ * holds it is updated in place if it isn't shared, so a steady stream of such pushes needs no
+ * allocations.
+ *
+ * @return
+ *      - LE_UNAVAILABLE If the value must be pushed normally, using res_Push().
+ *      - LE_OK If the value was pushed (and there were no destinations to drop it).
+ *      - LE_FAULT If the value was pushed, but dropped by all the destinations.
+ *      - LE_NO_MEMORY If failed to store the value.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t res_PushNumericIfDropped
+(
+    res_Resource_t* resPtr,         ///< The resource to push to.
+    double timestamp,               ///< The timestamp (IO_NOW = now).
+    double value                    ///< The numeric value.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    admin_EntryType_t entryType = resTree_GetEntryType(resPtr->entryRef);
+
+    if (   ((entryType != ADMIN_ENTRY_TYPE_INPUT) && (entryType != ADMIN_ENTRY_TYPE_OUTPUT))
+        || (ioPoint_GetDataType(resPtr) != IO_DATA_TYPE_NUMERIC)
+        || (resPtr->flags & RES_FLAG_CHANGING_CONFIG)
+        || res_IsOverridden(resPtr)
+        || (resPtr->jsonExample != NULL)
+        || (!handler_IsListEmpty(&resPtr->pushHandlerList))  )
+    {
+        return LE_UNAVAILABLE;
+    }
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&(resPtr->destList));
+    le_result_t res = (linkPtr == NULL ? LE_OK : LE_FAULT);
+    uint64_t stageStart = pushTrace_StageStart();
+
+    while (linkPtr != NULL)
+    {
+        res_Resource_t* destPtr = CONTAINER_OF(linkPtr, res_Resource_t, destListLink);
+
+        if (   (resTree_GetEntryType(destPtr->entryRef) != ADMIN_ENTRY_TYPE_OBSERVATION)
+            || (!obs_WouldDropNumeric(destPtr, value)))
+        {
+            pushTrace_StageEnd(ADMIN_TRACE_STAGE_FILTERING, stageStart);
+            return LE_UNAVAILABLE;
+        }
+
+        linkPtr = le_dls_PeekNext(&(resPtr->destList), linkPtr);
+    }
+
+    // The pushes that the destinations would have received are counted as dropped by them.
+    linkPtr = le_dls_Peek(&(resPtr->destList));
+    while (linkPtr != NULL)
+    {
+        obs_CountNumericDrop(CONTAINER_OF(linkPtr, res_Resource_t, destListLink), value);
 
-            // *** FALL THROUGH ***
+        linkPtr = le_dls_PeekNext(&(resPtr->destList), linkPtr);
+    }
+    pushTrace_StageEnd(ADMIN_TRACE_STAGE_FILTERING, stageStart);
 
-        case ADMIN_ENTRY_TYPE_PLACEHOLDER:
+    res_AddToStat(resPtr, ADMIN_STAT_RECEIVED, 1);
 
-            // Note: Placeholders accept everything.
+    // If the current value is a sample that only this resource has, just update it.
+    if (   (resPtr->flags & RES_FLAG_PRIVATE_VALUE)
+        && (resPtr->currentValue != NULL)
+        && (resPtr->currentValue == resPtr->pushedValue))
+    {
+        if (timestamp == IO_NOW)
+        {
+            le_clk_Time_t currentTime = le_clk_GetAbsoluteTime();
+            timestamp = (((double)(currentTime.usec)) / 1000000) + currentTime.sec;
+        }
 
-            // This is a units-flexible resource, so if the units were provided,
-            // apply the units to this resource.
-            if (units != NULL)
-            {
-                SetUnits(resPtr, units);
-            }
+        dataSample_SetTimestamp(resPtr->currentValue, timestamp);
+        dataSample_SetNumeric(resPtr->currentValue, value);
+        resTree_RecordChange(resPtr->entryRef);
+        res_AddToStat(resPtr, ADMIN_STAT_ACCEPTED, 1);
 
-            break;
+        return res;
+    }
 
-        default:
-            LE_FATAL("Unexpected entry type.");
-            break;
+    dataSample_Ref_t dataSample = dataSample_CreateNumeric(timestamp, value);
+    if (dataSample == NULL)
+    {
+        res_AddToStat(resPtr, ADMIN_STAT_DROPPED_NO_MEMORY, 1);
+        return LE_NO_MEMORY;
     }
+    res_AddToStat(resPtr, ADMIN_STAT_ACCEPTED, 1);
 
-    return UpdateCurrentValue(resPtr, dataType, dataSample);
+    if (resPtr->pushedValue != NULL)
+    {
+        le_mem_Release(resPtr->pushedValue);
+    }
+    le_mem_AddRef(dataSample);
+    resPtr->pushedValue = dataSample;
+    resPtr->pushedType = IO_DATA_TYPE_NUMERIC;
+
+    if (resPtr->currentValue != NULL)
+    {
+        le_mem_Release(resPtr->currentValue);
+    }
+    resPtr->currentValue = dataSample;
+    resPtr->currentType = IO_DATA_TYPE_NUMERIC;
+
+    resPtr->flags |= RES_FLAG_PRIVATE_VALUE;
+    resTree_RecordChange(resPtr->entryRef);
+
+    return res;
 }
 
 
@@ -877,7 +1667,7 @@ bool res_HasAdminSettings
             || (!le_dls_IsEmpty(&resPtr->destList)) // Destination list
             || (resPtr->overrideValue != NULL) // Override
             || (resPtr->defaultValue != NULL) // Default
-            || (! le_dls_IsEmpty(&resPtr->pushHandlerList)) ); // Push handlers
+            || (! handler_IsListEmpty(&resPtr->pushHandlerList)) ); // Push handlers
 }
 
 
@@ -930,6 +1720,7 @@ static void DropSettings
     {
         le_mem_Release(resPtr->defaultValue);
         resPtr->defaultValue = NULL;
+        InvalidateMetadataCache(resPtr);
     }
 
     // Drop the JSON example value
@@ -1165,6 +1956,28 @@ admin_TransformType_t res_GetTransform
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a given transform, with given parameters, is the one currently applied to an
+ * Observation.  Setting a transform clears the Observation's buffer even if it is the same one,
+ * so this can be used to avoid re-applying it needlessly.
+ *
+ * @return true if setting this transform would not change the Observation's transform settings.
+ */
+//--------------------------------------------------------------------------------------------------
+bool res_IsTransformSet
+(
+    res_Resource_t* resPtr,
+    admin_TransformType_t transformType,
+    const double* paramsPtr,
+    size_t paramsSize
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return obs_IsTransformSet(resPtr, (obs_TransformType_t)transformType, paramsPtr, paramsSize);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the maximum number of data samples to buffer in a given Observation.  Buffers are FIFO
@@ -1237,6 +2050,77 @@ uint32_t res_GetBufferBackupPeriod
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the number of samples evicted from an Observation's buffer to keep in its spilled history
+ * on non-volatile storage.  See admin_SetBufferSpillMaxCount() for more information.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_SetBufferSpillMaxCount
+(
+    res_Resource_t* resPtr,
+    uint32_t count
+)
+//--------------------------------------------------------------------------------------------------
+{
+    obs_SetBufferSpillMaxCount(resPtr, count);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of samples evicted from an Observation's buffer to keep in its spilled history.
+ * See admin_SetBufferSpillMaxCount() for more information.
+ *
+ * @return The spill count (in number of samples) or 0 if the spilled history is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t res_GetBufferSpillMaxCount
+(
+    res_Resource_t* resPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return obs_GetBufferSpillMaxCount(resPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the precision with which an Observation's buffered numbers are stored.
+ * See admin_SetBufferPrecision() for more information.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_SetBufferPrecision
+(
+    res_Resource_t* resPtr,
+    admin_BufferPrecision_t precision
+)
+//--------------------------------------------------------------------------------------------------
+{
+    obs_SetBufferCompact(resPtr, (precision == ADMIN_BUFFER_PRECISION_COMPACT));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the precision with which an Observation's buffered numbers are stored.
+ * See admin_SetBufferPrecision() for more information.
+ *
+ * @return The buffer precision.
+ */
+//--------------------------------------------------------------------------------------------------
+admin_BufferPrecision_t res_GetBufferPrecision
+(
+    res_Resource_t* resPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (obs_IsBufferCompact(resPtr) ? ADMIN_BUFFER_PRECISION_COMPACT
+                                        : ADMIN_BUFFER_PRECISION_FULL);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Mark an Output resource "optional".  (By default, they are marked "mandatory".)
@@ -1293,6 +2177,9 @@ le_result_t res_SetDefault
 //--------------------------------------------------------------------------------------------------
 {
     le_result_t ret;
+
+    InvalidateMetadataCache(resPtr);
+
     if (resPtr->defaultValue != NULL)
     {
         le_mem_Release(resPtr->defaultValue);
@@ -1399,6 +2286,7 @@ void res_RemoveDefault
     {
         le_mem_Release(resPtr->defaultValue);
         resPtr->defaultValue = NULL;
+        InvalidateMetadataCache(resPtr);
     }
 }
 
@@ -1563,42 +2451,6 @@ void res_RemoveOverride
     }
 }
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Set the resource's relevance flag.
- */
-//--------------------------------------------------------------------------------------------------
-void res_SetRelevance
-(
-    res_Resource_t  *resPtr,    ///< Resource to query.
-    bool             relevant   ///< Relevance of resource to current operation.
-)
-{
-    if (relevant)
-    {
-        resPtr->flags |= RES_FLAG_RELEVANT;
-    }
-    else
-    {
-        resPtr->flags &= ~RES_FLAG_RELEVANT;
-    }
-}
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Get the resource's relevance flag.
- *
- * @return Relevance of resource to the current operation.
- */
-//--------------------------------------------------------------------------------------------------
-bool res_IsRelevant
-(
-    res_Resource_t *resPtr ///< Resource to query.
-)
-{
-    return (resPtr->flags & RES_FLAG_RELEVANT);
-}
-
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the resource's clear newness flag
@@ -1741,6 +2593,91 @@ void res_ReadBufferJson
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer in JSON format (like res_ReadBufferJson()), decimated to at most a
+ * given number of samples using the Largest-Triangle-Three-Buckets algorithm, which keeps the
+ * visual shape of the data.  The first and the last samples are always included.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride instead.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_ReadBufferJsonDecimated
+(
+    res_Resource_t* resPtr, ///< Ptr to the resource object for the Observation.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to read the whole buffer.
+    uint32_t maxCount,  ///< Max number of samples to read (at least 3); 0 = no limit.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    obs_ReadBufferJsonDecimated(resPtr, startAfter, maxCount, outputFile, handlerPtr, contextPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the samples in a buffer between two times, in JSON format (like res_ReadBufferJson()),
+ * decimated to at most a given number of samples using a given decimation mode.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_ReadBufferJsonRange
+(
+    res_Resource_t* resPtr, ///< Ptr to the resource object for the Observation.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to start at the oldest sample.
+    double endAt,   ///< End at this many seconds ago, or at an absolute number of seconds since
+                    ///< the Epoch (if endAt > 30 years).  Use NAN to read up to the newest sample.
+    uint32_t maxCount,  ///< Max number of samples to read; 0 = no limit.
+    query_DecimationMode_t decimation, ///< How to select the samples, if decimating.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    obs_ReadBufferJsonRange(resPtr,
+                            startAfter,
+                            endAt,
+                            maxCount,
+                            decimation,
+                            outputFile,
+                            handlerPtr,
+                            contextPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer.  Data is written to a given file descriptor in CBOR format as an
+ * indefinite-length array of [timestamp, value] arrays.  Timestamps and numeric values are
+ * doubles, Boolean values are true or false, trigger values are null, and string and JSON values
+ * are text strings.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_ReadBufferCbor
+(
+    res_Resource_t* resPtr, ///< Ptr to the resource object for the Observation.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to read the whole buffer.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    obs_ReadBufferCbor(resPtr, startAfter, outputFile, handlerPtr, contextPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Find the oldest data sample held in a given Observation's buffer that is newer than a
@@ -1846,6 +2783,82 @@ dataSample_Ref_t res_GetJsonExample
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the metadata encoding cached on a given resource by a snapshot formatter.
+ *
+ * @return The cached encoding, or NULL if none is cached.
+ */
+//--------------------------------------------------------------------------------------------------
+void* res_GetMetadataCache
+(
+    res_Resource_t* resPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return resPtr->metadataCache;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cache a snapshot formatter's encoding of a given resource's metadata.  The cache is dropped when
+ * the units or the default value of the resource change.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_SetMetadataCache
+(
+    res_Resource_t* resPtr,
+    void* cachePtr  ///< Memory pool object, or NULL.  Ownership of this reference is passed to the
+                    ///< resource.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    InvalidateMetadataCache(resPtr);
+    resPtr->metadataCache = cachePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set whether route pushes to a given resource are processed ahead of those to other resources.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_SetHighPriority
+(
+    res_Resource_t* resPtr,
+    bool isHighPriority
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (isHighPriority)
+    {
+        resPtr->flags |= RES_FLAG_HIGH_PRIORITY;
+    }
+    else
+    {
+        resPtr->flags &= ~RES_FLAG_HIGH_PRIORITY;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether route pushes to a given resource are processed ahead of those to other resources.
+ *
+ * @return true if the resource is high-priority.
+ */
+//--------------------------------------------------------------------------------------------------
+bool res_IsHighPriority
+(
+    res_Resource_t* resPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return ((resPtr->flags & RES_FLAG_HIGH_PRIORITY) != 0);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the JSON member/element specifier for extraction of data from within a structured JSON
@@ -1965,6 +2978,32 @@ double res_QueryStdDev
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the minimum, maximum, mean and standard deviation of all values found within a given time
+ * span in an Observation's buffer, all at once.
+ *
+ * If there's no numerical data in the Observation's buffer (if the buffer size is zero, the
+ * buffer is empty, or the buffer contains data of a non-numerical type), the count is zero and
+ * the statistics are NAN (not-a-number).
+ */
+//--------------------------------------------------------------------------------------------------
+void res_QueryStats
+(
+    res_Resource_t* resPtr,    ///< Ptr to Observation resource.
+    double startTime,   ///< If < 30 years then seconds before now; else seconds since the Epoch.
+    double* minPtr,     ///< [OUT] Minimum value.
+    double* maxPtr,     ///< [OUT] Maximum value.
+    double* meanPtr,    ///< [OUT] Mean value.
+    double* stdDevPtr,  ///< [OUT] Standard deviation.
+    uint32_t* countPtr  ///< [OUT] Number of values the statistics were computed from.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    obs_QueryStats(resPtr, startTime, minPtr, maxPtr, meanPtr, stdDevPtr, countPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Mark an observation as config.
@@ -10,17 +10,25 @@
 #ifndef RESOURCE_H_INCLUDE_GUARD
 #define RESOURCE_H_INCLUDE_GUARD
 
+#include "handler.h"
+
 #define RES_FLAG_CHANGING_CONFIG    0x80000000  ///< Administrative config update in progress.
-#define RES_FLAG_RELEVANT           0x40000000  ///< Resource is relevant to current operation.
+#define RES_FLAG_HIGH_PRIORITY      0x40000000  ///< Route pushes to this resource are processed
+                                                ///< ahead of normal-priority ones.
 #define RES_FLAG_NEW                0x20000000  ///< Node has been created since the last snapshot.
-#define RES_FLAG_DELETED            0x10000000  ///< Node has been deleted since deletions were last
-                                                ///< flushed.
+#define RES_FLAG_DELETED            0x10000000  ///< Node has been deleted, and only remains while
+                                                ///< snapshots still refer to it.
 #define RES_FLAG_CLEAR_NEW          0x08000000  ///< Node with new flag set has been used in current
                                                 ///< snapshot, clear its new flag at the end of it.
 #define RES_FLAG_JSON_EX_CHANGED    0x04000000  ///< Node JSON example value has been changed since
                                                 ///< the last snapshot (only for JSON resources).
 
 #define RES_FLAG_FROM_CONFIG_FILE   0x02000000  ///< This resource was created by a config file.
+#define RES_FLAG_PRIVATE_VALUE      0x01000000  ///< Current value is a sample not shared outside
+                                                ///< this resource (see res_PushNumericIfDropped).
+
+/// Number of runtime statistics counters kept for each resource (see admin_StatCounter_t).
+#define RES_NUM_STAT_COUNTERS       (ADMIN_STAT_DROPPED_OVERFLOW + 1)
 
 // Forward declaration needed by res_Resource_t.entryRef.  See resTree.h
 typedef struct resTree_Entry* resTree_EntryRef_t;
@@ -51,8 +59,10 @@ typedef struct res_Resource
     dataSample_Ref_t defaultValue; ///< Ref to default value; NULL if no default set.
     io_DataType_t defaultType;///< Data type of the default value, if defaultRef != NULL.
     uint32_t flags;  ///< Resource status flags.
-    le_dls_List_t pushHandlerList;  ///< List of Push Handler callbacks registered on this resource.
+    handler_List_t pushHandlerList; ///< Push Handler callbacks registered on this resource.
     dataSample_Ref_t jsonExample; ///< Ref to JSON example value; NULL if not set.
+    void* metadataCache; ///< Metadata encoded by a snapshot formatter; NULL if none cached.
+    uint32_t stats[RES_NUM_STAT_COUNTERS]; ///< Runtime statistics counters.
 }
 res_Resource_t;
 
@@ -101,6 +111,54 @@ static inline resTree_EntryRef_t res_GetResTreeEntry
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add to one of the runtime statistics counters of a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void res_AddToStat
+(
+    res_Resource_t* resPtr,
+    admin_StatCounter_t counter,
+    uint32_t count
+)
+//--------------------------------------------------------------------------------------------------
+{
+    resPtr->stats[counter] += count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the value of one of the runtime statistics counters of a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint32_t res_GetStat
+(
+    res_Resource_t* resPtr,
+    admin_StatCounter_t counter
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return resPtr->stats[counter];
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set all the runtime statistics counters of a resource back to zero.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void res_ResetStats
+(
+    res_Resource_t* resPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    memset(resPtr->stats, 0, sizeof(resPtr->stats));
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Create an Input resource object.
@@ -354,6 +412,63 @@ le_result_t res_Push
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a JSON data sample to a resource, using values already extracted from it for some of its
+ * destinations instead of extracting them again.
+ *
+ * @note Takes ownership of the data sample reference.
+ *
+ * @return Same as res_Push().
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t res_PushExtracted
+(
+    res_Resource_t* resPtr,         ///< The resource to push to.
+    io_DataType_t dataType,         ///< The data type.
+    const char* units,              ///< The units (NULL or "" = unspecified)
+    dataSample_Ref_t dataSample,    ///< The data sample (timestamp + value).
+    res_Resource_t* destPtrs[],     ///< The destinations served, in destination list order.
+    const json_Span_t spans[],      ///< The span found in the JSON value for each destination.
+    size_t count                    ///< The number of destinations served.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get those of a resource's destinations that are Observations with JSON extraction specifiers.
+ *
+ * @return The number of destinations found (at most JSON_MAX_MULTI_EXTRACTIONS).  They are
+ *         listed in the same order as in the resource's destination list.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t res_GetExtractingDestinations
+(
+    res_Resource_t* resPtr,         ///< The source resource.
+    res_Resource_t* destPtrs[]      ///< [OUT] The destinations (JSON_MAX_MULTI_EXTRACTIONS).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a numeric value to a resource without creating a data sample, if none of the resource's
+ * destinations would accept it and nothing else would see it.
+ *
+ * @return
+ *      - LE_UNAVAILABLE If the value must be pushed normally, using res_Push().
+ *      - LE_OK If the value was pushed (and there were no destinations to drop it).
+ *      - LE_FAULT If the value was pushed, but dropped by all the destinations.
+ *      - LE_NO_MEMORY If failed to store the value.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t res_PushNumericIfDropped
+(
+    res_Resource_t* resPtr,         ///< The resource to push to.
+    double timestamp,               ///< The timestamp (IO_NOW = now).
+    double value                    ///< The numeric value.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add a Push Handler to an Output resource.
@@ -541,6 +656,24 @@ admin_TransformType_t res_GetTransform
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a given transform, with given parameters, is the one currently applied to an
+ * Observation.  Setting a transform clears the Observation's buffer even if it is the same one,
+ * so this can be used to avoid re-applying it needlessly.
+ *
+ * @return true if setting this transform would not change the Observation's transform settings.
+ */
+//--------------------------------------------------------------------------------------------------
+bool res_IsTransformSet
+(
+    res_Resource_t* resPtr,
+    admin_TransformType_t transformType,
+    const double* paramsPtr,
+    size_t paramsSize
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the maximum number of data samples to buffer in a given Observation.  Buffers are FIFO
@@ -597,6 +730,60 @@ uint32_t res_GetBufferBackupPeriod
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the number of samples evicted from an Observation's buffer to keep in its spilled history
+ * on non-volatile storage.  See admin_SetBufferSpillMaxCount() for more information.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_SetBufferSpillMaxCount
+(
+    res_Resource_t* resPtr,
+    uint32_t count
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of samples evicted from an Observation's buffer to keep in its spilled history.
+ * See admin_SetBufferSpillMaxCount() for more information.
+ *
+ * @return The spill count (in number of samples) or 0 if the spilled history is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t res_GetBufferSpillMaxCount
+(
+    res_Resource_t* resPtr
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the precision with which an Observation's buffered numbers are stored.
+ * See admin_SetBufferPrecision() for more information.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_SetBufferPrecision
+(
+    res_Resource_t* resPtr,
+    admin_BufferPrecision_t precision
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the precision with which an Observation's buffered numbers are stored.
+ * See admin_SetBufferPrecision() for more information.
+ *
+ * @return The buffer precision.
+ */
+//--------------------------------------------------------------------------------------------------
+admin_BufferPrecision_t res_GetBufferPrecision
+(
+    res_Resource_t* resPtr
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Mark an Output resource "optional".  (By default, they are marked "mandatory".)
@@ -781,29 +968,6 @@ void res_RemoveOverride
     res_Resource_t* resPtr
 );
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Set the resource's relevance flag.
- */
-//--------------------------------------------------------------------------------------------------
-void res_SetRelevance
-(
-    res_Resource_t  *resPtr,    ///< Resource to query.
-    bool             relevant   ///< Relevance of resource to current operation.
-);
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Get the resource's relevance flag.
- *
- * @return Relevance of resource to the current operation.
- */
-//--------------------------------------------------------------------------------------------------
-bool res_IsRelevant
-(
-    res_Resource_t *resPtr ///< Resource to query.
-);
-
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the resource's clear newness flag
@@ -900,6 +1064,72 @@ void res_ReadBufferJson
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer in JSON format (like res_ReadBufferJson()), decimated to at most a
+ * given number of samples using the Largest-Triangle-Three-Buckets algorithm, which keeps the
+ * visual shape of the data.  The first and the last samples are always included.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride instead.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_ReadBufferJsonDecimated
+(
+    res_Resource_t* resPtr, ///< Ptr to the resource object for the Observation.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to read the whole buffer.
+    uint32_t maxCount,  ///< Max number of samples to read (at least 3); 0 = no limit.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the samples in a buffer between two times, in JSON format (like res_ReadBufferJson()),
+ * decimated to at most a given number of samples using a given decimation mode.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_ReadBufferJsonRange
+(
+    res_Resource_t* resPtr, ///< Ptr to the resource object for the Observation.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to start at the oldest sample.
+    double endAt,   ///< End at this many seconds ago, or at an absolute number of seconds since
+                    ///< the Epoch (if endAt > 30 years).  Use NAN to read up to the newest sample.
+    uint32_t maxCount,  ///< Max number of samples to read; 0 = no limit.
+    query_DecimationMode_t decimation, ///< How to select the samples, if decimating.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer.  Data is written to a given file descriptor in CBOR format as an
+ * indefinite-length array of [timestamp, value] arrays.  Timestamps and numeric values are
+ * doubles, Boolean values are true or false, trigger values are null, and string and JSON values
+ * are text strings.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_ReadBufferCbor
+(
+    res_Resource_t* resPtr, ///< Ptr to the resource object for the Observation.
+    double startAfter,  ///< Start after this many seconds ago, or after an absolute number of
+                        ///< seconds since the Epoch (if startafter > 30 years).
+                        ///< Use NAN (not a number) to read the whole buffer.
+    int outputFile, ///< File descriptor to write the data to.
+    query_ReadCompletionFunc_t handlerPtr, ///< Completion callback.
+    void* contextPtr    ///< Value to be passed to completion callback.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Find the oldest data sample held in a given Observation's buffer that is newer than a
@@ -966,6 +1196,58 @@ dataSample_Ref_t res_GetJsonExample
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the metadata encoding cached on a given resource by a snapshot formatter.
+ *
+ * @return The cached encoding, or NULL if none is cached.
+ */
+//--------------------------------------------------------------------------------------------------
+void* res_GetMetadataCache
+(
+    res_Resource_t* resPtr
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cache a snapshot formatter's encoding of a given resource's metadata.  The cache is dropped when
+ * the units or the default value of the resource change.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_SetMetadataCache
+(
+    res_Resource_t* resPtr,
+    void* cachePtr  ///< Memory pool object, or NULL.  Ownership of this reference is passed to the
+                    ///< resource.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set whether route pushes to a given resource are processed ahead of those to other resources.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_SetHighPriority
+(
+    res_Resource_t* resPtr,
+    bool isHighPriority
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether route pushes to a given resource are processed ahead of those to other resources.
+ *
+ * @return true if the resource is high-priority.
+ */
+//--------------------------------------------------------------------------------------------------
+bool res_IsHighPriority
+(
+    res_Resource_t* resPtr
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the JSON member/element specifier for extraction of data from within a structured JSON
@@ -1061,6 +1343,28 @@ double res_QueryStdDev
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the minimum, maximum, mean and standard deviation of all values found within a given time
+ * span in an Observation's buffer, all at once.
+ *
+ * If there's no numerical data in the Observation's buffer (if the buffer size is zero, the
+ * buffer is empty, or the buffer contains data of a non-numerical type), the count is zero and
+ * the statistics are NAN (not-a-number).
+ */
+//--------------------------------------------------------------------------------------------------
+void res_QueryStats
+(
+    res_Resource_t* resPtr,    ///< Ptr to Observation resource.
+    double startTime,   ///< If < 30 years then seconds before now; else seconds since the Epoch.
+    double* minPtr,     ///< [OUT] Minimum value.
+    double* maxPtr,     ///< [OUT] Maximum value.
+    double* meanPtr,    ///< [OUT] Mean value.
+    double* stdDevPtr,  ///< [OUT] Standard deviation.
+    uint32_t* countPtr  ///< [OUT] Number of values the statistics were computed from.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Mark an observation as config.
@@ -7,6 +7,10 @@
 //--------------------------------------------------------------------------------------------------
 #include "snapshot.h"
 
+#if !LE_CONFIG_RTOS
+#include <sys/mman.h>
+#endif
+
 #include "interfaces.h"
 
 #include "dataHub.h"
@@ -18,12 +22,41 @@
 /// Upper limit on the number of passes through the tree that can be requested by a formatter.
 #define MAX_PASSES      10
 
-/// FIFO path for formatted data streaming.
+/// FIFO path for formatted data streaming (followed by the session's index).
 #define SNAPSHOT_FIFO   "/tmp/datahub_snapshot_fifo"
 
 /// Default depth of resource tree entries.  This can be overridden in the .cdef.
 #define DEFAULT_NODE_PARENT_POOL_SIZE 10
 
+/// Initial size of the shared memory file of a snapshot taken to memory.  The file doubles in size
+/// whenever it fills up.  This can be overridden in the .cdef.
+#ifndef DHUB_SNAPSHOT_MEMORY_INITIAL_BYTES
+#define DHUB_SNAPSHOT_MEMORY_INITIAL_BYTES  (64 * 1024)
+#endif
+
+/// Longest time (in ms) a snapshot session may spend stepping through the tree before letting other
+/// events be handled.  This can be overridden in the .cdef.
+#ifndef DHUB_SNAPSHOT_STEP_BUDGET_MS
+#define DHUB_SNAPSHOT_STEP_BUDGET_MS        5
+#endif
+
+/// Largest shared memory file a snapshot taken to memory may grow to.  A snapshot that would be
+/// larger fails with LE_OVERFLOW.  This can be overridden in the .cdef.
+#ifndef DHUB_SNAPSHOT_MEMORY_MAX_BYTES
+#define DHUB_SNAPSHOT_MEMORY_MAX_BYTES      (16 * 1024 * 1024)
+#endif
+
+/// Number of deletions the deletion log can hold while deletions are tracked.  When it is full, the
+/// oldest deletion is dropped to make room, and snapshots that would have reported it include the
+/// whole tree instead.  This can be overridden in the .cdef.
+#ifndef DHUB_DELETION_LOG_SIZE
+#define DHUB_DELETION_LOG_SIZE              64
+#endif
+
+/// Default number of deletion records.  Records dropped from the log stay allocated until the
+/// snapshots reporting them are done.  This can be overridden in the .cdef.
+#define DEFAULT_DELETION_RECORD_POOL_SIZE   DHUB_DELETION_LOG_SIZE
+
 /// States of the snapshot state machine.
 typedef enum
 {
@@ -31,15 +64,41 @@ typedef enum
     STATE_NODE_CHILDREN,    ///< Begin processing children of a tree node.
     STATE_NODE_END,         ///< Finish processing the current tree node.
     STATE_NODE_SIBLING,     ///< Begin processing the next sibling of a tree node.
+    STATE_DELETIONS_BEGIN,  ///< Begin processing the root of a pass through the deletion log.
+    STATE_DELETION_NEXT,    ///< Move towards the next deleted node of the deletion log.
+    STATE_DELETIONS_END,    ///< Done processing all deleted nodes.
     STATE_TREE_END,         ///< Done processing all tree nodes.
     STATE_MAX               ///< One larger than highest state value.
 } SnapshotState_t;
 
-/// Active snapshot state structure.
+/// Record of a deleted node in the deletion log.
 typedef struct
 {
-    int sink;   ///< FIFO handle to write formatted snapshot to.
-    int source; ///< FIFO handle to read formatted snapshot from (passed to remote side).
+    le_dls_Link_t   link;       ///< Link in the deletion log.
+    uint64_t        seq;        ///< Sequence number of the deletion.
+    double          timestamp;  ///< When the node was deleted (in s).
+    char            path[HUB_MAX_RESOURCE_PATH_BYTES];  ///< Absolute path of the deleted node.
+} DeletionRecord_t;
+
+/// Snapshot session state structure.
+typedef struct snapshot_Session
+{
+    bool            inUse;      ///< Is the session taken (until its result has been delivered)?
+    bool            isRunning;  ///< Is the session's snapshot in progress?
+    bool            isStepping; ///< Is the session's state machine currently being run?
+    bool            needsStep;  ///< Was another step requested while the state machine ran?
+    unsigned int    slot;       ///< Resource tree relevance slot of the session.
+    le_result_t     status;     ///< Result to deliver to the result callback.
+
+    int sink;   ///< FIFO (or shared memory file) handle to write formatted snapshot to.
+    int source; ///< FIFO (or shared memory file) handle to read formatted snapshot from (passed to
+                ///< remote side).
+
+    bool        isMemory;   ///< Is the snapshot written to shared memory rather than a FIFO?
+    bool        overflowed; ///< Did the snapshot outgrow DHUB_SNAPSHOT_MEMORY_MAX_BYTES?
+    uint8_t    *memory;     ///< Mapping of the shared memory file (NULL until first written).
+    size_t      capacity;   ///< Current size of the shared memory file and its mapping.
+    size_t      length;     ///< Number of bytes of formatted snapshot written to shared memory.
 
     uint32_t                 flags;     ///< Snapshot flags.
     double                   since;     ///< Only include updates newer than this time stamp.
@@ -49,11 +108,34 @@ typedef struct
 
     query_HandleSnapshotResultFunc_t     callback;  ///< Callback to invoke to indicate end of
                                                     ///< snapshot, or error.
+    query_HandleSnapshotMemoryResultFunc_t   memoryCallback;    ///< Callback to invoke instead
+                                                                ///< when written to memory.
     void                                *context;   ///< User context for result callback.
 
     SnapshotState_t          nextState; ///< Next snapshot processing state to transition to.
-    resTree_EntryRef_t       nodeRef;   ///< Active resource tree node.
-    resTree_EntryRef_t       rootRef;   ///< Root of the relevant portion of the tree.
+    resTree_EntryRef_t       nodeRef;   ///< Active resource tree node (referenced by the session).
+    resTree_EntryRef_t       rootRef;   ///< Root of the relevant portion of the tree (referenced by
+                                        ///< the session).
+    le_sls_List_t            parents;   ///< Stack of parents of the active node (each referenced by
+                                        ///< the session).
+
+    bool                 isLogPass;     ///< Is the pass walking the deletion log, not the tree?
+    bool                 isDeletedNode; ///< Is the active node of the pass a deleted node, rather
+                                        ///< than one on the way to a deleted node?
+    bool                 isLeavingNode; ///< Has the active node of the pass been ended?
+    bool                 lostDeletions; ///< Were deletions to report dropped from the log?
+    double               lostTime;      ///< Newest dropped deletion when the snapshot started.
+    uint64_t             deletionSeq;   ///< Sequence number of the next deletion to be logged when
+                                        ///< the snapshot started.
+    size_t               deletionCount; ///< Number of deletions reported by the pass.
+    size_t               deletionIndex; ///< Index of the next deletion to move towards.
+    DeletionRecord_t    *deletions[DHUB_DELETION_LOG_SIZE]; ///< Deletions reported by the pass,
+                                                            ///< sorted by path (each referenced by
+                                                            ///< the session).
+    char                 rootPath[HUB_MAX_RESOURCE_PATH_BYTES]; ///< Absolute path of the root.
+    char                 deletedPath[HUB_MAX_RESOURCE_PATH_BYTES];  ///< Path of the active node of
+                                                                    ///< the pass, relative to the
+                                                                    ///< root ("" at the root).
 } Snapshot_t;
 
 /// Node parent stack entry.
@@ -66,578 +148,1591 @@ typedef struct
 /// Keep track of deleted resources?
 static bool AreDeletionsTracked;
 
-/// Is a snapshot request currently in progress?
-static bool IsRunning;
+/// Deletion log, oldest deletion first.  Deleted nodes are freed right away, so the log is all that
+/// is left of them for snapshots to report.
+static le_dls_List_t DeletionLog = LE_DLS_LIST_INIT;
+
+/// Number of deletions in the deletion log.
+static size_t DeletionCount;
+
+/// Sequence number of the next deletion to be logged.
+static uint64_t NextDeletionSeq;
+
+/// Time stamp of the newest deletion that was dropped from the full deletion log (or
+/// QUERY_BEGINNING_OF_TIME if none was).  A snapshot of changes since before then would have had to
+/// report it, so it includes the whole tree instead.
+static double LostDeletionTime;
+
+/// Pool of deletion records.
+static le_mem_PoolRef_t DeletionRecordPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(DeletionRecordPool, DEFAULT_DELETION_RECORD_POOL_SIZE,
+    sizeof(DeletionRecord_t));
 
-/// Active snapshot state.
-static Snapshot_t Snapshot;
+/// Snapshot sessions.  Each one walks the tree with its own cursor, parent stack, formatter and
+/// stream, so a slow consumer doesn't hold up the others.
+static Snapshot_t Sessions[DHUB_SNAPSHOT_MAX_SESSIONS];
+
+/// Time a session may spend stepping through the tree in one turn of the event loop.
+static const le_clk_Time_t StepBudget =
+{
+    .sec = DHUB_SNAPSHOT_STEP_BUDGET_MS / 1000,
+    .usec = (DHUB_SNAPSHOT_STEP_BUDGET_MS % 1000) * 1000
+};
+
+/// Number of reasons for which resource tree updates are currently paused.
+static unsigned int UpdatePauseCount;
 
 /// Pool of node parent references.
 static le_mem_PoolRef_t NodeParentPool = NULL;
 LE_MEM_DEFINE_STATIC_POOL(NodeParentPool, DEFAULT_NODE_PARENT_POOL_SIZE, sizeof(Parent_t));
 
-/// Stack of node parent references.
-static le_sls_List_t Parents = LE_SLS_LIST_DECL_INIT;
+// Forward reference.
+static void EndSession(Snapshot_t *session, le_result_t status);
 
 //--------------------------------------------------------------------------------------------------
 /*
- *  Obtain the flags for the current snapshot operation.
+ * Get the snapshot session that a formatter is producing.
  *
- *  @return Flags for the current snapshot.
+ *  @return Session pointer.
  */
 //--------------------------------------------------------------------------------------------------
-uint32_t snapshot_GetFlags
+static inline Snapshot_t *GetSession
 (
-    void
+    snapshot_Formatter_t *formatter ///< Formatter instance.
 )
 {
-    LE_ASSERT(IsRunning);
-    return Snapshot.flags;
+    LE_ASSERT(formatter != NULL);
+    LE_ASSERT(formatter->session != NULL);
+    LE_ASSERT(formatter->session->isRunning);
+    return formatter->session;
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- *  Obtain the file stream to write formatted output to for the current snapshot operation.
- *
- *  @return File descriptor for the formatted output stream.
+ * Pause resource tree updates, if they are not already paused.
  */
 //--------------------------------------------------------------------------------------------------
-int snapshot_GetStream
+static void PauseUpdates
 (
     void
 )
 {
-    LE_ASSERT(IsRunning);
-    return Snapshot.sink;
+    if (UpdatePauseCount++ == 0)
+    {
+        resTree_StartUpdate();
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- *  Obtain the resource tree node currently under consideration.
- *
- *  @return Node reference.
+ * Resume resource tree updates, unless they are still paused for another reason.
  */
 //--------------------------------------------------------------------------------------------------
-resTree_EntryRef_t snapshot_GetNode
+static void ResumeUpdates
 (
     void
 )
 {
-    LE_ASSERT(IsRunning);
-    LE_ASSERT(Snapshot.nodeRef != NULL);
-    return Snapshot.nodeRef;
+    LE_ASSERT(UpdatePauseCount > 0);
+    if (--UpdatePauseCount == 0)
+    {
+        resTree_EndUpdate();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Move a session's active node, keeping a reference to it so that it can't be destroyed under the
+ * session if the tree changes between steps.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetNode
+(
+    Snapshot_t          *session,   ///< Snapshot session.
+    resTree_EntryRef_t   nodeRef    ///< New active node (may be NULL).
+)
+{
+    resTree_EntryRef_t oldRef = session->nodeRef;
+
+    if (nodeRef != NULL)
+    {
+        le_mem_AddRef(nodeRef);
+    }
+    session->nodeRef = nodeRef;
+    if (oldRef != NULL)
+    {
+        le_mem_Release(oldRef);
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- *  Obtain the resource tree node used as root for snapshot.
- *
- *  @return Node reference.
+ * Determine if the active node of a session is a node of a pass through the deletion log, which is
+ * only known by its path.
  */
 //--------------------------------------------------------------------------------------------------
-resTree_EntryRef_t snapshot_GetRoot
+static inline bool IsLogNode
 (
-    void
+    Snapshot_t *session ///< Snapshot session.
 )
 {
-    LE_ASSERT(IsRunning);
-    LE_ASSERT(Snapshot.rootRef != NULL);
-    return Snapshot.rootRef;
+    return (session->isLogPass && (session->deletedPath[0] != '\0'));
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- *  Obtain the time stamp of the start of the snapshot operation.
+ * Determine if a path is beneath another one.  Every path is beneath the empty path.
  *
- *  @return File descriptor for the formatted output stream.
+ * @return true if the path is beneath the base path.
  */
 //--------------------------------------------------------------------------------------------------
-double snapshot_GetTimestamp
+static bool IsPathBeneath
 (
-    void
+    const char  *basePath,  ///< Base path.
+    const char  *path       ///< Path to check.
 )
 {
-    LE_ASSERT(IsRunning);
-    return Snapshot.timestamp;
+    size_t length = strlen(basePath);
+
+    return ((length == 0) || ((strncmp(path, basePath, length) == 0) && (path[length] == '/')));
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Determine if the given node is within the time window of interest for the current snapshot
- * operation.
+ * Get the path of a deleted node reported by a session's pass through the deletion log, relative
+ * to the root of the snapshot.
+ *
+ * @return Relative path.
  */
 //--------------------------------------------------------------------------------------------------
-bool snapshot_IsTimely
+static inline const char *GetDeletedPath
 (
-    resTree_EntryRef_t nodeRef ///< Node reference.
+    Snapshot_t  *session,   ///< Snapshot session.
+    size_t       index      ///< Index of the deletion among those reported by the pass.
 )
 {
-    LE_ASSERT(IsRunning);
-    return (resTree_GetLastModified(nodeRef) > Snapshot.since);
+    return &session->deletions[index]->path[strlen(session->rootPath) + 1];
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- *  Push a parent node reference onto the stack as we descend to a child.
+ * Compare the paths of two deletion records for sorting.  Separators sort before any other
+ * character, so that the deletions beneath a node come straight after it.
  *
- *  @return
- *      - LE_OK IF parent was pushed successfully.
- *      - LE_NO_MEMORY If failed to allocate memory for parent.
+ * @return Negative, zero or positive if the first path sorts before, with or after the second one.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t PushParent
+static int CompareDeletions
 (
-    resTree_EntryRef_t parentRef    ///< New parent to push onto the stack.
+    const void *aPtr,   ///< First deletion record reference.
+    const void *bPtr    ///< Second deletion record reference.
 )
 {
-    Parent_t *entry = hub_MemAlloc(NodeParentPool);
-    if (entry != NULL)
-    {
-        entry->link = LE_SLS_LINK_INIT;
-        entry->nodeRef = parentRef;
+    const unsigned char *a = (const unsigned char *) (*(DeletionRecord_t * const *) aPtr)->path;
+    const unsigned char *b = (const unsigned char *) (*(DeletionRecord_t * const *) bPtr)->path;
 
-        le_sls_Stack(&Parents, &entry->link);
-        return LE_OK;
-    }
-    else
+    while ((*a != '\0') && (*a == *b))
     {
-        return LE_NO_MEMORY;
+        ++a;
+        ++b;
     }
+    return ((*a == '/' ? 1 : *a) - (*b == '/' ? 1 : *b));
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- *  Pop a parent node reference off the stack as we back out of a child node.
- *
- *  @return The parent node reference, or NULL if no entries were present on the stack.
+ * Release the deletion records referenced by a session's pass through the deletion log.
  */
 //--------------------------------------------------------------------------------------------------
-static resTree_EntryRef_t PopParent
+static void ReleaseDeletions
 (
-    void
+    Snapshot_t *session ///< Snapshot session.
 )
 {
-    le_sls_Link_t       *link = le_sls_Pop(&Parents);
-    Parent_t            *entry;
-    resTree_EntryRef_t   parentRef = NULL;
-
-    if (link != NULL)
+    while (session->deletionCount > 0)
     {
-        entry = CONTAINER_OF(link, Parent_t, link);
-        parentRef = entry->nodeRef;
-        le_mem_Release(entry);
+        le_mem_Release(session->deletions[--session->deletionCount]);
     }
-    return parentRef;
+    session->deletionIndex = 0;
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Begin processing a resource tree node.  This will cumulatively perform a depth-first traversal of
- * the tree from the current node and invoke the formatter as it goes.
+ * Gather the deletions to be reported by a session's pass through the deletion log: those beneath
+ * the root of the snapshot that were logged since its time stamp, and before it started.  They are
+ * sorted by path, and only the topmost of a branch's deletions is kept, as it stands for the whole
+ * branch.
  */
 //--------------------------------------------------------------------------------------------------
-static void NodeBegin
+static void CollectDeletions
 (
-    void *unused1,  ///< [IN] Unused parameter.
-    void *unused2   ///< [IN] Unused parameter.
+    Snapshot_t *session ///< Snapshot session.
 )
 {
-    resTree_EntryRef_t childRef = NULL;
+    le_dls_Link_t       *linkPtr;
+    DeletionRecord_t    *recordPtr;
+    resTree_EntryRef_t   entryRef;
+    size_t               count = 0;
+    size_t               i;
 
-    LE_UNUSED(unused1);
-    LE_UNUSED(unused2);
+    ReleaseDeletions(session);
 
-    LE_DEBUG("Handling node beginning");
+    // Buffer is sized such that it should never overflow, and the root must exist.
+    LE_ASSERT(resTree_GetPath(session->rootPath, sizeof(session->rootPath), resTree_GetRoot(),
+                              session->rootRef) >= 0);
 
-    if (resTree_IsRelevant(Snapshot.nodeRef))
+    for (linkPtr = le_dls_Peek(&DeletionLog);
+         linkPtr != NULL;
+         linkPtr = le_dls_PeekNext(&DeletionLog, linkPtr))
     {
-        if (!resTree_IsDeleted(Snapshot.nodeRef))
+        recordPtr = CONTAINER_OF(linkPtr, DeletionRecord_t, link);
+        if (   (recordPtr->seq >= session->deletionSeq)
+            || (recordPtr->timestamp <= session->since)
+            || !IsPathBeneath(session->rootPath, recordPtr->path))
+        {
+            continue;
+        }
+
+        // A resource that has been created again since is not reported as deleted.
+        entryRef = resTree_FindEntryAtAbsolutePath(recordPtr->path);
+        if ((entryRef != NULL) && (resTree_GetEntryType(entryRef) != ADMIN_ENTRY_TYPE_NAMESPACE))
         {
-            childRef = resTree_GetFirstChildEx(
-                            Snapshot.nodeRef,
-                            Snapshot.formatter->filter & SNAPSHOT_FILTER_DELETED);
+            continue;
         }
-        Snapshot.nextState = (childRef == NULL ? STATE_NODE_END : STATE_NODE_CHILDREN);
-        Snapshot.formatter->beginNode(Snapshot.formatter);
+
+        LE_ASSERT(count < DHUB_DELETION_LOG_SIZE);
+        le_mem_AddRef(recordPtr);
+        session->deletions[count++] = recordPtr;
     }
-    else
+
+    qsort(session->deletions, count, sizeof(session->deletions[0]), &CompareDeletions);
+
+    for (i = 0; i < count; ++i)
     {
-        Snapshot.nextState = STATE_NODE_END;
-        snapshot_Step();
+        recordPtr = session->deletions[i];
+        if (   (session->deletionCount > 0)
+            && (   (strcmp(session->deletions[session->deletionCount - 1]->path,
+                           recordPtr->path) == 0)
+                || IsPathBeneath(session->deletions[session->deletionCount - 1]->path,
+                                 recordPtr->path)))
+        {
+            le_mem_Release(recordPtr);
+        }
+        else
+        {
+            session->deletions[session->deletionCount++] = recordPtr;
+        }
     }
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Begin processing the children of a tree node.
+ * Drop the oldest deletion from the deletion log.
  */
 //--------------------------------------------------------------------------------------------------
-static void NodeChildren
+static void DropOldestDeletion
 (
-    void *unused1,  ///< [IN] Unused parameter.
-    void *unused2   ///< [IN] Unused parameter.
+    bool isLost ///< Is the deletion dropped before being reported?
 )
 {
-    LE_UNUSED(unused1);
-    LE_UNUSED(unused2);
+    le_dls_Link_t       *linkPtr = le_dls_Pop(&DeletionLog);
+    DeletionRecord_t    *recordPtr;
 
-    LE_DEBUG("Handling node children");
+    LE_ASSERT(linkPtr != NULL);
+    recordPtr = CONTAINER_OF(linkPtr, DeletionRecord_t, link);
+    --DeletionCount;
 
-    le_result_t res = PushParent(Snapshot.nodeRef);
-    if (res != LE_OK)
+    if (isLost && (recordPtr->timestamp > LostDeletionTime))
     {
-        snapshot_End(res);
+        LostDeletionTime = recordPtr->timestamp;
     }
-    Snapshot.nodeRef = resTree_GetFirstChildEx(
-                            Snapshot.nodeRef,
-                            Snapshot.formatter->filter & SNAPSHOT_FILTER_DELETED);
-
-    // We should only get here if we already checked for children.
-    LE_ASSERT(Snapshot.nodeRef != NULL);
 
-    // No additional formatting here, so directly transition the state machine.
-    Snapshot.nextState = STATE_NODE_BEGIN;
-    snapshot_Step();
+    // Snapshots reporting the deletion keep the record until they are done.
+    le_mem_Release(recordPtr);
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * End processing a tree node.
+ * Remove the deletions logged before the given one from the deletion log.
  */
 //--------------------------------------------------------------------------------------------------
-static void NodeEnd
+static void FlushDeletionRecords
 (
-    void *unused1,  ///< [IN] Unused parameter.
-    void *unused2   ///< [IN] Unused parameter.
+    uint64_t seq    ///< Sequence number of the oldest deletion to keep.
 )
 {
-    LE_UNUSED(unused1);
-    LE_UNUSED(unused2);
-
-    LE_DEBUG("Handling node end");
+    le_dls_Link_t *linkPtr;
 
-    Snapshot.nextState = STATE_NODE_SIBLING;
-    if (resTree_IsRelevant(Snapshot.nodeRef))
-    {
-        Snapshot.formatter->endNode(Snapshot.formatter);
-        resTree_SetClearNewnessFlag(Snapshot.nodeRef);
-    }
-    else
+    while (   ((linkPtr = le_dls_Peek(&DeletionLog)) != NULL)
+           && (CONTAINER_OF(linkPtr, DeletionRecord_t, link)->seq < seq))
     {
-        snapshot_Step();
+        DropOldestDeletion(false);
     }
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Move to the next sibling of the current tree node.
+ * Add the deletion of a node to the deletion log, dropping the oldest deletion if it is full.
  */
 //--------------------------------------------------------------------------------------------------
-static void NodeSibling
+static void LogDeletion
 (
-    void *unused1,  ///< [IN] Unused parameter.
-    void *unused2   ///< [IN] Unused parameter.
+    resTree_EntryRef_t nodeRef  ///< Deleted node.
 )
 {
-    resTree_EntryRef_t nodeRef = Snapshot.nodeRef;
-
-    LE_UNUSED(unused1);
-    LE_UNUSED(unused2);
+    le_clk_Time_t        currentTime = le_clk_GetAbsoluteTime();
+    double               timestamp = (((double) currentTime.usec) / 1000000) + currentTime.sec;
+    DeletionRecord_t    *recordPtr;
 
-    LE_DEBUG("Handling node sibling");
-
-    Snapshot.nodeRef = resTree_GetNextSiblingEx(
-                            nodeRef,
-                            Snapshot.formatter->filter & SNAPSHOT_FILTER_DELETED);
-    if ((Snapshot.flags & QUERY_SNAPSHOT_FLAG_FLUSH_DELETIONS) && resTree_IsDeleted(nodeRef))
+    if (DeletionCount >= DHUB_DELETION_LOG_SIZE)
     {
-        // If we are flushing as we go, remove the deleted node.
-        le_mem_Release(nodeRef);
+        LE_DEBUG("Deletion log full, dropping oldest deletion");
+        DropOldestDeletion(true);
     }
 
-    if (Snapshot.nodeRef == NULL)
-    {
-        // No more siblings, try looking for a parent.
-        Snapshot.nodeRef = PopParent();
-        if (Snapshot.nodeRef == NULL)
-        {
-            // No more parents, we are done.
-            Snapshot.nextState = STATE_TREE_END;
-            Snapshot.formatter->endTree(Snapshot.formatter);
-            return;
-        }
-        else
-        {
-            // We have a parent, so back out to its level.
-            Snapshot.nextState = STATE_NODE_END;
-        }
-    }
-    else
+    recordPtr = hub_MemAlloc(DeletionRecordPool);
+    if (recordPtr == NULL)
     {
-        // There is another sibling, move to it.
-        Snapshot.nextState = STATE_NODE_BEGIN;
+        LE_WARN("No room to log deletion of '%s'", resTree_GetEntryName(nodeRef));
+        LostDeletionTime = timestamp;
+        return;
     }
 
-    // No formatting to do, so directly transition to the next state.
-    snapshot_Step();
+    recordPtr->link = LE_DLS_LINK_INIT;
+    recordPtr->seq = NextDeletionSeq++;
+    recordPtr->timestamp = timestamp;
+
+    // Buffer is sized such that it should never overflow.
+    LE_ASSERT(resTree_GetPath(recordPtr->path, sizeof(recordPtr->path), resTree_GetRoot(),
+                              nodeRef) > 0);
+
+    le_dls_Queue(&DeletionLog, &recordPtr->link);
+    ++DeletionCount;
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Recursively set the relevance flag for the specified node and its children.
+ *  Obtain the flags for a formatter's snapshot operation.
+ *
+ *  @return Flags for the snapshot.
  */
 //--------------------------------------------------------------------------------------------------
-static void UpdateRelevance
+uint32_t snapshot_GetFlags
+(
+    snapshot_Formatter_t *formatter ///< Formatter instance.
+)
+{
+    return GetSession(formatter)->flags;
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ *  Obtain the file stream to write formatted output to for a formatter's snapshot operation.
+ *
+ *  @return File descriptor for the formatted output stream, or -1 if the snapshot is written to
+ *          shared memory (see snapshot_Write()).
+ */
+//--------------------------------------------------------------------------------------------------
+int snapshot_GetStream
+(
+    snapshot_Formatter_t *formatter ///< Formatter instance.
+)
+{
+    Snapshot_t *session = GetSession(formatter);
+
+    return (session->isMemory ? -1 : session->sink);
+}
+
+#if !LE_CONFIG_RTOS
+//--------------------------------------------------------------------------------------------------
+/*
+ * Make sure a snapshot's shared memory file and its mapping can hold the given number of bytes.
+ *
+ * @return
+ *      - LE_OK if there is enough room.
+ *      - LE_OVERFLOW if that would exceed DHUB_SNAPSHOT_MEMORY_MAX_BYTES.
+ *      - LE_NO_MEMORY if the file could not be grown or mapped.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReserveMemory
 (
-    resTree_EntryRef_t nodeRef, ///< Node reference.
-    uint32_t           filter   ///< Filter bitmask for node relevence beyond just timestamp.
+    Snapshot_t  *session,   ///< Snapshot session.
+    size_t       needed     ///< Number of bytes the file must be able to hold.
 )
 {
-    bool                relevant = false;
-    bool                timely = false;
-    resTree_EntryRef_t  childRef = resTree_GetFirstChildEx(nodeRef, true);
+    size_t   capacity;
+    void    *memory;
 
-    if (nodeRef == Snapshot.rootRef)
+    if (needed <= session->capacity)
     {
-        // Always include the root node.
-        relevant = true;
+        return LE_OK;
     }
-    else if ((filter & SNAPSHOT_FILTER_CREATED) && resTree_IsNew(nodeRef))
+    if (needed > DHUB_SNAPSHOT_MEMORY_MAX_BYTES)
     {
-        relevant = true;
+        return LE_OVERFLOW;
     }
-    else if ((filter & SNAPSHOT_FILTER_DELETED) && resTree_IsDeleted(nodeRef))
+
+    capacity = (session->capacity == 0 ? DHUB_SNAPSHOT_MEMORY_INITIAL_BYTES : session->capacity);
+    while (capacity < needed)
     {
-        relevant = true;
+        capacity *= 2;
     }
-    else if ((filter & (SNAPSHOT_FILTER_NORMAL)) &&
-             !resTree_IsNew(nodeRef) && !resTree_IsDeleted(nodeRef))
+    if (capacity > DHUB_SNAPSHOT_MEMORY_MAX_BYTES)
     {
-        timely = snapshot_IsTimely(nodeRef);
-        relevant = timely;
+        capacity = DHUB_SNAPSHOT_MEMORY_MAX_BYTES;
     }
 
-    if (relevant)
+    if (ftruncate(session->sink, capacity) != 0)
     {
-        LE_DEBUG("Node '%s' is relevant", resTree_GetEntryName(nodeRef));
+        LE_ERROR("Failed to grow snapshot memory to %zu bytes, errno: %d", capacity, errno);
+        return LE_NO_MEMORY;
     }
-    resTree_SetRelevance(nodeRef, relevant);
-
-    // Regardless of this node's timeliness, it is considered relevant if at least one child node is
-    // relevant, in order to provide a "here to there" path.
-    while (childRef != NULL)
+    if (session->memory == NULL)
     {
-        UpdateRelevance(childRef, filter);
-        relevant = resTree_IsRelevant(childRef) || relevant;
-        childRef = resTree_GetNextSiblingEx(childRef, true);
+        memory = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, session->sink, 0);
     }
-
-    if (!resTree_IsRelevant(nodeRef) && relevant)
+    else
     {
-        LE_DEBUG("Node %s is cumulatively relevant", resTree_GetEntryName(nodeRef));
-        resTree_SetRelevance(nodeRef, relevant);
+        memory = mremap(session->memory, session->capacity, capacity, MREMAP_MAYMOVE);
     }
-
-    if (!resTree_IsRelevant(nodeRef))
+    if (memory == MAP_FAILED)
     {
-        LE_DEBUG("Node '%s' is irrelevant", resTree_GetEntryName(nodeRef));
+        LE_ERROR("Failed to map %zu bytes of snapshot memory, errno: %d", capacity, errno);
+        return LE_NO_MEMORY;
     }
-    // Timeliness implies relevance, but the reverse is not true.  Ensure that this condition is
-    // met.
-    LE_ASSERT(!(timely && !relevant));
+
+    session->memory = memory;
+    session->capacity = capacity;
+    return LE_OK;
 }
+#endif /* end not LE_CONFIG_RTOS */
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Clear the newness flag from tree nodes
+ * Write formatted output for a formatter's snapshot operation.
+ *
+ * Output written to shared memory is copied straight into the mapped file, so a write never has
+ * to wait for the other side and always consumes all of the data unless it fails.
+ *
+ * @return Number of bytes written, or -1 with errno set on failure (EAGAIN if the stream is full).
  */
 //--------------------------------------------------------------------------------------------------
-static void ClearNewness
+ssize_t snapshot_Write
 (
-    resTree_EntryRef_t nodeRef ///< Node reference.
+    snapshot_Formatter_t    *formatter, ///< Formatter instance.
+    const void              *data,      ///< Formatted data to write.
+    size_t                   length     ///< Number of bytes to write.
 )
 {
-    resTree_EntryRef_t  childRef = resTree_GetFirstChildEx(nodeRef, true);
-    if (resTree_IsNewnessClearRequired(nodeRef))
-    {
-        resTree_ClearNewness(nodeRef);
-    }
+    Snapshot_t *session = GetSession(formatter);
 
-    // Proceed with child/siblings
-    while (childRef != NULL)
+#if !LE_CONFIG_RTOS
+    if (session->isMemory)
     {
-        ClearNewness(childRef);
-        childRef = resTree_GetNextSiblingEx(childRef, true);
+        le_result_t result = ReserveMemory(session, session->length + length);
+
+        if (result != LE_OK)
+        {
+            LE_ERROR("Failed to write %zu bytes of snapshot to memory: %s", length,
+                LE_RESULT_TXT(result));
+            session->overflowed = (result == LE_OVERFLOW);
+            errno = ENOSPC;
+            return -1;
+        }
+
+        memcpy(&session->memory[session->length], data, length);
+        session->length += length;
+        return length;
     }
+#endif /* end not LE_CONFIG_RTOS */
+
+    return le_fd_Write(session->sink, data, length);
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Initiate a pass through the resource tree.
+ *  Obtain the resource tree node currently under consideration by a formatter's snapshot.  Must not
+ *  be called for the deleted nodes of a pass through the deletion log, or the nodes on the way to
+ *  them, which are no longer in the tree (see snapshot_GetNodeName()).
+ *
+ *  @return Node reference.
  */
 //--------------------------------------------------------------------------------------------------
-static void StartPass
+resTree_EntryRef_t snapshot_GetNode
 (
-    void
+    snapshot_Formatter_t *formatter ///< Formatter instance.
 )
 {
-    LE_DEBUG("Starting pass %u", Snapshot.passes);
+    Snapshot_t *session = GetSession(formatter);
 
-    Snapshot.nextState = STATE_NODE_BEGIN;
-    Snapshot.nodeRef = Snapshot.rootRef;
-    UpdateRelevance(Snapshot.nodeRef, Snapshot.formatter->filter);
-    Snapshot.formatter->startTree(Snapshot.formatter);
-    ++Snapshot.passes;
+    LE_ASSERT(!IsLogNode(session));
+    LE_ASSERT(session->nodeRef != NULL);
+    return session->nodeRef;
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * End the snapshot state machine.
+ *  Obtain the name of the node currently under consideration by a formatter's snapshot.
+ *
+ *  @return Node name.
  */
 //--------------------------------------------------------------------------------------------------
-static void TreeEnd
+const char *snapshot_GetNodeName
 (
-    void *unused1,  ///< [IN] Unused parameter.
-    void *unused2   ///< [IN] Unused parameter.
+    snapshot_Formatter_t *formatter ///< Formatter instance.
 )
 {
-    LE_UNUSED(unused1);
-    LE_UNUSED(unused2);
-
-    LE_DEBUG("Handling tree end");
-
-    // Should never get here with a parent still on the stack.
-    LE_ASSERT(PopParent() == NULL);
+    Snapshot_t *session = GetSession(formatter);
+    const char *namePtr;
 
-    // A formatter may ask for another pass through the tree, or we may be done.
-    if (Snapshot.formatter->scan && Snapshot.passes < MAX_PASSES)
+    if (IsLogNode(session))
     {
-        StartPass();
-    }
-    else if (Snapshot.passes >= MAX_PASSES)
-    {
-        snapshot_End(LE_OUT_OF_RANGE);
-    }
-    else
-    {
-        snapshot_End(LE_OK);
+        namePtr = strrchr(session->deletedPath, '/');
+        return (namePtr == NULL ? session->deletedPath : namePtr + 1);
     }
+    return resTree_GetEntryName(snapshot_GetNode(formatter));
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Transition the tree-walking snapshot state machine to the next state.
+ *  Obtain the type of the node currently under consideration by a formatter's snapshot.  The nodes
+ *  of a pass through the deletion log are all namespaces, apart from its root.
+ *
+ *  @return Node type.
  */
 //--------------------------------------------------------------------------------------------------
-void snapshot_Step
+admin_EntryType_t snapshot_GetNodeType
 (
-    void
+    snapshot_Formatter_t *formatter ///< Formatter instance.
 )
 {
-    const le_event_DeferredFunc_t steps[STATE_MAX] =
+    if (IsLogNode(GetSession(formatter)))
     {
-        &NodeBegin,     // STATE_NODE_BEGIN
-        &NodeChildren,  // STATE_NODE_CHILDREN
-        &NodeEnd,       // STATE_NODE_END
-        &NodeSibling,   // STATE_NODE_SIBLING
-        &TreeEnd        // STATE_TREE_END
-    };
-#if LE_DEBUG_ENABLED
-    const char *stepNames[STATE_MAX] =
-    {
-        "STATE_NODE_BEGIN",
-        "STATE_NODE_CHILDREN",
-        "STATE_NODE_END",
-        "STATE_NODE_SIBLING",
-        "STATE_TREE_END"
-    };
-#endif /* end LE_DEBUG_ENABLED */
-
-    LE_ASSERT(Snapshot.nextState >= STATE_NODE_BEGIN && Snapshot.nextState < STATE_MAX);
-#if LE_DEBUG_ENABLED
-    LE_DEBUG("Snapshot transition: -> %s", stepNames[Snapshot.nextState]);
-#endif /* end LE_DEBUG_ENABLED */
-    le_event_QueueFunction(steps[Snapshot.nextState], NULL, NULL);
+        return ADMIN_ENTRY_TYPE_NAMESPACE;
+    }
+    return resTree_GetEntryType(snapshot_GetNode(formatter));
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Invoke the result callback to provide final snapshot job status to the user.
+ *  Obtain the path of the node currently under consideration by a formatter's snapshot, relative to
+ *  the snapshot's root, in the same form as resTree_GetPath() does.
+ *
+ *  @return
+ *      - Number of bytes written to the buffer (excluding null terminator) if successful.
+ *      - LE_OVERFLOW if the buffer is too small to hold the path.
  */
 //--------------------------------------------------------------------------------------------------
-static void InvokeResultCallback
+ssize_t snapshot_GetNodePath
 (
-    void    *status,    ///< [IN] User result callback.
-    void    *unused     ///< [IN] Unused parameter.
+    snapshot_Formatter_t    *formatter, ///< Formatter instance.
+    char                    *buffer,    ///< Buffer to write the path to.
+    size_t                   size       ///< Size of the buffer, in bytes.
 )
 {
-    LE_UNUSED(unused);
+    Snapshot_t  *session = GetSession(formatter);
+    size_t       length;
 
-    LE_DEBUG("Invoking result callback");
-    if (Snapshot.callback != NULL)
+    if (!IsLogNode(session))
     {
-        Snapshot.callback((le_result_t) status, Snapshot.context);
+        return resTree_GetPath(buffer, size, session->rootRef, snapshot_GetNode(formatter));
     }
+
+    // Like resTree_GetPath(), prefix paths relative to the root namespace with a leading '/'.
+    length = snprintf(buffer, size, "%s%s", (session->rootRef == resTree_GetRoot() ? "/" : ""),
+                session->deletedPath);
+    return (length < size ? (ssize_t) length : LE_OVERFLOW);
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Remove all existing deletion records.
+ *  Determine if the node currently under consideration by a formatter's snapshot is a deleted node.
+ *  Only passes with the SNAPSHOT_FILTER_DELETED filter alone have any, which were taken from the
+ *  deletion log and are the last node of their branch.
+ *
+ *  @return true if the node was deleted.
  */
 //--------------------------------------------------------------------------------------------------
-static void FlushDeletionRecords
+bool snapshot_IsNodeDeleted
 (
-    resTree_EntryRef_t nodeRef ///< Node to flush beneath.
+    snapshot_Formatter_t *formatter ///< Formatter instance.
 )
 {
-    resTree_EntryRef_t childRef;
-    resTree_EntryRef_t nextRef = resTree_GetFirstChildEx(nodeRef, true);
-
-    while (nextRef != NULL)
-    {
-        childRef = nextRef;
-        nextRef = resTree_GetNextSiblingEx(childRef, true);
+    Snapshot_t *session = GetSession(formatter);
 
-        FlushDeletionRecords(childRef);
-        if (resTree_IsDeleted(childRef))
-        {
-            le_mem_Release(childRef);
-        }
-    }
+    return (IsLogNode(session) && session->isDeletedNode);
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * End snapshot and tidy up state.
+ *  Determine if the node currently under consideration by a formatter's snapshot is its root.
  *
- * Close the formatter and file handles, and queue up the result callback to provide the status to
- * the user.
+ *  @return true if the node is the root of the snapshot.
  */
 //--------------------------------------------------------------------------------------------------
-void snapshot_End
+bool snapshot_IsRootNode
 (
-    le_result_t status  ///< [IN] Result of the snapshot request.
+    snapshot_Formatter_t *formatter ///< Formatter instance.
 )
 {
-    LE_DEBUG("Ending snapshot with status %s", LE_RESULT_TXT(status));
+    Snapshot_t *session = GetSession(formatter);
 
-    if (Snapshot.formatter != NULL)
-    {
-        Snapshot.formatter->close(Snapshot.formatter);
-        Snapshot.formatter = NULL;
-    }
-    if (Snapshot.sink >= 0)
-    {
-        le_fd_Close(Snapshot.sink);
-        Snapshot.sink = -1;
-    }
+    return (!IsLogNode(session) && (session->nodeRef == session->rootRef));
+}
 
-    ClearNewness(Snapshot.rootRef);
-    // Resume resource tree updates.
-    resTree_EndUpdate();
-    IsRunning = false;
+//--------------------------------------------------------------------------------------------------
+/*
+ *  Determine if deletions that a formatter's snapshot would have reported were dropped from the
+ *  full deletion log.  Such a snapshot includes the whole tree, whatever time stamp was requested,
+ *  so that anything it doesn't include can be taken to be gone.
+ *
+ *  @return true if the snapshot includes the whole tree because deletions were lost.
+ */
+//--------------------------------------------------------------------------------------------------
+bool snapshot_HasLostDeletions
+(
+    snapshot_Formatter_t *formatter ///< Formatter instance.
+)
+{
+    return GetSession(formatter)->lostDeletions;
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ *  Obtain the resource tree node used as root for a formatter's snapshot.
+ *
+ *  @return Node reference.
+ */
+//--------------------------------------------------------------------------------------------------
+resTree_EntryRef_t snapshot_GetRoot
+(
+    snapshot_Formatter_t *formatter ///< Formatter instance.
+)
+{
+    Snapshot_t *session = GetSession(formatter);
+
+    LE_ASSERT(session->rootRef != NULL);
+    return session->rootRef;
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ *  Obtain the time stamp of the start of a formatter's snapshot operation.
+ *
+ *  @return Snapshot time stamp.
+ */
+//--------------------------------------------------------------------------------------------------
+double snapshot_GetTimestamp
+(
+    snapshot_Formatter_t *formatter ///< Formatter instance.
+)
+{
+    return GetSession(formatter)->timestamp;
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Determine if the given node is within the time window of interest for a snapshot session.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsTimely
+(
+    Snapshot_t          *session,   ///< Snapshot session.
+    resTree_EntryRef_t   nodeRef    ///< Node reference.
+)
+{
+    return (resTree_GetLastModified(nodeRef) > session->since);
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Determine if the given node is within the time window of interest for a formatter's snapshot
+ * operation.
+ */
+//--------------------------------------------------------------------------------------------------
+bool snapshot_IsTimely
+(
+    snapshot_Formatter_t    *formatter, ///< Formatter instance.
+    resTree_EntryRef_t       nodeRef    ///< Node reference.
+)
+{
+    return IsTimely(GetSession(formatter), nodeRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ *  Push a session's active node onto its parent stack as we descend to a child.  The stack takes
+ *  over the session's reference to the node.
+ *
+ *  @return
+ *      - LE_OK IF parent was pushed successfully.
+ *      - LE_NO_MEMORY If failed to allocate memory for parent.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t PushParent
+(
+    Snapshot_t *session ///< Snapshot session.
+)
+{
+    Parent_t *entry = hub_MemAlloc(NodeParentPool);
+    if (entry != NULL)
+    {
+        entry->link = LE_SLS_LINK_INIT;
+        entry->nodeRef = session->nodeRef;
+        session->nodeRef = NULL;
+
+        le_sls_Stack(&session->parents, &entry->link);
+        return LE_OK;
+    }
+    else
+    {
+        return LE_NO_MEMORY;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ *  Pop a parent node reference off a session's stack as we back out of a child node.  The caller
+ *  takes over the stack's reference to the node.
+ *
+ *  @return The parent node reference, or NULL if no entries were present on the stack.
+ */
+//--------------------------------------------------------------------------------------------------
+static resTree_EntryRef_t PopParent
+(
+    Snapshot_t *session ///< Snapshot session.
+)
+{
+    le_sls_Link_t       *link = le_sls_Pop(&session->parents);
+    Parent_t            *entry;
+    resTree_EntryRef_t   parentRef = NULL;
+
+    if (link != NULL)
+    {
+        entry = CONTAINER_OF(link, Parent_t, link);
+        parentRef = entry->nodeRef;
+        le_mem_Release(entry);
+    }
+    return parentRef;
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Skip over irrelevant nodes in a list of siblings.
+ *
+ *  @return The first relevant node from nodeRef onward, or NULL if there are none.
+ */
+//--------------------------------------------------------------------------------------------------
+static resTree_EntryRef_t SkipIrrelevant
+(
+    Snapshot_t          *session,   ///< Snapshot session.
+    resTree_EntryRef_t   nodeRef    ///< First sibling to consider (may be NULL).
+)
+{
+    while ((nodeRef != NULL) && !resTree_IsRelevant(nodeRef, session->slot))
+    {
+        nodeRef = resTree_GetNextSiblingEx(nodeRef, false);
+    }
+    return nodeRef;
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Get the first relevant child of a node.
+ *
+ *  @return The child, or NULL if there are none.
+ */
+//--------------------------------------------------------------------------------------------------
+static resTree_EntryRef_t GetFirstRelevantChild
+(
+    Snapshot_t          *session,   ///< Snapshot session.
+    resTree_EntryRef_t   nodeRef    ///< Parent node.
+)
+{
+    return SkipIrrelevant(session, resTree_GetFirstChildEx(nodeRef, false));
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Begin processing a resource tree node.  This will cumulatively perform a depth-first traversal of
+ * the tree from the current node and invoke the formatter as it goes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void NodeBegin
+(
+    Snapshot_t  *session,   ///< [IN] Snapshot session.
+    void        *unused     ///< [IN] Unused parameter.
+)
+{
+    resTree_EntryRef_t childRef;
+
+    LE_UNUSED(unused);
+
+    LE_DEBUG("Handling node beginning");
+
+    if (resTree_IsRelevant(session->nodeRef, session->slot))
+    {
+        childRef = GetFirstRelevantChild(session, session->nodeRef);
+        session->nextState = (childRef == NULL ? STATE_NODE_END : STATE_NODE_CHILDREN);
+        session->formatter->beginNode(session->formatter);
+    }
+    else
+    {
+        session->nextState = STATE_NODE_END;
+        snapshot_Step(session->formatter);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Begin processing the children of a tree node.
+ */
+//--------------------------------------------------------------------------------------------------
+static void NodeChildren
+(
+    Snapshot_t  *session,   ///< [IN] Snapshot session.
+    void        *unused     ///< [IN] Unused parameter.
+)
+{
+    resTree_EntryRef_t childRef;
+
+    LE_UNUSED(unused);
+
+    LE_DEBUG("Handling node children");
+
+    childRef = GetFirstRelevantChild(session, session->nodeRef);
+
+    // We should only get here if we already checked for children.
+    LE_ASSERT(childRef != NULL);
+
+    le_result_t res = PushParent(session);
+    if (res != LE_OK)
+    {
+        EndSession(session, res);
+        return;
+    }
+    SetNode(session, childRef);
+
+    // No additional formatting here, so directly transition the state machine.
+    session->nextState = STATE_NODE_BEGIN;
+    snapshot_Step(session->formatter);
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * End processing a tree node.
+ */
+//--------------------------------------------------------------------------------------------------
+static void NodeEnd
+(
+    Snapshot_t  *session,   ///< [IN] Snapshot session.
+    void        *unused     ///< [IN] Unused parameter.
+)
+{
+    LE_UNUSED(unused);
+
+    LE_DEBUG("Handling node end");
+
+    session->nextState = STATE_NODE_SIBLING;
+    if (resTree_IsRelevant(session->nodeRef, session->slot))
+    {
+        resTree_SetClearNewnessFlag(session->nodeRef);
+        session->formatter->endNode(session->formatter);
+    }
+    else
+    {
+        snapshot_Step(session->formatter);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Move to the next sibling of the current tree node.
+ */
+//--------------------------------------------------------------------------------------------------
+static void NodeSibling
+(
+    Snapshot_t  *session,   ///< [IN] Snapshot session.
+    void        *unused     ///< [IN] Unused parameter.
+)
+{
+    resTree_EntryRef_t siblingRef;
+
+    LE_UNUSED(unused);
+
+    LE_DEBUG("Handling node sibling");
+
+    // Irrelevant siblings are skipped here rather than stepping through each of them.
+    siblingRef = SkipIrrelevant(session, resTree_GetNextSiblingEx(session->nodeRef, false));
+
+    if (siblingRef == NULL)
+    {
+        // No more siblings, try looking for a parent.  It is moved to with the reference the stack
+        // held on it.
+        SetNode(session, NULL);
+        session->nodeRef = PopParent(session);
+        if (session->nodeRef == NULL)
+        {
+            // No more parents, we are done.
+            session->nextState = STATE_TREE_END;
+            session->formatter->endTree(session->formatter);
+            return;
+        }
+        else
+        {
+            // We have a parent, so back out to its level.
+            session->nextState = STATE_NODE_END;
+        }
+    }
+    else
+    {
+        // There is another sibling, move to it.
+        SetNode(session, siblingRef);
+        session->nextState = STATE_NODE_BEGIN;
+    }
+
+    // No formatting to do, so directly transition to the next state.
+    snapshot_Step(session->formatter);
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Begin processing the root of a pass through the deletion log.  The deleted nodes are then visited
+ * in order of their paths, along with the nodes on the way to them, as if they were still in the
+ * tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeletionsBegin
+(
+    Snapshot_t  *session,   ///< [IN] Snapshot session.
+    void        *unused     ///< [IN] Unused parameter.
+)
+{
+    LE_UNUSED(unused);
+
+    LE_DEBUG("Handling deletion log root");
+
+    session->nextState = STATE_DELETION_NEXT;
+    session->formatter->beginNode(session->formatter);
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Move one node towards the next deleted node of a pass through the deletion log, beginning the
+ * nodes on the way down and ending the ones that lead elsewhere.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeletionNext
+(
+    Snapshot_t  *session,   ///< [IN] Snapshot session.
+    void        *unused     ///< [IN] Unused parameter.
+)
+{
+    const char  *targetPath = NULL;
+    char        *endPtr;
+    size_t       length;
+
+    LE_UNUSED(unused);
+
+    LE_DEBUG("Handling deletion log node");
+
+    if (session->isLeavingNode)
+    {
+        // The node has been ended, so back out to its parent.
+        endPtr = strrchr(session->deletedPath, '/');
+        *(endPtr == NULL ? session->deletedPath : endPtr) = '\0';
+        session->isLeavingNode = false;
+        session->isDeletedNode = false;
+    }
+
+    if (session->deletionIndex < session->deletionCount)
+    {
+        targetPath = GetDeletedPath(session, session->deletionIndex);
+    }
+
+    if ((targetPath != NULL) && IsPathBeneath(session->deletedPath, targetPath))
+    {
+        // Move down to the next node on the way to the deleted node.
+        length = strlen(session->deletedPath);
+        endPtr = strchrnul(&targetPath[length == 0 ? 0 : length + 1], '/');
+        length = endPtr - targetPath;
+        memcpy(session->deletedPath, targetPath, length);
+        session->deletedPath[length] = '\0';
+        if (*endPtr == '\0')
+        {
+            // Reached the deleted node itself, which is the last node of its branch.
+            session->isDeletedNode = true;
+            ++session->deletionIndex;
+        }
+        session->nextState = STATE_DELETION_NEXT;
+        session->formatter->beginNode(session->formatter);
+    }
+    else if (session->deletedPath[0] == '\0')
+    {
+        // Back at the root with no more deleted nodes to visit, so we are done.
+        session->nextState = STATE_DELETIONS_END;
+        session->formatter->endNode(session->formatter);
+    }
+    else
+    {
+        // The next deleted node is elsewhere, so end this one before backing out of it.
+        session->isLeavingNode = true;
+        session->nextState = STATE_DELETION_NEXT;
+        session->formatter->endNode(session->formatter);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * End a pass through the deletion log.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeletionsEnd
+(
+    Snapshot_t  *session,   ///< [IN] Snapshot session.
+    void        *unused     ///< [IN] Unused parameter.
+)
+{
+    LE_UNUSED(unused);
+
+    LE_DEBUG("Handling deletion log end");
+
+    session->nextState = STATE_TREE_END;
+    session->formatter->endTree(session->formatter);
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Determine if a node is relevant in its own right (rather than because of its children).
+ *
+ * @return true if the node is relevant.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsNodeRelevant
+(
+    Snapshot_t          *session,   ///< Snapshot session.
+    resTree_EntryRef_t   nodeRef,   ///< Node reference.
+    uint32_t             filter     ///< Filter bitmask for node relevence beyond just timestamp.
+)
+{
+    if (nodeRef == session->rootRef)
+    {
+        // Always include the root node.
+        return true;
+    }
+    else if ((filter & SNAPSHOT_FILTER_CREATED) && resTree_IsNew(nodeRef))
+    {
+        return true;
+    }
+    else if ((filter & (SNAPSHOT_FILTER_NORMAL)) &&
+             !resTree_IsNew(nodeRef) && !resTree_IsDeleted(nodeRef))
+    {
+        return IsTimely(session, nodeRef);
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Recursively set the relevance flag for the specified node and its children.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateRelevance
+(
+    Snapshot_t          *session,   ///< Snapshot session.
+    resTree_EntryRef_t   nodeRef,   ///< Node reference.
+    uint32_t             filter     ///< Filter bitmask for node relevence beyond just timestamp.
+)
+{
+    bool                relevant;
+    resTree_EntryRef_t  childRef;
+
+    // When only timely nodes are of interest, a subtree with nothing newer than the snapshot's
+    // time stamp can be skipped entirely; its nodes were all made irrelevant when the pass began.
+    if (   (nodeRef != session->rootRef)
+        && ((filter & SNAPSHOT_FILTER_CREATED) == 0)
+        && (resTree_GetSubtreeLastModified(nodeRef) <= session->since))
+    {
+        return;
+    }
+
+    relevant = IsNodeRelevant(session, nodeRef, filter);
+    childRef = resTree_GetFirstChildEx(nodeRef, false);
+
+    if (relevant)
+    {
+        LE_DEBUG("Node '%s' is relevant", resTree_GetEntryName(nodeRef));
+    }
+    resTree_SetRelevance(nodeRef, session->slot, relevant);
+
+    // Regardless of this node's timeliness, it is considered relevant if at least one child node is
+    // relevant, in order to provide a "here to there" path.
+    while (childRef != NULL)
+    {
+        UpdateRelevance(session, childRef, filter);
+        relevant = resTree_IsRelevant(childRef, session->slot) || relevant;
+        childRef = resTree_GetNextSiblingEx(childRef, false);
+    }
+
+    if (!resTree_IsRelevant(nodeRef, session->slot) && relevant)
+    {
+        LE_DEBUG("Node %s is cumulatively relevant", resTree_GetEntryName(nodeRef));
+        resTree_SetRelevance(nodeRef, session->slot, relevant);
+    }
+
+    if (!resTree_IsRelevant(nodeRef, session->slot))
+    {
+        LE_DEBUG("Node '%s' is irrelevant", resTree_GetEntryName(nodeRef));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Mark a node as relevant, along with its ancestors up to the snapshot root to provide a "here to
+ * there" path, provided it is beneath the snapshot root.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MarkRelevantPath
+(
+    Snapshot_t          *session,   ///< Snapshot session.
+    resTree_EntryRef_t   nodeRef    ///< Node reference.
+)
+{
+    resTree_EntryRef_t ancestorRef = nodeRef;
+
+    while (ancestorRef != session->rootRef)
+    {
+        if (ancestorRef == NULL)
+        {
+            // Not beneath the snapshot root.
+            return;
+        }
+        ancestorRef = resTree_GetParent(ancestorRef);
+    }
+
+    // The root is marked first, so this stops at the root at the latest.
+    while (!resTree_IsRelevant(nodeRef, session->slot))
+    {
+        LE_DEBUG("Node '%s' is relevant", resTree_GetEntryName(nodeRef));
+        resTree_SetRelevance(nodeRef, session->slot, true);
+        nodeRef = resTree_GetParent(nodeRef);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Set the relevance flags for an incremental snapshot from the resource tree's change journals.
+ * This gives the same result as UpdateRelevance() for a snapshot that only wants values newer than
+ * a given time stamp, but without visiting the nodes that have not changed since then.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateRelevanceFromJournals
+(
+    Snapshot_t  *session,   ///< Snapshot session.
+    uint32_t     filter     ///< Filter bitmask for node relevence beyond just timestamp.
+)
+{
+    resTree_EntryRef_t nodeRef;
+
+    resTree_SetRelevance(session->rootRef, session->slot, true);
+
+    if (filter & SNAPSHOT_FILTER_NORMAL)
+    {
+        nodeRef = resTree_GetChangedSince(session->since, NULL);
+        while (nodeRef != NULL)
+        {
+            if (IsNodeRelevant(session, nodeRef, filter))
+            {
+                MarkRelevantPath(session, nodeRef);
+            }
+            nodeRef = resTree_GetChangedSince(session->since, nodeRef);
+        }
+    }
+
+    if (filter & SNAPSHOT_FILTER_CREATED)
+    {
+        nodeRef = resTree_GetNextStructureChange(NULL);
+        while (nodeRef != NULL)
+        {
+            if (IsNodeRelevant(session, nodeRef, filter))
+            {
+                MarkRelevantPath(session, nodeRef);
+            }
+            nodeRef = resTree_GetNextStructureChange(nodeRef);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Clear the newness flag from tree nodes
+ */
+//--------------------------------------------------------------------------------------------------
+static void ClearNewness
+(
+    void
+)
+{
+    // Only nodes that may be new need to be considered, and clearing their newness can remove them
+    // from the journal, so move on to the next one first.
+    resTree_EntryRef_t nextRef = resTree_GetNextStructureChange(NULL);
+
+    while (nextRef != NULL)
+    {
+        resTree_EntryRef_t nodeRef = nextRef;
+        nextRef = resTree_GetNextStructureChange(nodeRef);
+
+        if (resTree_IsNewnessClearRequired(nodeRef))
+        {
+            resTree_ClearNewness(nodeRef);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Initiate a pass through the resource tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartPass
+(
+    Snapshot_t *session ///< Snapshot session.
+)
+{
+    LE_DEBUG("Starting pass %u of session %u", session->passes, session->slot);
+
+    SetNode(session, session->rootRef);
+    session->isLogPass = (session->formatter->filter == SNAPSHOT_FILTER_DELETED);
+    session->isDeletedNode = false;
+    session->isLeavingNode = false;
+    session->deletedPath[0] = '\0';
+    if (session->isLogPass)
+    {
+        // Deleted nodes are no longer in the tree, so they are taken from the deletion log.
+        session->nextState = STATE_DELETIONS_BEGIN;
+        CollectDeletions(session);
+    }
+    else
+    {
+        session->nextState = STATE_NODE_BEGIN;
+        resTree_ResetRelevance(session->slot);
+        if (session->since > QUERY_BEGINNING_OF_TIME)
+        {
+            // Incremental snapshot, so only the nodes that changed need to be looked at.
+            UpdateRelevanceFromJournals(session, session->formatter->filter);
+        }
+        else
+        {
+            UpdateRelevance(session, session->nodeRef, session->formatter->filter);
+        }
+    }
+    session->formatter->startTree(session->formatter);
+    ++session->passes;
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * End the snapshot state machine.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TreeEnd
+(
+    Snapshot_t  *session,   ///< [IN] Snapshot session.
+    void        *unused     ///< [IN] Unused parameter.
+)
+{
+    LE_UNUSED(unused);
+
+    LE_DEBUG("Handling tree end");
+
+    // Should never get here with a parent still on the stack.
+    LE_ASSERT(le_sls_IsEmpty(&session->parents));
+
+    // A formatter may ask for another pass through the tree, or we may be done.
+    if (session->formatter->scan && session->passes < MAX_PASSES)
+    {
+        StartPass(session);
+    }
+    else if (session->passes >= MAX_PASSES)
+    {
+        EndSession(session, LE_OUT_OF_RANGE);
+    }
+    else
+    {
+        EndSession(session, LE_OK);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Run a session's next state, unless the session has ended since the step was queued.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunStep
+(
+    void *sessionPtr,   ///< [IN] Snapshot session.
+    void *unused        ///< [IN] Unused parameter.
+)
+{
+    typedef void (*SnapshotStep_t)(Snapshot_t *session, void *unused);
+
+    const SnapshotStep_t steps[STATE_MAX] =
+    {
+        &NodeBegin,         // STATE_NODE_BEGIN
+        &NodeChildren,      // STATE_NODE_CHILDREN
+        &NodeEnd,           // STATE_NODE_END
+        &NodeSibling,       // STATE_NODE_SIBLING
+        &DeletionsBegin,    // STATE_DELETIONS_BEGIN
+        &DeletionNext,      // STATE_DELETION_NEXT
+        &DeletionsEnd,      // STATE_DELETIONS_END
+        &TreeEnd            // STATE_TREE_END
+    };
+    Snapshot_t      *session = sessionPtr;
+    le_clk_Time_t    deadline;
+
+    // A session stays in use until its result has been delivered, which is queued after any steps
+    // it still had pending, so the session can't have been reused by another snapshot yet.
+    if (!session->isRunning)
+    {
+        return;
+    }
+
+    // Steps requested while running the state machine are taken here rather than queued, until the
+    // budget for this turn of the event loop runs out.
+    deadline = le_clk_Add(le_clk_GetRelativeTime(), StepBudget);
+    session->isStepping = true;
+    do
+    {
+        session->needsStep = false;
+        steps[session->nextState](session, unused);
+    } while (   session->isRunning
+             && session->needsStep
+             && le_clk_GreaterThan(deadline, le_clk_GetRelativeTime()));
+    session->isStepping = false;
+
+    if (session->isRunning && session->needsStep)
+    {
+        // Out of time, so let other events through before carrying on.
+        session->needsStep = false;
+        le_event_QueueFunction(&RunStep, session, NULL);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Transition a formatter's tree-walking snapshot state machine to the next state.
+ */
+//--------------------------------------------------------------------------------------------------
+void snapshot_Step
+(
+    snapshot_Formatter_t *formatter ///< Formatter instance.
+)
+{
+    Snapshot_t *session = GetSession(formatter);
+#if LE_DEBUG_ENABLED
+    const char *stepNames[STATE_MAX] =
+    {
+        "STATE_NODE_BEGIN",
+        "STATE_NODE_CHILDREN",
+        "STATE_NODE_END",
+        "STATE_NODE_SIBLING",
+        "STATE_DELETIONS_BEGIN",
+        "STATE_DELETION_NEXT",
+        "STATE_DELETIONS_END",
+        "STATE_TREE_END"
+    };
+#endif /* end LE_DEBUG_ENABLED */
+
+    LE_ASSERT(session->nextState >= STATE_NODE_BEGIN && session->nextState < STATE_MAX);
+#if LE_DEBUG_ENABLED
+    LE_DEBUG("Snapshot %u transition: -> %s", session->slot, stepNames[session->nextState]);
+#endif /* end LE_DEBUG_ENABLED */
+    if (session->isStepping)
+    {
+        session->needsStep = true;
+    }
+    else
+    {
+        le_event_QueueFunction(&RunStep, session, NULL);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Invoke the result callback to provide final snapshot job status to the user.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InvokeResultCallback
+(
+    void    *sessionPtr,    ///< [IN] Snapshot session.
+    void    *unused         ///< [IN] Unused parameter.
+)
+{
+    Snapshot_t                              *session = sessionPtr;
+    query_HandleSnapshotResultFunc_t         callback = session->callback;
+    query_HandleSnapshotMemoryResultFunc_t   memoryCallback = session->memoryCallback;
+
+    LE_UNUSED(unused);
+
+    // The session can be reused from here on, including by the callback.
+    session->inUse = false;
+
+    LE_DEBUG("Invoking result callback");
+    if (callback != NULL)
+    {
+        callback(session->status, session->context);
+    }
+    else if (memoryCallback != NULL)
+    {
+        memoryCallback(session->status, session->length, session->context);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Invoke the result callback of a snapshot request that was turned away because all of the
+ * sessions were in use.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InvokeBusyCallback
+(
+    void    *callbackPtr,   ///< [IN] User result callback.
+    void    *contextPtr     ///< [IN] User context for the result callback.
+)
+{
+    query_HandleSnapshotResultFunc_t callback = (query_HandleSnapshotResultFunc_t) callbackPtr;
+
+    LE_DEBUG("Invoking result callback");
+    callback(LE_BUSY, contextPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Invoke the result callback of a request for a snapshot to memory that was turned away because
+ * all of the sessions were in use.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InvokeMemoryBusyCallback
+(
+    void    *callbackPtr,   ///< [IN] User result callback.
+    void    *contextPtr     ///< [IN] User context for the result callback.
+)
+{
+    query_HandleSnapshotMemoryResultFunc_t callback =
+        (query_HandleSnapshotMemoryResultFunc_t) callbackPtr;
+
+    LE_DEBUG("Invoking result callback");
+    callback(LE_BUSY, 0, contextPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * End a snapshot session and tidy up its state.
+ *
+ * Close the formatter and file handles, drop the session's references to tree nodes, and queue up
+ * the result callback to provide the status to the user.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EndSession
+(
+    Snapshot_t  *session,   ///< [IN] Snapshot session.
+    le_result_t  status     ///< [IN] Result of the snapshot request.
+)
+{
+    resTree_EntryRef_t parentRef;
+
+    LE_ASSERT(session->isRunning);
+    LE_DEBUG("Ending snapshot %u with status %s", session->slot, LE_RESULT_TXT(status));
+
+    if (session->formatter != NULL)
+    {
+        session->formatter->close(session->formatter);
+        session->formatter = NULL;
+    }
+#if !LE_CONFIG_RTOS
+    if (session->isMemory)
+    {
+        if (session->overflowed)
+        {
+            status = LE_OVERFLOW;
+        }
+        if (session->memory != NULL)
+        {
+            munmap(session->memory, session->capacity);
+            session->memory = NULL;
+        }
+        // Trim the file so that the requester sees exactly the formatted data.
+        if (status != LE_OK)
+        {
+            session->length = 0;
+        }
+        if (session->sink >= 0 && ftruncate(session->sink, session->length) != 0)
+        {
+            LE_ERROR("Failed to trim snapshot memory, errno: %d", errno);
+            if (status == LE_OK)
+            {
+                status = LE_FAULT;
+                session->length = 0;
+            }
+        }
+    }
+#endif /* end not LE_CONFIG_RTOS */
+    if (session->sink >= 0)
+    {
+        le_fd_Close(session->sink);
+        session->sink = -1;
+    }
+
+    // A snapshot that ends early may still have some of the path to its active node stacked.
+    SetNode(session, NULL);
+    while ((parentRef = PopParent(session)) != NULL)
+    {
+        le_mem_Release(parentRef);
+    }
+    if (session->rootRef != NULL)
+    {
+        le_mem_Release(session->rootRef);
+        session->rootRef = NULL;
+    }
+    ReleaseDeletions(session);
+
+    if ((status == LE_OK) && (session->flags & QUERY_SNAPSHOT_FLAG_FLUSH_DELETIONS))
+    {
+        // The consumer is up to date with everything logged before the snapshot started, including
+        // the deletions that were dropped, unless more were dropped since.
+        FlushDeletionRecords(session->deletionSeq);
+        if (LostDeletionTime == session->lostTime)
+        {
+            LostDeletionTime = QUERY_BEGINNING_OF_TIME;
+        }
+    }
 
-    le_event_QueueFunction(&InvokeResultCallback, (void *) (uintptr_t) status, NULL);
+    ClearNewness();
+    // Resume resource tree updates.
+    ResumeUpdates();
+    session->isRunning = false;
+
+    session->status = status;
+    le_event_QueueFunction(&InvokeResultCallback, session, NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * End snapshot and tidy up state.
+ *
+ * Close the formatter and file handles, and queue up the result callback to provide the status to
+ * the user.  May be invoked from a formatter in exceptional circumstances to return early or return
+ * an error.
+ */
+//--------------------------------------------------------------------------------------------------
+void snapshot_End
+(
+    snapshot_Formatter_t    *formatter, ///< [IN] Formatter instance.
+    le_result_t              status     ///< [IN] Result of the snapshot request.
+)
+{
+    EndSession(GetSession(formatter), status);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -647,12 +1742,15 @@ void snapshot_End
 //--------------------------------------------------------------------------------------------------
 static inline void InitPipe
 (
-    void
+    Snapshot_t *session ///< Snapshot session.
 )
 #if LE_CONFIG_RTOS
 {
-    Snapshot.sink = le_fd_Open(SNAPSHOT_FIFO, O_WRONLY | O_NONBLOCK);
-    Snapshot.source = le_fd_Open(SNAPSHOT_FIFO, O_RDONLY | O_NONBLOCK);
+    char path[sizeof(SNAPSHOT_FIFO) + 10];
+
+    snprintf(path, sizeof(path), SNAPSHOT_FIFO "%u", session->slot);
+    session->sink = le_fd_Open(path, O_WRONLY | O_NONBLOCK);
+    session->source = le_fd_Open(path, O_RDONLY | O_NONBLOCK);
 }
 #else /* not LE_CONFIG_RTOS */
 {
@@ -661,71 +1759,103 @@ static inline void InitPipe
     // We don't bother checking the return value here because the FDs will be checked as soon as we
     // return.
     pipe2(fds, O_NONBLOCK);
-    Snapshot.sink = fds[1];
-    Snapshot.source = fds[0];
+    session->sink = fds[1];
+    session->source = fds[0];
 }
 #endif /* end not LE_CONFIG_RTOS */
 
+#if !LE_CONFIG_RTOS
 //--------------------------------------------------------------------------------------------------
 /*
- * Capture a snapshot of the resource tree.
- *
- * The snapshot will be of the portion of the tree rooted at the given path, and include all values
- * which have changed since the provided time stamp.  The response will be encoded according to the
- * specified formatter and streamed back to the requester via the provided file handle.  The end of
- * data or an error will be indicated by invoking the provided callback with a result code.
+ * Initialise the shared memory file for passing back formatted data.
  *
- * If deletions are being tracked (@see query_TrackDeletions), then information about deleted
- * resources will be included in the snapshot if the formatter includes it.  The
- * SNAPSHOT_FLAG_FLUSH_DELETIONS flag may be passed to flush and reset the current deletion tracking
- * as part of the snapshot operation.  Doing this would mean that deletion information would only be
- * available back to the time stamp of the last snapshot.
+ * The source handle is passed to the requester, while the session keeps a duplicate to write and
+ * map the file through.
  */
 //--------------------------------------------------------------------------------------------------
-void query_TakeSnapshot
+static inline void InitMemory
 (
-    uint32_t     format,    ///< [IN] Snapshot output data format.
-    uint32_t     flags,     ///< [IN] Flags controlling the snapshot action.
-    const char  *path,      ///< [IN] Tree path to use as the root.
-    double       since,     ///< [IN] Request only values that have changed since this time (in s).
-                            ///<      Use BEGINNING_OF_TIME to request the full tree.
-    query_HandleSnapshotResultFunc_t callback,  ///< [IN]  Completion callback to indicate the end
-                                                ///<       of the streamed snapshot, or an error.
-    void        *contextPtr,    ///< [IN]  User context for the completion callback.
-    int         *snapshotStream ///< [OUT] File descriptor to which the encoded snapshot data will
-                                ///<       be streamed.
+    Snapshot_t *session ///< Snapshot session.
 )
 {
-    le_clk_Time_t   currentTime;
-    le_result_t     status = LE_OK;
+    // We don't bother checking the return values here because the FDs will be checked as soon as
+    // we return.
+    session->source = memfd_create("datahub_snapshot", MFD_CLOEXEC);
+    if (session->source >= 0)
+    {
+        session->sink = fcntl(session->source, F_DUPFD_CLOEXEC, 0);
+    }
+}
+#endif /* end not LE_CONFIG_RTOS */
 
-    LE_ASSERT(callback != NULL);
-    LE_ASSERT(path != NULL);
-    LE_ASSERT(snapshotStream != NULL);
+//--------------------------------------------------------------------------------------------------
+/*
+ * Claim a free snapshot session and pause resource tree updates on its behalf.
+ *
+ * @return Session, or NULL if all of them are in use.
+ */
+//--------------------------------------------------------------------------------------------------
+static Snapshot_t *AcquireSession
+(
+    void
+)
+{
+    Snapshot_t      *session;
+    unsigned int     slot;
 
-    *snapshotStream = -1;
-    if (IsRunning)
+    for (slot = 0; slot < DHUB_SNAPSHOT_MAX_SESSIONS; ++slot)
     {
-        LE_INFO("Snapshot already running");
-        // Already running, so indicate we are busy.
-        status = LE_BUSY;
-        le_event_QueueFunction(&InvokeResultCallback, (void *) (uintptr_t) status, NULL);
-        return;
+        session = &Sessions[slot];
+        if (!session->inUse)
+        {
+            memset(session, 0, sizeof(*session));
+            session->inUse = true;
+            session->isRunning = true;
+            session->slot = RESTREE_CONFIG_RELEVANCE_SLOT + 1 + slot;
+            session->parents = LE_SLS_LIST_INIT;
+            session->sink = -1;
+            session->source = -1;
+
+            // Pause updates to the tree while the snapshot scan runs.
+            PauseUpdates();
+            return session;
+        }
     }
-    IsRunning = true;
 
-    // Pause updates to the tree while the snapshot scan runs.
-    resTree_StartUpdate();
+    LE_INFO("All %u snapshot sessions already running", DHUB_SNAPSHOT_MAX_SESSIONS);
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Set up the formatter and tree root of a session whose output handles are open, and begin the
+ * first pass through the tree.
+ *
+ * @return
+ *      - LE_OK if the snapshot is under way.
+ *      - LE_CLOSED if the output handles could not be opened.
+ *      - LE_NOT_FOUND if there is no node at the requested path.
+ *      - Any other error from the formatter.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t StartSession
+(
+    Snapshot_t  *session,   ///< [IN] Snapshot session.
+    uint32_t     format,    ///< [IN] Snapshot output data format.
+    uint32_t     flags,     ///< [IN] Flags controlling the snapshot action.
+    const char  *path,      ///< [IN] Tree path to use as the root.
+    double       since      ///< [IN] Request only values that have changed since this time (in s).
+)
+{
+    le_clk_Time_t   currentTime;
+    le_result_t     status;
+    int             stream = (session->isMemory ? -1 : session->sink);
 
-    memset(&Snapshot, 0, sizeof(Snapshot));
-    Snapshot.callback = callback;
-    Snapshot.context = contextPtr;
-    InitPipe();
-    if (Snapshot.sink < 0 || Snapshot.source < 0)
+    if (session->sink < 0 || session->source < 0)
     {
-        LE_ERROR("Failed to open pipe (sink: %d, source: %d)", Snapshot.sink, Snapshot.source);
-        status = LE_CLOSED;
-        goto end;
+        LE_ERROR("Failed to open %s (sink: %d, source: %d)",
+            (session->isMemory ? "shared memory" : "pipe"), session->sink, session->source);
+        return LE_CLOSED;
     }
 
     // NOTE: In the future it may be possible to plug in more formatters, but for now this is a
@@ -733,11 +1863,11 @@ void query_TakeSnapshot
     switch (format)
     {
         case QUERY_SNAPSHOT_FORMAT_JSON:
-            status = GetJsonSnapshotFormatter(flags, Snapshot.sink, &Snapshot.formatter);
+            status = GetJsonSnapshotFormatter(flags, stream, &session->formatter);
             break;
 #ifdef WITH_OCTAVE
         case QUERY_SNAPSHOT_FORMAT_OCTAVE:
-            status = GetOctaveSnapshotFormatter(flags, Snapshot.sink, &Snapshot.formatter);
+            status = GetOctaveSnapshotFormatter(flags, stream, &session->formatter);
             break;
 #endif
         default:
@@ -746,55 +1876,199 @@ void query_TakeSnapshot
     }
     if (LE_OK != status)
     {
-        // Close the source here because the client will not do it
-        le_fd_Close(Snapshot.source);
-        Snapshot.source = -1;
-        goto end;
+        session->formatter = NULL;
+        return status;
     }
+    session->formatter->session = session;
 
-    Snapshot.rootRef = resTree_FindEntryAtAbsolutePath(path);
-    if (Snapshot.rootRef == NULL)
+    session->rootRef = resTree_FindEntryAtAbsolutePath(path);
+    if (session->rootRef == NULL)
     {
-        status = LE_NOT_FOUND;
-        goto end;
+        return LE_NOT_FOUND;
     }
+    le_mem_AddRef(session->rootRef);
+
+    session->flags = flags;
+    session->since = since;
 
-    Snapshot.flags = flags;
-    Snapshot.since = since;
-    *snapshotStream = Snapshot.source;
+    // A snapshot that would have reported deletions dropped from the full deletion log includes the
+    // whole tree instead, so that the consumer can tell what is gone from what is left.
+    session->deletionSeq = NextDeletionSeq;
+    session->lostTime = LostDeletionTime;
+    session->lostDeletions = (LostDeletionTime > since);
+    if (session->lostDeletions)
+    {
+        LE_INFO("Deletions since %lf were lost, taking full snapshot", since);
+        session->since = QUERY_BEGINNING_OF_TIME;
+    }
 
     currentTime = le_clk_GetAbsoluteTime();
-    Snapshot.timestamp = (((double) currentTime.usec) / 1000000) + currentTime.sec;
+    session->timestamp = (((double) currentTime.usec) / 1000000) + currentTime.sec;
 
-    if (Snapshot.formatter->scan)
+    if (!session->formatter->scan)
     {
-        StartPass();
+        return LE_UNSUPPORTED;
     }
-    else
+    StartPass(session);
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Hand the requester the output handle of a session that has started, or end a session that
+ * failed to start.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CompleteStart
+(
+    Snapshot_t  *session,   ///< [IN]  Snapshot session.
+    le_result_t  status,    ///< [IN]  Result of starting the session.
+    int         *handlePtr  ///< [OUT] Handle to pass back to the requester.
+)
+{
+    if (status == LE_OK)
+    {
+        *handlePtr = session->source;
+        return;
+    }
+
+    LE_ERROR("Failed to start snapshot with error: %s", LE_RESULT_TXT(status));
+
+    // Close the source here because the client will not receive it.
+    if (session->source >= 0)
+    {
+        le_fd_Close(session->source);
+        session->source = -1;
+    }
+
+    // End the snapshot request and unlock the tree.
+    EndSession(session, status);
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Capture a snapshot of the resource tree.
+ *
+ * The snapshot will be of the portion of the tree rooted at the given path, and include all values
+ * which have changed since the provided time stamp.  The response will be encoded according to the
+ * specified formatter and streamed back to the requester via the provided file handle.  The end of
+ * data or an error will be indicated by invoking the provided callback with a result code.
+ *
+ * If deletions are being tracked (@see query_TrackDeletions), then information about deleted
+ * resources will be included in the snapshot if the formatter includes it.  The
+ * SNAPSHOT_FLAG_FLUSH_DELETIONS flag may be passed to flush and reset the current deletion tracking
+ * as part of the snapshot operation.  Doing this would mean that deletion information would only be
+ * available back to the time stamp of the last snapshot.  If deletions the snapshot would have
+ * reported were dropped from the full deletion log, the whole tree is included instead.
+ *
+ * Several snapshots can be in progress at the same time, each streaming to its own file handle.  If
+ * too many already are, the callback is invoked with LE_BUSY.
+ */
+//--------------------------------------------------------------------------------------------------
+void query_TakeSnapshot
+(
+    uint32_t     format,    ///< [IN] Snapshot output data format.
+    uint32_t     flags,     ///< [IN] Flags controlling the snapshot action.
+    const char  *path,      ///< [IN] Tree path to use as the root.
+    double       since,     ///< [IN] Request only values that have changed since this time (in s).
+                            ///<      Use BEGINNING_OF_TIME to request the full tree.
+    query_HandleSnapshotResultFunc_t callback,  ///< [IN]  Completion callback to indicate the end
+                                                ///<       of the streamed snapshot, or an error.
+    void        *contextPtr,    ///< [IN]  User context for the completion callback.
+    int         *snapshotStream ///< [OUT] File descriptor to which the encoded snapshot data will
+                                ///<       be streamed.
+)
+{
+    Snapshot_t *session;
+
+    LE_ASSERT(callback != NULL);
+    LE_ASSERT(path != NULL);
+    LE_ASSERT(snapshotStream != NULL);
+
+    *snapshotStream = -1;
+    session = AcquireSession();
+    if (session == NULL)
     {
-        status = LE_UNSUPPORTED;
+        // No free session, so indicate we are busy.
+        le_event_QueueFunction(&InvokeBusyCallback, (void *) callback, contextPtr);
+        return;
     }
+    session->callback = callback;
+    session->context = contextPtr;
+
+    InitPipe(session);
+    CompleteStart(session, StartSession(session, format, flags, path, since), snapshotStream);
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Capture a snapshot of the resource tree into shared memory.
+ *
+ * This behaves like query_TakeSnapshot(), except that the encoded snapshot is written into an
+ * anonymous shared memory file instead of being streamed through a pipe, so the formatter never
+ * waits for the requester to drain the data.  Once the callback reports success, the file holds
+ * exactly the reported number of bytes.
+ *
+ * If shared memory files are not available on the target, the callback is invoked with
+ * LE_NOT_IMPLEMENTED.
+ */
+//--------------------------------------------------------------------------------------------------
+void query_TakeSnapshotToMemory
+(
+    uint32_t     format,    ///< [IN] Snapshot output data format.
+    uint32_t     flags,     ///< [IN] Flags controlling the snapshot action.
+    const char  *path,      ///< [IN] Tree path to use as the root.
+    double       since,     ///< [IN] Request only values that have changed since this time (in s).
+                            ///<      Use BEGINNING_OF_TIME to request the full tree.
+    query_HandleSnapshotMemoryResultFunc_t callback,    ///< [IN]  Completion callback to indicate
+                                                        ///<       the end of the snapshot, or an
+                                                        ///<       error.
+    void        *contextPtr,    ///< [IN]  User context for the completion callback.
+    int         *snapshotMemory ///< [OUT] Shared memory file that the encoded snapshot data will
+                                ///<       be written to.
+)
+{
+    Snapshot_t *session;
+
+    LE_ASSERT(callback != NULL);
+    LE_ASSERT(path != NULL);
+    LE_ASSERT(snapshotMemory != NULL);
 
-end:
-    if (status != LE_OK)
+    *snapshotMemory = -1;
+    session = AcquireSession();
+    if (session == NULL)
     {
-        LE_ERROR("Failed to start snapshot with error: %s", LE_RESULT_TXT(status));
-        // End the snapshot request and unlock the tree if it is locked.
-        snapshot_End(status);
+        // No free session, so indicate we are busy.
+        le_event_QueueFunction(&InvokeMemoryBusyCallback, (void *) callback, contextPtr);
+        return;
     }
+    session->memoryCallback = callback;
+    session->context = contextPtr;
+    session->isMemory = true;
+
+#if LE_CONFIG_RTOS
+    LE_UNUSED(format);
+    LE_UNUSED(flags);
+    LE_UNUSED(since);
+    CompleteStart(session, LE_NOT_IMPLEMENTED, snapshotMemory);
+#else /* not LE_CONFIG_RTOS */
+    InitMemory(session);
+    CompleteStart(session, StartSession(session, format, flags, path, since), snapshotMemory);
+#endif /* end not LE_CONFIG_RTOS */
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
  * Control whether deletion records should be maintained within the Data Hub.
  *
- * Turning on deletion tracking will cause some metadata to be retained for each deleted resource.
- * This metadata will be supplied to the formatter when a snapshot is requested so that nodes which
- * have disappeared from the tree can be recorded appropriately.  Because this metadata will
- * gradually accumulate over time as nodes are removed, there are two ways of requesting that the
- * deletion data be flushed.  The first is to just disable and then reenable tracking using this
- * function.  The second is to pass the SNAPSHOT_FLAG_FLUSH_DELETIONS flag when requesting a
- * snapshot.
+ * Turning on deletion tracking will cause the path and time of each deleted resource to be kept in
+ * a deletion log, outside of the resource tree.  This log will be supplied to the formatter when a
+ * snapshot is requested so that nodes which have disappeared from the tree can be recorded
+ * appropriately.  The log holds up to DHUB_DELETION_LOG_SIZE deletions, beyond which the oldest
+ * ones are dropped and the snapshots that would have reported them include the whole tree instead.
+ * There are two ways of requesting that the deletion data be flushed.  The first is to just disable
+ * and then reenable tracking using this function.  The second is to pass the
+ * SNAPSHOT_FLAG_FLUSH_DELETIONS flag when requesting a snapshot.
  */
 //--------------------------------------------------------------------------------------------------
 void query_TrackDeletions
@@ -805,10 +2079,9 @@ void query_TrackDeletions
     AreDeletionsTracked = on;
     if (!AreDeletionsTracked)
     {
-        // Pause updates to the tree while we flush the records.
-        resTree_StartUpdate();
-        FlushDeletionRecords(resTree_GetRoot());
-        resTree_EndUpdate();
+        // Snapshots that are running keep the records they are reporting until they are done.
+        FlushDeletionRecords(NextDeletionSeq);
+        LostDeletionTime = QUERY_BEGINNING_OF_TIME;
     }
 }
 
@@ -824,7 +2097,13 @@ void snapshot_RecordNodeDeletion
 {
     if (AreDeletionsTracked)
     {
-        le_mem_AddRef(nodeRef);
+        LogDeletion(nodeRef);
+    }
+
+    if (resTree_GetFirstChildEx(nodeRef, true) == NULL)
+    {
+        // A snapshot may still be referring to the node, in which case it will outlive the
+        // deletion, so make it a zombie rather than a namespace that looks live.
         resTree_SetDeleted(nodeRef);
     }
 }
@@ -840,9 +2119,16 @@ void snapshot_Init
 )
 {
     AreDeletionsTracked = false;
+    LostDeletionTime = QUERY_BEGINNING_OF_TIME;
 
 #if LE_CONFIG_RTOS
-    LE_ASSERT(le_fd_MkFifo(SNAPSHOT_FIFO, S_IRUSR | S_IWUSR) == 0);
+    for (unsigned int slot = 0; slot < DHUB_SNAPSHOT_MAX_SESSIONS; ++slot)
+    {
+        char path[sizeof(SNAPSHOT_FIFO) + 10];
+
+        snprintf(path, sizeof(path), SNAPSHOT_FIFO "%u", RESTREE_CONFIG_RELEVANCE_SLOT + 1 + slot);
+        LE_ASSERT(le_fd_MkFifo(path, S_IRUSR | S_IWUSR) == 0);
+    }
 #endif
 
     NodeParentPool = le_mem_InitStaticPool(
@@ -850,4 +2136,12 @@ void snapshot_Init
                         DEFAULT_NODE_PARENT_POOL_SIZE,
                         sizeof(Parent_t)
                     );
+    hub_RegisterPool(NodeParentPool);
+
+    DeletionRecordPool = le_mem_InitStaticPool(
+                            DeletionRecordPool,
+                            DEFAULT_DELETION_RECORD_POOL_SIZE,
+                            sizeof(DeletionRecord_t)
+                        );
+    hub_RegisterPool(DeletionRecordPool);
 }
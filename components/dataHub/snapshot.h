@@ -13,6 +13,7 @@
 #define SNAPSHOT_H_INCLUDE_GUARD
 
 #include "legato.h"
+#include "interfaces.h"
 
 /// Filter for newly created nodes.
 #define SNAPSHOT_FILTER_CREATED 0x1
@@ -21,8 +22,16 @@
 /// Filter for normal nodes (i.e. not new or deleted).
 #define SNAPSHOT_FILTER_NORMAL  0x4
 
-// Forward reference.
+/// Maximum number of snapshots that can be in progress at the same time.  Each one needs its own
+/// formatter instance, and adds a relevance mark to every resource tree entry.  This can be
+/// overridden in the .cdef (of every component that includes this header).
+#ifndef DHUB_SNAPSHOT_MAX_SESSIONS
+#define DHUB_SNAPSHOT_MAX_SESSIONS 2
+#endif
+
+// Forward references.
 struct snapshot_Formatter;
+struct snapshot_Session;
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -56,6 +65,9 @@ typedef struct snapshot_Formatter
 
     bool        scan;   ///< Request a scan of the resource tree.
     uint32_t    filter; ///< Mask to filter nodes during tree traversal.
+
+    struct snapshot_Session *session;   ///< Snapshot the formatter is producing (set by the
+                                        ///< snapshot system).
 } snapshot_Formatter_t;
 
 //--------------------------------------------------------------------------------------------------
@@ -80,83 +92,186 @@ void snapshot_RecordNodeDeletion
 
 //--------------------------------------------------------------------------------------------------
 /*
- *  Obtain the flags for the current snapshot operation.
+ *  Obtain the flags for a formatter's snapshot operation.
  *
- *  @return Flags for the current snapshot.
+ *  @return Flags for the snapshot.
  */
 //--------------------------------------------------------------------------------------------------
 LE_SHARED uint32_t snapshot_GetFlags
 (
-    void
+    struct snapshot_Formatter *formatter ///< Formatter instance.
 );
 
 //--------------------------------------------------------------------------------------------------
 /*
- *  Obtain the file stream to write formatted output to for the current snapshot operation.
+ *  Obtain the file stream to write formatted output to for a formatter's snapshot operation.
  *
- *  @return File descriptor for the formatted output stream.
+ *  @return File descriptor for the formatted output stream, or -1 if the snapshot is written to
+ *          shared memory (see snapshot_Write()).
  */
 //--------------------------------------------------------------------------------------------------
 LE_SHARED int snapshot_GetStream
 (
-    void
+    struct snapshot_Formatter *formatter ///< Formatter instance.
 );
 
 //--------------------------------------------------------------------------------------------------
 /*
- *  Obtain the resource tree node currently under consideration.
+ * Write formatted output for a formatter's snapshot operation.
+ *
+ * Output written to shared memory is copied straight into the mapped file, so a write never has
+ * to wait for the other side and always consumes all of the data unless it fails.
+ *
+ * @return Number of bytes written, or -1 with errno set on failure (EAGAIN if the stream is full).
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED ssize_t snapshot_Write
+(
+    struct snapshot_Formatter   *formatter, ///< Formatter instance.
+    const void                  *data,      ///< Formatted data to write.
+    size_t                       length     ///< Number of bytes to write.
+);
+
+//--------------------------------------------------------------------------------------------------
+/*
+ *  Obtain the resource tree node currently under consideration by a formatter's snapshot.  Must not
+ *  be called for the deleted nodes of a pass through the deletion log, or the nodes on the way to
+ *  them, which are no longer in the tree (see snapshot_GetNodeName()).
  *
  *  @return Node reference.
  */
 //--------------------------------------------------------------------------------------------------
 LE_SHARED resTree_EntryRef_t snapshot_GetNode
 (
-    void
+    struct snapshot_Formatter *formatter ///< Formatter instance.
+);
+
+//--------------------------------------------------------------------------------------------------
+/*
+ *  Obtain the name of the node currently under consideration by a formatter's snapshot.
+ *
+ *  @return Node name.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED const char *snapshot_GetNodeName
+(
+    struct snapshot_Formatter *formatter ///< Formatter instance.
+);
+
+//--------------------------------------------------------------------------------------------------
+/*
+ *  Obtain the type of the node currently under consideration by a formatter's snapshot.  The nodes
+ *  of a pass through the deletion log are all namespaces, apart from its root.
+ *
+ *  @return Node type.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED admin_EntryType_t snapshot_GetNodeType
+(
+    struct snapshot_Formatter *formatter ///< Formatter instance.
+);
+
+//--------------------------------------------------------------------------------------------------
+/*
+ *  Obtain the path of the node currently under consideration by a formatter's snapshot, relative to
+ *  the snapshot's root, in the same form as resTree_GetPath() does.
+ *
+ *  @return
+ *      - Number of bytes written to the buffer (excluding null terminator) if successful.
+ *      - LE_OVERFLOW if the buffer is too small to hold the path.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED ssize_t snapshot_GetNodePath
+(
+    struct snapshot_Formatter   *formatter, ///< Formatter instance.
+    char                        *buffer,    ///< Buffer to write the path to.
+    size_t                       size       ///< Size of the buffer, in bytes.
+);
+
+//--------------------------------------------------------------------------------------------------
+/*
+ *  Determine if the node currently under consideration by a formatter's snapshot is a deleted node.
+ *  Only passes with the SNAPSHOT_FILTER_DELETED filter alone have any, which were taken from the
+ *  deletion log and are the last node of their branch.
+ *
+ *  @return true if the node was deleted.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED bool snapshot_IsNodeDeleted
+(
+    struct snapshot_Formatter *formatter ///< Formatter instance.
+);
+
+//--------------------------------------------------------------------------------------------------
+/*
+ *  Determine if the node currently under consideration by a formatter's snapshot is its root.
+ *
+ *  @return true if the node is the root of the snapshot.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED bool snapshot_IsRootNode
+(
+    struct snapshot_Formatter *formatter ///< Formatter instance.
 );
 
 //--------------------------------------------------------------------------------------------------
 /*
- *  Obtain the resource tree node used as root for snapshot.
+ *  Determine if deletions that a formatter's snapshot would have reported were dropped from the
+ *  full deletion log.  Such a snapshot includes the whole tree, whatever time stamp was requested,
+ *  so that anything it doesn't include can be taken to be gone.
+ *
+ *  @return true if the snapshot includes the whole tree because deletions were lost.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED bool snapshot_HasLostDeletions
+(
+    struct snapshot_Formatter *formatter ///< Formatter instance.
+);
+
+//--------------------------------------------------------------------------------------------------
+/*
+ *  Obtain the resource tree node used as root for a formatter's snapshot.
  *
  *  @return Node reference.
  */
 //--------------------------------------------------------------------------------------------------
 LE_SHARED resTree_EntryRef_t snapshot_GetRoot
 (
-    void
+    struct snapshot_Formatter *formatter ///< Formatter instance.
 );
 
 //--------------------------------------------------------------------------------------------------
 /*
- *  Obtain the time at which the snapshot was initiated.
+ *  Obtain the time at which a formatter's snapshot was initiated.
  *
  *  @return Snapshot time stamp.
  */
 //--------------------------------------------------------------------------------------------------
 LE_SHARED double snapshot_GetTimestamp
 (
-    void
+    struct snapshot_Formatter *formatter ///< Formatter instance.
 );
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Determine if the given node is within the time window of interest for the current snapshot
+ * Determine if the given node is within the time window of interest for a formatter's snapshot
  * operation.
  */
 //--------------------------------------------------------------------------------------------------
 LE_SHARED bool snapshot_IsTimely
 (
-    resTree_EntryRef_t nodeRef ///< Node reference.
+    struct snapshot_Formatter   *formatter, ///< Formatter instance.
+    resTree_EntryRef_t           nodeRef    ///< Node reference.
 );
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Transition the tree-walking snapshot state machine to the next state.
+ * Transition a formatter's tree-walking snapshot state machine to the next state.
  */
 //--------------------------------------------------------------------------------------------------
 LE_SHARED void snapshot_Step
 (
-    void
+    struct snapshot_Formatter *formatter ///< Formatter instance.
 );
 
 //--------------------------------------------------------------------------------------------------
@@ -170,7 +285,8 @@ LE_SHARED void snapshot_Step
 //--------------------------------------------------------------------------------------------------
 LE_SHARED void snapshot_End
 (
-    le_result_t status  ///< [IN] Result of the snapshot request.
+    struct snapshot_Formatter   *formatter, ///< [IN] Formatter instance.
+    le_result_t                  status     ///< [IN] Result of the snapshot request.
 );
 
 #endif /* end SNAPSHOT_H_INCLUDE_GUARD */
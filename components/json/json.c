@@ -11,6 +11,146 @@
 #include "legato.h"
 #include "json.h"
 
+// Long runs of string content and whitespace are scanned a block of bytes at a time using the
+// target's vector unit, if it has one (NEON on ARM, SSE2 on x86).  Build with JSON_NO_SIMD
+// defined to always scan one byte at a time.
+#if !defined(JSON_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define SCAN_WITH_NEON
+#define SCAN_BLOCK_BYTES 16
+#elif !defined(JSON_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define SCAN_WITH_SSE2
+#define SCAN_BLOCK_BYTES 16
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a character ends a run of plain string content (a quote, backslash or the
+ * null terminator).
+ *
+ * @return true if it does.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsStringSpecial
+(
+    char c
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return ((c == '"') || (c == '\\') || (c == '\0'));
+}
+
+
+#ifdef SCAN_BLOCK_BYTES
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether an aligned block of SCAN_BLOCK_BYTES bytes contains a quote, backslash or null.
+ *
+ * @return true if it does.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool BlockHasStringSpecial
+(
+    const char* blockPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+#ifdef SCAN_WITH_SSE2
+    __m128i block = _mm_load_si128((const __m128i*)blockPtr);
+    __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('"')),
+                                             _mm_cmpeq_epi8(block, _mm_set1_epi8('\\'))),
+                                _mm_cmpeq_epi8(block, _mm_setzero_si128()));
+
+    return (_mm_movemask_epi8(hits) != 0);
+#else
+    uint8x16_t block = vld1q_u8((const uint8_t*)blockPtr);
+    uint8x16_t hits = vorrq_u8(vorrq_u8(vceqq_u8(block, vdupq_n_u8('"')),
+                                        vceqq_u8(block, vdupq_n_u8('\\'))),
+                               vceqq_u8(block, vdupq_n_u8(0)));
+    uint64x2_t hits64 = vreinterpretq_u64_u8(hits);
+
+    return ((vgetq_lane_u64(hits64, 0) | vgetq_lane_u64(hits64, 1)) != 0);
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether an aligned block of SCAN_BLOCK_BYTES bytes is all whitespace (as per isspace()
+ * in the "C" locale: space, or '\t' through '\r').
+ *
+ * @return true if it is.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool BlockIsAllWhitespace
+(
+    const char* blockPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+#ifdef SCAN_WITH_SSE2
+    __m128i block = _mm_load_si128((const __m128i*)blockPtr);
+    __m128i fromTab = _mm_sub_epi8(block, _mm_set1_epi8('\t'));
+    __m128i spaces = _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' ')),
+                                  _mm_cmpeq_epi8(_mm_min_epu8(fromTab, _mm_set1_epi8('\r' - '\t')),
+                                                 fromTab));
+
+    return (_mm_movemask_epi8(spaces) == 0xFFFF);
+#else
+    uint8x16_t block = vld1q_u8((const uint8_t*)blockPtr);
+    uint8x16_t spaces = vorrq_u8(vceqq_u8(block, vdupq_n_u8(' ')),
+                                 vcleq_u8(vsubq_u8(block, vdupq_n_u8('\t')),
+                                          vdupq_n_u8('\r' - '\t')));
+    uint64x2_t others64 = vreinterpretq_u64_u8(vmvnq_u8(spaces));
+
+    return ((vgetq_lane_u64(others64, 0) | vgetq_lane_u64(others64, 1)) == 0);
+#endif
+}
+#endif /* SCAN_BLOCK_BYTES */
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the end of a run of plain string content.
+ *
+ * Whole blocks are only read once the pointer is aligned to the block size, so a block never
+ * crosses into the next page, even if it extends past the null terminator.
+ *
+ * @return Pointer to the first quote, backslash or null terminator.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* FindStringSpecial
+(
+    const char* valPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+#ifdef SCAN_BLOCK_BYTES
+    while (((uintptr_t)valPtr % SCAN_BLOCK_BYTES) != 0)
+    {
+        if (IsStringSpecial(*valPtr))
+        {
+            return valPtr;
+        }
+        valPtr++;
+    }
+
+    while (!BlockHasStringSpecial(valPtr))
+    {
+        valPtr += SCAN_BLOCK_BYTES;
+    }
+#endif
+
+    while (!IsStringSpecial(*valPtr))
+    {
+        valPtr++;
+    }
+
+    return valPtr;
+}
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -27,9 +167,22 @@ static const char* SkipWhitespace
 {
     if (valPtr != NULL)
     {
+        // Most runs of whitespace are short, so only switch to scanning whole blocks if the run
+        // reaches a block boundary.  The null terminator is not whitespace, so the block scan
+        // stops at or before the block containing it.
         while (isspace(*valPtr))
         {
             valPtr++;
+
+#ifdef SCAN_BLOCK_BYTES
+            if (((uintptr_t)valPtr % SCAN_BLOCK_BYTES) == 0)
+            {
+                while (BlockIsAllWhitespace(valPtr))
+                {
+                    valPtr += SCAN_BLOCK_BYTES;
+                }
+            }
+#endif
         }
     }
 
@@ -55,7 +208,7 @@ static const char* SkipString
         return NULL;
     }
 
-    valPtr++;
+    valPtr = FindStringSpecial(valPtr + 1);
 
     while (*valPtr != '"')
     {
@@ -67,18 +220,11 @@ static const char* SkipString
         // Skip an escaped character (making sure not to skip past the null terminator).
         // Note that JSON only allows a few things to be escaped, but we are being tolerant
         // of invalid escape sequences here in the interests of runtime performance.
-        if (valPtr[0] == '\\')
-        {
-            if (valPtr[1] == '\0')
-            {
-                return NULL;
-            }
-            valPtr += 2;
-        }
-        else
+        if (valPtr[1] == '\0')
         {
-            valPtr += 1;
+            return NULL;
         }
+        valPtr = FindStringSpecial(valPtr + 2);
     }
 
     return valPtr + 1;
@@ -415,15 +561,33 @@ static le_result_t GoToElement
 
         valPtr = SkipWhitespace(SkipValue(valPtr));
 
-        if ((valPtr == NULL) || (*valPtr != ','))
+        if (valPtr == NULL)
         {
             return LE_FORMAT_ERROR;
         }
 
+        if (*valPtr != ',')
+        {
+            // The element doesn't exist if the array ends here.
+            return (*valPtr == ']') ? LE_NOT_FOUND : LE_FORMAT_ERROR;
+        }
+
         valPtr++;   // Skip ','
         valPtr = SkipWhitespace(valPtr);
     }
 
+    // The element doesn't exist if the array ends before it, and the input is malformed if
+    // it ends before the array does.
+    if (*valPtr == ']')
+    {
+        return LE_NOT_FOUND;
+    }
+
+    if (*valPtr == '\0')
+    {
+        return LE_FORMAT_ERROR;
+    }
+
     *resultPtrPtr = valPtr;
 
     return LE_OK;
@@ -443,7 +607,8 @@ static le_result_t GoToElement
 static le_result_t GoToMember
 (
     const char* valPtr,
-    const char* memberName,
+    const char* memberName,   ///< Member name (need not be null-terminated).
+    size_t nameLen,           ///< Length of the member name.
     const char** resultPtrPtr ///< [OUT] Ptr to where to put ptr to start of member if LE_OK rtrned.
 )
 //--------------------------------------------------------------------------------------------------
@@ -453,8 +618,6 @@ static le_result_t GoToMember
         return LE_FORMAT_ERROR;
     }
 
-    size_t nameLen = strlen(memberName);
-
     valPtr++;   // Skip '{'
     valPtr = SkipWhitespace(valPtr);
 
@@ -468,11 +631,20 @@ static le_result_t GoToMember
             valPtr = SkipWhitespace(valPtr + nameLen + 2);
             if (*valPtr != ':')
             {
-                LE_ERROR("Missing colon after JSON object member name '%s'.", memberName);
+                LE_ERROR("Missing colon after JSON object member name '%.*s'.",
+                         (int)nameLen,
+                         memberName);
+                return LE_FORMAT_ERROR;
+            }
+
+            // The input is malformed if it ends before the member's value.
+            valPtr = SkipWhitespace(valPtr + 1);
+            if (*valPtr == '\0')
+            {
                 return LE_FORMAT_ERROR;
             }
 
-            *resultPtrPtr = SkipWhitespace(valPtr + 1);
+            *resultPtrPtr = valPtr;
             return LE_OK;
         }
 
@@ -480,12 +652,18 @@ static le_result_t GoToMember
         valPtr = SkipWhitespace(SkipMember(valPtr));
 
         // Since we haven't found the member we are looking for yet, we hope to find a comma next,
-        // meaning there will be more members to follow.
-        if ((valPtr == NULL) || (*valPtr != ','))
+        // meaning there will be more members to follow.  If the object ends here instead, the
+        // member doesn't exist.
+        if (valPtr == NULL)
         {
             return LE_FORMAT_ERROR;
         }
 
+        if (*valPtr != ',')
+        {
+            return (*valPtr == '}') ? LE_NOT_FOUND : LE_FORMAT_ERROR;
+        }
+
         valPtr++;   // Skip ','
         valPtr = SkipWhitespace(valPtr);
     }
@@ -610,7 +788,7 @@ static le_result_t Find
                     goto badSpec;
                 }
 
-                le_result_t r = GoToMember(valPtr, memberName, &valPtr);
+                le_result_t r = GoToMember(valPtr, memberName, strlen(memberName), &valPtr);
                 if (r != LE_OK)
                 {
                     return r;
@@ -633,38 +811,171 @@ badSpec:
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Extract an object member or array element from a JSON data value, based on a given
- * extraction specifier.
+ * Find an object member or array element in a JSON data value, based on a compiled extraction
+ * specifier.  Scanning stops as soon as the target is found.
  *
- * The extraction specifiers look like "x" or "x.y" or "[3]" or "x[3].y", etc.
+ * @return
+ *  - LE_OK if successful,
+ *  - LE_FORMAT_ERROR if the original JSON input string is malformed,
+ *  - LE_NOT_FOUND if the thing specified in the extraction spec is not found in the JSON input.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FindCompiled
+(
+    const char* original,       ///< [IN] Original JSON string to extract from.
+    const json_Extraction_t* extractionPtr, ///< [IN] Compiled extraction specification.
+    const char** resultPtrPtr   ///< [OUT] Ptr to where the ptr to the value should go if LE_OK.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* valPtr = original;
+    size_t i;
+
+    for (i = 0; i < extractionPtr->stepCount; i++)
+    {
+        const json_ExtractionStep_t* stepPtr = &extractionPtr->steps[i];
+        le_result_t r;
+
+        if (*valPtr == '\0')
+        {
+            break;
+        }
+
+        if (stepPtr->nameLen == 0)
+        {
+            r = GoToElement(valPtr, stepPtr->index, &valPtr);
+        }
+        else
+        {
+            r = GoToMember(valPtr,
+                           extractionPtr->specPtr + stepPtr->nameOffset,
+                           stepPtr->nameLen,
+                           &valPtr);
+        }
+
+        if (r != LE_OK)
+        {
+            return r;
+        }
+    }
+
+    if ((i < extractionPtr->stepCount) || (*valPtr == '\0'))
+    {
+        LE_DEBUG("'%s' not found in JSON value '%s'.", extractionPtr->specPtr, original);
+        return LE_NOT_FOUND;
+    }
+
+    *resultPtrPtr = valPtr;
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compile an extraction specifier into a list of steps, so that the specifier doesn't have to be
+ * parsed again each time it is used.
  *
  * @return
  *  - LE_OK if successful
- *  - LE_FORMAT_ERROR if there's something wrong with the input JSON string.
  *  - LE_BAD_PARAMETER if there's something wrong with the extraction specification.
- *  - LE_NOT_FOUND if the thing we are trying to extract doesn't exist in the JSON input.
- *  - LE_OVERFLOW if the provided result buffer isn't big enough.
+ *  - LE_OVERFLOW if the specifier has more than JSON_MAX_EXTRACTION_STEPS steps.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t json_Extract
+le_result_t json_CompileExtraction
 (
-    char* resultBuffPtr,    ///< [OUT] Ptr to where to put the extracted JSON.
-    size_t resultBuffSize,  ///< [IN] Size of the result buffer, in bytes, including space for null.
-    const char* jsonValue,   ///< [IN] Original JSON string to extract from.
-    const char* extractionSpec, ///< [IN] the extraction specification.
-    json_DataType_t* dataTypePtr  ///< [OUT] Ptr to where to put the data type of extracted JSON
+    const char* extractionSpec,         ///< [IN] the extraction specification.
+    json_Extraction_t* extractionPtr    ///< [OUT] Ptr to where to put the compiled specifier.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    const char* valPtr;
+    const char* specPtr = extractionSpec;
 
-    le_result_t result = Find(jsonValue, extractionSpec, &valPtr);
+    extractionPtr->specPtr = extractionSpec;
+    extractionPtr->stepCount = 0;
 
-    if (result != LE_OK)
+    while (*specPtr != '\0')
     {
-        return result;
+        if (extractionPtr->stepCount >= JSON_MAX_EXTRACTION_STEPS)
+        {
+            return LE_OVERFLOW;
+        }
+
+        json_ExtractionStep_t* stepPtr = &extractionPtr->steps[extractionPtr->stepCount];
+
+        if (*specPtr == '[')
+        {
+            char* endPtr;
+            unsigned long index = strtoul(specPtr + 1, &endPtr, 10);
+            if ((endPtr == (specPtr + 1)) || (*endPtr != ']') || (index > UINT32_MAX))
+            {
+                goto badSpec;
+            }
+            specPtr = endPtr + 1;
+
+            stepPtr->nameOffset = 0;
+            stepPtr->nameLen = 0;
+            stepPtr->index = index;
+        }
+        else
+        {
+            if (*specPtr == '.')
+            {
+                specPtr++;
+            }
+
+            if (!isalpha(*specPtr))
+            {
+                goto badSpec;
+            }
+
+            const char* namePtr = specPtr;
+            while (isalnum(*specPtr) || (*specPtr == '_') || (*specPtr == '-'))
+            {
+                specPtr++;
+            }
+
+            if (((specPtr - extractionSpec) > UINT16_MAX) || ((specPtr - namePtr) > UINT16_MAX))
+            {
+                goto badSpec;
+            }
+
+            stepPtr->nameOffset = namePtr - extractionSpec;
+            stepPtr->nameLen = specPtr - namePtr;
+            stepPtr->index = 0;
+        }
+
+        extractionPtr->stepCount++;
     }
 
+    return LE_OK;
+
+badSpec:
+
+    LE_ERROR("Invalid JSON extraction spec '%s'.", extractionSpec);
+    return LE_BAD_PARAMETER;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy the JSON value found at a given position in a JSON string into a result buffer.
+ *
+ * @return
+ *  - LE_OK if successful
+ *  - LE_FORMAT_ERROR if there's something wrong with the input JSON string.
+ *  - LE_OVERFLOW if the provided result buffer isn't big enough.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CopyValue
+(
+    char* resultBuffPtr,    ///< [OUT] Ptr to where to put the extracted JSON.
+    size_t resultBuffSize,  ///< [IN] Size of the result buffer, in bytes, including space for null.
+    const char* jsonValue,   ///< [IN] Original JSON string the value was found in.
+    const char* valPtr,      ///< [IN] Ptr to the start of the value within jsonValue.
+    json_DataType_t* dataTypePtr  ///< [OUT] Ptr to where to put the data type of extracted JSON
+)
+//--------------------------------------------------------------------------------------------------
+{
     const char* endPtr = NULL;
 
     switch (*valPtr)
@@ -790,6 +1101,520 @@ le_result_t json_Extract
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Extract an object member or array element from a JSON data value, based on a given
+ * extraction specifier.
+ *
+ * The extraction specifiers look like "x" or "x.y" or "[3]" or "x[3].y", etc.
+ *
+ * @return
+ *  - LE_OK if successful
+ *  - LE_FORMAT_ERROR if there's something wrong with the input JSON string.
+ *  - LE_BAD_PARAMETER if there's something wrong with the extraction specification.
+ *  - LE_NOT_FOUND if the thing we are trying to extract doesn't exist in the JSON input.
+ *  - LE_OVERFLOW if the provided result buffer isn't big enough.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t json_Extract
+(
+    char* resultBuffPtr,    ///< [OUT] Ptr to where to put the extracted JSON.
+    size_t resultBuffSize,  ///< [IN] Size of the result buffer, in bytes, including space for null.
+    const char* jsonValue,   ///< [IN] Original JSON string to extract from.
+    const char* extractionSpec, ///< [IN] the extraction specification.
+    json_DataType_t* dataTypePtr  ///< [OUT] Ptr to where to put the data type of extracted JSON
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* valPtr;
+
+    le_result_t result = Find(jsonValue, extractionSpec, &valPtr);
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    return CopyValue(resultBuffPtr, resultBuffSize, jsonValue, valPtr, dataTypePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Extract an object member or array element from a JSON data value, based on an extraction
+ * specifier compiled by json_CompileExtraction().
+ *
+ * @return
+ *  - LE_OK if successful
+ *  - LE_FORMAT_ERROR if there's something wrong with the input JSON string.
+ *  - LE_NOT_FOUND if the thing we are trying to extract doesn't exist in the JSON input.
+ *  - LE_OVERFLOW if the provided result buffer isn't big enough.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t json_ExtractCompiled
+(
+    char* resultBuffPtr,    ///< [OUT] Ptr to where to put the extracted JSON.
+    size_t resultBuffSize,  ///< [IN] Size of the result buffer, in bytes, including space for null.
+    const char* jsonValue,   ///< [IN] Original JSON string to extract from.
+    const json_Extraction_t* extractionPtr, ///< [IN] the compiled extraction specification.
+    json_DataType_t* dataTypePtr  ///< [OUT] Ptr to where to put the data type of extracted JSON
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* valPtr;
+
+    le_result_t result = FindCompiled(jsonValue, extractionPtr, &valPtr);
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    return CopyValue(resultBuffPtr, resultBuffSize, jsonValue, valPtr, dataTypePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of a single pass over a JSON string serving several compiled extraction specifiers.
+ *
+ * Specifiers are identified by their index in the extractionPtrs array, and sets of them by bit
+ * masks.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* original;                           ///< Original JSON string being scanned.
+    const json_Extraction_t* const* extractionPtrs; ///< The compiled specifiers.
+    size_t count;                                   ///< Number of specifiers.
+    json_Span_t* spans;                             ///< Span found for each specifier.
+    uint32_t unresolvedMask;                        ///< Specifiers with no result yet.
+}
+MultiScan_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the result for those of a set of specifiers that don't have a result yet.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Resolve
+(
+    MultiScan_t* scanPtr,
+    uint32_t mask,          ///< The set of specifiers.
+    le_result_t result
+)
+//--------------------------------------------------------------------------------------------------
+{
+    mask &= scanPtr->unresolvedMask;
+
+    for (size_t i = 0; i < scanPtr->count; i++)
+    {
+        if (mask & (1u << i))
+        {
+            scanPtr->spans[i].result = result;
+        }
+    }
+
+    scanPtr->unresolvedMask &= ~mask;
+}
+
+
+static const char* ScanValue(MultiScan_t* scanPtr, const char* valPtr, size_t depth, uint32_t mask);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Scan the members of an object for the specifiers whose next step is a member name.
+ *
+ * @return Pointer to the first character after the object, or NULL on error.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* ScanObject
+(
+    MultiScan_t* scanPtr,
+    const char* valPtr,     ///< Ptr to the '{' starting the object.
+    size_t depth,           ///< Index of the step to be applied to this object.
+    uint32_t mask           ///< Specifiers to be served from inside this object.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t nameMask = 0;
+
+    for (size_t i = 0; i < scanPtr->count; i++)
+    {
+        if ((mask & (1u << i)) && (scanPtr->extractionPtrs[i]->steps[depth].nameLen != 0))
+        {
+            nameMask |= (1u << i);
+        }
+    }
+
+    // An array index can't be applied to an object.
+    Resolve(scanPtr, mask & ~nameMask, LE_FORMAT_ERROR);
+
+    valPtr = SkipWhitespace(valPtr + 1);   // Skip '{'
+
+    while (*valPtr == '"')
+    {
+        const char* namePtr = valPtr + 1;
+        const char* nameEndPtr = SkipString(valPtr);
+        if (nameEndPtr == NULL)
+        {
+            return NULL;
+        }
+        size_t nameLen = (nameEndPtr - namePtr) - 1;
+
+        // Find the specifiers that step into this member.  Only the first member with a given
+        // name is used, as in GoToMember().
+        uint32_t memberMask = 0;
+        for (size_t i = 0; i < scanPtr->count; i++)
+        {
+            if (nameMask & scanPtr->unresolvedMask & (1u << i))
+            {
+                const json_Extraction_t* extractionPtr = scanPtr->extractionPtrs[i];
+                const json_ExtractionStep_t* stepPtr = &extractionPtr->steps[depth];
+
+                if (   (stepPtr->nameLen == nameLen)
+                    && (memcmp(extractionPtr->specPtr + stepPtr->nameOffset,
+                               namePtr,
+                               nameLen) == 0)  )
+                {
+                    memberMask |= (1u << i);
+                }
+            }
+        }
+
+        valPtr = SkipWhitespace(nameEndPtr);
+        if (*valPtr != ':')
+        {
+            return NULL;
+        }
+        valPtr = SkipWhitespace(valPtr + 1);
+
+        if (memberMask != 0)
+        {
+            nameMask &= ~memberMask;
+            valPtr = ScanValue(scanPtr, valPtr, depth + 1, memberMask);
+        }
+        else
+        {
+            valPtr = SkipValue(valPtr);
+        }
+
+        if ((valPtr == NULL) || (scanPtr->unresolvedMask == 0))
+        {
+            return valPtr;
+        }
+
+        valPtr = SkipWhitespace(valPtr);
+        if (*valPtr == ',')
+        {
+            valPtr = SkipWhitespace(valPtr + 1);
+        }
+        else if (*valPtr != '}')
+        {
+            return NULL;
+        }
+    }
+
+    if (*valPtr != '}')
+    {
+        return NULL;
+    }
+
+    Resolve(scanPtr, nameMask, LE_NOT_FOUND);
+
+    return valPtr + 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Scan the elements of an array for the specifiers whose next step is an array index.
+ *
+ * @return Pointer to the first character after the array, or NULL on error.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* ScanArray
+(
+    MultiScan_t* scanPtr,
+    const char* valPtr,     ///< Ptr to the '[' starting the array.
+    size_t depth,           ///< Index of the step to be applied to this array.
+    uint32_t mask           ///< Specifiers to be served from inside this array.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t indexMask = 0;
+
+    for (size_t i = 0; i < scanPtr->count; i++)
+    {
+        if ((mask & (1u << i)) && (scanPtr->extractionPtrs[i]->steps[depth].nameLen == 0))
+        {
+            indexMask |= (1u << i);
+        }
+    }
+
+    // A member name can't be applied to an array.
+    Resolve(scanPtr, mask & ~indexMask, LE_FORMAT_ERROR);
+
+    valPtr = SkipWhitespace(valPtr + 1);   // Skip '['
+
+    for (uint32_t index = 0; *valPtr != ']'; index++)
+    {
+        uint32_t elementMask = 0;
+        for (size_t i = 0; i < scanPtr->count; i++)
+        {
+            if (   (indexMask & (1u << i))
+                && (scanPtr->extractionPtrs[i]->steps[depth].index == index)  )
+            {
+                elementMask |= (1u << i);
+            }
+        }
+
+        if (elementMask != 0)
+        {
+            indexMask &= ~elementMask;
+            valPtr = ScanValue(scanPtr, valPtr, depth + 1, elementMask);
+        }
+        else
+        {
+            valPtr = SkipValue(valPtr);
+        }
+
+        if ((valPtr == NULL) || (scanPtr->unresolvedMask == 0))
+        {
+            return valPtr;
+        }
+
+        valPtr = SkipWhitespace(valPtr);
+        if (*valPtr == ',')
+        {
+            valPtr = SkipWhitespace(valPtr + 1);
+        }
+        else if (*valPtr != ']')
+        {
+            return NULL;
+        }
+    }
+
+    Resolve(scanPtr, indexMask, LE_NOT_FOUND);
+
+    return valPtr + 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Scan a JSON value, recording its span for the specifiers that end at it and scanning inside it
+ * for the specifiers that have more steps.
+ *
+ * @return Pointer to the first character after the value, or NULL on error.  If all specifiers
+ *         have been resolved, scanning stops early and the pointer returned is not meaningful.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* ScanValue
+(
+    MultiScan_t* scanPtr,
+    const char* valPtr,     ///< Ptr to the first character of the value.
+    size_t depth,           ///< Number of steps that have been applied to get to this value.
+    uint32_t mask           ///< Specifiers to be served from this value.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t endMask = 0;
+    const char* endPtr;
+
+    for (size_t i = 0; i < scanPtr->count; i++)
+    {
+        if ((mask & (1u << i)) && (scanPtr->extractionPtrs[i]->stepCount == depth))
+        {
+            endMask |= (1u << i);
+        }
+    }
+
+    uint32_t deeperMask = mask & ~endMask;
+
+    if (deeperMask == 0)
+    {
+        endPtr = SkipValue(valPtr);
+    }
+    else if (*valPtr == '{')
+    {
+        endPtr = ScanObject(scanPtr, valPtr, depth, deeperMask);
+    }
+    else if (*valPtr == '[')
+    {
+        endPtr = ScanArray(scanPtr, valPtr, depth, deeperMask);
+    }
+    else
+    {
+        // Can't step inside anything other than an object or array.
+        Resolve(scanPtr, deeperMask, LE_FORMAT_ERROR);
+        endPtr = SkipValue(valPtr);
+    }
+
+    if ((endPtr != NULL) && (endMask != 0))
+    {
+        for (size_t i = 0; i < scanPtr->count; i++)
+        {
+            if (endMask & (1u << i))
+            {
+                scanPtr->spans[i].offset = valPtr - scanPtr->original;
+                scanPtr->spans[i].length = endPtr - valPtr;
+            }
+        }
+
+        Resolve(scanPtr, endMask, LE_OK);
+    }
+
+    return endPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the values for several compiled extraction specifiers in one pass over a JSON string.
+ *
+ * Each span's result is set to LE_OK if the value was found, LE_NOT_FOUND if it doesn't exist in
+ * the JSON input, or LE_FORMAT_ERROR if the JSON input is malformed before the value is reached.
+ * For well-formed JSON input, these are the same results that json_ExtractCompiled() returns
+ * for each specifier on its own.
+ * Buffer overflow is only detected when the value is copied out by json_CopySpan().
+ *
+ * @return
+ *  - LE_OK if the spans were filled in (check the result in each span).
+ *  - LE_OVERFLOW if count is greater than JSON_MAX_MULTI_EXTRACTIONS.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t json_ExtractMultiple
+(
+    const char* jsonValue,  ///< [IN] Original JSON string to extract from.
+    const json_Extraction_t* const extractionPtrs[], ///< [IN] the compiled specifications.
+    size_t count,           ///< [IN] Number of specifications.
+    json_Span_t spans[]     ///< [OUT] Where to put the span found for each specification.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (count > JSON_MAX_MULTI_EXTRACTIONS)
+    {
+        return LE_OVERFLOW;
+    }
+
+    MultiScan_t scan =
+    {
+        .original = jsonValue,
+        .extractionPtrs = extractionPtrs,
+        .count = count,
+        .spans = spans,
+        .unresolvedMask = (count == 32) ? UINT32_MAX : ((1u << count) - 1),
+    };
+
+    for (size_t i = 0; i < count; i++)
+    {
+        spans[i].offset = 0;
+        spans[i].length = 0;
+    }
+
+    uint32_t allMask = scan.unresolvedMask;
+
+    if (*jsonValue != '\0')
+    {
+        if (ScanValue(&scan, jsonValue, 0, allMask) == NULL)
+        {
+            LE_ERROR("Invalid content in JSON string '%s'.", jsonValue);
+            Resolve(&scan, allMask, LE_FORMAT_ERROR);
+        }
+    }
+
+    Resolve(&scan, allMask, LE_NOT_FOUND);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy the value found by json_ExtractMultiple() for one extraction specifier.
+ *
+ * @return
+ *  - LE_OK if successful
+ *  - LE_OVERFLOW if the provided result buffer isn't big enough.
+ *  - Otherwise, the result recorded in the span.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t json_CopySpan
+(
+    char* resultBuffPtr,    ///< [OUT] Ptr to where to put the extracted JSON.
+    size_t resultBuffSize,  ///< [IN] Size of the result buffer, in bytes, including space for null.
+    const char* jsonValue,   ///< [IN] Original JSON string the span was found in.
+    const json_Span_t* spanPtr,   ///< [IN] The span found by json_ExtractMultiple().
+    json_DataType_t* dataTypePtr  ///< [OUT] Ptr to where to put the data type of extracted JSON
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (spanPtr->result != LE_OK)
+    {
+        return spanPtr->result;
+    }
+
+    // The span was validated when it was found, so its first character gives its type.
+    const char* valPtr = jsonValue + spanPtr->offset;
+    size_t len = spanPtr->length;
+    json_DataType_t dataType;
+
+    switch (*valPtr)
+    {
+        case '{':
+
+            dataType = JSON_TYPE_OBJECT;
+            break;
+
+        case '[':
+
+            dataType = JSON_TYPE_ARRAY;
+            break;
+
+        case '"':
+
+            // Move inside the quotes.
+            dataType = JSON_TYPE_STRING;
+            valPtr++;
+            len -= 2;
+            break;
+
+        case 't':
+        case 'f':
+
+            dataType = JSON_TYPE_BOOLEAN;
+            break;
+
+        case 'n':
+
+            dataType = JSON_TYPE_NULL;
+            break;
+
+        default:
+
+            dataType = JSON_TYPE_NUMBER;
+            break;
+    }
+
+    if (len >= resultBuffSize)
+    {
+        return LE_OVERFLOW;
+    }
+    memcpy(resultBuffPtr, valPtr, len);
+    resultBuffPtr[len] = '\0';
+
+    if (dataTypePtr)
+    {
+        *dataTypePtr = dataType;
+    }
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Convert a JSON value into a Boolean value.
@@ -15,6 +15,13 @@
  *
  * The extraction specifiers look like "x" or "x.y" or "[3]" or "x[3].y", etc.
  *
+ * If the same specifier is used for many extractions, it can be compiled once using
+ * json_CompileExtraction(), and the result passed to json_ExtractCompiled() instead.
+ *
+ * Several compiled specifiers can be served from a single pass over the same JSON string using
+ * json_ExtractMultiple(), which finds the span of each extracted value.  json_CopySpan() then
+ * copies out the value found for one of them.
+ *
  * json_Extract() will tell you the data type of the thing that was extracted.  The following
  * functions can then be used to convert Boolean value strings or numbers into cardinal C data
  * types:
@@ -61,6 +68,56 @@ typedef enum
 json_DataType_t;
 
 
+/// Maximum number of steps (member names or array indices) in a compiled extraction specifier.
+#define JSON_MAX_EXTRACTION_STEPS   16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * One step of a compiled extraction specifier: go to an object member or to an array element.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint16_t nameOffset;    ///< Offset of the member name in the specifier.
+    uint16_t nameLen;       ///< Length of the member name, or 0 if this step is an array index.
+    uint32_t index;         ///< Array index (only if nameLen is 0).
+}
+json_ExtractionStep_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An extraction specifier, compiled by json_CompileExtraction().
+ *
+ * @warning The specifier string that it was compiled from must not change or be freed while this
+ *          is in use, because the member names are not copied.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* specPtr;    ///< The specifier the steps were compiled from.
+    size_t stepCount;       ///< Number of steps.
+    json_ExtractionStep_t steps[JSON_MAX_EXTRACTION_STEPS]; ///< The steps, in order.
+}
+json_Extraction_t;
+
+
+/// Maximum number of compiled specifiers that can be served by one json_ExtractMultiple() pass.
+#define JSON_MAX_MULTI_EXTRACTIONS  32
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Where, in the original JSON string, the value found for an extraction specifier is.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_result_t result;     ///< LE_OK if found, otherwise the reason why json_Extract() would fail.
+    uint32_t offset;        ///< Offset of the first byte of the value (only if result is LE_OK).
+    uint32_t length;        ///< Length of the value, in bytes (only if result is LE_OK).
+}
+json_Span_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Extract an object member or array element from a JSON data value, based on a given
@@ -86,6 +143,90 @@ LE_SHARED le_result_t json_Extract
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compile an extraction specifier into a list of steps, so that the specifier doesn't have to be
+ * parsed again each time it is used.
+ *
+ * @return
+ *  - LE_OK if successful
+ *  - LE_BAD_PARAMETER if there's something wrong with the extraction specification.
+ *  - LE_OVERFLOW if the specifier has more than JSON_MAX_EXTRACTION_STEPS steps.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t json_CompileExtraction
+(
+    const char* extractionSpec,         ///< [IN] the extraction specification.
+    json_Extraction_t* extractionPtr    ///< [OUT] Ptr to where to put the compiled specifier.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Extract an object member or array element from a JSON data value, based on an extraction
+ * specifier compiled by json_CompileExtraction().
+ *
+ * @return
+ *  - LE_OK if successful
+ *  - LE_FORMAT_ERROR if there's something wrong with the input JSON string.
+ *  - LE_NOT_FOUND if the thing we are trying to extract doesn't exist in the JSON input.
+ *  - LE_OVERFLOW if the provided result buffer isn't big enough.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t json_ExtractCompiled
+(
+    char* resultBuffPtr,    ///< [OUT] Ptr to where to put the extracted JSON.
+    size_t resultBuffSize,  ///< [IN] Size of the result buffer, in bytes, including space for null.
+    const char* jsonValue,   ///< [IN] Original JSON string to extract from.
+    const json_Extraction_t* extractionPtr, ///< [IN] the compiled extraction specification.
+    json_DataType_t* dataTypePtr  ///< [OUT] Ptr to where to put the data type of extracted JSON
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the values for several compiled extraction specifiers in one pass over a JSON string.
+ *
+ * Each span's result is set to LE_OK if the value was found, LE_NOT_FOUND if it doesn't exist in
+ * the JSON input, or LE_FORMAT_ERROR if the JSON input is malformed before the value is reached.
+ * For well-formed JSON input, these are the same results that json_ExtractCompiled() returns
+ * for each specifier on its own.
+ * Buffer overflow is only detected when the value is copied out by json_CopySpan().
+ *
+ * @return
+ *  - LE_OK if the spans were filled in (check the result in each span).
+ *  - LE_OVERFLOW if count is greater than JSON_MAX_MULTI_EXTRACTIONS.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t json_ExtractMultiple
+(
+    const char* jsonValue,  ///< [IN] Original JSON string to extract from.
+    const json_Extraction_t* const extractionPtrs[], ///< [IN] the compiled specifications.
+    size_t count,           ///< [IN] Number of specifications.
+    json_Span_t spans[]     ///< [OUT] Where to put the span found for each specification.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy the value found by json_ExtractMultiple() for one extraction specifier.
+ *
+ * @return
+ *  - LE_OK if successful
+ *  - LE_OVERFLOW if the provided result buffer isn't big enough.
+ *  - Otherwise, the result recorded in the span.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t json_CopySpan
+(
+    char* resultBuffPtr,    ///< [OUT] Ptr to where to put the extracted JSON.
+    size_t resultBuffSize,  ///< [IN] Size of the result buffer, in bytes, including space for null.
+    const char* jsonValue,   ///< [IN] Original JSON string the span was found in.
+    const json_Span_t* spanPtr,   ///< [IN] The span found by json_ExtractMultiple().
+    json_DataType_t* dataTypePtr  ///< [OUT] Ptr to where to put the data type of extracted JSON
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Convert a JSON value into a Boolean value.
@@ -17,6 +17,16 @@
 /// Filter bitmask for all possible filters.
 #define ALL_FILTERS     (LIVE_FILTERS | SNAPSHOT_FILTER_DELETED)
 
+/// Number of bytes of formatted output to accumulate before writing it out.  This can be overridden
+/// in the .cdef.
+#ifndef DHUB_JSON_FORMATTER_BUFFER_BYTES
+#define DHUB_JSON_FORMATTER_BUFFER_BYTES    4096
+#endif
+
+/// Largest output of a single formatter step, which is a string or JSON value plus two potential
+/// quotation marks.
+#define MAX_STEP_OUTPUT_BYTES   (HUB_MAX_STRING_BYTES + 2)
+
 /// Internal formatter states.
 typedef enum
 {
@@ -33,18 +43,25 @@ typedef enum
 typedef struct JsonFormatter
 {
     snapshot_Formatter_t    base;       ///< Base type containing tree handling callbacks.
-    char                    buffer[HUB_MAX_STRING_BYTES + 2];   ///< Buffer for preparing formatted
-                                                                ///< output.  Two extra bytes for
-                                                                ///< potential quotation marks.
+    char                    buffer[DHUB_JSON_FORMATTER_BUFFER_BYTES + MAX_STEP_OUTPUT_BYTES];
+                                        ///< Buffer accumulating formatted output.  Room for the
+                                        ///< output of one more step is always kept beyond the
+                                        ///< flushing threshold.
     size_t                  next;       ///< Offset of the next character to send.
     size_t                  available;  ///< Number of bytes available to be sent.
     bool                    needsComma; ///< Does the next item output need to prepend a comma?
     bool                    isRoot;     ///< Is the next node output the root node?
     JsonFormatterState_t    nextState;  ///< Next state to transition to once currently buffered
                                         ///< data is sent.
-    le_fdMonitor_Ref_t      monitor;    ///< FD monitor for output stream.
+    le_fdMonitor_Ref_t      monitor;    ///< FD monitor for output stream (NULL if the
+                                        ///< snapshot is written to shared memory).
+    bool                    isOpen;     ///< Is the formatter still open?
 } JsonFormatter_t;
 
+/// Pool of JSON formatter instances, enough for every snapshot session to be using one.
+static le_mem_PoolRef_t JsonFormatterPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(JsonFormatterPool, DHUB_SNAPSHOT_MAX_SESSIONS, sizeof(JsonFormatter_t));
+
 //--------------------------------------------------------------------------------------------------
 /*
  * Callback for an internal formatter state machine step.
@@ -67,8 +84,7 @@ static void Step(JsonFormatter_t *jsonFormatter);
 //--------------------------------------------------------------------------------------------------
 static int SendData
 (
-    JsonFormatter_t *jsonFormatter, ///< Formatter instance.
-    int              stream         ///< Output stream FD.
+    JsonFormatter_t *jsonFormatter  ///< Formatter instance.
 )
 {
     const char  *start = &jsonFormatter->buffer[jsonFormatter->next];
@@ -80,7 +96,7 @@ static int SendData
         return 1;
     }
 
-    count = le_fd_Write(stream, start, jsonFormatter->available);
+    count = snapshot_Write(&jsonFormatter->base, start, jsonFormatter->available);
     if (count < 0)
     {
         if (EAGAIN == errno)
@@ -97,7 +113,7 @@ static int SendData
     }
     else if (count < (ssize_t) jsonFormatter->available)
     {
-        LE_DEBUG("Sent some (%d bytes): %*s", (int) count, (int) count, start);
+        LE_DEBUG("Sent some (%d bytes): %.*s", (int) count, (int) count, start);
 
         // Didn't send all of the available data.
         jsonFormatter->next += count;
@@ -108,12 +124,15 @@ static int SendData
     else
     {
         LE_ASSERT(count == (ssize_t) jsonFormatter->available);
-        LE_DEBUG("Sent all (%d bytes): %*s", (int) count, (int) count, start);
+        LE_DEBUG("Sent all (%d bytes): %.*s", (int) count, (int) count, start);
 
         // We've sent everything in the buffer.
         jsonFormatter->next = 0;
         jsonFormatter->available = 0;
-        le_fdMonitor_Disable(jsonFormatter->monitor, POLLOUT);
+        if (jsonFormatter->monitor != NULL)
+        {
+            le_fdMonitor_Disable(jsonFormatter->monitor, POLLOUT);
+        }
         return 0;
     }
 }
@@ -126,7 +145,6 @@ static int SendData
 static void HandleEvents
 (
     JsonFormatter_t *jsonFormatter, ///< Formatter instance.
-    int              fd,            ///< Output stream file descriptor.
     short            events         ///< FD event bitfield.
 )
 {
@@ -136,11 +154,11 @@ static void HandleEvents
     if (events & POLLOUT)
     {
         // Can send more data, so do it.
-        status = SendData(jsonFormatter, fd);
+        status = SendData(jsonFormatter);
         if (status < 0)
         {
             // Error sending data, so abort the snapshot.
-            snapshot_End(LE_CLOSED);
+            snapshot_End(&jsonFormatter->base, LE_CLOSED);
             return;
         }
         else if (status == 0)
@@ -157,12 +175,12 @@ static void HandleEvents
     if (events & POLLHUP)
     {
         // Stream was closed for some reason, nothing we can do except terminate the snapshot.
-        snapshot_End(LE_CLOSED);
+        snapshot_End(&jsonFormatter->base, LE_CLOSED);
     }
     else if (events & ~POLLOUT)
     {
         // Any other condition is an error, so terminate the snapshot.
-        snapshot_End(LE_FAULT);
+        snapshot_End(&jsonFormatter->base, LE_FAULT);
     }
 }
 
@@ -179,8 +197,10 @@ static void StreamHandler
 {
     JsonFormatter_t *jsonFormatter = le_fdMonitor_GetContextPtr();
 
+    LE_UNUSED(fd);
+
     LE_DEBUG("Stream event");
-    HandleEvents(jsonFormatter, fd, events);
+    HandleEvents(jsonFormatter, events);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -194,12 +214,15 @@ static void ExplicitSendHandler
     void            *unused         ///< Unused.
 )
 {
-    int fd = le_fdMonitor_GetFd(jsonFormatter->monitor);
-
     LE_UNUSED(unused);
 
-    LE_DEBUG("Explicit send");
-    HandleEvents(jsonFormatter, fd, POLLOUT);
+    // The snapshot may have ended while this was queued.
+    if (jsonFormatter->isOpen)
+    {
+        LE_DEBUG("Explicit send");
+        HandleEvents(jsonFormatter, POLLOUT);
+    }
+    le_mem_Release(jsonFormatter);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -212,67 +235,77 @@ static void EnableSend
     JsonFormatter_t *jsonFormatter ///< Formatter instance.
 )
 {
-    le_fdMonitor_Enable(jsonFormatter->monitor, POLLOUT);
+    if (jsonFormatter->monitor != NULL)
+    {
+        le_fdMonitor_Enable(jsonFormatter->monitor, POLLOUT);
+    }
 
     // Explicitly trigger an attempt to send, since the stream might be sitting ready and therefore
-    // not generate a new POLLOUT.
+    // not generate a new POLLOUT.  The queued function holds a reference to the instance.
+    le_mem_AddRef(jsonFormatter);
     le_event_QueueFunction((le_event_DeferredFunc_t) &ExplicitSendHandler, jsonFormatter, NULL);
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Append a string to the current contents of the output buffer.
+ * Carry on once a formatter step has buffered its output.  The accumulated output is only written
+ * out once the buffer may not have room for the next step; until then the state machine proceeds
+ * straight away.
  */
 //--------------------------------------------------------------------------------------------------
-static void AppendString
+static void Proceed
 (
-    JsonFormatter_t *jsonFormatter, ///< Formatter instance.
-    bool             prependComma,  ///< Prepend a comma to the value being added?
-    const char      *str            ///< String to append to the buffer.  It is expected that this
-                                    ///< is sized so as to avoid overflowing the buffer.
+    JsonFormatter_t *jsonFormatter ///< Formatter instance.
 )
 {
-    // We should never be handed a combined string larger than the Data Hub's maximum string
-    // size + 2, so an overflow should not occur and we can assert if it does.
-    if (prependComma)
+    if (jsonFormatter->available > DHUB_JSON_FORMATTER_BUFFER_BYTES)
     {
-        LE_ASSERT_OK(
-            le_utf8_Append(jsonFormatter->buffer, ",", sizeof(jsonFormatter->buffer), NULL)
-        );
+        EnableSend(jsonFormatter);
+    }
+    else
+    {
+        Step(jsonFormatter);
     }
-    LE_ASSERT_OK(le_utf8_Append(jsonFormatter->buffer, str, sizeof(jsonFormatter->buffer), NULL));
-
-    jsonFormatter->available = strlen(jsonFormatter->buffer);
-    EnableSend(jsonFormatter);
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Write a string to the the output buffer.
+ * Append a string to the current contents of the output buffer.
  */
 //--------------------------------------------------------------------------------------------------
-static void BufferString
+static void AppendString
 (
     JsonFormatter_t *jsonFormatter, ///< Formatter instance.
     bool             prependComma,  ///< Prepend a comma to the value being added?
-    const char      *str            ///< String to write to the buffer.  It is expected that this
+    const char      *str            ///< String to append to the buffer.  It is expected that this
                                     ///< is sized so as to avoid overflowing the buffer.
 )
 {
+    size_t length = strlen(str);
+
+    // Output is only added once everything buffered before has been sent, and a single step never
+    // outputs more than MAX_STEP_OUTPUT_BYTES, so an overflow should not occur and we can assert if
+    // it does.
     LE_ASSERT(jsonFormatter->next == 0);
-    LE_ASSERT(jsonFormatter->available == 0);
+    LE_ASSERT(
+        length + (prependComma ? 1 : 0) <= sizeof(jsonFormatter->buffer) - jsonFormatter->available
+    );
 
-    jsonFormatter->buffer[0] = '\0';
-    AppendString(jsonFormatter, prependComma, str);
+    if (prependComma)
+    {
+        jsonFormatter->buffer[jsonFormatter->available++] = ',';
+    }
+    memcpy(&jsonFormatter->buffer[jsonFormatter->available], str, length);
+    jsonFormatter->available += length;
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Write a formatted string to the the output buffer.  It is expected that all inputs will be sized
- * so as to avoid overflowing the buffer.
+ * Append a formatted string to the output buffer.  It is expected that all inputs will be sized so
+ * as to avoid overflowing the buffer.
  */
 //--------------------------------------------------------------------------------------------------
-static void BufferFormatted
+static void AppendFormatted
 (
     JsonFormatter_t *jsonFormatter, ///< Formatter instance.
     bool             prependComma,  ///< Prepend a comma to the value being added?
@@ -281,36 +314,25 @@ static void BufferFormatted
 )
 {
     int     result;
-    size_t  offset = 0;
+    size_t  space;
     va_list args;
 
     LE_ASSERT(jsonFormatter->next == 0);
-    LE_ASSERT(jsonFormatter->available == 0);
 
     if (prependComma)
     {
-        jsonFormatter->buffer[0] = ',';
-        ++offset;
+        AppendString(jsonFormatter, false, ",");
     }
 
+    space = sizeof(jsonFormatter->buffer) - jsonFormatter->available;
     va_start(args, format);
-    result = vsnprintf(
-        jsonFormatter->buffer + offset,
-        sizeof(jsonFormatter->buffer) - offset,
-        format,
-        args
-    );
+    result = vsnprintf(&jsonFormatter->buffer[jsonFormatter->available], space, format, args);
     va_end(args);
 
     // By design the buffer should always be large enough to accommodate the resulting string, so we
     // can assert here.
-    LE_ASSERT(0 < result && result <= (int) (sizeof(jsonFormatter->buffer) - offset));
-    jsonFormatter->available = result;
-    if (prependComma)
-    {
-        jsonFormatter->available += 1;
-    }
-    EnableSend(jsonFormatter);
+    LE_ASSERT(0 < result && result < (int) space);
+    jsonFormatter->available += result;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -348,24 +370,26 @@ static void StartTree
     if (formatter->filter & LIVE_FILTERS)
     {
         // Buffer is sized such that it should never overflow, and the referenced nodes must exist.
-        LE_ASSERT(resTree_GetPath(path, sizeof(path), resTree_GetRoot(), snapshot_GetNode()) >= 0);
+        LE_ASSERT(resTree_GetPath(path, sizeof(path), resTree_GetRoot(),
+                                  snapshot_GetNode(formatter)) >= 0);
 
-        BufferFormatted(
+        AppendFormatted(
             jsonFormatter,
             false,
-            "{\"ts\":%lf,\"root\":\"%s\",\"upserted\":",
-            snapshot_GetTimestamp(),
-            path
+            "{\"ts\":%lf,\"root\":\"%s\",%s\"upserted\":",
+            snapshot_GetTimestamp(formatter),
+            path,
+            (snapshot_HasLostDeletions(formatter) ? "\"lostDeletions\":true," : "")
         );
     }
     else
     {
-        BufferString(jsonFormatter, true, "\"deleted\":");
+        AppendString(jsonFormatter, true, "\"deleted\":");
     }
 
-    // Now we wait for the buffer to drain and call snapshot_Step() when it is done.
     jsonFormatter->isRoot = true;
     jsonFormatter->nextState = STATE_SNAPSHOT_STEP;
+    Proceed(jsonFormatter);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -396,9 +420,10 @@ static void BeginNode
         // This node is a child of another, so open the object key entry and follow up with the node
         // name.
         LE_DEBUG("Starting child node");
-        BufferString(jsonFormatter, jsonFormatter->needsComma, "\"");
+        AppendString(jsonFormatter, jsonFormatter->needsComma, "\"");
         jsonFormatter->isRoot = false;
         jsonFormatter->nextState = STATE_NODE_NAME;
+        Proceed(jsonFormatter);
     }
 }
 
@@ -412,14 +437,15 @@ static void NodeName
     JsonFormatter_t *jsonFormatter ///< Formatter instance.
 )
 {
-    const char *name = resTree_GetEntryName(snapshot_GetNode());
+    const char *name = snapshot_GetNodeName(&jsonFormatter->base);
 
     LE_ASSERT(jsonFormatter->base.filter & ALL_FILTERS);
 
     LE_DEBUG("Output node name: '%s'", name);
-    BufferString(jsonFormatter, false, name);
+    AppendString(jsonFormatter, false, name);
     jsonFormatter->needsComma = false;
     jsonFormatter->nextState = STATE_NODE_OPEN;
+    Proceed(jsonFormatter);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -432,15 +458,14 @@ static void NodeOpen
     JsonFormatter_t *jsonFormatter ///< Formatter instance.
 )
 {
-    resTree_EntryRef_t  node = snapshot_GetNode();
-    admin_EntryType_t   entryType = resTree_GetEntryType(node);
+    admin_EntryType_t entryType = snapshot_GetNodeType(&jsonFormatter->base);
 
     LE_ASSERT(jsonFormatter->base.filter & ALL_FILTERS);
 
     LE_DEBUG("Open node contents");
 
     // Non-root node is preceded by `"<name>` so close that off and open the node object.
-    BufferFormatted(jsonFormatter, false, "%s{", (jsonFormatter->isRoot ? "" : "\":"));
+    AppendFormatted(jsonFormatter, false, "%s{", (jsonFormatter->isRoot ? "" : "\":"));
 
     jsonFormatter->isRoot = false;
     jsonFormatter->needsComma = false;
@@ -456,7 +481,8 @@ static void NodeOpen
         case ADMIN_ENTRY_TYPE_OUTPUT:
         case ADMIN_ENTRY_TYPE_OBSERVATION:
         case ADMIN_ENTRY_TYPE_PLACEHOLDER:
-            if ((jsonFormatter->base.filter & LIVE_FILTERS) && snapshot_IsTimely(node))
+            if (   (jsonFormatter->base.filter & LIVE_FILTERS)
+                && snapshot_IsTimely(&jsonFormatter->base, snapshot_GetNode(&jsonFormatter->base)))
             {
                 // These node types have additional fields of their own, so start the sequence of
                 // outputting those.
@@ -473,6 +499,7 @@ static void NodeOpen
             LE_FATAL("Unexpected entry type: %d", entryType);
             break;
     }
+    Proceed(jsonFormatter);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -486,7 +513,7 @@ static void NodeValues
 )
 {
     char                buffer[64]; // Sized for stringified boolean or double.
-    resTree_EntryRef_t  node = snapshot_GetNode();
+    resTree_EntryRef_t  node = snapshot_GetNode(&jsonFormatter->base);
     dataSample_Ref_t    sample = resTree_GetCurrentValue(node);
     io_DataType_t       dataType = resTree_GetDataType(node);
 
@@ -497,7 +524,7 @@ static void NodeValues
     // This function should never be called when the current value is unset.
     LE_ASSERT(sample != NULL);
 
-    BufferFormatted(
+    AppendFormatted(
         jsonFormatter,
         false,
         "\"type\":%u,\"ts\":%lf,\"mandatory\":%s,\"new\":%s",
@@ -531,6 +558,7 @@ static void NodeValues
             jsonFormatter->nextState = STATE_NODE_VALUE_BODY;
             break;
     }
+    Proceed(jsonFormatter);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -543,7 +571,8 @@ static void NodeValueBody
     JsonFormatter_t *jsonFormatter ///< Formatter instance.
 )
 {
-    resTree_EntryRef_t  node = snapshot_GetNode();
+    char               *body;
+    resTree_EntryRef_t  node = snapshot_GetNode(&jsonFormatter->base);
     dataSample_Ref_t    sample = resTree_GetCurrentValue(node);
     io_DataType_t       dataType = resTree_GetDataType(node);
 
@@ -558,19 +587,21 @@ static void NodeValueBody
     // This function should never be called when the current value is unset.
     LE_ASSERT(sample != NULL);
 
-    // The string/JSON copied in should never be larger than sizeof(jsonFormatter->buffer), so we
-    // can assert if this overflows.
+    // The string/JSON copied in should never be larger than MAX_STEP_OUTPUT_BYTES, which is always
+    // left free in the buffer, so we can assert if this overflows.
+    LE_ASSERT(jsonFormatter->next == 0);
+    body = &jsonFormatter->buffer[jsonFormatter->available];
     LE_ASSERT_OK(dataSample_ConvertToJson(
         sample,
         dataType,
-        jsonFormatter->buffer,
-        sizeof(jsonFormatter->buffer)
+        body,
+        sizeof(jsonFormatter->buffer) - jsonFormatter->available
     ));
 
-    jsonFormatter->available = strlen(jsonFormatter->buffer);
+    jsonFormatter->available += strlen(body);
     jsonFormatter->needsComma = true;
     jsonFormatter->nextState = STATE_SNAPSHOT_STEP;
-    EnableSend(jsonFormatter);
+    Proceed(jsonFormatter);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -588,11 +619,11 @@ static void EndObject
     LE_ASSERT(formatter->filter & ALL_FILTERS);
 
     LE_DEBUG("Closing object");
-    BufferString(jsonFormatter, false, "}");
+    AppendString(jsonFormatter, false, "}");
 
-    // Now we wait for the buffer to drain and call snapshot_Step() when it is done.
     jsonFormatter->needsComma = true;
     jsonFormatter->nextState = STATE_SNAPSHOT_STEP;
+    Proceed(jsonFormatter);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -624,10 +655,12 @@ static void EndTree
     }
     else
     {
-        BufferString(jsonFormatter, false, "}");
+        AppendString(jsonFormatter, false, "}");
 
-        // Now we wait for the buffer to drain and call snapshot_Step() when it is done.
+        // This is the end of the document, so write out everything that is left and call
+        // snapshot_Step() when it is done.
         jsonFormatter->needsComma = false;
+        EnableSend(jsonFormatter);
     }
 }
 
@@ -644,7 +677,13 @@ static void Close
     JsonFormatter_t *jsonFormatter = CONTAINER_OF(formatter, JsonFormatter_t, base);
 
     LE_DEBUG("Closing formatter");
-    le_fdMonitor_Delete(jsonFormatter->monitor);
+    if (jsonFormatter->monitor != NULL)
+    {
+        le_fdMonitor_Delete(jsonFormatter->monitor);
+        jsonFormatter->monitor = NULL;
+    }
+    jsonFormatter->isOpen = false;
+    le_mem_Release(jsonFormatter);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -657,10 +696,8 @@ static void SnapshotStep
     JsonFormatter_t *jsonFormatter ///< Formatter instance.
 )
 {
-    LE_UNUSED(jsonFormatter);
-
     LE_DEBUG("Stepping snapshot state machine");
-    snapshot_Step();
+    snapshot_Step(&jsonFormatter->base);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -707,55 +744,71 @@ static void Step
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Initialise and return the JSON snapshot formatter instance.
+ * Initialise and return a JSON snapshot formatter instance.
  *
- * @return LE_OK (the JSON formatter initialisation does not generate any errors).
+ * @return
+ *      - LE_OK on success.
+ *      - LE_NO_MEMORY if every instance is already in use.
  */
 //--------------------------------------------------------------------------------------------------
 le_result_t GetJsonSnapshotFormatter
 (
     uint32_t                  flags,    ///< [IN]  Flags that were passed to the snapshot request.
-    int                       stream,   ///< [IN]  File descriptor to write formatted output to.
+    int                       stream,   ///< [IN]  File descriptor to write formatted output to, or
+                                        ///<       -1 if the snapshot is written to shared memory.
     snapshot_Formatter_t    **formatter ///< [OUT] Returned formatter instance.
 )
 {
-    static JsonFormatter_t jsonFormatter =
-    {
-        {
-            .startTree  = &StartTree,
-            .beginNode  = &BeginNode,
-            .endNode    = &EndObject,
-            .endTree    = &EndTree,
-            .close      = &Close
-        }
-    };
+    JsonFormatter_t *jsonFormatter;
 
     LE_UNUSED(flags);
 
     LE_ASSERT(formatter != NULL);
-    *formatter = &jsonFormatter.base;
 
-    memset(jsonFormatter.buffer, 0, sizeof(jsonFormatter.buffer));
-    jsonFormatter.next          = 0;
-    jsonFormatter.available     = 0;
-    jsonFormatter.needsComma    = false;
-    jsonFormatter.isRoot        = true;
-    jsonFormatter.nextState     = STATE_START;
+    // The pool holds one instance per snapshot session, so this only fails if one is leaked.
+    jsonFormatter = le_mem_TryAlloc(JsonFormatterPool);
+    if (jsonFormatter == NULL)
+    {
+        LE_ERROR("No JSON formatter instance available");
+        return LE_NO_MEMORY;
+    }
+    *formatter = &jsonFormatter->base;
+
+    memset(&jsonFormatter->base, 0, sizeof(jsonFormatter->base));
+    jsonFormatter->base.startTree   = &StartTree;
+    jsonFormatter->base.beginNode   = &BeginNode;
+    jsonFormatter->base.endNode     = &EndObject;
+    jsonFormatter->base.endTree     = &EndTree;
+    jsonFormatter->base.close       = &Close;
 
-    jsonFormatter.base.filter   = LIVE_FILTERS;
-    jsonFormatter.base.scan     = true;
+    memset(jsonFormatter->buffer, 0, sizeof(jsonFormatter->buffer));
+    jsonFormatter->next         = 0;
+    jsonFormatter->available    = 0;
+    jsonFormatter->needsComma   = false;
+    jsonFormatter->isRoot       = true;
+    jsonFormatter->nextState    = STATE_START;
+
+    jsonFormatter->base.filter  = LIVE_FILTERS;
+    jsonFormatter->base.scan    = true;
 
     LE_DEBUG("JSON formatter transition: -> STATE_START");
 
-    // Configure event handler for outputting formatted data.
-    jsonFormatter.monitor = le_fdMonitor_Create(
-                                "JsonSnapshotStream",
-                                stream,
-                                &StreamHandler,
-                                POLLOUT
-                            );
-    le_fdMonitor_SetContextPtr(jsonFormatter.monitor, &jsonFormatter);
-    le_fdMonitor_Disable(jsonFormatter.monitor, POLLOUT);
+    jsonFormatter->isOpen = true;
+
+    // Configure event handler for outputting formatted data.  Output written to shared memory never
+    // has to wait, so there is nothing to monitor in that case.
+    jsonFormatter->monitor = NULL;
+    if (stream >= 0)
+    {
+        jsonFormatter->monitor = le_fdMonitor_Create(
+                                    "JsonSnapshotStream",
+                                    stream,
+                                    &StreamHandler,
+                                    POLLOUT
+                                );
+        le_fdMonitor_SetContextPtr(jsonFormatter->monitor, jsonFormatter);
+        le_fdMonitor_Disable(jsonFormatter->monitor, POLLOUT);
+    }
 
     return LE_OK;
 }
@@ -764,6 +817,10 @@ le_result_t GetJsonSnapshotFormatter
 /// Component initialisation.
 COMPONENT_INIT
 {
-    // Do nothing.
+    JsonFormatterPool = le_mem_InitStaticPool(
+                            JsonFormatterPool,
+                            DHUB_SNAPSHOT_MAX_SESSIONS,
+                            sizeof(JsonFormatter_t)
+                        );
 }
 #endif
@@ -25,13 +25,23 @@
 /// Filter bitmask for all possible filters.
 #define ALL_FILTERS     (LIVE_FILTERS | SNAPSHOT_FILTER_DELETED)
 
+/// Default number of nodes whose metadata encoding can be cached.  Nodes beyond that are encoded
+/// in full on every snapshot.  This can be overridden in the .cdef.
+#define DEFAULT_METADATA_CACHE_POOL_SIZE 64
+
+/// Longest encoding of a node's path, the opening of its map and its metadata.
+#define MAX_NODE_HEADER_BYTES   (HUB_MAX_RESOURCE_PATH_BYTES + 16)
+
+/// Longest encoding of a default value that is cached.  Longer ones are encoded on every snapshot.
+#define MAX_CACHED_DEFAULT_BYTES    32
+
 /// Internal formatter states.
 typedef enum
 {
     STATE_START = 0,            ///< Beginning of the document.
     STATE_SNAPSHOT_STEP,        ///< Trigger next outer state machine step.
-    STATE_NODE_NAME,            ///< Output node name.
-    STATE_NODE_OPEN,            ///< Output node opening and metadata.
+    STATE_NODE_NAME,            ///< Output node name, opening and metadata.
+    STATE_NODE_OPEN,            ///< Move on to the node's values, if any.
     STATE_NODE_VALUES,          ///< Output node timestamp and format for value.
     STATE_NODE_VALUE_BODY,      ///< Output node value.
     STATE_NODE_DEFAULT,         ///< Output formatting for default value.
@@ -55,9 +65,35 @@ typedef struct OctaveFormatter
     bool                    skipNode;       ///< Does formatter need to skip content for this node?
     OctaveFormatterState_t  nextState;      ///< Next state to transition to once currently buffered
                                             ///< data is sent.
-    le_fdMonitor_Ref_t      monitor;        ///< FD monitor for output stream.
+    le_fdMonitor_Ref_t      monitor;        ///< FD monitor for output stream (NULL if the
+                                            ///< snapshot is written to shared memory).
+    bool                    isOpen;         ///< Is the formatter still open?
 } OctaveFormatter_t;
 
+/// Pool of Octave formatter instances, enough for every snapshot session to be using one.
+static le_mem_PoolRef_t OctaveFormatterPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(OctaveFormatterPool, DHUB_SNAPSHOT_MAX_SESSIONS,
+                          sizeof(OctaveFormatter_t));
+
+/// Encoded metadata of a node, cached on its resource (see resTree_SetMetadataCache()).  The
+/// resource drops it when its default value changes, and it is replaced when the node's entry type,
+/// data type or mandatory flag no longer match.  Paths are relative to the snapshot root, so it is
+/// only used by snapshots of the whole tree.
+typedef struct
+{
+    int64_t     metadata;                                   ///< Metadata the header encodes.
+    size_t      headerLen;                                  ///< Number of bytes in header.
+    uint8_t     header[MAX_NODE_HEADER_BYTES];              ///< Path, map opening and metadata.
+    size_t      defaultLen;                                 ///< Number of bytes in defaultValue
+                                                            ///< (0 if not cached).
+    uint8_t     defaultValue[MAX_CACHED_DEFAULT_BYTES];     ///< Default value.
+} MetadataCache_t;
+
+/// Pool of node metadata caches.
+static le_mem_PoolRef_t MetadataCachePool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(MetadataCachePool, DEFAULT_METADATA_CACHE_POOL_SIZE,
+                          sizeof(MetadataCache_t));
+
 //--------------------------------------------------------------------------------------------------
 /*
  * Callback for an internal formatter state machine step.
@@ -115,8 +151,7 @@ static const char * FilterToString
 //--------------------------------------------------------------------------------------------------
 static int SendData
 (
-    OctaveFormatter_t   *octaveFormatter,   ///< Formatter instance.
-    int                  stream             ///< Output stream FD.
+    OctaveFormatter_t   *octaveFormatter  ///< Formatter instance.
 )
 {
     const uint8_t *start = &octaveFormatter->buffer[octaveFormatter->next];
@@ -128,7 +163,7 @@ static int SendData
         return 1;
     }
 
-    count = le_fd_Write(stream, start, octaveFormatter->available);
+    count = snapshot_Write(&octaveFormatter->base, start, octaveFormatter->available);
     if (count < 0)
     {
         if (EAGAIN == errno)
@@ -156,7 +191,10 @@ static int SendData
         // We've sent everything in the buffer.
         octaveFormatter->next = 0;
         octaveFormatter->available = 0;
-        le_fdMonitor_Disable(octaveFormatter->monitor, POLLOUT);
+        if (octaveFormatter->monitor != NULL)
+        {
+            le_fdMonitor_Disable(octaveFormatter->monitor, POLLOUT);
+        }
         return 0;
     }
 }
@@ -169,7 +207,6 @@ static int SendData
 static void HandleEvents
 (
     OctaveFormatter_t   *octaveFormatter,  ///< Formatter instance.
-    int                 fd,                ///< Output stream file descriptor.
     short               events             ///< FD event bitfield.
 )
 {
@@ -179,12 +216,12 @@ static void HandleEvents
     if (events & POLLOUT)
     {
         // Can send more data, so do it.
-        status = SendData(octaveFormatter, fd);
+        status = SendData(octaveFormatter);
         if (status < 0)
         {
             LE_ERROR("Failed to send data");
             // Error sending data, so abort the snapshot.
-            snapshot_End(LE_CLOSED);
+            snapshot_End(&octaveFormatter->base, LE_CLOSED);
             return;
         }
         else if (status == 0)
@@ -211,13 +248,13 @@ static void HandleEvents
     {
         LE_ERROR("Stream closed unexpectedly");
         // Stream was closed for some reason, nothing we can do except terminate the snapshot.
-        snapshot_End(LE_CLOSED);
+        snapshot_End(&octaveFormatter->base, LE_CLOSED);
     }
     else if (events & ~POLLOUT)
     {
         LE_ERROR("Unsupported event received");
         // Any other condition is an error, so terminate the snapshot.
-        snapshot_End(LE_FAULT);
+        snapshot_End(&octaveFormatter->base, LE_FAULT);
     }
 }
 
@@ -234,8 +271,10 @@ static void StreamHandler
 {
     OctaveFormatter_t *octaveFormatter = le_fdMonitor_GetContextPtr();
 
+    LE_UNUSED(fd);
+
     LE_DEBUG("Stream event");
-    HandleEvents(octaveFormatter, fd, events);
+    HandleEvents(octaveFormatter, events);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -249,12 +288,15 @@ static void ExplicitSendHandler
     void                *unused            ///< Unused.
 )
 {
-    int fd = le_fdMonitor_GetFd(octaveFormatter->monitor);
-
     LE_UNUSED(unused);
 
-    LE_DEBUG("Explicit send");
-    HandleEvents(octaveFormatter, fd, POLLOUT);
+    // The snapshot may have ended while this was queued.
+    if (octaveFormatter->isOpen)
+    {
+        LE_DEBUG("Explicit send");
+        HandleEvents(octaveFormatter, POLLOUT);
+    }
+    le_mem_Release(octaveFormatter);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -271,10 +313,14 @@ static void EnableSend
     LE_ASSERT(octaveFormatter->next == 0);
     LE_DEBUG("Sending %zu bytes", available);
     octaveFormatter->available = available;
-    le_fdMonitor_Enable(octaveFormatter->monitor, POLLOUT);
+    if (octaveFormatter->monitor != NULL)
+    {
+        le_fdMonitor_Enable(octaveFormatter->monitor, POLLOUT);
+    }
 
     // Explicitly trigger an attempt to send, since the stream might be sitting ready and therefore
-    // not generate a new POLLOUT.
+    // not generate a new POLLOUT.  The queued function holds a reference to the instance.
+    le_mem_AddRef(octaveFormatter);
     le_event_QueueFunction((le_event_DeferredFunc_t) &ExplicitSendHandler, octaveFormatter, NULL);
 }
 
@@ -332,6 +378,110 @@ static bool IsInternalNode(
     return false;
 }
 
+//--------------------------------------------------------------------------------------------------
+/*
+ * Get the metadata of a node, as reported under the "y" key.
+ *
+ * @return Entry type, plus ten times the data type, plus a hundred if the node is mandatory.
+ */
+//--------------------------------------------------------------------------------------------------
+static int64_t GetMetadata
+(
+    resTree_EntryRef_t node ///< Node to get the metadata of.
+)
+{
+    int64_t metadata = 0;
+
+    metadata += resTree_GetEntryType(node);
+    metadata += 10*resTree_GetDataType(node);
+    metadata += 100*resTree_IsMandatory(node);
+    return metadata;
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Get the cached metadata encoding of the node being formatted.
+ *
+ * @return The cache, or NULL if there is none that matches the node's metadata, or if the
+ *         snapshot is not of the whole tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static MetadataCache_t *GetMetadataCache
+(
+    OctaveFormatter_t *octaveFormatter  ///< Formatter instance.
+)
+{
+    resTree_EntryRef_t   node = snapshot_GetNode(&octaveFormatter->base);
+    MetadataCache_t     *cachePtr;
+
+    if (snapshot_GetRoot(&octaveFormatter->base) != resTree_GetRoot())
+    {
+        return NULL;
+    }
+
+    cachePtr = resTree_GetMetadataCache(node);
+    if (cachePtr == NULL || cachePtr->metadata != GetMetadata(node))
+    {
+        return NULL;
+    }
+    return cachePtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Cache the header encoding of the node being formatted, replacing any previous cache.  Nothing is
+ * cached if the snapshot is not of the whole tree, or if the cache pool is exhausted.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CacheHeader
+(
+    OctaveFormatter_t   *octaveFormatter,   ///< Formatter instance.
+    int64_t              metadata,          ///< Metadata encoded in the header.
+    const uint8_t       *header,            ///< Encoded header.
+    size_t               headerLen          ///< Number of bytes in the header.
+)
+{
+    resTree_EntryRef_t   node = snapshot_GetNode(&octaveFormatter->base);
+    MetadataCache_t     *cachePtr;
+
+    if (snapshot_GetRoot(&octaveFormatter->base) != resTree_GetRoot() ||
+        headerLen > MAX_NODE_HEADER_BYTES)
+    {
+        return;
+    }
+
+    cachePtr = le_mem_TryAlloc(MetadataCachePool);
+    if (cachePtr != NULL)
+    {
+        cachePtr->metadata = metadata;
+        cachePtr->headerLen = headerLen;
+        memcpy(cachePtr->header, header, headerLen);
+        cachePtr->defaultLen = 0;
+    }
+    resTree_SetMetadataCache(node, cachePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/*
+ * Get the state to move to once a node's default value has been written.
+ *
+ * @return STATE_JSON_EX if the node's JSON example has to be written, or STATE_SNAPSHOT_STEP.
+ */
+//--------------------------------------------------------------------------------------------------
+static OctaveFormatterState_t StateAfterDefault
+(
+    resTree_EntryRef_t node ///< Node being formatted.
+)
+{
+    if (IO_DATA_TYPE_JSON == resTree_GetDataType(node) &&
+        ADMIN_ENTRY_TYPE_INPUT == resTree_GetEntryType(node) &&
+        resTree_IsJsonExampleChanged(node))
+    {
+        return STATE_JSON_EX;
+    }
+    return STATE_SNAPSHOT_STEP;
+}
+
 //--------------------------------------------------------------------------------------------------
 /*
  * Begin formatting the overall resource tree.
@@ -413,7 +563,7 @@ static void StartTree
 
 cborerror:
     LE_ERROR("Failed to encode data with error %s", LE_RESULT_TXT(res));
-    snapshot_End(res);
+    snapshot_End(&octaveFormatter->base, res);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -434,23 +584,27 @@ static void BeginNode
     //  - root node is skipped
     //  - Octave internal node are skipped
     //  - added/modified nodes that are not input/ouput/observation are skipped
-    //  - for deleted nodes tracking: only the actually deleted node is considered
-    resTree_EntryRef_t  node = snapshot_GetNode();
-    resTree_EntryRef_t  root = snapshot_GetRoot();
-    admin_EntryType_t   entryType = resTree_GetEntryType(node);
-    octaveFormatter->skipNode = ((root == node) ||
-                                 IsInternalNode(node) ||
-                                 (!(formatter->filter & SNAPSHOT_FILTER_DELETED) &&
-                                  !((ADMIN_ENTRY_TYPE_INPUT == entryType) ||
-                                    (ADMIN_ENTRY_TYPE_OUTPUT == entryType) ||
-                                    (ADMIN_ENTRY_TYPE_OBSERVATION == entryType))) ||
-                                 ((formatter->filter & SNAPSHOT_FILTER_DELETED) &&
-                                  !resTree_IsDeleted(node)));
+    //  - for deleted nodes tracking: only the actually deleted node is considered, and it is only
+    //    known by its path (no longer in the tree)
+    if (formatter->filter & SNAPSHOT_FILTER_DELETED)
+    {
+        octaveFormatter->skipNode = !snapshot_IsNodeDeleted(formatter);
+    }
+    else
+    {
+        resTree_EntryRef_t  node = snapshot_GetNode(&octaveFormatter->base);
+        admin_EntryType_t   entryType = resTree_GetEntryType(node);
+        octaveFormatter->skipNode = (snapshot_IsRootNode(formatter) ||
+                                     IsInternalNode(node) ||
+                                     !((ADMIN_ENTRY_TYPE_INPUT == entryType) ||
+                                       (ADMIN_ENTRY_TYPE_OUTPUT == entryType) ||
+                                       (ADMIN_ENTRY_TYPE_OBSERVATION == entryType)));
+    }
 
     if (octaveFormatter->skipNode)
     {
         // Move directly to opening node as this one's content is irrelevant
-        LE_DEBUG("Skip node '%s'", resTree_GetEntryName(node));
+        LE_DEBUG("Skip node '%s'", snapshot_GetNodeName(formatter));
         octaveFormatter->nextState = STATE_NODE_OPEN;
         Step(octaveFormatter);
     }
@@ -464,7 +618,9 @@ static void BeginNode
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Write the node name part of the object key to the buffer.
+ * Write the node name part of the object key to the buffer, followed by the node opening and its
+ * metadata for added/modified nodes.  These are copied from the node's metadata cache if it has
+ * one, otherwise they are encoded and cached.
  */
 //--------------------------------------------------------------------------------------------------
 static void NodeName
@@ -472,29 +628,53 @@ static void NodeName
     OctaveFormatter_t *octaveFormatter  ///< Formatter instance.
 )
 {
-    resTree_EntryRef_t node = snapshot_GetNode();
     char path[HUB_MAX_RESOURCE_PATH_BYTES] = {0};
     ssize_t pathLen = 0;
+    resTree_EntryRef_t node = NULL;
+    MetadataCache_t *cachePtr = NULL;
+    int64_t metadata = 0;
+    bool isLive = (octaveFormatter->base.filter & LIVE_FILTERS);
 
     le_result_t res = LE_OK;
     size_t encodedBytes = octaveFormatter->encodedBytes;
     size_t remaining = octaveFormatter->remaining;
+    size_t start = encodedBytes;
 
 
     LE_ASSERT(octaveFormatter->base.filter & ALL_FILTERS);
     LE_ASSERT(!octaveFormatter->skipNode);
 
+    if (isLive)
+    {
+        node = snapshot_GetNode(&octaveFormatter->base);
+        metadata = GetMetadata(node);
+        cachePtr = GetMetadataCache(octaveFormatter);
+    }
+    if (cachePtr != NULL)
+    {
+        if (cachePtr->headerLen > remaining)
+        {
+            res = LE_OVERFLOW;
+            goto cborerror;
+        }
+        memcpy(octaveFormatter->buffer + encodedBytes, cachePtr->header, cachePtr->headerLen);
+        encodedBytes += cachePtr->headerLen;
+        remaining -= cachePtr->headerLen;
+        goto done;
+    }
+
     /* path returned below does not begin with '/', whereas the backend expects
      * this to be included in the cbor message
      */
     path[0] = '/';
-    /* Get node's full path from root. If this fails, abort snapshot. resTree_GetPath() returns
-     * -ve legato error code on failure
+    /* Get node's full path from root. If this fails, abort snapshot. snapshot_GetNodePath()
+     * returns -ve legato error code on failure
      */
-    if (0 > (pathLen = resTree_GetPath((char *)(path + 1), HUB_MAX_RESOURCE_PATH_BYTES - 1,
-                                       snapshot_GetRoot(), node)))
+    if (0 > (pathLen = snapshot_GetNodePath(&octaveFormatter->base, (char *)(path + 1),
+                                            HUB_MAX_RESOURCE_PATH_BYTES - 1)))
     {
-        LE_ERROR("Failed to retrieve node's path for node '%s'", resTree_GetEntryName(node));
+        LE_ERROR("Failed to retrieve node's path for node '%s'",
+                 snapshot_GetNodeName(&octaveFormatter->base));
         res = (le_result_t)pathLen;
         goto cborerror;
     }
@@ -503,6 +683,31 @@ static void NodeName
     {
         goto cborerror;
     }
+
+    // for added/modified nodes: open a map to dump their content
+    if (isLive)
+    {
+        LE_DEBUG("Open node '%s'", resTree_GetEntryName(node));
+        if (LE_OK != (res = cbor_utils_EncodeIndefMapStart(octaveFormatter->buffer + encodedBytes,
+                                                           &remaining, &encodedBytes)))
+        {
+            goto cborerror;
+        }
+        if (LE_OK != (res = cbor_utils_EncodeString(octaveFormatter->buffer + encodedBytes,
+                                                    &remaining, &encodedBytes, (char*)"y")))
+        {
+            goto cborerror;
+        }
+        if (LE_OK != (res = cbor_utils_EncodeInt(octaveFormatter->buffer + encodedBytes,
+                                                 &remaining, &encodedBytes, metadata)))
+        {
+            goto cborerror;
+        }
+        CacheHeader(octaveFormatter, metadata, octaveFormatter->buffer + start,
+                    encodedBytes - start);
+    }
+
+done:
     octaveFormatter->nextState = STATE_NODE_OPEN;
     octaveFormatter->encodedBytes = encodedBytes;
     octaveFormatter->remaining = remaining;
@@ -511,12 +716,12 @@ static void NodeName
 
 cborerror:
     LE_ERROR("Failed to encode data with error %s", LE_RESULT_TXT(res));
-    snapshot_End(res);
+    snapshot_End(&octaveFormatter->base, res);
 }
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Write the node opening preamble and its metadata to the buffer.
+ * Move on to the node values once its opening and metadata have been written.
  */
 //--------------------------------------------------------------------------------------------------
 static void NodeOpen
@@ -524,40 +729,16 @@ static void NodeOpen
     OctaveFormatter_t *octaveFormatter  ///< Formatter instance.
 )
 {
-    resTree_EntryRef_t  node = snapshot_GetNode();
-    admin_EntryType_t   entryType = resTree_GetEntryType(node);
-
-    le_result_t res = LE_OK;
-    size_t encodedBytes = octaveFormatter->encodedBytes;
-    size_t remaining = octaveFormatter->remaining;
+    resTree_EntryRef_t  node = NULL;
+    admin_EntryType_t   entryType = ADMIN_ENTRY_TYPE_NAMESPACE;
 
     LE_ASSERT(octaveFormatter->base.filter & ALL_FILTERS);
 
-    // for added/modified nodes: open a map to dump their content
+    // added/modified nodes were opened along with their name
     if (octaveFormatter->base.filter & LIVE_FILTERS && !octaveFormatter->skipNode)
     {
-        io_DataType_t dataType = resTree_GetDataType(node);
-        int64_t metadata = 0;
-        metadata += entryType;
-        metadata += 10*dataType;
-        metadata += 100*resTree_IsMandatory(node);
-
-        LE_DEBUG("Open node '%s'", resTree_GetEntryName(node));
-        if (LE_OK != (res = cbor_utils_EncodeIndefMapStart(octaveFormatter->buffer + encodedBytes,
-                                                           &remaining, &encodedBytes)))
-        {
-            goto cborerror;
-        }
-        if (LE_OK != (res = cbor_utils_EncodeString(octaveFormatter->buffer + encodedBytes,
-                                                    &remaining, &encodedBytes, (char*)"y")))
-        {
-            goto cborerror;
-        }
-        if (LE_OK != (res = cbor_utils_EncodeInt(octaveFormatter->buffer + encodedBytes,
-                                                 &remaining, &encodedBytes, metadata)))
-        {
-            goto cborerror;
-        }
+        node = snapshot_GetNode(&octaveFormatter->base);
+        entryType = resTree_GetEntryType(node);
     }
     // skipped nodes need no formatting and deleted ones are dumped by name only
     else
@@ -575,7 +756,7 @@ static void NodeOpen
         case ADMIN_ENTRY_TYPE_INPUT:
         case ADMIN_ENTRY_TYPE_OUTPUT:
         case ADMIN_ENTRY_TYPE_OBSERVATION:
-            if (snapshot_IsTimely(node))
+            if (snapshot_IsTimely(&octaveFormatter->base, node))
             {
                 // Node values have been set, output them
                 octaveFormatter->nextState = STATE_NODE_VALUES;
@@ -592,14 +773,7 @@ static void NodeOpen
             LE_FATAL("Unexpected entry type: %d", entryType);
             break;
     }
-    octaveFormatter->encodedBytes = encodedBytes;
-    octaveFormatter->remaining = remaining;
     SendOrAdvance(octaveFormatter, false);
-    return;
-
-cborerror:
-    LE_ERROR("Failed to encode data with error %s", LE_RESULT_TXT(res));
-    snapshot_End(res);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -612,7 +786,7 @@ static void NodeValues
     OctaveFormatter_t *octaveFormatter  ///< Formatter instance.
 )
 {
-    resTree_EntryRef_t  node = snapshot_GetNode();
+    resTree_EntryRef_t  node = snapshot_GetNode(&octaveFormatter->base);
     dataSample_Ref_t    sample = resTree_GetCurrentValue(node);
     io_DataType_t       dataType = resTree_GetDataType(node);
 
@@ -628,7 +802,7 @@ static void NodeValues
         // NodeOpen call should have jumped directly to next node
         // allow snapshot to continue as it does not creates issue but warn about it
         LE_WARN("Node '%s' has no value, should not have reached this function",
-                resTree_GetEntryName(snapshot_GetNode()));
+                resTree_GetEntryName(snapshot_GetNode(&octaveFormatter->base)));
         octaveFormatter->nextState = STATE_SNAPSHOT_STEP;
         Step(octaveFormatter);
         return;
@@ -679,7 +853,7 @@ static void NodeValues
 
 cborerror:
     LE_ERROR("Failed to encode data with error %s", LE_RESULT_TXT(res));
-    snapshot_End(res);
+    snapshot_End(&octaveFormatter->base, res);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -692,7 +866,7 @@ static void NodeValueBody
     OctaveFormatter_t *octaveFormatter  ///< Formatter instance.
 )
 {
-    resTree_EntryRef_t  node = snapshot_GetNode();
+    resTree_EntryRef_t  node = snapshot_GetNode(&octaveFormatter->base);
     dataSample_Ref_t    sample = resTree_GetCurrentValue(node);
     io_DataType_t       dataType = resTree_GetDataType(node);
 
@@ -757,7 +931,7 @@ static void NodeValueBody
 
 cborerror:
     LE_ERROR("Failed to encode data with error %s", LE_RESULT_TXT(res));
-    snapshot_End(res);
+    snapshot_End(&octaveFormatter->base, res);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -770,7 +944,7 @@ static void NodeDefaultValue
     OctaveFormatter_t *octaveFormatter  ///< Formatter instance.
 )
 {
-    resTree_EntryRef_t  node = snapshot_GetNode();
+    resTree_EntryRef_t  node = snapshot_GetNode(&octaveFormatter->base);
     io_DataType_t       dataType = resTree_GetDataType(node);
     admin_EntryType_t   entryType = resTree_GetEntryType(node);
 
@@ -782,12 +956,29 @@ static void NodeDefaultValue
 
     if (resTree_HasDefault(node))
     {
+        MetadataCache_t *cachePtr = GetMetadataCache(octaveFormatter);
+
         if (LE_OK != (res = cbor_utils_EncodeString(octaveFormatter->buffer + encodedBytes,
                                                     &remaining, &encodedBytes, (char*)"d")))
         {
             goto cborerror;
         }
         octaveFormatter->nextState = STATE_NODE_DEFAULT_BODY;
+
+        // copy the default value from the cache if it is there
+        if (cachePtr != NULL && cachePtr->defaultLen > 0)
+        {
+            if (cachePtr->defaultLen > remaining)
+            {
+                res = LE_OVERFLOW;
+                goto cborerror;
+            }
+            memcpy(octaveFormatter->buffer + encodedBytes, cachePtr->defaultValue,
+                   cachePtr->defaultLen);
+            encodedBytes += cachePtr->defaultLen;
+            remaining -= cachePtr->defaultLen;
+            octaveFormatter->nextState = StateAfterDefault(node);
+        }
         octaveFormatter->encodedBytes = encodedBytes;
         octaveFormatter->remaining = remaining;
         SendOrAdvance(octaveFormatter, false);
@@ -807,7 +998,7 @@ static void NodeDefaultValue
 
 cborerror:
     LE_ERROR("Failed to encode data with error %s", LE_RESULT_TXT(res));
-    snapshot_End(res);
+    snapshot_End(&octaveFormatter->base, res);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -820,13 +1011,15 @@ static void NodeDefaultValueBody
     OctaveFormatter_t *octaveFormatter  ///< Formatter instance.
 )
 {
-    resTree_EntryRef_t  node = snapshot_GetNode();
+    resTree_EntryRef_t  node = snapshot_GetNode(&octaveFormatter->base);
     io_DataType_t       dataType = resTree_GetDefaultDataType(node);
     dataSample_Ref_t    sample = resTree_GetDefaultValue(node);
+    MetadataCache_t    *cachePtr = GetMetadataCache(octaveFormatter);
 
     le_result_t res = LE_OK;
     size_t encodedBytes = octaveFormatter->encodedBytes;
     size_t remaining = octaveFormatter->remaining;
+    size_t start = encodedBytes;
 
     LE_ASSERT(octaveFormatter->base.filter & LIVE_FILTERS);
     LE_ASSERT(resTree_HasDefault(node));
@@ -875,16 +1068,14 @@ static void NodeDefaultValueBody
         LE_FATAL("Unexpected data type %d", dataType);
     }
 
-    if (IO_DATA_TYPE_JSON == resTree_GetDataType(node) &&
-        ADMIN_ENTRY_TYPE_INPUT == resTree_GetEntryType(node) &&
-        resTree_IsJsonExampleChanged(node))
-    {
-        octaveFormatter->nextState = STATE_JSON_EX;
-    }
-    else
+    // cache the encoded default value if it is short enough
+    if (cachePtr != NULL && (encodedBytes - start) <= MAX_CACHED_DEFAULT_BYTES)
     {
-        octaveFormatter->nextState = STATE_SNAPSHOT_STEP;
+        cachePtr->defaultLen = encodedBytes - start;
+        memcpy(cachePtr->defaultValue, octaveFormatter->buffer + start, cachePtr->defaultLen);
     }
+
+    octaveFormatter->nextState = StateAfterDefault(node);
     octaveFormatter->encodedBytes = encodedBytes;
     octaveFormatter->remaining = remaining;
     SendOrAdvance(octaveFormatter, false);
@@ -892,7 +1083,7 @@ static void NodeDefaultValueBody
 
 cborerror:
     LE_ERROR("Failed to encode data with error %s", LE_RESULT_TXT(res));
-    snapshot_End(res);
+    snapshot_End(&octaveFormatter->base, res);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -905,7 +1096,7 @@ static void NodeJsonExample
     OctaveFormatter_t *octaveFormatter  ///< Formatter instance.
 )
 {
-    resTree_EntryRef_t  node = snapshot_GetNode();
+    resTree_EntryRef_t  node = snapshot_GetNode(&octaveFormatter->base);
     io_DataType_t       dataType = resTree_GetDataType(node);
 
     le_result_t res = LE_OK;
@@ -929,7 +1120,7 @@ static void NodeJsonExample
 
 cborerror:
     LE_ERROR("Failed to encode data with error %s", LE_RESULT_TXT(res));
-    snapshot_End(res);
+    snapshot_End(&octaveFormatter->base, res);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -942,7 +1133,7 @@ static void NodeJsonExampleBody
     OctaveFormatter_t *octaveFormatter  ///< Formatter instance.
 )
 {
-    resTree_EntryRef_t  node = snapshot_GetNode();
+    resTree_EntryRef_t  node = snapshot_GetNode(&octaveFormatter->base);
     io_DataType_t       dataType = resTree_GetDataType(node);
 
     le_result_t res = LE_OK;
@@ -973,7 +1164,7 @@ static void NodeJsonExampleBody
 
 cborerror:
     LE_ERROR("Failed to encode data with error %s", LE_RESULT_TXT(res));
-    snapshot_End(res);
+    snapshot_End(&octaveFormatter->base, res);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1003,16 +1194,18 @@ static void EndObject
     //  - root node is skipped
     //  - added/modified nodes that are not input/ouput/observation are skipped
     //  - for deleted nodes tracking: only the actually deleted node is considered
-    resTree_EntryRef_t  node = snapshot_GetNode();
-    resTree_EntryRef_t  root = snapshot_GetRoot();
-    admin_EntryType_t   entryType = resTree_GetEntryType(node);
-    octaveFormatter->skipNode = ((root == node) ||
-                                 (!(formatter->filter & SNAPSHOT_FILTER_DELETED) &&
-                                  !((ADMIN_ENTRY_TYPE_INPUT == entryType) ||
-                                    (ADMIN_ENTRY_TYPE_OUTPUT == entryType) ||
-                                    (ADMIN_ENTRY_TYPE_OBSERVATION == entryType))) ||
-                                 ((formatter->filter & SNAPSHOT_FILTER_DELETED) &&
-                                  !resTree_IsDeleted(node)));
+    if (formatter->filter & SNAPSHOT_FILTER_DELETED)
+    {
+        octaveFormatter->skipNode = !snapshot_IsNodeDeleted(formatter);
+    }
+    else
+    {
+        admin_EntryType_t entryType = resTree_GetEntryType(snapshot_GetNode(formatter));
+        octaveFormatter->skipNode = (snapshot_IsRootNode(formatter) ||
+                                     !((ADMIN_ENTRY_TYPE_INPUT == entryType) ||
+                                       (ADMIN_ENTRY_TYPE_OUTPUT == entryType) ||
+                                       (ADMIN_ENTRY_TYPE_OBSERVATION == entryType)));
+    }
 
     // for added/modified nodes that were not skipped: close map
     if (formatter->filter & LIVE_FILTERS && !octaveFormatter->skipNode)
@@ -1035,7 +1228,7 @@ static void EndObject
 
 cborerror:
     LE_ERROR("Failed to encode data with error %s", LE_RESULT_TXT(res));
-    snapshot_End(res);
+    snapshot_End(&octaveFormatter->base, res);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1112,7 +1305,7 @@ static void EndTree
 
 cborerror:
     LE_ERROR("Failed to encode data with error %s", LE_RESULT_TXT(res));
-    snapshot_End(res);
+    snapshot_End(&octaveFormatter->base, res);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1128,7 +1321,13 @@ static void Close
     OctaveFormatter_t *octaveFormatter = CONTAINER_OF(formatter, OctaveFormatter_t, base);
 
     LE_DEBUG("Closing formatter");
-    le_fdMonitor_Delete(octaveFormatter->monitor);
+    if (octaveFormatter->monitor != NULL)
+    {
+        le_fdMonitor_Delete(octaveFormatter->monitor);
+        octaveFormatter->monitor = NULL;
+    }
+    octaveFormatter->isOpen = false;
+    le_mem_Release(octaveFormatter);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1141,10 +1340,8 @@ static void SnapshotStep
     OctaveFormatter_t *octaveFormatter  ///< Formatter instance.
 )
 {
-    LE_UNUSED(octaveFormatter);
-
     LE_DEBUG("Stepping snapshot state machine");
-    snapshot_Step();
+    snapshot_Step(&octaveFormatter->base);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1199,7 +1396,7 @@ static void Step
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Initialise and return the Octave CBOR snapshot formatter instance.
+ * Initialise and return an Octave CBOR snapshot formatter instance.
  *
  * @return LE_OK on success, otherwise an appropriate error code.
  */
@@ -1208,54 +1405,69 @@ LE_SHARED le_result_t GetOctaveSnapshotFormatter
 (
     uint32_t                      flags,    ///< [IN]  Flags that were passed to the snapshot
                                             ///<       request.
-    int                           stream,   ///< [IN]  File descriptor to write formatted output to.
+    int                           stream,   ///< [IN]  File descriptor to write formatted output to,
+                                            ///<       or -1 if the snapshot is written to shared
+                                            ///<       memory.
     struct snapshot_Formatter   **formatter ///< [OUT] Returned formatter instance.
 )
 {
-    static OctaveFormatter_t octaveFormatter =
-    {
-        {
-            .startTree  = &StartTree,
-            .beginNode  = &BeginNode,
-            .endNode    = &EndObject,
-            .endTree    = &EndTree,
-            .close      = &Close
-        }
-    };
+    OctaveFormatter_t *octaveFormatter;
 
     LE_ASSERT(formatter != NULL);
-    *formatter = &octaveFormatter.base;
 
-    memset(octaveFormatter.buffer, 0, sizeof(octaveFormatter.buffer));
-    octaveFormatter.remaining     = sizeof(octaveFormatter.buffer);
-    octaveFormatter.encodedBytes  = 0;
-    octaveFormatter.next          = 0;
-    octaveFormatter.available     = 0;
-    octaveFormatter.isFullDump    = (flags & OCTAVE_FLAG_FULL_TREE);
-    octaveFormatter.skipNode      = true;
-    octaveFormatter.nextState     = STATE_START;
+    // The pool holds one instance per snapshot session, so this only fails if one is leaked.
+    octaveFormatter = le_mem_TryAlloc(OctaveFormatterPool);
+    if (octaveFormatter == NULL)
+    {
+        LE_ERROR("No Octave formatter instance available");
+        return LE_NO_MEMORY;
+    }
+    *formatter = &octaveFormatter->base;
+
+    memset(&octaveFormatter->base, 0, sizeof(octaveFormatter->base));
+    octaveFormatter->base.startTree = &StartTree;
+    octaveFormatter->base.beginNode = &BeginNode;
+    octaveFormatter->base.endNode   = &EndObject;
+    octaveFormatter->base.endTree   = &EndTree;
+    octaveFormatter->base.close     = &Close;
+
+    memset(octaveFormatter->buffer, 0, sizeof(octaveFormatter->buffer));
+    octaveFormatter->remaining     = sizeof(octaveFormatter->buffer);
+    octaveFormatter->encodedBytes  = 0;
+    octaveFormatter->next          = 0;
+    octaveFormatter->available     = 0;
+    octaveFormatter->isFullDump    = (flags & OCTAVE_FLAG_FULL_TREE);
+    octaveFormatter->skipNode      = true;
+    octaveFormatter->nextState     = STATE_START;
 
-    if (octaveFormatter.isFullDump)
+    if (octaveFormatter->isFullDump)
     {
-        octaveFormatter.base.filter   = LIVE_FILTERS;
+        octaveFormatter->base.filter   = LIVE_FILTERS;
         LE_DEBUG("Octave formatter: full tree. Transition to STATE_START");
     }
     else
     {
-        octaveFormatter.base.filter   = SNAPSHOT_FILTER_CREATED;
+        octaveFormatter->base.filter   = SNAPSHOT_FILTER_CREATED;
         LE_DEBUG("Octave formatter: diff tree. Transition to STATE_START");
     }
-    octaveFormatter.base.scan     = true;
+    octaveFormatter->base.scan     = true;
+
+    octaveFormatter->isOpen = true;
 
-    // Configure event handler for outputting formatted data.
-    octaveFormatter.monitor = le_fdMonitor_Create(
-                                "OctaveSnapshotStream",
-                                stream,
-                                &StreamHandler,
-                                POLLOUT
-                            );
-    le_fdMonitor_SetContextPtr(octaveFormatter.monitor, &octaveFormatter);
-    le_fdMonitor_Disable(octaveFormatter.monitor, POLLOUT);
+    // Configure event handler for outputting formatted data.  Output written to shared memory never
+    // has to wait, so there is nothing to monitor in that case.
+    octaveFormatter->monitor = NULL;
+    if (stream >= 0)
+    {
+        octaveFormatter->monitor = le_fdMonitor_Create(
+                                    "OctaveSnapshotStream",
+                                    stream,
+                                    &StreamHandler,
+                                    POLLOUT
+                                );
+        le_fdMonitor_SetContextPtr(octaveFormatter->monitor, octaveFormatter);
+        le_fdMonitor_Disable(octaveFormatter->monitor, POLLOUT);
+    }
 
     return LE_OK;
 }
@@ -1263,5 +1475,14 @@ LE_SHARED le_result_t GetOctaveSnapshotFormatter
 /// Component initialisation.
 COMPONENT_INIT
 {
-    // Do nothing.
+    OctaveFormatterPool = le_mem_InitStaticPool(
+                            OctaveFormatterPool,
+                            DHUB_SNAPSHOT_MAX_SESSIONS,
+                            sizeof(OctaveFormatter_t)
+                        );
+    MetadataCachePool = le_mem_InitStaticPool(
+                            MetadataCachePool,
+                            DEFAULT_METADATA_CACHE_POOL_SIZE,
+                            sizeof(MetadataCache_t)
+                        );
 }
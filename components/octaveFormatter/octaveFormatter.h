@@ -19,7 +19,8 @@ struct snapshot_Formatter;
 
 //--------------------------------------------------------------------------------------------------
 /*
- * Initialise and return the Octave CBOR snapshot formatter instance.
+ * Initialise and return an Octave CBOR snapshot formatter instance.  The instance is released when
+ * the formatter is closed.
  *
  * @return LE_OK on success, otherwise an appropriate error code.
  */
@@ -28,7 +29,9 @@ LE_SHARED le_result_t GetOctaveSnapshotFormatter
 (
     uint32_t                      flags,    ///< [IN]  Flags that were passed to the snapshot
                                             ///<       request.
-    int                           stream,   ///< [IN]  File descriptor to write formatted output to.
+    int                           stream,   ///< [IN]  File descriptor to write formatted output to,
+                                            ///<       or -1 if the snapshot is written to shared
+                                            ///<       memory.
     struct snapshot_Formatter   **formatter ///< [OUT] Returned formatter instance.
 );
 
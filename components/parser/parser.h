@@ -24,6 +24,7 @@
 #define PARSER_OBS_RES_MAX_BYTES                (IO_MAX_RESOURCE_PATH_LEN + 1)
 
 #define PARSER_OBS_TRANSFORM_MAX_BYTES          (7)
+#define PARSER_OBS_PRECISION_MAX_BYTES          (8)
 #define PARSER_OBS_JSON_EX_MAX_BYTES            (ADMIN_MAX_JSON_EXTRACTOR_LEN + 1)
 
 #define PARSER_STATE_MAX_STRING_BYTES           (IO_MAX_STRING_VALUE_LEN + 1)
@@ -53,6 +54,10 @@
 #define PARSER_OBS_TRANSFORM_MASK               (0x80)
 #define PARSER_OBS_JSON_EXT_POS                 (8)
 #define PARSER_OBS_JSON_EXT_MASK                (0x100)
+#define PARSER_OBS_TRANSFORM_PERIOD_POS         (9)
+#define PARSER_OBS_TRANSFORM_PERIOD_MASK        (0x200)
+#define PARSER_OBS_PRECISION_POS                (10)
+#define PARSER_OBS_PRECISION_MASK               (0x400)
 
 
 //--------------------------------------------------------------------------------------------------
@@ -79,8 +84,9 @@ typedef struct ParseEnv* Parser_ParseSessionRef_t;
  * obsName, resourcePath, and destination will always be present and valid. Other members will be
  * set to a default value if they are missing from the file. Bellow is a list of members and their
  * default value:
- * minPeriod, changeBy, lowerThan, and greaterThan: NAN
+ * minPeriod, changeBy, lowerThan, greaterThan, and transformPeriod: NAN
  * bufferMaxCount: 0
+ * bufferPrecision: ADMIN_BUFFER_PRECISION_FULL
  * transform: ADMIN_OBS_TRANSFORM_TYPE_NONE
  * jsonExtraction: '/0'
  */
@@ -97,7 +103,9 @@ typedef struct parser_ObsData
     double lowerThan;                                   ///< Value of "lt"
     double greaterThan;                                 ///< Value of "gt"
     uint32_t bufferMaxCount;                            ///< Value of "b"
+    admin_BufferPrecision_t bufferPrecision;            ///< Value of "bp"
     admin_TransformType_t transform;                    ///< Value of "f"
+    double transformPeriod;                             ///< Value of "fp"
     char jsonExtraction[PARSER_OBS_JSON_EX_MAX_BYTES];  ///< Value of "s"
 } parser_ObsData_t;
 
@@ -267,4 +275,20 @@ LE_SHARED void parser_Parse
     void* context                                    ///< [IN] Context to provide to callbacks
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse a CBOR-encoded file.
+ *
+ *  The file has the same structure as a JSON one, with CBOR maps for objects, text strings for
+ *  strings and keys, and integers or floating point numbers for numbers.  The same callbacks are
+ *  called, in the same order, as for the JSON equivalent.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void parser_ParseCbor
+(
+    int fd,                                          ///< [IN] file descriptor to be parsed.
+    parser_Callbacks_t* callbacksPtr,                ///< [IN] Pointer to callback structure
+    void* context                                    ///< [IN] Context to provide to callbacks
+);
+
 #endif // PARSER_H_INCLUDE_GUARD
@@ -0,0 +1,1402 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file parser_cbor.c
+ *
+ *  Parsing a file with CBOR (RFC 7049) format.
+ *
+ *  The file is decoded directly from the file descriptor, a block at a time, and the same
+ *  callbacks are called as for the JSON equivalent of the file.  Tags are ignored, and both
+ *  definite and indefinite length strings, arrays and maps are accepted.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "dataHub.h"
+
+#include "parser.h"
+#include "parser_session.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes read from the file at a time.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CBOR_READ_BUFF_BYTES        256
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum depth of nested arrays and maps in values that are skipped over.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CBOR_MAX_SKIP_DEPTH         16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffer used for keys of members that have a fixed set of names.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CBOR_MEMBER_NAME_BYTES      8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffer used for the file's version string.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CBOR_VERSION_BYTES          64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * CBOR major types.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CBOR_MAJOR_UNSIGNED         0
+#define CBOR_MAJOR_NEGATIVE         1
+#define CBOR_MAJOR_BYTE_STRING      2
+#define CBOR_MAJOR_TEXT_STRING      3
+#define CBOR_MAJOR_ARRAY            4
+#define CBOR_MAJOR_MAP              5
+#define CBOR_MAJOR_TAG              6
+#define CBOR_MAJOR_SIMPLE           7
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Values of the additional information field (low 5 bits of the initial byte).
+ */
+//--------------------------------------------------------------------------------------------------
+#define CBOR_INFO_ONE_BYTE          24
+#define CBOR_INFO_EIGHT_BYTES       27
+#define CBOR_INFO_INDEFINITE        31
+
+#define CBOR_SIMPLE_FALSE           20
+#define CBOR_SIMPLE_TRUE            21
+#define CBOR_SIMPLE_HALF_FLOAT      25
+#define CBOR_SIMPLE_FLOAT           26
+#define CBOR_SIMPLE_DOUBLE          27
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Result code returned internally when the client has stopped the parse.  This is not an error,
+ * so it is not reported to the client.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CBOR_STOPPED                LE_TERMINATED
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  CBOR parse environment: the common parse environment plus the read buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct CborEnv
+{
+    ParseEnv_t env;                         ///< Common parse environment (must be first).
+    uint8_t buff[CBOR_READ_BUFF_BYTES];     ///< Bytes read from the file.
+    size_t buffLen;                         ///< Number of bytes in buff.
+    size_t buffPos;                         ///< Position of the next byte to consume in buff.
+} CborEnv_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  The head of a CBOR data item (after any tags).
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct CborHead
+{
+    uint8_t major;          ///< Major type.
+    uint8_t info;           ///< Additional information.
+    uint64_t arg;           ///< Value, length or count (unless indefinite).
+    bool isIndefinite;      ///< Indefinite length string, array or map (or a "break").
+} CborHead_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Report an error to the client.  Parsing stops after this.
+ *
+ * @return:
+ *      The result code (for convenience).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t HandleError
+(
+    CborEnv_t* cborPtr,                         ///< [IN] Parse environment.
+    le_result_t error,                          ///< [IN] result code
+    const char* msg                             ///< [IN] error message
+)
+{
+    if (cborPtr->env.callbacksPtr->error)
+    {
+        cborPtr->env.callbacksPtr->error(error, msg, cborPtr->env.context);
+    }
+
+    return error;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Check whether the client stopped the parse from inside the callback that was just called.
+ *
+ * @return:
+ *      LE_OK to carry on, or CBOR_STOPPED.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline le_result_t CheckStopped
+(
+    CborEnv_t* cborPtr                          ///< [IN] Parse environment.
+)
+{
+    return (cborPtr->env.stopped ? CBOR_STOPPED : LE_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Consume bytes from the file, refilling the read buffer as needed.
+ *
+ * @return:
+ *      LE_OK, LE_IO_ERROR or LE_FORMAT_ERROR (end of file reached).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadBytes
+(
+    CborEnv_t* cborPtr,                         ///< [IN] Parse environment.
+    void* destPtr,                              ///< [OUT] Where to copy the bytes (NULL = skip).
+    uint64_t len                                ///< [IN] Number of bytes (may exceed SIZE_MAX).
+)
+{
+    uint8_t* bytePtr = destPtr;
+
+    while (len > 0)
+    {
+        if (cborPtr->buffPos == cborPtr->buffLen)
+        {
+            ssize_t readLen;
+            do
+            {
+                readLen = read(cborPtr->env.fd, cborPtr->buff, sizeof(cborPtr->buff));
+            }
+            while ((readLen < 0) && (errno == EINTR));
+
+            if (readLen < 0)
+            {
+                return HandleError(cborPtr, LE_IO_ERROR, "Failed to read from file");
+            }
+            if (readLen == 0)
+            {
+                return HandleError(cborPtr, LE_FORMAT_ERROR, "Unexpected end of CBOR data");
+            }
+            cborPtr->buffLen = readLen;
+            cborPtr->buffPos = 0;
+        }
+
+        size_t chunkLen = cborPtr->buffLen - cborPtr->buffPos;
+        if (chunkLen > len)
+        {
+            chunkLen = len;
+        }
+
+        if (bytePtr != NULL)
+        {
+            memcpy(bytePtr, cborPtr->buff + cborPtr->buffPos, chunkLen);
+            bytePtr += chunkLen;
+        }
+        cborPtr->buffPos += chunkLen;
+        cborPtr->env.bytesRead += chunkLen;
+        len -= chunkLen;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read the head of the next data item, skipping any tags in front of it.
+ *
+ * @return:
+ *      LE_OK, LE_IO_ERROR or LE_FORMAT_ERROR.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadHead
+(
+    CborEnv_t* cborPtr,                         ///< [IN] Parse environment.
+    CborHead_t* headPtr                         ///< [OUT] The head of the item.
+)
+{
+    do
+    {
+        uint8_t initial;
+        le_result_t result = ReadBytes(cborPtr, &initial, 1);
+        if (result != LE_OK)
+        {
+            return result;
+        }
+
+        headPtr->major = initial >> 5;
+        headPtr->info = initial & 0x1f;
+        headPtr->arg = headPtr->info;
+        headPtr->isIndefinite = false;
+
+        if (headPtr->info == CBOR_INFO_INDEFINITE)
+        {
+            // Only strings, arrays and maps have indefinite lengths, and a "break" ends them.
+            if (   (headPtr->major == CBOR_MAJOR_UNSIGNED)
+                || (headPtr->major == CBOR_MAJOR_NEGATIVE)
+                || (headPtr->major == CBOR_MAJOR_TAG)  )
+            {
+                return HandleError(cborPtr, LE_FORMAT_ERROR, "Invalid CBOR item found");
+            }
+            headPtr->isIndefinite = true;
+        }
+        else if (headPtr->info > CBOR_INFO_EIGHT_BYTES)
+        {
+            return HandleError(cborPtr, LE_FORMAT_ERROR, "Invalid CBOR item found");
+        }
+        else if (headPtr->info >= CBOR_INFO_ONE_BYTE)
+        {
+            // The argument follows, big-endian, in 1, 2, 4 or 8 bytes.
+            uint8_t argBytes[8];
+            size_t argLen = (size_t)1 << (headPtr->info - CBOR_INFO_ONE_BYTE);
+
+            result = ReadBytes(cborPtr, argBytes, argLen);
+            if (result != LE_OK)
+            {
+                return result;
+            }
+
+            headPtr->arg = 0;
+            for (size_t i = 0; i < argLen; i++)
+            {
+                headPtr->arg = (headPtr->arg << 8) | argBytes[i];
+            }
+        }
+    }
+    while (headPtr->major == CBOR_MAJOR_TAG);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Check whether a head is the "break" that ends an indefinite length item.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsBreak
+(
+    const CborHead_t* headPtr                   ///< [IN] The head.
+)
+{
+    return ((headPtr->major == CBOR_MAJOR_SIMPLE) && headPtr->isIndefinite);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read the head of the next member key of a map, or find the end of the map.
+ *
+ * @return:
+ *      LE_OK, LE_IO_ERROR or LE_FORMAT_ERROR.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t NextMapKey
+(
+    CborEnv_t* cborPtr,                         ///< [IN] Parse environment.
+    CborHead_t* mapHeadPtr,                     ///< [INOUT] The map's head (counts down members).
+    CborHead_t* keyHeadPtr,                     ///< [OUT] The head of the key.
+    bool* isEndPtr                              ///< [OUT] true if the end of the map was reached.
+)
+{
+    *isEndPtr = false;
+
+    if (!mapHeadPtr->isIndefinite)
+    {
+        if (mapHeadPtr->arg == 0)
+        {
+            *isEndPtr = true;
+            return LE_OK;
+        }
+        mapHeadPtr->arg--;
+    }
+
+    le_result_t result = ReadHead(cborPtr, keyHeadPtr);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    if (IsBreak(keyHeadPtr))
+    {
+        if (!mapHeadPtr->isIndefinite)
+        {
+            return HandleError(cborPtr, LE_FORMAT_ERROR, "Invalid CBOR item found");
+        }
+        *isEndPtr = true;
+    }
+    else if (keyHeadPtr->major != CBOR_MAJOR_TEXT_STRING)
+    {
+        return HandleError(cborPtr, LE_FORMAT_ERROR, "Unexpected CBOR item found");
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read a text string into a buffer, as a null-terminated string.  If it doesn't fit, the rest
+ *  of it is skipped.
+ *
+ * @return:
+ *      - LE_OK if successful.
+ *      - LE_OVERFLOW if the string was truncated (this is not reported to the client).
+ *      - LE_IO_ERROR or LE_FORMAT_ERROR.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadText
+(
+    CborEnv_t* cborPtr,                         ///< [IN] Parse environment.
+    const CborHead_t* headPtr,                  ///< [IN] The head of the string.
+    char* buffPtr,                              ///< [OUT] Where to put the string.
+    size_t buffSize                             ///< [IN] Size of the buffer, including the null.
+)
+{
+    size_t usedLen = 0;
+    bool isTruncated = false;
+    le_result_t result;
+
+    if (headPtr->major != CBOR_MAJOR_TEXT_STRING)
+    {
+        return HandleError(cborPtr, LE_FORMAT_ERROR, "Unexpected CBOR item found");
+    }
+
+    CborHead_t chunkHead = *headPtr;
+
+    // An indefinite length string is a series of definite length chunks ended by a "break".
+    if (headPtr->isIndefinite)
+    {
+        result = ReadHead(cborPtr, &chunkHead);
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    while (!IsBreak(&chunkHead))
+    {
+        if ((chunkHead.major != CBOR_MAJOR_TEXT_STRING) || chunkHead.isIndefinite)
+        {
+            return HandleError(cborPtr, LE_FORMAT_ERROR, "Invalid CBOR item found");
+        }
+
+        uint64_t copyLen = buffSize - 1 - usedLen;
+        if (chunkHead.arg > copyLen)
+        {
+            isTruncated = true;
+        }
+        else
+        {
+            copyLen = chunkHead.arg;
+        }
+
+        result = ReadBytes(cborPtr, buffPtr + usedLen, copyLen);
+        if (result == LE_OK)
+        {
+            result = ReadBytes(cborPtr, NULL, chunkHead.arg - copyLen);
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+        usedLen += copyLen;
+
+        if (!headPtr->isIndefinite)
+        {
+            break;
+        }
+
+        result = ReadHead(cborPtr, &chunkHead);
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    buffPtr[usedLen] = '\0';
+
+    return (isTruncated ? LE_OVERFLOW : LE_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Decode a half-precision floating point number.
+ *
+ * @return:
+ *      The number.
+ */
+//--------------------------------------------------------------------------------------------------
+static double DecodeHalfFloat
+(
+    uint16_t half                               ///< [IN] The encoded number.
+)
+{
+    int exponent = (half >> 10) & 0x1f;
+    int mantissa = half & 0x3ff;
+    double value;
+
+    if (exponent == 0)
+    {
+        value = ldexp(mantissa, -24);
+    }
+    else if (exponent != 31)
+    {
+        value = ldexp(mantissa + 1024, exponent - 25);
+    }
+    else
+    {
+        value = ((mantissa == 0) ? INFINITY : NAN);
+    }
+
+    return ((half & 0x8000) ? -value : value);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Check whether a head is a number, and if so, get its value.
+ *
+ * @return:
+ *      true if the item is a number.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetNumber
+(
+    const CborHead_t* headPtr,                  ///< [IN] The head of the item.
+    double* valuePtr                            ///< [OUT] The value.
+)
+{
+    switch (headPtr->major)
+    {
+        case CBOR_MAJOR_UNSIGNED:
+
+            *valuePtr = (double)headPtr->arg;
+            return true;
+
+        case CBOR_MAJOR_NEGATIVE:
+
+            *valuePtr = -1.0 - (double)headPtr->arg;
+            return true;
+
+        case CBOR_MAJOR_SIMPLE:
+
+            if (headPtr->info == CBOR_SIMPLE_HALF_FLOAT)
+            {
+                *valuePtr = DecodeHalfFloat((uint16_t)headPtr->arg);
+                return true;
+            }
+            else if (headPtr->info == CBOR_SIMPLE_FLOAT)
+            {
+                uint32_t bits = (uint32_t)headPtr->arg;
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                *valuePtr = value;
+                return true;
+            }
+            else if (headPtr->info == CBOR_SIMPLE_DOUBLE)
+            {
+                memcpy(valuePtr, &headPtr->arg, sizeof(*valuePtr));
+                return true;
+            }
+            break;
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read the next item, which must be a number.
+ *
+ * @return:
+ *      LE_OK, LE_IO_ERROR or LE_FORMAT_ERROR.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadNumber
+(
+    CborEnv_t* cborPtr,                         ///< [IN] Parse environment.
+    double* valuePtr                            ///< [OUT] The value.
+)
+{
+    CborHead_t head;
+    le_result_t result = ReadHead(cborPtr, &head);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    if (!GetNumber(&head, valuePtr))
+    {
+        return HandleError(cborPtr, LE_FORMAT_ERROR, "Unexpected CBOR item found");
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Skip over the rest of an item whose head has been read.
+ *
+ * @return:
+ *      LE_OK, LE_IO_ERROR or LE_FORMAT_ERROR.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SkipItem
+(
+    CborEnv_t* cborPtr,                         ///< [IN] Parse environment.
+    const CborHead_t* headPtr,                  ///< [IN] The head of the item.
+    int depth                                   ///< [IN] Nesting depth of the item.
+)
+{
+    le_result_t result = LE_OK;
+
+    switch (headPtr->major)
+    {
+        case CBOR_MAJOR_BYTE_STRING:
+        case CBOR_MAJOR_TEXT_STRING:
+
+            if (!headPtr->isIndefinite)
+            {
+                return ReadBytes(cborPtr, NULL, headPtr->arg);
+            }
+            // *** FALL THROUGH *** (the chunks are skipped like array elements)
+
+        case CBOR_MAJOR_ARRAY:
+        case CBOR_MAJOR_MAP:
+        {
+            if (depth >= CBOR_MAX_SKIP_DEPTH)
+            {
+                return HandleError(cborPtr, LE_FORMAT_ERROR, "CBOR data nested too deeply");
+            }
+
+            uint64_t count = headPtr->arg;
+            if (headPtr->major == CBOR_MAJOR_MAP)
+            {
+                count *= 2;
+            }
+
+            while (headPtr->isIndefinite || (count > 0))
+            {
+                CborHead_t itemHead;
+                result = ReadHead(cborPtr, &itemHead);
+                if (result != LE_OK)
+                {
+                    return result;
+                }
+
+                if (IsBreak(&itemHead))
+                {
+                    if (!headPtr->isIndefinite)
+                    {
+                        return HandleError(cborPtr, LE_FORMAT_ERROR, "Invalid CBOR item found");
+                    }
+                    break;
+                }
+
+                result = SkipItem(cborPtr, &itemHead, depth + 1);
+                if (result != LE_OK)
+                {
+                    return result;
+                }
+                count--;
+            }
+            break;
+        }
+
+        case CBOR_MAJOR_SIMPLE:
+
+            if (IsBreak(headPtr))
+            {
+                return HandleError(cborPtr, LE_FORMAT_ERROR, "Invalid CBOR item found");
+            }
+            break;
+
+        default:
+
+            // Integers have no content after their head.
+            break;
+    }
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Skip over the next item.
+ *
+ * @return:
+ *      LE_OK, LE_IO_ERROR or LE_FORMAT_ERROR.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SkipNextItem
+(
+    CborEnv_t* cborPtr                          ///< [IN] Parse environment.
+)
+{
+    CborHead_t head;
+    le_result_t result = ReadHead(cborPtr, &head);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    return SkipItem(cborPtr, &head, 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read the next item, which must be a map.
+ *
+ * @return:
+ *      LE_OK, LE_IO_ERROR or LE_FORMAT_ERROR.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadMapHead
+(
+    CborEnv_t* cborPtr,                         ///< [IN] Parse environment.
+    CborHead_t* headPtr                         ///< [OUT] The head of the map.
+)
+{
+    le_result_t result = ReadHead(cborPtr, headPtr);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    if (headPtr->major != CBOR_MAJOR_MAP)
+    {
+        return HandleError(cborPtr, LE_FORMAT_ERROR, "Unexpected CBOR item found");
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read a string member of an observation that holds a resource path or destination.
+ *
+ * @return:
+ *      LE_OK, or the error reported.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadObsPath
+(
+    CborEnv_t* cborPtr,                         ///< [IN] Parse environment.
+    char* buffPtr,                              ///< [OUT] Where to put the path.
+    size_t buffSize,                            ///< [IN] Size of the buffer.
+    bool mustBePath,                            ///< [IN] false if it may be a destination name.
+    const char* errorMsg                        ///< [IN] Error message if it is invalid.
+)
+{
+    CborHead_t head;
+    le_result_t result = ReadHead(cborPtr, &head);
+    if (result == LE_OK)
+    {
+        result = ReadText(cborPtr, &head, buffPtr, buffSize);
+    }
+
+    if (result == LE_OVERFLOW)
+    {
+        // A destination that doesn't start with '/' isn't a path, but it still has to fit.
+        return HandleError(cborPtr, LE_BAD_PARAMETER, errorMsg);
+    }
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    if ((mustBePath || (buffPtr[0] == '/')) && hub_IsResourcePathMalformed(buffPtr))
+    {
+        return HandleError(cborPtr, LE_BAD_PARAMETER, errorMsg);
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read a text member of an observation.
+ *
+ * @return:
+ *      LE_OK, or the error reported.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadObsText
+(
+    CborEnv_t* cborPtr,                         ///< [IN] Parse environment.
+    char* buffPtr,                              ///< [OUT] Where to put the text.
+    size_t buffSize,                            ///< [IN] Size of the buffer.
+    const char* errorMsg                        ///< [IN] Error message if it is too long.
+)
+{
+    CborHead_t head;
+    le_result_t result = ReadHead(cborPtr, &head);
+    if (result == LE_OK)
+    {
+        result = ReadText(cborPtr, &head, buffPtr, buffSize);
+    }
+
+    if (result == LE_OVERFLOW)
+    {
+        return HandleError(cborPtr, LE_BAD_PARAMETER, errorMsg);
+    }
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse one observation's map into the temporary storage and pass it to the client.
+ *
+ * @return:
+ *      LE_OK, CBOR_STOPPED, or the error reported.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseObservation
+(
+    CborEnv_t* cborPtr                          ///< [IN] Parse environment.
+)
+{
+    parser_ObsData_t* obsPtr = &cborPtr->env.tempStorage.o;
+    CborHead_t mapHead;
+    le_result_t result = ReadMapHead(cborPtr, &mapHead);
+
+    while (result == LE_OK)
+    {
+        CborHead_t keyHead;
+        bool isEnd;
+        char memberName[CBOR_MEMBER_NAME_BYTES];
+
+        result = NextMapKey(cborPtr, &mapHead, &keyHead, &isEnd);
+        if ((result != LE_OK) || isEnd)
+        {
+            break;
+        }
+
+        result = ReadText(cborPtr, &keyHead, memberName, sizeof(memberName));
+        if (result == LE_OVERFLOW)
+        {
+            // Too long to be one we know.
+            memberName[0] = '\0';
+        }
+        else if (result != LE_OK)
+        {
+            break;
+        }
+
+        if (strcmp(memberName, "r") == 0)
+        {
+            result = ReadObsPath(cborPtr, obsPtr->resourcePath, PARSER_OBS_RES_MAX_BYTES,
+                                 true, "resource path is invalid");
+            obsPtr->bitmask |= PARSER_OBS_RESOURCE_MASK;
+        }
+        else if (strcmp(memberName, "d") == 0)
+        {
+            result = ReadObsPath(cborPtr, obsPtr->destination, PARSER_OBS_DEST_MAX_BYTES,
+                                 false, "obs destination is invalid");
+            obsPtr->bitmask |= PARSER_OBS_DEST_MASK;
+        }
+        else if (strcmp(memberName, "p") == 0)
+        {
+            result = ReadNumber(cborPtr, &obsPtr->minPeriod);
+            obsPtr->bitmask |= PARSER_OBS_PERIOD_MASK;
+        }
+        else if (strcmp(memberName, "st") == 0)
+        {
+            result = ReadNumber(cborPtr, &obsPtr->changeBy);
+            obsPtr->bitmask |= PARSER_OBS_CHANGEBY_MASK;
+        }
+        else if (strcmp(memberName, "lt") == 0)
+        {
+            result = ReadNumber(cborPtr, &obsPtr->lowerThan);
+            obsPtr->bitmask |= PARSER_OBS_LOWERTHAN_MASK;
+        }
+        else if (strcmp(memberName, "gt") == 0)
+        {
+            result = ReadNumber(cborPtr, &obsPtr->greaterThan);
+            obsPtr->bitmask |= PARSER_OBS_GREATERTHAN_MASK;
+        }
+        else if (strcmp(memberName, "b") == 0)
+        {
+            double bufferMaxCount = 0;
+            result = ReadNumber(cborPtr, &bufferMaxCount);
+            obsPtr->bufferMaxCount = bufferMaxCount;
+            obsPtr->bitmask |= PARSER_OBS_BUFFER_MASK;
+        }
+        else if (strcmp(memberName, "bp") == 0)
+        {
+            char precision[PARSER_OBS_PRECISION_MAX_BYTES];
+            result = ReadObsText(cborPtr, precision, sizeof(precision),
+                                 "obs buffer precision is invalid");
+            if (   (result == LE_OK)
+                && (parser_TextToBufferPrecision(precision, &obsPtr->bufferPrecision) != LE_OK))
+            {
+                result = HandleError(cborPtr, LE_BAD_PARAMETER, "obs buffer precision is invalid");
+            }
+            obsPtr->bitmask |= PARSER_OBS_PRECISION_MASK;
+        }
+        else if (strcmp(memberName, "f") == 0)
+        {
+            char transform[PARSER_OBS_TRANSFORM_MAX_BYTES];
+            result = ReadObsText(cborPtr, transform, sizeof(transform),
+                                 "obs transform is invalid");
+            obsPtr->transform = parser_FunctionToTransformType(transform);
+            obsPtr->bitmask |= PARSER_OBS_TRANSFORM_MASK;
+        }
+        else if (strcmp(memberName, "fp") == 0)
+        {
+            result = ReadNumber(cborPtr, &obsPtr->transformPeriod);
+            obsPtr->bitmask |= PARSER_OBS_TRANSFORM_PERIOD_MASK;
+        }
+        else if (strcmp(memberName, "s") == 0)
+        {
+            result = ReadObsText(cborPtr, obsPtr->jsonExtraction, PARSER_OBS_JSON_EX_MAX_BYTES,
+                                 "jsonExtraction is too long");
+            obsPtr->bitmask |= PARSER_OBS_JSON_EXT_MASK;
+        }
+        else
+        {
+            //unexpected member, ignore this member:
+            result = SkipNextItem(cborPtr);
+        }
+    }
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    // finished with this obs:
+    // did we get all we expect:
+    if (!(obsPtr->bitmask & PARSER_OBS_RESOURCE_MASK) || !(obsPtr->bitmask & PARSER_OBS_DEST_MASK))
+    {
+        char msg[PARSER_MAX_ERROR_MSG_BYTES] = {0};
+        snprintf(msg, PARSER_MAX_ERROR_MSG_BYTES,
+                 "observation %.10s did not have both r and d",
+                 obsPtr->obsName);
+        return HandleError(cborPtr, LE_FORMAT_ERROR, msg);
+    }
+
+    parser_SetObsDefaults(obsPtr);
+
+    if (cborPtr->env.callbacksPtr->observation)
+    {
+        cborPtr->env.callbacksPtr->observation(obsPtr, cborPtr->env.context);
+    }
+
+    // just need to clear the temp storage for the next observation.
+    memset(&cborPtr->env.tempStorage, 0, sizeof(cborPtr->env.tempStorage));
+
+    return CheckStopped(cborPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse the "o" map.
+ *
+ * @return:
+ *      LE_OK, CBOR_STOPPED, or the error reported.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseObservations
+(
+    CborEnv_t* cborPtr                          ///< [IN] Parse environment.
+)
+{
+    CborHead_t mapHead;
+    le_result_t result = ReadMapHead(cborPtr, &mapHead);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    if (cborPtr->env.callbacksPtr->oObject)
+    {
+        cborPtr->env.callbacksPtr->oObject(cborPtr->env.context);
+    }
+
+    while ((result = CheckStopped(cborPtr)) == LE_OK)
+    {
+        CborHead_t keyHead;
+        bool isEnd;
+
+        result = NextMapKey(cborPtr, &mapHead, &keyHead, &isEnd);
+        if (result != LE_OK)
+        {
+            return result;
+        }
+
+        if (isEnd)
+        {
+            // finished with all observations:
+            if (cborPtr->env.callbacksPtr->oObjectEnd)
+            {
+                cborPtr->env.callbacksPtr->oObjectEnd(cborPtr->env.context);
+            }
+            return CheckStopped(cborPtr);
+        }
+
+        char* obsName = cborPtr->env.tempStorage.o.obsName;
+        result = ReadText(cborPtr, &keyHead, obsName, PARSER_OBSNAME_MAX_BYTES);
+        if (   (result == LE_OVERFLOW)
+            || ((result == LE_OK) && hub_IsResourcePathMalformed(obsName)))
+        {
+            return HandleError(cborPtr, LE_BAD_PARAMETER, "observation name is invalid");
+        }
+        if (result == LE_OK)
+        {
+            result = ParseObservation(cborPtr);
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse the "v" member of a state.
+ *
+ * @return:
+ *      LE_OK, or the error reported.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseStateValue
+(
+    CborEnv_t* cborPtr                          ///< [IN] Parse environment.
+)
+{
+    parser_StateData_t* statePtr = &cborPtr->env.tempStorage.s;
+    CborHead_t head;
+    double number;
+
+    le_result_t result = ReadHead(cborPtr, &head);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    if (GetNumber(&head, &number))
+    {
+        statePtr->dataType = IO_DATA_TYPE_NUMERIC;
+        statePtr->value.number = number;
+    }
+    else if (   (head.major == CBOR_MAJOR_SIMPLE)
+             && ((head.info == CBOR_SIMPLE_FALSE) || (head.info == CBOR_SIMPLE_TRUE)))
+    {
+        statePtr->dataType = IO_DATA_TYPE_BOOLEAN;
+        statePtr->value.boolean = (head.info == CBOR_SIMPLE_TRUE);
+    }
+    else if (head.major == CBOR_MAJOR_TEXT_STRING)
+    {
+        if (statePtr->dataType != IO_DATA_TYPE_JSON)
+        {
+            // if we haven't gotten the "dt" field yet, then we'll assume this string is just
+            // a string type. If there was a "dt" later, then dataType will be corrected.
+            statePtr->dataType = IO_DATA_TYPE_STRING;
+        }
+
+        result = ReadText(cborPtr, &head, statePtr->value.string, PARSER_STATE_MAX_STRING_BYTES);
+        if (result == LE_OVERFLOW)
+        {
+            return HandleError(cborPtr, LE_BAD_PARAMETER, "String value is too long.");
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+    else
+    {
+        return HandleError(cborPtr, LE_FORMAT_ERROR, "Unexpected CBOR item found");
+    }
+
+    statePtr->bitmask |= PARSER_STATE_VALUE_MASK;
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse one state's map into the temporary storage and pass it to the client.
+ *
+ * @return:
+ *      LE_OK, CBOR_STOPPED, or the error reported.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseState
+(
+    CborEnv_t* cborPtr                          ///< [IN] Parse environment.
+)
+{
+    parser_StateData_t* statePtr = &cborPtr->env.tempStorage.s;
+    CborHead_t mapHead;
+    le_result_t result = ReadMapHead(cborPtr, &mapHead);
+
+    while (result == LE_OK)
+    {
+        CborHead_t keyHead;
+        bool isEnd;
+        char memberName[CBOR_MEMBER_NAME_BYTES];
+
+        result = NextMapKey(cborPtr, &mapHead, &keyHead, &isEnd);
+        if ((result != LE_OK) || isEnd)
+        {
+            break;
+        }
+
+        result = ReadText(cborPtr, &keyHead, memberName, sizeof(memberName));
+        if (result == LE_OVERFLOW)
+        {
+            // Too long to be one we know.
+            memberName[0] = '\0';
+        }
+        else if (result != LE_OK)
+        {
+            break;
+        }
+
+        if (strcmp(memberName, "v") == 0)
+        {
+            result = ParseStateValue(cborPtr);
+        }
+        else if (strcmp(memberName, "dt") == 0)
+        {
+            char dataType[CBOR_MEMBER_NAME_BYTES];
+            CborHead_t head;
+
+            result = ReadHead(cborPtr, &head);
+            if (result == LE_OK)
+            {
+                result = ReadText(cborPtr, &head, dataType, sizeof(dataType));
+            }
+
+            // anything other than "json" will be ignored.
+            if ((result == LE_OK) && (strcmp(dataType, "json") == 0))
+            {
+                statePtr->dataType = IO_DATA_TYPE_JSON;
+                statePtr->bitmask |= PARSER_STATE_DATATYPE_MASK;
+            }
+            else if (result == LE_OVERFLOW)
+            {
+                result = LE_OK;
+            }
+        }
+        else
+        {
+            result = SkipNextItem(cborPtr);
+        }
+    }
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    // finished with this state:
+    // did we get all the required fields for a state:
+    if (!(statePtr->bitmask & PARSER_STATE_VALUE_MASK))
+    {
+        return HandleError(cborPtr, LE_FORMAT_ERROR, "state did not have v");
+    }
+
+    if (cborPtr->env.callbacksPtr->state)
+    {
+        cborPtr->env.callbacksPtr->state(statePtr, cborPtr->env.context);
+    }
+
+    // just need to clear the temp storage for the next state.
+    memset(&cborPtr->env.tempStorage, 0, sizeof(cborPtr->env.tempStorage));
+
+    return CheckStopped(cborPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse the "s" map.
+ *
+ * @return:
+ *      LE_OK, CBOR_STOPPED, or the error reported.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseStates
+(
+    CborEnv_t* cborPtr                          ///< [IN] Parse environment.
+)
+{
+    CborHead_t mapHead;
+    le_result_t result = ReadMapHead(cborPtr, &mapHead);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    if (cborPtr->env.callbacksPtr->sObject)
+    {
+        cborPtr->env.callbacksPtr->sObject(cborPtr->env.context);
+    }
+
+    while ((result = CheckStopped(cborPtr)) == LE_OK)
+    {
+        CborHead_t keyHead;
+        bool isEnd;
+
+        result = NextMapKey(cborPtr, &mapHead, &keyHead, &isEnd);
+        if (result != LE_OK)
+        {
+            return result;
+        }
+
+        if (isEnd)
+        {
+            // finished with all states.
+            if (cborPtr->env.callbacksPtr->sObjectEnd)
+            {
+                cborPtr->env.callbacksPtr->sObjectEnd(cborPtr->env.context);
+            }
+            return CheckStopped(cborPtr);
+        }
+
+        char* stateName = cborPtr->env.tempStorage.s.resourcePath;
+        result = ReadText(cborPtr, &keyHead, stateName, PARSER_STATE_MAX_PATH_BYTES);
+        if (   (result == LE_OVERFLOW)
+            || ((result == LE_OK) && hub_IsResourcePathMalformed(stateName)))
+        {
+            return HandleError(cborPtr, LE_BAD_PARAMETER, "state key is invalid");
+        }
+        if (result == LE_OK)
+        {
+            result = ParseState(cborPtr);
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse the "a" map.  The action contents are not supported yet, so only their IDs are passed
+ *  to the client.
+ *
+ * @return:
+ *      LE_OK, CBOR_STOPPED, or the error reported.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseActions
+(
+    CborEnv_t* cborPtr                          ///< [IN] Parse environment.
+)
+{
+    CborHead_t mapHead;
+    le_result_t result = ReadMapHead(cborPtr, &mapHead);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    if (cborPtr->env.callbacksPtr->aObject)
+    {
+        cborPtr->env.callbacksPtr->aObject(cborPtr->env.context);
+    }
+
+    while ((result = CheckStopped(cborPtr)) == LE_OK)
+    {
+        CborHead_t keyHead;
+        bool isEnd;
+        char actionId[IO_MAX_RESOURCE_PATH_LEN + 1];
+
+        result = NextMapKey(cborPtr, &mapHead, &keyHead, &isEnd);
+        if ((result != LE_OK) || isEnd)
+        {
+            return result;
+        }
+
+        result = ReadText(cborPtr, &keyHead, actionId, sizeof(actionId));
+        if (result == LE_OVERFLOW)
+        {
+            return HandleError(cborPtr, LE_BAD_PARAMETER, "action id is invalid");
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+
+        if (cborPtr->env.callbacksPtr->actionId)
+        {
+            cborPtr->env.callbacksPtr->actionId(actionId, cborPtr->env.context);
+        }
+
+        result = CheckStopped(cborPtr);
+        if (result == LE_OK)
+        {
+            result = SkipNextItem(cborPtr);
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse the root map.
+ *
+ * @return:
+ *      LE_OK, CBOR_STOPPED, or the error reported.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseRoot
+(
+    CborEnv_t* cborPtr                          ///< [IN] Parse environment.
+)
+{
+    parser_Callbacks_t* callbacksPtr = cborPtr->env.callbacksPtr;
+    CborHead_t mapHead;
+    le_result_t result = ReadMapHead(cborPtr, &mapHead);
+
+    while (result == LE_OK)
+    {
+        CborHead_t keyHead;
+        bool isEnd;
+        char memberName[CBOR_MEMBER_NAME_BYTES];
+
+        result = NextMapKey(cborPtr, &mapHead, &keyHead, &isEnd);
+        if (result != LE_OK)
+        {
+            break;
+        }
+
+        if (isEnd)
+        {
+            if (callbacksPtr->endOfParse)
+            {
+                callbacksPtr->endOfParse(cborPtr->env.context);
+            }
+            break;
+        }
+
+        result = ReadText(cborPtr, &keyHead, memberName, sizeof(memberName));
+        if (result == LE_OVERFLOW)
+        {
+            // Too long to be one we know.
+            memberName[0] = '\0';
+        }
+        else if (result != LE_OK)
+        {
+            break;
+        }
+
+        if (strcmp(memberName, "o") == 0)
+        {
+            // observations:
+            result = ParseObservations(cborPtr);
+        }
+        else if (strcmp(memberName, "s") == 0)
+        {
+            // states:
+            result = ParseStates(cborPtr);
+        }
+        else if (strcmp(memberName, "a") == 0)
+        {
+            // actions:
+            result = ParseActions(cborPtr);
+        }
+        else if (strcmp(memberName, "t") == 0)
+        {
+            // type
+            double type = 0;
+            result = ReadNumber(cborPtr, &type);
+            if ((result == LE_OK) && callbacksPtr->type)
+            {
+                callbacksPtr->type((int)type, cborPtr->env.context);
+                result = CheckStopped(cborPtr);
+            }
+        }
+        else if (strcmp(memberName, "v") == 0)
+        {
+            // version:
+            char version[CBOR_VERSION_BYTES];
+            result = ReadObsText(cborPtr, version, sizeof(version), "version is too long");
+            if ((result == LE_OK) && callbacksPtr->version)
+            {
+                callbacksPtr->version(version, cborPtr->env.context);
+                result = CheckStopped(cborPtr);
+            }
+        }
+        else if (strcmp(memberName, "ts") == 0)
+        {
+            // timestamp
+            double timeStamp = 0;
+            result = ReadNumber(cborPtr, &timeStamp);
+            if ((result == LE_OK) && callbacksPtr->timeStamp)
+            {
+                callbacksPtr->timeStamp(timeStamp, cborPtr->env.context);
+                result = CheckStopped(cborPtr);
+            }
+        }
+        else
+        {
+            // unknown root object member, we will ignore this entire object.
+            result = SkipNextItem(cborPtr);
+        }
+    }
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Public functions:
+ */
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse a CBOR-encoded file.
+ *
+ *  The file has the same structure as a JSON one, with CBOR maps for objects, text strings for
+ *  strings and keys, and integers or floating point numbers for numbers.  The same callbacks are
+ *  called, in the same order, as for the JSON equivalent.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void parser_ParseCbor
+(
+    int fd,                                          ///< [IN] file descriptor to be parsed.
+    parser_Callbacks_t* callbacksPtr,                ///< [IN] Pointer to callback structure
+    void* context                                    ///< [IN] Context to provide to callbacks
+)
+{
+    CborEnv_t cborEnv;
+
+    if (parser_StartSession(&cborEnv.env, fd, callbacksPtr, context))
+    {
+        cborEnv.env.isCbor = true;
+        cborEnv.buffLen = 0;
+        cborEnv.buffPos = 0;
+
+        le_result_t result = ParseRoot(&cborEnv);
+        if ((result != LE_OK) && (result != CBOR_STOPPED))
+        {
+            LE_DEBUG("CBOR parse ended with error %s after %" PRIuS " bytes.",
+                     LE_RESULT_TXT(result),
+                     cborEnv.env.bytesRead);
+        }
+
+        parser_EndSession();
+    }
+}
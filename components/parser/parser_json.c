@@ -17,34 +17,7 @@
 #include "ioService.h"
 
 #include "parser.h"
-
-//--------------------------------------------------------------------------------------------------
-/**
- *  Temporary storage to use during parse.
- */
-//--------------------------------------------------------------------------------------------------
-typedef union TempStorage
-{
-    parser_ObsData_t o;
-    parser_StateData_t s;
-} tempStorage_t;
-
-//--------------------------------------------------------------------------------------------------
-/**
- *  Holds the parse environment parameters.
- */
-//--------------------------------------------------------------------------------------------------
-typedef struct ParseEnv
-{
-    int fd;                                 ///< File descriptor.
-    parser_Callbacks_t* callbacksPtr;       ///< Callbacks structure
-    tempStorage_t tempStorage;              ///< Temp storage for observation or state data.
-    bool stopped;                           ///< Whether the parse has been stopped by the client.
-    le_json_EventHandler_t fallbackHandler; ///< Sometimes we have to ignore an entire json object,
-                                            /// this field holds a handler to use when we are
-                                            /// finished with that object.
-    void* context;                          ///< User context.
-} ParseEnv_t;
+#include "parser_session.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -68,7 +41,9 @@ static void ExpectObsChangeBy         (le_json_Event_t event);
 static void ExpectObsLowerThan        (le_json_Event_t event);
 static void ExpectObsGreaterThan      (le_json_Event_t event);
 static void ExpectObsMaxBuffer        (le_json_Event_t event);
+static void ExpectObsBufferPrecision  (le_json_Event_t event);
 static void ExpectObsTransformFunction(le_json_Event_t event);
+static void ExpectObsTransformPeriod  (le_json_Event_t event);
 static void ExpectObsJsonExtraction   (le_json_Event_t event);
 static void ExpectObsMember           (le_json_Event_t event);
 static void ExpectOneObsStart         (le_json_Event_t event);
@@ -413,6 +388,39 @@ static void ExpectObsMaxBuffer
     }
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ *  le_json event handler that expects the "bp" member of an observation.
+ * This field holds the buffer precision of an observation ("full" or "compact").
+ */
+//--------------------------------------------------------------------------------------------------
+static void ExpectObsBufferPrecision
+(
+    le_json_Event_t event                          ///< [IN] The le_json event.
+)
+{
+    ParseEnv_t* parseEnvPtr = le_json_GetOpaquePtr();
+    if (event == LE_JSON_STRING)
+    {
+        // cache the value in temp storage:
+        if (parser_TextToBufferPrecision(le_json_GetString(),
+                                         &parseEnvPtr->tempStorage.o.bufferPrecision) != LE_OK)
+        {
+            HandleError(LE_BAD_PARAMETER, "obs buffer precision is invalid");
+            return;
+        }
+
+        // set the bitmask so we know we've received this field:
+        parseEnvPtr->tempStorage.o.bitmask |= PARSER_OBS_PRECISION_MASK;
+
+        GoToNextState(ExpectObsMember);
+    }
+    else
+    {
+        HandleError(LE_FORMAT_ERROR, "Unexpected JSON element found");
+    }
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Convert function text to transform type:
@@ -424,7 +432,7 @@ static void ExpectObsMaxBuffer
  *      obs transform type.
  */
 //--------------------------------------------------------------------------------------------------
-static admin_TransformType_t FunctionToTransformType
+admin_TransformType_t parser_FunctionToTransformType
 (
     const char* function            ///< [IN] transform function name in the config file.
 )
@@ -445,9 +453,103 @@ static admin_TransformType_t FunctionToTransformType
     {
         return ADMIN_OBS_TRANSFORM_TYPE_MAX;
     }
+    else if (strncmp(function, "bmean", PARSER_OBS_TRANSFORM_MAX_BYTES) == 0)
+    {
+        return ADMIN_OBS_TRANSFORM_TYPE_BUCKET_MEAN;
+    }
+    else if (strncmp(function, "bmin", PARSER_OBS_TRANSFORM_MAX_BYTES) == 0)
+    {
+        return ADMIN_OBS_TRANSFORM_TYPE_BUCKET_MIN;
+    }
+    else if (strncmp(function, "bmax", PARSER_OBS_TRANSFORM_MAX_BYTES) == 0)
+    {
+        return ADMIN_OBS_TRANSFORM_TYPE_BUCKET_MAX;
+    }
+    else if (strncmp(function, "blast", PARSER_OBS_TRANSFORM_MAX_BYTES) == 0)
+    {
+        return ADMIN_OBS_TRANSFORM_TYPE_BUCKET_LAST;
+    }
     return ADMIN_OBS_TRANSFORM_TYPE_NONE;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert buffer precision text ("full" or "compact") to a buffer precision.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_BAD_PARAMETER if the text is not a buffer precision.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t parser_TextToBufferPrecision
+(
+    const char* text,                               ///< [IN] precision text in the config file.
+    admin_BufferPrecision_t* precisionPtr           ///< [OUT] the buffer precision.
+)
+{
+    if (strncmp(text, "full", PARSER_OBS_PRECISION_MAX_BYTES) == 0)
+    {
+        *precisionPtr = ADMIN_BUFFER_PRECISION_FULL;
+    }
+    else if (strncmp(text, "compact", PARSER_OBS_PRECISION_MAX_BYTES) == 0)
+    {
+        *precisionPtr = ADMIN_BUFFER_PRECISION_COMPACT;
+    }
+    else
+    {
+        return LE_BAD_PARAMETER;
+    }
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Fill in the default values of the optional fields that were missing from an observation.
+ */
+//--------------------------------------------------------------------------------------------------
+void parser_SetObsDefaults
+(
+    parser_ObsData_t* obsDataPtr                     ///< [INOUT] The observation's data.
+)
+{
+    if (!(obsDataPtr->bitmask & PARSER_OBS_PERIOD_MASK))
+    {
+        obsDataPtr->minPeriod = NAN;
+    }
+    if (!(obsDataPtr->bitmask & PARSER_OBS_CHANGEBY_MASK))
+    {
+        obsDataPtr->changeBy = NAN;
+    }
+    if (!(obsDataPtr->bitmask & PARSER_OBS_LOWERTHAN_MASK))
+    {
+        obsDataPtr->lowerThan = NAN;
+    }
+    if (!(obsDataPtr->bitmask & PARSER_OBS_GREATERTHAN_MASK))
+    {
+        obsDataPtr->greaterThan = NAN;
+    }
+    if (!(obsDataPtr->bitmask & PARSER_OBS_BUFFER_MASK))
+    {
+        obsDataPtr->bufferMaxCount = 0;
+    }
+    if (!(obsDataPtr->bitmask & PARSER_OBS_PRECISION_MASK))
+    {
+        obsDataPtr->bufferPrecision = ADMIN_BUFFER_PRECISION_FULL;
+    }
+    if (!(obsDataPtr->bitmask & PARSER_OBS_TRANSFORM_MASK))
+    {
+        obsDataPtr->transform = ADMIN_OBS_TRANSFORM_TYPE_NONE;
+    }
+    if (!(obsDataPtr->bitmask & PARSER_OBS_TRANSFORM_PERIOD_MASK))
+    {
+        obsDataPtr->transformPeriod = NAN;
+    }
+    if (!(obsDataPtr->bitmask & PARSER_OBS_JSON_EXT_MASK))
+    {
+        obsDataPtr->jsonExtraction[0] = '\0';
+    }
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  le_json event handler that expects the "f" member of an observation.
@@ -474,7 +576,34 @@ static void ExpectObsTransformFunction
         // set the bitmask so we know we've received this field:
         parseEnvPtr->tempStorage.o.bitmask |= PARSER_OBS_TRANSFORM_MASK;
         // cache the value in temp storage:
-        parseEnvPtr->tempStorage.o.transform = FunctionToTransformType(transform);
+        parseEnvPtr->tempStorage.o.transform = parser_FunctionToTransformType(transform);
+
+        GoToNextState(ExpectObsMember);
+    }
+    else
+    {
+        HandleError(LE_FORMAT_ERROR, "Unexpected JSON element found");
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  le_json event handler that expects the "fp" member of an observation.
+ * This field holds the bucket period of an observation's transform.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ExpectObsTransformPeriod
+(
+    le_json_Event_t event                          ///< [IN] The le_json event.
+)
+{
+    ParseEnv_t* parseEnvPtr = le_json_GetOpaquePtr();
+    if (event == LE_JSON_NUMBER)
+    {
+        // set the bitmask so we know we've received this field:
+        parseEnvPtr->tempStorage.o.bitmask |= PARSER_OBS_TRANSFORM_PERIOD_MASK;
+        // cache the value in temp storage:
+        parseEnvPtr->tempStorage.o.transformPeriod = le_json_GetNumber();
 
         GoToNextState(ExpectObsMember);
     }
@@ -558,10 +687,18 @@ static void ObsMemberHelper
     {
         GoToNextState(ExpectObsMaxBuffer);
     }
+    else if (strcmp(memberName, "bp") == 0)
+    {
+        GoToNextState(ExpectObsBufferPrecision);
+    }
     else if (strcmp(memberName, "f") == 0)
     {
         GoToNextState(ExpectObsTransformFunction);
     }
+    else if (strcmp(memberName, "fp") == 0)
+    {
+        GoToNextState(ExpectObsTransformPeriod);
+    }
     else if (strcmp(memberName, "s") == 0)
     {
         GoToNextState(ExpectObsJsonExtraction);
@@ -598,34 +735,7 @@ static void ExpectObsMember
         {
             // have what we need:
             // set missing fields:
-            if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_PERIOD_MASK))
-            {
-                parseEnvPtr->tempStorage.o.minPeriod = NAN;
-            }
-            if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_CHANGEBY_MASK))
-            {
-                parseEnvPtr->tempStorage.o.changeBy = NAN;
-            }
-            if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_LOWERTHAN_MASK))
-            {
-                parseEnvPtr->tempStorage.o.lowerThan = NAN;
-            }
-            if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_GREATERTHAN_MASK))
-            {
-                parseEnvPtr->tempStorage.o.greaterThan = NAN;
-            }
-            if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_BUFFER_MASK))
-            {
-                parseEnvPtr->tempStorage.o.bufferMaxCount = 0;
-            }
-            if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_TRANSFORM_MASK))
-            {
-                parseEnvPtr->tempStorage.o.transform = ADMIN_OBS_TRANSFORM_TYPE_NONE;
-            }
-            if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_JSON_EXT_MASK))
-            {
-                parseEnvPtr->tempStorage.o.jsonExtraction[0] = '\0';
-            }
+            parser_SetObsDefaults(&(parseEnvPtr->tempStorage.o));
             // call the callback:
             if (parseEnvPtr->callbacksPtr->observation)
             {
@@ -1244,7 +1354,11 @@ LE_SHARED size_t parser_GetNumBytesRead
 (
 )
 {
-    if (CurrParseSessionRef)
+    if (CurrParseSessionRef && CurrParseSessionRef->isCbor)
+    {
+        return CurrParseSessionRef->bytesRead;
+    }
+    else if (CurrParseSessionRef)
     {
         return le_json_GetBytesRead(le_json_GetSession());
     }
@@ -1279,11 +1393,15 @@ LE_SHARED parser_Callbacks_t* parser_GetCallbacks
 
 //--------------------------------------------------------------------------------------------------
 /**
- *  Parse a file.
+ *  Start a parse session.  Reports an error to the client if a parse session can't be started.
+ *
+ * @return:
+ *      true if the session was started (parser_EndSession() must then be called when done).
  */
 //--------------------------------------------------------------------------------------------------
-LE_SHARED void parser_Parse
+bool parser_StartSession
 (
+    ParseEnv_t* parseEnvPtr,                         ///< [OUT] Environment for the session.
     int fd,                                          ///< [IN] file descriptor to be parsed.
     parser_Callbacks_t* callbacksPtr,                ///< [IN] Pointer to callback structure
     void* context                                    ///< [IN] Context to provide to callbacks
@@ -1294,21 +1412,54 @@ LE_SHARED void parser_Parse
         // there is another parse ongoing,
         // currently we only support one parse at the time.
         callbacksPtr->error(LE_BUSY, "Another parse is ongoing", context);
+        return false;
     }
     else if (fd < 0)
     {
         callbacksPtr->error(LE_IO_ERROR, "Invalid Fd", context);
+        return false;
     }
-    else
+
+    memset(parseEnvPtr, 0, sizeof(*parseEnvPtr));
+    parseEnvPtr->fd = fd;
+    parseEnvPtr->callbacksPtr = (callbacksPtr)? callbacksPtr : (&parseEnvPtr->emptyCallbacks);
+    parseEnvPtr->context = context;
+    CurrParseSessionRef = parseEnvPtr;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  End the current parse session.
+ */
+//--------------------------------------------------------------------------------------------------
+void parser_EndSession
+(
+    void
+)
+{
+    CurrParseSessionRef = NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse a file.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void parser_Parse
+(
+    int fd,                                          ///< [IN] file descriptor to be parsed.
+    parser_Callbacks_t* callbacksPtr,                ///< [IN] Pointer to callback structure
+    void* context                                    ///< [IN] Context to provide to callbacks
+)
+{
+    ParseEnv_t parseEnv;
+
+    if (parser_StartSession(&parseEnv, fd, callbacksPtr, context))
     {
-        parser_Callbacks_t emptyCallbacks = {0};
-        ParseEnv_t parseEnv = {0};
-        parseEnv.fd = fd;
-        parseEnv.callbacksPtr = (callbacksPtr)? callbacksPtr : (&emptyCallbacks);
-        parseEnv.context = context;
-        CurrParseSessionRef = &parseEnv;
         le_json_SyncParse(fd, ExpectConfigStart, ErrorEventHandler, &parseEnv);
-        CurrParseSessionRef = NULL;
+        parser_EndSession();
     }
 }
 
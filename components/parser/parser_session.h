@@ -0,0 +1,114 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file parser_session.h
+ *
+ *  Parse session state shared by the file parser front ends (JSON and CBOR).
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef PARSER_SESSION_H_INCLUDE_GUARD
+#define PARSER_SESSION_H_INCLUDE_GUARD
+
+#include "parser.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Temporary storage to use during parse.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef union TempStorage
+{
+    parser_ObsData_t o;
+    parser_StateData_t s;
+} tempStorage_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Holds the parse environment parameters.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct ParseEnv
+{
+    int fd;                                 ///< File descriptor.
+    parser_Callbacks_t* callbacksPtr;       ///< Callbacks structure
+    parser_Callbacks_t emptyCallbacks;      ///< Used if the client provided no callbacks.
+    tempStorage_t tempStorage;              ///< Temp storage for observation or state data.
+    bool stopped;                           ///< Whether the parse has been stopped by the client.
+    le_json_EventHandler_t fallbackHandler; ///< Sometimes we have to ignore an entire json object,
+                                            /// this field holds a handler to use when we are
+                                            /// finished with that object.
+    void* context;                          ///< User context.
+    bool isCbor;                            ///< true if parsing CBOR rather than JSON.
+    size_t bytesRead;                       ///< Number of bytes consumed so far (CBOR only).
+} ParseEnv_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Start a parse session.  Reports an error to the client if a parse session can't be started.
+ *
+ * @return:
+ *      true if the session was started (parser_EndSession() must then be called when done).
+ */
+//--------------------------------------------------------------------------------------------------
+bool parser_StartSession
+(
+    ParseEnv_t* parseEnvPtr,                         ///< [OUT] Environment for the session.
+    int fd,                                          ///< [IN] file descriptor to be parsed.
+    parser_Callbacks_t* callbacksPtr,                ///< [IN] Pointer to callback structure
+    void* context                                    ///< [IN] Context to provide to callbacks
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  End the current parse session.
+ */
+//--------------------------------------------------------------------------------------------------
+void parser_EndSession
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Fill in the default values of the optional fields that were missing from an observation.
+ */
+//--------------------------------------------------------------------------------------------------
+void parser_SetObsDefaults
+(
+    parser_ObsData_t* obsDataPtr                     ///< [INOUT] The observation's data.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert function text to transform type:
+ *
+ * @note:
+ * we won't validate the function to keep the current behavior, if text is unknown,
+ * ADMIN_OBS_TRANSFORM_TYPE_NONE will be applied.
+ * @return
+ *      obs transform type.
+ */
+//--------------------------------------------------------------------------------------------------
+admin_TransformType_t parser_FunctionToTransformType
+(
+    const char* function            ///< [IN] transform function name in the config file.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert buffer precision text ("full" or "compact") to a buffer precision.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_BAD_PARAMETER if the text is not a buffer precision.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t parser_TextToBufferPrecision
+(
+    const char* text,                               ///< [IN] precision text in the config file.
+    admin_BufferPrecision_t* precisionPtr           ///< [OUT] the buffer precision.
+);
+
+#endif // PARSER_SESSION_H_INCLUDE_GUARD
@@ -11,6 +11,24 @@
 #include "periodicSensor.h"
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Group of the sensors that are being sampled at the same period.
+ *
+ * All the sensors of a group are sampled one after the other when the group is due, and every
+ * group is due at multiples of its period, so that groups whose periods are multiples of each
+ * other are also sampled in the same wake-up.  A single timer serves all the groups.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t link;         ///< Used to link into the PeriodGroupList.
+    double period;              ///< seconds
+    double nextDueTime;         ///< When the group is next due (seconds, relative clock).
+    le_dls_List_t sensorList;   ///< Sensors being sampled at this period.
+}
+PeriodGroup_t;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sensor Scaffold object.
@@ -20,7 +38,8 @@ typedef struct psensor
 {
     bool isEnabled;
     double period;  ///< seconds (0.0 = not set yet)
-    le_timer_Ref_t timer;
+    PeriodGroup_t* groupPtr;    ///< Group the sensor is being sampled in (NULL if not sampling).
+    le_dls_Link_t groupLink;    ///< Used to link into the group's sensorList.
     void (*sampleFunc)(psensor_Ref_t, void *);
     void *sampleFuncContext;
     char name[PSENSOR_MAX_NAME_BYTES];
@@ -42,10 +61,245 @@ Sensor_t;
 static le_mem_PoolRef_t SensorPool = NULL;
 LE_MEM_DEFINE_STATIC_POOL(SensorPool, DEFAULT_POOL_SIZE, sizeof(Sensor_t));
 
+/// Default number of different sampling periods.  This may be overridden in the .cdef.  The pool
+/// is expanded from the heap on Linux, but on RTOS it caps the number of different periods that
+/// enabled sensors can be sampled at, and sensors at any further period aren't sampled.
+#define DEFAULT_PERIOD_GROUP_POOL_SIZE 4
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which PeriodGroup_t objects are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t PeriodGroupPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(PeriodGroupPool, DEFAULT_PERIOD_GROUP_POOL_SIZE, sizeof(PeriodGroup_t));
+
+/// Groups that are due within this many seconds of each other are sampled in the same wake-up.
+#define COALESCE_WINDOW 0.001
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * List of period groups.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t PeriodGroupList = LE_DLS_LIST_INIT;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer used to wake up when the next period group is due.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_timer_Ref_t SampleTimer = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true while the sensors of the due groups are being sampled.  Empty groups are only deleted
+ * when this is false.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsSampling = false;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * While IsSampling, link of the next sensor to sample in the group being sampled.  Kept up to
+ * date if that sensor stops being sampled by the sample function of the one before it.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_Link_t* NextSensorLinkPtr = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current time on the relative clock.
+ *
+ * @return The time in seconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetNow
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return now.sec + (((double)now.usec) / 1000000);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the first multiple of a period that is after a given time.
+ *
+ * @return The time in seconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetNextMultiple
+(
+    double time,    ///< seconds
+    double period   ///< seconds
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return ((double)(uint64_t)(time / period) + 1) * period;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete the period groups that no longer have any sensors, then start the timer to expire when
+ * the next remaining group is due.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ScheduleSampleTimer
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    double nextDueTime = 0.0;
+    bool isAnyGroup = false;
+
+    le_timer_Stop(SampleTimer);
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&PeriodGroupList);
+    while (linkPtr != NULL)
+    {
+        PeriodGroup_t* groupPtr = CONTAINER_OF(linkPtr, PeriodGroup_t, link);
+        linkPtr = le_dls_PeekNext(&PeriodGroupList, linkPtr);
+
+        if (le_dls_IsEmpty(&groupPtr->sensorList))
+        {
+            le_dls_Remove(&PeriodGroupList, &groupPtr->link);
+            le_mem_Release(groupPtr);
+        }
+        else if ((!isAnyGroup) || (groupPtr->nextDueTime < nextDueTime))
+        {
+            nextDueTime = groupPtr->nextDueTime;
+            isAnyGroup = true;
+        }
+    }
+
+    if (isAnyGroup)
+    {
+        double delay = nextDueTime - GetNow();
+        le_clk_Time_t interval = { .sec = 0, .usec = 1 };
+
+        if (delay > 0.0)
+        {
+            interval.sec = (time_t)delay;
+            interval.usec = (delay - interval.sec) * 1000000;
+        }
+
+        le_timer_SetInterval(SampleTimer, interval);
+        le_timer_Start(SampleTimer);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start sampling a sensor periodically, at its period.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NO_MEMORY if the sensor's period needs a new period group and the pool is full (RTOS).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t StartSampling
+(
+    Sensor_t* sensorPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    PeriodGroup_t* groupPtr = NULL;
+
+    LE_ASSERT(sensorPtr->groupPtr == NULL);
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&PeriodGroupList);
+    while (linkPtr != NULL)
+    {
+        PeriodGroup_t* candidatePtr = CONTAINER_OF(linkPtr, PeriodGroup_t, link);
+
+        if (candidatePtr->period == sensorPtr->period)
+        {
+            groupPtr = candidatePtr;
+            break;
+        }
+
+        linkPtr = le_dls_PeekNext(&PeriodGroupList, linkPtr);
+    }
+
+    if (groupPtr == NULL)
+    {
+#if LE_CONFIG_LINUX
+        groupPtr = le_mem_Alloc(PeriodGroupPool);
+#else
+        groupPtr = le_mem_TryAlloc(PeriodGroupPool);
+        if (groupPtr == NULL)
+        {
+            LE_ERROR("Too many different periods to sample sensor '%s' every %lf s.",
+                     sensorPtr->name,
+                     sensorPtr->period);
+            return LE_NO_MEMORY;
+        }
+#endif
+        groupPtr->link = LE_DLS_LINK_INIT;
+        groupPtr->period = sensorPtr->period;
+        groupPtr->nextDueTime = GetNextMultiple(GetNow(), sensorPtr->period);
+        groupPtr->sensorList = LE_DLS_LIST_INIT;
+        le_dls_Queue(&PeriodGroupList, &groupPtr->link);
+    }
+
+    sensorPtr->groupLink = LE_DLS_LINK_INIT;
+    le_dls_Queue(&groupPtr->sensorList, &sensorPtr->groupLink);
+    sensorPtr->groupPtr = groupPtr;
+
+    if (!IsSampling)
+    {
+        ScheduleSampleTimer();
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop sampling a sensor periodically.  Does nothing if it isn't being sampled.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StopSampling
+(
+    Sensor_t* sensorPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    PeriodGroup_t* groupPtr = sensorPtr->groupPtr;
+
+    if (groupPtr == NULL)
+    {
+        return;
+    }
+
+    if (NextSensorLinkPtr == &sensorPtr->groupLink)
+    {
+        NextSensorLinkPtr = le_dls_PeekNext(&groupPtr->sensorList, NextSensorLinkPtr);
+    }
+
+    le_dls_Remove(&groupPtr->sensorList, &sensorPtr->groupLink);
+    sensorPtr->groupPtr = NULL;
+
+    if (!IsSampling)
+    {
+        ScheduleSampleTimer();
+    }
+}
+
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Timer expiry handler function.
+ * Timer expiry handler function.  Samples all the sensors of the period groups that are due.
  */
 //--------------------------------------------------------------------------------------------------
 static void HandleTimerExpiry
@@ -54,9 +308,44 @@ static void HandleTimerExpiry
 )
 //--------------------------------------------------------------------------------------------------
 {
-    Sensor_t* sensorPtr = le_timer_GetContextPtr(timer);
+    LE_UNUSED(timer);
+
+    double now = GetNow();
 
-    sensorPtr->sampleFunc(sensorPtr, sensorPtr->sampleFuncContext);
+    IsSampling = true;
+
+    le_dls_Link_t* groupLinkPtr = le_dls_Peek(&PeriodGroupList);
+    while (groupLinkPtr != NULL)
+    {
+        PeriodGroup_t* groupPtr = CONTAINER_OF(groupLinkPtr, PeriodGroup_t, link);
+
+        if (groupPtr->nextDueTime <= (now + COALESCE_WINDOW))
+        {
+            // If samples were missed (e.g., the system was suspended), skip them.
+            groupPtr->nextDueTime += groupPtr->period;
+            if (groupPtr->nextDueTime <= now)
+            {
+                groupPtr->nextDueTime = GetNextMultiple(now, groupPtr->period);
+            }
+
+            le_dls_Link_t* sensorLinkPtr = le_dls_Peek(&groupPtr->sensorList);
+            while (sensorLinkPtr != NULL)
+            {
+                Sensor_t* sensorPtr = CONTAINER_OF(sensorLinkPtr, Sensor_t, groupLink);
+
+                NextSensorLinkPtr = le_dls_PeekNext(&groupPtr->sensorList, sensorLinkPtr);
+                sensorPtr->sampleFunc(sensorPtr, sensorPtr->sampleFuncContext);
+                sensorLinkPtr = NextSensorLinkPtr;
+            }
+            NextSensorLinkPtr = NULL;
+        }
+
+        groupLinkPtr = le_dls_PeekNext(&PeriodGroupList, groupLinkPtr);
+    }
+
+    IsSampling = false;
+
+    ScheduleSampleTimer();
 }
 
 
@@ -83,16 +372,16 @@ static void HandleEnablePush
 
         if (enable)
         {
-            // If the period has been set, take a sample and start the timer.
+            // If the period has been set, take a sample and start sampling periodically.
             if (sensorPtr->period > 0.0)
             {
                 sensorPtr->sampleFunc(sensorPtr, sensorPtr->sampleFuncContext);
-                le_timer_Start(sensorPtr->timer);
+                StartSampling(sensorPtr);
             }
         }
         else
         {
-            le_timer_Stop(sensorPtr->timer);
+            StopSampling(sensorPtr);
         }
     }
 }
@@ -119,37 +408,38 @@ static void HandlePeriodPush
     if (sensorPtr->period != period)
     {
         // Sanity check the period.
-        // If it's invalid, stop the timer and set the period to 0.0.
+        // If it's invalid, stop sampling and set the period to 0.0.
         if (period <= 0.0)
         {
             LE_ERROR("Timer period %lf is out of range. Must be > 0.", period);
-            le_timer_Stop(sensorPtr->timer);
+            StopSampling(sensorPtr);
             sensorPtr->period = 0.0;
         }
         else if (period > (double)(0x7FFFFFFF)) // Don't know how big time_t is, assume 32-bits.
         {
             LE_ERROR("Timer period %lf is too high.", period);
-            le_timer_Stop(sensorPtr->timer);
+            StopSampling(sensorPtr);
             sensorPtr->period = 0.0;
         }
         else
         {
             // The new period is good.
-            // Set the timer's interval to the period.
-            le_clk_Time_t interval;
-            interval.sec = (time_t)period;
-            interval.usec = (period - interval.sec) * 1000000;
-            le_timer_SetInterval(sensorPtr->timer, interval);
-
-            // If the old value was zero and the sensor is enabled, take a sample and
-            // start the timer now.
-            if ((sensorPtr->period == 0) && sensorPtr->isEnabled)
-            {
-                sensorPtr->sampleFunc(sensorPtr, sensorPtr->sampleFuncContext);
-                le_timer_Start(sensorPtr->timer);
-            }
+            // If the old value was zero and the sensor is enabled, take a sample now.
+            bool isFirstPeriod = (sensorPtr->period == 0);
 
+            StopSampling(sensorPtr);
             sensorPtr->period = period;
+
+            if (sensorPtr->isEnabled)
+            {
+                if (isFirstPeriod)
+                {
+                    sensorPtr->sampleFunc(sensorPtr, sensorPtr->sampleFuncContext);
+                }
+
+                // Move the sensor to the group of its new period.
+                StartSampling(sensorPtr);
+            }
         }
     }
 }
@@ -209,7 +499,7 @@ static void BuildResourcePath
 /**
  * Creates a periodic sensor scaffold for a sensor with a given name.
  *
- * This makes the sensor appear in the Data Hub and creates a timer for that sensor.
+ * This makes the sensor appear in the Data Hub and schedules its sampling.
  * The sampleFunc will be called whenever it's time to take a sample.  The sampleFunc must
  * call one of the psensor_PushX() functions below.
  *
@@ -231,11 +521,8 @@ psensor_Ref_t psensor_Create
 
     sensorPtr->isEnabled = false;
     sensorPtr->period = 0.0;
-
-    sensorPtr->timer = le_timer_Create(name);
-    le_timer_SetRepeat(sensorPtr->timer, 0); // Repeat an infinite number of times.
-    le_timer_SetHandler(sensorPtr->timer, HandleTimerExpiry);
-    le_timer_SetContextPtr(sensorPtr->timer, sensorPtr);
+    sensorPtr->groupPtr = NULL;
+    sensorPtr->groupLink = LE_DLS_LINK_INIT;
 
     sensorPtr->sampleFunc = sampleFunc;
     sensorPtr->sampleFuncContext = sampleFuncContext;
@@ -288,7 +575,7 @@ psensor_Ref_t psensor_Create
 /**
  * Creates a periodic sensor scaffold for a sensor with a given name that produces JSON samples.
  *
- * This makes the sensor appear in the Data Hub and creates a timer for that sensor.
+ * This makes the sensor appear in the Data Hub and schedules its sampling.
  * The sampleFunc will be called whenever it's time to take a sample.  The sampleFunc is supposed
  * to call psensor_PushJson() to push the JSON sample.
  *
@@ -342,9 +629,8 @@ void psensor_Destroy
     {
         sensorPtr->isEnabled = false;
 
-        // Stop and delete timer
-        (void)le_timer_Stop (sensorPtr->timer);
-        le_timer_Delete(sensorPtr->timer);
+        // Stop sampling
+        StopSampling(sensorPtr);
 
         // Deregister handlers and remove resources
         BuildResourcePath(path, sizeof(path), sensorPtr, "trigger");
@@ -458,4 +744,10 @@ void psensor_PushJson
 COMPONENT_INIT
 {
     SensorPool = le_mem_InitStaticPool(SensorPool, DEFAULT_POOL_SIZE, sizeof(Sensor_t));
+    PeriodGroupPool = le_mem_InitStaticPool(PeriodGroupPool,
+                                            DEFAULT_PERIOD_GROUP_POOL_SIZE,
+                                            sizeof(PeriodGroup_t));
+
+    SampleTimer = le_timer_Create("psensor");
+    le_timer_SetHandler(SampleTimer, HandleTimerExpiry);
 }
@@ -20,6 +20,13 @@
  *
  * psensor_Destroy() can be used to destroy a previously created sensor scaffold.
  *
+ * All the sensors are sampled from a single timer.  Sensors that have the same period are sampled
+ * one after the other in the same wake-up, at multiples of that period, so the number of wake-ups
+ * depends on the number of different periods in use rather than on the number of sensors.  On
+ * RTOS, the number of different periods is limited by the size of the PeriodGroupPool (4 by
+ * default).  A sensor whose period would be one too many isn't sampled periodically (it can still
+ * be triggered) until it is enabled again or its period changes.
+ *
  * Copyright (C) Sierra Wireless Inc.
  */
 //--------------------------------------------------------------------------------------------------
@@ -53,7 +60,7 @@ typedef struct psensor* psensor_Ref_t;
 /**
  * Creates a periodic sensor scaffold for a sensor with a given name.
  *
- * This makes the sensor appear in the Data Hub and creates a timer for that sensor.
+ * This makes the sensor appear in the Data Hub and schedules its sampling.
  * The sampleFunc will be called whenever it's time to take a sample.  The sampleFunc should
  * call one of the psensor_PushX() functions defined in this API to push its sample to the
  * Data Hub.
@@ -76,7 +83,7 @@ LE_SHARED psensor_Ref_t psensor_Create
 /**
  * Creates a periodic sensor scaffold for a sensor with a given name that produces JSON samples.
  *
- * This makes the sensor appear in the Data Hub and creates a timer for that sensor.
+ * This makes the sensor appear in the Data Hub and schedules its sampling.
  * The sampleFunc will be called whenever it's time to take a sample.  The sampleFunc is supposed
  * to call psensor_PushJson() to push the JSON sample.
  *
@@ -28,6 +28,28 @@
 //--------------------------------------------------------------------------------------------------
 #define ADMIN_MAX_JSON_EXTRACTOR_LEN 63
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of characters in a memory pool name (excluding null terminator).
+ */
+//--------------------------------------------------------------------------------------------------
+#define ADMIN_MAX_POOL_NAME_LEN 63
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of buckets in a push latency histogram.
+ */
+//--------------------------------------------------------------------------------------------------
+#define ADMIN_TRACE_HISTOGRAM_BUCKETS 16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum size of a batch of resource tree changes delivered to a batch handler, in bytes.
+ * See @ref c_dataHubAdmin_ChangeNotifications.
+ */
+//--------------------------------------------------------------------------------------------------
+#define ADMIN_MAX_TREE_CHANGE_BATCH_BYTES 1024
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Maximum number of optional transform parameters for an observation buffer.
@@ -88,12 +110,101 @@ typedef enum
         ///< Standard Deviation
     ADMIN_OBS_TRANSFORM_TYPE_MAX = 3,
         ///< Maximum value in buffer
-    ADMIN_OBS_TRANSFORM_TYPE_MIN = 4
+    ADMIN_OBS_TRANSFORM_TYPE_MIN = 4,
         ///< Minimum value in buffer
+    ADMIN_OBS_TRANSFORM_TYPE_BUCKET_MEAN = 5,
+        ///< Mean of each bucket of samples (downsampling)
+    ADMIN_OBS_TRANSFORM_TYPE_BUCKET_MIN = 6,
+        ///< Minimum of each bucket of samples (downsampling)
+    ADMIN_OBS_TRANSFORM_TYPE_BUCKET_MAX = 7,
+        ///< Maximum of each bucket of samples (downsampling)
+    ADMIN_OBS_TRANSFORM_TYPE_BUCKET_LAST = 8
+        ///< Newest sample of each bucket of samples (downsampling)
 }
 admin_TransformType_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enumerates the precisions with which an Observation's buffered numbers can be stored.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    ADMIN_BUFFER_PRECISION_FULL = 0,
+        ///< Double-precision values, full-precision timestamps
+    ADMIN_BUFFER_PRECISION_COMPACT = 1
+        ///< Single-precision values, timestamps to the millisecond
+}
+admin_BufferPrecision_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enumerates the runtime statistics counters kept for every resource.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    ADMIN_STAT_RECEIVED = 0,
+        ///< Samples pushed to the resource
+    ADMIN_STAT_ACCEPTED = 1,
+        ///< Samples accepted as the resource's current value
+    ADMIN_STAT_DROPPED_LIMIT = 2,
+        ///< Samples outside an Observation's low and high limits
+    ADMIN_STAT_DROPPED_CHANGE_BY = 3,
+        ///< Samples that didn't change an Observation's value enough
+    ADMIN_STAT_DROPPED_MIN_PERIOD = 4,
+        ///< Samples that came sooner than an Observation's minimum period
+    ADMIN_STAT_DROPPED_OVERRIDE = 5,
+        ///< Samples dropped by an overridden Observation with a changeBy
+    ADMIN_STAT_DROPPED_UPDATING = 6,
+        ///< Samples dropped while an administrative update was in progress
+    ADMIN_STAT_DROPPED_MISMATCH = 7,
+        ///< Samples dropped because of a data type or units mismatch
+    ADMIN_STAT_DROPPED_NO_MEMORY = 8,
+        ///< Samples that could not be handled for lack of memory
+    ADMIN_STAT_COERCIONS = 9,
+        ///< Samples converted to the resource's data type
+    ADMIN_STAT_EXTRACTION_FAILURES = 10,
+        ///< Samples from which JSON extraction failed
+    ADMIN_STAT_HANDLER_CALLS = 11,
+        ///< Push handler call-backs made with the resource's samples
+    ADMIN_STAT_BUFFER_EVICTIONS = 12,
+        ///< Samples evicted from an Observation's full buffer
+    ADMIN_STAT_DROPPED_OVERFLOW = 13
+        ///< Samples dropped because a stream's ring was full
+}
+admin_StatCounter_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enumerates the stages of a push that are timed when push tracing is enabled.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    ADMIN_TRACE_STAGE_TOTAL = 0,
+        ///< From the arrival of the push to the end of its propagation
+    ADMIN_TRACE_STAGE_EXTRACTION = 1,
+        ///< JSON extraction done by Observations
+    ADMIN_TRACE_STAGE_FILTERING = 2,
+        ///< Downsampling and limit, changeBy and minimum period checks
+    ADMIN_TRACE_STAGE_BUFFERING = 3,
+        ///< Buffering, backup and transforms done by Observations
+    ADMIN_TRACE_STAGE_COERCION = 4,
+        ///< Conversion to the data type of Inputs and Outputs
+    ADMIN_TRACE_STAGE_FAN_OUT = 5,
+        ///< Queueing the pushes to the destinations of routes
+    ADMIN_TRACE_STAGE_HANDLERS = 6,
+        ///< Calling the push handlers
+    ADMIN_TRACE_STAGE_DESTINATION = 7
+        ///< Calling the push handlers of Observation destinations
+}
+admin_TraceStage_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Reference type used by Add/Remove functions for EVENT 'admin_TriggerPush'
@@ -142,6 +253,14 @@ typedef struct admin_JsonPushHandler* admin_JsonPushHandlerRef_t;
 typedef struct admin_ResourceTreeChangeHandler* admin_ResourceTreeChangeHandlerRef_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference type used by Add/Remove functions for EVENT 'admin_ResourceTreeChangeBatch'
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct admin_ResourceTreeChangeBatchHandler* admin_ResourceTreeChangeBatchHandlerRef_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Callback function for pushing triggers to an output
@@ -232,6 +351,22 @@ typedef void (*admin_ResourceTreeChangeHandlerFunc_t)
         ///<
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Register a handler, to be called back with batches of Resource additions and removals.
+ * See @ref c_dataHubAdmin_ChangeNotifications.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*admin_ResourceTreeChangeBatchHandlerFunc_t)
+(
+        const uint8_t* changesPtr,
+        ///< Packed changes, oldest first.
+        size_t changesSize,
+        ///<
+        void* contextPtr
+        ///<
+);
+
 
 //--------------------------------------------------------------------------------------------------
 /**
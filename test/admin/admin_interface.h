@@ -323,10 +323,14 @@
  * Observation's filtering criteria:
  *  - admin_SetBufferMaxCount() - set the buffer size
  *  - admin_SetBufferBackupPeriod() - enable periodic backups of the buffer to non-volatile storage
+ *  - admin_SetBufferSpillMaxCount() - keep samples evicted from the buffer on non-volatile storage
+ *  - admin_SetBufferPrecision() - store buffered numbers with reduced precision to save memory
  *
  * The following functions can be used to read the buffer configuration settings:
  *  - admin_GetBufferMaxCount()
  *  - admin_GetBufferBackupPeriod()
+ *  - admin_GetBufferSpillMaxCount()
+ *  - admin_GetBufferPrecision()
  *
  * If the buffer backup period is set to a non-zero number of seconds, then
  *
@@ -343,6 +347,15 @@
  *  - the Data Hub application is uninstalled from the device
  *  - the Observation changes data type (because its data source pushed a different type of data)
  *
+ * If a buffer's spill count is set to a non-zero number of samples, then trigger, Boolean and
+ * numeric samples evicted from the buffer are appended to a "spilled history" on non-volatile
+ * storage, instead of being discarded.  The history keeps at least that many of the newest evicted
+ * samples, in segment files that are deleted oldest first.  Buffer reads and queries given a start
+ * time older than the oldest buffered sample go through the history first (decimated reads
+ * excepted).  Reads and queries without a start time only cover the buffer.  The history is kept
+ * across restarts, and is deleted along with the buffer if the Observation changes data type.
+ * This is only supported on Linux.
+ *
  *
  * @subsection c_dataHubAdmin_Defaults Default Values
  *
@@ -1343,6 +1356,74 @@ uint32_t admin_GetBufferBackupPeriod
         ///< [IN] Path within the /obs/ namespace.
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the number of samples evicted from an Observation's buffer to keep in its spilled history
+ * on non-volatile storage (see @ref c_dataHubAdmin_ObsBuffering).  Only trigger, Boolean and
+ * numeric samples are spilled.
+ *
+ * @return
+ *      - LE_OK If the spill count was set successfully.
+ *      - LE_FAULT If an error happened during set.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_SetBufferSpillMaxCount
+(
+    const char* LE_NONNULL path,
+        ///< [IN] Path within the /obs/ namespace.
+    uint32_t count
+        ///< [IN] The number of evicted samples to keep (0 = delete the spilled history)
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of samples evicted from an Observation's buffer to keep in its spilled history.
+ * See admin_SetBufferSpillMaxCount() for more information.
+ *
+ * @return The spill count (in number of samples) or 0 if the spilled history is disabled or the
+ *         Observation does not exist.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t admin_GetBufferSpillMaxCount
+(
+    const char* LE_NONNULL path
+        ///< [IN] Path within the /obs/ namespace.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the precision with which an Observation's buffered numbers are stored.  Compact precision
+ * stores values as single-precision floating point numbers and timestamps to the millisecond,
+ * which takes half the memory.  Samples already in the buffer keep the precision they have.
+ *
+ * @return
+ *      - LE_OK If the buffer precision was set successfully.
+ *      - LE_BAD_PARAMETER If the precision is not valid.
+ *      - LE_FAULT If an error happened during set.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_SetBufferPrecision
+(
+    const char* LE_NONNULL path,
+        ///< [IN] Path within the /obs/ namespace.
+    admin_BufferPrecision_t precision
+        ///< [IN] The precision of the buffered numbers.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the precision with which an Observation's buffered numbers are stored.
+ * See admin_SetBufferPrecision() for more information.
+ *
+ * @return The buffer precision (BUFFER_PRECISION_FULL if the Observation does not exist).
+ */
+//--------------------------------------------------------------------------------------------------
+admin_BufferPrecision_t admin_GetBufferPrecision
+(
+    const char* LE_NONNULL path
+        ///< [IN] Path within the /obs/ namespace.
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the default value of a resource to a Boolean value.
@@ -1742,6 +1823,155 @@ bool admin_IsMandatory
         ///< [IN] Absolute path of the resource.
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the value of one of the runtime statistics counters of a resource.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if there is no resource at the given path (e.g., it's a Namespace).
+ *  - LE_BAD_PARAMETER if the counter is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_GetStatCounter
+(
+    const char* LE_NONNULL path,
+        ///< [IN] Absolute path of the resource.
+    admin_StatCounter_t counter,
+        ///< [IN] The counter to get.
+    uint32_t* valuePtr
+        ///< [OUT] The value of the counter.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set all the runtime statistics counters of a resource back to zero.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if there is no resource at the given path (e.g., it's a Namespace).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_ResetStats
+(
+    const char* LE_NONNULL path
+        ///< [IN] Absolute path of the resource.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the usage of one of the Data Hub's memory pools whose size can be configured in the .cdef.
+ *
+ * The pools are numbered from 0, so they can all be listed by incrementing the index until
+ * LE_OUT_OF_RANGE is returned.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_OUT_OF_RANGE if the index is past the last pool.
+ *  - LE_OVERFLOW if the pool's name did not fit in the buffer provided (it has been truncated).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_GetPoolStats
+(
+    uint32_t index,
+        ///< [IN] Index of the pool.
+    char* name,
+        ///< [OUT] Name of the pool.
+    size_t nameSize,
+        ///< [IN]
+    uint32_t* objectSizePtr,
+        ///< [OUT] Size of the pool's blocks (in bytes).
+    uint32_t* totalBlocksPtr,
+        ///< [OUT] Number of blocks in the pool, including any expansions.
+    uint32_t* blocksInUsePtr,
+        ///< [OUT] Number of blocks currently in use.
+    uint32_t* peakBlocksPtr,
+        ///< [OUT] Largest number of blocks ever in use at the same time.
+    uint32_t* expansionsPtr
+        ///< [OUT] Number of times the pool had to be expanded.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start, change the rate of, or stop push latency tracing.
+ *
+ * Tracing one push out of every few keeps the overhead of tracing low on a busy system.
+ */
+//--------------------------------------------------------------------------------------------------
+void admin_SetPushTracing
+(
+    uint32_t samplePeriod
+        ///< [IN] Trace one push out of every samplePeriod (0 = stop tracing).
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the latency histogram of one of the stages of the traced pushes.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_BAD_PARAMETER if the stage is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_GetPushTraceHistogram
+(
+    admin_TraceStage_t stage,
+        ///< [IN] The stage.
+    uint32_t* bucketsPtr,
+        ///< [OUT] Number of traced pushes in each bucket.
+    size_t* bucketsSizePtr,
+        ///< [INOUT]
+    uint32_t* countPtr,
+        ///< [OUT] Number of traced pushes that went through the stage.
+    uint64_t* totalTimePtr,
+        ///< [OUT] Total time spent in the stage by those pushes (in microseconds).
+    uint32_t* maxTimePtr
+        ///< [OUT] Longest time spent in the stage by a traced push (in microseconds).
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clear the latency histograms of all the stages of the traced pushes.
+ */
+//--------------------------------------------------------------------------------------------------
+void admin_ResetPushTraces
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mark or unmark a namespace or resource as high-priority.  Samples routed to the resources at or
+ * under a high-priority path are pushed ahead of all the others.  The path doesn't have to exist.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_BAD_PARAMETER if the path is not a valid absolute path.
+ *  - LE_OUT_OF_RANGE if the maximum number of high-priority paths are already marked.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_SetHighPriority
+(
+    const char* LE_NONNULL path,
+        ///< [IN] Absolute path of a namespace or resource.
+    bool isHighPriority
+        ///< [IN] true to mark the path as high-priority, false to unmark it.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a namespace or resource is at or under a path marked high-priority.
+ * See admin_SetHighPriority() for more information.
+ *
+ * @return true if it is.
+ */
+//--------------------------------------------------------------------------------------------------
+bool admin_IsHighPriority
+(
+    const char* LE_NONNULL path
+        ///< [IN] Absolute path of a namespace or resource.
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add handler function for EVENT 'admin_ResourceTreeChange'
@@ -1766,6 +1996,30 @@ void admin_RemoveResourceTreeChangeHandler
         ///< [IN]
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'admin_ResourceTreeChangeBatch'
+ */
+//--------------------------------------------------------------------------------------------------
+admin_ResourceTreeChangeBatchHandlerRef_t admin_AddResourceTreeChangeBatchHandler
+(
+    admin_ResourceTreeChangeBatchHandlerFunc_t callbackPtr,
+        ///< [IN]
+    void* contextPtr
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'admin_ResourceTreeChangeBatch'
+ */
+//--------------------------------------------------------------------------------------------------
+void admin_RemoveResourceTreeChangeBatchHandler
+(
+    admin_ResourceTreeChangeBatchHandlerRef_t handlerRef
+        ///< [IN]
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Signal to the Data Hub that administrative changes are about to be performed.
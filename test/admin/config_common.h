@@ -0,0 +1,150 @@
+/*
+ * ====================== WARNING ======================
+ *
+ * THE CONTENTS OF THIS FILE HAVE BEEN AUTO-GENERATED.
+ * DO NOT MODIFY IN ANY WAY.
+ *
+ * ====================== WARNING ======================
+ */
+#ifndef CONFIG_COMMON_H_INCLUDE_GUARD
+#define CONFIG_COMMON_H_INCLUDE_GUARD
+
+
+#include "legato.h"
+
+// Interface specific includes
+#include "io_common.h"
+#include "admin_common.h"
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * String used to select a supported configuration format
+ */
+//--------------------------------------------------------------------------------------------------
+#define CONFIG_MAX_ENCODED_TYPE_LEN 15
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of the destination string (excluding null terminator).
+ */
+//--------------------------------------------------------------------------------------------------
+#define CONFIG_MAX_DESTINATION_NAME_LEN 15
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of the destination string (including null terminator).
+ */
+//--------------------------------------------------------------------------------------------------
+#define CONFIG_MAX_DESTINATION_NAME_BYTES 16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of source path reported by destination push handler (excluding null terminator).
+ */
+//--------------------------------------------------------------------------------------------------
+#define CONFIG_MAX_DESTINATION_SRC_LEN 142
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of source path reported by destination push handler (including null terminator).
+ */
+//--------------------------------------------------------------------------------------------------
+#define CONFIG_MAX_DESTINATION_SRC_BYTES 143
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of parser error message string (excluding null terminator).
+ */
+//--------------------------------------------------------------------------------------------------
+#define CONFIG_MAX_ERROR_MSG_LEN 255
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of parser error message string (including null terminator).
+ */
+//--------------------------------------------------------------------------------------------------
+#define CONFIG_MAX_ERROR_MSG_BYTES 256
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum size of a batch of samples delivered to a destination batch push handler, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CONFIG_MAX_DESTINATION_BATCH_BYTES 4096
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference type used by Add/Remove functions for EVENT 'config_DestinationPush'
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct config_DestinationPushHandler* config_DestinationPushHandlerRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference type used by Add/Remove functions for EVENT 'config_DestinationBatchPush'
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct config_DestinationBatchPushHandler* config_DestinationBatchPushHandlerRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler to pass the result of a configuration load request back to the caller
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*config_LoadResultHandlerFunc_t)
+(
+        le_result_t result,
+        ///< Result code
+        const char* LE_NONNULL errorMsg,
+        ///< Parse Error Message string
+        uint32_t fileLoc,
+        ///< File location (in bytes) where error occurred
+        void* contextPtr
+        ///<
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback function for observations in a configuration.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*config_DestinationPushHandlerFunc_t)
+(
+        double timestamp,
+        ///< Seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC)
+        const char* LE_NONNULL obsName,
+        ///< Name of observation from configuration
+        const char* LE_NONNULL srcPath,
+        ///< Source path + JSON extraction, if applicable
+        io_DataType_t dataType,
+        ///< Indicates type of data being returned (Bool, Numeric, or String)
+        bool boolValue,
+        ///< Boolean value
+        double numericValue,
+        ///< Numeric value
+        const char* LE_NONNULL stringValue,
+        ///< String or JSON string value
+        void* contextPtr
+        ///<
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback function for batches of samples received by the observations in a configuration.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*config_DestinationBatchPushHandlerFunc_t)
+(
+        const uint8_t* batchPtr,
+        ///< CBOR-encoded batch of samples.
+        size_t batchSize,
+        ///<
+        void* contextPtr
+        ///<
+);
+
+#endif // CONFIG_COMMON_H_INCLUDE_GUARD
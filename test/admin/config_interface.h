@@ -0,0 +1,103 @@
+/*
+ * ====================== WARNING ======================
+ *
+ * THE CONTENTS OF THIS FILE HAVE BEEN AUTO-GENERATED.
+ * DO NOT MODIFY IN ANY WAY.
+ *
+ * ====================== WARNING ======================
+ */
+
+/**
+ * @file config_interface.h
+ *
+ * Data Hub Config API, as used by the admin unit tests.
+ */
+
+#ifndef CONFIG_INTERFACE_H_INCLUDE_GUARD
+#define CONFIG_INTERFACE_H_INCLUDE_GUARD
+
+
+#include "legato.h"
+
+// Interface specific includes
+#include "io_interface.h"
+#include "admin_interface.h"
+
+// Internal includes for this interface
+#include "config_common.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Causes the Datahub to load a configuration from a file.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t config_Load
+(
+    const char* LE_NONNULL filePath,
+        ///< [IN] Path of configuration file.
+    const char* LE_NONNULL encodedType,
+        ///< [IN] Type of encoding used in the file: "json" or "cbor".
+    config_LoadResultHandlerFunc_t callbackPtr,
+        ///< [IN] Callback to notify caller of result
+    void* contextPtr
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'config_DestinationPush'
+ */
+//--------------------------------------------------------------------------------------------------
+config_DestinationPushHandlerRef_t config_AddDestinationPushHandler
+(
+    const char* LE_NONNULL destination,
+        ///< [IN] Destination for this event(e.g. "store")
+    config_DestinationPushHandlerFunc_t callbackPtr,
+        ///< [IN] Destination Push Handler
+    void* contextPtr
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'config_DestinationPush'
+ */
+//--------------------------------------------------------------------------------------------------
+void config_RemoveDestinationPushHandler
+(
+    config_DestinationPushHandlerRef_t handlerRef
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'config_DestinationBatchPush'
+ */
+//--------------------------------------------------------------------------------------------------
+config_DestinationBatchPushHandlerRef_t config_AddDestinationBatchPushHandler
+(
+    const char* LE_NONNULL destination,
+        ///< [IN] Destination for this event(e.g. "store")
+    uint32_t maxBytes,
+        ///< [IN] Batch size (bytes) that triggers a delivery
+        ///< (0 = MAX_DESTINATION_BATCH_BYTES).
+    uint32_t flushIntervalMs,
+        ///< [IN] Longest time (ms) a sample may be held back (0 = no limit).
+    config_DestinationBatchPushHandlerFunc_t callbackPtr,
+        ///< [IN] Destination Batch Push Handler
+    void* contextPtr
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'config_DestinationBatchPush'
+ */
+//--------------------------------------------------------------------------------------------------
+void config_RemoveDestinationBatchPushHandler
+(
+    config_DestinationBatchPushHandlerRef_t handlerRef
+        ///< [IN]
+);
+
+#endif // CONFIG_INTERFACE_H_INCLUDE_GUARD
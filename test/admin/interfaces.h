@@ -4,6 +4,7 @@
 #include "io_interface.h"
 #include "admin_interface.h"
 #include "query_interface.h"
+#include "config_interface.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
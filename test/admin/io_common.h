@@ -52,6 +52,22 @@
 //--------------------------------------------------------------------------------------------------
 #define IO_MAX_UNITS_NAME_LEN 23
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of samples in one batch push.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef IO_MAX_BATCH_LEN
+#define IO_MAX_BATCH_LEN 64
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of records in the ring of a stream.
+ */
+//--------------------------------------------------------------------------------------------------
+#define IO_MAX_STREAM_CAPACITY 65536
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Enumerates the data types supported.
@@ -81,6 +97,22 @@ io_DataType_t;
 typedef struct io_TriggerPushHandler* io_TriggerPushHandlerRef_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handle to an I/O resource, used to push samples without looking up the resource path each time.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct io_Resource* io_ResourceRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a stream of samples pushed to an Input or Output through shared memory.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct io_Stream* io_StreamRef_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Reference type used by Add/Remove functions for EVENT 'io_BooleanPush'
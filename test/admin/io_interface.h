@@ -673,6 +673,237 @@ void io_PushJson
         ///< [IN]
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a handle to an Input or Output resource, to push samples to it without a path lookup.
+ *
+ * @return Handle, or NULL if the resource does not exist.
+ */
+//--------------------------------------------------------------------------------------------------
+io_ResourceRef_t io_GetResourceHandle
+(
+    const char* LE_NONNULL path
+        ///< [IN] Resource path within the client app's namespace.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a handle obtained from io_GetResourceHandle().
+ */
+//--------------------------------------------------------------------------------------------------
+void io_ReleaseResourceHandle
+(
+    io_ResourceRef_t handle
+        ///< [IN] Handle returned by io_GetResourceHandle().
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a trigger sample to an Input or Output resource, given its handle.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if the handle is not valid (e.g., the resource has been deleted).
+ *  - LE_FAULT or another error code if the push failed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushTriggerByHandle
+(
+    io_ResourceRef_t handle,
+        ///< [IN] Handle returned by io_GetResourceHandle().
+    double timestamp
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< IO_NOW = now (i.e., generate a timestamp for me).
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a Boolean sample to an Input or Output resource, given its handle.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if the handle is not valid (e.g., the resource has been deleted).
+ *  - LE_FAULT or another error code if the push failed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushBooleanByHandle
+(
+    io_ResourceRef_t handle,
+        ///< [IN] Handle returned by io_GetResourceHandle().
+    double timestamp,
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< IO_NOW = now (i.e., generate a timestamp for me).
+    bool value
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a numeric sample to an Input or Output resource, given its handle.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if the handle is not valid (e.g., the resource has been deleted).
+ *  - LE_FAULT or another error code if the push failed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushNumericByHandle
+(
+    io_ResourceRef_t handle,
+        ///< [IN] Handle returned by io_GetResourceHandle().
+    double timestamp,
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< IO_NOW = now (i.e., generate a timestamp for me).
+    double value
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a string sample to an Input or Output resource, given its handle.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if the handle is not valid (e.g., the resource has been deleted).
+ *  - LE_FAULT or another error code if the push failed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushStringByHandle
+(
+    io_ResourceRef_t handle,
+        ///< [IN] Handle returned by io_GetResourceHandle().
+    double timestamp,
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< IO_NOW = now (i.e., generate a timestamp for me).
+    const char* LE_NONNULL value
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a JSON sample to an Input or Output resource, given its handle.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if the handle is not valid (e.g., the resource has been deleted).
+ *  - LE_FAULT or another error code if the push failed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushJsonByHandle
+(
+    io_ResourceRef_t handle,
+        ///< [IN] Handle returned by io_GetResourceHandle().
+    double timestamp,
+        ///< [IN] Timestamp in seconds since the Epoch 1970-01-01 00:00:00 +0000 (UTC).
+        ///< IO_NOW = now (i.e., generate a timestamp for me).
+    const char* LE_NONNULL value
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a batch of Boolean samples, each to the resource of the corresponding handle.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_BAD_PARAMETER if the arrays are not all the same length, or are longer than
+ *    IO_MAX_BATCH_LEN.
+ *  - Otherwise, the result of the first push that failed (all the samples are still pushed).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushBooleanBatch
+(
+    const io_ResourceRef_t* handlesPtr,
+        ///< [IN] Handles returned by io_GetResourceHandle().
+    size_t handlesSize,
+        ///< [IN]
+    const double* timestampsPtr,
+        ///< [IN] Timestamps in seconds since the Epoch (UTC).
+        ///< IO_NOW = now (i.e., generate a timestamp for me).
+    size_t timestampsSize,
+        ///< [IN]
+    const bool* valuesPtr,
+        ///< [IN]
+    size_t valuesSize
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a batch of numeric samples, each to the resource of the corresponding handle.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_BAD_PARAMETER if the arrays are not all the same length, or are longer than
+ *    IO_MAX_BATCH_LEN.
+ *  - Otherwise, the result of the first push that failed (all the samples are still pushed).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushNumericBatch
+(
+    const io_ResourceRef_t* handlesPtr,
+        ///< [IN] Handles returned by io_GetResourceHandle().
+    size_t handlesSize,
+        ///< [IN]
+    const double* timestampsPtr,
+        ///< [IN] Timestamps in seconds since the Epoch (UTC).
+        ///< IO_NOW = now (i.e., generate a timestamp for me).
+    size_t timestampsSize,
+        ///< [IN]
+    const double* valuesPtr,
+        ///< [IN]
+    size_t valuesSize
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open a stream of trigger, Boolean or numeric samples to an Input or Output.
+ *
+ * @return A reference to the stream, or NULL if failed.
+ */
+//--------------------------------------------------------------------------------------------------
+io_StreamRef_t io_OpenStream
+(
+    const char* path,
+        ///< [IN] Resource path within the client app's namespace.
+    io_DataType_t dataType,
+        ///< [IN] Type of the samples (trigger, Boolean or numeric).
+    uint32_t capacity,
+        ///< [IN] Number of records in the ring (a power of two).
+    int* streamMemoryPtr
+        ///< [OUT] Shared memory file holding the ring.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the doorbell of a stream.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_BAD_PARAMETER if the stream reference is not valid.
+ *  - LE_FAULT if failed to duplicate the doorbell file.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_GetStreamDoorbell
+(
+    io_StreamRef_t stream,
+        ///< [IN] Stream returned by io_OpenStream().
+    int* doorbellPtr
+        ///< [OUT] The stream's doorbell.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close a stream returned by io_OpenStream().
+ */
+//--------------------------------------------------------------------------------------------------
+void io_CloseStream
+(
+    io_StreamRef_t stream
+        ///< [IN] Stream returned by io_OpenStream().
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add handler function for EVENT 'io_TriggerPush'
@@ -4,6 +4,11 @@
  * unit test admin API functions:
  *  CreateInput, CreateOutput, DeleteResource, SetJsonExample and MarkOptional
  *
+ * as well as the propagation of pushes along routes, the ring storage of Observation buffers,
+ * buffer backup journals, the deletion log, the draining of streams, child lookups in large
+ * namespaces, interned entry names and pushes through resource handles, one by one or in
+ * batches.
+ *
  * Copyright (C) Sierra Wireless, Inc. Use of this work is subject to license.
  */
 #include <stdarg.h>
@@ -13,9 +18,27 @@
 #include <stdlib.h>
 #include <cmocka.h>
 #include <limits.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "interfaces.h"
+#include "dataHub.h"
+#include "ioStreamRing.h"
 
 extern void initDataHub(void);
+extern char* simulateAppName;
+
+/* Number of 10 ms turns of the event loop to wait for timers and doorbells before giving up */
+#define EVENT_LOOP_MAX_TURNS 500
+
+static void ServiceEvents(void)
+{
+    while (le_event_ServiceLoop() == LE_OK)
+    {
+    }
+}
 
 static int setup(void **state) {
     // Init Data Hub component
@@ -246,6 +269,835 @@ static void test_admin_set_json_example
     }
 }
 
+/* Resources of the route tests, and the order in which their push handlers were called */
+#define ROUTE_TEST_RESOURCES_NB 4
+static const char* RouteResourceName[] = {
+    "/app/route/source",
+    "/obs/routeB",
+    "/obs/routeC",
+    "/obs/routeD"
+};
+static int RouteCallOrder[ROUTE_TEST_RESOURCES_NB];
+static int RouteCallCount;
+
+static void RoutePushHandler
+(
+    double timestamp,
+    double value,
+    void* contextPtr
+)
+{
+    (void)timestamp;
+    (void)value;
+
+    if (RouteCallCount < ROUTE_TEST_RESOURCES_NB)
+    {
+        RouteCallOrder[RouteCallCount] = (int)(intptr_t)contextPtr;
+    }
+    RouteCallCount++;
+}
+
+static void test_res_push_route_order
+(
+    void** state
+)
+{
+    (void)state;
+
+    // source -> B -> D, and source -> C.
+    assert_true(LE_OK == admin_CreateInput(RouteResourceName[0], IO_DATA_TYPE_NUMERIC, ""));
+    for (int i = 1 ; i < ROUTE_TEST_RESOURCES_NB ; i++)
+    {
+        assert_true(LE_OK == admin_CreateObs(RouteResourceName[i]));
+    }
+    assert_true(LE_OK == admin_SetSource(RouteResourceName[1], RouteResourceName[0]));
+    assert_true(LE_OK == admin_SetSource(RouteResourceName[2], RouteResourceName[0]));
+    assert_true(LE_OK == admin_SetSource(RouteResourceName[3], RouteResourceName[1]));
+
+    admin_NumericPushHandlerRef_t refs[ROUTE_TEST_RESOURCES_NB];
+    for (int i = 0 ; i < ROUTE_TEST_RESOURCES_NB ; i++)
+    {
+        refs[i] = admin_AddNumericPushHandler(RouteResourceName[i],
+                                              RoutePushHandler,
+                                              (void*)(intptr_t)i);
+        assert_non_null(refs[i]);
+    }
+
+    RouteCallCount = 0;
+    resTree_EntryRef_t entryRef = resTree_FindEntryAtAbsolutePath(RouteResourceName[0]);
+    assert_non_null(entryRef);
+    assert_true(LE_OK == resTree_Push(entryRef,
+                                      IO_DATA_TYPE_NUMERIC,
+                                      dataSample_CreateNumeric(IO_NOW, 1.0)));
+
+    // Routes are followed breadth-first: the source's own handlers are called once its
+    // destinations have been queued, and D only after both B and C.
+    assert_int_equal(ROUTE_TEST_RESOURCES_NB, RouteCallCount);
+    for (int i = 0 ; i < ROUTE_TEST_RESOURCES_NB ; i++)
+    {
+        assert_int_equal(i, RouteCallOrder[i]);
+    }
+
+    // Delete resources to leave the test in a clean state
+    for (int i = 0 ; i < ROUTE_TEST_RESOURCES_NB ; i++)
+    {
+        admin_RemoveNumericPushHandler(refs[i]);
+    }
+    for (int i = 1 ; i < ROUTE_TEST_RESOURCES_NB ; i++)
+    {
+        admin_DeleteObs(RouteResourceName[i] + strlen("/obs/"));
+    }
+    admin_DeleteResource(RouteResourceName[0]);
+}
+
+static void test_res_push_error_latching
+(
+    void** state
+)
+{
+    (void)state;
+
+    // source -> B (drops values above 10), and source -> C.
+    assert_true(LE_OK == admin_CreateInput(RouteResourceName[0], IO_DATA_TYPE_NUMERIC, ""));
+    assert_true(LE_OK == admin_CreateObs(RouteResourceName[1]));
+    assert_true(LE_OK == admin_CreateObs(RouteResourceName[2]));
+    admin_SetHighLimit(RouteResourceName[1], 10.0);
+    assert_true(LE_OK == admin_SetSource(RouteResourceName[1], RouteResourceName[0]));
+    assert_true(LE_OK == admin_SetSource(RouteResourceName[2], RouteResourceName[0]));
+
+    admin_NumericPushHandlerRef_t ref = admin_AddNumericPushHandler(RouteResourceName[2],
+                                                                    RoutePushHandler,
+                                                                    (void*)(intptr_t)2);
+    assert_non_null(ref);
+
+    resTree_EntryRef_t entryRef = resTree_FindEntryAtAbsolutePath(RouteResourceName[0]);
+    assert_non_null(entryRef);
+
+    // B rejects the sample, which fails the push, but C still gets it.
+    RouteCallCount = 0;
+    assert_true(LE_FAULT == resTree_Push(entryRef,
+                                         IO_DATA_TYPE_NUMERIC,
+                                         dataSample_CreateNumeric(IO_NOW, 20.0)));
+    assert_int_equal(1, RouteCallCount);
+
+    // The error isn't carried over to the next push.
+    RouteCallCount = 0;
+    assert_true(LE_OK == resTree_Push(entryRef,
+                                      IO_DATA_TYPE_NUMERIC,
+                                      dataSample_CreateNumeric(IO_NOW, 5.0)));
+    assert_int_equal(1, RouteCallCount);
+
+    // Delete resources to leave the test in a clean state
+    admin_RemoveNumericPushHandler(ref);
+    admin_DeleteObs(RouteResourceName[1] + strlen("/obs/"));
+    admin_DeleteObs(RouteResourceName[2] + strlen("/obs/"));
+    admin_DeleteResource(RouteResourceName[0]);
+}
+
+/* Time stamp of the oldest sample pushed by the buffer tests (seconds since the Epoch) */
+#define BUFFER_TEST_START_TIME 1600000000.0
+
+static void PushNumeric
+(
+    const char* path,
+    double timestamp,
+    double value
+)
+{
+    resTree_EntryRef_t entryRef = resTree_FindEntryAtAbsolutePath(path);
+    assert_non_null(entryRef);
+    resTree_Push(entryRef, IO_DATA_TYPE_NUMERIC, dataSample_CreateNumeric(timestamp, value));
+}
+
+static void test_obs_ring_wrap_truncate
+(
+    void** state
+)
+{
+    (void)state;
+    const char* path = "/obs/ring";
+    uint32_t evictions = 0;
+
+    assert_true(LE_OK == admin_CreateObs(path));
+    admin_SetBufferMaxCount(path, 5);
+
+    // 40 samples wrap around more than a whole Sample Block, leaving the 5 newest (35 to 39).
+    for (int i = 0 ; i < 40 ; i++)
+    {
+        PushNumeric(path, BUFFER_TEST_START_TIME + i, i);
+    }
+    assert_true(35.0 == query_GetMin(path, NAN));
+    assert_true(39.0 == query_GetMax(path, NAN));
+    assert_true(37.0 == query_GetMean(path, NAN));
+    assert_true(LE_OK == admin_GetStatCounter(path, ADMIN_STAT_BUFFER_EVICTIONS, &evictions));
+    assert_int_equal(35, evictions);
+
+    // A start time makes the queries walk the records instead of using running aggregates.
+    assert_true(37.0 == query_GetMin(path, BUFFER_TEST_START_TIME + 36.5));
+    assert_true(38.0 == query_GetMean(path, BUFFER_TEST_START_TIME + 36.5));
+
+    // Shrinking the buffer drops the oldest samples.
+    admin_SetBufferMaxCount(path, 2);
+    assert_true(38.0 == query_GetMin(path, NAN));
+    assert_true(39.0 == query_GetMax(path, NAN));
+    assert_true(38.5 == query_GetMean(path, NAN));
+
+    // New samples go on after the truncated ones.
+    PushNumeric(path, BUFFER_TEST_START_TIME + 40, 40);
+    assert_true(39.0 == query_GetMin(path, NAN));
+    assert_true(40.0 == query_GetMax(path, NAN));
+
+    // Delete resources to leave the test in a clean state
+    admin_DeleteObs(path + strlen("/obs/"));
+}
+
+/* Sizes of the parts of a numeric backup journal (see the file format in obs.c) */
+#define JOURNAL_HEADER_BYTES 2
+#define JOURNAL_SEGMENT_HEADER_BYTES 8
+#define JOURNAL_NUMERIC_RECORD_BYTES 16
+
+static off_t GetJournalSize
+(
+    int segmentCount,
+    int recordCount
+)
+{
+    return JOURNAL_HEADER_BYTES
+           + (segmentCount * JOURNAL_SEGMENT_HEADER_BYTES)
+           + (recordCount * JOURNAL_NUMERIC_RECORD_BYTES);
+}
+
+static bool WaitForFileSize
+(
+    const char* path,
+    off_t size
+)
+{
+    for (int i = 0 ; i < EVENT_LOOP_MAX_TURNS ; i++)
+    {
+        struct stat st;
+
+        ServiceEvents();
+        if ((stat(path, &st) == 0) && (st.st_size == size))
+        {
+            return true;
+        }
+        usleep(10000);
+    }
+    return false;
+}
+
+static uint32_t ReadJournalWord
+(
+    const char* path,
+    off_t offset
+)
+{
+    uint32_t word = 0;
+    int fd = open(path, O_RDONLY);
+    assert_true(fd >= 0);
+    assert_int_equal(sizeof(word), pread(fd, &word, sizeof(word), offset));
+    close(fd);
+    return word;
+}
+
+static void test_obs_journal_append_compact
+(
+    void** state
+)
+{
+    (void)state;
+    const char* path = "/obs/journal";
+    const char* backupPath = "backup/journal.bak";
+    int pushCount = 0;
+
+    // Don't restore a journal left by an earlier run.
+    unlink(backupPath);
+
+    assert_true(LE_OK == admin_CreateObs(path));
+    admin_SetBufferMaxCount(path, 4);
+    admin_SetBufferBackupPeriod(path, 1);
+
+    // The first backup writes the whole buffer as a single segment.
+    for ( ; pushCount < 3 ; pushCount++)
+    {
+        PushNumeric(path, BUFFER_TEST_START_TIME + pushCount, pushCount);
+    }
+    assert_true(WaitForFileSize(backupPath, GetJournalSize(1, 3)));
+
+    int fd = open(backupPath, O_RDONLY);
+    uint8_t header[JOURNAL_HEADER_BYTES];
+    assert_true(fd >= 0);
+    assert_int_equal(sizeof(header), read(fd, header, sizeof(header)));
+    close(fd);
+    assert_int_equal(1, header[0]);
+    assert_int_equal('n', header[1]);
+    assert_int_equal(3, ReadJournalWord(backupPath, JOURNAL_HEADER_BYTES));
+    assert_int_equal(3, ReadJournalWord(backupPath, JOURNAL_HEADER_BYTES + 4));
+
+    // Later backups only append the new samples.
+    PushNumeric(path, BUFFER_TEST_START_TIME + pushCount, pushCount);
+    pushCount++;
+    assert_true(WaitForFileSize(backupPath, GetJournalSize(2, 4)));
+    assert_int_equal(4, ReadJournalWord(backupPath, GetJournalSize(1, 3)));
+    assert_int_equal(1, ReadJournalWord(backupPath, GetJournalSize(1, 3) + 4));
+
+    // Samples that push old ones out of the buffer are still appended, until the dropped
+    // records outnumber the buffered ones.
+    for (int i = 0 ; i < 4 ; i++, pushCount++)
+    {
+        PushNumeric(path, BUFFER_TEST_START_TIME + pushCount, pushCount);
+    }
+    assert_true(WaitForFileSize(backupPath, GetJournalSize(3, 8)));
+
+    // Then the journal is compacted back to a single segment holding the buffer.
+    PushNumeric(path, BUFFER_TEST_START_TIME + pushCount, pushCount);
+    pushCount++;
+    assert_true(WaitForFileSize(backupPath, GetJournalSize(1, 4)));
+    assert_int_equal(4, ReadJournalWord(backupPath, JOURNAL_HEADER_BYTES));
+    assert_int_equal(4, ReadJournalWord(backupPath, JOURNAL_HEADER_BYTES + 4));
+
+    double newest = NAN;
+    fd = open(backupPath, O_RDONLY);
+    assert_true(fd >= 0);
+    assert_int_equal(sizeof(newest),
+                     pread(fd, &newest, sizeof(newest), GetJournalSize(1, 4) - sizeof(newest)));
+    close(fd);
+    assert_true((double)(pushCount - 1) == newest);
+
+    // Delete resources to leave the test in a clean state (this deletes the journal too)
+    admin_DeleteObs(path + strlen("/obs/"));
+    assert_true(access(backupPath, F_OK) != 0);
+}
+
+/* More deletions than the deletion log holds (DHUB_DELETION_LOG_SIZE, 64 by default) */
+#define DELETION_TEST_RESOURCES_NB 100
+
+static bool SnapshotDone;
+static le_result_t SnapshotResult;
+static uint32_t SnapshotLength;
+
+static void SnapshotMemoryResultHandler
+(
+    le_result_t status,
+    uint32_t length,
+    void* contextPtr
+)
+{
+    (void)contextPtr;
+
+    SnapshotDone = true;
+    SnapshotResult = status;
+    SnapshotLength = length;
+}
+
+/* Take a JSON snapshot of the whole tree, returned as a string to be freed by the caller */
+static char* TakeJsonSnapshot
+(
+    double since
+)
+{
+    int fd = -1;
+
+    SnapshotDone = false;
+    query_TakeSnapshotToMemory(QUERY_SNAPSHOT_FORMAT_JSON, 0, "/", since,
+                               SnapshotMemoryResultHandler, NULL, &fd);
+    for (int i = 0 ; (i < EVENT_LOOP_MAX_TURNS) && !SnapshotDone ; i++)
+    {
+        ServiceEvents();
+        if (!SnapshotDone)
+        {
+            usleep(10000);
+        }
+    }
+    assert_true(SnapshotDone);
+    assert_true(LE_OK == SnapshotResult);
+    assert_true(fd >= 0);
+
+    char* snapshot = malloc(SnapshotLength + 1);
+    assert_non_null(snapshot);
+    assert_int_equal(SnapshotLength, pread(fd, snapshot, SnapshotLength, 0));
+    snapshot[SnapshotLength] = '\0';
+    close(fd);
+
+    return snapshot;
+}
+
+static void CreateAndDeleteInputs
+(
+    int count
+)
+{
+    char path[IO_MAX_RESOURCE_PATH_LEN + 1];
+
+    for (int i = 0 ; i < count ; i++)
+    {
+        snprintf(path, sizeof(path), "/app/deletions/deleted%d", i);
+        assert_true(LE_OK == admin_CreateInput(path, IO_DATA_TYPE_NUMERIC, ""));
+        admin_DeleteResource(path);
+    }
+}
+
+static void test_snapshot_deletion_log_overflow
+(
+    void** state
+)
+{
+    (void)state;
+    const char* livePath = "/app/deletions/live";
+
+    query_TrackDeletions(true);
+    assert_true(LE_OK == admin_CreateInput(livePath, IO_DATA_TYPE_NUMERIC, ""));
+    usleep(10000);
+
+    le_clk_Time_t now = le_clk_GetAbsoluteTime();
+    double since = now.sec + (now.usec / 1000000.0);
+
+    // While the log holds all the deletions, a snapshot of changes only reports them.
+    CreateAndDeleteInputs(1);
+    char* snapshot = TakeJsonSnapshot(since);
+    assert_null(strstr(snapshot, "lostDeletions"));
+    free(snapshot);
+
+    // Once deletions to report have been dropped from the full log, the whole tree is included.
+    CreateAndDeleteInputs(DELETION_TEST_RESOURCES_NB);
+    snapshot = TakeJsonSnapshot(since);
+    assert_non_null(strstr(snapshot, "\"lostDeletions\":true"));
+    assert_non_null(strstr(snapshot, "live"));
+    free(snapshot);
+
+    // Delete resources to leave the test in a clean state
+    admin_DeleteResource(livePath);
+    query_TrackDeletions(false);
+}
+
+/* Records pushed through the stream test's ring */
+#define STREAM_TEST_CAPACITY 2048
+#define STREAM_TEST_RECORDS_NB 1500
+/* Most records drained from a ring at a time (DHUB_STREAM_DRAIN_BATCH, 1024 by default) */
+#define STREAM_TEST_DRAIN_BATCH 1024
+
+static int StreamPushCount;
+static int StreamFirstDrainCount;
+
+static void StreamPushHandler
+(
+    double timestamp,
+    double value,
+    void* contextPtr
+)
+{
+    (void)timestamp;
+    (void)value;
+    ioStreamRing_t* ringPtr = contextPtr;
+
+    // The Data Hub only moves the ring's tail on once it has pushed the records it drained.
+    if (__atomic_load_n(&ringPtr->tail, __ATOMIC_ACQUIRE) == 0)
+    {
+        StreamFirstDrainCount++;
+    }
+    StreamPushCount++;
+}
+
+static bool WaitForStreamPushes
+(
+    int count
+)
+{
+    for (int i = 0 ; i < EVENT_LOOP_MAX_TURNS ; i++)
+    {
+        ServiceEvents();
+        if (StreamPushCount >= count)
+        {
+            return (StreamPushCount == count);
+        }
+        usleep(10000);
+    }
+    return false;
+}
+
+static void test_io_stream_drain_bounds
+(
+    void** state
+)
+{
+    (void)state;
+    const char* path = "/app/admintest/stream";
+    int fd = -1;
+    uint32_t overflows = 0;
+
+    simulateAppName = "admintest";
+    assert_true(LE_OK == io_CreateInput("stream", IO_DATA_TYPE_NUMERIC, ""));
+
+    io_StreamRef_t streamRef = io_OpenStream("stream", IO_DATA_TYPE_NUMERIC,
+                                             STREAM_TEST_CAPACITY, &fd);
+    assert_non_null(streamRef);
+    assert_true(fd >= 0);
+    ioStreamRing_t* ringPtr = mmap(NULL, ioStreamRing_Size(STREAM_TEST_CAPACITY),
+                                   PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    assert_true(ringPtr != MAP_FAILED);
+    close(fd);
+
+    admin_NumericPushHandlerRef_t ref = admin_AddNumericPushHandler(path,
+                                                                    StreamPushHandler,
+                                                                    ringPtr);
+    assert_non_null(ref);
+
+    // A drain pushes no more than a batch of records, and leaves the rest for the next one.
+    StreamPushCount = 0;
+    StreamFirstDrainCount = 0;
+    for (int i = 0 ; i < STREAM_TEST_RECORDS_NB ; i++)
+    {
+        assert_true(ioStreamRing_Write(ringPtr, IO_NOW, i));
+    }
+    assert_true(WaitForStreamPushes(STREAM_TEST_RECORDS_NB));
+    assert_int_equal(STREAM_TEST_DRAIN_BATCH, StreamFirstDrainCount);
+    assert_true(STREAM_TEST_RECORDS_NB == __atomic_load_n(&ringPtr->tail, __ATOMIC_ACQUIRE));
+
+    // Records written to a full ring are dropped and counted, rather than blocking the client.
+    for (int i = 0 ; i < STREAM_TEST_CAPACITY ; i++)
+    {
+        assert_true(ioStreamRing_Write(ringPtr, IO_NOW, i));
+    }
+    assert_false(ioStreamRing_Write(ringPtr, IO_NOW, 0));
+    assert_false(ioStreamRing_Write(ringPtr, IO_NOW, 0));
+    assert_true(WaitForStreamPushes(STREAM_TEST_RECORDS_NB + STREAM_TEST_CAPACITY));
+    assert_true(LE_OK == admin_GetStatCounter(path, ADMIN_STAT_DROPPED_OVERFLOW, &overflows));
+    assert_int_equal(2, overflows);
+
+    // Delete resources to leave the test in a clean state
+    admin_RemoveNumericPushHandler(ref);
+    io_CloseStream(streamRef);
+    munmap(ringPtr, ioStreamRing_Size(STREAM_TEST_CAPACITY));
+    io_DeleteResource("stream");
+}
+
+/* Last batch of resource tree changes delivered to TreeChangeBatchHandler() */
+static uint8_t TreeChangeBatch[ADMIN_MAX_TREE_CHANGE_BATCH_BYTES];
+static size_t TreeChangeBatchLen;
+static int TreeChangeBatchCount;
+
+static void TreeChangeBatchHandler
+(
+    const uint8_t* changesPtr,
+    size_t changesSize,
+    void* contextPtr
+)
+{
+    (void)contextPtr;
+
+    assert_true(changesSize <= sizeof(TreeChangeBatch));
+    memcpy(TreeChangeBatch, changesPtr, changesSize);
+    TreeChangeBatchLen = changesSize;
+    TreeChangeBatchCount++;
+}
+
+static void test_admin_tree_change_batch_resubscribe
+(
+    void** state
+)
+{
+    (void)state;
+    const char* beforePath = "/app/treeChange/before";
+    const char* afterPath = "/app/treeChange/after";
+
+    TreeChangeBatchCount = 0;
+
+    // A change made while subscribed, but still pending when the last handler is removed...
+    admin_ResourceTreeChangeBatchHandlerRef_t ref =
+        admin_AddResourceTreeChangeBatchHandler(TreeChangeBatchHandler, NULL);
+    assert_non_null(ref);
+    assert_true(LE_OK == admin_CreateInput(beforePath, IO_DATA_TYPE_NUMERIC, ""));
+    admin_RemoveResourceTreeChangeBatchHandler(ref);
+
+    // ...isn't delivered to a handler added afterwards, which only gets the later changes.
+    ref = admin_AddResourceTreeChangeBatchHandler(TreeChangeBatchHandler, NULL);
+    assert_non_null(ref);
+    assert_true(LE_OK == admin_CreateInput(afterPath, IO_DATA_TYPE_NUMERIC, ""));
+
+    for (int i = 0 ; (i < EVENT_LOOP_MAX_TURNS) && (TreeChangeBatchCount == 0) ; i++)
+    {
+        ServiceEvents();
+        if (TreeChangeBatchCount == 0)
+        {
+            usleep(10000);
+        }
+    }
+    assert_int_equal(1, TreeChangeBatchCount);
+
+    // Each change is the entry type, the operation and the path (null-terminated).
+    bool isAfterFound = false;
+    size_t offset = 0;
+    while (offset < TreeChangeBatchLen)
+    {
+        const char* path = (const char*)TreeChangeBatch + offset + 2;
+
+        assert_null(strstr(path, "before"));
+        if (strcmp(path, afterPath) == 0)
+        {
+            isAfterFound = true;
+        }
+        offset += 2 + strlen(path) + 1;
+    }
+    assert_int_equal(TreeChangeBatchLen, offset);
+    assert_true(isAfterFound);
+
+    // Delete resources to leave the test in a clean state
+    admin_RemoveResourceTreeChangeBatchHandler(ref);
+    admin_DeleteResource(beforePath);
+    admin_DeleteResource(afterPath);
+}
+
+/* Children of the child index test's namespace (more than DHUB_CHILD_INDEX_THRESHOLD, 32 by
+   default, so that the namespace gets a Child Index) */
+#define CHILD_INDEX_TEST_RESOURCES_NB 100
+
+static void test_resTree_child_index_lookup
+(
+    void** state
+)
+{
+    (void)state;
+    char path[IO_MAX_RESOURCE_PATH_LEN + 1];
+
+    for (int i = 0 ; i < CHILD_INDEX_TEST_RESOURCES_NB ; i++)
+    {
+        snprintf(path, sizeof(path), "/app/childIndex/child%d", i);
+        assert_true(LE_OK == admin_CreateInput(path, IO_DATA_TYPE_NUMERIC, ""));
+    }
+
+    // Every child is found, and iteration still follows the order the children were added in.
+    resTree_EntryRef_t nsRef = resTree_FindEntryAtAbsolutePath("/app/childIndex");
+    assert_non_null(nsRef);
+    resTree_EntryRef_t childRef = resTree_GetFirstChild(nsRef);
+    for (int i = 0 ; i < CHILD_INDEX_TEST_RESOURCES_NB ; i++)
+    {
+        snprintf(path, sizeof(path), "/app/childIndex/child%d", i);
+        assert_true(ADMIN_ENTRY_TYPE_INPUT == admin_GetEntryType(path));
+
+        assert_non_null(childRef);
+        assert_string_equal(path + strlen("/app/childIndex/"), resTree_GetEntryName(childRef));
+        childRef = resTree_GetNextSibling(childRef);
+    }
+    assert_null(childRef);
+
+    // Names that aren't children aren't found, even if they are close to ones that are.
+    assert_true(ADMIN_ENTRY_TYPE_NONE == admin_GetEntryType("/app/childIndex/child100"));
+    assert_true(ADMIN_ENTRY_TYPE_NONE == admin_GetEntryType("/app/childIndex/child"));
+    assert_true(ADMIN_ENTRY_TYPE_NONE == admin_GetEntryType("/app/childIndex/Child1"));
+
+    // Deleted children are no longer found, but the others still are.
+    for (int i = 0 ; i < CHILD_INDEX_TEST_RESOURCES_NB ; i += 2)
+    {
+        snprintf(path, sizeof(path), "/app/childIndex/child%d", i);
+        admin_DeleteResource(path);
+    }
+    for (int i = 0 ; i < CHILD_INDEX_TEST_RESOURCES_NB ; i++)
+    {
+        snprintf(path, sizeof(path), "/app/childIndex/child%d", i);
+        assert_true(((i % 2) ? ADMIN_ENTRY_TYPE_INPUT : ADMIN_ENTRY_TYPE_NONE)
+                    == admin_GetEntryType(path));
+    }
+
+    // Once all the children are gone, a new one is found without an index.
+    for (int i = 1 ; i < CHILD_INDEX_TEST_RESOURCES_NB ; i += 2)
+    {
+        snprintf(path, sizeof(path), "/app/childIndex/child%d", i);
+        admin_DeleteResource(path);
+    }
+    assert_true(LE_OK == admin_CreateInput("/app/childIndex/child0", IO_DATA_TYPE_NUMERIC, ""));
+    assert_true(ADMIN_ENTRY_TYPE_INPUT == admin_GetEntryType("/app/childIndex/child0"));
+    assert_true(ADMIN_ENTRY_TYPE_NONE == admin_GetEntryType("/app/childIndex/child1"));
+
+    // Delete resources to leave the test in a clean state
+    admin_DeleteResource("/app/childIndex/child0");
+}
+
+static void test_io_resource_handle_stale
+(
+    void** state
+)
+{
+    (void)state;
+    const char* absPath = "/app/admintest/handle";
+    double timestamp;
+    double value;
+
+    simulateAppName = "admintest";
+    assert_true(LE_OK == io_CreateInput("handle", IO_DATA_TYPE_NUMERIC, ""));
+    assert_null(io_GetResourceHandle("noSuchResource"));
+
+    // Pushes through a handle reach the resource.
+    io_ResourceRef_t handle = io_GetResourceHandle("handle");
+    assert_non_null(handle);
+    assert_true(LE_OK == io_PushNumericByHandle(handle, BUFFER_TEST_START_TIME, 1.5));
+    assert_true(LE_OK == query_GetNumeric(absPath, &timestamp, &value));
+    assert_true(BUFFER_TEST_START_TIME == timestamp);
+    assert_true(1.5 == value);
+
+    // A sample of the wrong data type is converted to the resource's, and invalid JSON is
+    // rejected.
+    assert_true(LE_OK == io_PushBooleanByHandle(handle, BUFFER_TEST_START_TIME + 1, true));
+    assert_true(LE_OK == query_GetNumeric(absPath, &timestamp, &value));
+    assert_true(1.0 == value);
+    assert_true(LE_BAD_PARAMETER == io_PushJsonByHandle(handle, IO_NOW, "{\"a\":"));
+    assert_true(LE_OK == query_GetNumeric(absPath, &timestamp, &value));
+    assert_true(BUFFER_TEST_START_TIME + 1 == timestamp);
+
+    // A released handle is stale.
+    io_ReleaseResourceHandle(handle);
+    assert_true(LE_NOT_FOUND == io_PushNumericByHandle(handle, IO_NOW, 2.0));
+    assert_true(LE_NOT_FOUND == io_PushNumericByHandle(NULL, IO_NOW, 2.0));
+
+    // So is one whose resource has been deleted by the administrator...
+    handle = io_GetResourceHandle("handle");
+    assert_non_null(handle);
+    admin_DeleteResource(absPath);
+    assert_true(LE_NOT_FOUND == io_PushNumericByHandle(handle, IO_NOW, 2.0));
+    assert_true(LE_NOT_FOUND == io_PushTriggerByHandle(handle, IO_NOW));
+    io_ReleaseResourceHandle(handle);
+
+    // ...or by the client, even if a resource with the same path has been created since.
+    assert_true(LE_OK == io_CreateInput("handle", IO_DATA_TYPE_NUMERIC, ""));
+    handle = io_GetResourceHandle("handle");
+    assert_non_null(handle);
+    io_DeleteResource("handle");
+    assert_true(LE_OK == io_CreateInput("handle", IO_DATA_TYPE_NUMERIC, ""));
+    assert_true(LE_NOT_FOUND == io_PushNumericByHandle(handle, IO_NOW, 2.0));
+    assert_true(LE_UNAVAILABLE == query_GetNumeric(absPath, &timestamp, &value));
+
+    // Delete resources to leave the test in a clean state
+    io_DeleteResource("handle");
+}
+
+static void test_io_push_batch
+(
+    void** state
+)
+{
+    (void)state;
+    io_ResourceRef_t handles[IO_MAX_BATCH_LEN + 1];
+    double timestamps[IO_MAX_BATCH_LEN + 1] = { IO_NOW };
+    double values[IO_MAX_BATCH_LEN + 1] = { 0 };
+    bool flags[2] = { true, false };
+    double timestamp;
+    double firstTimestamp;
+    double value;
+    bool flag;
+
+    simulateAppName = "admintest";
+    assert_true(LE_OK == io_CreateInput("batch0", IO_DATA_TYPE_NUMERIC, ""));
+    assert_true(LE_OK == io_CreateInput("batch1", IO_DATA_TYPE_NUMERIC, ""));
+    assert_true(LE_OK == io_CreateInput("batchFlag", IO_DATA_TYPE_BOOLEAN, ""));
+    handles[0] = io_GetResourceHandle("batch0");
+    handles[1] = io_GetResourceHandle("batch1");
+    handles[2] = io_GetResourceHandle("batchFlag");
+    assert_non_null(handles[0]);
+    assert_non_null(handles[1]);
+    assert_non_null(handles[2]);
+
+    // The samples of a batch that are timestamped "now" all get the same timestamp.
+    values[0] = 1.0;
+    values[1] = 2.0;
+    assert_true(LE_OK == io_PushNumericBatch(handles, 2, timestamps, 2, values, 2));
+    assert_true(LE_OK == query_GetNumeric("/app/admintest/batch0", &firstTimestamp, &value));
+    assert_true(1.0 == value);
+    assert_true(LE_OK == query_GetNumeric("/app/admintest/batch1", &timestamp, &value));
+    assert_true(2.0 == value);
+    assert_true(firstTimestamp == timestamp);
+
+    // Nothing is pushed from a batch whose arrays differ in length or that is too long.
+    values[0] = 3.0;
+    assert_true(LE_BAD_PARAMETER == io_PushNumericBatch(handles, 2, timestamps, 1, values, 2));
+    assert_true(LE_BAD_PARAMETER == io_PushBooleanBatch(handles, 2, timestamps, 2, flags, 1));
+    for (int i = 0 ; i <= IO_MAX_BATCH_LEN ; i++)
+    {
+        handles[i] = handles[0];
+        timestamps[i] = IO_NOW;
+        values[i] = 3.0;
+    }
+    assert_true(LE_BAD_PARAMETER == io_PushNumericBatch(handles, IO_MAX_BATCH_LEN + 1,
+                                                        timestamps, IO_MAX_BATCH_LEN + 1,
+                                                        values, IO_MAX_BATCH_LEN + 1));
+    assert_true(LE_OK == query_GetNumeric("/app/admintest/batch0", &timestamp, &value));
+    assert_true(1.0 == value);
+
+    // Samples of the wrong data type are converted to each resource's.
+    handles[1] = io_GetResourceHandle("batch1");
+    handles[2] = io_GetResourceHandle("batchFlag");
+    values[2] = 0.0;
+    assert_true(LE_OK == io_PushNumericBatch(handles + 1, 2, timestamps, 2, values + 1, 2));
+    assert_true(LE_OK == query_GetBoolean("/app/admintest/batchFlag", &timestamp, &flag));
+    assert_false(flag);
+    assert_true(LE_OK == io_PushBooleanBatch(handles + 1, 2, timestamps, 2, flags, 2));
+    assert_true(LE_OK == query_GetNumeric("/app/admintest/batch1", &timestamp, &value));
+    assert_true(1.0 == value);
+    assert_true(LE_OK == query_GetBoolean("/app/admintest/batchFlag", &timestamp, &flag));
+    assert_false(flag);
+
+    // A stale handle fails the batch, but the other samples are still pushed.
+    io_ReleaseResourceHandle(handles[1]);
+    values[0] = 4.0;
+    values[2] = 5.0;
+    assert_true(LE_NOT_FOUND == io_PushNumericBatch(handles, 3, timestamps, 3, values, 3));
+    assert_true(LE_OK == query_GetNumeric("/app/admintest/batch0", &timestamp, &value));
+    assert_true(4.0 == value);
+    assert_true(LE_OK == query_GetBoolean("/app/admintest/batchFlag", &timestamp, &flag));
+    assert_true(flag);
+
+    // Delete resources to leave the test in a clean state
+    io_DeleteResource("batch0");
+    io_DeleteResource("batch1");
+    io_DeleteResource("batchFlag");
+}
+
+static void test_resTree_interned_names
+(
+    void** state
+)
+{
+    (void)state;
+
+    assert_true(LE_OK == admin_CreateInput("/app/names/a/value", IO_DATA_TYPE_NUMERIC, ""));
+    assert_true(LE_OK == admin_CreateInput("/app/names/b/value", IO_DATA_TYPE_NUMERIC, ""));
+    assert_true(LE_OK == admin_CreateInput("/app/names/b/valueX", IO_DATA_TYPE_NUMERIC, ""));
+
+    // Entries with the same name share it.
+    resTree_EntryRef_t aRef = resTree_FindEntryAtAbsolutePath("/app/names/a/value");
+    resTree_EntryRef_t bRef = resTree_FindEntryAtAbsolutePath("/app/names/b/value");
+    assert_non_null(aRef);
+    assert_non_null(bRef);
+    assert_string_equal("value", resTree_GetEntryName(aRef));
+    assert_ptr_equal(resTree_GetEntryName(aRef), resTree_GetEntryName(bRef));
+
+    // A name that some other entry has, or that no entry has, doesn't match a child.
+    assert_true(ADMIN_ENTRY_TYPE_NONE == admin_GetEntryType("/app/names/a/valueX"));
+    assert_true(ADMIN_ENTRY_TYPE_NONE == admin_GetEntryType("/app/names/a/valu"));
+    assert_true(ADMIN_ENTRY_TYPE_NONE == admin_GetEntryType("/app/names/b/valueXY"));
+
+    // Creating an entry again with another data type fails, and leaves the shared name alone.
+    assert_true(LE_DUPLICATE == admin_CreateInput("/app/names/a/value", IO_DATA_TYPE_STRING, ""));
+    assert_string_equal("value", resTree_GetEntryName(aRef));
+
+    // Deleting one of the entries doesn't take the name away from the other.
+    admin_DeleteResource("/app/names/a/value");
+    assert_true(ADMIN_ENTRY_TYPE_NONE == admin_GetEntryType("/app/names/a/value"));
+    assert_true(ADMIN_ENTRY_TYPE_INPUT == admin_GetEntryType("/app/names/b/value"));
+    assert_string_equal("value", resTree_GetEntryName(bRef));
+
+    // Once no entry has the name any more, it can still be given to a new one.
+    admin_DeleteResource("/app/names/b/value");
+    admin_DeleteResource("/app/names/b/valueX");
+    assert_true(ADMIN_ENTRY_TYPE_NONE == admin_GetEntryType("/app/names/b/value"));
+    assert_true(LE_OK == admin_CreateInput("/app/names/a/value", IO_DATA_TYPE_NUMERIC, ""));
+    aRef = resTree_FindEntryAtAbsolutePath("/app/names/a/value");
+    assert_non_null(aRef);
+    assert_string_equal("value", resTree_GetEntryName(aRef));
+
+    // Delete resources to leave the test in a clean state
+    admin_DeleteResource("/app/names/a/value");
+}
+
 int main(int argc, char **argv)
 {
     (void)argc;
@@ -259,7 +1111,18 @@ int main(int argc, char **argv)
         cmocka_unit_test(test_admin_create_output_bad_path),
         cmocka_unit_test(test_admin_create_output_duplicate),
         cmocka_unit_test(test_admin_mark_optional),
-        cmocka_unit_test(test_admin_set_json_example)
+        cmocka_unit_test(test_admin_set_json_example),
+        cmocka_unit_test(test_res_push_route_order),
+        cmocka_unit_test(test_res_push_error_latching),
+        cmocka_unit_test(test_obs_ring_wrap_truncate),
+        cmocka_unit_test(test_obs_journal_append_compact),
+        cmocka_unit_test(test_snapshot_deletion_log_overflow),
+        cmocka_unit_test(test_io_stream_drain_bounds),
+        cmocka_unit_test(test_admin_tree_change_batch_resubscribe),
+        cmocka_unit_test(test_resTree_child_index_lookup),
+        cmocka_unit_test(test_io_resource_handle_stale),
+        cmocka_unit_test(test_io_push_batch),
+        cmocka_unit_test(test_resTree_interned_names)
     };
     return cmocka_run_group_tests(tests, setup, teardown);
 }
@@ -67,6 +67,46 @@ typedef struct query_StringPushHandler* query_StringPushHandlerRef_t;
 typedef struct query_JsonPushHandler* query_JsonPushHandlerRef_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference type used by Add/Remove functions for EVENT 'query_BooleanBatchPush'
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct query_BooleanBatchPushHandler* query_BooleanBatchPushHandlerRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference type used by Add/Remove functions for EVENT 'query_NumericBatchPush'
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct query_NumericBatchPushHandler* query_NumericBatchPushHandlerRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference type used by Add/Remove functions for EVENT 'query_FilteredBooleanPush'
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct query_FilteredBooleanPushHandler* query_FilteredBooleanPushHandlerRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference type used by Add/Remove functions for EVENT 'query_FilteredNumericPush'
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct query_FilteredNumericPushHandler* query_FilteredNumericPushHandlerRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference type used by Add/Remove functions for EVENT 'query_FilteredStringPush'
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct query_FilteredStringPushHandler* query_FilteredStringPushHandlerRef_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  */
@@ -83,6 +123,26 @@ typedef enum
 query_SnapshotFormat_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ways in which the samples read from a buffer can be decimated.  The samples are split into
+ * buckets, and one sample is written for each bucket.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    QUERY_DECIMATION_LTTB = 0,
+        ///< Largest-Triangle-Three-Buckets: the sample that best keeps the visual
+        ///< shape of the data.  The first and last samples are always included.
+    QUERY_DECIMATION_STRIDE = 1,
+        ///< The first sample of each bucket (every Nth sample).
+    QUERY_DECIMATION_MEAN = 2
+        ///< The mean timestamp and value of the samples in each bucket.
+        ///< Non-numerical samples are decimated by stride instead.
+}
+query_DecimationMode_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  */
@@ -191,6 +251,60 @@ typedef void (*query_HandleSnapshotResultFunc_t)
         ///<
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback function for pushing batches of Boolean values to an output
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*query_BooleanBatchPushHandlerFunc_t)
+(
+        const double* timestampsPtr,
+        ///< Timestamps in seconds since the Epoch (UTC).
+        size_t timestampsSize,
+        ///<
+        const bool* valuesPtr,
+        ///< Values, in the same order as the timestamps.
+        size_t valuesSize,
+        ///<
+        void* contextPtr
+        ///<
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback function for pushing batches of numeric values to an output
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*query_NumericBatchPushHandlerFunc_t)
+(
+        const double* timestampsPtr,
+        ///< Timestamps in seconds since the Epoch (UTC).
+        size_t timestampsSize,
+        ///<
+        const double* valuesPtr,
+        ///< Values, in the same order as the timestamps.
+        size_t valuesSize,
+        ///<
+        void* contextPtr
+        ///<
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback to be invoked when a snapshot written to shared memory is complete or if an error
+ * occurs.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*query_HandleSnapshotMemoryResultFunc_t)
+(
+        le_result_t status,
+        ///< LE_OK when content is complete. Any other value indicates an error.
+        uint32_t length,
+        ///< Number of bytes of encoded snapshot data in the shared memory file.
+        void* contextPtr
+        ///<
+);
+
 
 //--------------------------------------------------------------------------------------------------
 /**
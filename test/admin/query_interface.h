@@ -318,6 +318,109 @@ le_result_t query_ReadBufferJson
         ///< [IN]
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer in JSON format (like query_ReadBufferJson()), decimated to at most a
+ * given number of samples using the Largest-Triangle-Three-Buckets (LTTB) algorithm.
+ *
+ * @return
+ *  - LE_OK if the read operation started successfully.
+ *  - LE_NOT_FOUND if the Observation doesn't exist.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t query_ReadBufferJsonDecimated
+(
+    const char* LE_NONNULL obsPath,
+        ///< [IN] Observation path. Can be absolute
+        ///< (beginning with a '/') or relative to /obs/.
+    double startAfter,
+        ///< [IN] Start after this many seconds ago,
+        ///< or after an absolute number of seconds since the Epoch
+        ///< (if startafter > 30 years).
+        ///< Use NAN (not a number) to read the whole buffer.
+    uint32_t maxCount,
+        ///< [IN] Maximum number of samples to read (at least 3). 0 = no limit.
+    int outputFile,
+        ///< [IN] File descriptor to write the data to.
+    query_ReadCompletionFunc_t completionFuncPtr,
+        ///< [IN] Completion callback to be called when operation finishes.
+    void* contextPtr
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the samples in a buffer that are newer than a start time and not newer than an end time,
+ * in JSON format (like query_ReadBufferJson()), decimated to at most a given number of samples.
+ *
+ * Buffers holding non-numerical data (other than Boolean) are decimated by stride, whatever the
+ * mode.  Reads start in the spilled history, like query_ReadBufferJson(), if it holds samples
+ * newer than the start time.  The samples asked for are then shared between the history and the
+ * buffer in proportion to the number of samples each holds.  The history can only be read once,
+ * in order, so LTTB selects the sample of each of its buckets against the mean of that bucket
+ * rather than the next.
+ *
+ * @return
+ *  - LE_OK if the read operation started successfully.
+ *  - LE_NOT_FOUND if the Observation doesn't exist.
+ *  - LE_BAD_PARAMETER if the decimation mode is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t query_ReadBufferJsonRange
+(
+    const char* LE_NONNULL obsPath,
+        ///< [IN] Observation path. Can be absolute
+        ///< (beginning with a '/') or relative to /obs/.
+    double startAfter,
+        ///< [IN] Start after this many seconds ago,
+        ///< or after an absolute number of seconds since the Epoch
+        ///< (if startafter > 30 years).
+        ///< Use NAN (not a number) to start at the oldest sample.
+    double endAt,
+        ///< [IN] End at this many seconds ago,
+        ///< or at an absolute number of seconds since the Epoch
+        ///< (if endAt > 30 years).
+        ///< Use NAN (not a number) to read up to the newest sample.
+    uint32_t maxCount,
+        ///< [IN] Maximum number of samples to read (at least 3 for LTTB). 0 = no limit.
+    query_DecimationMode_t mode,
+        ///< [IN] How to select the samples, if there are more than maxCount.
+    int outputFile,
+        ///< [IN] File descriptor to write the data to.
+    query_ReadCompletionFunc_t completionFuncPtr,
+        ///< [IN] Completion callback to be called when operation finishes.
+    void* contextPtr
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read data out of a buffer in CBOR (RFC 7049) format, as an indefinite-length array of
+ * [timestamp, value] arrays.
+ *
+ * @return
+ *  - LE_OK if the read operation started successfully.
+ *  - LE_NOT_FOUND if the Observation doesn't exist.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t query_ReadBufferCbor
+(
+    const char* LE_NONNULL obsPath,
+        ///< [IN] Observation path. Can be absolute
+        ///< (beginning with a '/') or relative to /obs/.
+    double startAfter,
+        ///< [IN] Start after this many seconds ago,
+        ///< or after an absolute number of seconds since the Epoch
+        ///< (if startafter > 30 years).
+        ///< Use NAN (not a number) to read the whole buffer.
+    int outputFile,
+        ///< [IN] File descriptor to write the data to.
+    query_ReadCompletionFunc_t completionFuncPtr,
+        ///< [IN] Completion callback to be called when operation finishes.
+    void* contextPtr
+        ///< [IN]
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Read the timestamp of a single sample from a buffer.
@@ -535,6 +638,35 @@ double query_GetStdDev
         ///< [IN] If < 30 years then seconds before now; else seconds since the Epoch.
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the minimum, maximum, mean and standard deviation of all values found within a given time
+ * span in an Observation's buffer, all at once.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if the Observation doesn't exist.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t query_GetStats
+(
+    const char* LE_NONNULL obsPath,
+        ///< [IN] Observation path. Can be absolute
+        ///< (beginning with a '/') or relative to /obs/.
+    double startTime,
+        ///< [IN] If < 30 years then seconds before now; else seconds since the Epoch.
+    double* minPtr,
+        ///< [OUT] Minimum value.
+    double* maxPtr,
+        ///< [OUT] Maximum value.
+    double* meanPtr,
+        ///< [OUT] Mean (average) value.
+    double* stdDevPtr,
+        ///< [OUT] Standard deviation.
+    uint32_t* countPtr
+        ///< [OUT] Number of numerical values the statistics were computed from.
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the current data type of a resource.
@@ -861,6 +993,161 @@ void query_RemoveJsonPushHandler
         ///< [IN]
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'query_BooleanBatchPush'
+ */
+//--------------------------------------------------------------------------------------------------
+query_BooleanBatchPushHandlerRef_t query_AddBooleanBatchPushHandler
+(
+    const char* LE_NONNULL path,
+        ///< [IN] Absolute path of resource.
+    uint32_t maxCount,
+        ///< [IN] Pending samples to deliver at once (0 = io.MAX_BATCH_LEN).
+    uint32_t maxDelayMs,
+        ///< [IN] Longest time (ms) a sample may be held back (0 = no limit).
+    query_BooleanBatchPushHandlerFunc_t callbackPtr,
+        ///< [IN]
+    void* contextPtr
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'query_BooleanBatchPush'
+ */
+//--------------------------------------------------------------------------------------------------
+void query_RemoveBooleanBatchPushHandler
+(
+    query_BooleanBatchPushHandlerRef_t handlerRef
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'query_NumericBatchPush'
+ */
+//--------------------------------------------------------------------------------------------------
+query_NumericBatchPushHandlerRef_t query_AddNumericBatchPushHandler
+(
+    const char* LE_NONNULL path,
+        ///< [IN] Absolute path of resource.
+    uint32_t maxCount,
+        ///< [IN] Pending samples to deliver at once (0 = io.MAX_BATCH_LEN).
+    uint32_t maxDelayMs,
+        ///< [IN] Longest time (ms) a sample may be held back (0 = no limit).
+    query_NumericBatchPushHandlerFunc_t callbackPtr,
+        ///< [IN]
+    void* contextPtr
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'query_NumericBatchPush'
+ */
+//--------------------------------------------------------------------------------------------------
+void query_RemoveNumericBatchPushHandler
+(
+    query_NumericBatchPushHandlerRef_t handlerRef
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'query_FilteredBooleanPush'
+ */
+//--------------------------------------------------------------------------------------------------
+query_FilteredBooleanPushHandlerRef_t query_AddFilteredBooleanPushHandler
+(
+    const char* LE_NONNULL path,
+        ///< [IN] Absolute path of resource.
+    double minPeriod,
+        ///< [IN] Minimum time between notifications (s).  0 or NAN = no minimum.
+    double changeBy,
+        ///< [IN] Non-zero to only notify when the value changes.
+    query_BooleanPushHandlerFunc_t callbackPtr,
+        ///< [IN]
+    void* contextPtr
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'query_FilteredBooleanPush'
+ */
+//--------------------------------------------------------------------------------------------------
+void query_RemoveFilteredBooleanPushHandler
+(
+    query_FilteredBooleanPushHandlerRef_t handlerRef
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'query_FilteredNumericPush'
+ */
+//--------------------------------------------------------------------------------------------------
+query_FilteredNumericPushHandlerRef_t query_AddFilteredNumericPushHandler
+(
+    const char* LE_NONNULL path,
+        ///< [IN] Absolute path of resource.
+    double minPeriod,
+        ///< [IN] Minimum time between notifications (s).  0 or NAN = no minimum.
+    double changeBy,
+        ///< [IN] Minimum change since the last value notified.  0 or NAN = any.
+    double lowLimit,
+        ///< [IN] Lowest value notified.  NAN = no limit.
+    double highLimit,
+        ///< [IN] Highest value notified.  NAN = no limit.  If lower than
+        ///< lowLimit, only values outside of the range between are notified.
+    query_NumericPushHandlerFunc_t callbackPtr,
+        ///< [IN]
+    void* contextPtr
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'query_FilteredNumericPush'
+ */
+//--------------------------------------------------------------------------------------------------
+void query_RemoveFilteredNumericPushHandler
+(
+    query_FilteredNumericPushHandlerRef_t handlerRef
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'query_FilteredStringPush'
+ */
+//--------------------------------------------------------------------------------------------------
+query_FilteredStringPushHandlerRef_t query_AddFilteredStringPushHandler
+(
+    const char* LE_NONNULL path,
+        ///< [IN] Absolute path of resource.
+    double minPeriod,
+        ///< [IN] Minimum time between notifications (s).  0 or NAN = no minimum.
+    double changeBy,
+        ///< [IN] Non-zero to only notify when the value changes.
+    query_StringPushHandlerFunc_t callbackPtr,
+        ///< [IN]
+    void* contextPtr
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'query_FilteredStringPush'
+ */
+//--------------------------------------------------------------------------------------------------
+void query_RemoveFilteredStringPushHandler
+(
+    query_FilteredStringPushHandlerRef_t handlerRef
+        ///< [IN]
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  */
@@ -891,6 +1178,43 @@ void query_TakeSnapshot
         ///< streamed.
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Capture a snapshot of the resource tree into shared memory.
+ *
+ * This behaves like query_TakeSnapshot(), except that the encoded snapshot is written into an
+ * anonymous shared memory file, which must not be read until the callback has been invoked.
+ */
+//--------------------------------------------------------------------------------------------------
+void query_TakeSnapshotToMemory
+(
+    uint32_t format,
+        ///< [IN] Snapshot output data
+        ///< format.
+    query_SnapshotFlag_t flags,
+        ///< [IN] Flags controlling the
+        ///< snapshot action.
+    const char* LE_NONNULL path,
+        ///< [IN] Tree path to use as the
+        ///< root.
+    double since,
+        ///< [IN] Request only values that
+        ///< have changed since this
+        ///< time (in s).  Use
+        ///< BEGINNING_OF_TIME to
+        ///< request the full tree.
+    query_HandleSnapshotMemoryResultFunc_t callbackPtr,
+        ///< [IN] Completion callback to
+        ///< indicate the end of the
+        ///< snapshot, or an error.
+    void* contextPtr,
+        ///< [IN]
+    int* snapshotMemoryPtr
+        ///< [OUT] Shared memory file that
+        ///< the encoded snapshot data
+        ///< will be written to.
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  */
@@ -0,0 +1,559 @@
+/**
+ * @file bench.c
+ *
+ * Benchmark of the Data Hub push path, built against the same mocked environment as the admin
+ * unit tests.
+ *
+ * A synthetic resource tree is generated: a number of numeric Inputs, each feeding a number of
+ * chains of Observations (the fan-out) of a given depth.  Every Observation in a chain applies a
+ * range filter and keeps a buffer, and the second one of each chain also applies a mean transform.
+ * Each numeric Input is matched by a JSON Input whose samples are extracted into a numeric
+ * Observation.  A push handler counts the samples coming out of the end of every chain.
+ *
+ * Pushes by path, by handle and in batches are then timed, followed by buffer exports and a
+ * snapshot of the whole tree, and the usage of the main memory pools is reported.
+ *
+ * Usage: benchtest [-n inputs] [-f fan-out] [-d depth] [-p pushes] [-b batch] [-B buffer]
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+#include "legato.h"
+#include "interfaces.h"
+
+#include <getopt.h>
+
+extern void initDataHub(void);
+
+/// App name used by the mocked I/O API client session (see mock.c).
+extern char* simulateAppName;
+
+/// Longest resource path generated by the benchmark.
+#define MAX_PATH_BYTES  (IO_MAX_RESOURCE_PATH_LEN + 1)
+
+/// Benchmark parameters.
+static unsigned int InputCount = 100;
+static unsigned int FanOut = 2;
+static unsigned int Depth = 3;
+static unsigned int PushCount = 1000;
+static unsigned int BatchLen = IO_MAX_BATCH_LEN;
+static unsigned int BufferLen = 100;
+
+/// Number of samples delivered to the push handlers at the end of the Observation chains.
+static uint64_t Deliveries;
+
+/// Latency of each timed operation of the current run (in ns).
+static uint64_t *Latencies;
+
+/// Completion state of the export operation in progress.
+static bool ExportDone;
+static le_result_t ExportResult;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current monotonic time.
+ *
+ * @return Time in ns.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t Now
+(
+    void
+)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Order latencies for qsort().
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareLatencies
+(
+    const void *a,
+    const void *b
+)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the throughput and latency percentiles of a run.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Report
+(
+    const char  *name,      ///< Name of the run.
+    size_t       ops,       ///< Number of timed operations (entries in Latencies).
+    size_t       samples,   ///< Number of samples pushed by those operations.
+    uint64_t     elapsed    ///< Wall time of the run (in ns).
+)
+{
+    qsort(Latencies, ops, sizeof(Latencies[0]), &CompareLatencies);
+
+    printf("%-22s %10zu samples %12.0f samples/s   p50 %8.2f us   p99 %8.2f us\n",
+           name,
+           samples,
+           (elapsed > 0 ? samples * 1e9 / elapsed : 0.0),
+           Latencies[ops / 2] / 1000.0,
+           Latencies[(ops * 99) / 100] / 1000.0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count the samples coming out of the end of an Observation chain.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CountHandler
+(
+    double   timestamp,
+    double   value,
+    void    *contextPtr
+)
+{
+    LE_UNUSED(timestamp);
+    LE_UNUSED(value);
+    LE_UNUSED(contextPtr);
+
+    ++Deliveries;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generate the synthetic resource tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BuildTree
+(
+    void
+)
+{
+    char            path[MAX_PATH_BYTES];
+    char            source[MAX_PATH_BYTES];
+    unsigned int    i;
+    unsigned int    f;
+    unsigned int    d;
+
+    for (i = 0; i < InputCount; ++i)
+    {
+        snprintf(path, sizeof(path), "in%u", i);
+        LE_ASSERT_OK(io_CreateInput(path, IO_DATA_TYPE_NUMERIC, ""));
+        snprintf(path, sizeof(path), "json%u", i);
+        LE_ASSERT_OK(io_CreateInput(path, IO_DATA_TYPE_JSON, ""));
+
+        for (f = 0; f < FanOut; ++f)
+        {
+            snprintf(source, sizeof(source), "/app/%s/in%u", simulateAppName, i);
+            for (d = 0; d < Depth; ++d)
+            {
+                snprintf(path, sizeof(path), "/obs/b%u_%u_%u", i, f, d);
+                LE_ASSERT_OK(admin_CreateObs(path));
+                LE_ASSERT_OK(admin_SetSource(path, source));
+                admin_SetLowLimit(path, -1e12);
+                admin_SetHighLimit(path, 1e12);
+                admin_SetBufferMaxCount(path, BufferLen);
+                if (d == 1)
+                {
+                    admin_SetTransform(path, ADMIN_OBS_TRANSFORM_TYPE_MEAN, NULL, 0);
+                }
+                LE_ASSERT(le_utf8_Copy(source, path, sizeof(source), NULL) == LE_OK);
+            }
+            if (Depth > 0)
+            {
+                LE_ASSERT(query_AddNumericPushHandler(source, &CountHandler, NULL) != NULL);
+            }
+        }
+
+        snprintf(path, sizeof(path), "/obs/j%u", i);
+        snprintf(source, sizeof(source), "/app/%s/json%u", simulateAppName, i);
+        LE_ASSERT_OK(admin_CreateObs(path));
+        LE_ASSERT_OK(admin_SetSource(path, source));
+        admin_SetJsonExtraction(path, "x");
+        admin_SetBufferMaxCount(path, BufferLen);
+        LE_ASSERT(query_AddNumericPushHandler(path, &CountHandler, NULL) != NULL);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time pushes of numeric samples by path.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchPushByPath
+(
+    void
+)
+{
+    char            path[MAX_PATH_BYTES];
+    unsigned int    i;
+    unsigned int    p;
+    size_t          ops = 0;
+    uint64_t        start = Now();
+    uint64_t        t;
+
+    for (p = 0; p < PushCount; ++p)
+    {
+        for (i = 0; i < InputCount; ++i)
+        {
+            snprintf(path, sizeof(path), "in%u", i);
+            t = Now();
+            io_PushNumeric(path, IO_NOW, p + i * 0.5);
+            Latencies[ops++] = Now() - t;
+        }
+    }
+    Report("numeric by path", ops, ops, Now() - start);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time pushes of JSON samples through JSON extraction.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchPushJson
+(
+    void
+)
+{
+    char            path[MAX_PATH_BYTES];
+    char            value[64];
+    unsigned int    i;
+    unsigned int    p;
+    size_t          ops = 0;
+    uint64_t        start = Now();
+    uint64_t        t;
+
+    for (p = 0; p < PushCount; ++p)
+    {
+        for (i = 0; i < InputCount; ++i)
+        {
+            snprintf(path, sizeof(path), "json%u", i);
+            snprintf(value, sizeof(value), "{\"x\":%u,\"y\":[%u,true],\"z\":\"abc\"}", p, i);
+            t = Now();
+            io_PushJson(path, IO_NOW, value);
+            Latencies[ops++] = Now() - t;
+        }
+    }
+    Report("JSON extraction", ops, ops, Now() - start);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time pushes of numeric samples by handle, one at a time and in batches.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchPushByHandle
+(
+    void
+)
+{
+    char                 path[MAX_PATH_BYTES];
+    io_ResourceRef_t    *handles = calloc(InputCount, sizeof(handles[0]));
+    io_ResourceRef_t     batchHandles[IO_MAX_BATCH_LEN];
+    double               timestamps[IO_MAX_BATCH_LEN];
+    double               values[IO_MAX_BATCH_LEN];
+    unsigned int         i;
+    unsigned int         p;
+    size_t               n;
+    size_t               ops = 0;
+    size_t               samples = 0;
+    uint64_t             start;
+    uint64_t             t;
+
+    LE_ASSERT(handles != NULL);
+    for (i = 0; i < InputCount; ++i)
+    {
+        snprintf(path, sizeof(path), "in%u", i);
+        handles[i] = io_GetResourceHandle(path);
+        LE_ASSERT(handles[i] != NULL);
+    }
+
+    start = Now();
+    for (p = 0; p < PushCount; ++p)
+    {
+        for (i = 0; i < InputCount; ++i)
+        {
+            t = Now();
+            LE_ASSERT_OK(io_PushNumericByHandle(handles[i], IO_NOW, p + i * 0.25));
+            Latencies[ops++] = Now() - t;
+        }
+    }
+    Report("numeric by handle", ops, ops, Now() - start);
+
+    // Batches cycle through the inputs, so each one fans out to several of them.
+    ops = 0;
+    start = Now();
+    for (p = 0; p < PushCount; ++p)
+    {
+        for (i = 0; i < InputCount; i += n)
+        {
+            for (n = 0; n < BatchLen && i + n < InputCount; ++n)
+            {
+                batchHandles[n] = handles[i + n];
+                timestamps[n] = IO_NOW;
+                values[n] = p + (i + n) * 0.75;
+            }
+            t = Now();
+            LE_ASSERT_OK(io_PushNumericBatch(batchHandles, n, timestamps, n, values, n));
+            Latencies[ops++] = Now() - t;
+            samples += n;
+        }
+    }
+    Report("numeric batches", ops, samples, Now() - start);
+
+    for (i = 0; i < InputCount; ++i)
+    {
+        io_ReleaseResourceHandle(handles[i]);
+    }
+    free(handles);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Export operation completion callback.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HandleExportDone
+(
+    le_result_t  result,
+    void        *contextPtr
+)
+{
+    LE_UNUSED(contextPtr);
+
+    ExportResult = result;
+    ExportDone = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the event loop, draining the read end of an export stream, until the export is complete and
+ * the stream has been closed by the Data Hub.
+ *
+ * @return Number of bytes read from the stream.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t DrainExport
+(
+    int fd  ///< Read end of the export stream.
+)
+{
+    char            buffer[4096];
+    ssize_t         count;
+    size_t          total = 0;
+    bool            isOpen = true;
+    struct pollfd   fds[2] =
+    {
+        { .fd = le_event_GetFd(), .events = POLLIN },
+        { .fd = fd, .events = POLLIN }
+    };
+
+    while (!ExportDone || isOpen)
+    {
+        while (le_event_ServiceLoop() == LE_OK)
+        {
+        }
+
+        while (isOpen && (count = read(fd, buffer, sizeof(buffer))) != 0)
+        {
+            if (count < 0)
+            {
+                LE_ASSERT(errno == EAGAIN || errno == EWOULDBLOCK);
+                break;
+            }
+            total += count;
+        }
+        if (count == 0)
+        {
+            isOpen = false;
+        }
+
+        if (!ExportDone || isOpen)
+        {
+            poll(fds, (isOpen ? 2 : 1), 100);
+        }
+    }
+
+    close(fd);
+    return total;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the size and rate of an export.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportExport
+(
+    const char  *name,      ///< Name of the export.
+    size_t       bytes,     ///< Number of bytes exported.
+    uint64_t     elapsed    ///< Wall time of the export (in ns).
+)
+{
+    LE_ASSERT(ExportResult == LE_OK);
+    printf("%-22s %10zu bytes   %12.2f MB/s       %10.2f ms\n",
+           name, bytes, (elapsed > 0 ? bytes * 1e3 / elapsed : 0.0), elapsed / 1e6);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time reading an Observation buffer out in JSON and CBOR, and taking a snapshot of the tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchExports
+(
+    void
+)
+{
+    int         fds[2];
+    int         stream = -1;
+    size_t      bytes;
+    uint64_t    start;
+
+    if (Depth == 0)
+    {
+        return;
+    }
+
+    // Both read operations take over the write end of the pipe and close it when done.
+    LE_ASSERT(pipe2(fds, O_NONBLOCK) == 0);
+    ExportDone = false;
+    start = Now();
+    LE_ASSERT_OK(query_ReadBufferJson("/obs/b0_0_0", NAN, fds[1], &HandleExportDone, NULL));
+    bytes = DrainExport(fds[0]);
+    ReportExport("ReadBufferJson", bytes, Now() - start);
+
+    LE_ASSERT(pipe2(fds, O_NONBLOCK) == 0);
+    ExportDone = false;
+    start = Now();
+    LE_ASSERT_OK(query_ReadBufferCbor("/obs/b0_0_0", NAN, fds[1], &HandleExportDone, NULL));
+    bytes = DrainExport(fds[0]);
+    ReportExport("ReadBufferCbor", bytes, Now() - start);
+
+    ExportDone = false;
+    start = Now();
+    query_TakeSnapshot(QUERY_SNAPSHOT_FORMAT_JSON, 0, "/", QUERY_BEGINNING_OF_TIME,
+                       &HandleExportDone, NULL, &stream);
+    LE_ASSERT(stream >= 0);
+    bytes = DrainExport(stream);
+    ReportExport("JSON snapshot", bytes, Now() - start);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the usage of the busiest memory pools.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportPools
+(
+    void
+)
+{
+    static const char * const names[] =
+    {
+        "EntryPool",
+        "ObservationPool",
+        "NonStringDataSamplePool",
+        "StringBasedDataSamplePool",
+        "InlineStringSamplePool",
+        "SampleBlockPool",
+        "DequeBlockPool",
+        "HandlerPool",
+        "IoResourcePool",
+        "ResourceHandlePool"
+    };
+    le_mem_PoolStats_t  stats;
+    le_mem_PoolRef_t    pool;
+    size_t              i;
+
+    printf("\n%-26s %10s %10s %10s %10s\n", "pool", "blocks", "in use", "peak", "overflows");
+    for (i = 0; i < NUM_ARRAY_MEMBERS(names); ++i)
+    {
+        pool = le_mem_FindPool(names[i]);
+        if (pool == NULL)
+        {
+            printf("%-26s %10s\n", names[i], "n/a");
+            continue;
+        }
+        le_mem_GetStats(pool, &stats);
+        printf("%-26s %10zu %10zu %10zu %10zu\n",
+               names[i],
+               le_mem_GetObjectCount(pool),
+               stats.numBlocksInUse,
+               stats.maxNumBlocksUsed,
+               stats.numOverflows);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the command line parameters.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ParseArgs
+(
+    int     argc,
+    char  **argv
+)
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:f:d:p:b:B:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': InputCount = strtoul(optarg, NULL, 0);    break;
+            case 'f': FanOut = strtoul(optarg, NULL, 0);        break;
+            case 'd': Depth = strtoul(optarg, NULL, 0);         break;
+            case 'p': PushCount = strtoul(optarg, NULL, 0);     break;
+            case 'b': BatchLen = strtoul(optarg, NULL, 0);      break;
+            case 'B': BufferLen = strtoul(optarg, NULL, 0);     break;
+            default:
+                fprintf(stderr, "Usage: %s [-n inputs] [-f fan-out] [-d depth] [-p pushes]"
+                                " [-b batch] [-B buffer]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if (InputCount == 0 || PushCount == 0 || BatchLen == 0 || BatchLen > IO_MAX_BATCH_LEN)
+    {
+        fprintf(stderr, "Inputs and pushes must be non-zero, and the batch length between 1 and"
+                        " %d\n", IO_MAX_BATCH_LEN);
+        exit(EXIT_FAILURE);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t start;
+
+    ParseArgs(argc, argv);
+
+    simulateAppName = "bench";
+    initDataHub();
+
+    Latencies = calloc((size_t) InputCount * PushCount, sizeof(Latencies[0]));
+    LE_ASSERT(Latencies != NULL);
+
+    start = Now();
+    BuildTree();
+    printf("Tree: %u inputs, fan-out %u, depth %u, buffers of %u (built in %.2f ms)\n\n",
+           InputCount, FanOut, Depth, BufferLen, (Now() - start) / 1e6);
+
+    BenchPushByPath();
+    BenchPushJson();
+    BenchPushByHandle();
+    printf("%-22s %10" PRIu64 " samples\n\n", "delivered to handlers", Deliveries);
+
+    BenchExports();
+    ReportPools();
+
+    free(Latencies);
+    return EXIT_SUCCESS;
+}
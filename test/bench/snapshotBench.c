@@ -0,0 +1,609 @@
+/**
+ * @file snapshotBench.c
+ *
+ * Benchmark of Data Hub snapshots, built against the same mocked environment as the admin unit
+ * tests.
+ *
+ * A synthetic resource tree is generated: a number of Inputs spread over nested namespaces of a
+ * given width.  The Inputs cycle through numeric, Boolean, string and JSON types, the JSON values
+ * being of a given size, and every few Inputs also feed a buffered Observation.
+ *
+ * A full snapshot of the tree is timed with each formatter, followed by rounds of churn, in which a
+ * share of the Inputs get new values and another share is deleted and recreated, each followed by
+ * an incremental snapshot with each formatter.  Every snapshot reports its size, rate and wall
+ * time, and the longest time a single event handler held the event loop while it was taken (the
+ * stall).  The peak usage of the memory pools involved is reported at the end.
+ *
+ * The Octave formatter is only covered when the benchmark is built with OCTAVE_ROOT set.
+ *
+ * Usage: snapshotbench [-n inputs] [-w width] [-j json-bytes] [-o obs-every] [-u update-%]
+ *                      [-c churn-%] [-r rounds] [-m]
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+#include "legato.h"
+#include "interfaces.h"
+
+#include <getopt.h>
+
+#ifdef WITH_OCTAVE
+/// Query API custom flag used by the Octave formatter as a full tree encoding request.
+#define OCTAVE_FLAG_FULL_TREE QUERY_SNAPSHOT_FLAG_CUSTOM
+#endif
+
+extern void initDataHub(void);
+
+/// App name used by the mocked I/O API client session (see mock.c).
+extern char* simulateAppName;
+
+/// Longest resource path generated by the benchmark.
+#define MAX_PATH_BYTES  (IO_MAX_RESOURCE_PATH_LEN + 1)
+
+/// Shortest JSON value size that leaves room for the members identifying the value.
+#define MIN_JSON_BYTES  64
+
+/// Benchmark parameters.
+static unsigned int InputCount = 10000;
+static unsigned int Width = 16;
+static unsigned int JsonBytes = 256;
+static unsigned int ObsEvery = 10;
+static unsigned int UpdatePercent = 5;
+static unsigned int ChurnPercent = 1;
+static unsigned int Rounds = 3;
+static bool ToMemory = false;
+
+/// A snapshot formatter under test.
+typedef struct
+{
+    const char  *name;      ///< Name used in the report.
+    uint32_t     format;    ///< Query API snapshot format.
+    uint32_t     fullFlags; ///< Flags requesting the full tree rather than changes.
+}
+Formatter_t;
+
+/// Formatters built into the Data Hub.
+static const Formatter_t Formatters[] =
+{
+    { "JSON", QUERY_SNAPSHOT_FORMAT_JSON, 0 },
+#ifdef WITH_OCTAVE
+    { "Octave", QUERY_SNAPSHOT_FORMAT_OCTAVE, OCTAVE_FLAG_FULL_TREE },
+#endif
+};
+
+/// Completion state of the snapshot in progress.
+static bool SnapshotDone;
+static le_result_t SnapshotResult;
+
+/// Length of the last snapshot taken to memory.
+static uint32_t SnapshotLength;
+
+/// Longest time a single event handler held the event loop during the current snapshot (in ns).
+static uint64_t MaxStall;
+
+/// Buffer holding the JSON value being pushed.
+static char *JsonValue;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current monotonic time.
+ *
+ * @return Time in ns.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t Now
+(
+    void
+)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the path of an Input, relative to the app's namespace.  The Input's index divided by the
+ * width gives its namespace, with one level per digit in base width.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InputPath
+(
+    unsigned int     index, ///< Index of the Input.
+    char            *path,  ///< [OUT] Buffer for the path.
+    size_t           size   ///< Size of the buffer.
+)
+{
+    unsigned int    digits[MAX_PATH_BYTES / 2];
+    unsigned int    depth = 0;
+    unsigned int    ns;
+    size_t          len = 0;
+
+    for (ns = index / Width; ns > 0; ns /= Width)
+    {
+        digits[depth++] = ns % Width;
+    }
+    while (depth > 0)
+    {
+        len += snprintf(path + len, size - len, "g%u/", digits[--depth]);
+        LE_ASSERT(len < size);
+    }
+    LE_ASSERT((size_t) snprintf(path + len, size - len, "r%u", index % Width) < size - len);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the data type of an Input.
+ */
+//--------------------------------------------------------------------------------------------------
+static io_DataType_t InputType
+(
+    unsigned int index  ///< Index of the Input.
+)
+{
+    static const io_DataType_t types[] =
+    {
+        IO_DATA_TYPE_NUMERIC,
+        IO_DATA_TYPE_BOOLEAN,
+        IO_DATA_TYPE_STRING,
+        IO_DATA_TYPE_JSON
+    };
+
+    return types[index % NUM_ARRAY_MEMBERS(types)];
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a new value to an Input.  The value depends on the churn round, so that every round
+ * changes it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushValue
+(
+    unsigned int index, ///< Index of the Input.
+    unsigned int round  ///< Churn round (0 while building the tree).
+)
+{
+    char    path[MAX_PATH_BYTES];
+    char    value[32];
+    size_t  len;
+
+    InputPath(index, path, sizeof(path));
+    switch (InputType(index))
+    {
+        case IO_DATA_TYPE_NUMERIC:
+            io_PushNumeric(path, IO_NOW, index + round * 0.5);
+            break;
+
+        case IO_DATA_TYPE_BOOLEAN:
+            io_PushBoolean(path, IO_NOW, ((index + round) % 2) == 0);
+            break;
+
+        case IO_DATA_TYPE_STRING:
+            snprintf(value, sizeof(value), "s%u.%u", index, round);
+            io_PushString(path, IO_NOW, value);
+            break;
+
+        default:
+            // Pad the value out to the requested size.
+            len = snprintf(JsonValue, JsonBytes, "{\"i\":%u,\"r\":%u,\"pad\":\"", index, round);
+            while (len + 2 < JsonBytes)
+            {
+                JsonValue[len++] = 'x';
+            }
+            memcpy(JsonValue + len, "\"}", 3);
+            io_PushJson(path, IO_NOW, JsonValue);
+            break;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create an Input and give it a value.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CreateInput
+(
+    unsigned int index, ///< Index of the Input.
+    unsigned int round  ///< Churn round (0 while building the tree).
+)
+{
+    char path[MAX_PATH_BYTES];
+
+    InputPath(index, path, sizeof(path));
+    LE_ASSERT_OK(io_CreateInput(path, InputType(index), ""));
+    PushValue(index, round);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generate the synthetic resource tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BuildTree
+(
+    void
+)
+{
+    char            path[MAX_PATH_BYTES];
+    char            source[MAX_PATH_BYTES];
+    char            input[MAX_PATH_BYTES];
+    unsigned int    i;
+
+    for (i = 0; i < InputCount; ++i)
+    {
+        CreateInput(i, 0);
+
+        if (ObsEvery > 0 && (i % ObsEvery) == 0)
+        {
+            InputPath(i, input, sizeof(input));
+            snprintf(path, sizeof(path), "/obs/o%u", i);
+            LE_ASSERT(snprintf(source, sizeof(source), "/app/%s/%s", simulateAppName, input) <
+                (int) sizeof(source));
+            LE_ASSERT_OK(admin_CreateObs(path));
+            LE_ASSERT_OK(admin_SetSource(path, source));
+            admin_SetBufferMaxCount(path, 10);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Change the tree: update the values of a share of the Inputs and delete and recreate another
+ * share of them.  The Inputs are picked at random, so the changes are spread over the tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Churn
+(
+    unsigned int round  ///< Churn round.
+)
+{
+    char            path[MAX_PATH_BYTES];
+    unsigned int    updates = (unsigned int) ((uint64_t) InputCount * UpdatePercent / 100);
+    unsigned int    deletions = (unsigned int) ((uint64_t) InputCount * ChurnPercent / 100);
+    unsigned int    index;
+    unsigned int    i;
+    uint64_t        start = Now();
+
+    for (i = 0; i < updates; ++i)
+    {
+        PushValue(rand() % InputCount, round);
+    }
+    for (i = 0; i < deletions; ++i)
+    {
+        index = rand() % InputCount;
+        InputPath(index, path, sizeof(path));
+        io_DeleteResource(path);
+        CreateInput(index, round);
+    }
+
+    printf("\nRound %u: %u updates, %u deletions (%.2f ms)\n",
+           round, updates, deletions, (Now() - start) / 1e6);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Snapshot completion callback.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HandleSnapshotDone
+(
+    le_result_t  result,
+    void        *contextPtr
+)
+{
+    LE_UNUSED(contextPtr);
+
+    SnapshotResult = result;
+    SnapshotDone = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Completion callback of a snapshot taken to memory.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HandleMemorySnapshotDone
+(
+    le_result_t  result,
+    uint32_t     length,
+    void        *contextPtr
+)
+{
+    SnapshotLength = length;
+    HandleSnapshotDone(result, contextPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handle all the pending events, keeping track of the longest time taken by any one of them.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ServiceEvents
+(
+    void
+)
+{
+    le_result_t result;
+    uint64_t    start;
+    uint64_t    stall;
+
+    do
+    {
+        start = Now();
+        result = le_event_ServiceLoop();
+        stall = Now() - start;
+        if (stall > MaxStall)
+        {
+            MaxStall = stall;
+        }
+    }
+    while (result == LE_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the event loop, draining the read end of a snapshot stream if there is one, until the
+ * snapshot is complete and the stream has been closed by the Data Hub.
+ *
+ * @return Number of bytes read from the stream.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t DrainSnapshot
+(
+    int fd  ///< Read end of the snapshot stream, or -1 if the snapshot is not streamed.
+)
+{
+    char            buffer[4096];
+    ssize_t         count = -1;
+    size_t          total = 0;
+    bool            isOpen = (fd >= 0);
+    struct pollfd   fds[2] =
+    {
+        { .fd = le_event_GetFd(), .events = POLLIN },
+        { .fd = fd, .events = POLLIN }
+    };
+
+    if (isOpen)
+    {
+        LE_ASSERT(fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) == 0);
+    }
+
+    while (!SnapshotDone || isOpen)
+    {
+        ServiceEvents();
+
+        while (isOpen && (count = read(fd, buffer, sizeof(buffer))) != 0)
+        {
+            if (count < 0)
+            {
+                LE_ASSERT(errno == EAGAIN || errno == EWOULDBLOCK);
+                break;
+            }
+            total += count;
+        }
+        if (count == 0)
+        {
+            isOpen = false;
+        }
+
+        if (!SnapshotDone || isOpen)
+        {
+            poll(fds, (isOpen ? 2 : 1), 100);
+        }
+    }
+
+    return total;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take a snapshot of the whole tree and report its size, rate, wall time and stall.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunSnapshot
+(
+    const char  *name,      ///< Name of the run.
+    uint32_t     format,    ///< Snapshot format.
+    uint32_t     flags,     ///< Snapshot flags.
+    double       since      ///< Only report changes since this time (in s).
+)
+{
+    int         fd = -1;
+    size_t      bytes;
+    uint64_t    elapsed;
+    uint64_t    start;
+
+    SnapshotDone = false;
+    MaxStall = 0;
+    start = Now();
+    if (ToMemory)
+    {
+        query_TakeSnapshotToMemory(format, flags, "/", since, &HandleMemorySnapshotDone, NULL,
+            &fd);
+        DrainSnapshot(-1);
+        bytes = SnapshotLength;
+    }
+    else
+    {
+        query_TakeSnapshot(format, flags, "/", since, &HandleSnapshotDone, NULL, &fd);
+        bytes = DrainSnapshot(fd);
+    }
+    elapsed = Now() - start;
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    LE_ASSERT(SnapshotResult == LE_OK);
+
+    printf("%-22s %12zu bytes %10.2f MB/s %10.2f ms   stall %8.2f ms\n",
+           name,
+           bytes,
+           (elapsed > 0 ? bytes * 1e3 / elapsed : 0.0),
+           elapsed / 1e6,
+           MaxStall / 1e6);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take a snapshot with each formatter.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunFormatters
+(
+    double since    ///< Only report changes since this time (in s), or QUERY_BEGINNING_OF_TIME.
+)
+{
+    char        name[64];
+    bool        isFull = (since == QUERY_BEGINNING_OF_TIME);
+    uint32_t    flags;
+    size_t      i;
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(Formatters); ++i)
+    {
+        flags = (isFull ? Formatters[i].fullFlags : 0);
+
+        // Only the last formatter flushes the deletions, so that all of them report the same.
+        if (i == NUM_ARRAY_MEMBERS(Formatters) - 1)
+        {
+            flags |= QUERY_SNAPSHOT_FLAG_FLUSH_DELETIONS;
+        }
+
+        snprintf(name, sizeof(name), "%s %s", Formatters[i].name,
+                 (isFull ? "full" : "incremental"));
+        RunSnapshot(name, Formatters[i].format, flags, since);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the usage of the memory pools involved in snapshots.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportPools
+(
+    void
+)
+{
+    static const char * const names[] =
+    {
+        "EntryPool",
+        "ChildIndexPool",
+        "IoResourcePool",
+        "ObservationPool",
+        "NonStringDataSamplePool",
+        "StringBasedDataSamplePool",
+        "StringPool",
+        "NodeParentPool",
+        "DeletionRecordPool",
+        "JsonFormatterPool",
+        "OctaveFormatterPool"
+    };
+    le_mem_PoolStats_t  stats;
+    le_mem_PoolRef_t    pool;
+    size_t              i;
+
+    printf("\n%-26s %10s %10s %10s %10s\n", "pool", "blocks", "in use", "peak", "overflows");
+    for (i = 0; i < NUM_ARRAY_MEMBERS(names); ++i)
+    {
+        pool = le_mem_FindPool(names[i]);
+        if (pool == NULL)
+        {
+            printf("%-26s %10s\n", names[i], "n/a");
+            continue;
+        }
+        le_mem_GetStats(pool, &stats);
+        printf("%-26s %10zu %10zu %10zu %10zu\n",
+               names[i],
+               le_mem_GetObjectCount(pool),
+               stats.numBlocksInUse,
+               stats.maxNumBlocksUsed,
+               stats.numOverflows);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the command line parameters.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ParseArgs
+(
+    int     argc,
+    char  **argv
+)
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:w:j:o:u:c:r:m")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': InputCount = strtoul(optarg, NULL, 0);    break;
+            case 'w': Width = strtoul(optarg, NULL, 0);         break;
+            case 'j': JsonBytes = strtoul(optarg, NULL, 0);     break;
+            case 'o': ObsEvery = strtoul(optarg, NULL, 0);      break;
+            case 'u': UpdatePercent = strtoul(optarg, NULL, 0); break;
+            case 'c': ChurnPercent = strtoul(optarg, NULL, 0);  break;
+            case 'r': Rounds = strtoul(optarg, NULL, 0);        break;
+            case 'm': ToMemory = true;                          break;
+            default:
+                fprintf(stderr, "Usage: %s [-n inputs] [-w width] [-j json-bytes] [-o obs-every]"
+                                " [-u update-%%] [-c churn-%%] [-r rounds] [-m]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if (InputCount == 0 || Width < 2 || UpdatePercent > 100 || ChurnPercent > 100)
+    {
+        fprintf(stderr, "Inputs must be non-zero, the width at least 2 and the percentages at most"
+                        " 100\n");
+        exit(EXIT_FAILURE);
+    }
+    if (JsonBytes < MIN_JSON_BYTES || JsonBytes > IO_MAX_STRING_VALUE_LEN)
+    {
+        fprintf(stderr, "JSON values must be between %d and %d bytes\n",
+                MIN_JSON_BYTES, IO_MAX_STRING_VALUE_LEN);
+        exit(EXIT_FAILURE);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    le_clk_Time_t   now;
+    unsigned int    round;
+    uint64_t        start;
+
+    ParseArgs(argc, argv);
+
+    simulateAppName = "snapbench";
+    initDataHub();
+
+    JsonValue = malloc(JsonBytes + 1);
+    LE_ASSERT(JsonValue != NULL);
+
+    query_TrackDeletions(true);
+
+    start = Now();
+    BuildTree();
+    printf("Tree: %u inputs, width %u, JSON values of %u bytes, observation every %u inputs"
+           " (built in %.2f ms)\n\n",
+           InputCount, Width, JsonBytes, ObsEvery, (Now() - start) / 1e6);
+
+    RunFormatters(QUERY_BEGINNING_OF_TIME);
+
+    // Fixed seed, so that runs can be compared.
+    srand(1);
+    for (round = 1; round <= Rounds; ++round)
+    {
+        now = le_clk_GetAbsoluteTime();
+        Churn(round);
+        RunFormatters(now.sec + now.usec / 1e6);
+    }
+
+    ReportPools();
+
+    free(JsonValue);
+    return EXIT_SUCCESS;
+}
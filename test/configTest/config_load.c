@@ -71,7 +71,7 @@ static config_testcase_t config_testcases[][8] =
         {"nonExistingConfig.json", "json", LE_NOT_FOUND, LE_FAULT}, {{0}}
     },
     {
-        {"validConfig1.cbor", "cbor", LE_UNSUPPORTED, LE_FAULT} ,{{0}}
+        {"validConfig1.cbor", "cbor", LE_OK, LE_OK}, {{0}}
     },
     {
         {"validConfig1.json", "json", LE_OK, LE_OK}, {{0}}
@@ -119,6 +119,34 @@ static config_testcase_t config_testcases[][8] =
     {
         {"validConfig1.json" , "json", LE_OK, LE_OK},
         {"tooLargeConfig1.json", "json", LE_OK, LE_FAULT}, {{0}} // will only pass on RTOS
+    },
+    {
+        {"validConfig1.json", "xml", LE_UNSUPPORTED, LE_FAULT}, {{0}}
+    },
+    {
+        {"truncatedConfig1.cbor", "cbor", LE_OK, LE_FORMAT_ERROR}, {{0}}
+    },
+    {
+        {"wrongTypeConfig1.cbor", "cbor", LE_OK, LE_FORMAT_ERROR}, {{0}} // root is an array
+    },
+    {
+        {"wrongTypeConfig2.cbor", "cbor", LE_OK, LE_FORMAT_ERROR}, {{0}} // "o" is a string
+    },
+    {
+        {"wrongTypeConfig3.cbor", "cbor", LE_OK, LE_FORMAT_ERROR}, {{0}} // state "v" is an array
+    },
+    {
+        {"tooLongStringConfig1.cbor", "cbor", LE_OK, LE_BAD_PARAMETER}, {{0}} // obs name
+    },
+    {
+        {"tooLongStringConfig2.cbor", "cbor", LE_OK, LE_FORMAT_ERROR}, {{0}} // length > 4 GiB
+    },
+    {
+        {"tooLongMapConfig1.cbor", "cbor", LE_OK, LE_FORMAT_ERROR}, {{0}} // count > members
+    },
+    {
+        {"validConfig1.cbor" , "cbor", LE_OK, LE_OK},
+        {"truncatedConfig1.cbor", "cbor", LE_OK, LE_FORMAT_ERROR}, {{0}}
     }
 };
 
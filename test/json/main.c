@@ -0,0 +1,642 @@
+/**
+ * @file main.c
+ *
+ * unit test JSON functions:
+ *  json_Extract, json_CompileExtraction, json_ExtractCompiled, json_ExtractMultiple and
+ *  json_CopySpan
+ *
+ * Each case is checked through both the uncompiled and the compiled extraction, which must
+ * give the same result.  Values found together in one pass must be the same as those found
+ * one at a time.  Strings and whitespace are also placed at every offset from the blocks that
+ * the scanner reads at a time, so that each kind of character is seen at the edge of a block.
+ *
+ * Copyright (C) Sierra Wireless, Inc. Use of this work is subject to license.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include <string.h>
+#include "legato.h"
+#include "json.h"
+
+/* Size of the buffers the extracted values are copied to */
+#define RESULT_BUFF_BYTES 256
+
+/* Maximum number of specifiers extracted together by a multiple extraction case */
+#define MULTI_CASE_MAX_SPECS 10
+
+/* Size of the blocks the JSON scanner reads at a time (if the target has a vector unit) */
+#define SCAN_BLOCK_BYTES 16
+
+/* Longest run of string content or whitespace placed in the scan buffer: enough to span a
+ * whole block wherever it starts */
+#define MAX_RUN_BYTES (3 * SCAN_BLOCK_BYTES)
+
+/* Block-aligned buffer that JSON is copied to, at a chosen offset from the start of a block */
+static char ScanBuffer[64 * SCAN_BLOCK_BYTES] __attribute__((aligned(SCAN_BLOCK_BYTES)));
+
+/* An extraction case: the value expected from applying an extraction specifier to some JSON */
+typedef struct
+{
+    const char* json;           ///< JSON input.
+    const char* spec;           ///< Extraction specifier.
+    le_result_t result;         ///< Expected result.
+    json_DataType_t type;       ///< Expected data type (if result is LE_OK).
+    const char* value;          ///< Expected extracted value (if result is LE_OK).
+}
+ExtractionCase_t;
+
+/* One of the values expected from a multiple extraction */
+typedef struct
+{
+    const char* spec;           ///< Extraction specifier (NULL ends the list).
+    le_result_t result;         ///< Expected result.
+    const char* value;          ///< Expected extracted value (if result is LE_OK).
+}
+SpanCase_t;
+
+/* A multiple extraction case: the values expected from applying several specifiers together */
+typedef struct
+{
+    const char* json;                           ///< JSON input.
+    SpanCase_t spans[MULTI_CASE_MAX_SPECS + 1]; ///< Expected values, ending with a NULL spec.
+}
+MultiCase_t;
+
+static int setup(void **state) {
+    return 0;
+}
+static int teardown(void **state) {
+    return 0;
+}
+
+/* Check that the uncompiled and compiled extractions both give the result expected by a case */
+static void CheckExtraction
+(
+    const ExtractionCase_t* casePtr
+)
+{
+    char result[RESULT_BUFF_BYTES];
+    char compiledResult[RESULT_BUFF_BYTES];
+    json_DataType_t type = JSON_TYPE_NULL;
+    json_DataType_t compiledType = JSON_TYPE_NULL;
+    json_Extraction_t extraction;
+
+    print_message("'%s' from '%s'\n", casePtr->spec, casePtr->json);
+
+    le_result_t r = json_Extract(result, sizeof(result), casePtr->json, casePtr->spec, &type);
+    assert_int_equal(casePtr->result, r);
+
+    assert_true(LE_OK == json_CompileExtraction(casePtr->spec, &extraction));
+    le_result_t compiledR = json_ExtractCompiled(compiledResult,
+                                                 sizeof(compiledResult),
+                                                 casePtr->json,
+                                                 &extraction,
+                                                 &compiledType);
+    assert_int_equal(r, compiledR);
+
+    if (r == LE_OK)
+    {
+        assert_int_equal(casePtr->type, type);
+        assert_string_equal(casePtr->value, result);
+        assert_int_equal(type, compiledType);
+        assert_string_equal(result, compiledResult);
+    }
+}
+
+static const ExtractionCase_t ExtractionCases[] =
+{
+    // Members and elements of each type.
+    { "{\"a\":1}", "a", LE_OK, JSON_TYPE_NUMBER, "1" },
+    { "{\"a\":-12.5e3}", "a", LE_OK, JSON_TYPE_NUMBER, "-12.5e3" },
+    { "{\"a\":true}", "a", LE_OK, JSON_TYPE_BOOLEAN, "true" },
+    { "{\"a\":false}", "a", LE_OK, JSON_TYPE_BOOLEAN, "false" },
+    { "{\"a\":null}", "a", LE_OK, JSON_TYPE_NULL, "null" },
+    { "{\"a\":\"x y\"}", "a", LE_OK, JSON_TYPE_STRING, "x y" },
+    { "{\"a\":{\"b\":[1, 2]}}", "a", LE_OK, JSON_TYPE_OBJECT, "{\"b\":[1, 2]}" },
+    { "{\"a\":[1, {\"b\":2}]}", "a", LE_OK, JSON_TYPE_ARRAY, "[1, {\"b\":2}]" },
+    { "[10, 20, 30]", "[0]", LE_OK, JSON_TYPE_NUMBER, "10" },
+    { "[10, 20, 30]", "[2]", LE_OK, JSON_TYPE_NUMBER, "30" },
+
+    // Paths through nested objects and arrays.
+    { "{\"a\":{\"b\":{\"c\":\"deep\"}}}", "a.b.c", LE_OK, JSON_TYPE_STRING, "deep" },
+    { "{\"x\":[{\"y\":1}, {\"y\":2}]}", "x[1].y", LE_OK, JSON_TYPE_NUMBER, "2" },
+    { "[[1, 2], [3, [4, 5]]]", "[1][1][0]", LE_OK, JSON_TYPE_NUMBER, "4" },
+    { "{\"a_1\":{\"b-2\":3}}", "a_1.b-2", LE_OK, JSON_TYPE_NUMBER, "3" },
+
+    // Whitespace around the structure.
+    { "{ \"a\" : { \"b\" : 7 } , \"c\" : 8 } ", "a.b", LE_OK, JSON_TYPE_NUMBER, "7" },
+    { "{\n\t\"a\"\r\n:\t[ 1 ,\n 2 ]\n}", "a[1]", LE_OK, JSON_TYPE_NUMBER, "2" },
+
+    // A member name that is a prefix of another is not mistaken for it.
+    { "{\"ab\":1, \"a\":2}", "a", LE_OK, JSON_TYPE_NUMBER, "2" },
+    { "{\"a\":1, \"ab\":2}", "ab", LE_OK, JSON_TYPE_NUMBER, "2" },
+
+    // The first of duplicate members is used.
+    { "{\"a\":1, \"a\":2}", "a", LE_OK, JSON_TYPE_NUMBER, "1" },
+
+    // Members and elements that don't exist.
+    { "{}", "a", LE_NOT_FOUND, JSON_TYPE_NULL, NULL },
+    { "{\"a\":1}", "b", LE_NOT_FOUND, JSON_TYPE_NULL, NULL },
+    { "{\"a\":1, \"b\":2}", "c", LE_NOT_FOUND, JSON_TYPE_NULL, NULL },
+    { "{\"a\":{\"b\":1}}", "a.c", LE_NOT_FOUND, JSON_TYPE_NULL, NULL },
+    { "[]", "[0]", LE_NOT_FOUND, JSON_TYPE_NULL, NULL },
+    { "[1, 2]", "[2]", LE_NOT_FOUND, JSON_TYPE_NULL, NULL },
+    { "{\"a\":[]}", "a[0].b", LE_NOT_FOUND, JSON_TYPE_NULL, NULL },
+    { "", "a", LE_NOT_FOUND, JSON_TYPE_NULL, NULL },
+
+    // Stepping into something that isn't an object or array.
+    { "{\"a\":1}", "a.b", LE_FORMAT_ERROR, JSON_TYPE_NULL, NULL },
+    { "{\"a\":\"text\"}", "a[0]", LE_FORMAT_ERROR, JSON_TYPE_NULL, NULL },
+    { "[1]", "a", LE_FORMAT_ERROR, JSON_TYPE_NULL, NULL },
+    { "{\"a\":1}", "[0]", LE_FORMAT_ERROR, JSON_TYPE_NULL, NULL },
+
+    // Malformed input.
+    { "{\"a\" 1}", "a", LE_FORMAT_ERROR, JSON_TYPE_NULL, NULL },
+    { "{\"a\":1 \"b\":2}", "b", LE_FORMAT_ERROR, JSON_TYPE_NULL, NULL },
+    { "{\"a\":", "a", LE_FORMAT_ERROR, JSON_TYPE_NULL, NULL },
+    { "{\"a\":1", "b", LE_FORMAT_ERROR, JSON_TYPE_NULL, NULL },
+    { "[1, 2", "[2]", LE_FORMAT_ERROR, JSON_TYPE_NULL, NULL },
+    { "[", "[0]", LE_FORMAT_ERROR, JSON_TYPE_NULL, NULL },
+    { "{\"a\":\"unterminated}", "a", LE_FORMAT_ERROR, JSON_TYPE_NULL, NULL },
+    { "{\"a\":tru}", "a", LE_FORMAT_ERROR, JSON_TYPE_NULL, NULL },
+};
+
+static void test_json_extract
+(
+    void** state
+)
+{
+    (void)state;
+
+    for (size_t i = 0; i < NUM_ARRAY_MEMBERS(ExtractionCases); i++)
+    {
+        CheckExtraction(&ExtractionCases[i]);
+    }
+}
+
+/* Check that values found in one pass are the same as those found one at a time */
+static void CheckMultiple
+(
+    const char* json,
+    const json_Extraction_t* const extractionPtrs[],
+    size_t count,
+    const json_Span_t spans[]
+)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        char result[RESULT_BUFF_BYTES];
+        char spanResult[RESULT_BUFF_BYTES];
+        json_DataType_t type = JSON_TYPE_NULL;
+        json_DataType_t spanType = JSON_TYPE_NULL;
+
+        print_message("'%s' from '%s' in one pass\n", extractionPtrs[i]->specPtr, json);
+
+        le_result_t r = json_ExtractCompiled(result,
+                                             sizeof(result),
+                                             json,
+                                             extractionPtrs[i],
+                                             &type);
+        assert_int_equal(r, spans[i].result);
+        assert_int_equal(r,
+                         json_CopySpan(spanResult, sizeof(spanResult), json, &spans[i], &spanType));
+
+        if (r == LE_OK)
+        {
+            assert_int_equal(type, spanType);
+            assert_string_equal(result, spanResult);
+        }
+    }
+}
+
+static const MultiCase_t MultiCases[] =
+{
+    // Some members missing.
+    {
+        "{\"a\":1, \"b\":2}",
+        {
+            { "a", LE_OK, "1" }, { "c", LE_NOT_FOUND }, { "b", LE_OK, "2" },
+            { "d", LE_NOT_FOUND }, { NULL }
+        }
+    },
+
+    // All members missing, from an empty object, a non-empty object and no input at all.
+    { "{}", { { "a", LE_NOT_FOUND }, { "b.c", LE_NOT_FOUND }, { NULL } } },
+    { "{\"x\":[1]}", { { "a", LE_NOT_FOUND }, { "b[0]", LE_NOT_FOUND }, { NULL } } },
+    { "", { { "a", LE_NOT_FOUND }, { "[0]", LE_NOT_FOUND }, { NULL } } },
+
+    // Duplicate members: the first one is used, even for specifiers that go inside it.
+    {
+        "{\"a\":1, \"a\":2, \"b\":{\"c\":3}, \"b\":{\"c\":4, \"d\":5}}",
+        {
+            { "a", LE_OK, "1" }, { "b.c", LE_OK, "3" }, { "b", LE_OK, "{\"c\":3}" },
+            { "b.d", LE_NOT_FOUND }, { NULL }
+        }
+    },
+
+    // The same specifier more than once.
+    { "{\"a\":[7]}", { { "a[0]", LE_OK, "7" }, { "a[0]", LE_OK, "7" }, { NULL } } },
+
+    // Nested members and elements, including ones that share part of their path.
+    {
+        "{\"a\":{\"b\":{\"c\":1, \"d\":[1, 2, {\"e\":\"x\"}]}, \"f\":null}, \"g\":[[]]}",
+        {
+            { "a.b.c", LE_OK, "1" }, { "a.b.d[2].e", LE_OK, "x" }, { "a.f", LE_OK, "null" },
+            { "a.b.d", LE_OK, "[1, 2, {\"e\":\"x\"}]" }, { "g[0]", LE_OK, "[]" },
+            { "g[0][0]", LE_NOT_FOUND }, { "a.b.d[3]", LE_NOT_FOUND },
+            { "a.x.y", LE_NOT_FOUND }, { "a.b.c.d", LE_FORMAT_ERROR }, { NULL }
+        }
+    },
+
+    // Steps that don't suit the type of value they are applied to.
+    {
+        "[1, {\"a\":2}]",
+        {
+            { "[1].a", LE_OK, "2" }, { "a", LE_FORMAT_ERROR }, { "[0].a", LE_FORMAT_ERROR },
+            { "[1][0]", LE_FORMAT_ERROR }, { "[2]", LE_NOT_FOUND }, { NULL }
+        }
+    },
+
+    // Malformed input after some of the values.
+    {
+        "{\"a\":1, \"b\":tru}",
+        { { "a", LE_OK, "1" }, { "b", LE_FORMAT_ERROR }, { "c", LE_FORMAT_ERROR }, { NULL } }
+    },
+    {
+        "{\"a\":[1, 2",
+        { { "a[1]", LE_OK, "2" }, { "a[2]", LE_FORMAT_ERROR }, { "b", LE_FORMAT_ERROR }, { NULL } }
+    },
+};
+
+static void test_json_extract_multiple
+(
+    void** state
+)
+{
+    (void)state;
+
+    for (size_t i = 0; i < NUM_ARRAY_MEMBERS(MultiCases); i++)
+    {
+        const MultiCase_t* casePtr = &MultiCases[i];
+        json_Extraction_t extractions[MULTI_CASE_MAX_SPECS];
+        const json_Extraction_t* extractionPtrs[MULTI_CASE_MAX_SPECS];
+        json_Span_t spans[MULTI_CASE_MAX_SPECS];
+        size_t count = 0;
+
+        while (casePtr->spans[count].spec != NULL)
+        {
+            assert_true(LE_OK == json_CompileExtraction(casePtr->spans[count].spec,
+                                                        &extractions[count]));
+            extractionPtrs[count] = &extractions[count];
+            count++;
+        }
+
+        assert_true(LE_OK == json_ExtractMultiple(casePtr->json, extractionPtrs, count, spans));
+
+        for (size_t j = 0; j < count; j++)
+        {
+            char result[RESULT_BUFF_BYTES];
+
+            print_message("'%s' from '%s'\n", casePtr->spans[j].spec, casePtr->json);
+
+            assert_int_equal(casePtr->spans[j].result, spans[j].result);
+            if (spans[j].result == LE_OK)
+            {
+                assert_true(LE_OK == json_CopySpan(result,
+                                                   sizeof(result),
+                                                   casePtr->json,
+                                                   &spans[j],
+                                                   NULL));
+                assert_string_equal(casePtr->spans[j].value, result);
+            }
+        }
+
+        CheckMultiple(casePtr->json, extractionPtrs, count, spans);
+    }
+
+    // Each of the single extraction cases gives the same result when found in one pass.
+    for (size_t i = 0; i < NUM_ARRAY_MEMBERS(ExtractionCases); i++)
+    {
+        json_Extraction_t extraction;
+        const json_Extraction_t* extractionPtrs[1] = { &extraction };
+        json_Span_t span;
+
+        assert_true(LE_OK == json_CompileExtraction(ExtractionCases[i].spec, &extraction));
+        assert_true(LE_OK == json_ExtractMultiple(ExtractionCases[i].json,
+                                                  extractionPtrs,
+                                                  1,
+                                                  &span));
+        CheckMultiple(ExtractionCases[i].json, extractionPtrs, 1, &span);
+    }
+}
+
+static void test_json_extract_multiple_limit
+(
+    void** state
+)
+{
+    (void)state;
+    json_Extraction_t extractions[JSON_MAX_MULTI_EXTRACTIONS + 1];
+    const json_Extraction_t* extractionPtrs[JSON_MAX_MULTI_EXTRACTIONS + 1];
+    json_Span_t spans[JSON_MAX_MULTI_EXTRACTIONS + 1];
+    char specs[JSON_MAX_MULTI_EXTRACTIONS + 1][8];
+    char json[16 * (JSON_MAX_MULTI_EXTRACTIONS + 1)] = "[";
+
+    // The most specifiers that can be extracted together, one for each element of an array.
+    for (size_t i = 0; i < JSON_MAX_MULTI_EXTRACTIONS + 1; i++)
+    {
+        snprintf(specs[i], sizeof(specs[i]), "[%zu]", i);
+        assert_true(LE_OK == json_CompileExtraction(specs[i], &extractions[i]));
+        extractionPtrs[i] = &extractions[i];
+
+        if (i + 1 < JSON_MAX_MULTI_EXTRACTIONS)
+        {
+            snprintf(json + strlen(json), sizeof(json) - strlen(json), "%zu, ", i);
+        }
+        else if (i + 1 == JSON_MAX_MULTI_EXTRACTIONS)
+        {
+            snprintf(json + strlen(json), sizeof(json) - strlen(json), "%zu]", i);
+        }
+    }
+
+    assert_true(LE_OK == json_ExtractMultiple(json,
+                                              extractionPtrs,
+                                              JSON_MAX_MULTI_EXTRACTIONS,
+                                              spans));
+    CheckMultiple(json, extractionPtrs, JSON_MAX_MULTI_EXTRACTIONS, spans);
+    assert_int_equal(LE_OK, spans[JSON_MAX_MULTI_EXTRACTIONS - 1].result);
+
+    assert_true(LE_OVERFLOW == json_ExtractMultiple(json,
+                                                    extractionPtrs,
+                                                    JSON_MAX_MULTI_EXTRACTIONS + 1,
+                                                    spans));
+}
+
+/* Copy a JSON string into the scan buffer, at an offset from the start of a block */
+static const char* PlaceJson
+(
+    size_t offset,
+    const char* json
+)
+{
+    assert_true(offset + strlen(json) < sizeof(ScanBuffer));
+    strcpy(ScanBuffer + offset, json);
+
+    return ScanBuffer + offset;
+}
+
+/* Check that a JSON object's members "a" and "b" are found, and are the same when found in one
+ * pass */
+static void CheckMembers
+(
+    const char* json,
+    json_DataType_t aType,
+    const char* aValue,
+    const char* bValue
+)
+{
+    char result[RESULT_BUFF_BYTES];
+    json_DataType_t type;
+    json_Extraction_t extractions[2];
+    const json_Extraction_t* extractionPtrs[2] = { &extractions[0], &extractions[1] };
+    json_Span_t spans[2];
+
+    assert_true(json_IsValid(json));
+
+    assert_true(LE_OK == json_Extract(result, sizeof(result), json, "a", &type));
+    assert_int_equal(aType, type);
+    assert_string_equal(aValue, result);
+
+    assert_true(LE_OK == json_Extract(result, sizeof(result), json, "b", &type));
+    assert_int_equal(JSON_TYPE_NUMBER, type);
+    assert_string_equal(bValue, result);
+
+    assert_true(LE_OK == json_CompileExtraction("a", &extractions[0]));
+    assert_true(LE_OK == json_CompileExtraction("b", &extractions[1]));
+    assert_true(LE_OK == json_ExtractMultiple(json, extractionPtrs, 2, spans));
+    CheckMultiple(json, extractionPtrs, 2, spans);
+}
+
+static void test_json_string_block_edges
+(
+    void** state
+)
+{
+    (void)state;
+    char content[MAX_RUN_BYTES + 1];
+    char json[RESULT_BUFF_BYTES];
+    char result[RESULT_BUFF_BYTES];
+    json_DataType_t type;
+
+    // Strings of every length up to a few blocks, starting at every offset in a block, so that
+    // the closing quote lands at every offset too.
+    for (size_t offset = 0; offset < SCAN_BLOCK_BYTES; offset++)
+    {
+        for (size_t len = 0; len <= MAX_RUN_BYTES; len++)
+        {
+            memset(content, 'x', len);
+            content[len] = '\0';
+            snprintf(json, sizeof(json), "{\"a\":\"%s\",\"b\":%zu}", content, len);
+
+            print_message("%zu bytes at offset %zu\n", len, offset);
+
+            char number[8];
+            snprintf(number, sizeof(number), "%zu", len);
+            CheckMembers(PlaceJson(offset, json), JSON_TYPE_STRING, content, number);
+
+            // With the input ending inside the string, at every offset.
+            json[strlen("{\"a\":\"") + len] = '\0';
+            const char* truncatedPtr = PlaceJson(offset, json);
+            assert_false(json_IsValid(truncatedPtr));
+            assert_int_equal(LE_FORMAT_ERROR,
+                             json_Extract(result, sizeof(result), truncatedPtr, "a", &type));
+        }
+    }
+}
+
+static void test_json_string_specials_at_block_edges
+(
+    void** state
+)
+{
+    (void)state;
+    char content[MAX_RUN_BYTES + 16];
+    char json[RESULT_BUFF_BYTES];
+
+    // Escape sequences and control characters, which are kept as they are in the string.  The
+    // two-byte escapes put a backslash at the end of one block and the escaped character at
+    // the start of the next.
+    static const char* const Specials[] =
+    {
+        "\\\"", "\\\\", "\\/", "\\n", "\\u00e9", "\\\\\\\"",
+        "\x01", "\x1f", "\t", "\n", "\x7f", "\xc3\xa9"
+    };
+
+    for (size_t i = 0; i < NUM_ARRAY_MEMBERS(Specials); i++)
+    {
+        for (size_t offset = 0; offset < SCAN_BLOCK_BYTES; offset++)
+        {
+            for (size_t pos = 0; pos <= 2 * SCAN_BLOCK_BYTES; pos++)
+            {
+                memset(content, 'x', pos);
+                content[pos] = '\0';
+                strcat(content, Specials[i]);
+                strcat(content, "yz");
+                snprintf(json, sizeof(json), "{\"a\":\"%s\",\"b\":1}", content);
+
+                print_message("special %zu at %zu, offset %zu\n", i, pos, offset);
+
+                CheckMembers(PlaceJson(offset, json), JSON_TYPE_STRING, content, "1");
+            }
+        }
+    }
+}
+
+static void test_json_whitespace_blocks
+(
+    void** state
+)
+{
+    (void)state;
+    char space[MAX_RUN_BYTES + 1];
+    char json[16 * MAX_RUN_BYTES];
+    char array[RESULT_BUFF_BYTES];
+    char result[RESULT_BUFF_BYTES];
+    json_DataType_t type;
+
+    // Every kind of whitespace.
+    static const char Whitespace[] = " \t\n\v\f\r";
+
+    // Runs of whitespace of every length up to a few blocks, starting at every offset in a
+    // block, between every token and after the end of the value.  Whole blocks of whitespace
+    // are skipped in one go.
+    for (size_t offset = 0; offset < SCAN_BLOCK_BYTES; offset++)
+    {
+        for (size_t len = 0; len <= MAX_RUN_BYTES; len++)
+        {
+            for (size_t i = 0; i < len; i++)
+            {
+                space[i] = Whitespace[(i + len) % (sizeof(Whitespace) - 1)];
+            }
+            space[len] = '\0';
+
+            snprintf(json,
+                     sizeof(json),
+                     "{%s\"a\"%s:%s[%s1%s,%s2%s]%s,%s\"b\":%s3%s}%s",
+                     space, space, space, space, space, space, space, space, space, space,
+                     space, space);
+
+            print_message("%zu whitespace bytes at offset %zu\n", len, offset);
+
+            snprintf(array, sizeof(array), "[%s1%s,%s2%s]", space, space, space, space);
+
+            const char* jsonPtr = PlaceJson(offset, json);
+            CheckMembers(jsonPtr, JSON_TYPE_ARRAY, array, "3");
+
+            assert_true(LE_OK == json_Extract(result, sizeof(result), jsonPtr, "a[1]", &type));
+            assert_string_equal("2", result);
+        }
+    }
+
+    // A character that isn't whitespace, at every offset in a run that would otherwise fill
+    // whole blocks.  Bytes either side of the whitespace range are not whitespace.
+    static const char NotWhitespace[] = { '\x08', '\x0e', '\x1f', '!', '\x89', 'x' };
+
+    for (size_t i = 0; i < sizeof(NotWhitespace); i++)
+    {
+        for (size_t pos = 0; pos < MAX_RUN_BYTES; pos++)
+        {
+            memset(space, ' ', MAX_RUN_BYTES);
+            space[MAX_RUN_BYTES] = '\0';
+            space[pos] = NotWhitespace[i];
+            snprintf(json, sizeof(json), "[1,%s2]", space);
+
+            print_message("byte 0x%02x at %zu\n", (unsigned char)NotWhitespace[i], pos);
+
+            const char* jsonPtr = PlaceJson(0, json);
+            assert_false(json_IsValid(jsonPtr));
+            assert_int_equal(LE_FORMAT_ERROR,
+                             json_Extract(result, sizeof(result), jsonPtr, "[1]", &type));
+        }
+    }
+}
+
+static void test_json_extract_overflow
+(
+    void** state
+)
+{
+    (void)state;
+    char result[4];
+    json_DataType_t type;
+    json_Extraction_t extraction;
+
+    // The value and its null terminator must fit.
+    assert_true(LE_OK == json_Extract(result, sizeof(result), "{\"a\":\"xyz\"}", "a", &type));
+    assert_string_equal("xyz", result);
+    assert_true(LE_OVERFLOW ==
+                json_Extract(result, sizeof(result), "{\"a\":\"wxyz\"}", "a", &type));
+
+    assert_true(LE_OK == json_CompileExtraction("a", &extraction));
+    assert_true(LE_OVERFLOW ==
+                json_ExtractCompiled(result, sizeof(result), "{\"a\":[1,2]}", &extraction, &type));
+}
+
+static void test_json_compile_bad_spec
+(
+    void** state
+)
+{
+    (void)state;
+    json_Extraction_t extraction;
+    char result[RESULT_BUFF_BYTES];
+    json_DataType_t type;
+
+    static const char* const BadSpecs[] =
+    {
+        "a.", "a..b", "1a", "[", "[]", "[x]", "a[0", "a]", "a b", "a[0]."
+    };
+
+    for (size_t i = 0; i < NUM_ARRAY_MEMBERS(BadSpecs); i++)
+    {
+        print_message("'%s'\n", BadSpecs[i]);
+        assert_int_equal(LE_BAD_PARAMETER, json_CompileExtraction(BadSpecs[i], &extraction));
+    }
+
+    // A spec that is bad after the first step is also rejected by the uncompiled extraction,
+    // once the steps before it have been found.
+    assert_int_equal(LE_BAD_PARAMETER,
+                     json_Extract(result, sizeof(result), "{\"a\":{\"b\":1}}", "a..b", &type));
+
+    // Only JSON_MAX_EXTRACTION_STEPS steps fit in a compiled specifier.
+    char spec[4 * (JSON_MAX_EXTRACTION_STEPS + 1)] = "";
+    for (size_t i = 0; i < JSON_MAX_EXTRACTION_STEPS; i++)
+    {
+        strcat(spec, "[0]");
+    }
+    assert_true(LE_OK == json_CompileExtraction(spec, &extraction));
+    strcat(spec, "[0]");
+    assert_true(LE_OVERFLOW == json_CompileExtraction(spec, &extraction));
+}
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+    const struct CMUnitTest tests[] =
+    {
+        cmocka_unit_test(test_json_extract),
+        cmocka_unit_test(test_json_extract_multiple),
+        cmocka_unit_test(test_json_extract_multiple_limit),
+        cmocka_unit_test(test_json_string_block_edges),
+        cmocka_unit_test(test_json_string_specials_at_block_edges),
+        cmocka_unit_test(test_json_whitespace_blocks),
+        cmocka_unit_test(test_json_extract_overflow),
+        cmocka_unit_test(test_json_compile_bad_spec),
+    };
+    return cmocka_run_group_tests(tests, setup, teardown);
+}
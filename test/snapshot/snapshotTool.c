@@ -8,6 +8,10 @@
 #include "legato.h"
 #include "interfaces.h"
 
+#if !LE_CONFIG_RTOS
+#include <sys/mman.h>
+#endif
+
 #ifdef WITH_OCTAVE
 /// Use query API custom flag as full tree encoding request
 #define OCTAVE_FLAG_FULL_TREE QUERY_SNAPSHOT_FLAG_CUSTOM
@@ -19,6 +23,11 @@ static le_fdMonitor_Ref_t MonitorRef;
 /// FD to write the formatted output to.
 static int OutFile;
 
+#if !LE_CONFIG_RTOS
+/// Shared memory file the formatted snapshot is written to, when requested.
+static int MemoryFile = -1;
+#endif
+
 /// Query API connection state.
 static bool Connected;
 
@@ -96,6 +105,84 @@ static void HandleResult
     DoExit(ret);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy formatted data to the output file, blocking until it has all been written.
+ *
+ * @return true if successful, false on a write error.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool WriteOutput
+(
+    const uint8_t   *data,  ///< Formatted data.
+    size_t           count  ///< Number of bytes of formatted data.
+)
+{
+    size_t  offset = 0;
+    ssize_t written;
+
+    while (count > 0)
+    {
+        written = le_fd_Write(OutFile, &data[offset], count);
+        if (written < 0)
+        {
+            LE_WARN("Output stream write error");
+            return false;
+        }
+        else
+        {
+            LE_ASSERT((size_t) written <= count);
+            count -= written;
+            offset += written;
+        }
+    }
+    return true;
+}
+
+#if !LE_CONFIG_RTOS
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handle completion result of a snapshot operation to shared memory, copying the formatted data
+ * to the output on success.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HandleMemoryResult
+(
+    le_result_t  result,    ///< Snapshot operation result.
+    uint32_t     length,    ///< Number of bytes of formatted data in the shared memory file.
+    void        *context    ///< Unused.
+)
+{
+    void *data;
+
+    LE_DEBUG("Got %" PRIu32 " bytes of shared memory", length);
+    if (result == LE_OK && length > 0)
+    {
+        data = mmap(NULL, length, PROT_READ, MAP_SHARED, MemoryFile, 0);
+        if (data == MAP_FAILED)
+        {
+            LE_ERROR("Failed to map snapshot memory, errno: %d", errno);
+            result = LE_FAULT;
+        }
+        else
+        {
+            if (!WriteOutput(data, length))
+            {
+                result = LE_IO_ERROR;
+            }
+            munmap(data, length);
+        }
+    }
+
+    if (MemoryFile >= 0)
+    {
+        le_fd_Close(MemoryFile);
+        MemoryFile = -1;
+    }
+    HandleResult(result, context);
+}
+#endif /* end not LE_CONFIG_RTOS */
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Handle formatted snapshot data being streamed back from the Data Hub.
@@ -107,9 +194,7 @@ static void HandleStreamData
     short events    ///< Event bitfield which triggered this callback.
 )
 {
-    size_t  offset;
     ssize_t count;
-    ssize_t written;
     uint8_t buffer[128];
 
     if (events & POLLIN)
@@ -130,21 +215,9 @@ static void HandleStreamData
             }
             else if (count > 0)
             {
-                offset = 0;
-                while (count > 0)
+                if (!WriteOutput(buffer, count))
                 {
-                    written = le_fd_Write(OutFile, &buffer[offset], count);
-                    if (written < 0)
-                    {
-                        LE_WARN("Output stream write error");
-                        return;
-                    }
-                    else
-                    {
-                        count -= written;
-                        offset += written;
-                        LE_ASSERT(count >= 0);
-                    }
+                    return;
                 }
             }
             else
@@ -170,6 +243,9 @@ static void HandleHelpRequest
 #ifdef WITH_OCTAVE
         " [-F]"
 #endif
+#if !LE_CONFIG_RTOS
+        " [-m]"
+#endif
 #if LE_CONFIG_FILESYSTEM
         " [-o <output>]"
 #endif
@@ -191,6 +267,10 @@ static void HandleHelpRequest
 #ifdef WITH_OCTAVE
         "    -F                      Encode full tree (diff otherwise, octave format only).\n"
 #endif
+#if !LE_CONFIG_RTOS
+        "    -m, --memory            Have the snapshot written to shared memory instead of\n"
+        "                            streamed.\n"
+#endif
 #if LE_CONFIG_FILESYSTEM
         "    -o, --output=<string>   File path to write the output to.  Default is to write to\n"
         "                            stdout.\n"
@@ -217,6 +297,9 @@ COMPONENT_INIT
     int          formatStream = -1;
 #ifdef WITH_OCTAVE
     bool         fullDump = false;
+#endif
+#if !LE_CONFIG_RTOS
+    bool         toMemory = false;
 #endif
     le_result_t  result;
     uint32_t     flags = QUERY_SNAPSHOT_FLAG_FLUSH_DELETIONS;
@@ -234,6 +317,9 @@ COMPONENT_INIT
 #ifdef WITH_OCTAVE
     le_arg_SetFlagVar(&fullDump, "F", "fulldump");
 #endif
+#if !LE_CONFIG_RTOS
+    le_arg_SetFlagVar(&toMemory, "m", "memory");
+#endif
 #if LE_CONFIG_FILESYSTEM
     le_arg_SetStringVar(&outputStr, "o", "output");
 #endif
@@ -311,6 +397,14 @@ COMPONENT_INIT
 #endif
 
     // Initiate the snapshot.
+#if !LE_CONFIG_RTOS
+    if (toMemory)
+    {
+        query_TakeSnapshotToMemory(format, flags, pathStr, since, &HandleMemoryResult, NULL,
+            &MemoryFile);
+        return;
+    }
+#endif
     query_TakeSnapshot(format, flags, pathStr, since, &HandleResult, NULL, &formatStream);
     if (formatStream >= 0)
     {